@@ -247,7 +247,7 @@ void SVNRepos::dump(File &path, OutputStream &dataOut,
                                     ? ReposNotifyCallback::notify
                                     : NULL,
                                  notifyCallback,
-                                 NULL, NULL,
+                                 NULL, NULL, 1,
                                  checkCancel, this, requestPool.getPool()), );
 }
 
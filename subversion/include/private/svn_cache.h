@@ -115,6 +115,12 @@ typedef struct svn_memcache_t svn_memcache_t;
  */
 typedef struct svn_membuffer_t svn_membuffer_t;
 
+/**
+ * An opaque structure representing a memory-mapped cache file that is
+ * shared between all processes on the same host and survives restarts.
+ */
+typedef struct svn_cache__mmap_t svn_cache__mmap_t;
+
 /**
  * Opaque type for an in-memory cache.
  */
@@ -270,6 +276,65 @@ svn_cache__make_memcache_from_config(svn_memcache_t **memcache_p,
                                      apr_pool_t *result_pool,
                                      apr_pool_t *scratch_pool);
 
+/**
+ * Opens the persistent cache file at @a path and returns a handle to it
+ * in @a *mmap_p.  If the file does not exist or has not been initialized,
+ * yet, it will be created with a size of about @a size bytes.  Otherwise,
+ * its current size will be kept.  Use @a scratch_pool for temporary
+ * allocations.
+ *
+ * The file will be mapped into memory and every process on the same host
+ * opening the same file will share its contents.  Within a process, all
+ * callers opening the same @a path will get the same handle, which will
+ * remain valid until the process terminates.
+ *
+ * The file contents is never trusted: Entries that got corrupted e.g. by
+ * a crash or written by a different Subversion build will simply not be
+ * found.  Writes will be dropped while other processes write to the file.
+ *
+ * If the platform does not support memory-mapped files or the lock-free
+ * access to them, raises SVN_ERR_UNSUPPORTED_FEATURE.
+ */
+svn_error_t *
+svn_cache__mmap_open(svn_cache__mmap_t **mmap_p,
+                     const char *path,
+                     apr_uint64_t size,
+                     apr_pool_t *scratch_pool);
+
+/**
+ * Creates a new cache in @a *cache_p, storing its elements in the
+ * persistent cache file @a mmap.  The elements in the cache will be
+ * indexed by keys of length @a klen, which may be APR_HASH_KEY_STRING if
+ * they are strings.  Values will be serialized for the cache file using
+ * @a serialize_func and deserialized using @a deserialize_func.  Because
+ * the same cache file may cache many different kinds of values, @a prefix
+ * should be specified to differentiate this cache from other caches.  It
+ * must also be stable across process restarts to make the cache useful.
+ * @a *cache_p will be allocated in @a result_pool.
+ *
+ * If @a l1 is not @c NULL, the new cache will act as a second level behind
+ * it: Lookups will try @a l1 first, copying any data found only in @a mmap
+ * into @a l1, and all writes will go to both levels.  @a l1 must use the
+ * same keys and value types as the new cache.
+ *
+ * If @a deserialize_func is NULL, then the data is returned as an
+ * svn_stringbuf_t; if @a serialize_func is NULL, then the data is
+ * assumed to be an svn_stringbuf_t.
+ *
+ * These caches are always thread safe.
+ *
+ * These caches do not support svn_cache__iter.
+ */
+svn_error_t *
+svn_cache__create_mmap_cache(svn_cache__t **cache_p,
+                             svn_cache__mmap_t *mmap,
+                             svn_cache__t *l1,
+                             svn_cache__serialize_func_t serialize_func,
+                             svn_cache__deserialize_func_t deserialize_func,
+                             apr_ssize_t klen,
+                             const char *prefix,
+                             apr_pool_t *result_pool);
+
 /**
  * Creates a new membuffer cache object in @a *cache. It will contain
  * up to @a total_size bytes of data, using @a directory_size bytes
@@ -286,14 +351,18 @@ svn_cache__make_memcache_from_config(svn_memcache_t **memcache_p,
  * cachable item size.  If it is not a power of two, it will be rounded
  * down to next lower power of two. Also, there is an implementation
  * specific upper limit and the setting will be capped there automatically.
- * If the number is 0, a default will be derived from @a total_size.
+ * If the number is 0, a default will be derived from @a total_size.  Pass
+ * #SVN_CACHE__MEMBUFFER_SCALE_SEGMENTS to use at least twice as many
+ * segments as there are hardware threads.
  *
  * If access to the resulting cache object is guaranteed to be serialized,
  * @a thread_safe may be set to @c FALSE for maximum performance.
  *
  * There is no limit on the number of threads reading a given cache segment
- * concurrently.  Writes, however, need an exclusive lock on the respective
- * segment.  @a allow_blocking_writes controls contention is handled here.
+ * concurrently.  Where supported, readers will not even block each other
+ * but simply retry under a lock if a writer interfered with them.  Writes,
+ * however, need an exclusive lock on the respective segment.
+ * @a allow_blocking_writes controls how contention is handled here.
  * If set to TRUE, writes will wait until the lock becomes available, i.e.
  * reads should be short.  If set to FALSE, write attempts will be ignored
  * (no data being written to the cache) if some reader or another writer
@@ -310,6 +379,14 @@ svn_cache__membuffer_cache_create(svn_membuffer_t **cache,
                                   svn_boolean_t allow_blocking_writes,
                                   apr_pool_t *result_pool);
 
+/**
+ * Special value for the @a segment_count parameter of
+ * svn_cache__membuffer_cache_create() that makes the number of segments
+ * scale with the number of hardware threads.  Size-dependent minimums and
+ * limits still apply.
+ */
+#define SVN_CACHE__MEMBUFFER_SCALE_SEGMENTS ((apr_size_t)-1)
+
 /**
  * @defgroup Standard priority classes for #svn_cache__create_membuffer_cache.
  * @{
@@ -554,6 +631,17 @@ svn_cache__format_info(const svn_cache__info_t *info,
 struct svn_membuffer_t *
 svn_cache__get_global_membuffer_cache(void);
 
+/**
+ * If @a scale is set, let the process-global membuffer cache use
+ * #SVN_CACHE__MEMBUFFER_SCALE_SEGMENTS when it gets created.  That is
+ * useful for servers running many threads in one process.
+ *
+ * Like svn_cache_config_set(), this has no effect once the cache is in
+ * use and is not thread-safe.
+ */
+void
+svn_cache__config_set_scale_segments(svn_boolean_t scale);
+
 /**
  * Return total access and size stats over all membuffer caches as they
  * share the underlying data buffer.  The result will be allocated in POOL.
@@ -26,6 +26,7 @@
 #define SVN_FS_PRIVATE_H
 
 #include "svn_fs.h"
+#include "private/svn_cache.h"
 #include "private/svn_editor.h"
 
 #ifdef __cplusplus
@@ -211,6 +212,41 @@ svn_fs__get_deleted_node(svn_fs_root_t **node_root,
                          apr_pool_t *result_pool,
                          apr_pool_t *scratch_pool);
 
+/** Set @a *info to the usage statistics of the process-wide cache used by
+ * svn_fs_get_file_delta_stream(), see #SVN_FS_CONFIG_CACHE_FILE_DELTAS.
+ * If there is no such cache, set @a *info to NULL.  If @a reset is set,
+ * reset the access counters after reading them.  Allocate the result in
+ * @a result_pool.
+ */
+svn_error_t *
+svn_fs__get_file_delta_cache_info(svn_cache__info_t **info,
+                                  svn_boolean_t reset,
+                                  apr_pool_t *result_pool);
+
+/** If the contents of the file @a path under the revision root @a root
+ * are stored as a single, unencoded byte range on disk, set @a *file to
+ * the file containing them and @a *offset and @a *length to the location
+ * of the contents within @a *file.  Otherwise, e.g. for transaction roots
+ * or deltified contents, set @a *file to NULL.
+ *
+ * This allows servers to deliver large fulltexts straight from disk,
+ * e.g. using sendfile(), rather than reading them through a stream.
+ * Note that in that case, the contents will not be verified against
+ * their checksum.
+ *
+ * @a *file will remain open for as long as @a result_pool.  Callers
+ * may read from and seek in it but must not modify or close it.
+ * Use @a scratch_pool for temporary allocations.
+ */
+svn_error_t *
+svn_fs__file_contents_range(apr_file_t **file,
+                            apr_off_t *offset,
+                            svn_filesize_t *length,
+                            svn_fs_root_t *root,
+                            const char *path,
+                            apr_pool_t *result_pool,
+                            apr_pool_t *scratch_pool);
+
 
 /** @} */
 
@@ -72,6 +72,17 @@ svn_io__is_finfo_read_only(svn_boolean_t *read_only,
                            apr_finfo_t *file_info,
                            apr_pool_t *pool);
 
+/** Set @a *owned TRUE if @a file_info, which must have been retrieved
+ * with #APR_FINFO_USER, shows that the file is owned by the current user,
+ * FALSE otherwise.
+ *
+ * Always returns FALSE on platforms without user support.
+ */
+svn_error_t *
+svn_io__is_finfo_owned(svn_boolean_t *owned,
+                       apr_finfo_t *file_info,
+                       apr_pool_t *pool);
+
 
 /**
  * Lock file at @a lock_file. If that file does not exist, create an empty
@@ -84,6 +95,25 @@ svn_error_t *
 svn_io__file_lock_autocreate(const char *lock_file,
                              apr_pool_t *pool);
 
+/* Create DST_ABSPATH as a new hard link to the existing file SRC_ABSPATH.
+   Fail if DST_ABSPATH already exists, or if the file system does not
+   support hard links between the two paths.  Use SCRATCH_POOL for
+   temporary allocations. */
+svn_error_t *
+svn_io__link_file(const char *src_abspath,
+                  const char *dst_abspath,
+                  apr_pool_t *scratch_pool);
+
+/* Create DST_ABSPATH as a new file that shares the data blocks of the
+   existing file SRC_ABSPATH copy-on-write, i.e. as a reflink.  Fail if
+   DST_ABSPATH already exists, and return SVN_ERR_UNSUPPORTED_FEATURE if
+   this platform cannot clone files at all.  Use SCRATCH_POOL for temporary
+   allocations. */
+svn_error_t *
+svn_io__clone_file(const char *src_abspath,
+                   const char *dst_abspath,
+                   apr_pool_t *scratch_pool);
+
 
 /** Return the underlying file, if any, associated with the stream, or
  * NULL if not available.  Accessing the file bypasses the stream.
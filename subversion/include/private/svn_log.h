@@ -264,6 +264,29 @@ svn_log__list(const char *path, svn_revnum_t revision,
               apr_array_header_t *patterns, svn_depth_t depth,
               apr_uint32_t dirent_fields, apr_pool_t *pool);
 
+/**
+ * Return a log string for a get-blame action.
+ *
+ * @since New in 1.10.
+ */
+const char *
+svn_log__get_blame(const char *path, svn_revnum_t start, svn_revnum_t end,
+                   const apr_array_header_t *diff_options,
+                   apr_pool_t *pool);
+
+/**
+ * Return a log string for a get-files action.  @a paths and @a revisions
+ * are parallel arrays of <tt>const char *</tt> and #svn_revnum_t,
+ * respectively.
+ *
+ * @since New in 1.10.
+ */
+const char *
+svn_log__get_files(const apr_array_header_t *paths,
+                   const apr_array_header_t *revisions,
+                   svn_boolean_t want_props,
+                   apr_pool_t *pool);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -0,0 +1,142 @@
+/**
+ * @copyright
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ * @endcopyright
+ *
+ * @file svn_parallel.h
+ * @brief Concurrent execution of independent tasks with ordered output
+ */
+
+#ifndef SVN_PARALLEL_H
+#define SVN_PARALLEL_H
+
+#include <apr_pools.h>
+
+#include "svn_types.h"
+#include "svn_error.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * A simple framework to process a sequence of independent tasks on a
+ * number of worker threads while handing their results back to the
+ * calling thread strictly in task order.
+ *
+ * Tasks are identified by their index, 0 .. task count - 1.  They get
+ * executed in any order and potentially concurrently by calling a
+ * #svn_parallel__task_func_t.  The outcome of each task, i.e. its result
+ * or error, is passed to a #svn_parallel__output_func_t in the calling
+ * thread in the order of the task indexes.  Thus, all output handling,
+ * notifications etc. may continue to use single-threaded data structures.
+ *
+ * If APR does not support threads or if only a single thread has been
+ * requested, all tasks will be executed sequentially in the calling
+ * thread, interleaved with their respective output calls.  Callers
+ * therefore do not need separate code paths for the sequential case.
+ */
+
+/** Callback type executing the task with index @a idx and returning its
+ * result in @a *result.  @a baton is the task baton given to
+ * svn_parallel__run().
+ *
+ * Allocate the result in @a result_pool, which is private to this task
+ * and will not be cleared before the result has been passed to the output
+ * function.  Use @a scratch_pool for temporary allocations.  Both pools
+ * may be used safely within the current thread.  The result will be
+ * passed to the output function even if the task returns an error.
+ *
+ * Call @a cancel_func with @a cancel_baton periodically.  It will report
+ * #SVN_ERR_CANCELLED when the whole run is being aborted.  Unlike the
+ * caller's cancellation function, this one may be called from any thread.
+ *
+ * @note This function may be called from any thread and concurrently
+ * for different tasks.  It must not access state shared with other tasks
+ * or the caller unless it has been made thread-safe.
+ */
+typedef svn_error_t *
+(*svn_parallel__task_func_t)(void **result,
+                             void *baton,
+                             int idx,
+                             svn_cancel_func_t cancel_func,
+                             void *cancel_baton,
+                             apr_pool_t *result_pool,
+                             apr_pool_t *scratch_pool);
+
+/** Callback type processing the outcome of the task with index @a idx.
+ * @a result is what the task function returned in its @c *result, or
+ * @c NULL if it did not set it.  @a task_err is the error returned by the
+ * task function and this function takes ownership of it.  @a baton is
+ * the output baton given to svn_parallel__run().
+ *
+ * Returning an error aborts the run and that error will be returned by
+ * svn_parallel__run().
+ *
+ * Use @a scratch_pool for temporary allocations.  @a result will become
+ * invalid as soon as this function returns.
+ *
+ * @note This function will always be called from the thread that called
+ * svn_parallel__run().
+ */
+typedef svn_error_t *
+(*svn_parallel__output_func_t)(void *baton,
+                               int idx,
+                               void *result,
+                               svn_error_t *task_err,
+                               apr_pool_t *scratch_pool);
+
+/** Execute @a task_count tasks by calling @a task_func with @a task_baton
+ * for each of them, using up to @a thread_count worker threads.  Pass the
+ * outcome of each task to @a output_func with @a output_baton, in the
+ * order of the task indexes.
+ *
+ * To limit memory usage, at most @a max_pending tasks will be started
+ * or completed but have not been processed by @a output_func, yet.  If
+ * @a max_pending is 0, a reasonable default based on @a thread_count
+ * will be used.
+ *
+ * If @a thread_count is 1 or smaller, execute all tasks sequentially in
+ * the calling thread.
+ *
+ * If @a cancel_func is not @c NULL, call it with @a cancel_baton
+ * periodically from the calling thread.  Upon cancellation or an error
+ * returned by @a output_func, wait for all running tasks to complete,
+ * discard all pending results and return the error.
+ *
+ * Use @a scratch_pool for temporary allocations.
+ */
+svn_error_t *
+svn_parallel__run(int task_count,
+                  int thread_count,
+                  int max_pending,
+                  svn_parallel__task_func_t task_func,
+                  void *task_baton,
+                  svn_parallel__output_func_t output_func,
+                  void *output_baton,
+                  svn_cancel_func_t cancel_func,
+                  void *cancel_baton,
+                  apr_pool_t *scratch_pool);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* SVN_PARALLEL_H */
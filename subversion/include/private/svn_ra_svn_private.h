@@ -178,6 +178,19 @@ svn_ra_svn__write_cstring(svn_ra_svn_conn_t *conn,
                           apr_pool_t *pool,
                           const char *s);
 
+/** Write the @a length bytes at @a offset in @a file over the net as
+ * a sequence of strings, each no longer than 1 MB.  Use sendfile() for
+ * them, if supported by the platform and the connection.
+ *
+ * The strings are not terminated by an empty string.
+ */
+svn_error_t *
+svn_ra_svn__write_file_range(svn_ra_svn_conn_t *conn,
+                             apr_pool_t *pool,
+                             apr_file_t *file,
+                             apr_off_t offset,
+                             svn_filesize_t length);
+
 /** Write a word over the net.
  *
  * Writes will be buffered until the next read or flush.
@@ -365,6 +378,26 @@ svn_ra_svn__has_command(svn_boolean_t *has_command,
                         svn_ra_svn_conn_t *conn,
                         apr_pool_t *pool);
 
+/** Like svn_ra_svn__has_command() but set @a *has_command to TRUE only
+ * once the next command has been received completely.  Read all data
+ * that is currently available on @a conn without ever waiting for new
+ * data to come in and keep it for the next command to be handled.
+ *
+ * This allows servers to wait for requests on many connections at once
+ * and to process them only when they can do so without blocking.
+ *
+ * SASL encrypted input can't be read partially without blocking.  For
+ * such connections, @a *has_command will be set as soon as any input is
+ * available and handling the command may block until it is complete.
+ *
+ * @since New in 1.10.
+ */
+svn_error_t *
+svn_ra_svn__has_complete_command(svn_boolean_t *has_command,
+                                 svn_boolean_t *terminated,
+                                 svn_ra_svn_conn_t *conn,
+                                 apr_pool_t *pool);
+
 /** Accept a single command from @a conn and handle them according
  * to @a cmd_hash.  Command handlers will be passed @a conn, @a pool,
  * the parameters of the command, and @a baton.  @a *terminate will be
@@ -349,6 +349,41 @@ svn_repos__dump_node_record(svn_stream_t *dump_stream,
                             svn_boolean_t content_length_always,
                             apr_pool_t *scratch_pool);
 
+/* Like svn_repos_dump_fs4() but if USE_DELTAS is set, encode the text
+ * deltas in svndiff format SVNDIFF_VERSION with the given
+ * COMPRESSION_LEVEL instead of using the uncompressed svndiff0 format.
+ *
+ * Note that loading the resulting dump file requires a Subversion version
+ * that supports the respective svndiff format.
+ */
+svn_error_t *
+svn_repos__dump_fs(svn_repos_t *repos,
+                   svn_stream_t *stream,
+                   svn_revnum_t start_rev,
+                   svn_revnum_t end_rev,
+                   svn_boolean_t incremental,
+                   svn_boolean_t use_deltas,
+                   int svndiff_version,
+                   int compression_level,
+                   svn_boolean_t include_revprops,
+                   svn_boolean_t include_changes,
+                   svn_repos_notify_func_t notify_func,
+                   void *notify_baton,
+                   svn_repos_dump_filter_func_t filter_func,
+                   void *filter_baton,
+                   int thread_count,
+                   svn_cancel_func_t cancel_func,
+                   void *cancel_baton,
+                   apr_pool_t *pool);
+
+/* Return the number of file entries whose data any update report in this
+ * process has gathered on worker threads ahead of the editor drive.  See
+ * the THREAD_COUNT parameter of svn_repos_begin_report4().  This allows
+ * tests to check that prefetching actually took place.
+ */
+apr_uint32_t
+svn_repos__report_prefetch_count(void);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
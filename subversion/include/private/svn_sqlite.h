@@ -96,6 +96,12 @@ svn_sqlite__insert(apr_int64_t *row_id, svn_sqlite__stmt_t *stmt);
 svn_error_t *
 svn_sqlite__update(int *affected_rows, svn_sqlite__stmt_t *stmt);
 
+/* Return the number of rows inserted, updated or deleted through DB since
+   it has been opened, including changes made by triggers.  Comparing two
+   values tells whether anything has been written to DB in between. */
+int
+svn_sqlite__total_changes(svn_sqlite__db_t *db);
+
 /* Return in *VERSION the version of the schema in DB. Use SCRATCH_POOL
    for temporary allocations.  */
 svn_error_t *
@@ -505,6 +505,16 @@ svn_version__at_least(const svn_version_t *version,
 /* Slowest, best compression method & level provided by zlib. */
 #define SVN__COMPRESSION_ZLIB_MAX     9
 
+/* Fastest, least effective compression level provided by zstd. */
+#define SVN__COMPRESSION_ZSTD_MIN     1
+
+/* Default compression level provided by zstd. */
+#define SVN__COMPRESSION_ZSTD_DEFAULT 3
+
+/* Slowest, best compression level of zstd that does not require
+   special decoder settings. */
+#define SVN__COMPRESSION_ZSTD_MAX     19
+
 /* Encode VAL into the buffer P using the variable-length 7b/8b unsigned
    integer format.  Return the incremented value of P after the
    encoded bytes have been written.  P must point to a buffer of size
@@ -591,6 +601,32 @@ svn__decompress_lz4(const void *data, apr_size_t len,
                     svn_stringbuf_t *out,
                     apr_size_t limit);
 
+/* Return TRUE if this build supports Zstandard compression, i.e. if
+ * svn__compress_zstd() and svn__decompress_zstd() are functional.
+ */
+svn_boolean_t
+svn_zstd__is_available(void);
+
+/* Same as svn__compress_zlib(), but use Zstandard compression with the
+ * given COMPRESSION_LEVEL.  SVN__COMPRESSION_NONE is valid for
+ * COMPRESSION_LEVEL and levels beyond what the library supports will be
+ * reduced to its maximum.  Return SVN_ERR_UNSUPPORTED_FEATURE if
+ * svn_zstd__is_available() is FALSE.
+ */
+svn_error_t *
+svn__compress_zstd(const void *data, apr_size_t len,
+                   svn_stringbuf_t *out,
+                   int compression_level);
+
+/* Same as svn__decompress_zlib(), but use Zstandard compression.  Return
+ * SVN_ERR_UNSUPPORTED_FEATURE for compressed data if
+ * svn_zstd__is_available() is FALSE.
+ */
+svn_error_t *
+svn__decompress_zstd(const void *data, apr_size_t len,
+                     svn_stringbuf_t *out,
+                     apr_size_t limit);
+
 /** @} */
 
 /**
@@ -738,6 +774,14 @@ const char *svn_zlib__compiled_version(void);
 /* Return the zlib version we run against. */
 const char *svn_zlib__runtime_version(void);
 
+/* Return the zstd version we compiled against or NULL if we were built
+   without zstd support. */
+const char *svn_zstd__compiled_version(void);
+
+/* Return the zstd version we run against or NULL if we were built
+   without zstd support. */
+const char *svn_zstd__runtime_version(void);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -1004,7 +1004,10 @@ svn_wc__node_get_md5_from_sha1(const svn_checksum_t **md5_checksum,
 /* Like svn_wc_get_pristine_contents2(), but keyed on the CHECKSUM
    rather than on the local absolute path of the working file.
    WRI_ABSPATH is any versioned path of the working copy in whose
-   pristine database we'll be looking for these contents.  */
+   pristine database we'll be looking for these contents.  If that
+   working copy doesn't have them, or WRI_ABSPATH is NULL, look in the
+   pristine store shared by all working copies on this host, if one is
+   configured.  */
 svn_error_t *
 svn_wc__get_pristine_contents_by_checksum(svn_stream_t **contents,
                                           svn_wc_context_t *wc_ctx,
@@ -1013,6 +1016,60 @@ svn_wc__get_pristine_contents_by_checksum(svn_stream_t **contents,
                                           apr_pool_t *result_pool,
                                           apr_pool_t *scratch_pool);
 
+/* The text delta of a working file, as handed out by
+   svn_wc__prepare_text_deltas(). */
+typedef struct svn_wc__prepared_delta_t svn_wc__prepared_delta_t;
+
+/* Callback type used by svn_wc__prepare_text_deltas() for the file with
+   index IDX.  DELTA may be passed to svn_wc__transmit_prepared_delta()
+   before this function returns and becomes invalid afterwards.  If the
+   delta could not be prepared, DELTA is NULL and ERR is the reason; this
+   function takes ownership of ERR.  Returning an error stops the
+   preparation of all remaining files. */
+typedef svn_error_t *(*svn_wc__prepared_delta_func_t)(
+  void *baton,
+  int idx,
+  svn_wc__prepared_delta_t *delta,
+  svn_error_t *err,
+  apr_pool_t *scratch_pool);
+
+/* Prepare the text deltas of the working files LOCAL_ABSPATHS (const
+   char *) for svn_wc__transmit_prepared_delta() and pass them to
+   DELTA_FUNC with DELTA_BATON, in order.  FULLTEXTS (svn_boolean_t) has
+   the same length and tells which files to send as fulltexts, like the
+   FULLTEXT argument of svn_wc_transmit_text_deltas3().
+
+   If the "commit-threads" option of the working copy configuration is
+   larger than 1, read, translate, checksum and delta the files on that
+   many threads ahead of DELTA_FUNC, keeping the results in spill
+   buffers.  Otherwise, nothing is done ahead of time and each delta is
+   computed while it is being sent.
+
+   DELTA_FUNC is always called in this thread, so the editor may be
+   driven from there as usual.  Use CANCEL_FUNC with CANCEL_BATON for
+   cancellation, and SCRATCH_POOL for temporary allocations.  */
+svn_error_t *
+svn_wc__prepare_text_deltas(svn_wc_context_t *wc_ctx,
+                            const apr_array_header_t *local_abspaths,
+                            const apr_array_header_t *fulltexts,
+                            svn_wc__prepared_delta_func_t delta_func,
+                            void *delta_baton,
+                            svn_cancel_func_t cancel_func,
+                            void *cancel_baton,
+                            apr_pool_t *scratch_pool);
+
+/* Like svn_wc_transmit_text_deltas3(), but send the text delta DELTA
+   handed out by svn_wc__prepare_text_deltas() to EDITOR and FILE_BATON. */
+svn_error_t *
+svn_wc__transmit_prepared_delta(
+  const svn_checksum_t **new_text_base_md5_checksum,
+  const svn_checksum_t **new_text_base_sha1_checksum,
+  svn_wc__prepared_delta_t *delta,
+  const svn_delta_editor_t *editor,
+  void *file_baton,
+  apr_pool_t *result_pool,
+  apr_pool_t *scratch_pool);
+
 /* Gets an array of const char *repos_relpaths of descendants of LOCAL_ABSPATH,
  * which must be the op root of an addition, copy or move. The descendants
  * returned are at the same op_depth, but are to be deleted by the commit
@@ -2086,6 +2143,79 @@ svn_wc__translated_stream(svn_stream_t **stream,
                           apr_pool_t *result_pool,
                           apr_pool_t *scratch_pool);
 
+/**
+ * @defgroup svn_wc__journal Working copy change journal
+ *
+ * A change journal records the paths below a working copy root that may
+ * have changed on disk.  It is written by an external file system monitor
+ * and allows svn_wc_walk_status() to check only the recorded paths instead
+ * of reading every directory and stat()ing every file.
+ *
+ * The monitor must record every path that is created, modified, deleted
+ * or renamed, and report every event it may have missed via
+ * svn_wc__journal_invalidate().  Status walks fall back to a full walk
+ * whenever the journal is missing, has been restarted or invalidated, or
+ * the monitor does not respond in time.
+ *
+ * @{
+ */
+
+/** Files created in the directory returned by svn_wc__journal_open()
+ * whose name starts with this prefix must be reported to
+ * svn_wc__journal_add_cookie() by the monitor. */
+#define SVN_WC__JOURNAL_COOKIE_PREFIX "cookie-"
+
+/** An open change journal. */
+typedef struct svn_wc__journal_t svn_wc__journal_t;
+
+/** Start a new change journal for the working copy rooted at
+ * WCROOT_ABSPATH and return it in *JOURNAL.  Set *MONITOR_ABSPATH to the
+ * directory within the administrative area that the monitor must watch
+ * for cookie files.
+ *
+ * Return SVN_ERR_WC_LOCKED if another monitor is already running for
+ * this working copy.
+ *
+ * The journal remains open until svn_wc__journal_close() is called or
+ * RESULT_POOL gets cleaned up.  Either way, the journal gets removed and
+ * the working copy is no longer considered monitored.
+ */
+svn_error_t *
+svn_wc__journal_open(svn_wc__journal_t **journal,
+                     const char **monitor_abspath,
+                     const char *wcroot_abspath,
+                     apr_pool_t *result_pool,
+                     apr_pool_t *scratch_pool);
+
+/** Record in JOURNAL that the node at LOCAL_RELPATH, relative to the
+ * working copy root, has been changed.  If LOCAL_RELPATH is a directory,
+ * everything below it is considered changed as well. */
+svn_error_t *
+svn_wc__journal_add_path(svn_wc__journal_t *journal,
+                         const char *local_relpath,
+                         apr_pool_t *scratch_pool);
+
+/** Record in JOURNAL that the monitor has seen the creation of the cookie
+ * file NAME, i.e. that all changes before that have been recorded. */
+svn_error_t *
+svn_wc__journal_add_cookie(svn_wc__journal_t *journal,
+                           const char *name,
+                           apr_pool_t *scratch_pool);
+
+/** Record in JOURNAL that changes may have been missed, e.g. because the
+ * monitor's event queue overflowed.  The next status walk will be a full
+ * walk. */
+svn_error_t *
+svn_wc__journal_invalidate(svn_wc__journal_t *journal,
+                           apr_pool_t *scratch_pool);
+
+/** Remove JOURNAL from the working copy and stop recording changes. */
+svn_error_t *
+svn_wc__journal_close(svn_wc__journal_t *journal,
+                      apr_pool_t *scratch_pool);
+
+/** @} */
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -112,6 +112,10 @@ typedef struct svn_config_t svn_config_t;
 #define SVN_CONFIG_OPTION_HTTP_MAX_CONNECTIONS      "http-max-connections"
 /** @since New in 1.9. */
 #define SVN_CONFIG_OPTION_HTTP_CHUNKED_REQUESTS     "http-chunked-requests"
+/** @since New in 1.10. */
+#define SVN_CONFIG_OPTION_HTTP_ADAPTIVE_CONNECTIONS "http-adaptive-connections"
+/** @since New in 1.10. */
+#define SVN_CONFIG_OPTION_HTTP_DECODE_THREADS       "http-decode-threads"
 
 /** @since New in 1.9. */
 #define SVN_CONFIG_OPTION_SERF_LOG_COMPONENTS       "serf-log-components"
@@ -171,6 +175,14 @@ typedef struct svn_config_t svn_config_t;
 #define SVN_CONFIG_OPTION_SQLITE_EXCLUSIVE_CLIENTS  "exclusive-locking-clients"
 /** @since New in 1.9. */
 #define SVN_CONFIG_OPTION_SQLITE_BUSY_TIMEOUT       "busy-timeout"
+/** @since New in 1.10. */
+#define SVN_CONFIG_OPTION_WC_INSTALL_THREADS        "install-threads"
+/** @since New in 1.10. */
+#define SVN_CONFIG_OPTION_WC_STATUS_THREADS         "status-threads"
+/** @since New in 1.10. */
+#define SVN_CONFIG_OPTION_WC_COMMIT_THREADS         "commit-threads"
+/** @since New in 1.10. */
+#define SVN_CONFIG_OPTION_WC_SHARED_PRISTINE_STORE  "shared-pristine-store"
 /** @} */
 
 /** @name Repository conf directory configuration files strings
@@ -522,7 +522,12 @@ svn_txdelta_apply(svn_stream_t *source,
  *
  * @since New in 1.7.  Since 1.10, @a svndiff_version can be 2 for the
  * svndiff2 format.  @a compression_level is currently ignored if
- * @a svndiff_version is set to 2.
+ * @a svndiff_version is set to 2.  Since 1.10, @a svndiff_version can
+ * also be 3 for the Zstandard based svndiff3 format, which is only
+ * available if Subversion has been built with zstd support.  In that
+ * case, @a compression_level is the zstd compression level, with 0
+ * disabling compression and levels beyond what zstd supports being
+ * reduced to its maximum.
  */
 void
 svn_txdelta_to_svndiff3(svn_txdelta_window_handler_t *handler,
@@ -166,6 +166,35 @@ typedef struct svn_fs_t svn_fs_t;
  */
 #define SVN_FS_CONFIG_FSFS_LOG_ADDRESSING       "fsfs-log-addressing"
 
+/** String with a decimal representation of the maximum number of threads
+ * that svn_fs_pack2() may use to pack FSFS shards concurrently.  Values
+ * of "1" or less make packing strictly sequential, which is also the
+ * default.
+ *
+ * When packing concurrently, the #svn_fs_pack_notify_start and
+ * #svn_fs_pack_notify_end notifications of a shard are both sent once its
+ * data has been packed, in shard order and from the calling thread.
+ *
+ * @note Using more than one thread requires the global cache settings to
+ * be thread-safe, see #svn_cache_config_t.
+ *
+ * @since New in 1.10.
+ */
+#define SVN_FS_CONFIG_FSFS_PACK_THREADS         "fsfs-pack-threads"
+
+/** Enable / disable caching of the deltas that svn_fs_get_file_delta_stream()
+ * computes between two file node revisions.  The cache is shared by all
+ * filesystems of the process and uses the global cache memory as set by
+ * svn_cache_config_set().  Caching is disabled by default.
+ *
+ * This option has no effect for filesystems that can't be told apart
+ * from a replacement with the same UUID, i.e. BDB and FSFS before
+ * format 7.
+ *
+ * @since New in 1.10.
+ */
+#define SVN_FS_CONFIG_CACHE_FILE_DELTAS         "fs-cache-file-deltas"
+
 /* Note to maintainers: if you add further SVN_FS_CONFIG_FSFS_CACHE_* knobs,
    update fs_fs.c:verify_as_revision_before_current_plus_plus(). */
 
@@ -2913,6 +2942,10 @@ svn_fs_change_rev_prop(svn_fs_t *fs,
  *
  * This function does not compare the two files' properties.
  *
+ * If #SVN_FS_CONFIG_CACHE_FILE_DELTAS has been enabled for the filesystem
+ * and both roots are revision roots, the delta may be served from or
+ * added to a process-wide cache.
+ *
  * Allocate @a *stream_p, and do any necessary temporary allocation, in
  * @a pool.
  */
@@ -3301,11 +3334,35 @@ typedef svn_error_t *(*svn_fs_pack_notify_t)(void *baton,
                                              apr_pool_t *pool);
 
 /**
- * Possibly update the filesystem located in the directory @a path
+ * Possibly update the filesystem located in the directory @a db_path
  * to use disk space more efficiently.
  *
+ * The @a fs_config hash is passed to the filesystem implementation and
+ * may be @c NULL.  It also controls backend-specific packing options such
+ * as #SVN_FS_CONFIG_FSFS_PACK_THREADS.
+ *
+ * If given, @a notify_func will be called with @a notify_baton to report
+ * progress.  Use optional @a cancel_func / @a cancel_baton for
+ * cancellation support.  Use @a scratch_pool for temporary allocations.
+ *
+ * @since New in 1.10.
+ */
+svn_error_t *
+svn_fs_pack2(const char *db_path,
+             apr_hash_t *fs_config,
+             svn_fs_pack_notify_t notify_func,
+             void *notify_baton,
+             svn_cancel_func_t cancel_func,
+             void *cancel_baton,
+             apr_pool_t *scratch_pool);
+
+/**
+ * Like svn_fs_pack2() but with @a fs_config always being @c NULL.
+ *
  * @since New in 1.6.
+ * @deprecated Provided for backward compatibility with the 1.9 API.
  */
+SVN_DEPRECATED
 svn_error_t *
 svn_fs_pack(const char *db_path,
             svn_fs_pack_notify_t notify_func,
@@ -1111,6 +1111,108 @@ svn_ra_get_dir2(svn_ra_session_t *session,
                 apr_uint32_t dirent_fields,
                 apr_pool_t *pool);
 
+/**
+ * Fetch the entries of all directories @a paths at @a revision, like
+ * svn_ra_get_dir2() does for a single directory.
+ *
+ * Set @a *dirents to a hash mapping each element of @a paths
+ * (<tt>const char *</tt>) to a hash of the directory's entries as
+ * returned in the @a dirents parameter of svn_ra_get_dir2().  @a paths
+ * are relative to the URL in @a session.  @a revision must be a valid
+ * revision number.  @a dirent_fields controls which portions of the
+ * <tt>@c svn_dirent_t</tt> objects are filled in.
+ *
+ * Depending on the RA layer, this may be much faster than calling
+ * svn_ra_get_dir2() for each path.  ra_svn, for instance, sends all
+ * requests without waiting for the responses to the previous ones.
+ *
+ * If any of the @a paths does not exist or is not a directory, return
+ * the same error as svn_ra_get_dir2() would.
+ *
+ * Allocate @a *dirents in @a result_pool and use @a scratch_pool for
+ * temporary allocations.
+ *
+ * @since New in 1.10.
+ */
+svn_error_t *
+svn_ra_get_dirs(svn_ra_session_t *session,
+                apr_hash_t **dirents,
+                const apr_array_header_t *paths,
+                svn_revnum_t revision,
+                apr_uint32_t dirent_fields,
+                apr_pool_t *result_pool,
+                apr_pool_t *scratch_pool);
+
+/**
+ * A file to fetch with svn_ra_get_files().
+ *
+ * @since New in 1.10.
+ */
+typedef struct svn_ra_file_target_t
+{
+  /** The path of the file, relative to the session URL. */
+  const char *path;
+
+  /** The revision to fetch, or #SVN_INVALID_REVNUM for HEAD. */
+  svn_revnum_t revision;
+} svn_ra_file_target_t;
+
+/**
+ * Callback type to be used with svn_ra_get_files().  It will be invoked
+ * once for each file, before its contents get sent.
+ *
+ * @a path is the path of the file as given in the respective
+ * #svn_ra_file_target_t and @a revision is the actual revision that is
+ * being fetched.  If properties were requested, @a props contains all
+ * of the file's properties as with svn_ra_get_file(); otherwise it is
+ * @c NULL.
+ *
+ * Set @a *stream to the stream that shall receive the file's contents
+ * or to @c NULL if they are not needed.  The stream will be closed once
+ * all contents have been written to it.  Allocate @a *stream in @a pool,
+ * which will be cleared after the file has been processed.
+ *
+ * The callback and the stream handlers may not perform any RA operations
+ * using the session that svn_ra_get_files() has been called for.
+ *
+ * @since New in 1.10.
+ */
+typedef svn_error_t *(* svn_ra_file_stream_func_t)(svn_stream_t **stream,
+                                                   void *baton,
+                                                   const char *path,
+                                                   svn_revnum_t revision,
+                                                   apr_hash_t *props,
+                                                   apr_pool_t *pool);
+
+/**
+ * Fetch the contents and, if @a want_props is set, the properties of all
+ * files in @a targets, like svn_ra_get_file() does for a single file.
+ * @a targets is an array of <tt>const svn_ra_file_target_t *</tt>.
+ *
+ * For each target, in the order given, call @a stream_func with
+ * @a stream_baton and push the file's contents into the stream it
+ * returns.
+ *
+ * Depending on the RA layer, this may be much faster than calling
+ * svn_ra_get_file() for each file.  Servers that support it stream all
+ * files back in a single response.  See #SVN_RA_CAPABILITY_GET_FILES.
+ *
+ * If any of the @a targets does not exist, is not a file or cannot be
+ * read, return the same error as svn_ra_get_file() would.  Files
+ * preceding that target may already have been passed to @a stream_func.
+ *
+ * Use @a scratch_pool for temporary allocations.
+ *
+ * @since New in 1.10.
+ */
+svn_error_t *
+svn_ra_get_files(svn_ra_session_t *session,
+                 const apr_array_header_t *targets,
+                 svn_boolean_t want_props,
+                 svn_ra_file_stream_func_t stream_func,
+                 void *stream_baton,
+                 apr_pool_t *scratch_pool);
+
 /**
  * Similar to @c svn_ra_get_dir2, but with @c SVN_DIRENT_ALL for the
  * @a dirent_fields parameter.
@@ -1890,6 +1992,66 @@ svn_ra_get_file_revs(svn_ra_session_t *session,
                      void *handler_baton,
                      apr_pool_t *pool);
 
+/**
+ * Callback type to be used with svn_ra_get_blame().  It will be invoked
+ * for every range of lines that has last been changed in the same
+ * revision.
+ *
+ * The lines from @a start_line up to but not including @a end_line have
+ * last been changed in @a revision.  Line numbers are zero-based.
+ * @a rev_props contains the #SVN_PROP_REVISION_AUTHOR and
+ * #SVN_PROP_REVISION_DATE properties of @a revision, if they are set and
+ * readable.  For lines that already existed before the start of the
+ * blamed revision range, @a revision is #SVN_INVALID_REVNUM and
+ * @a rev_props is @c NULL.
+ *
+ * @a baton is the user-provided receiver baton.  @a scratch_pool may be
+ * used for temporary allocations.
+ *
+ * @since New in 1.10.
+ */
+typedef svn_error_t *(* svn_ra_blame_receiver_t)(apr_int64_t start_line,
+                                                 apr_int64_t end_line,
+                                                 svn_revnum_t revision,
+                                                 apr_hash_t *rev_props,
+                                                 void *baton,
+                                                 apr_pool_t *scratch_pool);
+
+/**
+ * Let the server calculate the blame information for the file @a path
+ * within the revision range @a start to @a end.  Unlike
+ * svn_ra_get_file_revs2(), this transmits no file contents at all.
+ *
+ * Call @a receiver with @a receiver_baton for each range of consecutive
+ * lines in @a path at @a end that have last been changed in the same
+ * revision, in the order of the lines in the file.  Merge history is not
+ * taken into account.
+ *
+ * @a diff_options is an optional array of <tt>const char *</tt> that
+ * controls the line comparison.  It accepts the same options as
+ * svn_diff_file_options_parse().
+ *
+ * @a start must not be larger than @a end and both must be valid
+ * revision numbers.
+ *
+ * If the server doesn't support the 'get-blame' command, return
+ * @c SVN_ERR_UNSUPPORTED_FEATURE in preference to any other error that
+ * might otherwise be returned.
+ *
+ * Use @a scratch_pool for temporary memory allocation.
+ *
+ * @since New in 1.10.
+ */
+svn_error_t *
+svn_ra_get_blame(svn_ra_session_t *session,
+                 const char *path,
+                 svn_revnum_t start,
+                 svn_revnum_t end,
+                 const apr_array_header_t *diff_options,
+                 svn_ra_blame_receiver_t receiver,
+                 void *receiver_baton,
+                 apr_pool_t *scratch_pool);
+
 /**
  * Lock each path in @a path_revs, which is a hash whose keys are the
  * paths to be locked, and whose values are the corresponding base
@@ -2240,6 +2402,21 @@ svn_ra_has_capability(svn_ra_session_t *session,
  */
 #define SVN_RA_CAPABILITY_LIST "list"
 
+/**
+ * The capability of a server to calculate blame information itself.
+ *
+ * @since New in 1.10.
+ */
+#define SVN_RA_CAPABILITY_BLAME "blame"
+
+/**
+ * The capability of a server to send the contents of many files in
+ * a single response.
+ *
+ * @since New in 1.10.
+ */
+#define SVN_RA_CAPABILITY_GET_FILES "get-files"
+
 
 /*       *** PLEASE READ THIS IF YOU ADD A NEW CAPABILITY ***
  *
@@ -50,6 +50,8 @@ extern "C" {
 #define SVN_RA_SVN_CAP_EDIT_PIPELINE "edit-pipeline"
 #define SVN_RA_SVN_CAP_SVNDIFF1 "svndiff1"
 #define SVN_RA_SVN_CAP_SVNDIFF2_ACCEPTED "accepts-svndiff2"
+/* only advertised by builds that support zstd compression */
+#define SVN_RA_SVN_CAP_SVNDIFF3_ACCEPTED "accepts-svndiff3"
 #define SVN_RA_SVN_CAP_ABSENT_ENTRIES "absent-entries"
 /* maps to SVN_RA_CAPABILITY_COMMIT_REVPROPS: */
 #define SVN_RA_SVN_CAP_COMMIT_REVPROPS "commit-revprops"
@@ -71,6 +73,12 @@ extern "C" {
 #define SVN_RA_SVN_CAP_GET_FILE_REVS_REVERSE "file-revs-reverse"
 /* maps to SVN_RA_CAPABILITY_LIST */
 #define SVN_RA_SVN_CAP_LIST "list"
+/* maps to SVN_RA_CAPABILITY_BLAME */
+#define SVN_RA_SVN_CAP_BLAME "blame"
+/* maps to SVN_RA_CAPABILITY_GET_FILES */
+#define SVN_RA_SVN_CAP_GET_FILES "get-files"
+/* accepts begin-pipeline and end-pipeline commands */
+#define SVN_RA_SVN_CAP_PIPELINING "pipelining"
 
 
 /** ra_svn passes @c svn_dirent_t fields over the wire as a list of
@@ -250,7 +250,10 @@ typedef enum svn_repos_notify_action_t
   svn_repos_notify_pack_noop,
 
   /** The revision properties got set. @since New in 1.10. */
-  svn_repos_notify_load_revprop_set
+  svn_repos_notify_load_revprop_set,
+
+  /** A revision got added to the log index. @since New in 1.10. */
+  svn_repos_notify_log_index_rev
 } svn_repos_notify_action_t;
 
 /** The type of warning occurring.
@@ -730,6 +733,10 @@ svn_repos_hotcopy(const char *src_path,
  * Possibly update the repository, @a repos, to use a more efficient
  * filesystem representation.  Use @a pool for allocations.
  *
+ * The filesystem configuration that @a repos has been opened with will
+ * be passed on to svn_fs_pack2().  Thus, backend-specific options such as
+ * #SVN_FS_CONFIG_FSFS_PACK_THREADS can be set upon svn_repos_open3().
+ *
  * @since New in 1.7.
  */
 svn_error_t *
@@ -740,6 +747,34 @@ svn_repos_fs_pack2(svn_repos_t *repos,
                    void *cancel_baton,
                    apr_pool_t *pool);
 
+/**
+ * Bring the optional log index of @a repos up to date with its youngest
+ * revision, creating the index if it does not exist yet.
+ *
+ * The log index records which revisions changed which paths.  Once it
+ * exists, it will be used by svn_repos_get_logs5() and
+ * svn_repos_deleted_rev() instead of walking the filesystem history.
+ * svn_repos_fs_commit_txn() adds each new revision to an index that is
+ * up to date or only a few revisions behind.  Larger numbers of revisions
+ * added by other means, e.g. svn_repos_load_fs6(), leave the index behind
+ * until this function gets called again.
+ *
+ * If @a notify_func is not @c NULL, call it with @a notify_baton and a
+ * #svn_repos_notify_log_index_rev notification for every revision added
+ * to the index.  Check @a cancel_func with @a cancel_baton for
+ * cancellation between revisions.  Use @a scratch_pool for temporary
+ * allocations.
+ *
+ * @since New in 1.10.
+ */
+svn_error_t *
+svn_repos_build_log_index(svn_repos_t *repos,
+                          svn_repos_notify_func_t notify_func,
+                          void *notify_baton,
+                          svn_cancel_func_t cancel_func,
+                          void *cancel_baton,
+                          apr_pool_t *scratch_pool);
+
 /**
  * Similar to svn_repos_fs_pack2(), but with a #svn_fs_pack_notify_t instead
  * of a #svn_repos_notify_t.
@@ -1086,8 +1121,44 @@ svn_repos_hooks_setenv(svn_repos_t *repos,
  * than or equal to the depth of the working copy, then the editor
  * operations will affect only paths at or above @a depth.
  *
+ * If @a thread_count is larger than 1, use up to @a thread_count worker
+ * threads, each with its own filesystem instance, to compare the entries
+ * of larger directories and to prepare their property lists and text
+ * deltas ahead of the editor drive.  @a editor and @a authz_read_func
+ * will still only be called from the calling thread and the sequence of
+ * editor calls does not change.  Make sure that the caches used by the
+ * filesystem layer have been configured to be thread-safe; see
+ * svn_cache_config_set().
+ *
+ * @since New in 1.10.
+ */
+svn_error_t *
+svn_repos_begin_report4(void **report_baton,
+                        svn_revnum_t revnum,
+                        svn_repos_t *repos,
+                        const char *fs_base,
+                        const char *target,
+                        const char *tgt_path,
+                        svn_boolean_t text_deltas,
+                        svn_depth_t depth,
+                        svn_boolean_t ignore_ancestry,
+                        svn_boolean_t send_copyfrom_args,
+                        const svn_delta_editor_t *editor,
+                        void *edit_baton,
+                        svn_repos_authz_func_t authz_read_func,
+                        void *authz_read_baton,
+                        apr_size_t zero_copy_limit,
+                        int thread_count,
+                        apr_pool_t *pool);
+
+/**
+ * The same as svn_repos_begin_report4(), but with @a thread_count
+ * always passed as 1.
+ *
  * @since New in 1.8.
+ * @deprecated Provided for backward compatibility with the 1.9 API.
  */
+SVN_DEPRECATED
 svn_error_t *
 svn_repos_begin_report3(void **report_baton,
                         svn_revnum_t revnum,
@@ -2457,6 +2528,71 @@ svn_repos_get_file_revs(svn_repos_t *repos,
                         void *handler_baton,
                         apr_pool_t *pool);
 
+/**
+ * Callback type to be used with svn_repos_blame().  It will be invoked
+ * for every range of lines that has last been changed in the same
+ * revision.
+ *
+ * The lines from @a start_line up to but not including @a end_line have
+ * last been changed in @a revision.  Line numbers are zero-based.
+ * @a rev_props contains the #SVN_PROP_REVISION_AUTHOR and
+ * #SVN_PROP_REVISION_DATE properties of @a revision, if they are set.
+ * For lines that already existed before the start of the blamed revision
+ * range, @a revision is #SVN_INVALID_REVNUM and @a rev_props is @c NULL.
+ *
+ * @a baton is the user-provided receiver baton.  @a scratch_pool may be
+ * used for temporary allocations.
+ *
+ * @since New in 1.10.
+ */
+typedef svn_error_t *(* svn_repos_blame_receiver_t)(apr_int64_t start_line,
+                                                    apr_int64_t end_line,
+                                                    svn_revnum_t revision,
+                                                    apr_hash_t *rev_props,
+                                                    void *baton,
+                                                    apr_pool_t *scratch_pool);
+
+/**
+ * Calculate the blame information for the file @a path in @a repos
+ * within the revision range @a start to @a end without transmitting any
+ * file contents.
+ *
+ * For every line in the file at @a end, determine the last revision
+ * within that range that added or changed it.  Then call @a receiver
+ * with @a receiver_baton for each range of consecutive lines that have
+ * been changed in the same revision, in the order of the lines in the
+ * file.  The history of @a path gets traced the same way as by
+ * svn_repos_get_file_revs2() without @a include_merged_revisions.
+ *
+ * @a diff_options is an optional array of <tt>const char *</tt> that
+ * controls the line comparison.  It accepts the same options as
+ * svn_diff_file_options_parse().
+ *
+ * If optional @a authz_read_func is non-NULL, then use this function
+ * (along with optional @a authz_read_baton) to check the readability
+ * of the rev-path in each interesting revision encountered, with the
+ * same effect as in svn_repos_get_file_revs2().
+ *
+ * @a start must not be larger than @a end.  Cancellation support is
+ * provided in the usual way through the optional @a cancel_func and
+ * @a cancel_baton.  Use @a scratch_pool for temporary allocations.
+ *
+ * @since New in 1.10.
+ */
+svn_error_t *
+svn_repos_blame(svn_repos_t *repos,
+                const char *path,
+                svn_revnum_t start,
+                svn_revnum_t end,
+                const apr_array_header_t *diff_options,
+                svn_repos_authz_func_t authz_read_func,
+                void *authz_read_baton,
+                svn_repos_blame_receiver_t receiver,
+                void *receiver_baton,
+                svn_cancel_func_t cancel_func,
+                void *cancel_baton,
+                apr_pool_t *scratch_pool);
+
 
 /* ---------------------------------------------------------------*/
 
@@ -3131,10 +3267,10 @@ enum svn_repos_load_uuid
   svn_repos_load_uuid_force
 };
 
-/** Callback type for use with svn_repos_verify_fs3().  @a revision
+/** Callback type for use with svn_repos_verify_fs4().  @a revision
  * and @a verify_err are the details of a single verification failure
- * that occurred during the svn_repos_verify_fs3() call.  @a baton is
- * the same baton given to svn_repos_verify_fs3().  @a scratch_pool is
+ * that occurred during the svn_repos_verify_fs4() call.  @a baton is
+ * the same baton given to svn_repos_verify_fs4().  @a scratch_pool is
  * provided for the convenience of the implementor, who should not
  * expect it to live longer than a single callback call.
  *
@@ -3144,7 +3280,7 @@ enum svn_repos_load_uuid
  * should also call svn_error_dup() for @a verify_err.  Implementors of this
  * callback are forbidden to call svn_error_clear() for @a verify_err.
  *
- * @see svn_repos_verify_fs3
+ * @see svn_repos_verify_fs4
  *
  * @since New in 1.9.
  */
@@ -3213,6 +3349,17 @@ typedef svn_error_t *(*svn_repos_verify_callback_t)(void *baton,
  *            called has reached its end and is about to return?
  *        ### Not sent, currently, if a FS structure error is found.
  *
+ * If @a thread_count is larger than 1, split the work into independent
+ * tasks - the metadata checks of each shard and the contents checks of
+ * each revision - and run them on up to @a thread_count worker threads,
+ * each using its own filesystem instance.  Notifications and errors are
+ * still reported from the calling thread and in the same order as with
+ * sequential verification.  However, metadata checks will continue with
+ * the next shard after a failure, i.e. @a verify_callback may be called
+ * more than once for #SVN_INVALID_REVNUM.  Make sure that the caches used
+ * by the filesystem layer have been configured to be thread-safe; see
+ * svn_cache_config_set().
+ *
  * If @a cancel_func is not @c NULL, call it periodically with @a
  * cancel_baton as argument to see if the caller wishes to cancel the
  * verification.
@@ -3221,8 +3368,30 @@ typedef svn_error_t *(*svn_repos_verify_callback_t)(void *baton,
  *
  * @see svn_repos_verify_callback_t
  *
+ * @since New in 1.10.
+ */
+svn_error_t *
+svn_repos_verify_fs4(svn_repos_t *repos,
+                     svn_revnum_t start_rev,
+                     svn_revnum_t end_rev,
+                     svn_boolean_t check_normalization,
+                     svn_boolean_t metadata_only,
+                     int thread_count,
+                     svn_repos_notify_func_t notify_func,
+                     void *notify_baton,
+                     svn_repos_verify_callback_t verify_callback,
+                     void *verify_baton,
+                     svn_cancel_func_t cancel,
+                     void *cancel_baton,
+                     apr_pool_t *scratch_pool);
+
+/**
+ * Like svn_repos_verify_fs4(), but with @a thread_count set to 1.
+ *
  * @since New in 1.9.
+ * @deprecated Provided for backward compatibility with the 1.9 API.
  */
+SVN_DEPRECATED
 svn_error_t *
 svn_repos_verify_fs3(svn_repos_t *repos,
                      svn_revnum_t start_rev,
@@ -3280,7 +3449,7 @@ svn_repos_verify_fs(svn_repos_t *repos,
  * Dump the contents of the filesystem within already-open @a repos into
  * writable @a dumpstream.  If @a dumpstream is
  * @c NULL, this is effectively a primitive verify.  It is not complete,
- * however; see instead svn_repos_verify_fs3().
+ * however; see instead svn_repos_verify_fs4().
  *
  * Begin at revision @a start_rev, and dump every revision up through
  * @a end_rev.  If @a start_rev is #SVN_INVALID_REVNUM, start at revision
@@ -3331,6 +3500,15 @@ svn_repos_verify_fs(svn_repos_t *repos,
  * If @a filter_func is not @c NULL, it is called for each node being
  * dumped, allowing the caller to exclude it from dump.
  *
+ * If @a thread_count is larger than 1, dump up to @a thread_count
+ * revisions concurrently, each using its own filesystem instance.  The
+ * dump data of every revision is buffered in memory and temporary files
+ * until all previous revisions have been written, so the output as well
+ * as the notifications will be the same as with a sequential dump.  In
+ * that case, @a filter_func may be called from any thread and must be
+ * thread-safe.  Make sure that the caches used by the filesystem layer
+ * have been configured to be thread-safe; see svn_cache_config_set().
+ *
  * If @a cancel_func is not @c NULL, it is called periodically with
  * @a cancel_baton as argument to see if the client wishes to cancel
  * the dump.
@@ -3352,14 +3530,15 @@ svn_repos_dump_fs4(svn_repos_t *repos,
                    void *notify_baton,
                    svn_repos_dump_filter_func_t filter_func,
                    void *filter_baton,
+                   int thread_count,
                    svn_cancel_func_t cancel_func,
                    void *cancel_baton,
                    apr_pool_t *pool);
 
 /**
  * Similar to svn_repos_dump_fs4(), but with @a include_revprops and 
- * @a include_changes both set to @c TRUE and @a filter_func and
- * @a filter_baton set to @c NULL.
+ * @a include_changes both set to @c TRUE, @a filter_func and
+ * @a filter_baton set to @c NULL and @a thread_count set to 1.
  *
  * @since New in 1.7.
  * @deprecated Provided for backward compatibility with the 1.9 API.
@@ -3469,6 +3648,14 @@ svn_repos_dump_fs(svn_repos_t *repos,
  * @note The details or the performed normalizations are deliberately
  * left unspecified and may change in the future.
  *
+ * If @a thread_count is larger than 1, reconstruct the file contents
+ * from the text deltas in @a dumpstream and verify their checksums on up
+ * to @a thread_count worker threads, each using its own filesystem
+ * instance, while the stream is still being parsed.  The revisions are
+ * still committed one after the other and in stream order.  Make sure
+ * that the caches used by the filesystem layer have been configured to
+ * be thread-safe; see svn_cache_config_set().
+ *
  * If non-NULL, use @a notify_func and @a notify_baton to send notification
  * of events to the caller.
  *
@@ -3490,6 +3677,7 @@ svn_repos_load_fs6(svn_repos_t *repos,
                    svn_boolean_t validate_props,
                    svn_boolean_t ignore_dates,
                    svn_boolean_t normalize_props,
+                   int thread_count,
                    svn_repos_notify_func_t notify_func,
                    void *notify_baton,
                    svn_cancel_func_t cancel_func,
@@ -3498,7 +3686,7 @@ svn_repos_load_fs6(svn_repos_t *repos,
 
 /**
  * Similar to svn_repos_load_fs6(), but with the @a normalize_props
- * parameter always set to @c FALSE.
+ * parameter always set to @c FALSE and @a thread_count set to 1.
  *
  * @since New in 1.9.
  * @deprecated Provided for backward compatibility with the 1.9 API.
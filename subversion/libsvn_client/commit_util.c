@@ -1834,6 +1834,71 @@ fixup_error:
                                             err, ctx, pool));
 }
 
+/* Baton for transmit_text_delta(). */
+struct transmit_baton
+{
+  const apr_array_header_t *file_mods; /* struct file_mod_t * */
+  const svn_delta_editor_t *editor;    /* commit editor */
+  const char *notify_path_prefix;      /* notification path prefix */
+  const char *base_url;                /* The session url for the commit */
+  apr_hash_t *sha1_checksums;          /* new text base checksums, or NULL */
+  svn_client_ctx_t *ctx;               /* client context baton */
+  apr_pool_t *result_pool;             /* for SHA1_CHECKSUMS */
+};
+
+/* Transmit DELTA, the text delta of the IDX-th file in the
+   struct transmit_baton BATON->file_mods, or report ERR if that could not
+   be prepared.
+
+   This implements svn_wc__prepared_delta_func_t. */
+static svn_error_t *
+transmit_text_delta(void *baton,
+                    int idx,
+                    svn_wc__prepared_delta_t *delta,
+                    svn_error_t *err,
+                    apr_pool_t *scratch_pool)
+{
+  struct transmit_baton *tb = baton;
+  struct file_mod_t *mod = APR_ARRAY_IDX(tb->file_mods, idx,
+                                         struct file_mod_t *);
+  const svn_client_commit_item3_t *item = mod->item;
+  svn_client_ctx_t *ctx = tb->ctx;
+  const svn_checksum_t *new_text_base_md5_checksum;
+  const svn_checksum_t *new_text_base_sha1_checksum;
+
+  if (ctx->notify_func2)
+    {
+      svn_wc_notify_t *notify;
+      notify = svn_wc_create_notify(item->path,
+                                    svn_wc_notify_commit_postfix_txdelta,
+                                    scratch_pool);
+      notify->kind = svn_node_file;
+      notify->path_prefix = tb->notify_path_prefix;
+      ctx->notify_func2(ctx->notify_baton2, notify, scratch_pool);
+    }
+
+  if (! err)
+    err = svn_wc__transmit_prepared_delta(&new_text_base_md5_checksum,
+                                          &new_text_base_sha1_checksum,
+                                          delta, tb->editor,
+                                          mod->file_baton,
+                                          tb->result_pool, scratch_pool);
+
+  if (err)
+    return svn_error_trace(fixup_commit_error(item->path,
+                                              tb->base_url,
+                                              item->session_relpath,
+                                              svn_node_file,
+                                              err, ctx, scratch_pool));
+
+  if (tb->sha1_checksums)
+    svn_hash_sets(tb->sha1_checksums, item->path,
+                  new_text_base_sha1_checksum);
+
+  svn_pool_destroy(mod->file_pool);
+  return SVN_NO_ERROR;
+}
+
 svn_error_t *
 svn_client__do_commit(const char *base_url,
                       const apr_array_header_t *commit_items,
@@ -1847,10 +1912,13 @@ svn_client__do_commit(const char *base_url,
 {
   apr_hash_t *file_mods = apr_hash_make(scratch_pool);
   apr_hash_t *items_hash = apr_hash_make(scratch_pool);
-  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
   apr_hash_index_t *hi;
   int i;
   struct item_commit_baton cb_baton;
+  struct transmit_baton tb;
+  apr_array_header_t *mods;
+  apr_array_header_t *local_abspaths;
+  apr_array_header_t *fulltexts;
   apr_array_header_t *paths =
     apr_array_make(scratch_pool, commit_items->nelts, sizeof(const char *));
 
@@ -1883,73 +1951,52 @@ svn_client__do_commit(const char *base_url,
   SVN_ERR(svn_delta_path_driver2(editor, edit_baton, paths, TRUE,
                                  do_item_commit, &cb_baton, scratch_pool));
 
-  /* Transmit outstanding text deltas. */
+  /* Transmit outstanding text deltas.  Their preparation may run ahead
+     on other threads, but the editor is only driven from this one. */
+  mods = apr_array_make(scratch_pool, apr_hash_count(file_mods),
+                        sizeof(struct file_mod_t *));
+  local_abspaths = apr_array_make(scratch_pool, apr_hash_count(file_mods),
+                                  sizeof(const char *));
+  fulltexts = apr_array_make(scratch_pool, apr_hash_count(file_mods),
+                             sizeof(svn_boolean_t));
   for (hi = apr_hash_first(scratch_pool, file_mods);
        hi;
        hi = apr_hash_next(hi))
     {
       struct file_mod_t *mod = apr_hash_this_val(hi);
       const svn_client_commit_item3_t *item = mod->item;
-      const svn_checksum_t *new_text_base_md5_checksum;
-      const svn_checksum_t *new_text_base_sha1_checksum;
-      svn_boolean_t fulltext = FALSE;
-      svn_error_t *err;
-
-      svn_pool_clear(iterpool);
 
-      /* Transmit the entry. */
-      if (ctx->cancel_func)
-        SVN_ERR(ctx->cancel_func(ctx->cancel_baton));
-
-      if (ctx->notify_func2)
-        {
-          svn_wc_notify_t *notify;
-          notify = svn_wc_create_notify(item->path,
-                                        svn_wc_notify_commit_postfix_txdelta,
-                                        iterpool);
-          notify->kind = svn_node_file;
-          notify->path_prefix = notify_path_prefix;
-          ctx->notify_func2(ctx->notify_baton2, notify, iterpool);
-        }
+      APR_ARRAY_PUSH(mods, struct file_mod_t *) = mod;
+      APR_ARRAY_PUSH(local_abspaths, const char *) = item->path;
 
       /* If the node has no history, transmit full text */
-      if ((item->state_flags & SVN_CLIENT_COMMIT_ITEM_ADD)
-          && ! (item->state_flags & SVN_CLIENT_COMMIT_ITEM_IS_COPY))
-        fulltext = TRUE;
-
-      err = svn_wc_transmit_text_deltas3(&new_text_base_md5_checksum,
-                                         &new_text_base_sha1_checksum,
-                                         ctx->wc_ctx, item->path,
-                                         fulltext, editor, mod->file_baton,
-                                         result_pool, iterpool);
-
-      if (err)
-        {
-          svn_pool_destroy(iterpool); /* Close tempfiles */
-          return svn_error_trace(fixup_commit_error(item->path,
-                                                    base_url,
-                                                    item->session_relpath,
-                                                    svn_node_file,
-                                                    err, ctx, scratch_pool));
-        }
-
-      if (sha1_checksums)
-        svn_hash_sets(*sha1_checksums, item->path, new_text_base_sha1_checksum);
-
-      svn_pool_destroy(mod->file_pool);
+      APR_ARRAY_PUSH(fulltexts, svn_boolean_t)
+        = ((item->state_flags & SVN_CLIENT_COMMIT_ITEM_ADD)
+           && ! (item->state_flags & SVN_CLIENT_COMMIT_ITEM_IS_COPY));
     }
 
+  tb.file_mods = mods;
+  tb.editor = editor;
+  tb.notify_path_prefix = notify_path_prefix;
+  tb.base_url = base_url;
+  tb.sha1_checksums = sha1_checksums ? *sha1_checksums : NULL;
+  tb.ctx = ctx;
+  tb.result_pool = result_pool;
+
+  SVN_ERR(svn_wc__prepare_text_deltas(ctx->wc_ctx, local_abspaths, fulltexts,
+                                      transmit_text_delta, &tb,
+                                      ctx->cancel_func, ctx->cancel_baton,
+                                      scratch_pool));
+
   if (ctx->notify_func2)
     {
       svn_wc_notify_t *notify;
       notify = svn_wc_create_notify_url(base_url,
                                         svn_wc_notify_commit_finalizing,
-                                        iterpool);
-      ctx->notify_func2(ctx->notify_baton2, notify, iterpool);
+                                        scratch_pool);
+      ctx->notify_func2(ctx->notify_baton2, notify, scratch_pool);
     }
 
-  svn_pool_destroy(iterpool);
-
   /* Close the edit. */
   return svn_error_trace(editor->close_edit(edit_baton, scratch_pool));
 }
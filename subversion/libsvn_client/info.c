@@ -179,11 +179,18 @@ build_info_from_dirent(svn_client_info2_t **info,
    svn_depth_files, then invoke RECEIVER on file children of DIR but
    not on subdirectories; if svn_depth_infinity, recurse fully.
    DIR is a relpath, relative to the root of RA_SESSION.
+
+   If DIRENTS is not NULL, it contains the entries of DIR as returned by
+   svn_ra_get_dir2 and DIR will not be fetched again.  With
+   svn_depth_infinity, fetch the entries of all subdirectories of DIR
+   with a single call to svn_ra_get_dirs, which allows the RA layer to
+   save round trips.
 */
 static svn_error_t *
 push_dir_info(svn_ra_session_t *ra_session,
               const svn_client__pathrev_t *pathrev,
               const char *dir,
+              apr_hash_t *dirents,
               svn_client_info_receiver2_t receiver,
               void *receiver_baton,
               svn_depth_t depth,
@@ -191,14 +198,34 @@ push_dir_info(svn_ra_session_t *ra_session,
               apr_hash_t *locks,
               apr_pool_t *pool)
 {
-  apr_hash_t *tmpdirents;
+  apr_hash_t *subdirents = NULL;
   apr_hash_index_t *hi;
   apr_pool_t *subpool = svn_pool_create(pool);
 
-  SVN_ERR(svn_ra_get_dir2(ra_session, &tmpdirents, NULL, NULL,
-                          dir, pathrev->rev, DIRENT_FIELDS, pool));
+  if (! dirents)
+    SVN_ERR(svn_ra_get_dir2(ra_session, &dirents, NULL, NULL,
+                            dir, pathrev->rev, DIRENT_FIELDS, pool));
+
+  if (depth == svn_depth_infinity)
+    {
+      apr_array_header_t *subdirs = apr_array_make(pool, 0,
+                                                    sizeof(const char *));
+
+      for (hi = apr_hash_first(pool, dirents); hi; hi = apr_hash_next(hi))
+        {
+          const svn_dirent_t *the_ent = apr_hash_this_val(hi);
+
+          if (the_ent->kind == svn_node_dir)
+            APR_ARRAY_PUSH(subdirs, const char *)
+              = svn_relpath_join(dir, apr_hash_this_key(hi), pool);
+        }
+
+      if (subdirs->nelts)
+        SVN_ERR(svn_ra_get_dirs(ra_session, &subdirents, subdirs,
+                                pathrev->rev, DIRENT_FIELDS, pool, pool));
+    }
 
-  for (hi = apr_hash_first(pool, tmpdirents); hi; hi = apr_hash_next(hi))
+  for (hi = apr_hash_first(pool, dirents); hi; hi = apr_hash_next(hi))
     {
       const char *path, *fs_path;
       svn_lock_t *lock;
@@ -230,6 +257,7 @@ push_dir_info(svn_ra_session_t *ra_session,
       if (depth == svn_depth_infinity && the_ent->kind == svn_node_dir)
         {
           SVN_ERR(push_dir_info(ra_session, child_pathrev, path,
+                                svn_hash_gets(subdirents, path),
                                 receiver, receiver_baton,
                                 depth, ctx, locks, subpool));
         }
@@ -452,7 +480,7 @@ svn_client_info4(const char *abspath_or_url,
       else
         locks = apr_hash_make(pool); /* use an empty hash */
 
-      SVN_ERR(push_dir_info(ra_session, pathrev, "",
+      SVN_ERR(push_dir_info(ra_session, pathrev, "", NULL,
                             receiver, receiver_baton,
                             depth, ctx, locks, pool));
     }
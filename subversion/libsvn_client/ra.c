@@ -257,12 +257,8 @@ get_wc_contents(void *baton,
 {
   callback_baton_t *cb = baton;
 
-  if (! cb->wcroot_abspath)
-    {
-      *contents = NULL;
-      return SVN_NO_ERROR;
-    }
-
+  /* Without a working copy (e.g. while checking out), we can still find
+     the contents in the shared pristine store, if there is one. */
   return svn_error_trace(
              svn_wc__get_pristine_contents_by_checksum(contents,
                                                        cb->ctx->wc_ctx,
@@ -352,8 +348,7 @@ svn_client__open_ra_session_internal(svn_ra_session_t **ra_session,
   cbtable->progress_baton = cb;
   cbtable->cancel_func = ctx->cancel_func ? cancel_callback : NULL;
   cbtable->get_client_string = get_client_string;
-  if (base_dir_abspath)
-    cbtable->get_wc_contents = get_wc_contents;
+  cbtable->get_wc_contents = get_wc_contents;
   cbtable->check_tunnel_func = ctx->check_tunnel_func;
   cbtable->open_tunnel_func = ctx->open_tunnel_func;
   cbtable->tunnel_baton = ctx->tunnel_baton;
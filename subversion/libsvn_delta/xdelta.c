@@ -31,6 +31,19 @@
 #include "svn_delta.h"
 #include "private/svn_string_private.h"
 #include "delta.h"
+
+/* Checksum 16 bytes at a time using vector instructions where they are
+ * part of the baseline instruction set, i.e. need no runtime checks:
+ * SSE2 on x64 and NEON on AArch64.
+ */
+#if defined(__SSE2__) || defined(_M_X64) \
+    || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  include <emmintrin.h>
+#  define SVN_XDELTA_SSE2 1
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#  include <arm_neon.h>
+#  define SVN_XDELTA_NEON 1
+#endif
 
 /* This is pseudo-adler32. It is adler32 without the prime modulus.
    The idea is borrowed from monotone, and is a translation of the C++
@@ -76,6 +89,16 @@ adler32_replace(apr_uint32_t adler32, const char c_out, const char c_in)
   return adler32 + adler32 * 0x10000;
 }
 
+#if defined(SVN_XDELTA_SSE2) || defined(SVN_XDELTA_NEON)
+
+/* The factors by which the first 16 bytes of a block contribute to the
+   s2 part of the checksum.  For every further 16 bytes, they decrease
+   by 16. */
+static const apr_int16_t adler32_weights[16]
+  = { 64, 63, 62, 61, 60, 59, 58, 57, 56, 55, 54, 53, 52, 51, 50, 49 };
+
+#endif
+
 /* Calculate an pseudo-adler32 checksum for MATCH_BLOCKSIZE bytes starting
    at DATA.  Return the checksum value.  */
 
@@ -88,6 +111,70 @@ init_adler32(const char *data)
   apr_uint32_t s1 = 0;
   apr_uint32_t s2 = 0;
 
+#if defined(SVN_XDELTA_SSE2)
+
+  /* S1 is the plain sum over all bytes while every byte contributes to
+     S2 once for itself and each of the following bytes in the block. */
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i step = _mm_set1_epi16(16);
+  __m128i weights_lo = _mm_loadu_si128((const __m128i *)adler32_weights);
+  __m128i weights_hi = _mm_loadu_si128((const __m128i *)adler32_weights + 1);
+  __m128i sum1 = zero;
+  __m128i sum2 = zero;
+
+  for (; input < last; input += 16)
+    {
+      __m128i bytes = _mm_loadu_si128((const __m128i *)input);
+
+      sum1 = _mm_add_epi32(sum1, _mm_sad_epu8(bytes, zero));
+      sum2 = _mm_add_epi32(sum2,
+                           _mm_madd_epi16(_mm_unpacklo_epi8(bytes, zero),
+                                          weights_lo));
+      sum2 = _mm_add_epi32(sum2,
+                           _mm_madd_epi16(_mm_unpackhi_epi8(bytes, zero),
+                                          weights_hi));
+
+      weights_lo = _mm_sub_epi16(weights_lo, step);
+      weights_hi = _mm_sub_epi16(weights_hi, step);
+    }
+
+  sum1 = _mm_add_epi32(sum1, _mm_srli_si128(sum1, 8));
+  sum2 = _mm_add_epi32(sum2, _mm_srli_si128(sum2, 8));
+  sum2 = _mm_add_epi32(sum2, _mm_srli_si128(sum2, 4));
+
+  s1 = (apr_uint32_t)_mm_cvtsi128_si32(sum1);
+  s2 = (apr_uint32_t)_mm_cvtsi128_si32(sum2);
+
+#elif defined(SVN_XDELTA_NEON)
+
+  /* Same as above. */
+  const uint16x8_t step = vdupq_n_u16(16);
+  uint16x8_t weights_lo = vld1q_u16((const uint16_t *)adler32_weights);
+  uint16x8_t weights_hi = vld1q_u16((const uint16_t *)adler32_weights + 8);
+  uint16x8_t sum1 = vdupq_n_u16(0);
+  uint32x4_t sum2 = vdupq_n_u32(0);
+
+  for (; input < last; input += 16)
+    {
+      uint8x16_t bytes = vld1q_u8(input);
+      uint16x8_t lo = vmovl_u8(vget_low_u8(bytes));
+      uint16x8_t hi = vmovl_u8(vget_high_u8(bytes));
+
+      sum1 = vpadalq_u8(sum1, bytes);
+      sum2 = vmlal_u16(sum2, vget_low_u16(lo), vget_low_u16(weights_lo));
+      sum2 = vmlal_u16(sum2, vget_high_u16(lo), vget_high_u16(weights_lo));
+      sum2 = vmlal_u16(sum2, vget_low_u16(hi), vget_low_u16(weights_hi));
+      sum2 = vmlal_u16(sum2, vget_high_u16(hi), vget_high_u16(weights_hi));
+
+      weights_lo = vsubq_u16(weights_lo, step);
+      weights_hi = vsubq_u16(weights_hi, step);
+    }
+
+  s1 = vaddvq_u16(sum1);
+  s2 = vaddvq_u32(sum2);
+
+#else
+
   for (; input < last; input += 8)
     {
       s1 += input[0]; s2 += s1;
@@ -100,6 +187,8 @@ init_adler32(const char *data)
       s1 += input[7]; s2 += s1;
     }
 
+#endif
+
   return s2 * 0x10000 + s1;
 }
 
@@ -278,7 +367,7 @@ find_match(const struct blocks *blocks,
            apr_size_t pending_insert_start)
 {
   apr_size_t apos, bpos = *bposp;
-  apr_size_t delta, max_delta;
+  apr_size_t delta, max_delta, max_back, back;
 
   apos = find_block(blocks, rolling, b + bpos);
 
@@ -296,12 +385,13 @@ find_match(const struct blocks *blocks,
 
   /* See if we can extend backwards (max MATCH_BLOCKSIZE-1 steps because A's
      content has been sampled only every MATCH_BLOCKSIZE positions).  */
-  while (apos > 0 && bpos > pending_insert_start && a[apos-1] == b[bpos-1])
-    {
-      --apos;
-      --bpos;
-      ++delta;
-    }
+  max_back = apos < bpos - pending_insert_start
+           ? apos
+           : bpos - pending_insert_start;
+  back = svn_cstring__reverse_match_length(a + apos, b + bpos, max_back);
+  apos -= back;
+  bpos -= back;
+  delta += back;
 
   *aposp = apos;
   *bposp = bpos;
@@ -41,8 +41,10 @@
 #include "svn_pools.h"
 #include "svn_string.h"
 #include "svn_sorts.h"
+#include "svn_delta.h"
 
 #include "private/svn_atomic.h"
+#include "private/svn_cache.h"
 #include "private/svn_fs_private.h"
 #include "private/svn_fs_util.h"
 #include "private/svn_fspath.h"
@@ -710,22 +712,23 @@ svn_fs_hotcopy3(const char *src_path, const char *dst_path,
 }
 
 svn_error_t *
-svn_fs_pack(const char *path,
-            svn_fs_pack_notify_t notify_func,
-            void *notify_baton,
-            svn_cancel_func_t cancel_func,
-            void *cancel_baton,
-            apr_pool_t *pool)
+svn_fs_pack2(const char *path,
+             apr_hash_t *fs_config,
+             svn_fs_pack_notify_t notify_func,
+             void *notify_baton,
+             svn_cancel_func_t cancel_func,
+             void *cancel_baton,
+             apr_pool_t *scratch_pool)
 {
   fs_library_vtable_t *vtable;
   svn_fs_t *fs;
 
-  SVN_ERR(fs_library_vtable(&vtable, path, pool));
-  fs = fs_new(NULL, pool);
+  SVN_ERR(fs_library_vtable(&vtable, path, scratch_pool));
+  fs = fs_new(fs_config, scratch_pool);
 
   SVN_ERR(vtable->pack_fs(fs, path, notify_func, notify_baton,
                           cancel_func, cancel_baton, common_pool_lock,
-                          pool, common_pool));
+                          scratch_pool, common_pool));
   return SVN_NO_ERROR;
 }
 
@@ -1564,6 +1567,30 @@ svn_fs_try_process_file_contents(svn_boolean_t *success,
                          processor, baton, pool));
 }
 
+svn_error_t *
+svn_fs__file_contents_range(apr_file_t **file,
+                            apr_off_t *offset,
+                            svn_filesize_t *length,
+                            svn_fs_root_t *root,
+                            const char *path,
+                            apr_pool_t *result_pool,
+                            apr_pool_t *scratch_pool)
+{
+  /* if the FS doesn't implement this function, the contents are not
+     available as a plain byte range */
+  if (root->vtable->file_contents_range == NULL)
+    {
+      *file = NULL;
+      return SVN_NO_ERROR;
+    }
+
+  return svn_error_trace(root->vtable->file_contents_range(file, offset,
+                                                           length,
+                                                           root, path,
+                                                           result_pool,
+                                                           scratch_pool));
+}
+
 svn_error_t *
 svn_fs_make_file(svn_fs_root_t *root, const char *path, apr_pool_t *pool)
 {
@@ -1715,6 +1742,261 @@ svn_fs_change_rev_prop2(svn_fs_t *fs, svn_revnum_t rev, const char *name,
                                                      value, pool));
 }
 
+/* Computed file deltas.
+ *
+ * Many clients tend to request the very same delta between two node
+ * revisions, e.g. when they all update their working copies after a
+ * commit.  Keep the encoded deltas in the global membuffer cache so that
+ * only the first request has to reconstruct both texts and compute the
+ * delta.
+ */
+
+/* The svndiff format version that cached deltas are encoded in.  Version
+   0 is the fastest to encode and decode, which matters more here than
+   the memory savings of compression. */
+#define DELTA_CACHE_SVNDIFF_VERSION 0
+
+/* The process-wide delta cache.  NULL if caching is not available. */
+static svn_cache__t *delta_cache = NULL;
+static svn_atomic_t delta_cache_initialized = FALSE;
+
+/* Implements svn_atomic__err_init_func_t.  Create DELTA_CACHE in the
+   global membuffer cache, if there is one. */
+static svn_error_t *
+initialize_delta_cache(void *baton,
+                       apr_pool_t *pool)
+{
+  svn_membuffer_t *membuffer = svn_cache__get_global_membuffer_cache();
+
+  if (membuffer)
+    {
+      /* Deltas can easily be computed again and must not push out the
+         FS backends' cached data.  Hence the low priority. */
+      SVN_ERR(svn_cache__create_membuffer_cache(&delta_cache, membuffer,
+                                                NULL, NULL,
+                                                APR_HASH_KEY_STRING,
+                                                "fs-file-deltas:",
+                                                SVN_CACHE__MEMBUFFER_LOW_PRIORITY,
+                                                TRUE, FALSE,
+                                                svn_pool_create(NULL),
+                                                pool));
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Set *CACHE to the process-wide delta cache or to NULL if there is none.
+   Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+get_delta_cache(svn_cache__t **cache,
+                apr_pool_t *scratch_pool)
+{
+  SVN_ERR(svn_atomic__init_once(&delta_cache_initialized,
+                                initialize_delta_cache, NULL,
+                                scratch_pool));
+  *cache = delta_cache;
+
+  return SVN_NO_ERROR;
+}
+
+/* Set *KEY to the delta cache key for the delta from SOURCE_PATH under
+   SOURCE_ROOT to TARGET_PATH under TARGET_ROOT.  Set it to NULL if that
+   delta cannot be cached, e.g. because one of the nodes is mutable.
+   Allocate the result in POOL. */
+static svn_error_t *
+make_delta_cache_key(const char **key,
+                     svn_fs_root_t *source_root,
+                     const char *source_path,
+                     svn_fs_root_t *target_root,
+                     const char *target_path,
+                     apr_pool_t *pool)
+{
+  svn_fs_t *fs = target_root->fs;
+  const svn_fs_id_t *source_id;
+  const svn_fs_id_t *target_id;
+  const char *uuid;
+  const char *instance_id = NULL;
+
+  *key = NULL;
+  if (   !source_root
+      || !svn_fs_is_revision_root(source_root)
+      || !svn_fs_is_revision_root(target_root)
+      || source_root->fs != fs)
+    return SVN_NO_ERROR;
+
+  /* Node revision IDs are unique within a repository only.  Neither the
+     UUID nor the path tell a repository from one that replaced it, e.g.
+     after a dump / load cycle, but the instance ID does.  Without one,
+     don't cache at all. */
+  if (fs->vtable->get_instance_id)
+    SVN_ERR(fs->vtable->get_instance_id(&instance_id, fs, pool));
+  if (!instance_id)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_fs_node_id(&source_id, source_root, source_path, pool));
+  SVN_ERR(svn_fs_node_id(&target_id, target_root, target_path, pool));
+  SVN_ERR(svn_fs_get_uuid(fs, &uuid, pool));
+
+  *key = apr_psprintf(pool, "%s:%s:%s:%d:%s:%s",
+                      uuid, instance_id, fs->path,
+                      DELTA_CACHE_SVNDIFF_VERSION,
+                      svn_fs_unparse_id(source_id, pool)->data,
+                      svn_fs_unparse_id(target_id, pool)->data);
+
+  return SVN_NO_ERROR;
+}
+
+/* Baton type for delta streams that replay a cached delta. */
+typedef struct cached_delta_baton_t
+{
+  /* The delta windows, svn_txdelta_window_t *, and the index of the
+     next one to return. */
+  apr_array_header_t *windows;
+  int next;
+
+  /* MD5 digest of the target text. */
+  const unsigned char *digest;
+} cached_delta_baton_t;
+
+/* Implements svn_txdelta_window_handler_t.  Append a copy of WINDOW to
+   the cached_delta_baton_t BATON. */
+static svn_error_t *
+collect_cached_window(svn_txdelta_window_t *window,
+                      void *baton)
+{
+  cached_delta_baton_t *b = baton;
+
+  if (window)
+    APR_ARRAY_PUSH(b->windows, svn_txdelta_window_t *)
+      = svn_txdelta_window_dup(window, b->windows->pool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_txdelta_next_window_fn_t for cached_delta_baton_t. */
+static svn_error_t *
+cached_delta_next_window(svn_txdelta_window_t **window,
+                         void *baton,
+                         apr_pool_t *pool)
+{
+  cached_delta_baton_t *b = baton;
+
+  *window = b->next < b->windows->nelts
+          ? APR_ARRAY_IDX(b->windows, b->next++, svn_txdelta_window_t *)
+          : NULL;
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_txdelta_md5_digest_fn_t for cached_delta_baton_t. */
+static const unsigned char *
+cached_delta_md5_digest(void *baton)
+{
+  cached_delta_baton_t *b = baton;
+  return b->digest;
+}
+
+/* Set *STREAM_P to a delta stream replaying the svndiff data in SVNDIFF
+   that encodes the delta to TARGET_PATH under TARGET_ROOT.  Allocate
+   the result in POOL. */
+static svn_error_t *
+create_cached_delta_stream(svn_txdelta_stream_t **stream_p,
+                           const svn_stringbuf_t *svndiff,
+                           svn_fs_root_t *target_root,
+                           const char *target_path,
+                           apr_pool_t *pool)
+{
+  cached_delta_baton_t *b = apr_pcalloc(pool, sizeof(*b));
+  svn_checksum_t *checksum;
+  svn_stream_t *parser;
+  apr_size_t len = svndiff->len;
+
+  b->windows = apr_array_make(pool, 4, sizeof(svn_txdelta_window_t *));
+  parser = svn_txdelta_parse_svndiff(collect_cached_window, b, TRUE, pool);
+  SVN_ERR(svn_stream_write(parser, svndiff->data, &len));
+  SVN_ERR(svn_stream_close(parser));
+
+  SVN_ERR(svn_fs_file_checksum(&checksum, svn_checksum_md5, target_root,
+                               target_path, TRUE, pool));
+  b->digest = checksum->digest;
+
+  *stream_p = svn_txdelta_stream_create(b, cached_delta_next_window,
+                                        cached_delta_md5_digest, pool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Baton type for delta streams that add the delta to the cache. */
+typedef struct caching_delta_baton_t
+{
+  /* The delta stream provided by the FS backend. */
+  svn_txdelta_stream_t *inner;
+
+  /* Where to put the delta and under which key. */
+  svn_cache__t *cache;
+  const char *key;
+
+  /* The delta encoded so far and the encoder writing to it.  SVNDIFF
+     will be NULL once it becomes too large to be cached. */
+  svn_stringbuf_t *svndiff;
+  svn_txdelta_window_handler_t handler;
+  void *handler_baton;
+} caching_delta_baton_t;
+
+/* Implements svn_txdelta_next_window_fn_t for caching_delta_baton_t. */
+static svn_error_t *
+caching_delta_next_window(svn_txdelta_window_t **window,
+                          void *baton,
+                          apr_pool_t *pool)
+{
+  caching_delta_baton_t *b = baton;
+
+  SVN_ERR(svn_txdelta_next_window(window, b->inner, pool));
+  if (b->svndiff)
+    {
+      SVN_ERR(b->handler(*window, b->handler_baton));
+
+      if (!svn_cache__is_cachable(b->cache, b->svndiff->len))
+        b->svndiff = NULL;
+      else if (*window == NULL)
+        {
+          SVN_ERR(svn_cache__set(b->cache, b->key, b->svndiff, pool));
+          b->svndiff = NULL;
+        }
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_txdelta_md5_digest_fn_t for caching_delta_baton_t. */
+static const unsigned char *
+caching_delta_md5_digest(void *baton)
+{
+  caching_delta_baton_t *b = baton;
+  return svn_txdelta_md5_digest(b->inner);
+}
+
+svn_error_t *
+svn_fs__get_file_delta_cache_info(svn_cache__info_t **info,
+                                  svn_boolean_t reset,
+                                  apr_pool_t *result_pool)
+{
+  svn_cache__t *cache;
+
+  SVN_ERR(get_delta_cache(&cache, result_pool));
+  if (cache)
+    {
+      *info = apr_pcalloc(result_pool, sizeof(**info));
+      SVN_ERR(svn_cache__get_info(cache, *info, reset, result_pool));
+    }
+  else
+    {
+      *info = NULL;
+    }
+
+  return SVN_NO_ERROR;
+}
+
 svn_error_t *
 svn_fs_get_file_delta_stream(svn_txdelta_stream_t **stream_p,
                              svn_fs_root_t *source_root,
@@ -1722,10 +2004,54 @@ svn_fs_get_file_delta_stream(svn_txdelta_stream_t **stream_p,
                              svn_fs_root_t *target_root,
                              const char *target_path, apr_pool_t *pool)
 {
-  return svn_error_trace(target_root->vtable->get_file_delta_stream(
+  svn_cache__t *cache = NULL;
+  const char *key = NULL;
+  caching_delta_baton_t *b;
+
+  if (svn_hash__get_bool(target_root->fs->config,
+                         SVN_FS_CONFIG_CACHE_FILE_DELTAS, FALSE))
+    {
+      SVN_ERR(get_delta_cache(&cache, pool));
+      if (cache)
+        SVN_ERR(make_delta_cache_key(&key, source_root, source_path,
+                                     target_root, target_path, pool));
+    }
+
+  if (key)
+    {
+      svn_stringbuf_t *svndiff;
+      svn_boolean_t found;
+
+      SVN_ERR(svn_cache__get((void **)&svndiff, &found, cache, key, pool));
+      if (found)
+        return svn_error_trace(create_cached_delta_stream(stream_p, svndiff,
+                                                          target_root,
+                                                          target_path,
+                                                          pool));
+    }
+
+  SVN_ERR(target_root->vtable->get_file_delta_stream(
                            stream_p,
                            source_root, source_path,
                            target_root, target_path, pool));
+  if (!key)
+    return SVN_NO_ERROR;
+
+  /* Encode the delta while our caller reads it and cache it at the end. */
+  b = apr_pcalloc(pool, sizeof(*b));
+  b->inner = *stream_p;
+  b->cache = cache;
+  b->key = key;
+  b->svndiff = svn_stringbuf_create_empty(pool);
+  svn_txdelta_to_svndiff3(&b->handler, &b->handler_baton,
+                          svn_stream_from_stringbuf(b->svndiff, pool),
+                          DELTA_CACHE_SVNDIFF_VERSION,
+                          SVN_DELTA_COMPRESSION_LEVEL_NONE, pool);
+
+  *stream_p = svn_txdelta_stream_create(b, caching_delta_next_window,
+                                        caching_delta_md5_digest, pool);
+
+  return SVN_NO_ERROR;
 }
 
 svn_error_t *
@@ -266,6 +266,11 @@ typedef struct fs_vtable_t
   svn_error_t *(*bdb_set_errcall)(svn_fs_t *fs,
                                   void (*handler)(const char *errpfx,
                                                   char *msg));
+  /* Set *INSTANCE_ID to the ID that distinguishes FS from other
+     filesystems with the same UUID, e.g. one that got loaded from a dump
+     of it, or to NULL if FS does not have one.  May be NULL. */
+  svn_error_t *(*get_instance_id)(const char **instance_id, svn_fs_t *fs,
+                                  apr_pool_t *pool);
 } fs_vtable_t;
 
 
@@ -387,6 +392,14 @@ typedef struct root_vtable_t
                                             svn_fs_process_contents_func_t processor,
                                             void* baton,
                                             apr_pool_t *pool);
+  /* May be NULL. */
+  svn_error_t *(*file_contents_range)(apr_file_t **file,
+                                      apr_off_t *offset,
+                                      svn_filesize_t *length,
+                                      svn_fs_root_t *root,
+                                      const char *path,
+                                      apr_pool_t *result_pool,
+                                      apr_pool_t *scratch_pool);
   svn_error_t *(*make_file)(svn_fs_root_t *root, const char *path,
                             apr_pool_t *pool);
   svn_error_t *(*apply_textdelta)(svn_txdelta_window_handler_t *contents_p,
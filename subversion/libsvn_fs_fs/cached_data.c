@@ -2396,6 +2396,41 @@ svn_fs_fs__try_process_file_contents(svn_boolean_t *success,
   return SVN_NO_ERROR;
 }
 
+svn_error_t *
+svn_fs_fs__get_contents_range(apr_file_t **file,
+                              apr_off_t *offset,
+                              svn_filesize_t *length,
+                              svn_fs_t *fs,
+                              node_revision_t *noderev,
+                              apr_pool_t *result_pool,
+                              apr_pool_t *scratch_pool)
+{
+  representation_t *rep = noderev->data_rep;
+  rep_state_t *rs;
+  svn_fs_fs__rep_header_t *rh;
+
+  *file = NULL;
+
+  /* Only committed PLAIN reps are stored as a contiguous copy of the
+     fulltext.  Everything else must be reconstructed. */
+  if (!rep || svn_fs_fs__id_txn_used(&rep->txn_id))
+    return SVN_NO_ERROR;
+
+  SVN_ERR(create_rep_state(&rs, &rh, NULL, rep, fs, result_pool,
+                           scratch_pool));
+  if (rh->type != svn_fs_fs__rep_plain)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(auto_open_shared_file(rs->sfile));
+  SVN_ERR(auto_set_start_offset(rs, scratch_pool));
+
+  *file = rs->sfile->rfile->file;
+  *offset = rs->start;
+  *length = rs->size;
+
+  return SVN_NO_ERROR;
+}
+
 
 /* Baton used when reading delta windows. */
 struct delta_read_baton
@@ -119,6 +119,23 @@ svn_fs_fs__try_process_file_contents(svn_boolean_t *success,
                                      void* baton,
                                      apr_pool_t *pool);
 
+/* If the text representation of node-revision NODEREV in filesystem FS
+   is stored as a plain, unencoded fulltext in a revision or pack file,
+   set *FILE to that file and *OFFSET and *LENGTH to the location of the
+   fulltext within it.  Otherwise, set *FILE to NULL.
+   *FILE will remain open for as long as RESULT_POOL.  Note that the
+   fulltext will not be verified against its checksums.
+   Use SCRATCH_POOL for temporary allocations.
+ */
+svn_error_t *
+svn_fs_fs__get_contents_range(apr_file_t **file,
+                              apr_off_t *offset,
+                              svn_filesize_t *length,
+                              svn_fs_t *fs,
+                              node_revision_t *noderev,
+                              apr_pool_t *result_pool,
+                              apr_pool_t *scratch_pool);
+
 /* Set *STREAM_P to a delta stream turning the contents of the file SOURCE into
    the contents of the file TARGET, allocated in POOL.
    If SOURCE is null, the empty string will be used. */
@@ -346,6 +346,79 @@ create_cache(svn_cache__t **cache_p,
   return SVN_NO_ERROR;
 }
 
+/* If PERSISTENT is not NULL, put a persistent 2nd level cache using the
+ * given SERIALIZER, DESERIALIZER, KLEN and PREFIX behind *CACHE_P and
+ * return the combined cache in *CACHE_P.  Leave *CACHE_P untouched if it
+ * is NULL or HAS_NAMESPACE is set; the latter caches are short-lived and
+ * not worth persisting.
+ *
+ * Since the persistent cache is always optional, errors from it are only
+ * reported as warnings to the FS warning callback, unless NO_HANDLER is
+ * true.  Allocate the new cache in RESULT_POOL.
+ */
+static svn_error_t *
+add_persistent_cache(svn_cache__t **cache_p,
+                     svn_cache__mmap_t *persistent,
+                     svn_cache__serialize_func_t serializer,
+                     svn_cache__deserialize_func_t deserializer,
+                     apr_ssize_t klen,
+                     const char *prefix,
+                     svn_boolean_t has_namespace,
+                     svn_fs_t *fs,
+                     svn_boolean_t no_handler,
+                     apr_pool_t *result_pool)
+{
+  if (*cache_p == NULL || persistent == NULL || has_namespace)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_cache__create_mmap_cache(cache_p, persistent, *cache_p,
+                                       serializer, deserializer, klen,
+                                       prefix, result_pool));
+  SVN_ERR(init_callbacks(*cache_p, fs,
+                         no_handler ? NULL
+                                    : warn_and_continue_on_cache_errors,
+                         result_pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Open the persistent cache file configured for FS and return it in
+ * *PERSISTENT.  Set it to NULL if there is no such file, if FS does not
+ * support it or, unless FFD->FAIL_STOP is set, if it could not be opened.
+ * Use SCRATCH_POOL for temporary allocations.
+ */
+static svn_error_t *
+open_persistent_cache(svn_cache__mmap_t **persistent,
+                      svn_fs_t *fs,
+                      apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  svn_error_t *err;
+
+  *persistent = NULL;
+  if (ffd->persistent_cache_path == NULL)
+    return SVN_NO_ERROR;
+
+  /* Older formats have no instance ID and their keys would only contain
+   * the UUID and path.  These remain the same when e.g. a backup of the
+   * repository gets restored, so entries for revisions committed since
+   * the backup had been taken would become stale.  Cache entries must
+   * never be stale. */
+  if (ffd->format < SVN_FS_FS__MIN_INSTANCE_ID_FORMAT)
+    return SVN_NO_ERROR;
+
+  err = svn_cache__mmap_open(persistent, ffd->persistent_cache_path,
+                             ffd->persistent_cache_size, scratch_pool);
+  if (err && !ffd->fail_stop)
+    {
+      *persistent = NULL;
+      return svn_error_trace(warn_and_continue_on_cache_errors(err, fs,
+                                                               scratch_pool));
+    }
+
+  return svn_error_trace(err);
+}
+
 svn_error_t *
 svn_fs_fs__initialize_caches(svn_fs_t *fs,
                              apr_pool_t *pool)
@@ -363,6 +436,8 @@ svn_fs_fs__initialize_caches(svn_fs_t *fs,
   svn_boolean_t cache_nodeprops;
   const char *cache_namespace;
   svn_boolean_t has_namespace;
+  svn_cache__mmap_t *persistent;
+  const char *persistent_prefix;
 
   /* Evaluating the cache configuration. */
   SVN_ERR(read_config(&cache_namespace,
@@ -377,6 +452,12 @@ svn_fs_fs__initialize_caches(svn_fs_t *fs,
 
   membuffer = svn_cache__get_global_membuffer_cache();
 
+  /* Data in the persistent cache may outlive this repository.  Make sure
+   * it won't be picked up by a replacement with the same UUID and path. */
+  SVN_ERR(open_persistent_cache(&persistent, fs, pool));
+  persistent_prefix = apr_pstrcat(pool, prefix, ffd->instance_id, ":",
+                                  SVN_VA_NULL);
+
   /* General rules for assigning cache priorities:
    *
    * - Data that can be reconstructed from other elements has low prio
@@ -434,6 +515,13 @@ svn_fs_fs__initialize_caches(svn_fs_t *fs,
                        fs,
                        no_handler,
                        fs->pool, pool));
+  SVN_ERR(add_persistent_cache(&(ffd->rev_node_cache), persistent,
+                               svn_fs_fs__dag_serialize,
+                               svn_fs_fs__dag_deserialize,
+                               APR_HASH_KEY_STRING,
+                               apr_pstrcat(pool, persistent_prefix, "DAG",
+                                           SVN_VA_NULL),
+                               has_namespace, fs, no_handler, fs->pool));
 
   /* 1st level DAG node cache */
   ffd->dag_node_cache = svn_fs_fs__create_dag_cache(fs->pool);
@@ -452,6 +540,13 @@ svn_fs_fs__initialize_caches(svn_fs_t *fs,
                        fs,
                        no_handler,
                        fs->pool, pool));
+  SVN_ERR(add_persistent_cache(&(ffd->dir_cache), persistent,
+                               svn_fs_fs__serialize_dir_entries,
+                               svn_fs_fs__deserialize_dir_entries,
+                               sizeof(pair_cache_key_t),
+                               apr_pstrcat(pool, persistent_prefix, "DIR",
+                                           SVN_VA_NULL),
+                               has_namespace, fs, no_handler, fs->pool));
 
   /* 8 kBytes per entry (1000 revs / shared, one file offset per rev).
      Covering about 8 pack files gives us an "o.k." hit rate. */
@@ -639,6 +734,15 @@ svn_fs_fs__initialize_caches(svn_fs_t *fs,
                            fs,
                            no_handler,
                            fs->pool, pool));
+      SVN_ERR(add_persistent_cache(&(ffd->txdelta_window_cache), persistent,
+                                   svn_fs_fs__serialize_txdelta_window,
+                                   svn_fs_fs__deserialize_txdelta_window,
+                                   sizeof(window_cache_key_t),
+                                   apr_pstrcat(pool, persistent_prefix,
+                                               "TXDELTA_WINDOW",
+                                               SVN_VA_NULL),
+                                   has_namespace, fs, no_handler,
+                                   fs->pool));
 
       SVN_ERR(create_cache(&(ffd->combined_window_cache),
                            NULL,
@@ -654,6 +758,16 @@ svn_fs_fs__initialize_caches(svn_fs_t *fs,
                            fs,
                            no_handler,
                            fs->pool, pool));
+      SVN_ERR(add_persistent_cache(&(ffd->combined_window_cache),
+                                   persistent,
+                                   /* Values are svn_stringbuf_t */
+                                   NULL, NULL,
+                                   sizeof(window_cache_key_t),
+                                   apr_pstrcat(pool, persistent_prefix,
+                                               "COMBINED_WINDOW",
+                                               SVN_VA_NULL),
+                                   has_namespace, fs, no_handler,
+                                   fs->pool));
     }
   else
     {
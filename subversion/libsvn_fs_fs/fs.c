@@ -241,6 +241,22 @@ fs_info(const void **fsfs_info,
   return SVN_NO_ERROR;
 }
 
+static svn_error_t *
+fs_get_instance_id(const char **instance_id,
+                   svn_fs_t *fs,
+                   apr_pool_t *pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+
+  /* Older formats use the UUID instead. */
+  if (ffd->format >= SVN_FS_FS__MIN_INSTANCE_ID_FORMAT)
+    *instance_id = ffd->instance_id;
+  else
+    *instance_id = NULL;
+
+  return SVN_NO_ERROR;
+}
+
 /* Wrapper around svn_fs_fs__set_uuid() adapting between function
    signatures. */
 static svn_error_t *
@@ -279,7 +295,8 @@ static fs_vtable_t fs_vtable = {
   fs_info,
   svn_fs_fs__verify_root,
   fs_freeze,
-  fs_set_errcall
+  fs_set_errcall,
+  fs_get_instance_id
 };
 
 
@@ -308,6 +325,35 @@ uninitialize_fs_struct(svn_fs_t *fs)
   fs->fsap_data = NULL;
 }
 
+svn_error_t *
+svn_fs_fs__open_instance(svn_fs_t **instance,
+                         svn_fs_t *fs,
+                         apr_pool_t *result_pool,
+                         apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  svn_fs_t *new_fs = apr_pcalloc(result_pool, sizeof(*new_fs));
+  fs_fs_data_t *new_ffd;
+
+  new_fs->pool = result_pool;
+  new_fs->warning = fs->warning;
+  new_fs->warning_baton = fs->warning_baton;
+  new_fs->config = fs->config;
+
+  SVN_ERR(initialize_fs_struct(new_fs));
+  SVN_ERR(svn_fs_fs__open(new_fs, fs->path, scratch_pool));
+  SVN_ERR(svn_fs_fs__initialize_caches(new_fs, scratch_pool));
+
+  /* The shared data has already been set up for FS and the same instance
+     must be used by all svn_fs_t for that repository. */
+  new_ffd = new_fs->fsap_data;
+  new_ffd->shared = ffd->shared;
+  new_ffd->svn_fs_open_ = ffd->svn_fs_open_;
+
+  *instance = new_fs;
+  return SVN_NO_ERROR;
+}
+
 /* This implements the fs_library_vtable_t.create() API.  Create a new
    fsfs-backed Subversion filesystem at path PATH and link it into
    *FS.  Perform temporary allocations in POOL, and fs-global allocations
@@ -100,6 +100,8 @@ extern "C" {
 /* Names of sections and options in fsfs.conf. */
 #define CONFIG_SECTION_CACHES            "caches"
 #define CONFIG_OPTION_FAIL_STOP          "fail-stop"
+#define CONFIG_OPTION_PERSISTENT_CACHE_FILE "persistent-cache-file"
+#define CONFIG_OPTION_PERSISTENT_CACHE_SIZE "persistent-cache-size"
 #define CONFIG_SECTION_REP_SHARING       "rep-sharing"
 #define CONFIG_OPTION_ENABLE_REP_SHARING "enable-rep-sharing"
 #define CONFIG_SECTION_DELTIFICATION     "deltification"
@@ -188,6 +190,10 @@ extern "C" {
 /* The minimum format number that supports svndiff version 2. */
 #define SVN_FS_FS__MIN_SVNDIFF2_FORMAT 8
 
+/* The minimum format number that supports svndiff version 3.  Note that
+   reading such data also requires Subversion to be built with zstd. */
+#define SVN_FS_FS__MIN_SVNDIFF3_FORMAT 8
+
 /* The minimum format number that supports the special notation ("-")
    for optional values that are not present in the representation strings,
    such as SHA1 or the uniquifier.  For example:
@@ -315,7 +321,8 @@ typedef enum compression_type_t
 {
   compression_type_none,
   compression_type_zlib,
-  compression_type_lz4
+  compression_type_lz4,
+  compression_type_zstd
 } compression_type_t;
 
 /* Private (non-shared) FSFS-specific data for each svn_fs_t object.
@@ -360,6 +367,12 @@ typedef struct fs_fs_data_t
      e.g. memcached may be ignored as caching is an optional feature. */
   svn_boolean_t fail_stop;
 
+  /* Absolute path of the persistent 2nd level cache file shared with
+     other processes on this host.  NULL, if that cache has been disabled.
+     PERSISTENT_CACHE_SIZE is the size in bytes to create that file with. */
+  const char *persistent_cache_path;
+  apr_int64_t persistent_cache_size;
+
   /* A cache of revision root IDs, mapping from (svn_revnum_t *) to
      (svn_fs_id_t *).  (Not threadsafe.) */
   svn_cache__t *rev_root_id_cache;
@@ -496,12 +509,20 @@ typedef struct fs_fs_data_t
   /* Compression type to use with txdelta storage format in new revs. */
   compression_type_t delta_compression_type;
 
-  /* Compression level (currently, only used with compression_type_zlib). */
+  /* Compression level (used with compression_type_zlib and
+     compression_type_zstd). */
   int delta_compression_level;
 
+  /* Whether to store new fulltexts as PLAIN instead of self-deltas.
+     Only set if the config explicitly asks for "compression = none". */
+  svn_boolean_t store_plain_fulltexts;
+
   /* Pack after every commit. */
   svn_boolean_t pack_after_commit;
 
+  /* Maximum number of shards to pack concurrently.  1 means sequential. */
+  int pack_threads;
+
   /* Verify each new revision before commit. */
   svn_boolean_t verify_before_commit;
 
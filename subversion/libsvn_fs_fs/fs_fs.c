@@ -692,7 +692,8 @@ parse_compression_option(compression_type_t *compression_type_p,
   int level;
   svn_boolean_t is_valid = TRUE;
 
-  /* compression = none | lz4 | zlib | zlib-1 ... zlib-9 */
+  /* compression = none | lz4 | zlib | zlib-1 ... zlib-9 |
+   *               zstd | zstd-1 ... zstd-19 */
   if (strcmp(value, "none") == 0)
     {
       type = compression_type_none;
@@ -722,6 +723,26 @@ parse_compression_option(compression_type_t *compression_type_p,
       else
         is_valid = FALSE;
     }
+  else if (strncmp(value, "zstd", 4) == 0)
+    {
+      const char *p = value + 4;
+
+      type = compression_type_zstd;
+      if (*p == 0)
+        {
+          level = SVN__COMPRESSION_ZSTD_DEFAULT;
+        }
+      else if (*p == '-')
+        {
+          p++;
+          SVN_ERR(svn_cstring_atoi(&level, p));
+          if (level < SVN__COMPRESSION_ZSTD_MIN
+              || level > SVN__COMPRESSION_ZSTD_MAX)
+            is_valid = FALSE;
+        }
+      else
+        is_valid = FALSE;
+    }
   else
     {
       is_valid = FALSE;
@@ -747,6 +768,7 @@ read_config(fs_fs_data_t *ffd,
             apr_pool_t *scratch_pool)
 {
   svn_config_t *config;
+  const char *cache_path;
 
   SVN_ERR(svn_config_read3(&config,
                            svn_dirent_join(fs_path, PATH_CONFIG, scratch_pool),
@@ -861,6 +883,7 @@ read_config(fs_fs_data_t *ffd,
     }
 
   /* Initialize compression settings in ffd. */
+  ffd->store_plain_fulltexts = FALSE;
   if (ffd->format >= SVN_FS_FS__MIN_DELTIFICATION_FORMAT)
     {
       const char *compression_val;
@@ -890,6 +913,20 @@ read_config(fs_fs_data_t *ffd,
                                       _("Compression type 'lz4' requires "
                                         "filesystem format 8 or higher"));
             }
+          if (ffd->delta_compression_type == compression_type_none)
+            ffd->store_plain_fulltexts = TRUE;
+          if (ffd->delta_compression_type == compression_type_zstd)
+            {
+              if (ffd->format < SVN_FS_FS__MIN_SVNDIFF3_FORMAT)
+                return svn_error_create(SVN_ERR_BAD_CONFIG_VALUE, NULL,
+                                        _("Compression type 'zstd' requires "
+                                          "filesystem format 8 or higher"));
+              if (!svn_zstd__is_available())
+                return svn_error_create(SVN_ERR_BAD_CONFIG_VALUE, NULL,
+                                        _("Compression type 'zstd' is not "
+                                          "supported by this build of "
+                                          "Subversion"));
+            }
         }
       else if (compression_level_val)
         {
@@ -945,6 +982,43 @@ read_config(fs_fs_data_t *ffd,
                               CONFIG_SECTION_CACHES, CONFIG_OPTION_FAIL_STOP,
                               FALSE));
 
+  /* Persistent cache configuration.  Relative paths are relative to the
+   * repository's db directory. */
+  svn_config_get(config, &cache_path, CONFIG_SECTION_CACHES,
+                 CONFIG_OPTION_PERSISTENT_CACHE_FILE, NULL);
+  if (cache_path && *cache_path)
+    ffd->persistent_cache_path
+      = svn_dirent_join(fs_path,
+                        svn_dirent_internal_style(cache_path, scratch_pool),
+                        result_pool);
+  else
+    ffd->persistent_cache_path = NULL;
+
+  SVN_ERR(svn_config_get_int64(config, &ffd->persistent_cache_size,
+                               CONFIG_SECTION_CACHES,
+                               CONFIG_OPTION_PERSISTENT_CACHE_SIZE,
+                               64));
+
+  /* Don't accept unreasonable or illegal values.  The size is in MB and
+   * the whole file gets mapped into memory. */
+  if (ffd->persistent_cache_size <= 0)
+    return svn_error_createf(SVN_ERR_BAD_CONFIG_VALUE, NULL,
+                             _("%s is too small for fsfs.conf setting '%s'."),
+                             apr_psprintf(scratch_pool,
+                                          "%" APR_INT64_T_FMT,
+                                          ffd->persistent_cache_size),
+                             CONFIG_OPTION_PERSISTENT_CACHE_SIZE);
+
+  if (ffd->persistent_cache_size > SVN_MAX_OBJECT_SIZE / 0x100000)
+    return svn_error_createf(SVN_ERR_BAD_CONFIG_VALUE, NULL,
+                             _("%s is too large for fsfs.conf setting '%s'."),
+                             apr_psprintf(scratch_pool,
+                                          "%" APR_INT64_T_FMT,
+                                          ffd->persistent_cache_size),
+                             CONFIG_OPTION_PERSISTENT_CACHE_SIZE);
+
+  ffd->persistent_cache_size *= 0x100000;
+
   return SVN_NO_ERROR;
 }
 
@@ -977,6 +1051,19 @@ write_config(svn_fs_t *fs,
 "### configured (and ignoring it with file:// access).  To make"             NL
 "### Subversion never ignore cache errors, uncomment this line."             NL
 "# " CONFIG_OPTION_FAIL_STOP " = true"                                       NL
+"### FSFS can keep a persistent copy of frequently used, expensive to"       NL
+"### reconstruct data such as directories and delta windows in a memory-"   NL
+"### mapped file.  All processes on the same host that access repositories"  NL
+"### configured with the same file share its contents and the data will"    NL
+"### survive server restarts.  Relative paths are interpreted relative to"  NL
+"### this repository's db directory.  The file should be on a local disk"   NL
+"### and readable only by users that may also read the repository.  It is"  NL
+"### disabled by default.  Repositories in formats older than 7, i.e. those" NL
+"### created with Subversion 1.8 or earlier, never use this file."           NL
+"# " CONFIG_OPTION_PERSISTENT_CACHE_FILE " = /var/cache/svn/fsfs.cache"      NL
+"### The size of that file in MB when it gets created.  Once the file"       NL
+"### exists, its size will not change.  Defaults to 64 MB."                  NL
+"# " CONFIG_OPTION_PERSISTENT_CACHE_SIZE " = 64"                             NL
 ""                                                                           NL
 "[" CONFIG_SECTION_REP_SHARING "]"                                           NL
 "### To conserve space, the filesystem can optionally avoid storing"         NL
@@ -1058,19 +1145,30 @@ write_config(svn_fs_t *fs,
 "### After deltification, we compress the data to minimize on-disk size."    NL
 "### This setting controls the compression algorithm, which will be used in" NL
 "### future revisions.  It can be used to either disable compression or to"  NL
-"### select between available algorithms (zlib, lz4).  zlib is a general-"   NL
-"### purpose compression algorithm.  lz4 is a fast compression algorithm"    NL
-"### which should be preferred for repositories with large and, possibly,"   NL
-"### incompressible files.  Note that the compression ratio of lz4 is"       NL
-"### usually lower than the one provided by zlib, but using it can"          NL
+"### select between available algorithms (zlib, lz4, zstd).  zlib is a"     NL
+"### general-purpose compression algorithm.  lz4 is a fast compression"      NL
+"### algorithm which should be preferred for repositories with large and,"   NL
+"### possibly, incompressible files.  Note that the compression ratio of"    NL
+"### lz4 is usually lower than the one provided by zlib, but using it can"   NL
 "### significantly speed up commits as well as reading the data."            NL
-"### lz4 compression algorithm is supported, starting from format 8"         NL
-"### repositories, available in Subversion 1.10 and higher."                 NL
+"### zstd (Zstandard) provides compression ratios similar to or better than" NL
+"### zlib while decompressing about as fast as lz4.  Higher zstd levels"     NL
+"### mainly increase the time spent on commits."                             NL
+"### lz4 and zstd compression algorithms are supported, starting from"       NL
+"### format 8 repositories, available in Subversion 1.10 and higher."        NL
+"### zstd is an optional feature; all Subversion servers and tools that"     NL
+"### access a repository containing zstd compressed data directly must have" NL
+"### been built with zstd support."                                          NL
 "### The syntax of this option is:"                                          NL
-"###   " CONFIG_OPTION_COMPRESSION " = none | lz4 | zlib | zlib-1 ... zlib-9" NL
+"###   " CONFIG_OPTION_COMPRESSION " = none | lz4 | zlib | zlib-1 ... zlib-9 |" NL
+"###                 zstd | zstd-1 ... zstd-19"                              NL
 "### Versions prior to Subversion 1.10 will ignore this option."             NL
 "### The default value is 'lz4' if supported by the repository format and"   NL
-"### 'zlib' otherwise.  'zlib' is currently equivalent to 'zlib-5'."         NL
+"### 'zlib' otherwise.  'zlib' is currently equivalent to 'zlib-5' and"      NL
+"### 'zstd' is equivalent to 'zstd-3'."                                      NL
+"### With 'none', new file contents that are not deltified against a"        NL
+"### previous version are stored as plain fulltexts.  Servers may then"      NL
+"### send them directly from the revision files, e.g. using sendfile()."     NL
 "# " CONFIG_OPTION_COMPRESSION " = lz4"                                      NL
 "###"                                                                        NL
 "### DEPRECATED: The new '" CONFIG_OPTION_COMPRESSION "' option deprecates previously used" NL
@@ -1166,6 +1264,7 @@ static svn_error_t *
 read_global_config(svn_fs_t *fs)
 {
   fs_fs_data_t *ffd = fs->fsap_data;
+  const char *pack_threads_str;
 
   ffd->use_block_read = svn_hash__get_bool(fs->config,
                                            SVN_FS_CONFIG_FSFS_BLOCK_READ,
@@ -1174,6 +1273,18 @@ read_global_config(svn_fs_t *fs)
                                            SVN_FS_CONFIG_NO_FLUSH_TO_DISK,
                                            FALSE);
 
+  ffd->pack_threads = 1;
+  pack_threads_str = svn_hash__get_cstring(fs->config,
+                                           SVN_FS_CONFIG_FSFS_PACK_THREADS,
+                                           NULL);
+  if (pack_threads_str)
+    {
+      apr_int64_t val;
+      SVN_ERR(svn_cstring_strtoi64(&val, pack_threads_str, 0, APR_INT32_MAX,
+                                   10));
+      ffd->pack_threads = MAX((int) val, 1);
+    }
+
   /* Ignore the user-specified larger block size if we don't use block-read.
      Defaulting to 4k gives us the same access granularity in format 7 as in
      older formats. */
@@ -48,6 +48,16 @@ svn_error_t *svn_fs_fs__initialize_shared_data(svn_fs_t *fs,
                                                apr_pool_t *pool,
                                                apr_pool_t *common_pool);
 
+/* Open another, independent instance of the already opened filesystem FS
+   and return it in *INSTANCE.  The new instance uses the same config and
+   shared data as FS but none of its per-instance state.  Thus, it may be
+   used from a different thread than FS.  Allocate *INSTANCE in
+   RESULT_POOL and use SCRATCH_POOL for temporary allocations. */
+svn_error_t *svn_fs_fs__open_instance(svn_fs_t **instance,
+                                      svn_fs_t *fs,
+                                      apr_pool_t *result_pool,
+                                      apr_pool_t *scratch_pool);
+
 /* Upgrade the fsfs filesystem FS.  Indicate progress via the optional
  * NOTIFY_FUNC callback using NOTIFY_BATON.  The optional CANCEL_FUNC
  * will periodically be called with CANCEL_BATON to allow for preemption.
@@ -30,6 +30,7 @@
 #include "private/svn_subr_private.h"
 #include "private/svn_string_private.h"
 #include "private/svn_io_private.h"
+#include "private/svn_parallel.h"
 
 #include "fs_fs.h"
 #include "pack.h"
@@ -1701,6 +1702,126 @@ svn_fs_fs__get_packed_offset(apr_off_t *rev_offset,
   return svn_cache__set(ffd->packed_offset_cache, &shard, manifest, pool);
 }
 
+/* Revision files up to this size will be read into memory by the
+ * read-ahead threads in pack_phys_addressed().  Larger files get copied
+ * in chunks by the pack file writer itself.
+ */
+#define MAX_READ_AHEAD_FILE_SIZE (1024 * 1024)
+
+/* Baton type used by read_rev_file_task() and append_rev_file_output().
+ */
+typedef struct phys_pack_baton_t
+{
+  /* directory containing the revision files to pack */
+  const char *shard_path;
+
+  /* first revision in the shard */
+  svn_revnum_t start_rev;
+
+  /* the pack file to append the revision contents to */
+  apr_file_t *pack_file;
+
+  /* stream to write the manifest lines to */
+  svn_stream_t *manifest_stream;
+
+  /* cancellation support for the pack file writer */
+  svn_cancel_func_t cancel_func;
+  void *cancel_baton;
+} phys_pack_baton_t;
+
+/* Return the path of revision file IDX within the shard described by
+ * BATON.  Allocate the result in RESULT_POOL.
+ */
+static const char *
+rev_file_path(phys_pack_baton_t *baton,
+              int idx,
+              apr_pool_t *result_pool)
+{
+  return svn_dirent_join(baton->shard_path,
+                         apr_psprintf(result_pool, "%ld",
+                                      baton->start_rev + idx),
+                         result_pool);
+}
+
+/* Implements svn_parallel__task_func_t.  If the revision file IDX in the
+ * shard described by BATON is not larger than MAX_READ_AHEAD_FILE_SIZE,
+ * read its contents into an svn_stringbuf_t allocated in RESULT_POOL and
+ * return it in *RESULT.  Otherwise, return NULL.
+ */
+static svn_error_t *
+read_rev_file_task(void **result,
+                   void *baton,
+                   int idx,
+                   svn_cancel_func_t cancel_func,
+                   void *cancel_baton,
+                   apr_pool_t *result_pool,
+                   apr_pool_t *scratch_pool)
+{
+  const char *path = rev_file_path(baton, idx, scratch_pool);
+  svn_stringbuf_t *contents;
+  apr_finfo_t finfo;
+
+  SVN_ERR(svn_io_stat(&finfo, path, APR_FINFO_SIZE, scratch_pool));
+  if (finfo.size > MAX_READ_AHEAD_FILE_SIZE)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_stringbuf_from_file2(&contents, path, result_pool));
+  *result = contents;
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_parallel__output_func_t.  Append the revision file IDX
+ * of the shard described by BATON to its pack file and add the respective
+ * manifest entry.  If RESULT is not NULL, it contains the file contents
+ * as read by read_rev_file_task().
+ */
+static svn_error_t *
+append_rev_file_output(void *baton,
+                       int idx,
+                       void *result,
+                       svn_error_t *task_err,
+                       apr_pool_t *scratch_pool)
+{
+  phys_pack_baton_t *b = baton;
+  svn_stringbuf_t *contents = result;
+  apr_off_t offset;
+
+  SVN_ERR(task_err);
+
+  /* Obtain current offset in pack file. */
+  SVN_ERR(svn_io_file_get_offset(&offset, b->pack_file, scratch_pool));
+
+  /* build manifest */
+  SVN_ERR(svn_stream_printf(b->manifest_stream, scratch_pool,
+                            "%" APR_OFF_T_FMT "\n", offset));
+
+  /* Copy all the bits from the rev file to the end of the pack file. */
+  if (contents)
+    {
+      SVN_ERR(svn_io_file_write_full(b->pack_file, contents->data,
+                                     contents->len, NULL, scratch_pool));
+    }
+  else
+    {
+      svn_stream_t *rev_stream;
+      apr_file_t *rev_file;
+
+      /* Use unbuffered apr_file_t since we're going to write using 16kb
+       * chunks. */
+      SVN_ERR(svn_io_file_open(&rev_file, rev_file_path(b, idx, scratch_pool),
+                               APR_READ, APR_OS_DEFAULT, scratch_pool));
+      rev_stream = svn_stream_from_aprfile2(rev_file, FALSE, scratch_pool);
+      SVN_ERR(svn_stream_copy3(rev_stream,
+                               svn_stream_from_aprfile2(b->pack_file, TRUE,
+                                                        scratch_pool),
+                               b->cancel_func, b->cancel_baton,
+                               scratch_pool));
+    }
+
+  return SVN_NO_ERROR;
+}
+
 /* Packing logic for physical addresssing mode:
  * Simply concatenate all revision contents.
  *
@@ -1709,12 +1830,17 @@ svn_fs_fs__get_packed_offset(apr_off_t *rev_offset,
  * using POOL for allocations.  If FLUSH_TO_DISK is non-zero, do not
  * return until the data has actually been written on the disk.
  * CANCEL_FUNC and CANCEL_BATON are what you think they are.
+ *
+ * If READ_AHEAD_THREADS is larger than 1, that many threads will read
+ * the next revision files while the current ones are being written to
+ * the pack file.
  */
 static svn_error_t *
 pack_phys_addressed(const char *pack_file_dir,
                     const char *shard_path,
                     svn_revnum_t start_rev,
                     int max_files_per_dir,
+                    int read_ahead_threads,
                     svn_boolean_t flush_to_disk,
                     svn_cancel_func_t cancel_func,
                     void *cancel_baton,
@@ -1723,9 +1849,7 @@ pack_phys_addressed(const char *pack_file_dir,
   const char *pack_file_path, *manifest_file_path;
   apr_file_t *pack_file;
   apr_file_t *manifest_file;
-  svn_stream_t *manifest_stream;
-  svn_revnum_t end_rev, rev;
-  apr_pool_t *iterpool;
+  phys_pack_baton_t baton;
 
   /* Some useful paths. */
   pack_file_path = svn_dirent_join(pack_file_dir, PATH_PACKED, pool);
@@ -1742,45 +1866,24 @@ pack_phys_addressed(const char *pack_file_dir,
   SVN_ERR(svn_io_file_open(&manifest_file, manifest_file_path,
                            APR_WRITE | APR_BUFFERED | APR_CREATE | APR_EXCL,
                            APR_OS_DEFAULT, pool));
-  manifest_stream = svn_stream_from_aprfile2(manifest_file, TRUE, pool);
-
-  end_rev = start_rev + max_files_per_dir - 1;
-  iterpool = svn_pool_create(pool);
-
-  /* Iterate over the revisions in this shard, squashing them together. */
-  for (rev = start_rev; rev <= end_rev; rev++)
-    {
-      svn_stream_t *rev_stream;
-      const char *path;
-      apr_off_t offset;
-      apr_file_t *rev_file;
 
-      svn_pool_clear(iterpool);
-
-      path = svn_dirent_join(shard_path, apr_psprintf(iterpool, "%ld", rev),
-                             iterpool);
-
-      /* Obtain current offset in pack file. */
-      SVN_ERR(svn_io_file_get_offset(&offset, pack_file, iterpool));
-
-      /* build manifest */
-      SVN_ERR(svn_stream_printf(manifest_stream, iterpool,
-                                "%" APR_OFF_T_FMT "\n", offset));
-
-      /* Copy all the bits from the rev file to the end of the pack file.
-       * Use unbuffered apr_file_t since we're going to write using 16kb
-       * chunks. */
-      SVN_ERR(svn_io_file_open(&rev_file, path, APR_READ, APR_OS_DEFAULT,
-                               iterpool));
-      rev_stream = svn_stream_from_aprfile2(rev_file, FALSE, iterpool);
-      SVN_ERR(svn_stream_copy3(rev_stream,
-                               svn_stream_from_aprfile2(pack_file, TRUE,
-                                                        iterpool),
-                               cancel_func, cancel_baton, iterpool));
-    }
+  baton.shard_path = shard_path;
+  baton.start_rev = start_rev;
+  baton.pack_file = pack_file;
+  baton.manifest_stream = svn_stream_from_aprfile2(manifest_file, TRUE,
+                                                   pool);
+  baton.cancel_func = cancel_func;
+  baton.cancel_baton = cancel_baton;
+
+  /* Iterate over the revisions in this shard, squashing them together.
+   * Reading may happen ahead of time but writing will be in order. */
+  SVN_ERR(svn_parallel__run(max_files_per_dir, read_ahead_threads, 0,
+                            read_rev_file_task, &baton,
+                            append_rev_file_output, &baton,
+                            cancel_func, cancel_baton, pool));
 
   /* Close stream over APR file. */
-  SVN_ERR(svn_stream_close(manifest_stream));
+  SVN_ERR(svn_stream_close(baton.manifest_stream));
 
   /* Ensure that pack file is written to disk. */
   if (flush_to_disk)
@@ -1788,15 +1891,13 @@ pack_phys_addressed(const char *pack_file_dir,
   SVN_ERR(svn_io_file_close(manifest_file, pool));
 
   /* disallow write access to the manifest file */
-  SVN_ERR(svn_io_set_file_read_only(manifest_file_path, FALSE, iterpool));
+  SVN_ERR(svn_io_set_file_read_only(manifest_file_path, FALSE, pool));
 
   /* Ensure that pack file is written to disk. */
   if (flush_to_disk)
     SVN_ERR(svn_io_file_flush_to_disk(pack_file, pool));
   SVN_ERR(svn_io_file_close(pack_file, pool));
 
-  svn_pool_destroy(iterpool);
-
   return SVN_NO_ERROR;
 }
 
@@ -1805,7 +1906,8 @@ pack_phys_addressed(const char *pack_file_dir,
  * using POOL for allocations.  Try to limit the amount of temporary
  * memory needed to MAX_MEM bytes.  If FLUSH_TO_DISK is non-zero, do
  * not return until the data has actually been written on the disk.
- * CANCEL_FUNC and CANCEL_BATON are what you think they are.
+ * Allow for up to READ_AHEAD_THREADS threads reading revision data
+ * ahead of time.  CANCEL_FUNC and CANCEL_BATON are what you think they are.
  *
  * If for some reason we detect a partial packing already performed, we
  * remove the pack file and start again.
@@ -1819,6 +1921,7 @@ pack_rev_shard(svn_fs_t *fs,
                apr_int64_t shard,
                int max_files_per_dir,
                apr_size_t max_mem,
+               int read_ahead_threads,
                svn_boolean_t flush_to_disk,
                svn_cancel_func_t cancel_func,
                void *cancel_baton,
@@ -1844,8 +1947,9 @@ pack_rev_shard(svn_fs_t *fs,
                                cancel_func, cancel_baton, pool));
   else
     SVN_ERR(pack_phys_addressed(pack_file_dir, shard_path, shard_rev,
-                                max_files_per_dir, flush_to_disk,
-                                cancel_func, cancel_baton, pool));
+                                max_files_per_dir, read_ahead_threads,
+                                flush_to_disk, cancel_func, cancel_baton,
+                                pool));
 
   SVN_ERR(svn_io_copy_perms(shard_path, pack_file_dir, pool));
   SVN_ERR(svn_io_set_file_read_only(pack_file_path, FALSE, pool));
@@ -1957,6 +2061,49 @@ synced_pack_shard(void *baton,
   return SVN_NO_ERROR;
 }
 
+/* Return the paths of the pack directory and of the non-packed revision
+ * directory for SHARD in REVS_DIR in *REV_PACK_FILE_DIR and
+ * *REV_SHARD_PATH, respectively.  Allocate them in POOL.
+ */
+static void
+get_shard_paths(const char **rev_pack_file_dir,
+                const char **rev_shard_path,
+                const char *revs_dir,
+                apr_int64_t shard,
+                apr_pool_t *pool)
+{
+  *rev_pack_file_dir = svn_dirent_join(revs_dir,
+                  apr_psprintf(pool,
+                               "%" APR_INT64_T_FMT PATH_EXT_PACKED_SHARD,
+                               shard),
+                  pool);
+  *rev_shard_path = svn_dirent_join(revs_dir,
+                                    apr_psprintf(pool, "%" APR_INT64_T_FMT,
+                                                 shard),
+                                    pool);
+}
+
+/* Switch the repository over to the packed revision data for the shard
+ * described by BATON, which must already be complete.
+ */
+static svn_error_t *
+switch_to_packed_shard(struct pack_baton *baton,
+                       apr_pool_t *pool)
+{
+  fs_fs_data_t *ffd = baton->fs->fsap_data;
+
+  /* For newer repo formats, we only acquired the pack lock so far.
+     Before modifying the repo state by switching over to the packed
+     data, we need to acquire the global (write) lock. */
+  if (ffd->format >= SVN_FS_FS__MIN_PACK_LOCK_FORMAT)
+    SVN_ERR(svn_fs_fs__with_write_lock(baton->fs, synced_pack_shard, baton,
+                                       pool));
+  else
+    SVN_ERR(synced_pack_shard(baton, pool));
+
+  return SVN_NO_ERROR;
+}
+
 /* Pack the shard described by BATON.
  *
  * If for some reason we detect a partial packing already performed,
@@ -1975,31 +2122,16 @@ pack_shard(struct pack_baton *baton,
                                svn_fs_pack_notify_start, pool));
 
   /* Some useful paths. */
-  rev_pack_file_dir = svn_dirent_join(baton->revs_dir,
-                  apr_psprintf(pool,
-                               "%" APR_INT64_T_FMT PATH_EXT_PACKED_SHARD,
-                               baton->shard),
-                  pool);
-  baton->rev_shard_path = svn_dirent_join(baton->revs_dir,
-                                          apr_psprintf(pool,
-                                                       "%" APR_INT64_T_FMT,
-                                                       baton->shard),
-                                          pool);
+  get_shard_paths(&rev_pack_file_dir, &baton->rev_shard_path,
+                  baton->revs_dir, baton->shard, pool);
 
   /* pack the revision content */
   SVN_ERR(pack_rev_shard(baton->fs, rev_pack_file_dir, baton->rev_shard_path,
                          baton->shard, ffd->max_files_per_dir,
-                         baton->max_mem, ffd->flush_to_disk,
+                         baton->max_mem, 1, ffd->flush_to_disk,
                          baton->cancel_func, baton->cancel_baton, pool));
 
-  /* For newer repo formats, we only acquired the pack lock so far.
-     Before modifying the repo state by switching over to the packed
-     data, we need to acquire the global (write) lock. */
-  if (ffd->format >= SVN_FS_FS__MIN_PACK_LOCK_FORMAT)
-    SVN_ERR(svn_fs_fs__with_write_lock(baton->fs, synced_pack_shard, baton,
-                                       pool));
-  else
-    SVN_ERR(synced_pack_shard(baton, pool));
+  SVN_ERR(switch_to_packed_shard(baton, pool));
 
   /* Notify caller we're starting to pack this shard. */
   if (baton->notify_func)
@@ -2009,6 +2141,148 @@ pack_shard(struct pack_baton *baton,
   return SVN_NO_ERROR;
 }
 
+/* Number of threads per shard reading revision files ahead of time when
+ * packing shards concurrently.
+ */
+#define READ_AHEAD_THREADS 2
+
+/* Baton type used by pack_shard_task() and pack_shard_output().
+ */
+typedef struct pack_shards_baton_t
+{
+  /* The overall pack operation.  Only to be modified by the thread
+   * calling pack_shards_concurrently(). */
+  struct pack_baton *pb;
+
+  /* Shard to be packed by task 0. */
+  apr_int64_t first_shard;
+
+  /* Number of shards to pack. */
+  int shard_count;
+
+  /* Maximum number of tasks running or waiting for their output. */
+  int max_pending;
+
+  /* Share of PB->MAX_MEM that each task may use. */
+  apr_size_t max_mem;
+} pack_shards_baton_t;
+
+/* Implements svn_parallel__task_func_t.  Pack the revision contents of
+ * shard FIRST_SHARD + IDX as given by the pack_shards_baton_t BATON into
+ * its pack directory.  Do not modify the repository state; this is left
+ * to pack_shard_output().
+ *
+ * To not interfere with other threads, this uses a separate instance of
+ * the filesystem.
+ */
+static svn_error_t *
+pack_shard_task(void **result,
+                void *baton,
+                int idx,
+                svn_cancel_func_t cancel_func,
+                void *cancel_baton,
+                apr_pool_t *result_pool,
+                apr_pool_t *scratch_pool)
+{
+  pack_shards_baton_t *b = baton;
+  apr_int64_t shard = b->first_shard + idx;
+  const char *rev_pack_file_dir, *rev_shard_path;
+  svn_fs_t *fs;
+  fs_fs_data_t *ffd;
+
+  SVN_ERR(svn_fs_fs__open_instance(&fs, b->pb->fs, scratch_pool,
+                                   scratch_pool));
+  ffd = fs->fsap_data;
+
+  get_shard_paths(&rev_pack_file_dir, &rev_shard_path, b->pb->revs_dir,
+                  shard, scratch_pool);
+  SVN_ERR(pack_rev_shard(fs, rev_pack_file_dir, rev_shard_path, shard,
+                         ffd->max_files_per_dir, b->max_mem,
+                         READ_AHEAD_THREADS, ffd->flush_to_disk,
+                         cancel_func, cancel_baton, scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_parallel__output_func_t.  Unless TASK_ERR is set, switch
+ * the repository over to the packed data of shard FIRST_SHARD + IDX as
+ * given by the pack_shards_baton_t BATON.
+ *
+ * Send both notifications for the shard from here, such that callers see
+ * the same start / end pairs in shard order as with a sequential pack.
+ */
+static svn_error_t *
+pack_shard_output(void *baton,
+                  int idx,
+                  void *result,
+                  svn_error_t *task_err,
+                  apr_pool_t *scratch_pool)
+{
+  pack_shards_baton_t *b = baton;
+  struct pack_baton *pb = b->pb;
+  const char *rev_pack_file_dir;
+
+  SVN_ERR(task_err);
+
+  pb->shard = b->first_shard + idx;
+  get_shard_paths(&rev_pack_file_dir, &pb->rev_shard_path, pb->revs_dir,
+                  pb->shard, scratch_pool);
+
+  if (pb->notify_func)
+    SVN_ERR(pb->notify_func(pb->notify_baton, pb->shard,
+                            svn_fs_pack_notify_start, scratch_pool));
+
+  SVN_ERR(switch_to_packed_shard(pb, scratch_pool));
+
+  if (pb->notify_func)
+    SVN_ERR(pb->notify_func(pb->notify_baton, pb->shard,
+                            svn_fs_pack_notify_end, scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Pack all shards from the first non-packed one up to but not including
+ * COMPLETED_SHARDS as described by BATON.  Use up to FFD->PACK_THREADS
+ * threads to pack the revision data of different shards concurrently.
+ *
+ * Switching over to the packed data happens in the calling thread and
+ * strictly in shard order.  Thus, the repository will be in the same
+ * consistent state upon failure or interruption as after a sequential
+ * pack.  Use POOL for temporary allocations.
+ */
+static svn_error_t *
+pack_shards_concurrently(struct pack_baton *baton,
+                         apr_int64_t completed_shards,
+                         apr_pool_t *pool)
+{
+  fs_fs_data_t *ffd = baton->fs->fsap_data;
+  pack_shards_baton_t b;
+  apr_int64_t shard_count;
+
+  b.pb = baton;
+  b.first_shard = ffd->min_unpacked_rev / ffd->max_files_per_dir;
+
+  shard_count = completed_shards - b.first_shard;
+  SVN_ERR_ASSERT(shard_count <= INT_MAX);
+  b.shard_count = (int)shard_count;
+
+  /* Don't let completed shards pile up while waiting for a slow one
+     because each of them temporarily doubles the disk space needed. */
+  b.max_pending = 2 * ffd->pack_threads;
+
+  /* Stay within the overall memory limit. */
+  b.max_mem = baton->max_mem / ffd->pack_threads;
+
+  SVN_ERR(svn_parallel__run(b.shard_count, ffd->pack_threads,
+                            b.max_pending,
+                            pack_shard_task, &b,
+                            pack_shard_output, &b,
+                            baton->cancel_func, baton->cancel_baton,
+                            pool));
+
+  return SVN_NO_ERROR;
+}
+
 /* Read the youngest rev and the first non-packed rev info for FS from disk.
    Set *FULLY_PACKED when there is no completed unpacked shard.
    Use SCRATCH_POOL for temporary allocations.
@@ -2080,6 +2354,10 @@ pack_body(void *baton,
     pb->revsprops_dir = svn_dirent_join(pb->fs->path, PATH_REVPROPS_DIR,
                                         pool);
 
+  if (ffd->pack_threads > 1)
+    return svn_error_trace(pack_shards_concurrently(pb, completed_shards,
+                                                    pool));
+
   iterpool = svn_pool_create(pool);
   for (pb->shard = ffd->min_unpacked_rev / ffd->max_files_per_dir;
        pb->shard < completed_shards;
@@ -32,6 +32,11 @@
    MAX_MEM limits the size of in-memory data structures needed for reordering
    items in format 7 repositories.  0 means use the built-in default.
 
+   If FS has been configured to use more than one pack thread, multiple
+   shards will be packed concurrently, sharing MAX_MEM equally.  The
+   switch-over to the packed data and its notifications still happen in
+   shard order.
+
    If given, NOTIFY_FUNC will be called with NOTIFY_BATON to report progress.
    Use optional CANCEL_FUNC/CANCEL_BATON for cancellation support.
 
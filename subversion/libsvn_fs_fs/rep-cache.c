@@ -33,6 +33,7 @@
 #include "svn_path.h"
 
 #include "private/svn_sqlite.h"
+#include "private/svn_subr_private.h"
 
 #include "rep-cache-db.h"
 
@@ -378,6 +379,247 @@ svn_fs_fs__set_rep_reference(svn_fs_t *fs,
 }
 
 
+/* Number of hashes looked up and of rows inserted per execution of
+   STMT_GET_REPS_BATCH and STMT_SET_REPS_BATCH, respectively. */
+#define REP_CACHE_BATCH_SIZE 16
+
+svn_error_t *
+svn_fs_fs__get_rep_references(apr_hash_t **reps_p,
+                              svn_fs_t *fs,
+                              const apr_array_header_t *checksums,
+                              apr_pool_t *result_pool,
+                              apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  svn_sqlite__stmt_t *stmt;
+  apr_hash_t *reps = apr_hash_make(result_pool);
+  apr_hash_index_t *hi;
+  svn_revnum_t max_rev = SVN_INVALID_REVNUM;
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  int i;
+
+  SVN_ERR_ASSERT(ffd->rep_sharing_allowed);
+  if (! ffd->rep_cache_db)
+    SVN_ERR(svn_fs_fs__open_rep_cache(fs, scratch_pool));
+
+  /* We only allow SHA1 checksums in this table. */
+  for (i = 0; i < checksums->nelts; i++)
+    if (APR_ARRAY_IDX(checksums, i, const svn_checksum_t *)->kind
+          != svn_checksum_sha1)
+      return svn_error_create(SVN_ERR_BAD_CHECKSUM_KIND, NULL,
+                              _("Only SHA1 checksums can be used as keys in "
+                                "the rep_cache table.\n"));
+
+  SVN_ERR(svn_sqlite__get_statement(&stmt, ffd->rep_cache_db,
+                                    STMT_GET_REPS_BATCH));
+  for (i = 0; i < checksums->nelts; i += REP_CACHE_BATCH_SIZE)
+    {
+      svn_boolean_t have_row;
+      int k;
+
+      svn_pool_clear(iterpool);
+
+      /* Unused slots remain NULL and will not match anything. */
+      for (k = 0; k < REP_CACHE_BATCH_SIZE; k++)
+        {
+          const svn_checksum_t *checksum
+            = i + k < checksums->nelts
+            ? APR_ARRAY_IDX(checksums, i + k, const svn_checksum_t *)
+            : NULL;
+
+          SVN_ERR(svn_sqlite__bind_text(stmt, k + 1,
+                                        checksum
+                                          ? svn_checksum_to_cstring(checksum,
+                                                                    iterpool)
+                                          : NULL));
+        }
+
+      SVN_ERR(svn_sqlite__step(&have_row, stmt));
+      while (have_row)
+        {
+          representation_t *rep;
+          svn_checksum_t *checksum;
+          svn_error_t *err;
+
+          err = svn_checksum_parse_hex(&checksum, svn_checksum_sha1,
+                                       svn_sqlite__column_text(stmt, 0,
+                                                               iterpool),
+                                       iterpool);
+          if (err)
+            return svn_error_compose_create(err, svn_sqlite__reset(stmt));
+
+          rep = apr_pcalloc(result_pool, sizeof(*rep));
+          svn_fs_fs__id_txn_reset(&(rep->txn_id));
+          memcpy(rep->sha1_digest, checksum->digest, sizeof(rep->sha1_digest));
+          rep->has_sha1 = TRUE;
+          rep->revision = svn_sqlite__column_revnum(stmt, 1);
+          rep->item_index = svn_sqlite__column_int64(stmt, 2);
+          rep->size = svn_sqlite__column_int64(stmt, 3);
+          rep->expanded_size = svn_sqlite__column_int64(stmt, 4);
+
+          apr_hash_set(reps, rep->sha1_digest, APR_SHA1_DIGESTSIZE, rep);
+          if (rep->revision > max_rev)
+            max_rev = rep->revision;
+
+          SVN_ERR(svn_sqlite__step(&have_row, stmt));
+        }
+
+      SVN_ERR(svn_sqlite__reset(stmt));
+    }
+
+  /* Check that all reps refer to revisions that exist in FS.
+     See svn_fs_fs__get_rep_reference(). */
+  if (SVN_IS_VALID_REVNUM(max_rev))
+    {
+      svn_error_t *err = svn_fs_fs__ensure_revision_exists(max_rev, fs,
+                                                           iterpool);
+      if (err)
+        return svn_error_createf(SVN_ERR_FS_CORRUPT, err,
+                                 "Rep-cache refers to r%ld beyond HEAD",
+                                 max_rev);
+    }
+
+  for (hi = apr_hash_first(scratch_pool, reps); hi; hi = apr_hash_next(hi))
+    {
+      svn_pool_clear(iterpool);
+      SVN_ERR(svn_fs_fs__fixup_expanded_size(fs, apr_hash_this_val(hi),
+                                             iterpool));
+    }
+
+  svn_pool_destroy(iterpool);
+
+  *reps_p = reps;
+  return SVN_NO_ERROR;
+}
+
+/* Bind the values of REP to the 5 parameters starting at FIRST_SLOT of
+   STMT.  Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+bind_rep(svn_sqlite__stmt_t *stmt,
+         int first_slot,
+         const representation_t *rep,
+         apr_pool_t *scratch_pool)
+{
+  svn_checksum_t checksum;
+  checksum.kind = svn_checksum_sha1;
+  checksum.digest = rep->sha1_digest;
+
+  SVN_ERR(svn_sqlite__bind_text(stmt, first_slot,
+                                svn_checksum_to_cstring(&checksum,
+                                                        scratch_pool)));
+  SVN_ERR(svn_sqlite__bind_revnum(stmt, first_slot + 1, rep->revision));
+  SVN_ERR(svn_sqlite__bind_int64(stmt, first_slot + 2, rep->item_index));
+  SVN_ERR(svn_sqlite__bind_int64(stmt, first_slot + 3, rep->size));
+  SVN_ERR(svn_sqlite__bind_int64(stmt, first_slot + 4, rep->expanded_size));
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_fs_fs__set_rep_references(svn_fs_t *fs,
+                              const apr_array_header_t *reps,
+                              apr_pool_t *scratch_pool)
+{
+  fs_fs_data_t *ffd = fs->fsap_data;
+  apr_array_header_t *checksums;
+  apr_array_header_t *new_reps;
+  apr_hash_t *seen = apr_hash_make(scratch_pool);
+  apr_hash_t *existing;
+  svn_sqlite__stmt_t *stmt;
+  apr_pool_t *iterpool;
+  int i;
+
+  SVN_ERR_ASSERT(ffd->rep_sharing_allowed);
+  if (! ffd->rep_cache_db)
+    SVN_ERR(svn_fs_fs__open_rep_cache(fs, scratch_pool));
+
+  /* Look up all of them at once, skipping duplicates. */
+  checksums = apr_array_make(scratch_pool, reps->nelts,
+                             sizeof(svn_checksum_t *));
+  for (i = 0; i < reps->nelts; i++)
+    {
+      representation_t *rep = APR_ARRAY_IDX(reps, i, representation_t *);
+
+      /* We only allow SHA1 checksums in this table. */
+      if (! rep->has_sha1)
+        return svn_error_create(SVN_ERR_BAD_CHECKSUM_KIND, NULL,
+                                _("Only SHA1 checksums can be used as keys "
+                                  "in the rep_cache table.\n"));
+
+      if (apr_hash_get(seen, rep->sha1_digest, APR_SHA1_DIGESTSIZE))
+        continue;
+
+      apr_hash_set(seen, rep->sha1_digest, APR_SHA1_DIGESTSIZE, rep);
+      APR_ARRAY_PUSH(checksums, svn_checksum_t *)
+        = svn_checksum__from_digest_sha1(rep->sha1_digest, scratch_pool);
+    }
+
+  SVN_ERR(svn_fs_fs__get_rep_references(&existing, fs, checksums,
+                                        scratch_pool, scratch_pool));
+
+  /* Existing mappings are fine as they are. */
+  new_reps = apr_array_make(scratch_pool, checksums->nelts,
+                            sizeof(representation_t *));
+  for (i = 0; i < checksums->nelts; i++)
+    {
+      const unsigned char *digest
+        = APR_ARRAY_IDX(checksums, i, svn_checksum_t *)->digest;
+
+      if (!apr_hash_get(existing, digest, APR_SHA1_DIGESTSIZE))
+        APR_ARRAY_PUSH(new_reps, representation_t *)
+          = apr_hash_get(seen, digest, APR_SHA1_DIGESTSIZE);
+    }
+
+  /* Insert full batches with a single statement each. */
+  iterpool = svn_pool_create(scratch_pool);
+  SVN_ERR(svn_sqlite__get_statement(&stmt, ffd->rep_cache_db,
+                                    STMT_SET_REPS_BATCH));
+  for (i = 0; i + REP_CACHE_BATCH_SIZE <= new_reps->nelts;
+       i += REP_CACHE_BATCH_SIZE)
+    {
+      svn_error_t *err;
+      int k;
+
+      svn_pool_clear(iterpool);
+      for (k = 0; k < REP_CACHE_BATCH_SIZE; k++)
+        SVN_ERR(bind_rep(stmt, 5 * k + 1,
+                         APR_ARRAY_IDX(new_reps, i + k, representation_t *),
+                         iterpool));
+
+      err = svn_sqlite__insert(NULL, stmt);
+      if (err)
+        {
+          if (err->apr_err != SVN_ERR_SQLITE_CONSTRAINT)
+            return svn_error_trace(err);
+
+          /* Someone else added some of these mappings in the meantime.
+             Fall back to adding them one-by-one, which tolerates that. */
+          svn_error_clear(err);
+          for (k = 0; k < REP_CACHE_BATCH_SIZE; k++)
+            SVN_ERR(svn_fs_fs__set_rep_reference(fs,
+                                                 APR_ARRAY_IDX(new_reps,
+                                                               i + k,
+                                                           representation_t *),
+                                                 iterpool));
+        }
+    }
+
+  /* The remainder. */
+  for (; i < new_reps->nelts; i++)
+    {
+      svn_pool_clear(iterpool);
+      SVN_ERR(svn_fs_fs__set_rep_reference(fs,
+                                           APR_ARRAY_IDX(new_reps, i,
+                                                         representation_t *),
+                                           iterpool));
+    }
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+
 svn_error_t *
 svn_fs_fs__del_rep_reference(svn_fs_t *fs,
                              svn_revnum_t youngest,
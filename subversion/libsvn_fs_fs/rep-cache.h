@@ -83,6 +83,37 @@ svn_fs_fs__set_rep_reference(svn_fs_t *fs,
                              representation_t *rep,
                              apr_pool_t *pool);
 
+/* Look up all SHA1 CHECKSUMS (an array of svn_checksum_t *) in FS's rep
+   cache at once and set *REPS_P to a hash mapping the SHA1 digests
+   (APR_SHA1_DIGESTSIZE bytes) of those found to their representation_t *.
+   Allocate the result in RESULT_POOL and use SCRATCH_POOL for temporary
+   allocations.  Returns SVN_ERR_FS_CORRUPT if a reference beyond HEAD is
+   detected.
+
+   This is much faster than calling svn_fs_fs__get_rep_reference() for
+   each checksum individually. */
+svn_error_t *
+svn_fs_fs__get_rep_references(apr_hash_t **reps_p,
+                              svn_fs_t *fs,
+                              const apr_array_header_t *checksums,
+                              apr_pool_t *result_pool,
+                              apr_pool_t *scratch_pool);
+
+/* Set all representations in REPS (an array of representation_t *) in FS,
+   using their SHA1 checksums.  Duplicates and representations that are
+   already in the cache will be skipped.  Use SCRATCH_POOL for temporary
+   allocations.
+
+   This looks up and inserts the representations in batches and is much
+   faster than calling svn_fs_fs__set_rep_reference() for each of them.
+   Callers should wrap this in an SQLite transaction that takes the write
+   lock immediately, so the cache does not change between the lookup and
+   the inserts. */
+svn_error_t *
+svn_fs_fs__set_rep_references(svn_fs_t *fs,
+                              const apr_array_header_t *reps,
+                              apr_pool_t *scratch_pool);
+
 /* Delete from the cache all reps corresponding to revisions younger
    than YOUNGEST. */
 svn_error_t *
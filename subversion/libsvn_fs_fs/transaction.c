@@ -2169,7 +2169,12 @@ txdelta_to_svndiff(svn_txdelta_window_handler_t *handler,
   fs_fs_data_t *ffd = fs->fsap_data;
   int svndiff_version;
 
-  if (ffd->delta_compression_type == compression_type_lz4)
+  if (ffd->delta_compression_type == compression_type_zstd)
+    {
+      SVN_ERR_ASSERT_NO_RETURN(ffd->format >= SVN_FS_FS__MIN_SVNDIFF3_FORMAT);
+      svndiff_version = 3;
+    }
+  else if (ffd->delta_compression_type == compression_type_lz4)
     {
       SVN_ERR_ASSERT_NO_RETURN(ffd->format >= SVN_FS_FS__MIN_SVNDIFF2_FORMAT);
       svndiff_version = 2;
@@ -2205,6 +2210,7 @@ rep_write_get_baton(struct rep_write_baton **wb_p,
   svn_txdelta_window_handler_t wh;
   void *whb;
   svn_fs_fs__rep_header_t header = { 0 };
+  fs_fs_data_t *ffd = fs->fsap_data;
 
   b = apr_pcalloc(pool, sizeof(*b));
 
@@ -2232,8 +2238,6 @@ rep_write_get_baton(struct rep_write_baton **wb_p,
 
   /* Get the base for this delta. */
   SVN_ERR(choose_delta_base(&base_rep, fs, noderev, FALSE, b->scratch_pool));
-  SVN_ERR(svn_fs_fs__get_contents(&source, fs, base_rep, TRUE,
-                                  b->scratch_pool));
 
   /* Write out the rep header. */
   if (base_rep)
@@ -2243,6 +2247,15 @@ rep_write_get_baton(struct rep_write_baton **wb_p,
       header.base_length = base_rep->size;
       header.type = svn_fs_fs__rep_delta;
     }
+  else if (ffd->store_plain_fulltexts)
+    {
+      /* Without compression, a self-delta would not save much space.
+         Store the fulltext as is instead, so that it can be read
+         without any reconstruction or even be sent directly from the
+         rev file.  See svn_fs_fs__get_contents_range().  Repositories
+         that don't compress by default keep writing self-deltas. */
+      header.type = svn_fs_fs__rep_plain;
+    }
   else
     {
       header.type = svn_fs_fs__rep_self_delta;
@@ -2258,11 +2271,17 @@ rep_write_get_baton(struct rep_write_baton **wb_p,
   apr_pool_cleanup_register(b->scratch_pool, b, rep_write_cleanup,
                             apr_pool_cleanup_null);
 
-  /* Prepare to write the svndiff data. */
-  txdelta_to_svndiff(&wh, &whb, b->rep_stream, fs, pool);
+  /* Prepare to write the svndiff data.  PLAIN data will be written
+     to REP_STREAM directly. */
+  if (header.type != svn_fs_fs__rep_plain)
+    {
+      SVN_ERR(svn_fs_fs__get_contents(&source, fs, base_rep, TRUE,
+                                      b->scratch_pool));
+      txdelta_to_svndiff(&wh, &whb, b->rep_stream, fs, pool);
 
-  b->delta_stream = svn_txdelta_target_push(wh, whb, source,
-                                            b->scratch_pool);
+      b->delta_stream = svn_txdelta_target_push(wh, whb, source,
+                                                b->scratch_pool);
+    }
 
   *wb_p = b;
 
@@ -3935,25 +3954,6 @@ commit_body(void *baton, apr_pool_t *pool)
   return SVN_NO_ERROR;
 }
 
-/* Add the representations in REPS_TO_CACHE (an array of representation_t *)
- * to the rep-cache database of FS. */
-static svn_error_t *
-write_reps_to_cache(svn_fs_t *fs,
-                    const apr_array_header_t *reps_to_cache,
-                    apr_pool_t *scratch_pool)
-{
-  int i;
-
-  for (i = 0; i < reps_to_cache->nelts; i++)
-    {
-      representation_t *rep = APR_ARRAY_IDX(reps_to_cache, i, representation_t *);
-
-      SVN_ERR(svn_fs_fs__set_rep_reference(fs, rep, scratch_pool));
-    }
-
-  return SVN_NO_ERROR;
-}
-
 svn_error_t *
 svn_fs_fs__commit(svn_revnum_t *new_rev_p,
                   svn_fs_t *fs,
@@ -3994,13 +3994,13 @@ svn_fs_fs__commit(svn_revnum_t *new_rev_p,
       /* Write new entries to the rep-sharing database.
        *
        * We use an sqlite transaction to speed things up;
-       * see <http://www.sqlite.org/faq.html#q19>.
+       * see <http://www.sqlite.org/faq.html#q19>.  Take the write lock
+       * right away because the entries get looked up before the inserts.
+       * Batching the lookups and inserts keeps the time we block other
+       * commits short even for commits that touch thousands of files.
        */
-      /* ### A commit that touches thousands of files will starve other
-             (reader/writer) commits for the duration of the below call.
-             Maybe write in batches? */
-      SVN_ERR(svn_sqlite__begin_transaction(ffd->rep_cache_db));
-      err = write_reps_to_cache(fs, cb.reps_to_cache, pool);
+      SVN_ERR(svn_sqlite__begin_immediate_transaction(ffd->rep_cache_db));
+      err = svn_fs_fs__set_rep_references(fs, cb.reps_to_cache, pool);
       err = svn_sqlite__finish_transaction(ffd->rep_cache_db, err);
 
       if (svn_error_find_cause(err, SVN_ERR_SQLITE_ROLLBACK_FAILED))
@@ -2938,6 +2938,35 @@ fs_try_process_file_contents(svn_boolean_t *success,
 /* --- End machinery for svn_fs_try_process_file_contents() ---  */
 
 
+/* --- Machinery for svn_fs__file_contents_range() ---  */
+
+static svn_error_t *
+fs_file_contents_range(apr_file_t **file,
+                       apr_off_t *offset,
+                       svn_filesize_t *length,
+                       svn_fs_root_t *root,
+                       const char *path,
+                       apr_pool_t *result_pool,
+                       apr_pool_t *scratch_pool)
+{
+  dag_node_t *node;
+
+  /* Transaction contents may still change. */
+  if (root->is_txn_root)
+    {
+      *file = NULL;
+      return SVN_NO_ERROR;
+    }
+
+  SVN_ERR(get_dag(&node, root, path, scratch_pool));
+
+  return svn_fs_fs__dag_get_contents_range(file, offset, length, node,
+                                           result_pool, scratch_pool);
+}
+
+/* --- End machinery for svn_fs__file_contents_range() ---  */
+
+
 /* --- Machinery for svn_fs_apply_textdelta() ---  */
 
 
@@ -4547,6 +4576,7 @@ static root_vtable_t root_vtable = {
   fs_file_checksum,
   fs_file_contents,
   fs_try_process_file_contents,
+  fs_file_contents_range,
   fs_make_file,
   fs_apply_textdelta,
   fs_apply_text,
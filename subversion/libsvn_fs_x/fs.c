@@ -230,6 +230,17 @@ x_info(const void **fsx_info,
   return SVN_NO_ERROR;
 }
 
+static svn_error_t *
+x_get_instance_id(const char **instance_id,
+                  svn_fs_t *fs,
+                  apr_pool_t *pool)
+{
+  svn_fs_x__data_t *ffd = fs->fsap_data;
+  *instance_id = ffd->instance_id;
+
+  return SVN_NO_ERROR;
+}
+
 static svn_error_t *
 x_refresh_revprops(svn_fs_t *fs,
                    apr_pool_t *scratch_pool)
@@ -310,7 +321,8 @@ static fs_vtable_t fs_vtable = {
   x_info,
   svn_fs_x__verify_root,
   x_freeze,
-  x_set_errcall
+  x_set_errcall,
+  x_get_instance_id
 };
 
 
@@ -54,6 +54,7 @@
 
 #include "private/svn_auth_private.h"
 #include "private/svn_ra_private.h"
+#include "private/svn_subr_private.h"
 #include "svn_private_config.h"
 
 
@@ -645,6 +646,133 @@ svn_error_t *svn_ra_get_dir2(svn_ra_session_t *session,
                                   path, revision, dirent_fields, pool);
 }
 
+svn_error_t *
+svn_ra_get_dirs(svn_ra_session_t *session,
+                apr_hash_t **dirents,
+                const apr_array_header_t *paths,
+                svn_revnum_t revision,
+                apr_uint32_t dirent_fields,
+                apr_pool_t *result_pool,
+                apr_pool_t *scratch_pool)
+{
+  int i;
+
+  SVN_ERR_ASSERT(SVN_IS_VALID_REVNUM(revision));
+  for (i = 0; i < paths->nelts; i++)
+    SVN_ERR_ASSERT(svn_relpath_is_canonical(APR_ARRAY_IDX(paths, i,
+                                                          const char *)));
+
+  if (session->vtable->get_dirs)
+    return svn_error_trace(session->vtable->get_dirs(session, dirents, paths,
+                                                     revision, dirent_fields,
+                                                     result_pool,
+                                                     scratch_pool));
+
+  /* Fall back to fetching one directory at a time. */
+  *dirents = apr_hash_make(result_pool);
+  for (i = 0; i < paths->nelts; i++)
+    {
+      const char *path = APR_ARRAY_IDX(paths, i, const char *);
+      apr_hash_t *entries;
+
+      SVN_ERR(session->vtable->get_dir(session, &entries, NULL, NULL, path,
+                                       revision, dirent_fields, result_pool));
+      svn_hash_sets(*dirents, apr_pstrdup(result_pool, path), entries);
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Amount of file contents to keep in memory when fetching files one at a
+   time in svn_ra_get_files() before spilling them to a temporary file. */
+#define GET_FILES_SPILL_MEMORY_SIZE (1024 * 1024)
+
+/* Implement svn_ra_get_files() for SESSION by fetching one file at a time
+   with the vtable's get_file() function.  The other parameters are the
+   same as for svn_ra_get_files(). */
+static svn_error_t *
+get_files_one_by_one(svn_ra_session_t *session,
+                     const apr_array_header_t *targets,
+                     svn_boolean_t want_props,
+                     svn_ra_file_stream_func_t stream_func,
+                     void *stream_baton,
+                     apr_pool_t *scratch_pool)
+{
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  int i;
+
+  for (i = 0; i < targets->nelts; i++)
+    {
+      const svn_ra_file_target_t *target
+        = APR_ARRAY_IDX(targets, i, const svn_ra_file_target_t *);
+      svn_spillbuf_t *contents;
+      svn_stream_t *stream;
+      svn_revnum_t fetched_rev = SVN_INVALID_REVNUM;
+      apr_hash_t *props = NULL;
+
+      svn_pool_clear(iterpool);
+
+      /* STREAM_FUNC needs to know the properties before it can provide
+         the target stream, so buffer the contents. */
+      contents = svn_spillbuf__create(SVN__STREAM_CHUNK_SIZE,
+                                      GET_FILES_SPILL_MEMORY_SIZE,
+                                      iterpool);
+      SVN_ERR(session->vtable->get_file(session, target->path,
+                                        target->revision,
+                                        svn_stream__from_spillbuf(contents,
+                                                                  iterpool),
+                                        &fetched_rev,
+                                        want_props ? &props : NULL,
+                                        iterpool));
+      if (!SVN_IS_VALID_REVNUM(fetched_rev))
+        fetched_rev = target->revision;
+
+      SVN_ERR(stream_func(&stream, stream_baton, target->path, fetched_rev,
+                          props, iterpool));
+      if (stream)
+        SVN_ERR(svn_stream_copy3(svn_stream__from_spillbuf(contents,
+                                                           iterpool),
+                                 stream, NULL, NULL, iterpool));
+    }
+
+  svn_pool_destroy(iterpool);
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_ra_get_files(svn_ra_session_t *session,
+                 const apr_array_header_t *targets,
+                 svn_boolean_t want_props,
+                 svn_ra_file_stream_func_t stream_func,
+                 void *stream_baton,
+                 apr_pool_t *scratch_pool)
+{
+  int i;
+
+  for (i = 0; i < targets->nelts; i++)
+    SVN_ERR_ASSERT(svn_relpath_is_canonical(
+                     APR_ARRAY_IDX(targets, i,
+                                   const svn_ra_file_target_t *)->path));
+
+  if (session->vtable->get_files)
+    {
+      svn_error_t *err = session->vtable->get_files(session, targets,
+                                                    want_props,
+                                                    stream_func,
+                                                    stream_baton,
+                                                    scratch_pool);
+      if (!err || err->apr_err != SVN_ERR_RA_NOT_IMPLEMENTED)
+        return svn_error_trace(err);
+
+      svn_error_clear(err);
+    }
+
+  /* Do it the slow way for older servers. */
+  return svn_error_trace(get_files_one_by_one(session, targets, want_props,
+                                              stream_func, stream_baton,
+                                              scratch_pool));
+}
+
 svn_error_t *
 svn_ra_list(svn_ra_session_t *session,
             const char *path,
@@ -1065,6 +1193,30 @@ svn_error_t *svn_ra_get_file_revs2(svn_ra_session_t *session,
   return svn_error_trace(err);
 }
 
+svn_error_t *
+svn_ra_get_blame(svn_ra_session_t *session,
+                 const char *path,
+                 svn_revnum_t start,
+                 svn_revnum_t end,
+                 const apr_array_header_t *diff_options,
+                 svn_ra_blame_receiver_t receiver,
+                 void *receiver_baton,
+                 apr_pool_t *scratch_pool)
+{
+  SVN_ERR_ASSERT(svn_relpath_is_canonical(path));
+  SVN_ERR_ASSERT(SVN_IS_VALID_REVNUM(start) && SVN_IS_VALID_REVNUM(end));
+  SVN_ERR_ASSERT(start <= end);
+
+  if (!session->vtable->get_blame)
+    return svn_error_create(SVN_ERR_UNSUPPORTED_FEATURE, NULL, NULL);
+
+  SVN_ERR(svn_ra__assert_capable_server(session, SVN_RA_CAPABILITY_BLAME,
+                                        NULL, scratch_pool));
+
+  return session->vtable->get_blame(session, path, start, end, diff_options,
+                                    receiver, receiver_baton, scratch_pool);
+}
+
 svn_error_t *svn_ra_lock(svn_ra_session_t *session,
                          apr_hash_t *path_revs,
                          const char *comment,
@@ -343,6 +343,34 @@ typedef struct svn_ra__vtable_t {
                        void *receiver_baton,
                        apr_pool_t *scratch_pool);
 
+  /* See svn_ra_get_blame(). */
+  svn_error_t *(*get_blame)(svn_ra_session_t *session,
+                            const char *path,
+                            svn_revnum_t start,
+                            svn_revnum_t end,
+                            const apr_array_header_t *diff_options,
+                            svn_ra_blame_receiver_t receiver,
+                            void *receiver_baton,
+                            apr_pool_t *scratch_pool);
+
+  /* See svn_ra_get_dirs().  May be NULL. */
+  svn_error_t *(*get_dirs)(svn_ra_session_t *session,
+                           apr_hash_t **dirents,
+                           const apr_array_header_t *paths,
+                           svn_revnum_t revision,
+                           apr_uint32_t dirent_fields,
+                           apr_pool_t *result_pool,
+                           apr_pool_t *scratch_pool);
+
+  /* See svn_ra_get_files().  May be NULL.  Return SVN_ERR_RA_NOT_IMPLEMENTED
+     if the server does not support fetching multiple files at once. */
+  svn_error_t *(*get_files)(svn_ra_session_t *session,
+                            const apr_array_header_t *targets,
+                            svn_boolean_t want_props,
+                            svn_ra_file_stream_func_t stream_func,
+                            void *stream_baton,
+                            apr_pool_t *scratch_pool);
+
   /* Experimental support below here */
 
   /* See svn_ra__register_editor_shim_callbacks() */
@@ -346,7 +346,7 @@ make_reporter(svn_ra_session_t *session,
                                               result_pool));
 
   /* Build a reporter baton. */
-  SVN_ERR(svn_repos_begin_report3(&rbaton,
+  SVN_ERR(svn_repos_begin_report4(&rbaton,
                                   revision,
                                   sess->repos,
                                   sess->fs_path->data,
@@ -365,8 +365,9 @@ make_reporter(svn_ra_session_t *session,
                                         zero-copy code path limitation (do
                                         not access FSFS data structures
                                         and, hence, caches).  See notes
-                                        to svn_repos_begin_report3() for
+                                        to svn_repos_begin_report4() for
                                         additional details. */
+                                  1,
                                   result_pool));
 
   /* Wrap the report baton given us by the repos layer with our own
@@ -1673,6 +1674,7 @@ svn_ra_local__has_capability(svn_ra_session_t *session,
       || strcmp(capability, SVN_RA_CAPABILITY_EPHEMERAL_TXNPROPS) == 0
       || strcmp(capability, SVN_RA_CAPABILITY_GET_FILE_REVS_REVERSE) == 0
       || strcmp(capability, SVN_RA_CAPABILITY_LIST) == 0
+      || strcmp(capability, SVN_RA_CAPABILITY_BLAME) == 0
       )
     {
       *has = TRUE;
@@ -1863,6 +1865,30 @@ svn_ra_local__list(svn_ra_session_t *session,
                                         sess->callback_baton, pool));
 }
 
+static svn_error_t *
+svn_ra_local__get_blame(svn_ra_session_t *session,
+                        const char *path,
+                        svn_revnum_t start,
+                        svn_revnum_t end,
+                        const apr_array_header_t *diff_options,
+                        svn_ra_blame_receiver_t receiver,
+                        void *receiver_baton,
+                        apr_pool_t *pool)
+{
+  svn_ra_local__session_baton_t *sess = session->priv;
+  const char *abs_path = svn_fspath__join(sess->fs_path->data, path, pool);
+
+  /* svn_repos_blame_receiver_t and svn_ra_blame_receiver_t share the
+     same signature. */
+  return svn_error_trace(svn_repos_blame(sess->repos, abs_path, start, end,
+                                         diff_options, NULL, NULL,
+                                         receiver, receiver_baton,
+                                         sess->callbacks
+                                           ? sess->callbacks->cancel_func
+                                           : NULL,
+                                         sess->callback_baton, pool));
+}
+
 /*----------------------------------------------------------------*/
 
 static const svn_version_t *
@@ -1914,6 +1940,9 @@ static const svn_ra__vtable_t ra_local_vtable =
   svn_ra_local__get_inherited_props,
   NULL /* set_svn_ra_open */,
   svn_ra_local__list ,
+  svn_ra_local__get_blame,
+  NULL /* get_dirs */,
+  NULL /* get_files */,
   svn_ra_local__register_editor_shim_callbacks,
   svn_ra_local__get_commit_ev2,
   NULL /* replay_range_ev2 */
@@ -40,6 +40,7 @@
 #include "private/svn_dep_compat.h"
 #include "private/svn_fspath.h"
 #include "private/svn_skel.h"
+#include "private/svn_subr_private.h"
 
 #include "ra_serf.h"
 #include "../libsvn_ra/ra_loader.h"
@@ -1873,7 +1874,15 @@ negotiate_put_encoding(int *svndiff_version_p,
   int svndiff_version;
   int compression_level;
 
-  if (session->using_compression == svn_tristate_unknown)
+  if (session->supports_svndiff3 &&
+      session->using_compression != svn_tristate_false)
+    {
+      /* svndiff3 is faster than svndiff1 and compresses as well or
+       * better, so we use it whenever both ends support it and the
+       * compression has not been disabled. */
+      svndiff_version = 3;
+    }
+  else if (session->using_compression == svn_tristate_unknown)
     {
       /* With http-compression=auto, prefer svndiff2 to svndiff1 with a
        * low latency connection (assuming the underlying network has high
@@ -1927,6 +1936,8 @@ negotiate_put_encoding(int *svndiff_version_p,
 
   if (svndiff_version == 0)
     compression_level = SVN_DELTA_COMPRESSION_LEVEL_NONE;
+  else if (svndiff_version == 3)
+    compression_level = SVN__COMPRESSION_ZSTD_DEFAULT;
   else
     compression_level = SVN_DELTA_COMPRESSION_LEVEL_DEFAULT;
 
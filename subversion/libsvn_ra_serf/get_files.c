@@ -0,0 +1,384 @@
+/*
+ * get_files.c :  entry point for the get_files RA function in ra_serf
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+
+
+
+#include <apr_md5.h>
+#include <serf.h>
+
+#include "svn_hash.h"
+#include "svn_pools.h"
+#include "svn_ra.h"
+#include "svn_dav.h"
+#include "svn_base64.h"
+#include "svn_delta.h"
+#include "svn_xml.h"
+#include "svn_props.h"
+#include "svn_string.h"
+
+#include "private/svn_subr_private.h"
+
+#include "svn_private_config.h"
+
+#include "ra_serf.h"
+#include "../libsvn_ra/ra_loader.h"
+
+
+
+/*
+ * This enum represents the current state of our XML parsing for a REPORT.
+ */
+enum get_files_state_e {
+  INITIAL = XML_STATE_INITIAL,
+  REPORT,
+  FILE_ELT,
+  SET_PROP,
+  TXDELTA
+};
+
+typedef struct get_files_context_t {
+  /* parameters set by our caller */
+  const apr_array_header_t *targets;
+  svn_boolean_t want_props;
+  svn_ra_file_stream_func_t stream_func;
+  void *stream_baton;
+
+  /* Index of the next target to be received. */
+  int next_target;
+
+  /* As we parse each FILE_ELT, we collect its properties here.  STREAM
+     is valid when we're in the TXDELTA state, processing the incoming
+     cdata.  It is NULL if the caller does not want the contents. */
+  apr_hash_t *props;
+  svn_stream_t *stream;
+
+  /* Checksum verification of the current file's contents. */
+  const char *path;
+  svn_checksum_t *expected_checksum;
+  unsigned char result_digest[APR_MD5_DIGESTSIZE];
+
+  svn_ra_serf__session_t *session;
+} get_files_context_t;
+
+#define D_ "DAV:"
+#define S_ SVN_XML_NAMESPACE
+static const svn_ra_serf__xml_transition_t get_files_ttable[] = {
+  { INITIAL, S_, "get-files-report", REPORT,
+    FALSE, { NULL }, FALSE },
+
+  { REPORT, S_, "file", FILE_ELT,
+    FALSE, { "path", "rev", "?checksum", NULL }, TRUE },
+
+  { FILE_ELT, S_, "set-prop", SET_PROP,
+    TRUE, { "name", "?encoding", NULL }, TRUE },
+
+  { FILE_ELT, S_, "txdelta", TXDELTA,
+    FALSE, { NULL }, TRUE },
+
+  { 0 }
+};
+
+/* Conforms to svn_ra_serf__xml_opened_t  */
+static svn_error_t *
+get_files_opened(svn_ra_serf__xml_estate_t *xes,
+                 void *baton,
+                 int entered_state,
+                 const svn_ra_serf__dav_props_t *tag,
+                 apr_pool_t *scratch_pool)
+{
+  get_files_context_t *gf_ctx = baton;
+
+  if (entered_state == FILE_ELT)
+    {
+      apr_pool_t *state_pool = svn_ra_serf__xml_state_pool(xes);
+
+      /* Child elements will store properties in here.  */
+      gf_ctx->props = gf_ctx->want_props ? apr_hash_make(state_pool) : NULL;
+    }
+  else if (entered_state == TXDELTA)
+    {
+      apr_pool_t *state_pool = svn_ra_serf__xml_state_pool(xes);
+      apr_hash_t *gathered = svn_ra_serf__xml_gather_since(xes, FILE_ELT);
+      const svn_ra_file_target_t *target;
+      const char *checksum;
+      svn_revnum_t revision;
+      svn_stream_t *stream;
+
+      /* The files arrive in the order they were requested. */
+      if (gf_ctx->next_target >= gf_ctx->targets->nelts)
+        return svn_error_create(SVN_ERR_RA_DAV_MALFORMED_DATA, NULL,
+                                _("Server sent more files than requested"));
+      target = APR_ARRAY_IDX(gf_ctx->targets, gf_ctx->next_target++,
+                             const svn_ra_file_target_t *);
+
+      SVN_ERR(svn_revnum_parse(&revision, svn_hash_gets(gathered, "rev"),
+                               NULL));
+      SVN_ERR(gf_ctx->stream_func(&stream, gf_ctx->stream_baton,
+                                  target->path, revision, gf_ctx->props,
+                                  state_pool));
+
+      gf_ctx->stream = NULL;
+      if (stream)
+        {
+          svn_txdelta_window_handler_t handler;
+          void *handler_baton;
+
+          checksum = svn_hash_gets(gathered, "checksum");
+          gf_ctx->expected_checksum = NULL;
+          if (checksum)
+            SVN_ERR(svn_checksum_parse_hex(&gf_ctx->expected_checksum,
+                                           svn_checksum_md5, checksum,
+                                           state_pool));
+          gf_ctx->path = apr_pstrdup(state_pool, target->path);
+
+          /* Applying the final window will close STREAM. */
+          svn_txdelta_apply(svn_stream_empty(state_pool), stream,
+                            gf_ctx->result_digest, target->path, state_pool,
+                            &handler, &handler_baton);
+          gf_ctx->stream = svn_base64_decode(svn_txdelta_parse_svndiff(
+                                               handler, handler_baton,
+                                               TRUE /* error_on_early_close */,
+                                               state_pool),
+                                             state_pool);
+        }
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Conforms to svn_ra_serf__xml_closed_t  */
+static svn_error_t *
+get_files_closed(svn_ra_serf__xml_estate_t *xes,
+                 void *baton,
+                 int leaving_state,
+                 const svn_string_t *cdata,
+                 apr_hash_t *attrs,
+                 apr_pool_t *scratch_pool)
+{
+  get_files_context_t *gf_ctx = baton;
+
+  if (leaving_state == SET_PROP)
+    {
+      const char *encoding = svn_hash_gets(attrs, "encoding");
+      apr_pool_t *state_pool;
+
+      /* We collect them only if they were requested. */
+      if (!gf_ctx->props)
+        return SVN_NO_ERROR;
+
+      state_pool = apr_hash_pool_get(gf_ctx->props);
+      if (encoding && strcmp(encoding, "base64") == 0)
+        cdata = svn_base64_decode_string(cdata, state_pool);
+      else
+        cdata = svn_string_dup(cdata, state_pool);
+
+      svn_hash_sets(gf_ctx->props,
+                    apr_pstrdup(state_pool, svn_hash_gets(attrs, "name")),
+                    cdata);
+    }
+  else if (leaving_state == TXDELTA && gf_ctx->stream)
+    {
+      SVN_ERR(svn_stream_close(gf_ctx->stream));
+      gf_ctx->stream = NULL;
+
+      if (gf_ctx->expected_checksum)
+        {
+          svn_checksum_t *actual_checksum
+            = svn_checksum__from_digest_md5(gf_ctx->result_digest,
+                                            scratch_pool);
+
+          if (!svn_checksum_match(gf_ctx->expected_checksum,
+                                  actual_checksum))
+            return svn_checksum_mismatch_err(gf_ctx->expected_checksum,
+                                             actual_checksum, scratch_pool,
+                                             _("Checksum mismatch for '%s'"),
+                                             gf_ctx->path);
+        }
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Conforms to svn_ra_serf__xml_cdata_t  */
+static svn_error_t *
+get_files_cdata(svn_ra_serf__xml_estate_t *xes,
+                void *baton,
+                int current_state,
+                const char *data,
+                apr_size_t len,
+                apr_pool_t *scratch_pool)
+{
+  get_files_context_t *gf_ctx = baton;
+
+  if (current_state == TXDELTA && gf_ctx->stream)
+    {
+      SVN_ERR(svn_stream_write(gf_ctx->stream, data, &len));
+      /* Ignore the returned LEN value.  */
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_ra_serf__request_body_delegate_t */
+static svn_error_t *
+create_get_files_body(serf_bucket_t **body_bkt,
+                      void *baton,
+                      serf_bucket_alloc_t *alloc,
+                      apr_pool_t *pool /* request pool */,
+                      apr_pool_t *scratch_pool)
+{
+  serf_bucket_t *buckets;
+  get_files_context_t *gf_ctx = baton;
+  int i;
+
+  buckets = serf_bucket_aggregate_create(alloc);
+
+  svn_ra_serf__add_open_tag_buckets(buckets, alloc,
+                                    "S:get-files-report",
+                                    "xmlns:S", SVN_XML_NAMESPACE,
+                                    SVN_VA_NULL);
+
+  if (gf_ctx->want_props)
+    svn_ra_serf__add_empty_tag_buckets(buckets, alloc,
+                                       "S:include-props", SVN_VA_NULL);
+
+  for (i = 0; i < gf_ctx->targets->nelts; i++)
+    {
+      const svn_ra_file_target_t *target
+        = APR_ARRAY_IDX(gf_ctx->targets, i, const svn_ra_file_target_t *);
+
+      if (SVN_IS_VALID_REVNUM(target->revision))
+        svn_ra_serf__add_open_tag_buckets(buckets, alloc, "S:file",
+                                          "rev", apr_ltoa(pool,
+                                                          target->revision),
+                                          SVN_VA_NULL);
+      else
+        svn_ra_serf__add_open_tag_buckets(buckets, alloc, "S:file",
+                                          SVN_VA_NULL);
+
+      svn_ra_serf__add_cdata_len_buckets(buckets, alloc, target->path,
+                                         strlen(target->path));
+      svn_ra_serf__add_close_tag_buckets(buckets, alloc, "S:file");
+    }
+
+  svn_ra_serf__add_close_tag_buckets(buckets, alloc,
+                                     "S:get-files-report");
+
+  *body_bkt = buckets;
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_ra_serf__request_header_delegate_t */
+static svn_error_t *
+setup_headers(serf_bucket_t *headers,
+              void *baton,
+              apr_pool_t *request_pool,
+              apr_pool_t *scratch_pool)
+{
+  get_files_context_t *gf_ctx = baton;
+
+  svn_ra_serf__setup_svndiff_accept_encoding(headers, gf_ctx->session);
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_ra_serf__get_files(svn_ra_session_t *ra_session,
+                       const apr_array_header_t *targets,
+                       svn_boolean_t want_props,
+                       svn_ra_file_stream_func_t stream_func,
+                       void *stream_baton,
+                       apr_pool_t *scratch_pool)
+{
+  get_files_context_t *gf_ctx;
+  svn_ra_serf__session_t *session = ra_session->priv;
+  svn_ra_serf__handler_t *handler;
+  svn_ra_serf__xml_context_t *xmlctx;
+  const char *req_url;
+  svn_revnum_t peg_rev = SVN_INVALID_REVNUM;
+  svn_boolean_t supported;
+  int i;
+
+  /* Let svn_ra_get_files() fall back to fetching one file at a time. */
+  SVN_ERR(svn_ra_serf__has_capability(ra_session, &supported,
+                                      SVN_RA_CAPABILITY_GET_FILES,
+                                      scratch_pool));
+  if (!supported)
+    return svn_error_create(SVN_ERR_RA_NOT_IMPLEMENTED, NULL,
+                            _("Server does not support fetching multiple "
+                              "files at once"));
+
+  if (targets->nelts == 0)
+    return SVN_NO_ERROR;
+
+  gf_ctx = apr_pcalloc(scratch_pool, sizeof(*gf_ctx));
+  gf_ctx->targets = targets;
+  gf_ctx->want_props = want_props;
+  gf_ctx->stream_func = stream_func;
+  gf_ctx->stream_baton = stream_baton;
+  gf_ctx->session = session;
+
+  /* If all files come from the same revision, use that as the peg
+     revision.  The session URL might not exist in HEAD. */
+  for (i = 0; i < targets->nelts; i++)
+    {
+      const svn_ra_file_target_t *target
+        = APR_ARRAY_IDX(targets, i, const svn_ra_file_target_t *);
+
+      if (i == 0)
+        peg_rev = target->revision;
+      else if (peg_rev != target->revision)
+        peg_rev = SVN_INVALID_REVNUM;
+    }
+
+  SVN_ERR(svn_ra_serf__get_stable_url(&req_url, NULL /* latest_revnum */,
+                                      session,
+                                      NULL /* url */, peg_rev,
+                                      scratch_pool, scratch_pool));
+
+  xmlctx = svn_ra_serf__xml_context_create(get_files_ttable,
+                                           get_files_opened,
+                                           get_files_closed,
+                                           get_files_cdata,
+                                           gf_ctx,
+                                           scratch_pool);
+  handler = svn_ra_serf__create_expat_handler(session, xmlctx, NULL,
+                                              scratch_pool);
+
+  handler->method = "REPORT";
+  handler->path = req_url;
+  handler->body_delegate = create_get_files_body;
+  handler->body_delegate_baton = gf_ctx;
+  handler->body_type = "text/xml";
+  handler->custom_accept_encoding = TRUE;
+  handler->header_delegate = setup_headers;
+  handler->header_delegate_baton = gf_ctx;
+
+  SVN_ERR(svn_ra_serf__context_run_one(handler, scratch_pool));
+
+  if (handler->sline.code != 200)
+    SVN_ERR(svn_ra_serf__unexpected_status(handler));
+
+  return SVN_NO_ERROR;
+}
@@ -91,6 +91,13 @@ typedef struct svn_ra_serf__connection_t {
  */
 #define SVN_RA_SERF__MAX_CONNECTIONS_LIMIT 8
 
+/** Maximum number of connections that the http-adaptive-connections
+ * option may grow a session to. */
+#define SVN_RA_SERF__ADAPTIVE_CONNECTIONS_LIMIT 32
+
+/** Maximum value we'll allow for the http-decode-threads config option. */
+#define SVN_RA_SERF__MAX_DECODE_THREADS 64
+
 /*
  * The master serf RA session.
  *
@@ -110,6 +117,13 @@ struct svn_ra_serf__session_t {
      fetch operations (updates, etc.) */
   apr_int64_t max_connections;
 
+  /* May we open more than MAX_CONNECTIONS connections as long as that
+     increases the throughput? */
+  svn_boolean_t adaptive_connections;
+
+  /* Number of threads to use for decoding fetched file contents. */
+  int decode_threads;
+
   /* Are we using ssl */
   svn_boolean_t using_ssl;
 
@@ -124,7 +138,7 @@ struct svn_ra_serf__session_t {
   const char *useragent;
 
   /* The current connection */
-  svn_ra_serf__connection_t *conns[SVN_RA_SERF__MAX_CONNECTIONS_LIMIT];
+  svn_ra_serf__connection_t *conns[SVN_RA_SERF__ADAPTIVE_CONNECTIONS_LIMIT];
   int num_conns;
   int cur_conn;
 
@@ -269,6 +283,9 @@ struct svn_ra_serf__session_t {
   /* Indicates whether the server can understand svndiff version 2. */
   svn_boolean_t supports_svndiff2;
 
+  /* Indicates whether the server can understand svndiff version 3. */
+  svn_boolean_t supports_svndiff3;
+
   /* Indicates whether the server sends the result checksum in the response
    * to a successful PUT request. */
   svn_boolean_t supports_put_result_checksum;
@@ -1443,6 +1460,26 @@ svn_ra_serf__list(svn_ra_session_t *ra_session,
                   void *receiver_baton,
                   apr_pool_t *scratch_pool);
 
+/* Implements svn_ra__vtable_t.get_blame(). */
+svn_error_t *
+svn_ra_serf__get_blame(svn_ra_session_t *ra_session,
+                       const char *path,
+                       svn_revnum_t start,
+                       svn_revnum_t end,
+                       const apr_array_header_t *diff_options,
+                       svn_ra_blame_receiver_t receiver,
+                       void *receiver_baton,
+                       apr_pool_t *scratch_pool);
+
+/* Implements svn_ra__vtable_t.get_files(). */
+svn_error_t *
+svn_ra_serf__get_files(svn_ra_session_t *ra_session,
+                       const apr_array_header_t *targets,
+                       svn_boolean_t want_props,
+                       svn_ra_file_stream_func_t stream_func,
+                       void *stream_baton,
+                       apr_pool_t *scratch_pool);
+
 /* Request a mergeinfo-report from the URL attached to SESSION,
    and fill in the MERGEINFO hash with the results.
 
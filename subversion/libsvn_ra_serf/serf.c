@@ -164,6 +164,7 @@ load_config(svn_ra_serf__session_t *session,
   const char *exceptions;
   apr_port_t proxy_port;
   svn_tristate_t chunked_requests;
+  apr_int64_t decode_threads;
 #if SERF_VERSION_AT_LEAST(1, 4, 0) && !defined(SVN_SERF_NO_LOGGING)
   apr_int64_t log_components;
   apr_int64_t log_level;
@@ -245,6 +246,17 @@ load_config(svn_ra_serf__session_t *session,
                                SVN_CONFIG_OPTION_HTTP_MAX_CONNECTIONS,
                                SVN_CONFIG_DEFAULT_OPTION_HTTP_MAX_CONNECTIONS));
 
+  /* Should we open additional connections beyond that number? */
+  SVN_ERR(svn_config_get_bool(config, &session->adaptive_connections,
+                              SVN_CONFIG_SECTION_GLOBAL,
+                              SVN_CONFIG_OPTION_HTTP_ADAPTIVE_CONNECTIONS,
+                              FALSE));
+
+  /* Load the number of threads used to decode file contents. */
+  SVN_ERR(svn_config_get_int64(config, &decode_threads,
+                               SVN_CONFIG_SECTION_GLOBAL,
+                               SVN_CONFIG_OPTION_HTTP_DECODE_THREADS, 1));
+
   /* Should we use chunked transfer encoding. */
   SVN_ERR(svn_config_get_tristate(config, &chunked_requests,
                                   SVN_CONFIG_SECTION_GLOBAL,
@@ -311,6 +323,14 @@ load_config(svn_ra_serf__session_t *session,
                                    server_group,
                                    SVN_CONFIG_OPTION_HTTP_MAX_CONNECTIONS,
                                    session->max_connections));
+      SVN_ERR(svn_config_get_bool(config, &session->adaptive_connections,
+                                  server_group,
+                                  SVN_CONFIG_OPTION_HTTP_ADAPTIVE_CONNECTIONS,
+                                  session->adaptive_connections));
+      SVN_ERR(svn_config_get_int64(config, &decode_threads,
+                                   server_group,
+                                   SVN_CONFIG_OPTION_HTTP_DECODE_THREADS,
+                                   decode_threads));
 
       /* Should we use chunked transfer encoding. */
       SVN_ERR(svn_config_get_tristate(config, &chunked_requests,
@@ -357,6 +377,10 @@ load_config(svn_ra_serf__session_t *session,
   if (session->max_connections < 2)
     session->max_connections = 2;
 
+  if (decode_threads > SVN_RA_SERF__MAX_DECODE_THREADS)
+    decode_threads = SVN_RA_SERF__MAX_DECODE_THREADS;
+  session->decode_threads = decode_threads < 1 ? 1 : (int)decode_threads;
+
   /* Parse the connection timeout value, if any. */
   session->timeout = apr_time_from_sec(DEFAULT_HTTP_TIMEOUT);
   if (timeout_str)
@@ -1064,6 +1088,9 @@ static const svn_ra__vtable_t serf_vtable = {
   svn_ra_serf__get_inherited_props,
   NULL /* set_svn_ra_open */,
   svn_ra_serf__list,
+  svn_ra_serf__get_blame,
+  NULL /* get_dirs */,
+  svn_ra_serf__get_files,
   svn_ra_serf__register_editor_shim_callbacks,
   NULL /* commit_ev2 */,
   NULL /* replay_range_ev2 */
@@ -40,11 +40,14 @@
 #include "svn_path.h"
 #include "svn_base64.h"
 #include "svn_props.h"
+#include "svn_sorts.h"
 
 #include "svn_private_config.h"
 #include "private/svn_dep_compat.h"
 #include "private/svn_fspath.h"
+#include "private/svn_parallel.h"
 #include "private/svn_string_private.h"
+#include "private/svn_subr_private.h"
 
 #include "ra_serf.h"
 #include "../libsvn_ra/ra_loader.h"
@@ -255,6 +258,27 @@ static const svn_ra_serf__xml_transition_t update_ttable[] = {
 #define REQUEST_COUNT_TO_PAUSE 50
 #define REQUEST_COUNT_TO_RESUME 40
 
+/* When adapting the number of connections, measure the throughput for at
+   least ADAPT_MIN_SAMPLE_TIME and at least ADAPT_RTTS_PER_SAMPLE round
+   trips before deciding whether the last connection we opened helped.
+   The latter gives the new connection's TCP window time to grow towards
+   the bandwidth-delay product of the link. */
+#define ADAPT_MIN_SAMPLE_TIME apr_time_from_msec(250)
+#define ADAPT_RTTS_PER_SAMPLE 8
+
+/* Keep opening connections only while each new one increases the
+   throughput by at least 1 / ADAPT_MIN_GAIN_DIVISOR, i.e. 10%. */
+#define ADAPT_MIN_GAIN_DIVISOR 10
+
+/* With http-decode-threads, svndiff responses up to this size get buffered
+   in memory and decoded by worker threads.  Larger ones are decoded while
+   they are being received, as usual. */
+#define DEFERRED_DECODE_LIMIT (1024 * 1024)
+
+/* Number of buffered svndiff responses per decoding thread to collect
+   before decoding them. */
+#define DEFERRED_FETCHES_PER_THREAD 4
+
 #define SPILLBUF_BLOCKSIZE 4096
 #define SPILLBUF_MAXBUFFSIZE 131072
 
@@ -388,6 +412,13 @@ typedef struct fetch_ctx_t {
   /* The base-rev header  */
   const char *delta_base;
 
+  /* If we buffer the svndiff response in order to decode it later on a
+     worker thread, this is the data received so far. */
+  svn_stringbuf_t *deferred;
+
+  /* When we queued the request. */
+  apr_time_t queued;
+
 } fetch_ctx_t;
 
 /*
@@ -453,6 +484,23 @@ struct report_context_t {
 
   /* Did we close the root directory? */
   svn_boolean_t closed_root;
+
+  /* Fetches whose svndiff response has been buffered completely but
+     still needs to be decoded, fetch_ctx_t *. */
+  apr_array_header_t *deferred_fetches;
+
+  /* State for http-adaptive-connections.  RTT is the shortest time seen
+     between queueing a GET and receiving its response, or 0 if there was
+     none yet.  The current throughput sample started at SAMPLE_START
+     (0 if none) and SAMPLE_BYTES have been received since.  LAST_RATE is
+     the rate in bytes per second before we opened the last connection,
+     or -1 if unknown.  ADAPT_DONE is set when we decided not to open any
+     further connections. */
+  apr_interval_time_t rtt;
+  apr_time_t sample_start;
+  apr_off_t sample_bytes;
+  apr_int64_t last_rate;
+  svn_boolean_t adapt_done;
 };
 
 static svn_error_t *
@@ -651,6 +699,92 @@ get_best_connection(report_context_t *ctx)
     }
   return conn;
 }
+
+/* Return TRUE if CTX should open a connection beyond the configured
+   maximum, given NUM_ACTIVE_REQS outstanding requests.
+
+   This is a simple hill climb: As long as all connections have enough
+   requests queued to keep them busy, we measure the throughput over a
+   few round trips and open another connection if the previous one
+   increased the throughput noticeably.  Once it didn't, we stop. */
+static svn_boolean_t
+adapt_connections(report_context_t *ctx,
+                  int num_active_reqs)
+{
+  svn_ra_serf__session_t *sess = ctx->sess;
+  apr_interval_time_t sample_time;
+  apr_time_t now;
+  apr_int64_t rate;
+
+  if (ctx->adapt_done
+      || sess->num_conns >= SVN_RA_SERF__ADAPTIVE_CONNECTIONS_LIMIT)
+    return FALSE;
+
+  /* Throughput is not limited by the connections if they are not busy.
+     Don't measure it, then. */
+  if ((num_active_reqs / REQS_PER_CONN) <= sess->num_conns)
+    {
+      ctx->sample_start = 0;
+      return FALSE;
+    }
+
+  now = apr_time_now();
+  if (ctx->sample_start == 0)
+    {
+      ctx->sample_start = now;
+      ctx->sample_bytes = 0;
+      return FALSE;
+    }
+
+  sample_time = MAX(ADAPT_MIN_SAMPLE_TIME, ctx->rtt * ADAPT_RTTS_PER_SAMPLE);
+  if (now - ctx->sample_start < sample_time)
+    return FALSE;
+
+  rate = ctx->sample_bytes * APR_USEC_PER_SEC / (now - ctx->sample_start);
+  if (ctx->last_rate >= 0
+      && rate < ctx->last_rate + ctx->last_rate / ADAPT_MIN_GAIN_DIVISOR)
+    {
+      ctx->adapt_done = TRUE;
+      return FALSE;
+    }
+
+  ctx->last_rate = rate;
+  ctx->sample_start = 0;
+  return TRUE;
+}
+
+/* Open another connection for CTX if the number of outstanding requests
+   calls for it. */
+static svn_error_t *
+open_report_connection_if_needed(report_context_t *ctx)
+{
+  svn_ra_serf__session_t *sess = ctx->sess;
+  int num_active_reqs = ctx->num_active_fetches + ctx->num_active_propfinds;
+
+  if (sess->num_conns < sess->max_connections
+      || (sess->adaptive_connections
+          && adapt_connections(ctx, num_active_reqs)))
+    SVN_ERR(open_connection_if_needed(sess, num_active_reqs));
+
+  return SVN_NO_ERROR;
+}
+
+/* Return the number of outstanding requests of CTX below which we
+   continue parsing the REPORT response.
+
+   With http-adaptive-connections, a new connection will only be opened
+   while all connections have a number of requests queued.  We must queue
+   enough requests for that to happen, so REQUEST_COUNT_TO_RESUME is raised
+   as the number of connections grows. */
+static unsigned int
+request_count_to_resume(const report_context_t *ctx)
+{
+  if (ctx->sess->adaptive_connections && !ctx->adapt_done)
+    return MAX(REQUEST_COUNT_TO_RESUME,
+               (ctx->sess->num_conns + 2) * REQS_PER_CONN);
+
+  return REQUEST_COUNT_TO_RESUME;
+}
 
 /** Helpers to open and close directories */
 
@@ -953,6 +1087,7 @@ handle_fetch(serf_request_t *request,
   apr_status_t status;
   fetch_ctx_t *fetch_ctx = handler_baton;
   file_baton_t *file = fetch_ctx->file;
+  report_context_t *ctx = file->parent_dir->ctx;
 
   /* ### new field. make sure we didn't miss some initialization.  */
   SVN_ERR_ASSERT(fetch_ctx->handler != NULL);
@@ -971,15 +1106,29 @@ handle_fetch(serf_request_t *request,
           return SVN_NO_ERROR; /* Will return an error in the DONE handler */
         }
 
+      if (fetch_ctx->queued)
+        {
+          apr_interval_time_t rtt = apr_time_now() - fetch_ctx->queued;
+
+          if (ctx->rtt == 0 || rtt < ctx->rtt)
+            ctx->rtt = rtt;
+          fetch_ctx->queued = 0;
+        }
+
       hdrs = serf_bucket_response_get_headers(response);
       val = serf_bucket_headers_get(hdrs, "Content-Type");
 
       if (val && svn_cstring_casecmp(val, SVN_SVNDIFF_MIME_TYPE) == 0)
         {
-          fetch_ctx->result_stream =
-              svn_txdelta_parse_svndiff(file->txdelta,
-                                        file->txdelta_baton,
-                                        TRUE, file->pool);
+          /* Leave decoding to worker threads, if we may.  See
+             decode_deferred_fetches(). */
+          if (fetch_ctx->session->decode_threads > 1)
+            fetch_ctx->deferred = svn_stringbuf_create_empty(file->pool);
+          else
+            fetch_ctx->result_stream =
+                svn_txdelta_parse_svndiff(file->txdelta,
+                                          file->txdelta_baton,
+                                          TRUE, file->pool);
 
           /* Validate the delta base claimed by the server matches
              what we asked for! */
@@ -1020,6 +1169,7 @@ handle_fetch(serf_request_t *request,
         }
 
       fetch_ctx->read_size += len;
+      ctx->sample_bytes += len;
 
       if (fetch_ctx->aborted_read)
         {
@@ -1049,7 +1199,25 @@ handle_fetch(serf_request_t *request,
           len -= (apr_size_t)skip;
         }
 
-      if (fetch_ctx->result_stream)
+      /* Too large to buffer?  Then decode it right here after all. */
+      if (fetch_ctx->deferred
+          && fetch_ctx->deferred->len + len > DEFERRED_DECODE_LIMIT)
+        {
+          apr_size_t buffered = fetch_ctx->deferred->len;
+
+          fetch_ctx->result_stream =
+              svn_txdelta_parse_svndiff(file->txdelta,
+                                        file->txdelta_baton,
+                                        TRUE, file->pool);
+          SVN_ERR(svn_stream_write(fetch_ctx->result_stream,
+                                   fetch_ctx->deferred->data, &buffered));
+          fetch_ctx->deferred = NULL;
+        }
+
+      if (fetch_ctx->deferred)
+        svn_stringbuf_appendbytes(fetch_ctx->deferred, data, len);
+
+      else if (fetch_ctx->result_stream)
         SVN_ERR(svn_stream_write(fetch_ctx->result_stream, data, &len));
 
       /* otherwise, manually construct the text delta window. */
@@ -1071,7 +1239,8 @@ handle_fetch(serf_request_t *request,
           SVN_ERR(file->txdelta(&delta_window, file->txdelta_baton));
         }
 
-      if (APR_STATUS_IS_EOF(status))
+      /* Deferred responses will be completed by decode_output(). */
+      if (APR_STATUS_IS_EOF(status) && !fetch_ctx->deferred)
         {
           if (fetch_ctx->result_stream)
             SVN_ERR(svn_stream_close(fetch_ctx->result_stream));
@@ -1191,6 +1360,14 @@ file_fetch_done(serf_request_t *request,
 
   file->parent_dir->ctx->num_active_fetches--;
 
+  if (fetch_ctx->deferred)
+    {
+      /* Still needs to be decoded.  See decode_deferred_fetches(). */
+      APR_ARRAY_PUSH(file->parent_dir->ctx->deferred_fetches,
+                     fetch_ctx_t *) = fetch_ctx;
+      return SVN_NO_ERROR;
+    }
+
   file->fetch_file = FALSE;
 
   if (file->fetch_props)
@@ -1205,6 +1382,143 @@ file_fetch_done(serf_request_t *request,
   return svn_error_trace(close_file(file, scratch_pool));
 }
 
+/* Baton for collect_window(). */
+typedef struct collect_baton_t
+{
+  /* Where to copy the windows to, svn_txdelta_window_t *, and the pool
+     to allocate them in. */
+  apr_array_header_t *windows;
+  apr_pool_t *pool;
+
+  /* Optional window handler to pass all windows on to. */
+  svn_txdelta_window_handler_t handler;
+  void *handler_baton;
+} collect_baton_t;
+
+/* Implements svn_txdelta_window_handler_t.  Copies WINDOW into the
+   collect_baton_t BATON. */
+static svn_error_t *
+collect_window(svn_txdelta_window_t *window,
+               void *baton)
+{
+  collect_baton_t *b = baton;
+
+  if (window)
+    APR_ARRAY_PUSH(b->windows, svn_txdelta_window_t *)
+      = svn_txdelta_window_dup(window, b->pool);
+
+  if (b->handler)
+    SVN_ERR(b->handler(window, b->handler_baton));
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_parallel__task_func_t.  BATON is the array of deferred
+   fetches.  Decode the buffered svndiff response of the IDX-th one into
+   an array of svn_txdelta_window_t * and return that.
+
+   Runs on a worker thread, so it must not touch anything but the fetch
+   itself.  If the delta has no base, also verify the checksum of the
+   resulting text here. */
+static svn_error_t *
+decode_task(void **result,
+            void *baton,
+            int idx,
+            svn_cancel_func_t cancel_func,
+            void *cancel_baton,
+            apr_pool_t *result_pool,
+            apr_pool_t *scratch_pool)
+{
+  const apr_array_header_t *fetches = baton;
+  const fetch_ctx_t *fetch_ctx = APR_ARRAY_IDX(fetches, idx,
+                                               const fetch_ctx_t *);
+  const file_baton_t *file = fetch_ctx->file;
+  unsigned char digest[APR_MD5_DIGESTSIZE];
+  apr_size_t len = fetch_ctx->deferred->len;
+  svn_stream_t *stream;
+  collect_baton_t b = { 0 };
+
+  b.windows = apr_array_make(result_pool, 4, sizeof(svn_txdelta_window_t *));
+  b.pool = result_pool;
+
+  if (!fetch_ctx->delta_base && file->final_md5_checksum)
+    svn_txdelta_apply(svn_stream_empty(scratch_pool),
+                      svn_stream_empty(scratch_pool),
+                      digest, file->relpath, scratch_pool,
+                      &b.handler, &b.handler_baton);
+
+  stream = svn_txdelta_parse_svndiff(collect_window, &b, TRUE, scratch_pool);
+  SVN_ERR(svn_stream_write(stream, fetch_ctx->deferred->data, &len));
+  SVN_ERR(svn_stream_close(stream));
+
+  if (b.handler)
+    {
+      svn_checksum_t *checksum = svn_checksum__from_digest_md5(digest,
+                                                               scratch_pool);
+
+      if (!svn_checksum_match(checksum, file->final_md5_checksum))
+        return svn_checksum_mismatch_err(file->final_md5_checksum, checksum,
+                                         scratch_pool,
+                                         _("Checksum mismatch for '%s'"),
+                                         file->relpath);
+    }
+
+  *result = b.windows;
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_parallel__output_func_t.  BATON is the array of deferred
+   fetches.  Pass the windows in RESULT to the IDX-th fetch's file and
+   close it, unless we are still waiting for its properties. */
+static svn_error_t *
+decode_output(void *baton,
+              int idx,
+              void *result,
+              svn_error_t *task_err,
+              apr_pool_t *scratch_pool)
+{
+  const apr_array_header_t *fetches = baton;
+  fetch_ctx_t *fetch_ctx = APR_ARRAY_IDX(fetches, idx, fetch_ctx_t *);
+  file_baton_t *file = fetch_ctx->file;
+  const apr_array_header_t *windows = result;
+  int i;
+
+  SVN_ERR(task_err);
+
+  for (i = 0; i < windows->nelts; i++)
+    SVN_ERR(file->txdelta(APR_ARRAY_IDX(windows, i, svn_txdelta_window_t *),
+                          file->txdelta_baton));
+  SVN_ERR(file->txdelta(NULL, file->txdelta_baton));
+
+  file->fetch_file = FALSE;
+
+  if (file->fetch_props)
+    return SVN_NO_ERROR; /* Still processing PROPFIND request */
+
+  /* This may destroy FETCH_CTX. */
+  return svn_error_trace(close_file(file, scratch_pool));
+}
+
+/* Decode all deferred fetches of CTX on up to http-decode-threads worker
+   threads and pass the results to the editor. */
+static svn_error_t *
+decode_deferred_fetches(report_context_t *ctx,
+                        apr_pool_t *scratch_pool)
+{
+  apr_array_header_t *fetches = ctx->deferred_fetches;
+
+  if (fetches->nelts == 0)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_parallel__run(fetches->nelts, ctx->sess->decode_threads, 0,
+                            decode_task, fetches, decode_output, fetches,
+                            ctx->sess->cancel_func, ctx->sess->cancel_baton,
+                            scratch_pool));
+  apr_array_clear(fetches);
+
+  return SVN_NO_ERROR;
+}
+
 /* Initiates additional requests needed for a file when not in "send-all" mode.
  */
 static svn_error_t *
@@ -1216,9 +1530,7 @@ fetch_for_file(file_baton_t *file,
   svn_ra_serf__handler_t *handler;
 
   /* Open extra connections if we have enough requests to send. */
-  if (ctx->sess->num_conns < ctx->sess->max_connections)
-    SVN_ERR(open_connection_if_needed(ctx->sess, ctx->num_active_fetches +
-                                                 ctx->num_active_propfinds));
+  SVN_ERR(open_report_connection_if_needed(ctx));
 
   /* What connection should we go on? */
   conn = get_best_connection(ctx);
@@ -1346,6 +1658,7 @@ fetch_for_file(file_baton_t *file,
           handler->done_delegate_baton = fetch_ctx;
 
           fetch_ctx->handler = handler;
+          fetch_ctx->queued = apr_time_now();
 
           svn_ra_serf__request_create(handler);
 
@@ -1444,9 +1757,7 @@ fetch_for_dir(dir_baton_t *dir,
   svn_ra_serf__connection_t *conn;
 
   /* Open extra connections if we have enough requests to send. */
-  if (ctx->sess->num_conns < ctx->sess->max_connections)
-    SVN_ERR(open_connection_if_needed(ctx->sess, ctx->num_active_fetches +
-                                                 ctx->num_active_propfinds));
+  SVN_ERR(open_report_connection_if_needed(ctx));
 
   /* What connection should we go on? */
   conn = get_best_connection(ctx);
@@ -2251,7 +2562,7 @@ update_delay_handler(serf_request_t *request,
         }
 
       while ((udb->report->num_active_fetches + udb->report->num_active_propfinds)
-                 < REQUEST_COUNT_TO_RESUME)
+                 < request_count_to_resume(udb->report))
         {
           const char *data;
           apr_size_t len;
@@ -2335,7 +2646,7 @@ process_pending(update_delay_baton_t *udb,
   serf_bucket_alloc_t *alloc = NULL;
 
   while ((udb->report->num_active_fetches + udb->report->num_active_propfinds)
-            < REQUEST_COUNT_TO_RESUME)
+            < request_count_to_resume(udb->report))
     {
       const char *data;
       apr_size_t len;
@@ -2419,6 +2730,7 @@ process_editor_report(report_context_t *ctx,
   while (!handler->done
          || ctx->num_active_fetches
          || ctx->num_active_propfinds
+         || ctx->deferred_fetches->nelts
          || !ctx->done)
     {
       svn_error_t *err;
@@ -2442,6 +2754,13 @@ process_editor_report(report_context_t *ctx,
       if (ud->spillbuf)
         SVN_ERR(process_pending(ud, iterpool));
 
+      /* Decode buffered file contents once there are enough to keep all
+         threads busy or when we would otherwise have to wait for them. */
+      if (ctx->deferred_fetches->nelts
+            >= sess->decode_threads * DEFERRED_FETCHES_PER_THREAD
+          || (ctx->deferred_fetches->nelts && !ctx->num_active_fetches))
+        SVN_ERR(decode_deferred_fetches(ctx, iterpool));
+
       /* Debugging purposes only! */
       for (i = 0; i < sess->num_conns; i++)
         {
@@ -2596,6 +2915,9 @@ make_update_reporter(svn_ra_session_t *ra_session,
   report->send_copyfrom_args = send_copyfrom_args;
   report->text_deltas = text_deltas;
   report->switched_paths = apr_hash_make(report->pool);
+  report->deferred_fetches = apr_array_make(report->pool, 0,
+                                            sizeof(fetch_ctx_t *));
+  report->last_rate = -1;
 
   report->source = src_path;
   report->destination = dest_path;
@@ -252,6 +252,199 @@ static svn_error_t *handle_auth_request(svn_ra_svn__session_baton_t *sess,
   return DO_AUTH(sess, mechlist, realm, pool);
 }
 
+/* --- COMMAND PIPELINING --- */
+
+/* Maximum number of commands that run_batch() keeps in flight.  This
+   limits the amount of request data that we write before reading any
+   responses, so that neither side blocks on a full socket buffer while
+   the other one is still writing, too. */
+#define BATCH_WINDOW_SIZE 64
+
+/* A command to be executed by run_batch(). */
+typedef struct batch_cmd_t
+{
+  /* Write the command to CONN.  Must not read anything from CONN. */
+  svn_error_t *(*send)(svn_ra_svn_conn_t *conn,
+                       void *baton,
+                       apr_pool_t *scratch_pool);
+
+  /* Read the command's response from CONN.  The auth request preceding
+     it has already been handled. */
+  svn_error_t *(*receive)(svn_ra_svn_conn_t *conn,
+                          void *baton,
+                          apr_pool_t *scratch_pool);
+
+  /* Passed to the callbacks above. */
+  void *baton;
+} batch_cmd_t;
+
+/* Return TRUE, if ERR indicates that the connection is no longer in
+   sync with the server, i.e. that we cannot read any further responses
+   from it. */
+static svn_boolean_t
+is_connection_error(svn_error_t *err)
+{
+  return svn_error_find_cause(err, SVN_ERR_RA_SVN_CONNECTION_CLOSED)
+      || svn_error_find_cause(err, SVN_ERR_RA_SVN_IO_ERROR)
+      || svn_error_find_cause(err, SVN_ERR_RA_SVN_MALFORMED_DATA)
+      || svn_error_find_cause(err, SVN_ERR_RA_SVN_REQUEST_SIZE)
+      || svn_error_find_cause(err, SVN_ERR_RA_SVN_RESPONSE_SIZE);
+}
+
+/* Read the auth request preceding a response to a pipelined command from
+   CONN.  Since we cannot authenticate in the middle of a pipeline, the
+   server must not actually ask for credentials. */
+static svn_error_t *
+read_pipelined_auth_request(svn_ra_svn_conn_t *conn,
+                            apr_pool_t *scratch_pool)
+{
+  svn_ra_svn__list_t *mechlist;
+  const char *realm;
+
+  SVN_ERR(svn_ra_svn__read_cmd_response(conn, scratch_pool, "lc",
+                                        &mechlist, &realm));
+  if (mechlist->nelts != 0)
+    return svn_error_create(SVN_ERR_RA_SVN_MALFORMED_DATA, NULL,
+                            _("Unexpected authentication request "
+                              "within a command pipeline"));
+
+  return SVN_NO_ERROR;
+}
+
+/* Execute CMD on SESS, handling authentication as usual. */
+static svn_error_t *
+run_cmd(svn_ra_svn__session_baton_t *sess,
+        const batch_cmd_t *cmd,
+        apr_pool_t *scratch_pool)
+{
+  SVN_ERR(cmd->send(sess->conn, cmd->baton, scratch_pool));
+  SVN_ERR(handle_auth_request(sess, scratch_pool));
+  SVN_ERR(cmd->receive(sess->conn, cmd->baton, scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Execute all batch_cmd_t in CMDS on SESS, calling their RECEIVE callbacks
+   in order.  Return the first error encountered.
+
+   If the server supports it, send the commands without waiting for the
+   previous responses.  Commands that the server rejected for lack of
+   authentication get retried individually afterwards, so that we can
+   authenticate as usual.  Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+run_batch(svn_ra_svn__session_baton_t *sess,
+          const apr_array_header_t *cmds,
+          apr_pool_t *scratch_pool)
+{
+  svn_ra_svn_conn_t *conn = sess->conn;
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  apr_array_header_t *retries;
+  svn_boolean_t started = FALSE;
+  svn_error_t *err = SVN_NO_ERROR;
+  int sent = 0;
+  int received = 0;
+  int i;
+
+  if (! svn_ra_svn_has_capability(conn, SVN_RA_SVN_CAP_PIPELINING))
+    {
+      for (i = 0; i < cmds->nelts; i++)
+        {
+          svn_pool_clear(iterpool);
+          SVN_ERR(run_cmd(sess, &APR_ARRAY_IDX(cmds, i, batch_cmd_t),
+                          iterpool));
+        }
+
+      svn_pool_destroy(iterpool);
+      return SVN_NO_ERROR;
+    }
+
+  /* Don't open a pipeline that we would never close. */
+  if (cmds->nelts == 0)
+    {
+      svn_pool_destroy(iterpool);
+      return SVN_NO_ERROR;
+    }
+
+  retries = apr_array_make(scratch_pool, 0, sizeof(const batch_cmd_t *));
+  SVN_ERR(svn_ra_svn__write_tuple(conn, iterpool, "w()", "begin-pipeline"));
+
+  /* Once a command failed, don't send any further ones but still read
+     the responses to those already sent. */
+  while (received < sent || (!err && sent < cmds->nelts))
+    {
+      const batch_cmd_t *cmd;
+      svn_error_t *cmd_err;
+
+      svn_pool_clear(iterpool);
+      while (!err && sent < cmds->nelts
+             && sent - received < BATCH_WINDOW_SIZE)
+        {
+          cmd = &APR_ARRAY_IDX(cmds, sent, batch_cmd_t);
+          SVN_ERR(cmd->send(conn, cmd->baton, iterpool));
+          sent++;
+        }
+
+      if (! started)
+        {
+          SVN_ERR(svn_ra_svn__read_cmd_response(conn, iterpool, ""));
+          started = TRUE;
+        }
+
+      cmd = &APR_ARRAY_IDX(cmds, received, batch_cmd_t);
+      received++;
+
+      cmd_err = read_pipelined_auth_request(conn, iterpool);
+      if (!cmd_err)
+        cmd_err = cmd->receive(conn, cmd->baton, iterpool);
+
+      if (!cmd_err)
+        continue;
+
+      if (is_connection_error(cmd_err))
+        {
+          svn_error_clear(err);
+          return svn_error_trace(cmd_err);
+        }
+
+      if (!err && svn_error_find_cause(cmd_err, SVN_ERR_RA_NOT_AUTHORIZED))
+        {
+          svn_error_clear(cmd_err);
+          APR_ARRAY_PUSH(retries, const batch_cmd_t *) = cmd;
+        }
+      else if (!err)
+        {
+          err = cmd_err;
+        }
+      else
+        {
+          svn_error_clear(cmd_err);
+        }
+    }
+
+  if (started)
+    {
+      svn_error_t *end_err;
+
+      svn_pool_clear(iterpool);
+      end_err = svn_ra_svn__write_tuple(conn, iterpool, "w()",
+                                        "end-pipeline");
+      if (!end_err)
+        end_err = svn_ra_svn__read_cmd_response(conn, iterpool, "");
+
+      err = svn_error_compose_create(err, end_err);
+    }
+
+  for (i = 0; !err && i < retries->nelts; i++)
+    {
+      svn_pool_clear(iterpool);
+      err = run_cmd(sess, APR_ARRAY_IDX(retries, i, const batch_cmd_t *),
+                    iterpool);
+    }
+
+  svn_pool_destroy(iterpool);
+  return svn_error_trace(err);
+}
+
 /* --- REPORTER IMPLEMENTATION --- */
 
 static svn_error_t *ra_svn_set_path(void *baton, const char *path,
@@ -747,7 +940,7 @@ static svn_error_t *open_session(svn_ra_svn__session_baton_t **sess_p,
    * capability list, and the URL, and subsequently there is an auth
    * request. */
   /* Client-side capabilities list: */
-  SVN_ERR(svn_ra_svn__write_tuple(conn, pool, "n(wwwwwww)cc(?c)",
+  SVN_ERR(svn_ra_svn__write_tuple(conn, pool, "n(wwwwwww?w)cc(?c)",
                                   (apr_uint64_t) 2,
                                   SVN_RA_SVN_CAP_EDIT_PIPELINE,
                                   SVN_RA_SVN_CAP_SVNDIFF1,
@@ -756,6 +949,9 @@ static svn_error_t *open_session(svn_ra_svn__session_baton_t **sess_p,
                                   SVN_RA_SVN_CAP_DEPTH,
                                   SVN_RA_SVN_CAP_MERGEINFO,
                                   SVN_RA_SVN_CAP_LOG_REVPROPS,
+                                  svn_zstd__is_available()
+                                    ? SVN_RA_SVN_CAP_SVNDIFF3_ACCEPTED
+                                    : NULL,
                                   url,
                                   SVN_RA_SVN__DEFAULT_USERAGENT,
                                   client_string));
@@ -1539,44 +1735,16 @@ send_dirent_fields(svn_ra_svn_conn_t *conn,
   return SVN_NO_ERROR;
 }
 
-static svn_error_t *ra_svn_get_dir(svn_ra_session_t *session,
-                                   apr_hash_t **dirents,
-                                   svn_revnum_t *fetched_rev,
-                                   apr_hash_t **props,
-                                   const char *path,
-                                   svn_revnum_t rev,
-                                   apr_uint32_t dirent_fields,
-                                   apr_pool_t *pool)
+/* Set *DIRENTS to a hash mapping entry names to svn_dirent_t * for the
+   directory listing DIRLIST as sent by the server in response to a
+   get-dir command.  Allocate the result in POOL. */
+static svn_error_t *
+parse_dirlist(apr_hash_t **dirents,
+              const svn_ra_svn__list_t *dirlist,
+              apr_pool_t *pool)
 {
-  svn_ra_svn__session_baton_t *sess_baton = session->priv;
-  svn_ra_svn_conn_t *conn = sess_baton->conn;
-  svn_ra_svn__list_t *proplist, *dirlist;
   int i;
 
-  path = reparent_path(session, path, pool);
-  SVN_ERR(svn_ra_svn__write_tuple(conn, pool, "w(c(?r)bb(!", "get-dir", path,
-                                  rev, (props != NULL), (dirents != NULL)));
-  SVN_ERR(send_dirent_fields(conn, dirent_fields, pool));
-
-  /* Always send the, nominally optional, want-iprops as "false" to
-     workaround a bug in svnserve 1.8.0-1.8.8 that causes the server
-     to see "true" if it is omitted. */
-  SVN_ERR(svn_ra_svn__write_tuple(conn, pool, "!)b)", FALSE));
-
-  SVN_ERR(handle_auth_request(sess_baton, pool));
-  SVN_ERR(svn_ra_svn__read_cmd_response(conn, pool, "rll", &rev, &proplist,
-                                        &dirlist));
-
-  if (fetched_rev)
-    *fetched_rev = rev;
-  if (props)
-    SVN_ERR(svn_ra_svn__parse_proplist(proplist, pool, props));
-
-  /* We're done if dirents aren't wanted. */
-  if (!dirents)
-    return SVN_NO_ERROR;
-
-  /* Interpret the directory list. */
   *dirents = svn_hash__make(pool);
   for (i = 0; i < dirlist->nelts; i++)
     {
@@ -1625,6 +1793,137 @@ static svn_error_t *ra_svn_get_dir(svn_ra_session_t *session,
   return SVN_NO_ERROR;
 }
 
+static svn_error_t *ra_svn_get_dir(svn_ra_session_t *session,
+                                   apr_hash_t **dirents,
+                                   svn_revnum_t *fetched_rev,
+                                   apr_hash_t **props,
+                                   const char *path,
+                                   svn_revnum_t rev,
+                                   apr_uint32_t dirent_fields,
+                                   apr_pool_t *pool)
+{
+  svn_ra_svn__session_baton_t *sess_baton = session->priv;
+  svn_ra_svn_conn_t *conn = sess_baton->conn;
+  svn_ra_svn__list_t *proplist, *dirlist;
+
+  path = reparent_path(session, path, pool);
+  SVN_ERR(svn_ra_svn__write_tuple(conn, pool, "w(c(?r)bb(!", "get-dir", path,
+                                  rev, (props != NULL), (dirents != NULL)));
+  SVN_ERR(send_dirent_fields(conn, dirent_fields, pool));
+
+  /* Always send the, nominally optional, want-iprops as "false" to
+     workaround a bug in svnserve 1.8.0-1.8.8 that causes the server
+     to see "true" if it is omitted. */
+  SVN_ERR(svn_ra_svn__write_tuple(conn, pool, "!)b)", FALSE));
+
+  SVN_ERR(handle_auth_request(sess_baton, pool));
+  SVN_ERR(svn_ra_svn__read_cmd_response(conn, pool, "rll", &rev, &proplist,
+                                        &dirlist));
+
+  if (fetched_rev)
+    *fetched_rev = rev;
+  if (props)
+    SVN_ERR(svn_ra_svn__parse_proplist(proplist, pool, props));
+
+  /* We're done if dirents aren't wanted. */
+  if (!dirents)
+    return SVN_NO_ERROR;
+
+  /* Interpret the directory list. */
+  return svn_error_trace(parse_dirlist(dirents, dirlist, pool));
+}
+
+/* Baton for a single get-dir command executed by ra_svn_get_dirs(). */
+typedef struct get_dirs_cmd_baton_t
+{
+  /* The directory to list, relative to the connection's URL. */
+  const char *path;
+
+  /* The path to use as key in RESULT. */
+  const char *key;
+
+  svn_revnum_t revision;
+  apr_uint32_t dirent_fields;
+
+  /* Where to store the directory's entries. */
+  apr_hash_t *result;
+  apr_pool_t *result_pool;
+} get_dirs_cmd_baton_t;
+
+/* Implements batch_cmd_t.send for get_dirs_cmd_baton_t. */
+static svn_error_t *
+get_dirs_send(svn_ra_svn_conn_t *conn,
+              void *baton,
+              apr_pool_t *scratch_pool)
+{
+  get_dirs_cmd_baton_t *b = baton;
+
+  SVN_ERR(svn_ra_svn__write_tuple(conn, scratch_pool, "w(c(?r)bb(!",
+                                  "get-dir", b->path, b->revision,
+                                  FALSE, TRUE));
+  SVN_ERR(send_dirent_fields(conn, b->dirent_fields, scratch_pool));
+
+  /* See ra_svn_get_dir() for why we always send want-iprops. */
+  SVN_ERR(svn_ra_svn__write_tuple(conn, scratch_pool, "!)b)", FALSE));
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements batch_cmd_t.receive for get_dirs_cmd_baton_t. */
+static svn_error_t *
+get_dirs_receive(svn_ra_svn_conn_t *conn,
+                 void *baton,
+                 apr_pool_t *scratch_pool)
+{
+  get_dirs_cmd_baton_t *b = baton;
+  svn_ra_svn__list_t *proplist, *dirlist;
+  svn_revnum_t rev;
+  apr_hash_t *entries;
+
+  SVN_ERR(svn_ra_svn__read_cmd_response(conn, scratch_pool, "rll", &rev,
+                                        &proplist, &dirlist));
+  SVN_ERR(parse_dirlist(&entries, dirlist, b->result_pool));
+  svn_hash_sets(b->result, b->key, entries);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+ra_svn_get_dirs(svn_ra_session_t *session,
+                apr_hash_t **dirents,
+                const apr_array_header_t *paths,
+                svn_revnum_t revision,
+                apr_uint32_t dirent_fields,
+                apr_pool_t *result_pool,
+                apr_pool_t *scratch_pool)
+{
+  svn_ra_svn__session_baton_t *sess_baton = session->priv;
+  apr_array_header_t *cmds = apr_array_make(scratch_pool, paths->nelts,
+                                            sizeof(batch_cmd_t));
+  int i;
+
+  *dirents = svn_hash__make(result_pool);
+  for (i = 0; i < paths->nelts; i++)
+    {
+      const char *path = APR_ARRAY_IDX(paths, i, const char *);
+      get_dirs_cmd_baton_t *b = apr_pcalloc(scratch_pool, sizeof(*b));
+      batch_cmd_t *cmd = apr_array_push(cmds);
+
+      b->path = reparent_path(session, path, scratch_pool);
+      b->key = apr_pstrdup(result_pool, path);
+      b->revision = revision;
+      b->dirent_fields = dirent_fields;
+      b->result = *dirents;
+      b->result_pool = result_pool;
+
+      cmd->send = get_dirs_send;
+      cmd->receive = get_dirs_receive;
+      cmd->baton = b;
+    }
+
+  return svn_error_trace(run_batch(sess_baton, cmds, scratch_pool));
+}
+
 /* Converts a apr_uint64_t with values TRUE, FALSE or
    SVN_RA_SVN_UNSPECIFIED_NUMBER as provided by svn_ra_svn__parse_tuple
    to a svn_tristate_t */
@@ -3073,6 +3372,8 @@ ra_svn_has_capability(svn_ra_session_t *session,
       {SVN_RA_CAPABILITY_GET_FILE_REVS_REVERSE,
                                        SVN_RA_SVN_CAP_GET_FILE_REVS_REVERSE},
       {SVN_RA_CAPABILITY_LIST, SVN_RA_SVN_CAP_LIST},
+      {SVN_RA_CAPABILITY_BLAME, SVN_RA_SVN_CAP_BLAME},
+      {SVN_RA_CAPABILITY_GET_FILES, SVN_RA_SVN_CAP_GET_FILES},
 
       {NULL, NULL} /* End of list marker */
   };
@@ -3242,6 +3543,207 @@ ra_svn_list(svn_ra_session_t *session,
   return SVN_NO_ERROR;
 }
 
+static svn_error_t *
+ra_svn_get_blame(svn_ra_session_t *session,
+                 const char *path,
+                 svn_revnum_t start,
+                 svn_revnum_t end,
+                 const apr_array_header_t *diff_options,
+                 svn_ra_blame_receiver_t receiver,
+                 void *receiver_baton,
+                 apr_pool_t *scratch_pool)
+{
+  svn_ra_svn__session_baton_t *sess_baton = session->priv;
+  svn_ra_svn_conn_t *conn = sess_baton->conn;
+  int i;
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+
+  path = reparent_path(session, path, scratch_pool);
+
+  /* Send the get-blame request. */
+  SVN_ERR(svn_ra_svn__write_tuple(conn, scratch_pool, "w(crr(!", "get-blame",
+                                  path, start, end));
+  for (i = 0; diff_options && i < diff_options->nelts; ++i)
+    {
+      const char *option = APR_ARRAY_IDX(diff_options, i, const char *);
+      SVN_ERR(svn_ra_svn__write_cstring(conn, scratch_pool, option));
+    }
+  SVN_ERR(svn_ra_svn__write_tuple(conn, scratch_pool, "!))"));
+
+  /* Handle auth request by server */
+  SVN_ERR(handle_auth_request(sess_baton, scratch_pool));
+
+  /* Read and process the line ranges. */
+  while (1)
+    {
+      svn_ra_svn__item_t *item;
+      apr_uint64_t start_line, end_line;
+      svn_revnum_t revision;
+      const char *author, *date;
+      apr_hash_t *rev_props = NULL;
+
+      svn_pool_clear(iterpool);
+
+      /* Read the next range or bail out on "done", respectively */
+      SVN_ERR(svn_ra_svn__read_item(conn, iterpool, &item));
+      if (is_done_response(item))
+        break;
+      if (item->kind != SVN_RA_SVN_LIST)
+        return svn_error_create(SVN_ERR_RA_SVN_MALFORMED_DATA, NULL,
+                                _("Blame entry not a list"));
+      SVN_ERR(svn_ra_svn__parse_tuple(&item->u.list, "nn(?r)(?c)(?c)",
+                                      &start_line, &end_line, &revision,
+                                      &author, &date));
+
+      /* Lines not changed within the requested range carry no revision
+         and therefore no revision properties, either. */
+      if (SVN_IS_VALID_REVNUM(revision))
+        {
+          rev_props = apr_hash_make(iterpool);
+          if (author)
+            svn_hash_sets(rev_props, SVN_PROP_REVISION_AUTHOR,
+                          svn_string_create(author, iterpool));
+          if (date)
+            svn_hash_sets(rev_props, SVN_PROP_REVISION_DATE,
+                          svn_string_create(date, iterpool));
+        }
+
+      /* Invoke RECEIVER */
+      SVN_ERR(receiver((apr_int64_t)start_line, (apr_int64_t)end_line,
+                       revision, rev_props, receiver_baton, iterpool));
+    }
+  svn_pool_destroy(iterpool);
+
+  /* Read the actual command response. */
+  SVN_ERR(svn_ra_svn__read_cmd_response(conn, scratch_pool, ""));
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+ra_svn_get_files(svn_ra_session_t *session,
+                 const apr_array_header_t *targets,
+                 svn_boolean_t want_props,
+                 svn_ra_file_stream_func_t stream_func,
+                 void *stream_baton,
+                 apr_pool_t *scratch_pool)
+{
+  svn_ra_svn__session_baton_t *sess_baton = session->priv;
+  svn_ra_svn_conn_t *conn = sess_baton->conn;
+  apr_pool_t *iterpool, *chunkpool;
+  int i;
+
+  /* Let svn_ra_get_files() fall back to individual get-file commands. */
+  if (!svn_ra_svn_has_capability(conn, SVN_RA_SVN_CAP_GET_FILES))
+    return svn_error_create(SVN_ERR_RA_NOT_IMPLEMENTED, NULL,
+                            _("Server does not support fetching multiple "
+                              "files at once"));
+
+  /* Send the get-files request. */
+  iterpool = svn_pool_create(scratch_pool);
+  chunkpool = svn_pool_create(scratch_pool);
+  SVN_ERR(svn_ra_svn__write_tuple(conn, scratch_pool, "w((!", "get-files"));
+  for (i = 0; i < targets->nelts; i++)
+    {
+      const svn_ra_file_target_t *target
+        = APR_ARRAY_IDX(targets, i, const svn_ra_file_target_t *);
+
+      svn_pool_clear(iterpool);
+      SVN_ERR(svn_ra_svn__write_tuple(conn, iterpool, "c(?r)",
+                                      reparent_path(session, target->path,
+                                                    iterpool),
+                                      target->revision));
+    }
+  SVN_ERR(svn_ra_svn__write_tuple(conn, scratch_pool, "!)b)", want_props));
+
+  /* Handle auth request by server */
+  SVN_ERR(handle_auth_request(sess_baton, scratch_pool));
+
+  /* Read and process the files.  They come in the order requested. */
+  for (i = 0; ; i++)
+    {
+      const svn_ra_file_target_t *target;
+      svn_ra_svn__item_t *item;
+      svn_ra_svn__list_t *proplist;
+      const char *path, *expected_digest;
+      svn_revnum_t revision;
+      svn_checksum_t *expected_checksum = NULL;
+      svn_checksum_ctx_t *checksum_ctx = NULL;
+      apr_hash_t *props = NULL;
+      svn_stream_t *stream;
+
+      svn_pool_clear(iterpool);
+
+      /* Read the next file header or bail out on "done", respectively */
+      SVN_ERR(svn_ra_svn__read_item(conn, iterpool, &item));
+      if (is_done_response(item))
+        break;
+      if (item->kind != SVN_RA_SVN_LIST || i >= targets->nelts)
+        return svn_error_create(SVN_ERR_RA_SVN_MALFORMED_DATA, NULL,
+                                _("File entry not a list"));
+      SVN_ERR(svn_ra_svn__parse_tuple(&item->u.list, "c(?c)rl", &path,
+                                      &expected_digest, &revision,
+                                      &proplist));
+
+      target = APR_ARRAY_IDX(targets, i, const svn_ra_file_target_t *);
+      if (want_props)
+        SVN_ERR(svn_ra_svn__parse_proplist(proplist, iterpool, &props));
+
+      SVN_ERR(stream_func(&stream, stream_baton, target->path, revision,
+                          props, iterpool));
+
+      if (stream && expected_digest)
+        {
+          SVN_ERR(svn_checksum_parse_hex(&expected_checksum,
+                                         svn_checksum_md5, expected_digest,
+                                         iterpool));
+          checksum_ctx = svn_checksum_ctx_create(svn_checksum_md5, iterpool);
+        }
+
+      /* Read the file's contents. */
+      while (1)
+        {
+          svn_pool_clear(chunkpool);
+          SVN_ERR(svn_ra_svn__read_item(conn, chunkpool, &item));
+          if (item->kind != SVN_RA_SVN_STRING)
+            return svn_error_create(SVN_ERR_RA_SVN_MALFORMED_DATA, NULL,
+                                    _("Non-string as part of file contents"));
+          if (item->u.string.len == 0)
+            break;
+
+          if (!stream)
+            continue;
+
+          if (checksum_ctx)
+            SVN_ERR(svn_checksum_update(checksum_ctx, item->u.string.data,
+                                        item->u.string.len));
+
+          SVN_ERR(svn_stream_write(stream, item->u.string.data,
+                                   &item->u.string.len));
+        }
+
+      if (stream)
+        SVN_ERR(svn_stream_close(stream));
+
+      if (checksum_ctx)
+        {
+          svn_checksum_t *checksum;
+
+          SVN_ERR(svn_checksum_final(&checksum, checksum_ctx, iterpool));
+          if (!svn_checksum_match(checksum, expected_checksum))
+            return svn_checksum_mismatch_err(expected_checksum, checksum,
+                                             iterpool,
+                                             _("Checksum mismatch for '%s'"),
+                                             path);
+        }
+    }
+  svn_pool_destroy(chunkpool);
+  svn_pool_destroy(iterpool);
+
+  /* Read the actual command response. */
+  SVN_ERR(svn_ra_svn__read_cmd_response(conn, scratch_pool, ""));
+  return SVN_NO_ERROR;
+}
+
 static const svn_ra__vtable_t ra_svn_vtable = {
   svn_ra_svn_version,
   ra_svn_get_description,
@@ -3282,6 +3784,9 @@ static const svn_ra__vtable_t ra_svn_vtable = {
   ra_svn_get_inherited_props,
   NULL /* ra_set_svn_ra_open */,
   ra_svn_list,
+  ra_svn_get_blame,
+  ra_svn_get_dirs,
+  ra_svn_get_files,
   ra_svn_register_editor_shim_callbacks,
   NULL /* commit_ev2 */,
   NULL /* replay_range_ev2 */
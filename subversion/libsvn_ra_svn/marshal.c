@@ -203,6 +203,10 @@ svn_ra_svn_conn_t *svn_ra_svn_create_conn5(apr_socket_t *sock,
   conn->read_ptr = conn->read_buf;
   conn->read_end = conn->read_buf;
   conn->write_pos = 0;
+  conn->prefetch = NULL;
+  conn->prefetch_pos = 0;
+  conn->prefetch_pool = NULL;
+  conn->scan_valid = FALSE;
   conn->written_since_error_check = 0;
   conn->error_check_interval = error_check_interval;
   conn->may_check_for_error = error_check_interval == 0;
@@ -273,13 +277,17 @@ svn_ra_svn__svndiff_version(svn_ra_svn_conn_t *conn)
   if (svn_ra_svn_compression_level(conn) <= 0)
     return 0;
 
-  /* Prefer SVNDIFF2 over SVNDIFF1. */
+  /* Prefer SVNDIFF3 over SVNDIFF2 over SVNDIFF1.  Data that we are
+   * sending is only encoded by us, so we need zstd support on both ends. */
+  if (svn_zstd__is_available()
+      && svn_ra_svn_has_capability(conn, SVN_RA_SVN_CAP_SVNDIFF3_ACCEPTED))
+    return 3;
   if (svn_ra_svn_has_capability(conn, SVN_RA_SVN_CAP_SVNDIFF2_ACCEPTED))
     return 2;
   if (svn_ra_svn_has_capability(conn, SVN_RA_SVN_CAP_SVNDIFF1))
     return 1;
 
-  /* The connection does not support SVNDIFF1/2; default to "version 0". */
+  /* The connection does not support SVNDIFF1/2/3; default to "version 0". */
   return 0;
 }
 
@@ -333,6 +341,12 @@ svn_ra_svn__set_block_handler(svn_ra_svn_conn_t *conn,
 svn_error_t *svn_ra_svn__data_available(svn_ra_svn_conn_t *conn,
                                        svn_boolean_t *data_available)
 {
+  if (conn->prefetch && conn->prefetch_pos < conn->prefetch->len)
+    {
+      *data_available = TRUE;
+      return SVN_NO_ERROR;
+    }
+
   return svn_ra_svn__stream_data_available(conn->stream, data_available);
 }
 
@@ -491,8 +505,8 @@ static char *readbuf_drain(svn_ra_svn_conn_t *conn, char *data, char *end)
 }
 
 /* Read data from socket or input file as appropriate. */
-static svn_error_t *readbuf_input(svn_ra_svn_conn_t *conn, char *data,
-                                  apr_size_t *len, apr_pool_t *pool)
+static svn_error_t *stream_input(svn_ra_svn_conn_t *conn, char *data,
+                                 apr_size_t *len, apr_pool_t *pool)
 {
   svn_ra_svn__session_baton_t *session = conn->session;
 
@@ -523,6 +537,30 @@ static svn_error_t *readbuf_input(svn_ra_svn_conn_t *conn, char *data,
   return SVN_NO_ERROR;
 }
 
+/* Read up to *LEN bytes of input from CONN into DATA, serving any data
+ * read ahead by svn_ra_svn__has_complete_command() first.  Set *LEN to
+ * the number of bytes actually read. */
+static svn_error_t *readbuf_input(svn_ra_svn_conn_t *conn, char *data,
+                                  apr_size_t *len, apr_pool_t *pool)
+{
+  if (conn->prefetch && conn->prefetch_pos < conn->prefetch->len)
+    {
+      apr_size_t available = conn->prefetch->len - conn->prefetch_pos;
+      if (*len > available)
+        *len = available;
+
+      memcpy(data, conn->prefetch->data + conn->prefetch_pos, *len);
+      conn->prefetch_pos += *len;
+
+      /* The I/O limits have already been checked while reading ahead.
+       * But the next command will start somewhere else now. */
+      conn->scan_valid = FALSE;
+      return SVN_NO_ERROR;
+    }
+
+  return svn_error_trace(stream_input(conn, data, len, pool));
+}
+
 /* Treat the next LEN input bytes from CONN as "read" */
 static svn_error_t *readbuf_skip(svn_ra_svn_conn_t *conn, apr_uint64_t len)
 {
@@ -536,9 +574,19 @@ static svn_error_t *readbuf_skip(svn_ra_svn_conn_t *conn, apr_uint64_t len)
       break;
 
     buflen = sizeof(conn->read_buf);
-    SVN_ERR(svn_ra_svn__stream_read(conn->stream, conn->read_buf, &buflen));
-    if (buflen == 0)
-      return svn_error_create(SVN_ERR_RA_SVN_CONNECTION_CLOSED, NULL, NULL);
+    if (conn->prefetch && conn->prefetch_pos < conn->prefetch->len)
+      {
+        /* Skip data read ahead by svn_ra_svn__has_complete_command(). */
+        SVN_ERR(readbuf_input(conn, conn->read_buf, &buflen, NULL));
+      }
+    else
+      {
+        SVN_ERR(svn_ra_svn__stream_read(conn->stream, conn->read_buf,
+                                        &buflen));
+        if (buflen == 0)
+          return svn_error_create(SVN_ERR_RA_SVN_CONNECTION_CLOSED, NULL,
+                                  NULL);
+      }
 
     conn->read_end = conn->read_buf + buflen;
     conn->read_ptr = conn->read_buf;
@@ -771,6 +819,122 @@ svn_ra_svn__write_cstring(svn_ra_svn_conn_t *conn,
   return SVN_NO_ERROR;
 }
 
+/* Maximum size of the strings that svn_ra_svn__write_file_range() splits
+ * its data into.  This limits the memory that the receiver needs to hold
+ * a single string. */
+#define FILE_RANGE_STRING_SIZE (1024 * 1024)
+
+#if APR_HAS_SENDFILE
+/* Send the LEN bytes at OFFSET in FILE directly to SOCK, bypassing the
+ * write buffer of CONN.  The write buffer must be empty. */
+static svn_error_t *
+sendfile_output(svn_ra_svn_conn_t *conn,
+                apr_pool_t *pool,
+                apr_socket_t *sock,
+                apr_file_t *file,
+                apr_off_t offset,
+                apr_size_t len)
+{
+  apr_pool_t *subpool = NULL;
+
+  /* Same limits as for buffered data.  See writebuf_output(). */
+  conn->current_out += len;
+  SVN_ERR(check_io_limits(conn));
+
+  conn->written_since_error_check += len;
+  conn->may_check_for_error
+    = conn->written_since_error_check >= conn->error_check_interval;
+
+  while (len > 0)
+    {
+      apr_off_t sent_offset = offset;
+      apr_size_t count = len;
+      apr_status_t status = apr_socket_sendfile(sock, file, NULL,
+                                                &sent_offset, &count, 0);
+
+      if (status && !APR_STATUS_IS_EAGAIN(status))
+        return svn_error_wrap_apr(status, _("Can't write to connection"));
+
+      if (count == 0)
+        {
+          if (!subpool)
+            subpool = svn_pool_create(pool);
+          else
+            svn_pool_clear(subpool);
+          SVN_ERR(conn->block_handler(conn, subpool, conn->block_baton));
+        }
+
+      offset += count;
+      len -= count;
+    }
+
+  if (subpool)
+    svn_pool_destroy(subpool);
+  return SVN_NO_ERROR;
+}
+#endif
+
+svn_error_t *
+svn_ra_svn__write_file_range(svn_ra_svn_conn_t *conn,
+                             apr_pool_t *pool,
+                             apr_file_t *file,
+                             apr_off_t offset,
+                             svn_filesize_t length)
+{
+  apr_socket_t *sock = NULL;
+  char *buffer = NULL;
+
+#if APR_HAS_SENDFILE
+  sock = svn_ra_svn__stream_socket(conn->stream);
+#endif
+
+  /* Without sendfile(), read the data sequentially through our buffer. */
+  if (sock == NULL)
+    {
+      apr_off_t start = offset;
+
+      buffer = apr_palloc(pool, SVN__STREAM_CHUNK_SIZE);
+      SVN_ERR(svn_io_file_seek(file, APR_SET, &start, pool));
+    }
+
+  while (length > 0)
+    {
+      apr_size_t string_len = length < FILE_RANGE_STRING_SIZE
+                            ? (apr_size_t)length
+                            : FILE_RANGE_STRING_SIZE;
+
+      SVN_ERR(write_number(conn, pool, string_len, ':'));
+
+#if APR_HAS_SENDFILE
+      if (sock)
+        {
+          SVN_ERR(writebuf_flush(conn, pool));
+          SVN_ERR(sendfile_output(conn, pool, sock, file, offset,
+                                  string_len));
+        }
+      else
+#endif
+        {
+          apr_size_t remaining = string_len;
+          while (remaining > 0)
+            {
+              apr_size_t count = MIN(remaining, SVN__STREAM_CHUNK_SIZE);
+
+              SVN_ERR(svn_io_file_read_full2(file, buffer, count, NULL, NULL,
+                                             pool));
+              SVN_ERR(writebuf_write(conn, pool, buffer, count));
+              remaining -= count;
+            }
+        }
+
+      SVN_ERR(writebuf_writechar(conn, pool, ' '));
+      offset += string_len;
+      length -= string_len;
+    }
+
+  return SVN_NO_ERROR;
+}
+
 svn_error_t *
 svn_ra_svn__write_word(svn_ra_svn_conn_t *conn,
                        apr_pool_t *pool,
@@ -1903,6 +2067,187 @@ svn_ra_svn__has_command(svn_boolean_t *has_command,
   return svn_error_trace(err);
 }
 
+/* Make all unread input of CONN, i.e. the rest of its read buffer and
+ * of its read-ahead buffer, the contents of the read-ahead buffer and
+ * restart the scan for the end of the next command at its beginning. */
+static void
+restart_command_scan(svn_ra_svn_conn_t *conn)
+{
+  apr_size_t buffered = conn->read_end - conn->read_ptr;
+  apr_size_t remaining = 0;
+
+  if (conn->prefetch)
+    remaining = conn->prefetch->len - conn->prefetch_pos;
+
+  /* Don't keep large buffers from previous requests around while the
+   * connection is idle. */
+  if (   conn->prefetch
+      && buffered + remaining == 0
+      && conn->prefetch->blocksize > SVN_RA_SVN__READBUF_SIZE)
+    {
+      svn_pool_clear(conn->prefetch_pool);
+      conn->prefetch = NULL;
+    }
+
+  if (!conn->prefetch)
+    {
+      if (!conn->prefetch_pool)
+        conn->prefetch_pool = svn_pool_create(conn->pool);
+
+      conn->prefetch = svn_stringbuf_create_ensure(SVN_RA_SVN__READBUF_SIZE,
+                                                   conn->prefetch_pool);
+    }
+
+  svn_stringbuf_ensure(conn->prefetch, buffered + remaining);
+  memmove(conn->prefetch->data + buffered,
+          conn->prefetch->data + conn->prefetch_pos, remaining);
+  memcpy(conn->prefetch->data, conn->read_ptr, buffered);
+  conn->prefetch->len = buffered + remaining;
+  conn->prefetch->data[conn->prefetch->len] = '\0';
+  conn->prefetch_pos = 0;
+  conn->read_ptr = conn->read_end;
+
+  conn->scan_pos = 0;
+  conn->scan_depth = 0;
+  conn->scan_number = 0;
+  conn->scan_skip = 0;
+  conn->scan_in_number = FALSE;
+  conn->scan_complete = FALSE;
+  conn->scan_valid = TRUE;
+
+  /* The next command starts here. */
+  svn_ra_svn__reset_command_io_counters(conn);
+  conn->current_in = conn->prefetch->len;
+}
+
+/* Continue the scan of the read-ahead buffer of CONN for the end of the
+ * next command, i.e. the closing parenthesis of the top-level tuple.
+ * This only needs to know about lists and strings; the actual parser
+ * will deal with malformed data. */
+static void
+scan_for_command_end(svn_ra_svn_conn_t *conn)
+{
+  const char *data = conn->prefetch->data;
+  apr_size_t len = conn->prefetch->len;
+  apr_size_t pos = conn->scan_pos;
+
+  while (pos < len && !conn->scan_complete)
+    {
+      char c;
+
+      /* Skip string contents in one go. */
+      if (conn->scan_skip)
+        {
+          apr_size_t count = len - pos;
+          if (count > conn->scan_skip)
+            count = (apr_size_t)conn->scan_skip;
+
+          pos += count;
+          conn->scan_skip -= count;
+          continue;
+        }
+
+      c = data[pos++];
+      if (conn->scan_in_number)
+        {
+          if (svn_ctype_isdigit(c))
+            {
+              conn->scan_number = conn->scan_number * 10 + (c - '0');
+              continue;
+            }
+
+          conn->scan_in_number = FALSE;
+          if (c == ':')
+            {
+              conn->scan_skip = conn->scan_number;
+              continue;
+            }
+        }
+
+      if (svn_ctype_isdigit(c))
+        {
+          conn->scan_in_number = TRUE;
+          conn->scan_number = c - '0';
+        }
+      else if (c == '(')
+        {
+          conn->scan_depth++;
+        }
+      else if (c == ')')
+        {
+          /* Also stop at unbalanced parentheses and let the parser
+           * report them. */
+          if (--conn->scan_depth <= 0)
+            conn->scan_complete = TRUE;
+        }
+    }
+
+  conn->scan_pos = pos;
+}
+
+svn_error_t *
+svn_ra_svn__has_complete_command(svn_boolean_t *has_command,
+                                 svn_boolean_t *terminated,
+                                 svn_ra_svn_conn_t *conn,
+                                 apr_pool_t *pool)
+{
+  *has_command = FALSE;
+  *terminated = FALSE;
+
+  /* Send any pending response before we wait for the next request. */
+  if (conn->write_pos)
+    SVN_ERR(writebuf_flush(conn, pool));
+
+#ifdef SVN_HAVE_SASL
+  /* SASL can only decode whole packets and reading a partial one would
+   * block until the rest of it arrives.  So, don't read ahead at all but
+   * report any input as a command.  Reading it is then left to the
+   * caller's command handler, which may block. */
+  if (conn->encrypted)
+    {
+      if (conn->read_ptr < conn->read_end)
+        *has_command = TRUE;
+      else
+        SVN_ERR(svn_ra_svn__data_available(conn, has_command));
+
+      return SVN_NO_ERROR;
+    }
+#endif
+
+  if (!conn->scan_valid)
+    restart_command_scan(conn);
+
+  scan_for_command_end(conn);
+  while (!conn->scan_complete)
+    {
+      svn_boolean_t available;
+      apr_size_t len = SVN_RA_SVN__READBUF_SIZE;
+      svn_error_t *err;
+
+      SVN_ERR(svn_ra_svn__stream_data_available(conn->stream, &available));
+      if (!available)
+        break;
+
+      svn_stringbuf_ensure(conn->prefetch, conn->prefetch->len + len);
+      err = stream_input(conn, conn->prefetch->data + conn->prefetch->len,
+                         &len, pool);
+      if (err && err->apr_err == SVN_ERR_RA_SVN_CONNECTION_CLOSED)
+        {
+          *terminated = TRUE;
+          svn_error_clear(err);
+          return SVN_NO_ERROR;
+        }
+      SVN_ERR(err);
+
+      conn->prefetch->len += len;
+      conn->prefetch->data[conn->prefetch->len] = '\0';
+      scan_for_command_end(conn);
+    }
+
+  *has_command = conn->scan_complete;
+  return SVN_NO_ERROR;
+}
+
 svn_error_t *
 svn_ra_svn__handle_command(svn_boolean_t *terminate,
                            apr_hash_t *cmd_hash,
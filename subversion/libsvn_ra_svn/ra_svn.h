@@ -81,6 +81,28 @@ struct svn_ra_svn_conn_st {
   char *read_end;
   apr_size_t write_pos;
 
+  /* Input read ahead by svn_ra_svn__has_complete_command() that has not
+     been consumed yet, i.e. everything from PREFETCH_POS onwards.  It
+     logically follows the unread part of READ_BUF.  PREFETCH is NULL
+     until first used and gets allocated in PREFETCH_POOL. */
+  svn_stringbuf_t *prefetch;
+  apr_size_t prefetch_pos;
+  apr_pool_t *prefetch_pool;
+
+  /* State of the scan for the end of the next command in PREFETCH.
+     Everything before SCAN_POS has been scanned.  SCAN_DEPTH is the
+     current list nesting level, SCAN_NUMBER the value of the number
+     being read if SCAN_IN_NUMBER is set and SCAN_SKIP the number of
+     string bytes still to skip.  If SCAN_VALID is not set, the scan
+     must start over because input has been consumed. */
+  apr_size_t scan_pos;
+  int scan_depth;
+  apr_uint64_t scan_number;
+  apr_uint64_t scan_skip;
+  svn_boolean_t scan_in_number;
+  svn_boolean_t scan_complete;
+  svn_boolean_t scan_valid;
+
   svn_ra_svn__stream_t *stream;
   svn_ra_svn__session_baton_t *session;
 #ifdef SVN_HAVE_SASL
@@ -235,6 +257,11 @@ svn_error_t *svn_ra_svn__read_command_only(svn_ra_svn_conn_t *conn,
                                            apr_pool_t *pool,
                                            const char **command);
 
+/* Return the socket that STREAM reads from and writes to without any
+   further processing.  Return NULL if there is no such socket, e.g.
+   for tunnels or when using SASL encryption. */
+apr_socket_t *svn_ra_svn__stream_socket(svn_ra_svn__stream_t *stream);
+
 /* Set the timeout for operations on STREAM to INTERVAL. */
 void svn_ra_svn__stream_timeout(svn_ra_svn__stream_t *stream,
                                 apr_interval_time_t interval);
@@ -226,6 +226,12 @@ typedef struct sorted_pattern_t
 
   /* Entry that is a prefix to this one or NULL. */
   struct sorted_pattern_t *next;
+
+  /* Only used for "complex" patterns that contain no wildcards other than
+   * '*'.  The literal (svn_string_t) pieces between the wildcards, such
+   * that matching does not need to parse the pattern again.  NULL for all
+   * other patterns. */
+  apr_array_header_t *pieces;
 } sorted_pattern_t;
 
 /* Substructure of node_t.  It contains all sub-node that use patterns
@@ -339,6 +345,82 @@ compare_node_path_segment(const void *void_lhs,
   return strcmp(element->node->segment.data, segment);
 }
 
+/* If PATTERN contains no wildcards but '*', return the literal pieces
+ * between them as an array of svn_string_t, allocated in RESULT_POOL.
+ * Return NULL otherwise.  Note that we will always find at least 2 pieces
+ * since PATTERN contains at least one '*'.
+ */
+static apr_array_header_t *
+compile_pattern(const svn_string_t *pattern,
+                apr_pool_t *result_pool)
+{
+  apr_array_header_t *pieces;
+  const char *start = pattern->data;
+  const char *end = pattern->data + pattern->len;
+  const char *p;
+
+  for (p = start; p < end; ++p)
+    if (*p == '?' || *p == '[' || *p == '\\')
+      return NULL;
+
+  pieces = apr_array_make(result_pool, 4, sizeof(svn_string_t));
+  for (p = start; p <= end; ++p)
+    if (p == end || *p == '*')
+      {
+        /* Pieces point into the interned PATTERN. */
+        svn_string_t *piece = apr_array_push(pieces);
+        piece->data = start;
+        piece->len = p - start;
+        start = p + 1;
+      }
+
+  return pieces;
+}
+
+/* Return TRUE, iff SEGMENT matches the pattern that has been compiled
+ * into PIECES by compile_pattern().
+ */
+static svn_boolean_t
+match_pieces(const apr_array_header_t *pieces,
+             const svn_stringbuf_t *segment)
+{
+  const svn_string_t *first = &APR_ARRAY_IDX(pieces, 0, svn_string_t);
+  const svn_string_t *last = &APR_ARRAY_IDX(pieces, pieces->nelts - 1,
+                                            svn_string_t);
+  apr_size_t pos, end;
+  int i;
+
+  /* The first piece must match at the start and the last piece at the
+   * end of SEGMENT, without overlapping. */
+  if (first->len + last->len > segment->len)
+    return FALSE;
+
+  if (   memcmp(segment->data, first->data, first->len)
+      || memcmp(segment->data + segment->len - last->len, last->data,
+                last->len))
+    return FALSE;
+
+  /* Find the remaining pieces in order.  Taking the leftmost match each
+   * time is sufficient as '*' may skip over any number of chars. */
+  pos = first->len;
+  end = segment->len - last->len;
+  for (i = 1; i < pieces->nelts - 1; ++i)
+    {
+      const svn_string_t *piece = &APR_ARRAY_IDX(pieces, i, svn_string_t);
+
+      while (   pos + piece->len <= end
+             && memcmp(segment->data + pos, piece->data, piece->len))
+        ++pos;
+
+      if (pos + piece->len > end)
+        return FALSE;
+
+      pos += piece->len;
+    }
+
+  return TRUE;
+}
+
 /* Make sure a node_t* for SEGMENT exists in *ARRAY and return it.
  * Auto-create either if they don't exist.  Entries in *ARRAY are
  * sorted by their segment strings.
@@ -369,6 +451,9 @@ ensure_node_in_array(apr_array_header_t **array,
    * Create one and insert it into the sorted array. */
   entry.node = create_node(segment, result_pool);
   entry.next = NULL;
+  entry.pieces = segment->kind == authz_rule_fnmatch
+               ? compile_pattern(&segment->pattern, result_pool)
+               : NULL;
   svn_sort__array_insert(*array, &entry, idx);
 
   return entry.node;
@@ -967,6 +1052,20 @@ create_user_authz(authz_full_t *authz,
 
 /*** Lookup. ***/
 
+/* The lookup state for one parent path level, i.e. for the path in
+ * lookup_state_t's PARENT_PATH up to PATH_LEN. */
+typedef struct lookup_level_t
+{
+  /* Nodes applying to the path at this level. */
+  apr_array_header_t *nodes;
+
+  /* Rights that apply at this level. */
+  limited_rights_t rights;
+
+  /* Length of the path of this level within PARENT_PATH. */
+  apr_size_t path_len;
+} lookup_level_t;
+
 /* Reusable lookup state object. It is easy to pass to functions and
  * recycling it between lookups saves significant setup costs. */
 typedef struct lookup_state_t
@@ -992,6 +1091,17 @@ typedef struct lookup_state_t
   /* Rights that apply at PARENT_PATH, if PARENT_PATH is not empty. */
   limited_rights_t parent_rights;
 
+  /* Stack of lookup_level_t for the root and all parent paths of
+   * PARENT_PATH, including PARENT_PATH itself.  The first DEPTH entries
+   * are valid and the last one of those corresponds to CURRENT and
+   * PARENT_RIGHTS.  Tree walks like the reporter's will typically continue
+   * with a sibling of some parent path, so we can resume from here. */
+  apr_array_header_t *levels;
+  int depth;
+
+  /* For allocating new LEVELS. */
+  apr_pool_t *pool;
+
 } lookup_state_t;
 
 /* Constructor for lookup_state_t. */
@@ -1001,7 +1111,8 @@ create_lookup_state(apr_pool_t *result_pool)
   lookup_state_t *state = apr_pcalloc(result_pool, sizeof(*state));
  
   state->next = apr_array_make(result_pool, 4, sizeof(node_t *));
-  state->current = apr_array_make(result_pool, 4, sizeof(node_t *));
+  state->levels = apr_array_make(result_pool, 8, sizeof(lookup_level_t));
+  state->pool = result_pool;
 
   /* Virtually all path segments should fit into this buffer.  If they
    * don't, the buffer gets automatically reallocated.
@@ -1018,6 +1129,36 @@ create_lookup_state(apr_pool_t *result_pool)
   return state;
 }
 
+/* Make the node list in STATE->NEXT the one for the next level in STATE,
+ * with the current rights and parent path.  Recycle the level's previous
+ * node list as STATE->NEXT. */
+static void
+push_lookup_level(lookup_state_t *state)
+{
+  lookup_level_t *level;
+  apr_array_header_t *temp;
+
+  if (state->depth == state->levels->nelts)
+    {
+      level = apr_array_push(state->levels);
+      level->nodes = apr_array_make(state->pool, 4, sizeof(node_t *));
+    }
+  else
+    {
+      level = &APR_ARRAY_IDX(state->levels, state->depth, lookup_level_t);
+    }
+
+  temp = level->nodes;
+  level->nodes = state->next;
+  level->rights = state->rights;
+  level->path_len = state->parent_path->len;
+  ++state->depth;
+
+  state->current = level->nodes;
+  state->parent_rights = state->rights;
+  state->next = temp;
+}
+
 /* Clear the current contents of STATE and re-initialize it for ROOT.
  * Check whether we can reuse a previous parent path lookup to shorten
  * the current PATH walk.  Return the full or remaining portion of
@@ -1028,27 +1169,36 @@ init_lockup_state(lookup_state_t *state,
                   const char *path)
 {
   apr_size_t len = strlen(path);
-  if (   (len > state->parent_path->len)
-      && state->parent_path->len
-      && (path[state->parent_path->len] == '/')
-      && !memcmp(path, state->parent_path->data, state->parent_path->len))
+
+  /* Find the deepest level that is actually a parent path of PATH.
+   * Its node list already matches that parent path and we only have to
+   * set the correct rights info.  The root level is handled below. */
+  for (; state->depth > 1; --state->depth)
     {
-      /* The PARENT_PATH of the previous lookup is actually a parent path
-       * of PATH.  The CURRENT node list already matches the parent path
-       * and we only have to set the correct rights info. */
-      state->rights = state->parent_rights;
+      const lookup_level_t *level
+        = &APR_ARRAY_IDX(state->levels, state->depth - 1, lookup_level_t);
 
-      /* Tell the caller where to proceed. */
-      return path + state->parent_path->len;
+      if (   (len > level->path_len)
+          && (path[level->path_len] == '/')
+          && !memcmp(path, state->parent_path->data, level->path_len))
+        {
+          state->current = level->nodes;
+          state->rights = level->rights;
+          state->parent_rights = level->rights;
+          svn_stringbuf_remove(state->parent_path, level->path_len,
+                               state->parent_path->len - level->path_len);
+
+          /* Tell the caller where to proceed. */
+          return path + level->path_len;
+        }
     }
 
   /* Start lookup at ROOT for the full PATH. */
   state->rights = root->rights;
-  state->parent_rights = root->rights;
+  state->depth = 0;
 
   apr_array_clear(state->next);
-  apr_array_clear(state->current);
-  APR_ARRAY_PUSH(state->current, node_t *) = root;
+  APR_ARRAY_PUSH(state->next, node_t *) = root;
 
   /* Var-segment rules match empty segments as well */
   if (root->pattern_sub_nodes && root->pattern_sub_nodes->any_var)
@@ -1058,12 +1208,17 @@ init_lockup_state(lookup_state_t *state,
       /* This is non-recursive due to ACL normalization. */
       combine_access(&state->rights, &node->rights);
       combine_right_limits(&state->rights, &node->rights);
-      APR_ARRAY_PUSH(state->current, node_t *) = node;
+      APR_ARRAY_PUSH(state->next, node_t *) = node;
    }
 
   svn_stringbuf_setempty(state->parent_path);
   svn_stringbuf_setempty(state->scratch_pad);
 
+  /* The root level has an empty path.  Its sub-nodes inherit the rights
+   * of ROOT itself. */
+  push_lookup_level(state);
+  state->parent_rights = root->rights;
+
   return path;
 }
 
@@ -1165,9 +1320,12 @@ add_complex_matches(lookup_state_t *state,
   int i;
   for (i = 0; i < patterns->nelts; ++i)
     {
-      node_t *node = APR_ARRAY_IDX(patterns, i, sorted_pattern_t).node;
-      if (0 == apr_fnmatch(node->segment.data, segment->data, 0))
-        add_next_node(state, node);
+      const sorted_pattern_t *pattern
+        = &APR_ARRAY_IDX(patterns, i, sorted_pattern_t);
+      if (pattern->pieces
+            ? match_pieces(pattern->pieces, segment)
+            : 0 == apr_fnmatch(pattern->node->segment.data, segment->data, 0))
+        add_next_node(state, pattern->node);
     }
 }
 
@@ -1259,7 +1417,6 @@ lookup(lookup_state_t *state,
    * either tree or PATH. */
   while (state->current->nelts && path)
     {
-      apr_array_header_t *temp;
       int i;
       svn_stringbuf_t *segment = state->scratch_pad;
 
@@ -1353,12 +1510,8 @@ lookup(lookup_state_t *state,
        */
       if (path)
         {
-          temp = state->current;
-          state->current = state->next;
-          state->next = temp;
-
           /* In STATE, PARENT_PATH, PARENT_RIGHTS and CURRENT are now in sync. */
-          state->parent_rights = state->rights;
+          push_lookup_level(state);
         }
     }
 
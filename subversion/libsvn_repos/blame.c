@@ -0,0 +1,437 @@
+/* blame.c : calculating blame information inside the repository
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#include <apr_pools.h>
+
+#include "svn_pools.h"
+#include "svn_error.h"
+#include "svn_diff.h"
+#include "svn_hash.h"
+#include "svn_io.h"
+#include "svn_props.h"
+#include "svn_repos.h"
+#include "svn_sorts.h"
+
+#include "svn_private_config.h"
+
+#include "repos.h"
+
+
+
+/* The blame chain below works like the one in libsvn_client/blame.c.
+ * However, the chain always ends with a chunk without revision that
+ * starts right behind the last line of the file.  This allows us to
+ * report the line ranges without having to count the lines separately.
+ */
+
+/* The revision that is responsible for a chunk of blame. */
+struct rev
+{
+  svn_revnum_t revision; /* the revision number */
+  apr_hash_t *rev_props; /* author and date, NULL outside the range */
+};
+
+/* One chunk of blame */
+struct blame
+{
+  const struct rev *rev;    /* the responsible revision */
+  apr_off_t start;          /* the starting diff-token (line) */
+  struct blame *next;       /* the next chunk */
+};
+
+/* A chain of blame chunks */
+struct blame_chain
+{
+  struct blame *blame;      /* linked list of blame chunks */
+  struct blame *avail;      /* linked list of free blame chunks */
+  apr_pool_t *pool;         /* Allocate members from this pool. */
+};
+
+/* The baton use for the diff output routine. */
+struct diff_baton
+{
+  struct blame_chain *chain;
+  const struct rev *rev;
+};
+
+/* The baton used for the whole svn_repos_blame() call. */
+struct blame_baton
+{
+  /* Where to get the file contents from. */
+  svn_fs_t *fs;
+
+  /* Revisions older than this are not part of the blame range. */
+  svn_revnum_t start;
+
+  const svn_diff_file_options_t *diff_options;
+  struct blame_chain chain;
+
+  /* name of file containing the previous revision of the file */
+  const char *last_filename;
+
+  svn_cancel_func_t cancel_func;
+  void *cancel_baton;
+
+  apr_pool_t *mainpool;  /* lives during the whole sequence of calls */
+  apr_pool_t *lastpool;  /* pool used during previous call */
+  apr_pool_t *currpool;  /* pool used during this call */
+};
+
+/* Marks the end of the file in the blame chain. */
+static const struct rev end_of_file = { SVN_INVALID_REVNUM, NULL };
+
+
+
+/* Return a blame chunk associated with REV for a change starting
+   at token START, and allocated in CHAIN->pool. */
+static struct blame *
+blame_create(struct blame_chain *chain,
+             const struct rev *rev,
+             apr_off_t start)
+{
+  struct blame *blame;
+  if (chain->avail)
+    {
+      blame = chain->avail;
+      chain->avail = blame->next;
+    }
+  else
+    blame = apr_palloc(chain->pool, sizeof(*blame));
+  blame->rev = rev;
+  blame->start = start;
+  blame->next = NULL;
+  return blame;
+}
+
+/* Destroy a blame chunk. */
+static void
+blame_destroy(struct blame_chain *chain,
+              struct blame *blame)
+{
+  blame->next = chain->avail;
+  chain->avail = blame;
+}
+
+/* Return the blame chunk that contains token OFF, starting the search at
+   BLAME. */
+static struct blame *
+blame_find(struct blame *blame, apr_off_t off)
+{
+  struct blame *prev = NULL;
+  while (blame)
+    {
+      if (blame->start > off) break;
+      prev = blame;
+      blame = blame->next;
+    }
+  return prev;
+}
+
+/* Shift the start-point of BLAME and all subsequence blame-chunks
+   by ADJUST tokens */
+static void
+blame_adjust(struct blame *blame, apr_off_t adjust)
+{
+  while (blame)
+    {
+      blame->start += adjust;
+      blame = blame->next;
+    }
+}
+
+/* Delete the blame associated with the region from token START to
+   START + LENGTH */
+static void
+blame_delete_range(struct blame_chain *chain,
+                   apr_off_t start,
+                   apr_off_t length)
+{
+  struct blame *first = blame_find(chain->blame, start);
+  struct blame *last = blame_find(chain->blame, start + length);
+  struct blame *tail = last->next;
+
+  if (first != last)
+    {
+      struct blame *walk = first->next;
+      while (walk != last)
+        {
+          struct blame *next = walk->next;
+          blame_destroy(chain, walk);
+          walk = next;
+        }
+      first->next = last;
+      last->start = start;
+      if (first->start == start)
+        {
+          *first = *last;
+          blame_destroy(chain, last);
+          last = first;
+        }
+    }
+
+  if (tail && tail->start == last->start + length)
+    {
+      *last = *tail;
+      blame_destroy(chain, tail);
+      tail = last->next;
+    }
+
+  blame_adjust(tail, -length);
+}
+
+/* Insert a chunk of blame associated with REV starting
+   at token START and continuing for LENGTH tokens */
+static void
+blame_insert_range(struct blame_chain *chain,
+                   const struct rev *rev,
+                   apr_off_t start,
+                   apr_off_t length)
+{
+  struct blame *head = chain->blame;
+  struct blame *point = blame_find(head, start);
+  struct blame *insert;
+
+  if (point->start == start)
+    {
+      insert = blame_create(chain, point->rev, point->start + length);
+      point->rev = rev;
+      insert->next = point->next;
+      point->next = insert;
+    }
+  else
+    {
+      struct blame *middle;
+      middle = blame_create(chain, rev, start);
+      insert = blame_create(chain, point->rev, start + length);
+      middle->next = insert;
+      insert->next = point->next;
+      point->next = middle;
+    }
+  blame_adjust(insert->next, length);
+}
+
+/* Callback for diff between subsequent revisions */
+static svn_error_t *
+output_diff_modified(void *baton,
+                     apr_off_t original_start,
+                     apr_off_t original_length,
+                     apr_off_t modified_start,
+                     apr_off_t modified_length,
+                     apr_off_t latest_start,
+                     apr_off_t latest_length)
+{
+  struct diff_baton *db = baton;
+
+  if (original_length)
+    blame_delete_range(db->chain, modified_start, original_length);
+
+  if (modified_length)
+    blame_insert_range(db->chain, db->rev, modified_start, modified_length);
+
+  return SVN_NO_ERROR;
+}
+
+static const svn_diff_output_fns_t output_fns = {
+        NULL,
+        output_diff_modified
+};
+
+/* Return a copy of those REV_PROPS that we report to the blame receiver,
+   allocated in RESULT_POOL. */
+static apr_hash_t *
+copy_blame_rev_props(apr_hash_t *rev_props,
+                     apr_pool_t *result_pool)
+{
+  apr_hash_t *result = apr_hash_make(result_pool);
+  const svn_string_t *value;
+
+  value = svn_hash_gets(rev_props, SVN_PROP_REVISION_AUTHOR);
+  if (value)
+    svn_hash_sets(result, SVN_PROP_REVISION_AUTHOR,
+                  svn_string_dup(value, result_pool));
+
+  value = svn_hash_gets(rev_props, SVN_PROP_REVISION_DATE);
+  if (value)
+    svn_hash_sets(result, SVN_PROP_REVISION_DATE,
+                  svn_string_dup(value, result_pool));
+
+  return result;
+}
+
+/* Update the blame chain in BATON for the contents of PATH in REVNUM.
+ *
+ * Unlike the client, we don't need the text deltas.  Instead, we read
+ * the fulltext directly from the repository and diff it against the
+ * previous one.
+ *
+ * Implements svn_file_rev_handler_t.
+ */
+static svn_error_t *
+file_rev_handler(void *baton,
+                 const char *path,
+                 svn_revnum_t revnum,
+                 apr_hash_t *rev_props,
+                 svn_boolean_t merged_revision,
+                 svn_txdelta_window_handler_t *content_delta_handler,
+                 void **content_delta_baton,
+                 apr_array_header_t *prop_diffs,
+                 apr_pool_t *pool)
+{
+  struct blame_baton *bb = baton;
+  struct diff_baton diff_baton;
+  struct rev *rev;
+  svn_fs_root_t *root;
+  svn_stream_t *contents;
+  svn_stream_t *cur_stream;
+  const char *filename;
+  svn_diff_t *diff;
+  apr_pool_t *tmp_pool;
+
+  if (bb->cancel_func)
+    SVN_ERR(bb->cancel_func(bb->cancel_baton));
+
+  /* Property changes don't affect the blame.  We also keep the previous
+     file around, so don't switch the pools in this case. */
+  if (!content_delta_handler)
+    return SVN_NO_ERROR;
+
+  svn_pool_clear(bb->currpool);
+
+  rev = apr_pcalloc(bb->mainpool, sizeof(*rev));
+  if (revnum >= bb->start)
+    {
+      rev->revision = revnum;
+      rev->rev_props = copy_blame_rev_props(rev_props, bb->mainpool);
+    }
+  else
+    {
+      /* The file existed before the start of the range; generate no
+         blame info for lines from this revision (or before). */
+      rev->revision = SVN_INVALID_REVNUM;
+    }
+
+  /* Copy the new contents to a temporary file. */
+  SVN_ERR(svn_fs_revision_root(&root, bb->fs, revnum, pool));
+  SVN_ERR(svn_fs_file_contents(&contents, root, path, pool));
+  SVN_ERR(svn_stream_open_unique(&cur_stream, &filename, NULL,
+                                 svn_io_file_del_on_pool_cleanup,
+                                 bb->currpool, pool));
+  SVN_ERR(svn_stream_copy3(contents, cur_stream,
+                           bb->cancel_func, bb->cancel_baton, pool));
+
+  /* Diff against the previous contents and adjust the blame info. */
+  diff_baton.chain = &bb->chain;
+  diff_baton.rev = rev;
+
+  SVN_ERR(svn_diff_file_diff_2(&diff, bb->last_filename, filename,
+                               bb->diff_options, pool));
+  SVN_ERR(svn_diff_output2(diff, &diff_baton, &output_fns,
+                           bb->cancel_func, bb->cancel_baton));
+
+  /* Prepare for next revision. */
+  bb->last_filename = filename;
+
+  tmp_pool = bb->lastpool;
+  bb->lastpool = bb->currpool;
+  bb->currpool = tmp_pool;
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_repos_blame(svn_repos_t *repos,
+                const char *path,
+                svn_revnum_t start,
+                svn_revnum_t end,
+                const apr_array_header_t *diff_options,
+                svn_repos_authz_func_t authz_read_func,
+                void *authz_read_baton,
+                svn_repos_blame_receiver_t receiver,
+                void *receiver_baton,
+                svn_cancel_func_t cancel_func,
+                void *cancel_baton,
+                apr_pool_t *scratch_pool)
+{
+  struct blame_baton bb;
+  svn_diff_file_options_t *options;
+  struct blame *walk;
+  apr_pool_t *iterpool;
+
+  if (start > end)
+    return svn_error_createf(SVN_ERR_UNSUPPORTED_FEATURE, NULL,
+                             _("Reverse blame of '%s' (r%ld:%ld) is not "
+                               "supported"), path, start, end);
+
+  options = svn_diff_file_options_create(scratch_pool);
+  if (diff_options)
+    SVN_ERR(svn_diff_file_options_parse(options, diff_options,
+                                        scratch_pool));
+
+  bb.fs = svn_repos_fs(repos);
+  bb.start = start;
+  bb.diff_options = options;
+  bb.cancel_func = cancel_func;
+  bb.cancel_baton = cancel_baton;
+  bb.mainpool = scratch_pool;
+  bb.lastpool = svn_pool_create(scratch_pool);
+  bb.currpool = svn_pool_create(scratch_pool);
+
+  /* Start with an empty file, i.e. just the end-of-file marker. */
+  bb.chain.blame = NULL;
+  bb.chain.avail = NULL;
+  bb.chain.pool = scratch_pool;
+  bb.chain.blame = blame_create(&bb.chain, &end_of_file, 0);
+
+  SVN_ERR(svn_io_open_unique_file3(NULL, &bb.last_filename, NULL,
+                                   svn_io_file_del_on_pool_cleanup,
+                                   scratch_pool, scratch_pool));
+
+  /* Collect all blame information.
+     We need to ensure that we get one revision before START, if available
+     so that we can know what was actually changed in the start revision. */
+  SVN_ERR(svn_repos_get_file_revs2(repos, path, MAX(0, start - 1), end,
+                                   FALSE, authz_read_func, authz_read_baton,
+                                   file_rev_handler, &bb, scratch_pool));
+
+  /* Report the blame to the caller, merging adjacent chunks that belong
+     to the same revision. */
+  iterpool = svn_pool_create(scratch_pool);
+  for (walk = bb.chain.blame; walk->rev != &end_of_file; )
+    {
+      struct blame *next = walk->next;
+      while (next->rev == walk->rev)
+        next = next->next;
+
+      svn_pool_clear(iterpool);
+      if (next->start > walk->start)
+        SVN_ERR(receiver(walk->start, next->start, walk->rev->revision,
+                         walk->rev->rev_props, receiver_baton, iterpool));
+
+      walk = next;
+    }
+
+  svn_pool_destroy(iterpool);
+  svn_pool_destroy(bb.lastpool);
+  svn_pool_destroy(bb.currpool);
+
+  return SVN_NO_ERROR;
+}
@@ -307,7 +307,7 @@ svn_repos_begin_report2(void **report_baton,
                         void *authz_read_baton,
                         apr_pool_t *pool)
 {
-  return svn_repos_begin_report3(report_baton,
+  return svn_repos_begin_report4(report_baton,
                                  revnum,
                                  repos,
                                  fs_base,
@@ -322,9 +322,36 @@ svn_repos_begin_report2(void **report_baton,
                                  authz_read_func,
                                  authz_read_baton,
                                  0,     /* disable zero-copy code path */
+                                 1,
                                  pool);
 }
 
+svn_error_t *
+svn_repos_begin_report3(void **report_baton,
+                        svn_revnum_t revnum,
+                        svn_repos_t *repos,
+                        const char *fs_base,
+                        const char *s_operand,
+                        const char *switch_path,
+                        svn_boolean_t text_deltas,
+                        svn_depth_t depth,
+                        svn_boolean_t ignore_ancestry,
+                        svn_boolean_t send_copyfrom_args,
+                        const svn_delta_editor_t *editor,
+                        void *edit_baton,
+                        svn_repos_authz_func_t authz_read_func,
+                        void *authz_read_baton,
+                        apr_size_t zero_copy_limit,
+                        apr_pool_t *pool)
+{
+  return svn_repos_begin_report4(report_baton, revnum, repos, fs_base,
+                                 s_operand, switch_path, text_deltas, depth,
+                                 ignore_ancestry, send_copyfrom_args,
+                                 editor, edit_baton,
+                                 authz_read_func, authz_read_baton,
+                                 zero_copy_limit, 1, pool);
+}
+
 svn_error_t *
 svn_repos_set_path2(void *baton, const char *path, svn_revnum_t rev,
                     svn_boolean_t start_empty, const char *lock_token,
@@ -823,6 +850,7 @@ svn_repos_dump_fs3(svn_repos_t *repos,
                                             notify_func,
                                             notify_baton,
                                             NULL, NULL,
+                                            1,
                                             cancel_func,
                                             cancel_baton,
                                             pool));
@@ -855,6 +883,35 @@ svn_repos_dump_fs2(svn_repos_t *repos,
                                             pool));
 }
 
+svn_error_t *
+svn_repos_verify_fs3(svn_repos_t *repos,
+                     svn_revnum_t start_rev,
+                     svn_revnum_t end_rev,
+                     svn_boolean_t check_normalization,
+                     svn_boolean_t metadata_only,
+                     svn_repos_notify_func_t notify_func,
+                     void *notify_baton,
+                     svn_repos_verify_callback_t verify_callback,
+                     void *verify_baton,
+                     svn_cancel_func_t cancel_func,
+                     void *cancel_baton,
+                     apr_pool_t *pool)
+{
+  return svn_error_trace(svn_repos_verify_fs4(repos,
+                                              start_rev,
+                                              end_rev,
+                                              check_normalization,
+                                              metadata_only,
+                                              1,
+                                              notify_func,
+                                              notify_baton,
+                                              verify_callback,
+                                              verify_baton,
+                                              cancel_func,
+                                              cancel_baton,
+                                              pool));
+}
+
 svn_error_t *
 svn_repos_verify_fs2(svn_repos_t *repos,
                      svn_revnum_t start_rev,
@@ -865,11 +922,12 @@ svn_repos_verify_fs2(svn_repos_t *repos,
                      void *cancel_baton,
                      apr_pool_t *pool)
 {
-  return svn_error_trace(svn_repos_verify_fs3(repos,
+  return svn_error_trace(svn_repos_verify_fs4(repos,
                                               start_rev,
                                               end_rev,
                                               FALSE,
                                               FALSE,
+                                              1,
                                               notify_func,
                                               notify_baton,
                                               NULL, NULL,
@@ -921,7 +979,7 @@ svn_repos_load_fs5(svn_repos_t *repos,
   return svn_repos_load_fs6(repos, dumpstream, start_rev, end_rev,
                             uuid_action, parent_dir,
                             use_post_commit_hook, use_post_commit_hook,
-                            validate_props, ignore_dates, FALSE,
+                            validate_props, ignore_dates, FALSE, 1,
                             notify_func, notify_baton,
                             cancel_func, cancel_baton, pool);
 }
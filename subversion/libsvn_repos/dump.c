@@ -42,8 +42,12 @@
 #include "private/svn_mergeinfo_private.h"
 #include "private/svn_fs_private.h"
 #include "private/svn_sorts_private.h"
+#include "private/svn_subr_private.h"
 #include "private/svn_utf_private.h"
 #include "private/svn_cache.h"
+#include "private/svn_parallel.h"
+
+#include "repos.h"
 
 #define ARE_VALID_COPY_ARGS(p,r) ((p) && SVN_IS_VALID_REVNUM(r))
 
@@ -317,13 +321,16 @@ tracker_path_delete(path_tracker_t *tracker,
 /* Compute the delta between OLDROOT/OLDPATH and NEWROOT/NEWPATH and
    store it into a new temporary file *TEMPFILE.  OLDROOT may be NULL,
    in which case the delta will be computed against an empty file, as
-   per the svn_fs_get_file_delta_stream docstring.  Record the length
-   of the temporary file in *LEN, and rewind the file before
+   per the svn_fs_get_file_delta_stream docstring.  Encode the delta
+   in svndiff format SVNDIFF_VERSION using COMPRESSION_LEVEL.  Record
+   the length of the temporary file in *LEN, and rewind the file before
    returning. */
 static svn_error_t *
 store_delta(apr_file_t **tempfile, svn_filesize_t *len,
             svn_fs_root_t *oldroot, const char *oldpath,
-            svn_fs_root_t *newroot, const char *newpath, apr_pool_t *pool)
+            svn_fs_root_t *newroot, const char *newpath,
+            int svndiff_version, int compression_level,
+            apr_pool_t *pool)
 {
   svn_stream_t *temp_stream;
   apr_off_t offset;
@@ -341,8 +348,8 @@ store_delta(apr_file_t **tempfile, svn_filesize_t *len,
   /* Compute the delta and send it to the temporary file. */
   SVN_ERR(svn_fs_get_file_delta_stream(&delta_stream, oldroot, oldpath,
                                        newroot, newpath, pool));
-  svn_txdelta_to_svndiff3(&wh, &whb, temp_stream, 0,
-                          SVN_DELTA_COMPRESSION_LEVEL_DEFAULT, pool);
+  svn_txdelta_to_svndiff3(&wh, &whb, temp_stream, svndiff_version,
+                          compression_level, pool);
   SVN_ERR(svn_txdelta_send_txstream(delta_stream, wh, whb, pool));
 
   /* Get the length of the temporary file and rewind it. */
@@ -645,6 +652,10 @@ struct edit_baton
   /* True if dumped nodes should output deltas instead of full text. */
   svn_boolean_t use_deltas;
 
+  /* svndiff format version and compression level used for text deltas. */
+  int svndiff_version;
+  int compression_level;
+
   /* True if this "dump" is in fact a verify. */
   svn_boolean_t verify;
 
@@ -1430,7 +1441,9 @@ dump_node(struct edit_baton *eb,
              file, so that we can find its length.  Output a header
              saying our text contents are a delta. */
           SVN_ERR(store_delta(&delta_file, &textlen, compare_root,
-                              compare_path, eb->fs_root, path, pool));
+                              compare_path, eb->fs_root, path,
+                              eb->svndiff_version, eb->compression_level,
+                              pool));
           svn_repos__dumpfile_header_push(
             headers, SVN_REPOS_DUMPFILE_TEXT_DELTA, "true");
 
@@ -1853,6 +1866,8 @@ get_dump_editor(const svn_delta_editor_t **editor,
                 void *notify_baton,
                 svn_revnum_t oldest_dumped_rev,
                 svn_boolean_t use_deltas,
+                int svndiff_version,
+                int compression_level,
                 svn_boolean_t verify,
                 svn_boolean_t check_normalization,
                 apr_pool_t *pool)
@@ -1875,6 +1890,8 @@ get_dump_editor(const svn_delta_editor_t **editor,
   eb->fs = fs;
   eb->current_rev = to_rev;
   eb->use_deltas = use_deltas;
+  eb->svndiff_version = svndiff_version;
+  eb->compression_level = compression_level;
   eb->verify = verify;
   eb->check_normalization = check_normalization;
   eb->found_old_reference = found_old_reference;
@@ -1992,26 +2009,305 @@ dump_filter_authz_func(svn_boolean_t *allowed,
 
 
 
+/* Options of a dump that apply to all revisions being dumped. */
+typedef struct dump_options_t
+{
+  /* First revision to dump. */
+  svn_revnum_t start_rev;
+
+  /* As passed to svn_repos__dump_fs(). */
+  svn_boolean_t incremental;
+  svn_boolean_t use_deltas;
+  int svndiff_version;
+  int compression_level;
+
+  /* Path-based filtering; AUTHZ_FUNC may be NULL. */
+  svn_repos_authz_func_t authz_func;
+  void *authz_baton;
+} dump_options_t;
+
+/* Write the node records of revision REV in FS to STREAM as described
+   by OPTS.  Set *FOUND_OLD_REFERENCE and *FOUND_OLD_MERGEINFO if copy
+   sources or mergeinfo refer to revisions older than OPTS->START_REV;
+   leave them untouched otherwise.  Send warnings to NOTIFY_FUNC with
+   NOTIFY_BATON.  Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+dump_revision_changes(svn_stream_t *stream,
+                      svn_fs_t *fs,
+                      svn_revnum_t rev,
+                      const dump_options_t *opts,
+                      svn_boolean_t *found_old_reference,
+                      svn_boolean_t *found_old_mergeinfo,
+                      svn_repos_notify_func_t notify_func,
+                      void *notify_baton,
+                      apr_pool_t *scratch_pool)
+{
+  const svn_delta_editor_t *dump_editor;
+  void *dump_edit_baton = NULL;
+  svn_fs_root_t *to_root;
+  svn_boolean_t use_deltas_for_rev;
+
+  /* Fetch the editor which dumps nodes to a file.  Regardless of
+     what we've been told, don't use deltas for the first rev of a
+     non-incremental dump. */
+  use_deltas_for_rev = opts->use_deltas
+                    && (opts->incremental || rev != opts->start_rev);
+  SVN_ERR(get_dump_editor(&dump_editor, &dump_edit_baton, fs, rev,
+                          "", stream, found_old_reference,
+                          found_old_mergeinfo, NULL,
+                          notify_func, notify_baton,
+                          opts->start_rev, use_deltas_for_rev,
+                          opts->svndiff_version, opts->compression_level,
+                          FALSE, FALSE, scratch_pool));
+
+  /* Drive the editor in one way or another. */
+  SVN_ERR(svn_fs_revision_root(&to_root, fs, rev, scratch_pool));
+
+  /* If this is the first revision of a non-incremental dump,
+     we're in for a full tree dump.  Otherwise, we want to simply
+     replay the revision.  */
+  if ((rev == opts->start_rev) && (! opts->incremental))
+    {
+      /* Compare against revision 0, so everything appears to be added. */
+      svn_fs_root_t *from_root;
+      SVN_ERR(svn_fs_revision_root(&from_root, fs, 0, scratch_pool));
+      SVN_ERR(svn_repos_dir_delta2(from_root, "", "",
+                                   to_root, "",
+                                   dump_editor, dump_edit_baton,
+                                   opts->authz_func, opts->authz_baton,
+                                   FALSE, /* don't send text-deltas */
+                                   svn_depth_infinity,
+                                   FALSE, /* don't send entry props */
+                                   FALSE, /* don't ignore ancestry */
+                                   scratch_pool));
+    }
+  else
+    {
+      /* The normal case: compare consecutive revs. */
+      SVN_ERR(svn_repos_replay2(to_root, "", SVN_INVALID_REVNUM, FALSE,
+                                dump_editor, dump_edit_baton,
+                                opts->authz_func, opts->authz_baton,
+                                scratch_pool));
+
+      /* While our editor close_edit implementation is a no-op, we still
+         do this for completeness. */
+      SVN_ERR(dump_editor->close_edit(dump_edit_baton, scratch_pool));
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Amount of dump data per revision to keep in memory before the
+   concurrent dump spills it to a temporary file. */
+#define DUMP_SPILL_MEMORY_SIZE (1024 * 1024)
+
+/* Baton for the concurrent dump tasks and their output. */
+typedef struct dump_tasks_baton_t
+{
+  /* FS instances to be used by the dump tasks. */
+  svn_repos__fs_handles_t *fs_handles;
+
+  /* What and how to dump. */
+  const dump_options_t *opts;
+  svn_boolean_t include_revprops;
+  svn_boolean_t include_changes;
+
+  /* Where the output goes.  Only to be used by the output function. */
+  svn_repos_t *repos;
+  svn_stream_t *stream;
+  svn_repos_notify_func_t notify_func;
+  void *notify_baton;
+
+  /* Reusable notification for dumped revisions. */
+  svn_repos_notify_t *notify;
+
+  /* Accumulated over all tasks by the output function. */
+  svn_boolean_t found_old_reference;
+  svn_boolean_t found_old_mergeinfo;
+} dump_tasks_baton_t;
+
+/* Result of a single revision's dump task. */
+typedef struct dump_task_result_t
+{
+  /* The node records of the revision.  NULL if there are none. */
+  svn_spillbuf_t *contents;
+
+  /* Warnings to send, svn_repos_notify_t *. */
+  apr_array_header_t *notifications;
+
+  /* See dump_revision_changes(). */
+  svn_boolean_t found_old_reference;
+  svn_boolean_t found_old_mergeinfo;
+} dump_task_result_t;
+
+/* Implements svn_parallel__task_func_t.  BATON is a dump_tasks_baton_t.
+   Dump the node records of the IDX-th revision into a spill buffer and
+   return it, together with any warnings, in a dump_task_result_t. */
+static svn_error_t *
+dump_task(void **result,
+          void *baton,
+          int idx,
+          svn_cancel_func_t cancel_func,
+          void *cancel_baton,
+          apr_pool_t *result_pool,
+          apr_pool_t *scratch_pool)
+{
+  dump_tasks_baton_t *db = baton;
+  svn_revnum_t rev = db->opts->start_rev + idx;
+  dump_task_result_t *task_result = apr_pcalloc(result_pool,
+                                                sizeof(*task_result));
+  svn_stream_t *stream;
+  svn_fs_t *fs;
+
+  task_result->notifications
+    = apr_array_make(result_pool, 0, sizeof(svn_repos_notify_t *));
+  *result = task_result;
+
+  /* Like the sequential dump, only write the revision record for r0. */
+  if (rev == 0 || !db->include_changes)
+    return SVN_NO_ERROR;
+
+  if (cancel_func)
+    SVN_ERR(cancel_func(cancel_baton));
+
+  task_result->contents = svn_spillbuf__create(SVN__STREAM_CHUNK_SIZE,
+                                               DUMP_SPILL_MEMORY_SIZE,
+                                               result_pool);
+  stream = svn_stream__from_spillbuf(task_result->contents, scratch_pool);
+
+  SVN_ERR(svn_repos__fs_handles_acquire(&fs, db->fs_handles,
+                                        scratch_pool));
+  return svn_error_trace(svn_repos__fs_handles_release(
+                           db->fs_handles, fs,
+                           dump_revision_changes(
+                             stream, fs, rev, db->opts,
+                             &task_result->found_old_reference,
+                             &task_result->found_old_mergeinfo,
+                             db->notify_func ? svn_repos__notify_record
+                                             : NULL,
+                             task_result->notifications,
+                             scratch_pool)));
+}
+
+/* Implements svn_parallel__output_func_t.  BATON is a dump_tasks_baton_t.
+   Write the revision record and the node records in RESULT for the
+   IDX-th revision to the output stream and send the notifications just
+   like the sequential dump does. */
+static svn_error_t *
+dump_output(void *baton,
+            int idx,
+            void *result,
+            svn_error_t *task_err,
+            apr_pool_t *scratch_pool)
+{
+  dump_tasks_baton_t *db = baton;
+  dump_task_result_t *task_result = result;
+  svn_revnum_t rev = db->opts->start_rev + idx;
+  int i;
+
+  if (task_err)
+    return svn_error_trace(task_err);
+
+  SVN_ERR(write_revision_record(db->stream, db->repos, rev,
+                                db->include_revprops,
+                                db->opts->authz_func, db->opts->authz_baton,
+                                scratch_pool));
+
+  if (task_result->contents)
+    SVN_ERR(svn_stream_copy3(svn_stream__from_spillbuf(task_result->contents,
+                                                       scratch_pool),
+                             svn_stream_disown(db->stream, scratch_pool),
+                             NULL, NULL, scratch_pool));
+
+  db->found_old_reference |= task_result->found_old_reference;
+  db->found_old_mergeinfo |= task_result->found_old_mergeinfo;
+
+  if (db->notify_func)
+    {
+      for (i = 0; i < task_result->notifications->nelts; ++i)
+        db->notify_func(db->notify_baton,
+                        APR_ARRAY_IDX(task_result->notifications, i,
+                                      const svn_repos_notify_t *),
+                        scratch_pool);
+
+      db->notify->revision = rev;
+      db->notify_func(db->notify_baton, db->notify, scratch_pool);
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Dump the revisions OPTS->START_REV to END_REV of REPOS to STREAM using
+   up to THREAD_COUNT worker threads, each with its own FS instance.
+   The node records of each revision get buffered until all previous
+   revisions have been written, so the output is identical to that of
+   the sequential dump.  Set *FOUND_OLD_REFERENCE and *FOUND_OLD_MERGEINFO
+   like dump_revision_changes() does.  The remaining parameters are as
+   for svn_repos__dump_fs(). */
+static svn_error_t *
+dump_concurrently(svn_repos_t *repos,
+                  svn_stream_t *stream,
+                  svn_revnum_t end_rev,
+                  const dump_options_t *opts,
+                  svn_boolean_t include_revprops,
+                  svn_boolean_t include_changes,
+                  int thread_count,
+                  svn_boolean_t *found_old_reference,
+                  svn_boolean_t *found_old_mergeinfo,
+                  svn_repos_notify_func_t notify_func,
+                  void *notify_baton,
+                  svn_cancel_func_t cancel_func,
+                  void *cancel_baton,
+                  apr_pool_t *scratch_pool)
+{
+  dump_tasks_baton_t *db = apr_pcalloc(scratch_pool, sizeof(*db));
+
+  db->opts = opts;
+  db->include_revprops = include_revprops;
+  db->include_changes = include_changes;
+  db->repos = repos;
+  db->stream = stream;
+  db->notify_func = notify_func;
+  db->notify_baton = notify_baton;
+  db->notify = svn_repos_notify_create(svn_repos_notify_dump_rev_end,
+                                       scratch_pool);
+  SVN_ERR(svn_repos__fs_handles_create(&db->fs_handles,
+                                       svn_repos_fs(repos), scratch_pool));
+
+  SVN_ERR(svn_parallel__run((int)(end_rev - opts->start_rev + 1),
+                            thread_count, 0,
+                            dump_task, db,
+                            dump_output, db,
+                            cancel_func, cancel_baton,
+                            scratch_pool));
+
+  *found_old_reference |= db->found_old_reference;
+  *found_old_mergeinfo |= db->found_old_mergeinfo;
+
+  return SVN_NO_ERROR;
+}
+
 /* The main dumper. */
 svn_error_t *
-svn_repos_dump_fs4(svn_repos_t *repos,
+svn_repos__dump_fs(svn_repos_t *repos,
                    svn_stream_t *stream,
                    svn_revnum_t start_rev,
                    svn_revnum_t end_rev,
                    svn_boolean_t incremental,
                    svn_boolean_t use_deltas,
+                   int svndiff_version,
+                   int compression_level,
                    svn_boolean_t include_revprops,
                    svn_boolean_t include_changes,
                    svn_repos_notify_func_t notify_func,
                    void *notify_baton,
                    svn_repos_dump_filter_func_t filter_func,
                    void *filter_baton,
+                   int thread_count,
                    svn_cancel_func_t cancel_func,
                    void *cancel_baton,
                    apr_pool_t *pool)
 {
-  const svn_delta_editor_t *dump_editor;
-  void *dump_edit_baton = NULL;
   svn_revnum_t rev;
   svn_fs_t *fs = svn_repos_fs(repos);
   apr_pool_t *iterpool = svn_pool_create(pool);
@@ -2021,7 +2317,7 @@ svn_repos_dump_fs4(svn_repos_t *repos,
   svn_boolean_t found_old_reference = FALSE;
   svn_boolean_t found_old_mergeinfo = FALSE;
   svn_repos_notify_t *notify;
-  svn_repos_authz_func_t authz_func;
+  dump_options_t opts = {0};
   dump_filter_baton_t authz_baton = {0};
 
   /* Make sure we catch up on the latest revprop changes.  This is the only
@@ -2056,14 +2352,17 @@ svn_repos_dump_fs4(svn_repos_t *repos,
    * references to it (e.g. copy source). */
   if (filter_func)
     {
-      authz_func = dump_filter_authz_func;
+      opts.authz_func = dump_filter_authz_func;
+      opts.authz_baton = &authz_baton;
       authz_baton.filter_func = filter_func;
       authz_baton.filter_baton = filter_baton;
     }
-  else
-    {
-      authz_func = NULL;
-    }
+
+  opts.start_rev = start_rev;
+  opts.incremental = incremental;
+  opts.use_deltas = use_deltas;
+  opts.svndiff_version = svndiff_version;
+  opts.compression_level = compression_level;
 
   /* Write out the UUID. */
   SVN_ERR(svn_fs_get_uuid(fs, &uuid, pool));
@@ -2082,82 +2381,52 @@ svn_repos_dump_fs4(svn_repos_t *repos,
   SVN_ERR(svn_stream_printf(stream, pool, SVN_REPOS_DUMPFILE_UUID
                             ": %s\n\n", uuid));
 
-  /* Create a notify object that we can reuse in the loop. */
-  if (notify_func)
-    notify = svn_repos_notify_create(svn_repos_notify_dump_rev_end,
-                                     pool);
-
-  /* Main loop:  we're going to dump revision REV.  */
-  for (rev = start_rev; rev <= end_rev; rev++)
+  if (thread_count > 1)
     {
-      svn_fs_root_t *to_root;
-      svn_boolean_t use_deltas_for_rev;
-
-      svn_pool_clear(iterpool);
-
-      /* Check for cancellation. */
-      if (cancel_func)
-        SVN_ERR(cancel_func(cancel_baton));
-
-      /* Write the revision record. */
-      SVN_ERR(write_revision_record(stream, repos, rev, include_revprops,
-                                    authz_func, &authz_baton, iterpool));
-
-      /* When dumping revision 0, we just write out the revision record.
-         The parser might want to use its properties.
-         If we don't want revision changes at all, skip in any case. */
-      if (rev == 0 || !include_changes)
-        goto loop_end;
-
-      /* Fetch the editor which dumps nodes to a file.  Regardless of
-         what we've been told, don't use deltas for the first rev of a
-         non-incremental dump. */
-      use_deltas_for_rev = use_deltas && (incremental || rev != start_rev);
-      SVN_ERR(get_dump_editor(&dump_editor, &dump_edit_baton, fs, rev,
-                              "", stream, &found_old_reference,
-                              &found_old_mergeinfo, NULL,
-                              notify_func, notify_baton,
-                              start_rev, use_deltas_for_rev, FALSE, FALSE,
-                              iterpool));
-
-      /* Drive the editor in one way or another. */
-      SVN_ERR(svn_fs_revision_root(&to_root, fs, rev, iterpool));
-
-      /* If this is the first revision of a non-incremental dump,
-         we're in for a full tree dump.  Otherwise, we want to simply
-         replay the revision.  */
-      if ((rev == start_rev) && (! incremental))
-        {
-          /* Compare against revision 0, so everything appears to be added. */
-          svn_fs_root_t *from_root;
-          SVN_ERR(svn_fs_revision_root(&from_root, fs, 0, iterpool));
-          SVN_ERR(svn_repos_dir_delta2(from_root, "", "",
-                                       to_root, "",
-                                       dump_editor, dump_edit_baton,
-                                       authz_func, &authz_baton,
-                                       FALSE, /* don't send text-deltas */
-                                       svn_depth_infinity,
-                                       FALSE, /* don't send entry props */
-                                       FALSE, /* don't ignore ancestry */
-                                       iterpool));
-        }
-      else
-        {
-          /* The normal case: compare consecutive revs. */
-          SVN_ERR(svn_repos_replay2(to_root, "", SVN_INVALID_REVNUM, FALSE,
-                                    dump_editor, dump_edit_baton,
-                                    authz_func, &authz_baton, iterpool));
-
-          /* While our editor close_edit implementation is a no-op, we still
-             do this for completeness. */
-          SVN_ERR(dump_editor->close_edit(dump_edit_baton, iterpool));
-        }
-
-    loop_end:
+      SVN_ERR(dump_concurrently(repos, stream, end_rev, &opts,
+                                include_revprops, include_changes,
+                                thread_count,
+                                &found_old_reference, &found_old_mergeinfo,
+                                notify_func, notify_baton,
+                                cancel_func, cancel_baton, iterpool));
+    }
+  else
+    {
+      /* Create a notify object that we can reuse in the loop. */
       if (notify_func)
+        notify = svn_repos_notify_create(svn_repos_notify_dump_rev_end,
+                                         pool);
+
+      /* Main loop:  we're going to dump revision REV.  */
+      for (rev = start_rev; rev <= end_rev; rev++)
         {
-          notify->revision = rev;
-          notify_func(notify_baton, notify, iterpool);
+          svn_pool_clear(iterpool);
+
+          /* Check for cancellation. */
+          if (cancel_func)
+            SVN_ERR(cancel_func(cancel_baton));
+
+          /* Write the revision record. */
+          SVN_ERR(write_revision_record(stream, repos, rev,
+                                        include_revprops,
+                                        opts.authz_func, opts.authz_baton,
+                                        iterpool));
+
+          /* When dumping revision 0, we just write out the revision
+             record.  The parser might want to use its properties.
+             If we don't want revision changes at all, skip in any case. */
+          if (rev != 0 && include_changes)
+            SVN_ERR(dump_revision_changes(stream, fs, rev, &opts,
+                                          &found_old_reference,
+                                          &found_old_mergeinfo,
+                                          notify_func, notify_baton,
+                                          iterpool));
+
+          if (notify_func)
+            {
+              notify->revision = rev;
+              notify_func(notify_baton, notify, iterpool);
+            }
         }
     }
 
@@ -2199,6 +2468,36 @@ svn_repos_dump_fs4(svn_repos_t *repos,
   return SVN_NO_ERROR;
 }
 
+svn_error_t *
+svn_repos_dump_fs4(svn_repos_t *repos,
+                   svn_stream_t *stream,
+                   svn_revnum_t start_rev,
+                   svn_revnum_t end_rev,
+                   svn_boolean_t incremental,
+                   svn_boolean_t use_deltas,
+                   svn_boolean_t include_revprops,
+                   svn_boolean_t include_changes,
+                   svn_repos_notify_func_t notify_func,
+                   void *notify_baton,
+                   svn_repos_dump_filter_func_t filter_func,
+                   void *filter_baton,
+                   int thread_count,
+                   svn_cancel_func_t cancel_func,
+                   void *cancel_baton,
+                   apr_pool_t *pool)
+{
+  /* Plain svndiff0 deltas can be read by all versions of Subversion. */
+  return svn_error_trace(svn_repos__dump_fs(repos, stream, start_rev,
+                                            end_rev, incremental, use_deltas,
+                                            0, SVN_DELTA_COMPRESSION_LEVEL_NONE,
+                                            include_revprops, include_changes,
+                                            notify_func, notify_baton,
+                                            filter_func, filter_baton,
+                                            thread_count,
+                                            cancel_func, cancel_baton,
+                                            pool));
+}
+
 
 /*----------------------------------------------------------------------*/
 
@@ -2357,7 +2656,8 @@ verify_one_revision(svn_fs_t *fs,
                           verify_close_directory,
                           notify_func, notify_baton,
                           start_rev,
-                          FALSE, TRUE, /* use_deltas, verify */
+                          FALSE, 0, SVN_DELTA_COMPRESSION_LEVEL_NONE,
+                          TRUE, /* use_deltas, svndiff, verify */
                           check_normalization,
                           scratch_pool));
   SVN_ERR(svn_delta_get_cancellation_editor(cancel_func, cancel_baton,
@@ -2433,12 +2733,241 @@ report_error(svn_revnum_t revision,
     }
 }
 
+/* Shard size to use for the concurrent metadata verification if the
+   backend does not report one. */
+#define DEFAULT_VERIFY_SHARD_SIZE 1000
+
+/* Baton for the concurrent verification tasks and their output. */
+typedef struct verify_tasks_baton_t
+{
+  /* Location and configuration of the repository's FS. */
+  const char *fs_path;
+  apr_hash_t *fs_config;
+
+  /* FS instances to be used by the revision verification tasks. */
+  svn_repos__fs_handles_t *fs_handles;
+
+  /* Range of revisions to verify. */
+  svn_revnum_t start_rev;
+  svn_revnum_t end_rev;
+
+  /* Metadata will be verified in shards of that many revisions. */
+  svn_revnum_t shard_size;
+
+  /* Number of metadata verification tasks, i.e. shards to verify.  All
+     tasks with larger indexes verify a single revision each. */
+  int shard_count;
+
+  /* As passed to svn_repos_verify_fs4. */
+  svn_boolean_t check_normalization;
+
+  /* The caller's callbacks.  Only to be used by the output function. */
+  svn_repos_notify_func_t notify_func;
+  void *notify_baton;
+  svn_repos_verify_callback_t verify_callback;
+  void *verify_baton;
+
+  /* Reusable notification for verified revisions. */
+  svn_repos_notify_t *notify;
+} verify_tasks_baton_t;
+
+/* Implements svn_parallel__task_func_t.  BATON is a verify_tasks_baton_t.
+   Verify the metadata of one shard or the contents of one revision and
+   return the list of notifications to send as *RESULT. */
+static svn_error_t *
+verify_task(void **result,
+            void *baton,
+            int idx,
+            svn_cancel_func_t cancel_func,
+            void *cancel_baton,
+            apr_pool_t *result_pool,
+            apr_pool_t *scratch_pool)
+{
+  verify_tasks_baton_t *vb = baton;
+  apr_array_header_t *notifications
+    = apr_array_make(result_pool, 4, sizeof(svn_repos_notify_t *));
+  svn_repos_notify_func_t notify_func
+    = vb->notify_func ? svn_repos__notify_record : NULL;
+
+  *result = notifications;
+
+  if (idx < vb->shard_count)
+    {
+      svn_revnum_t first_shard = vb->start_rev / vb->shard_size;
+      svn_revnum_t shard_start = (first_shard + idx) * vb->shard_size;
+      svn_revnum_t shard_end = shard_start + vb->shard_size - 1;
+      svn_fs_progress_notify_func_t verify_notify = NULL;
+      struct verify_fs_notify_func_baton_t *verify_notify_baton = NULL;
+
+      if (notify_func)
+        {
+          verify_notify = verify_fs_notify_func;
+          verify_notify_baton = apr_palloc(scratch_pool,
+                                           sizeof(*verify_notify_baton));
+          verify_notify_baton->notify_func = notify_func;
+          verify_notify_baton->notify_baton = notifications;
+          verify_notify_baton->notify
+            = svn_repos_notify_create(svn_repos_notify_verify_rev_structure,
+                                      scratch_pool);
+        }
+
+      /* svn_fs_verify() uses its own FS instance. */
+      return svn_error_trace(svn_fs_verify(vb->fs_path, vb->fs_config,
+                                           MAX(shard_start, vb->start_rev),
+                                           MIN(shard_end, vb->end_rev),
+                                           verify_notify,
+                                           verify_notify_baton,
+                                           cancel_func, cancel_baton,
+                                           scratch_pool));
+    }
+  else
+    {
+      svn_revnum_t rev = vb->start_rev + (idx - vb->shard_count);
+      svn_fs_t *fs;
+
+      SVN_ERR(svn_repos__fs_handles_acquire(&fs, vb->fs_handles,
+                                            scratch_pool));
+      return svn_error_trace(svn_repos__fs_handles_release(
+                               vb->fs_handles, fs,
+                                 verify_one_revision(fs, rev,
+                                                     notify_func,
+                                                     notifications,
+                                                     vb->start_rev,
+                                                     vb->check_normalization,
+                                                     cancel_func,
+                                                     cancel_baton,
+                                                     scratch_pool)));
+    }
+}
+
+/* Implements svn_parallel__output_func_t.  BATON is a
+   verify_tasks_baton_t.  Send the notifications recorded in RESULT and
+   report TASK_ERR just like the sequential verification does. */
+static svn_error_t *
+verify_output(void *baton,
+              int idx,
+              void *result,
+              svn_error_t *task_err,
+              apr_pool_t *scratch_pool)
+{
+  verify_tasks_baton_t *vb = baton;
+  apr_array_header_t *notifications = result;
+  svn_boolean_t is_metadata = idx < vb->shard_count;
+  svn_revnum_t rev = is_metadata
+                   ? SVN_INVALID_REVNUM
+                   : vb->start_rev + (idx - vb->shard_count);
+
+  if (vb->notify_func && notifications)
+    {
+      int i;
+      for (i = 0; i < notifications->nelts; ++i)
+        {
+          const svn_repos_notify_t *notify
+            = APR_ARRAY_IDX(notifications, i, const svn_repos_notify_t *);
+
+          /* Every shard announces the start of the global checks.
+             The sequential verification does that only once. */
+          if (   is_metadata && idx > 0
+              && notify->action == svn_repos_notify_verify_rev_structure
+              && !SVN_IS_VALID_REVNUM(notify->revision))
+            continue;
+
+          vb->notify_func(vb->notify_baton, notify, scratch_pool);
+        }
+    }
+
+  if (task_err && task_err->apr_err == SVN_ERR_CANCELLED)
+    {
+      return svn_error_trace(task_err);
+    }
+  else if (task_err)
+    {
+      SVN_ERR(report_error(rev, task_err, vb->verify_callback,
+                           vb->verify_baton, scratch_pool));
+    }
+  else if (vb->notify_func && !is_metadata)
+    {
+      /* Tell the caller that we're done with this revision. */
+      vb->notify->revision = rev;
+      vb->notify_func(vb->notify_baton, vb->notify, scratch_pool);
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Implement svn_repos_verify_fs4 for THREAD_COUNT > 1 after the input
+   has been validated.  The metadata gets verified per shard and the
+   revision contents per revision, each shard and revision being an
+   independent task.  All notifications and errors are being reported
+   in the same order as the sequential verification would. */
+static svn_error_t *
+verify_concurrently(svn_fs_t *fs,
+                    svn_revnum_t start_rev,
+                    svn_revnum_t end_rev,
+                    svn_boolean_t check_normalization,
+                    svn_boolean_t metadata_only,
+                    int thread_count,
+                    svn_repos_notify_func_t notify_func,
+                    void *notify_baton,
+                    svn_repos_verify_callback_t verify_callback,
+                    void *verify_baton,
+                    svn_cancel_func_t cancel_func,
+                    void *cancel_baton,
+                    apr_pool_t *scratch_pool)
+{
+  verify_tasks_baton_t *vb = apr_pcalloc(scratch_pool, sizeof(*vb));
+  const svn_fs_info_placeholder_t *info;
+  int task_count;
+
+  vb->fs_path = svn_fs_path(fs, scratch_pool);
+  vb->fs_config = svn_fs_config(fs, scratch_pool);
+  vb->start_rev = start_rev;
+  vb->end_rev = end_rev;
+  vb->check_normalization = check_normalization;
+  vb->notify_func = notify_func;
+  vb->notify_baton = notify_baton;
+  vb->verify_callback = verify_callback;
+  vb->verify_baton = verify_baton;
+  vb->notify = svn_repos_notify_create(svn_repos_notify_verify_rev_end,
+                                       scratch_pool);
+  SVN_ERR(svn_repos__fs_handles_create(&vb->fs_handles, fs, scratch_pool));
+
+  /* Align the metadata verification with the backend's shards, if any. */
+  vb->shard_size = DEFAULT_VERIFY_SHARD_SIZE;
+  SVN_ERR(svn_fs_info(&info, fs, scratch_pool, scratch_pool));
+  if (info && !strcmp(info->fs_type, SVN_FS_TYPE_FSFS))
+    {
+      const svn_fs_fsfs_info_t *fsfs_info = (const void *)info;
+      if (fsfs_info->shard_size)
+        vb->shard_size = fsfs_info->shard_size;
+    }
+  else if (info && !strcmp(info->fs_type, SVN_FS_TYPE_FSX))
+    {
+      const svn_fs_fsx_info_t *fsx_info = (const void *)info;
+      if (fsx_info->shard_size)
+        vb->shard_size = fsx_info->shard_size;
+    }
+
+  vb->shard_count = (int)(end_rev / vb->shard_size
+                          - start_rev / vb->shard_size + 1);
+  task_count = vb->shard_count;
+  if (!metadata_only)
+    task_count += (int)(end_rev - start_rev + 1);
+
+  return svn_error_trace(svn_parallel__run(task_count, thread_count, 0,
+                                           verify_task, vb,
+                                           verify_output, vb,
+                                           cancel_func, cancel_baton,
+                                           scratch_pool));
+}
+
 svn_error_t *
-svn_repos_verify_fs3(svn_repos_t *repos,
+svn_repos_verify_fs4(svn_repos_t *repos,
                      svn_revnum_t start_rev,
                      svn_revnum_t end_rev,
                      svn_boolean_t check_normalization,
                      svn_boolean_t metadata_only,
+                     int thread_count,
                      svn_repos_notify_func_t notify_func,
                      void *notify_baton,
                      svn_repos_verify_callback_t verify_callback,
@@ -2481,6 +3010,28 @@ svn_repos_verify_fs3(svn_repos_t *repos,
                                "(youngest revision is %ld)"),
                              end_rev, youngest);
 
+  if (thread_count > 1)
+    {
+      SVN_ERR(verify_concurrently(fs, start_rev, end_rev,
+                                  check_normalization, metadata_only,
+                                  thread_count,
+                                  notify_func, notify_baton,
+                                  verify_callback, verify_baton,
+                                  cancel_func, cancel_baton, iterpool));
+
+      /* We're done. */
+      if (notify_func)
+        {
+          notify = svn_repos_notify_create(svn_repos_notify_verify_end,
+                                           iterpool);
+          notify_func(notify_baton, notify, iterpool);
+        }
+
+      svn_pool_destroy(iterpool);
+
+      return SVN_NO_ERROR;
+    }
+
   /* Create a notify object that we can reuse within the loop and a
      forwarding structure for notifications from inside svn_fs_verify(). */
   if (notify_func)
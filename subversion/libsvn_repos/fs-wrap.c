@@ -111,6 +111,21 @@ svn_repos_fs_commit_txn(const char **conflict_p,
       return err;
     }
 
+  /* Keep the log index, if there is one, up to date.  Like a failing
+     post-commit hook, a failure here does not undo the commit.  Readers
+     will simply ignore the outdated index until the next update.  This
+     also adds the few revisions that a concurrent commit or a failed
+     update may have left out, in order.  Don't make the committer wait
+     for the index to catch up with many revisions added by other means;
+     that is up to svnadmin build-log-index. */
+  err = svn_error_compose_create(err,
+                                 svn_repos__log_index_update(repos->fs,
+                                                             *new_rev, FALSE,
+                                                             FALSE,
+                                                             NULL, NULL,
+                                                             NULL, NULL,
+                                                             pool));
+
   /* Run post-commit hooks. */
   if ((err2 = svn_repos__hooks_post_commit(repos, hooks_env,
                                            *new_rev, txn_name, pool)))
@@ -1045,10 +1060,10 @@ svn_repos_fs_pack2(svn_repos_t *repos,
   pnb.notify_func = notify_func;
   pnb.notify_baton = notify_baton;
 
-  return svn_fs_pack(repos->db_path,
-                     notify_func ? pack_notify_func : NULL,
-                     notify_func ? &pnb : NULL,
-                     cancel_func, cancel_baton, pool);
+  return svn_fs_pack2(repos->db_path, svn_fs_config(repos->fs, pool),
+                      notify_func ? pack_notify_func : NULL,
+                      notify_func ? &pnb : NULL,
+                      cancel_func, cancel_baton, pool);
 }
 
 svn_error_t *
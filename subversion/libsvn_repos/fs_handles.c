@@ -0,0 +1,128 @@
+/* fs_handles.c --- FS instances for concurrently running tasks
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#include "svn_pools.h"
+#include "svn_fs.h"
+#include "svn_repos.h"
+#include "repos.h"
+
+#include "private/svn_mutex.h"
+
+
+struct svn_repos__fs_handles_t
+{
+  /* Location and configuration of the repository's FS. */
+  const char *path;
+  apr_hash_t *config;
+
+  /* Currently unused svn_fs_t * instances. */
+  apr_array_header_t *unused;
+
+  /* Thread-safe pool containing the FS instances and UNUSED. */
+  apr_pool_t *pool;
+
+  /* Serializes access to UNUSED and POOL. */
+  svn_mutex__t *mutex;
+};
+
+/* Pool cleanup function releasing all FS instances in the
+   svn_repos__fs_handles_t given as BATON. */
+static apr_status_t
+fs_handles_cleanup(void *baton)
+{
+  svn_repos__fs_handles_t *handles = baton;
+  svn_pool_destroy(handles->pool);
+
+  return APR_SUCCESS;
+}
+
+/* A warning handling function that does not abort on errors,
+   but just lets them be returned normally.  */
+static void
+fs_handles_warning_func(void *baton, svn_error_t *err)
+{
+}
+
+svn_error_t *
+svn_repos__fs_handles_create(svn_repos__fs_handles_t **handles_p,
+                             svn_fs_t *fs,
+                             apr_pool_t *result_pool)
+{
+  svn_repos__fs_handles_t *handles = apr_pcalloc(result_pool, sizeof(*handles));
+
+  handles->path = svn_fs_path(fs, result_pool);
+  handles->config = svn_fs_config(fs, result_pool);
+
+  /* A sub-pool of the standard memory pool is thread-safe. */
+  handles->pool = svn_pool_create(NULL);
+  handles->unused = apr_array_make(handles->pool, 16, sizeof(svn_fs_t *));
+  SVN_ERR(svn_mutex__init(&handles->mutex, TRUE, result_pool));
+
+  apr_pool_cleanup_register(result_pool, handles, fs_handles_cleanup,
+                            apr_pool_cleanup_null);
+
+  *handles_p = handles;
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_repos__fs_handles_acquire(svn_fs_t **fs_p,
+                              svn_repos__fs_handles_t *handles,
+                              apr_pool_t *scratch_pool)
+{
+  apr_pool_t *fs_pool = NULL;
+
+  *fs_p = NULL;
+
+  SVN_ERR(svn_mutex__lock(handles->mutex));
+  if (handles->unused->nelts)
+    *fs_p = APR_ARRAY_IDX(handles->unused, --handles->unused->nelts,
+                          svn_fs_t *);
+  else
+    fs_pool = svn_pool_create(handles->pool);
+  SVN_ERR(svn_mutex__unlock(handles->mutex, SVN_NO_ERROR));
+
+  /* Each instance has its own pool and can be used independently. */
+  if (fs_pool)
+    {
+      SVN_ERR(svn_fs_open2(fs_p, handles->path, handles->config,
+                           fs_pool, scratch_pool));
+      svn_fs_set_warning_func(*fs_p, fs_handles_warning_func, NULL);
+    }
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_repos__fs_handles_release(svn_repos__fs_handles_t *handles,
+                              svn_fs_t *fs,
+                              svn_error_t *err)
+{
+  svn_error_t *lock_err = svn_mutex__lock(handles->mutex);
+  if (lock_err)
+    return svn_error_compose_create(err, lock_err);
+
+  APR_ARRAY_PUSH(handles->unused, svn_fs_t *) = fs;
+
+  return svn_error_trace(svn_mutex__unlock(handles->mutex, err));
+}
@@ -35,6 +35,7 @@
 #include "svn_checksum.h"
 #include "svn_subst.h"
 #include "svn_dirent_uri.h"
+#include "svn_delta.h"
 
 #include <apr_lib.h>
 
@@ -42,6 +43,8 @@
 #include "private/svn_dep_compat.h"
 #include "private/svn_mergeinfo_private.h"
 #include "private/svn_repos_private.h"
+#include "private/svn_subr_private.h"
+#include "private/svn_parallel.h"
 
 /*----------------------------------------------------------------------*/
 
@@ -87,6 +90,15 @@ struct parse_baton
   /* The oldest revision loaded from the dump stream.  If no revisions
      have been loaded yet, this is set to SVN_INVALID_REVNUM. */
   svn_revnum_t oldest_dumpstream_rev;
+
+  /* Number of threads to reconstruct file contents with.  If this is
+     larger than 1, text deltas get passed to set_fulltext() unparsed and
+     most texts get deferred to apply_pending_texts().  FS_HANDLES then
+     provides the FS instances for the worker threads. */
+  int thread_count;
+  svn_repos__fs_handles_t *fs_handles;
+  svn_cancel_func_t cancel_func;
+  void *cancel_baton;
 };
 
 struct revision_baton
@@ -105,6 +117,13 @@ struct revision_baton
   /* Array of svn_prop_t with revision properties. */
   apr_array_header_t *revprops;
 
+  /* Deferred texts, pending_text_t * in stream order, and the paths they
+     belong to, mapped to their pending_text_t *.  Both are allocated in
+     PENDING_POOL and only used if PB->THREAD_COUNT is larger than 1. */
+  apr_array_header_t *pending_texts;
+  apr_hash_t *pending_paths;
+  apr_pool_t *pending_pool;
+
   struct parse_baton *pb;
   apr_pool_t *pool;
 };
@@ -118,13 +137,49 @@ struct node_baton
   svn_checksum_t *result_checksum;      /* null, if not available */
   svn_checksum_t *copy_source_checksum; /* null, if not available */
 
+  svn_checksum_t *result_sha1;          /* null, if not available */
+
   svn_revnum_t copyfrom_rev;
   const char *copyfrom_path;
 
+  /* Whether the node record contains a text block and whether that is a
+     delta which will be passed to set_fulltext() unparsed. */
+  svn_boolean_t has_text;
+  svn_boolean_t text_is_delta;
+
+  /* Whether to defer the text to apply_pending_texts() and the location
+     of the delta base to use in that case.  BASE_PATH is NULL for an
+     empty base. */
+  svn_boolean_t defer_text;
+  svn_revnum_t base_rev;
+  const char *base_path;
+
   struct revision_baton *rb;
   apr_pool_t *pool;
 };
 
+/* A text whose fulltext reconstruction and checksum verification has
+   been deferred such that it can be done concurrently with those of
+   other texts. */
+typedef struct pending_text_t
+{
+  /* The node that the text belongs to. */
+  const char *path;
+
+  /* The text data as found in the dump stream and whether it is a
+     delta against the base at BASE_REV, BASE_PATH.  BASE_PATH is NULL
+     for an empty base. */
+  svn_spillbuf_t *data;
+  svn_boolean_t is_delta;
+  svn_revnum_t base_rev;
+  const char *base_path;
+
+  /* Expected checksums, each null if not available. */
+  svn_checksum_t *base_checksum;
+  svn_checksum_t *result_checksum;
+  svn_checksum_t *result_sha1;
+} pending_text_t;
+
 
 /*----------------------------------------------------------------------*/
 
@@ -373,6 +428,7 @@ make_node_baton(struct node_baton **node_baton_p,
   nb->rb = rb;
   nb->pool = pool;
   nb->kind = svn_node_unknown;
+  nb->base_rev = SVN_INVALID_REVNUM;
 
   /* Then add info from the headers.  */
   if ((val = svn_hash_gets(headers, SVN_REPOS_DUMPFILE_NODE_PATH)))
@@ -425,6 +481,20 @@ make_node_baton(struct node_baton **node_baton_p,
                                      val, pool));
     }
 
+  if ((val = svn_hash_gets(headers, SVN_REPOS_DUMPFILE_TEXT_CONTENT_SHA1)))
+    {
+      SVN_ERR(svn_checksum_parse_hex(&nb->result_sha1, svn_checksum_sha1,
+                                     val, pool));
+    }
+
+  nb->has_text = svn_hash_gets(headers,
+                               SVN_REPOS_DUMPFILE_TEXT_CONTENT_LENGTH) != NULL;
+  if (rb->pb->thread_count > 1)
+    {
+      val = svn_hash_gets(headers, SVN_REPOS_DUMPFILE_TEXT_DELTA);
+      nb->text_is_delta = (val && strcmp(val, "true") == 0);
+    }
+
   if ((val = svn_hash_gets(headers,
                            SVN_REPOS_DUMPFILE_TEXT_DELTA_BASE_CHECKSUM)))
     {
@@ -463,6 +533,14 @@ make_revision_baton(apr_hash_t *headers,
   rb->rev = SVN_INVALID_REVNUM;
   rb->revprops = apr_array_make(rb->pool, 8, sizeof(svn_prop_t));
 
+  if (pb->thread_count > 1)
+    {
+      rb->pending_pool = svn_pool_create(pool);
+      rb->pending_texts = apr_array_make(rb->pending_pool, 0,
+                                         sizeof(pending_text_t *));
+      rb->pending_paths = apr_hash_make(rb->pending_pool);
+    }
+
   if ((val = svn_hash_gets(headers, SVN_REPOS_DUMPFILE_REVISION_NUMBER)))
     {
       rb->rev = SVN_STR_TO_REV(val);
@@ -613,6 +691,10 @@ maybe_add_with_history(struct node_baton *nb,
       SVN_ERR(svn_fs_copy(copy_root, nb->copyfrom_path,
                           rb->txn_root, nb->path, pool));
 
+      /* Any text delta will be against the copy source. */
+      nb->base_rev = copyfrom_rev;
+      nb->base_path = nb->copyfrom_path;
+
       if (pb->notify_func)
         {
           /* ### TODO: Use proper scratch pool instead of pb->notify_pool */
@@ -628,6 +710,257 @@ maybe_add_with_history(struct node_baton *nb,
   return SVN_NO_ERROR;
 }
 
+/* Amount of raw text data and reconstructed fulltext per node to keep in
+   memory before spilling it to a temporary file. */
+#define LOAD_SPILL_MEMORY_SIZE (1024 * 1024)
+
+/* Number of deferred texts per worker thread to collect before
+   processing them. */
+#define LOAD_PENDING_TEXTS_PER_THREAD 16
+
+/* Pool cleanup function destroying the pool given as BATON. */
+static apr_status_t
+pending_text_cleanup(void *baton)
+{
+  svn_pool_destroy(baton);
+
+  return APR_SUCCESS;
+}
+
+/* Return a new pending_text_t for the node NB.  Allocate it in its own,
+   thread-safe pool that will be destroyed with RB->PENDING_POOL. */
+static pending_text_t *
+make_pending_text(struct node_baton *nb,
+                  struct revision_baton *rb)
+{
+  /* The text's data will be read by a worker thread, which may need to
+     allocate memory from its spill buffer's pool.  So, don't use a
+     sub-pool of the parser's pools but a sub-pool of the standard root
+     pool, which is thread-safe. */
+  apr_pool_t *pool = svn_pool_create(NULL);
+  pending_text_t *pt = apr_pcalloc(pool, sizeof(*pt));
+
+  apr_pool_cleanup_register(rb->pending_pool, pool, pending_text_cleanup,
+                            apr_pool_cleanup_null);
+
+  pt->path = apr_pstrdup(pool, nb->path);
+  pt->is_delta = nb->text_is_delta;
+  pt->base_rev = nb->base_rev;
+  pt->base_path = nb->base_path ? apr_pstrdup(pool, nb->base_path) : NULL;
+  pt->base_checksum = svn_checksum_dup(nb->base_checksum, pool);
+  pt->result_checksum = svn_checksum_dup(nb->result_checksum, pool);
+  pt->result_sha1 = svn_checksum_dup(nb->result_sha1, pool);
+  pt->data = svn_spillbuf__create(SVN__STREAM_CHUNK_SIZE,
+                                  LOAD_SPILL_MEMORY_SIZE, pool);
+
+  return pt;
+}
+
+/* Set *CONTENTS to the delta base of PT in FS, verifying its checksum.
+   Allocate the result in RESULT_POOL and use SCRATCH_POOL for temporary
+   allocations. */
+static svn_error_t *
+open_delta_base(svn_stream_t **contents,
+                svn_fs_t *fs,
+                const pending_text_t *pt,
+                apr_pool_t *result_pool,
+                apr_pool_t *scratch_pool)
+{
+  svn_checksum_t *checksum;
+
+  if (pt->base_path)
+    {
+      svn_fs_root_t *root;
+
+      SVN_ERR(svn_fs_revision_root(&root, fs, pt->base_rev, result_pool));
+      if (pt->base_checksum)
+        SVN_ERR(svn_fs_file_checksum(&checksum, svn_checksum_md5, root,
+                                     pt->base_path, TRUE, scratch_pool));
+      SVN_ERR(svn_fs_file_contents(contents, root, pt->base_path,
+                                   result_pool));
+    }
+  else
+    {
+      checksum = svn_checksum_empty_checksum(svn_checksum_md5,
+                                             scratch_pool);
+      *contents = svn_stream_empty(result_pool);
+    }
+
+  if (pt->base_checksum && !svn_checksum_match(pt->base_checksum, checksum))
+    return svn_checksum_mismatch_err(pt->base_checksum, checksum,
+                                     scratch_pool,
+                                     _("Base checksum mismatch on '%s'"),
+                                     pt->path);
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_parallel__task_func_t.  BATON is a revision_baton.
+   Reconstruct the fulltext of its IDX-th pending text into a spill buffer,
+   verify its checksums and return the spill buffer. */
+static svn_error_t *
+text_task(void **result,
+          void *baton,
+          int idx,
+          svn_cancel_func_t cancel_func,
+          void *cancel_baton,
+          apr_pool_t *result_pool,
+          apr_pool_t *scratch_pool)
+{
+  struct revision_baton *rb = baton;
+  const pending_text_t *pt = APR_ARRAY_IDX(rb->pending_texts, idx,
+                                           const pending_text_t *);
+  svn_spillbuf_t *fulltext = svn_spillbuf__create(SVN__STREAM_CHUNK_SIZE,
+                                                  LOAD_SPILL_MEMORY_SIZE,
+                                                  result_pool);
+  svn_stream_t *source = svn_stream__from_spillbuf(pt->data, scratch_pool);
+  svn_stream_t *target = svn_stream__from_spillbuf(fulltext, scratch_pool);
+  svn_checksum_t *md5_checksum = NULL;
+  svn_checksum_t *sha1_checksum = NULL;
+  svn_error_t *err;
+  svn_fs_t *fs = NULL;
+
+  if (pt->result_checksum)
+    target = svn_stream_checksummed2(target, NULL, &md5_checksum,
+                                     svn_checksum_md5, FALSE, scratch_pool);
+  if (pt->result_sha1)
+    target = svn_stream_checksummed2(target, NULL, &sha1_checksum,
+                                     svn_checksum_sha1, FALSE, scratch_pool);
+
+  if (pt->is_delta)
+    {
+      svn_stream_t *base;
+      svn_txdelta_window_handler_t handler;
+      void *handler_baton;
+
+      if (pt->base_path)
+        SVN_ERR(svn_repos__fs_handles_acquire(&fs, rb->pb->fs_handles,
+                                              scratch_pool));
+
+      err = open_delta_base(&base, fs, pt, scratch_pool, scratch_pool);
+      if (!err)
+        {
+          /* Applying the final window will close TARGET. */
+          svn_txdelta_apply(base, target, NULL, pt->path, scratch_pool,
+                            &handler, &handler_baton);
+          err = svn_stream_copy3(source,
+                                 svn_txdelta_parse_svndiff(handler,
+                                                           handler_baton,
+                                                           TRUE,
+                                                           scratch_pool),
+                                 cancel_func, cancel_baton, scratch_pool);
+        }
+
+      if (fs)
+        err = svn_repos__fs_handles_release(rb->pb->fs_handles, fs, err);
+    }
+  else
+    {
+      err = svn_stream_copy3(source, target, cancel_func, cancel_baton,
+                             scratch_pool);
+    }
+
+  SVN_ERR(err);
+
+  if (md5_checksum && !svn_checksum_match(pt->result_checksum, md5_checksum))
+    return svn_checksum_mismatch_err(pt->result_checksum, md5_checksum,
+                                     scratch_pool,
+                                     _("Checksum mismatch for '%s'"),
+                                     pt->path);
+  if (sha1_checksum && !svn_checksum_match(pt->result_sha1, sha1_checksum))
+    return svn_checksum_mismatch_err(pt->result_sha1, sha1_checksum,
+                                     scratch_pool,
+                                     _("Checksum mismatch for '%s'"),
+                                     pt->path);
+
+  *result = fulltext;
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_parallel__output_func_t.  BATON is a revision_baton.
+   Store the fulltext in RESULT as the new contents of the IDX-th pending
+   text's node in the transaction. */
+static svn_error_t *
+text_output(void *baton,
+            int idx,
+            void *result,
+            svn_error_t *task_err,
+            apr_pool_t *scratch_pool)
+{
+  struct revision_baton *rb = baton;
+  const pending_text_t *pt = APR_ARRAY_IDX(rb->pending_texts, idx,
+                                           const pending_text_t *);
+  svn_stream_t *stream;
+
+  SVN_ERR(task_err);
+
+  SVN_ERR(svn_fs_apply_text(&stream, rb->txn_root, pt->path,
+                            svn_checksum_to_cstring(pt->result_checksum,
+                                                    scratch_pool),
+                            scratch_pool));
+
+  return svn_error_trace(svn_stream_copy3(
+                           svn_stream__from_spillbuf(result, scratch_pool),
+                           stream, NULL, NULL, scratch_pool));
+}
+
+/* Reconstruct all texts pending in RB concurrently and apply them to the
+   transaction in stream order. */
+static svn_error_t *
+apply_pending_texts(struct revision_baton *rb)
+{
+  struct parse_baton *pb = rb->pb;
+
+  if (rb->pending_texts->nelts == 0)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_parallel__run(rb->pending_texts->nelts, pb->thread_count, 0,
+                            text_task, rb, text_output, rb,
+                            pb->cancel_func, pb->cancel_baton,
+                            rb->pending_pool));
+
+  svn_pool_clear(rb->pending_pool);
+  rb->pending_texts = apr_array_make(rb->pending_pool, 0,
+                                     sizeof(pending_text_t *));
+  rb->pending_paths = apr_hash_make(rb->pending_pool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Determine whether the text of the node NB shall be reconstructed by a
+   worker thread and set NB->DEFER_TEXT accordingly.  Call this after the
+   node has been created in the transaction but before any of its
+   properties or contents have been changed.  Use POOL for allocations. */
+static svn_error_t *
+prepare_deferred_text(struct node_baton *nb,
+                      struct revision_baton *rb,
+                      apr_pool_t *pool)
+{
+  nb->defer_text = FALSE;
+  if (!nb->has_text || nb->kind == svn_node_dir)
+    return SVN_NO_ERROR;
+
+  /* The delta base of added nodes has already been determined when
+     adding them.  For changed nodes, it is the node's current state. */
+  if (nb->action == svn_node_action_change)
+    {
+      SVN_ERR(svn_fs_node_created_rev(&nb->base_rev, rb->txn_root,
+                                      nb->path, pool));
+
+      /* Already modified in this transaction?  Then the base is not
+         available to the worker threads. */
+      if (!SVN_IS_VALID_REVNUM(nb->base_rev))
+        return SVN_NO_ERROR;
+
+      SVN_ERR(svn_fs_node_created_path(&nb->base_path, rb->txn_root,
+                                       nb->path, pool));
+    }
+
+  nb->defer_text = TRUE;
+  return SVN_NO_ERROR;
+}
+
+
 static svn_error_t *
 uuid_record(const char *uuid,
             void *parse_baton,
@@ -692,6 +1025,14 @@ new_node_record(void **node_baton,
       svn_pool_clear(pb->notify_pool);
     }
 
+  /* Deferred texts must have been applied before we delete their nodes
+     or change them again. */
+  if (rb->pending_texts
+      && (nb->action == svn_node_action_delete
+          || nb->action == svn_node_action_replace
+          || svn_hash_gets(rb->pending_paths, nb->path)))
+    SVN_ERR(apply_pending_texts(rb));
+
   switch (nb->action)
     {
     case svn_node_action_change:
@@ -711,6 +1052,9 @@ new_node_record(void **node_baton,
       break;
     }
 
+  if (rb->pending_texts)
+    SVN_ERR(prepare_deferred_text(nb, rb, pool));
+
   *node_baton = nb;
   return SVN_NO_ERROR;
 }
@@ -955,6 +1299,29 @@ set_fulltext(svn_stream_t **stream,
       return SVN_NO_ERROR;
     }
 
+  if (nb->defer_text)
+    {
+      pending_text_t *pt = make_pending_text(nb, rb);
+
+      APR_ARRAY_PUSH(rb->pending_texts, pending_text_t *) = pt;
+      svn_hash_sets(rb->pending_paths, pt->path, pt);
+
+      *stream = svn_stream__from_spillbuf(pt->data, nb->pool);
+      return SVN_NO_ERROR;
+    }
+
+  /* A delta that we can't defer.  Apply it like apply_textdelta would. */
+  if (nb->text_is_delta)
+    {
+      svn_txdelta_window_handler_t handler;
+      void *handler_baton;
+
+      SVN_ERR(apply_textdelta(&handler, &handler_baton, nb));
+      *stream = svn_txdelta_parse_svndiff(handler, handler_baton, TRUE,
+                                          nb->pool);
+      return SVN_NO_ERROR;
+    }
+
   return svn_fs_apply_text(stream,
                            rb->txn_root, nb->path,
                            svn_checksum_to_cstring(nb->result_checksum,
@@ -985,6 +1352,12 @@ close_node(void *baton)
       svn_pool_clear(pb->notify_pool);
     }
 
+  /* Limit the number of texts held back. */
+  if (rb->pending_texts
+      && rb->pending_texts->nelts
+           >= LOAD_PENDING_TEXTS_PER_THREAD * pb->thread_count)
+    SVN_ERR(apply_pending_texts(rb));
+
   return SVN_NO_ERROR;
 }
 
@@ -1004,6 +1377,10 @@ close_revision(void *baton)
   if (rb->skipped)
     return SVN_NO_ERROR;
 
+  /* All texts must be in place before we commit. */
+  if (rb->pending_texts)
+    SVN_ERR(apply_pending_texts(rb));
+
   if (rb->rev == 0)
     {
       /* Special case: set revision 0 properties when loading into an
@@ -1243,6 +1620,7 @@ svn_repos_get_fs_build_parser6(const svn_repos_parse_fns3_t **callbacks,
   pb->use_post_commit_hook = use_post_commit_hook;
   pb->ignore_dates = ignore_dates;
   pb->normalize_props = normalize_props;
+  pb->thread_count = 1;
 
   *callbacks = parser;
   *parse_baton = pb;
@@ -1262,6 +1640,7 @@ svn_repos_load_fs6(svn_repos_t *repos,
                    svn_boolean_t validate_props,
                    svn_boolean_t ignore_dates,
                    svn_boolean_t normalize_props,
+                   int thread_count,
                    svn_repos_notify_func_t notify_func,
                    void *notify_baton,
                    svn_cancel_func_t cancel_func,
@@ -1270,6 +1649,7 @@ svn_repos_load_fs6(svn_repos_t *repos,
 {
   const svn_repos_parse_fns3_t *parser;
   void *parse_baton;
+  struct parse_baton *pb;
 
   /* This is really simple. */
 
@@ -1288,7 +1668,19 @@ svn_repos_load_fs6(svn_repos_t *repos,
                                          notify_baton,
                                          pool));
 
-  return svn_repos_parse_dumpstream3(dumpstream, parser, parse_baton, FALSE,
+  /* Pass text deltas unparsed to set_fulltext() such that we may defer
+     their application to the worker threads. */
+  pb = parse_baton;
+  if (thread_count > 1)
+    {
+      pb->thread_count = thread_count;
+      pb->cancel_func = cancel_func;
+      pb->cancel_baton = cancel_baton;
+      SVN_ERR(svn_repos__fs_handles_create(&pb->fs_handles, pb->fs, pool));
+    }
+
+  return svn_repos_parse_dumpstream3(dumpstream, parser, parse_baton,
+                                     thread_count > 1,
                                      cancel_func, cancel_baton, pool);
 }
 
@@ -0,0 +1,82 @@
+/* log-index-db.sql -- schema of the per-path log index
+ *   This is intended for use with SQLite 3
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+-- STMT_CREATE_SCHEMA
+/* For every revision and every path that got changed in it, including all
+   parent directories of changed paths, one row giving the kind of change
+   to that path:
+
+     0  something below PATH changed
+     1  PATH itself got modified
+     2  PATH got added, possibly as a copy
+     3  PATH got deleted
+     4  PATH got replaced
+
+   The root directory gets a row for every indexed revision. */
+CREATE TABLE log_index (
+  path TEXT NOT NULL,
+  revision INTEGER NOT NULL,
+  action INTEGER NOT NULL,
+  PRIMARY KEY (path, revision)
+  );
+
+/* A single row holding the youngest revision that has been indexed.
+   All revisions up to and including it have been indexed. */
+CREATE TABLE log_index_info (
+  indexed_revision INTEGER NOT NULL
+  );
+
+INSERT INTO log_index_info (indexed_revision) VALUES (-1);
+
+PRAGMA USER_VERSION = 1;
+
+-- STMT_GET_INDEXED_REVISION
+SELECT indexed_revision
+FROM log_index_info
+
+-- STMT_SET_INDEXED_REVISION
+UPDATE log_index_info
+SET indexed_revision = ?1
+
+-- STMT_SET_CHANGE
+INSERT OR REPLACE INTO log_index (path, revision, action)
+VALUES (?1, ?2, ?3)
+
+-- STMT_GET_LAST_CHANGE
+/* Youngest revision in ?3 .. ?2 that changed ?1 or anything below it. */
+SELECT MAX(revision)
+FROM log_index
+WHERE path = ?1 AND revision <= ?2 AND revision >= ?3
+
+-- STMT_GET_LAST_CREATION
+/* Youngest revision in ?3 .. ?2 that added or replaced ?1. */
+SELECT MAX(revision)
+FROM log_index
+WHERE path = ?1 AND revision <= ?2 AND revision >= ?3 AND action IN (2, 4)
+
+-- STMT_GET_FIRST_REMOVAL
+/* Oldest revision in ?2+1 .. ?3 that deleted or replaced ?1. */
+SELECT MIN(revision)
+FROM log_index
+WHERE path = ?1 AND revision > ?2 AND revision <= ?3 AND action IN (3, 4)
+
@@ -56,6 +56,9 @@ typedef struct log_callbacks_t
   void *revision_receiver_baton;
   svn_repos_authz_func_t authz_read_func;
   void *authz_read_baton;
+
+  /* The log index to use instead of the FS history, or NULL. */
+  svn_repos__log_index_t *log_index;
 } log_callbacks_t;
 
 
@@ -429,8 +432,61 @@ struct path_info
   svn_fs_history_t *hist;
   apr_pool_t *newpool;
   apr_pool_t *oldpool;
+
+  /* If not NULL, look up the history in this index instead of the FS.
+     The three members above will be NULL then. */
+  svn_repos__log_index_t *log_index;
 };
 
+/* Like get_history() but use the log index in INFO. */
+static svn_error_t *
+get_indexed_history(struct path_info *info,
+                    svn_fs_t *fs,
+                    svn_boolean_t strict,
+                    svn_repos_authz_func_t authz_read_func,
+                    void *authz_read_baton,
+                    svn_revnum_t start,
+                    apr_pool_t *scratch_pool)
+{
+  const char *path;
+
+  SVN_ERR(svn_repos__log_index_history_prev(&path, &info->history_rev,
+                                            info->log_index,
+                                            info->path->data,
+                                            info->history_rev,
+                                            ! strict, info->first_time,
+                                            scratch_pool, scratch_pool));
+  info->first_time = FALSE;
+
+  /* No more history or history item predates our START revision? */
+  if (! path || info->history_rev < start)
+    {
+      info->done = TRUE;
+      return SVN_NO_ERROR;
+    }
+
+  svn_stringbuf_set(info->path, path);
+
+  /* Is the history item readable?  If not, done with path. */
+  if (authz_read_func)
+    {
+      svn_boolean_t readable;
+      svn_fs_root_t *history_root;
+
+      SVN_ERR(svn_fs_revision_root(&history_root, fs,
+                                   info->history_rev,
+                                   scratch_pool));
+      SVN_ERR(authz_read_func(&readable, history_root,
+                              info->path->data,
+                              authz_read_baton,
+                              scratch_pool));
+      if (! readable)
+        info->done = TRUE;
+    }
+
+  return SVN_NO_ERROR;
+}
+
 /* Advance to the next history for the path.
  *
  * If INFO->HIST is not NULL we do this using that existing history object,
@@ -462,6 +518,12 @@ get_history(struct path_info *info,
   apr_pool_t *subpool;
   const char *path;
 
+  if (info->log_index)
+    return svn_error_trace(get_indexed_history(info, fs, strict,
+                                               authz_read_func,
+                                               authz_read_baton, start,
+                                               scratch_pool));
+
   if (info->hist)
     {
       subpool = info->newpool;
@@ -1387,13 +1449,15 @@ send_log(svn_revnum_t rev,
    memory. */
 #define MAX_OPEN_HISTORIES 32
 
-/* Get the histories for PATHS, and store them in *HISTORIES.
+/* Get the histories for PATHS, and store them in *HISTORIES.  If LOG_INDEX
+   is not NULL, use it instead of the FS history objects.
 
    If IGNORE_MISSING_LOCATIONS is set, don't treat requests for bogus
    repository locations as fatal -- just ignore them.  */
 static svn_error_t *
 get_path_histories(apr_array_header_t **histories,
                    svn_fs_t *fs,
+                   svn_repos__log_index_t *log_index,
                    const apr_array_header_t *paths,
                    svn_revnum_t hist_start,
                    svn_revnum_t hist_end,
@@ -1442,8 +1506,9 @@ get_path_histories(apr_array_header_t **histories,
       info->done = FALSE;
       info->history_rev = hist_end;
       info->first_time = TRUE;
+      info->log_index = log_index;
 
-      if (i < MAX_OPEN_HISTORIES)
+      if (i < MAX_OPEN_HISTORIES && ! log_index)
         {
           err = svn_fs_node_history2(&info->hist, root, this_path, pool,
                                      iterpool);
@@ -2012,7 +2077,8 @@ do_logs(svn_fs_t *fs,
      about all the revisions in the range -- only the ones in which
      one of our paths was changed.  So let's go figure out which
      revisions contain real changes to at least one of our paths.  */
-  SVN_ERR(get_path_histories(&histories, fs, paths, hist_start, hist_end,
+  SVN_ERR(get_path_histories(&histories, fs, callbacks->log_index,
+                             paths, hist_start, hist_end,
                              strict_node_history, ignore_missing_locations,
                              callbacks->authz_read_func,
                              callbacks->authz_read_baton, pool));
@@ -2332,6 +2398,7 @@ svn_repos_get_logs5(svn_repos_t *repos,
   callbacks.revision_receiver_baton = revision_receiver_baton;
   callbacks.authz_read_func = authz_read_func;
   callbacks.authz_read_baton = authz_read_baton;
+  callbacks.log_index = NULL;
 
   if (revprops)
     {
@@ -2460,6 +2527,11 @@ svn_repos_get_logs5(svn_repos_t *repos,
       svn_pool_destroy(subpool);
     }
 
+  /* Use the log index, if available, to find the revisions that touched
+     PATHS.  It will be closed along with SCRATCH_POOL. */
+  SVN_ERR(svn_repos__log_index_open(&callbacks.log_index, fs, end,
+                                    scratch_pool, scratch_pool));
+
   return do_logs(repos->fs, paths, paths_history_mergeinfo, NULL, NULL,
                  start, end, limit, strict_node_history,
                  include_merged_revisions, FALSE, FALSE, FALSE,
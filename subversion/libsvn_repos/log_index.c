@@ -0,0 +1,525 @@
+/* log_index.c : an on-disk index of the revisions that changed each path
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#include "svn_dirent_uri.h"
+#include "svn_error.h"
+#include "svn_fs.h"
+#include "svn_hash.h"
+#include "svn_pools.h"
+#include "svn_repos.h"
+
+#include "private/svn_fspath.h"
+#include "private/svn_sqlite.h"
+
+#include "repos.h"
+#include "svn_private_config.h"
+
+#include "log-index-db.h"
+
+LOG_INDEX_DB_SQL_DECLARE_STATEMENTS(statements);
+
+
+/* The ACTION values stored in the index.  See log-index-db.sql. */
+#define ACTION_BELOW    0
+#define ACTION_MODIFY   1
+#define ACTION_ADD      2
+#define ACTION_DELETE   3
+#define ACTION_REPLACE  4
+
+/* The maximum number of revisions a commit will add to a log index that
+   has fallen behind, e.g. because the update for a concurrent commit came
+   first or an earlier update failed. */
+#define MAX_COMMIT_CATCH_UP 16
+
+struct svn_repos__log_index_t
+{
+  /* The filesystem being indexed. */
+  svn_fs_t *fs;
+
+  /* The index database, opened read-only. */
+  svn_sqlite__db_t *sdb;
+};
+
+/* Return the location of the log index for FS, allocated in RESULT_POOL. */
+static const char *
+path_log_index_db(svn_fs_t *fs,
+                  apr_pool_t *result_pool)
+{
+  return svn_dirent_join(svn_fs_path(fs, result_pool),
+                         SVN_REPOS__LOG_INDEX_DB, result_pool);
+}
+
+/* Set *INDEXED_REV to the youngest revision fully covered by SDB. */
+static svn_error_t *
+get_indexed_revision(svn_revnum_t *indexed_rev,
+                     svn_sqlite__db_t *sdb)
+{
+  svn_sqlite__stmt_t *stmt;
+  svn_boolean_t have_row;
+
+  SVN_ERR(svn_sqlite__get_statement(&stmt, sdb, STMT_GET_INDEXED_REVISION));
+  SVN_ERR(svn_sqlite__step(&have_row, stmt));
+  *indexed_rev = have_row ? svn_sqlite__column_revnum(stmt, 0)
+                          : SVN_INVALID_REVNUM;
+
+  return svn_error_trace(svn_sqlite__reset(stmt));
+}
+
+/* Set *REVISION to the result of the single-value statement STMT_IDX
+   run against SDB with the arguments PATH, REV1 and REV2.  Set it to
+   SVN_INVALID_REVNUM if there is no such revision. */
+static svn_error_t *
+query_revision(svn_revnum_t *revision,
+               svn_sqlite__db_t *sdb,
+               int stmt_idx,
+               const char *path,
+               svn_revnum_t rev1,
+               svn_revnum_t rev2)
+{
+  svn_sqlite__stmt_t *stmt;
+  svn_boolean_t have_row;
+
+  SVN_ERR(svn_sqlite__get_statement(&stmt, sdb, stmt_idx));
+  SVN_ERR(svn_sqlite__bindf(stmt, "srr", path, rev1, rev2));
+  SVN_ERR(svn_sqlite__step(&have_row, stmt));
+  *revision = have_row ? svn_sqlite__column_revnum(stmt, 0)
+                       : SVN_INVALID_REVNUM;
+
+  return svn_error_trace(svn_sqlite__reset(stmt));
+}
+
+svn_error_t *
+svn_repos__log_index_open(svn_repos__log_index_t **index_p,
+                          svn_fs_t *fs,
+                          svn_revnum_t revision,
+                          apr_pool_t *result_pool,
+                          apr_pool_t *scratch_pool)
+{
+  const char *db_path = path_log_index_db(fs, scratch_pool);
+  svn_repos__log_index_t *index;
+  svn_node_kind_t kind;
+  svn_revnum_t indexed_rev;
+  int version;
+
+  *index_p = NULL;
+
+  SVN_ERR(svn_io_check_path(db_path, &kind, scratch_pool));
+  if (kind != svn_node_file)
+    return SVN_NO_ERROR;
+
+  index = apr_pcalloc(result_pool, sizeof(*index));
+  index->fs = fs;
+  SVN_ERR(svn_sqlite__open(&index->sdb, db_path, svn_sqlite__mode_readonly,
+                           statements, 0, NULL, 0,
+                           result_pool, scratch_pool));
+
+  /* Only use the index if it is complete for all revisions of interest.
+     Otherwise, the caller falls back to walking the FS history. */
+  SVN_SQLITE__ERR_CLOSE(svn_sqlite__read_schema_version(&version, index->sdb,
+                                                        scratch_pool),
+                        index->sdb);
+  if (version != 1)
+    return svn_error_trace(svn_sqlite__close(index->sdb));
+
+  SVN_SQLITE__ERR_CLOSE(get_indexed_revision(&indexed_rev, index->sdb),
+                        index->sdb);
+  if (indexed_rev < revision)
+    return svn_error_trace(svn_sqlite__close(index->sdb));
+
+  *index_p = index;
+  return SVN_NO_ERROR;
+}
+
+/* Set *BIRTH_REV to the revision in which the node at PATH@REVISION came
+   into existence, i.e. the youngest revision up to REVISION in which PATH
+   or one of its parents got added or replaced.  Set *BIRTH_PATH to the
+   deepest path that got added or replaced in that revision, or to NULL if
+   there is no such revision, in which case *BIRTH_REV will be 0.
+   Allocate *BIRTH_PATH in RESULT_POOL. */
+static svn_error_t *
+find_birth(svn_revnum_t *birth_rev,
+           const char **birth_path,
+           svn_repos__log_index_t *index,
+           const char *path,
+           svn_revnum_t revision,
+           apr_pool_t *result_pool)
+{
+  *birth_rev = 0;
+  *birth_path = NULL;
+
+  while (TRUE)
+    {
+      svn_revnum_t created_rev;
+
+      SVN_ERR(query_revision(&created_rev, index->sdb,
+                             STMT_GET_LAST_CREATION, path, revision, 0));
+
+      /* On ties, the deepest path wins. */
+      if (SVN_IS_VALID_REVNUM(created_rev)
+          && (!*birth_path || created_rev > *birth_rev))
+        {
+          *birth_rev = created_rev;
+          *birth_path = path;
+        }
+
+      if (svn_fspath__is_root(path, strlen(path)))
+        break;
+
+      path = svn_fspath__dirname(path, result_pool);
+    }
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_repos__log_index_history_prev(const char **prev_path,
+                                  svn_revnum_t *prev_rev,
+                                  svn_repos__log_index_t *index,
+                                  const char *path,
+                                  svn_revnum_t revision,
+                                  svn_boolean_t cross_copies,
+                                  svn_boolean_t inclusive,
+                                  apr_pool_t *result_pool,
+                                  apr_pool_t *scratch_pool)
+{
+  *prev_path = NULL;
+  *prev_rev = SVN_INVALID_REVNUM;
+  path = svn_fspath__canonicalize(path, scratch_pool);
+
+  /* Like svn_fs_node_history2(), fail for non-existent paths. */
+  if (inclusive)
+    {
+      svn_fs_root_t *root;
+      svn_node_kind_t kind;
+
+      SVN_ERR(svn_fs_revision_root(&root, index->fs, revision, scratch_pool));
+      SVN_ERR(svn_fs_check_path(&kind, root, path, scratch_pool));
+      if (kind == svn_node_none)
+        return svn_error_createf(SVN_ERR_FS_NOT_FOUND, NULL,
+                                 _("File not found: revision %ld, path '%s'"),
+                                 revision, path);
+    }
+
+  while (TRUE)
+    {
+      svn_revnum_t birth_rev, last_rev;
+      const char *birth_path;
+      svn_revnum_t max_rev = inclusive ? revision : revision - 1;
+      svn_fs_root_t *root;
+      svn_revnum_t copyfrom_rev;
+      const char *copyfrom_path;
+
+      SVN_ERR(find_birth(&birth_rev, &birth_path, index, path, revision,
+                         scratch_pool));
+
+      /* Still within the lifetime of the current node?  Then report the
+         latest change to it, or its creation, if there are no further
+         changes. */
+      if (max_rev >= birth_rev)
+        {
+          SVN_ERR(query_revision(&last_rev, index->sdb,
+                                 STMT_GET_LAST_CHANGE, path, max_rev,
+                                 birth_rev));
+
+          *prev_path = apr_pstrdup(result_pool, path);
+          *prev_rev = SVN_IS_VALID_REVNUM(last_rev) ? last_rev : birth_rev;
+          return SVN_NO_ERROR;
+        }
+
+      /* We are at the start of the node's lifetime.  Continue at the copy
+         source, if there is one and we may follow it. */
+      if (!cross_copies || !birth_path)
+        return SVN_NO_ERROR;
+
+      SVN_ERR(svn_fs_revision_root(&root, index->fs, birth_rev,
+                                   scratch_pool));
+      SVN_ERR(svn_fs_copied_from(&copyfrom_rev, &copyfrom_path, root,
+                                 birth_path, scratch_pool));
+      if (!copyfrom_path)
+        return SVN_NO_ERROR;
+
+      path = svn_fspath__join(copyfrom_path,
+                              svn_fspath__skip_ancestor(birth_path, path),
+                              scratch_pool);
+      revision = copyfrom_rev;
+      inclusive = TRUE;
+    }
+}
+
+svn_error_t *
+svn_repos__log_index_deleted_rev(svn_revnum_t *deleted,
+                                 svn_repos__log_index_t *index,
+                                 const char *path,
+                                 svn_revnum_t start,
+                                 svn_revnum_t end,
+                                 apr_pool_t *scratch_pool)
+{
+  *deleted = SVN_INVALID_REVNUM;
+  path = svn_fspath__canonicalize(path, scratch_pool);
+
+  /* PATH@START goes away when it or any of its parents get deleted or
+     replaced, even if it is replaced by a copy of itself. */
+  while (TRUE)
+    {
+      svn_revnum_t removed_rev;
+
+      SVN_ERR(query_revision(&removed_rev, index->sdb,
+                             STMT_GET_FIRST_REMOVAL, path, start, end));
+      if (SVN_IS_VALID_REVNUM(removed_rev)
+          && (!SVN_IS_VALID_REVNUM(*deleted) || removed_rev < *deleted))
+        *deleted = removed_rev;
+
+      if (svn_fspath__is_root(path, strlen(path)))
+        break;
+
+      path = svn_fspath__dirname(path, scratch_pool);
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Baton for index_revision(). */
+typedef struct index_revision_baton_t
+{
+  svn_fs_t *fs;
+  svn_revnum_t revision;
+} index_revision_baton_t;
+
+/* Add the changes of the revision given by the index_revision_baton_t
+   BATON to SDB, unless somebody else already did that.
+   Implements svn_sqlite__transaction_callback_t. */
+static svn_error_t *
+index_revision(void *baton,
+               svn_sqlite__db_t *sdb,
+               apr_pool_t *scratch_pool)
+{
+  index_revision_baton_t *b = baton;
+  svn_fs_root_t *root;
+  svn_fs_path_change_iterator_t *iterator;
+  svn_fs_path_change3_t *change;
+  svn_sqlite__stmt_t *stmt;
+  svn_revnum_t indexed_rev;
+  apr_hash_t *actions = apr_hash_make(scratch_pool);
+  apr_hash_index_t *hi;
+
+  /* Concurrent commits may race to update the index. */
+  SVN_ERR(get_indexed_revision(&indexed_rev, sdb));
+  if (indexed_rev >= b->revision)
+    return SVN_NO_ERROR;
+
+  SVN_ERR_ASSERT(indexed_rev == b->revision - 1);
+
+  SVN_ERR(svn_fs_revision_root(&root, b->fs, b->revision, scratch_pool));
+  SVN_ERR(svn_fs_paths_changed3(&iterator, root, scratch_pool,
+                                scratch_pool));
+  SVN_ERR(svn_fs_path_change_get(&change, iterator));
+  while (change)
+    {
+      const char *path = apr_pstrmemdup(scratch_pool, change->path.data,
+                                        change->path.len);
+      int action;
+
+      switch (change->change_kind)
+        {
+          case svn_fs_path_change_add:
+            action = ACTION_ADD;
+            break;
+
+          case svn_fs_path_change_delete:
+            action = ACTION_DELETE;
+            break;
+
+          case svn_fs_path_change_replace:
+            action = ACTION_REPLACE;
+            break;
+
+          default:
+            action = ACTION_MODIFY;
+            break;
+        }
+
+      svn_hash_sets(actions, path, apr_pmemdup(scratch_pool, &action,
+                                               sizeof(action)));
+
+      /* All parents have been changed as well. */
+      while (!svn_fspath__is_root(path, strlen(path)))
+        {
+          path = svn_fspath__dirname(path, scratch_pool);
+          if (!svn_hash_gets(actions, path))
+            {
+              static const int below = ACTION_BELOW;
+              svn_hash_sets(actions, path, &below);
+            }
+        }
+
+      SVN_ERR(svn_fs_path_change_get(&change, iterator));
+    }
+
+  /* Every revision creates a new root node, r0 even the very first one. */
+  if (b->revision == 0)
+    {
+      static const int add = ACTION_ADD;
+      svn_hash_sets(actions, "/", &add);
+    }
+  else if (!svn_hash_gets(actions, "/"))
+    {
+      static const int below = ACTION_BELOW;
+      svn_hash_sets(actions, "/", &below);
+    }
+
+  SVN_ERR(svn_sqlite__get_statement(&stmt, sdb, STMT_SET_CHANGE));
+  for (hi = apr_hash_first(scratch_pool, actions); hi; hi = apr_hash_next(hi))
+    {
+      const int *action = apr_hash_this_val(hi);
+
+      SVN_ERR(svn_sqlite__bindf(stmt, "srd", apr_hash_this_key(hi),
+                                b->revision, *action));
+      SVN_ERR(svn_sqlite__update(NULL, stmt));
+    }
+
+  SVN_ERR(svn_sqlite__get_statement(&stmt, sdb, STMT_SET_INDEXED_REVISION));
+  SVN_ERR(svn_sqlite__bindf(stmt, "r", b->revision));
+  return svn_error_trace(svn_sqlite__update(NULL, stmt));
+}
+
+svn_error_t *
+svn_repos__log_index_update(svn_fs_t *fs,
+                            svn_revnum_t revision,
+                            svn_boolean_t create,
+                            svn_boolean_t catch_up,
+                            svn_repos_notify_func_t notify_func,
+                            void *notify_baton,
+                            svn_cancel_func_t cancel_func,
+                            void *cancel_baton,
+                            apr_pool_t *scratch_pool)
+{
+  const char *db_path = path_log_index_db(fs, scratch_pool);
+  apr_pool_t *iterpool;
+  svn_sqlite__db_t *sdb;
+  svn_node_kind_t kind;
+  svn_revnum_t indexed_rev;
+  index_revision_baton_t baton;
+  svn_repos_notify_t *notify = NULL;
+  int version;
+
+  SVN_ERR(svn_io_check_path(db_path, &kind, scratch_pool));
+  if (kind == svn_node_none)
+    {
+      /* The index is optional.  Don't create it implicitly. */
+      if (!create)
+        return SVN_NO_ERROR;
+
+#ifndef WIN32
+      {
+        /* Like the repository as a whole, the index must be writable
+           for every process that may commit to it. */
+        const char *perms_path = svn_dirent_join(svn_fs_path(fs, scratch_pool),
+                                                 "fs-type", scratch_pool);
+        svn_error_t *err = svn_io_file_create_empty(db_path, scratch_pool);
+
+        if (err && !APR_STATUS_IS_EEXIST(err->apr_err))
+          return svn_error_trace(err);
+        else if (err)
+          svn_error_clear(err);
+        else
+          SVN_ERR(svn_io_copy_perms(perms_path, db_path, scratch_pool));
+      }
+#endif
+    }
+
+  SVN_ERR(svn_sqlite__open(&sdb, db_path, svn_sqlite__mode_rwcreate,
+                           statements, 0, NULL, 0,
+                           scratch_pool, scratch_pool));
+
+  SVN_SQLITE__ERR_CLOSE(svn_sqlite__read_schema_version(&version, sdb,
+                                                        scratch_pool),
+                        sdb);
+  if (version <= 0)
+    SVN_SQLITE__ERR_CLOSE(svn_sqlite__exec_statements(sdb,
+                                                      STMT_CREATE_SCHEMA),
+                          sdb);
+  else if (version != 1)
+    return svn_error_compose_create(
+             svn_error_createf(SVN_ERR_REPOS_UNSUPPORTED_VERSION, NULL,
+                               _("Unsupported log index schema version %d "
+                                 "in '%s'"),
+                               version,
+                               svn_dirent_local_style(db_path, scratch_pool)),
+             svn_sqlite__close(sdb));
+
+  SVN_SQLITE__ERR_CLOSE(get_indexed_revision(&indexed_rev, sdb), sdb);
+
+  /* Leave larger gaps to be filled by a CATCH_UP run. */
+  if (!catch_up && revision - indexed_rev > MAX_COMMIT_CATCH_UP)
+    return svn_error_trace(svn_sqlite__close(sdb));
+
+  if (notify_func)
+    notify = svn_repos_notify_create(svn_repos_notify_log_index_rev,
+                                     scratch_pool);
+
+  /* Index one revision per transaction, such that concurrent readers get
+     to use the index and an interrupted run loses little work. */
+  baton.fs = fs;
+  iterpool = svn_pool_create(scratch_pool);
+  for (baton.revision = indexed_rev + 1;
+       baton.revision <= revision;
+       ++baton.revision)
+    {
+      svn_pool_clear(iterpool);
+
+      if (cancel_func)
+        SVN_SQLITE__ERR_CLOSE(cancel_func(cancel_baton), sdb);
+
+      SVN_SQLITE__ERR_CLOSE(svn_sqlite__with_immediate_transaction(
+                              sdb, index_revision, &baton, iterpool),
+                            sdb);
+
+      if (notify_func)
+        {
+          notify->revision = baton.revision;
+          notify_func(notify_baton, notify, iterpool);
+        }
+    }
+  svn_pool_destroy(iterpool);
+
+  return svn_error_trace(svn_sqlite__close(sdb));
+}
+
+svn_error_t *
+svn_repos_build_log_index(svn_repos_t *repos,
+                          svn_repos_notify_func_t notify_func,
+                          void *notify_baton,
+                          svn_cancel_func_t cancel_func,
+                          void *cancel_baton,
+                          apr_pool_t *scratch_pool)
+{
+  svn_revnum_t youngest;
+
+  SVN_ERR(svn_fs_youngest_rev(&youngest, repos->fs, scratch_pool));
+  return svn_error_trace(svn_repos__log_index_update(repos->fs, youngest,
+                                                     TRUE, TRUE,
+                                                     notify_func,
+                                                     notify_baton,
+                                                     cancel_func,
+                                                     cancel_baton,
+                                                     scratch_pool));
+}
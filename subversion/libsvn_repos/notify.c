@@ -42,3 +42,19 @@ svn_repos_notify_create(svn_repos_notify_action_t action,
 
   return notify;
 }
+
+void
+svn_repos__notify_record(void *baton,
+                         const svn_repos_notify_t *notify,
+                         apr_pool_t *scratch_pool)
+{
+  apr_array_header_t *notifications = baton;
+  apr_pool_t *result_pool = notifications->pool;
+  svn_repos_notify_t *copy = apr_pmemdup(result_pool, notify,
+                                         sizeof(*copy));
+
+  copy->warning_str = apr_pstrdup(result_pool, notify->warning_str);
+  copy->path = apr_pstrdup(result_pool, notify->path);
+
+  APR_ARRAY_PUSH(notifications, svn_repos_notify_t *) = copy;
+}
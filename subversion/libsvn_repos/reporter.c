@@ -34,13 +34,24 @@
 #include "repos.h"
 #include "svn_private_config.h"
 
+#include "private/svn_atomic.h"
 #include "private/svn_dep_compat.h"
 #include "private/svn_fspath.h"
+#include "private/svn_parallel.h"
+#include "private/svn_repos_private.h"
 #include "private/svn_subr_private.h"
 #include "private/svn_string_private.h"
 
 #define NUM_CACHED_SOURCE_ROOTS 4
 
+/* Directories with fewer entries than this will not be processed by
+   worker threads.  Starting them would cost more than it saves. */
+#define PREFETCH_MIN_ENTRIES 8
+
+/* Only compute text deltas ahead of the editor drive for files up to
+   this size.  The deltas of larger files get streamed as usual. */
+#define PREFETCH_MAX_TEXT_SIZE (256 * 1024)
+
 /* Theory of operation: we write report operations out to a spill-buffer
    as we receive them.  When the report is finished, we read the
    operations back out again, using them to guide the progression of
@@ -100,6 +111,42 @@ typedef struct revision_info_t
   svn_string_t* author;        /* name of the revisions' author */
 } revision_info_t;
 
+/* Describes a file entry that a worker thread has compared ahead of the
+   editor drive.  All data is taken from the source S_REV/S_PATH and the
+   target B->t_rev/T_PATH.  S_PATH is NULL if the file will be sent as an
+   addition.  See prefetch_file(). */
+typedef struct file_prefetch_t
+{
+  svn_revnum_t s_rev;
+  const char *s_path;
+  const char *t_path;
+
+  /* Whether properties or contents changed, as determined by
+     update_entry() for files with a common immediate predecessor.
+     TRUE if not applicable. */
+  svn_boolean_t changed;
+
+  /* The revision that T_PATH was last changed in. */
+  svn_revnum_t created_rev;
+
+  /* The target's properties and, if they differ from the target's, the
+     source's properties.  S_PROPS is NULL otherwise. */
+  apr_hash_t *t_props;
+  svn_boolean_t props_different;
+  apr_hash_t *s_props;
+
+  /* Whether the contents differ and the MD5 digests of the source and
+     target contents.  S_HEX_DIGEST is NULL if the contents are the same
+     or S_PATH is NULL. */
+  svn_boolean_t contents_different;
+  const char *s_hex_digest;
+  const char *t_hex_digest;
+
+  /* The text delta windows, svn_txdelta_window_t *, not including the
+     final NULL window.  NULL if the delta has not been prefetched. */
+  apr_array_header_t *windows;
+} file_prefetch_t;
+
 /* A structure used by the routines within the `reporter' vtable,
    driven by the client as it describes its working copy revisions. */
 typedef struct report_baton_t
@@ -143,6 +190,20 @@ typedef struct report_baton_t
 
   /* This will not change. So, fetch it once and reuse it. */
   svn_string_t *repos_uuid;
+
+  /* Maximum number of worker threads to use and the FS instances for
+     them.  FS_HANDLES is NULL if THREAD_COUNT is 1. */
+  int thread_count;
+  svn_repos__fs_handles_t *fs_handles;
+
+  /* The prefetched data for the file entry currently being processed
+     by update_entry() or NULL.  See find_prefetch(). */
+  const file_prefetch_t *prefetch;
+
+  /* Whether a delta_dirs() call further up is running its entries through
+     worker threads.  Only that one gets to use them.  See delta_dirs(). */
+  svn_boolean_t prefetching;
+
   apr_pool_t *pool;
 } report_baton_t;
 
@@ -442,6 +503,26 @@ get_source_root(report_baton_t *b, svn_fs_root_t **s_root, svn_revnum_t rev)
   return SVN_NO_ERROR;
 }
 
+/* Return B->prefetch if it has been gathered for the source S_REV/S_PATH
+   and the target T_PATH.  S_PATH may be NULL.  Return NULL otherwise. */
+static const file_prefetch_t *
+find_prefetch(report_baton_t *b, svn_revnum_t s_rev, const char *s_path,
+              const char *t_path)
+{
+  const file_prefetch_t *prefetch = b->prefetch;
+
+  if (!prefetch || strcmp(prefetch->t_path, t_path) != 0)
+    return NULL;
+
+  if (!s_path || !prefetch->s_path)
+    return (s_path == prefetch->s_path) ? prefetch : NULL;
+
+  if (s_rev != prefetch->s_rev || strcmp(s_path, prefetch->s_path) != 0)
+    return NULL;
+
+  return prefetch;
+}
+
 /* Call the directory property-setting function of B->editor to set
    the property NAME to VALUE on DIR_BATON. */
 static svn_error_t *
@@ -523,9 +604,13 @@ delta_proplists(report_baton_t *b, svn_revnum_t s_rev, const char *s_path,
   svn_fs_root_t *s_root;
   apr_hash_t *s_props = NULL, *t_props;
   svn_revnum_t crev;
+  const file_prefetch_t *prefetch = find_prefetch(b, s_rev, s_path, t_path);
 
   /* Fetch the created-rev and send entry props. */
-  SVN_ERR(svn_fs_node_created_rev(&crev, b->t_root, t_path, pool));
+  if (prefetch)
+    crev = prefetch->created_rev;
+  else
+    SVN_ERR(svn_fs_node_created_rev(&crev, b->t_root, t_path, pool));
   if (SVN_IS_VALID_REVNUM(crev))
     {
       revision_info_t *revision_info;
@@ -568,23 +653,34 @@ delta_proplists(report_baton_t *b, svn_revnum_t s_rev, const char *s_path,
                           NULL, pool));
     }
 
-  if (s_path)
+  if (prefetch)
     {
-      svn_boolean_t changed;
-      SVN_ERR(get_source_root(b, &s_root, s_rev));
-
-      /* Is this deltification worth our time? */
-      SVN_ERR(svn_fs_props_different(&changed, b->t_root, t_path, s_root,
-                                     s_path, pool));
-      if (! changed)
+      if (s_path && !prefetch->props_different)
         return SVN_NO_ERROR;
 
-      /* If so, go ahead and get the source path's properties. */
-      SVN_ERR(svn_fs_node_proplist(&s_props, s_root, s_path, pool));
+      s_props = prefetch->s_props;
+      t_props = prefetch->t_props;
     }
+  else
+    {
+      if (s_path)
+        {
+          svn_boolean_t changed;
+          SVN_ERR(get_source_root(b, &s_root, s_rev));
+
+          /* Is this deltification worth our time? */
+          SVN_ERR(svn_fs_props_different(&changed, b->t_root, t_path,
+                                         s_root, s_path, pool));
+          if (! changed)
+            return SVN_NO_ERROR;
 
-  /* Get the target path's properties */
-  SVN_ERR(svn_fs_node_proplist(&t_props, b->t_root, t_path, pool));
+          /* If so, go ahead and get the source path's properties. */
+          SVN_ERR(svn_fs_node_proplist(&s_props, s_root, s_path, pool));
+        }
+
+      /* Get the target path's properties */
+      SVN_ERR(svn_fs_node_proplist(&t_props, b->t_root, t_path, pool));
+    }
 
   if (s_props && apr_hash_count(s_props))
     {
@@ -677,12 +773,21 @@ delta_files(report_baton_t *b, void *file_baton, svn_revnum_t s_rev,
   const char *s_hex_digest = NULL;
   svn_txdelta_window_handler_t dhandler;
   void *dbaton;
+  const file_prefetch_t *prefetch = find_prefetch(b, s_rev, s_path, t_path);
 
   /* Compare the files' property lists.  */
   SVN_ERR(delta_proplists(b, s_rev, s_path, t_path, lock_token,
                           change_file_prop, file_baton, pool));
 
-  if (s_path)
+  if (s_path && prefetch)
+    {
+      if (!prefetch->contents_different)
+        return SVN_NO_ERROR;
+
+      SVN_ERR(get_source_root(b, &s_root, s_rev));
+      s_hex_digest = prefetch->s_hex_digest;
+    }
+  else if (s_path)
     {
       svn_boolean_t changed;
       SVN_ERR(get_source_root(b, &s_root, s_rev));
@@ -708,7 +813,19 @@ delta_files(report_baton_t *b, void *file_baton, svn_revnum_t s_rev,
 
   if (dhandler != svn_delta_noop_window_handler)
     {
-      if (b->text_deltas)
+      if (b->text_deltas && prefetch && prefetch->windows)
+        {
+          int i;
+
+          /* The delta has already been computed by a worker thread. */
+          for (i = 0; i < prefetch->windows->nelts; ++i)
+            SVN_ERR(dhandler(APR_ARRAY_IDX(prefetch->windows, i,
+                                           svn_txdelta_window_t *),
+                             dbaton));
+
+          SVN_ERR(dhandler(NULL, dbaton));
+        }
+      else if (b->text_deltas)
         {
           /* if we send deltas against empty streams, we may use our
              zero-copy code. */
@@ -923,6 +1040,7 @@ update_entry(report_baton_t *b, svn_revnum_t s_rev, const char *s_path,
   void *new_baton;
   svn_checksum_t *checksum;
   const char *hex_digest;
+  const file_prefetch_t *prefetch;
 
   /* For non-switch operations, follow link_path in the target. */
   if (info && info->link_path && !b->is_switch)
@@ -970,14 +1088,22 @@ update_entry(report_baton_t *b, svn_revnum_t s_rev, const char *s_path,
       if (!b->ignore_ancestry && t_entry->kind == svn_node_file &&
           distance == 1)
         {
-          if (s_root == NULL)
-            SVN_ERR(get_source_root(b, &s_root, s_rev));
-
-          SVN_ERR(svn_fs_props_changed(&changed, s_root, s_path,
-                                       b->t_root, t_path, pool));
-          if (!changed)
-            SVN_ERR(svn_fs_contents_changed(&changed, s_root, s_path,
-                                            b->t_root, t_path, pool));
+          prefetch = find_prefetch(b, s_rev, s_path, t_path);
+          if (prefetch)
+            {
+              changed = prefetch->changed;
+            }
+          else
+            {
+              if (s_root == NULL)
+                SVN_ERR(get_source_root(b, &s_root, s_rev));
+
+              SVN_ERR(svn_fs_props_changed(&changed, s_root, s_path,
+                                           b->t_root, t_path, pool));
+              if (!changed)
+                SVN_ERR(svn_fs_contents_changed(&changed, s_root, s_path,
+                                                b->t_root, t_path, pool));
+            }
         }
 
       if ((distance == 0 || !changed) && !any_path_info(b, e_path)
@@ -1087,9 +1213,19 @@ update_entry(report_baton_t *b, svn_revnum_t s_rev, const char *s_path,
                                 t_path, info ? info->lock_token : NULL, pool));
         }
 
-      SVN_ERR(svn_fs_file_checksum(&checksum, svn_checksum_md5, b->t_root,
-                                   t_path, TRUE, pool));
-      hex_digest = svn_checksum_to_cstring(checksum, pool);
+      /* The checksum does not depend on the source. */
+      prefetch = b->prefetch;
+      if (prefetch && strcmp(prefetch->t_path, t_path) == 0)
+        {
+          hex_digest = prefetch->t_hex_digest;
+        }
+      else
+        {
+          SVN_ERR(svn_fs_file_checksum(&checksum, svn_checksum_md5,
+                                       b->t_root, t_path, TRUE, pool));
+          hex_digest = svn_checksum_to_cstring(checksum, pool);
+        }
+
       return svn_error_trace(b->editor->close_file(new_baton, hex_digest,
                                                    pool));
     }
@@ -1099,6 +1235,234 @@ update_entry(report_baton_t *b, svn_revnum_t s_rev, const char *s_path,
 #define DEPTH_BELOW_HERE(depth) ((depth) == svn_depth_immediates) ? \
                                  svn_depth_empty : (depth)
 
+/* A target entry of a directory that delta_dirs() passes on to
+   update_entry().  S_ENTRY and S_PATH may be NULL.  If the entry is a
+   file, PREFETCH_S_PATH is the source that delta_files() will compare
+   it with, unless the report says otherwise.  See prefetch_file(). */
+typedef struct pending_entry_t
+{
+  const svn_fs_dirent_t *s_entry;
+  const svn_fs_dirent_t *t_entry;
+  const char *s_path;
+  const char *t_path;
+  const char *e_path;
+  const char *prefetch_s_path;
+  svn_boolean_t check_changed;
+} pending_entry_t;
+
+/* The target entries of a directory that get prefetched by worker
+   threads and then processed in order.  The other members are the
+   parameters of the update_entry() calls for them. */
+typedef struct prefetch_batch_t
+{
+  report_baton_t *b;
+  apr_array_header_t *entries;   /* pending_entry_t * */
+  svn_revnum_t s_rev;
+  void *dir_baton;
+  svn_depth_t wc_depth;
+  svn_depth_t requested_depth;
+} prefetch_batch_t;
+
+/* Set *WINDOWS to an array of svn_txdelta_window_t * turning the contents
+   of S_ROOT/S_PATH into those of T_ROOT/T_PATH.  S_ROOT and S_PATH may be
+   NULL to compare with the empty file.  Allocate the result in
+   RESULT_POOL and use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+prefetch_windows(apr_array_header_t **windows,
+                 svn_fs_root_t *s_root,
+                 const char *s_path,
+                 svn_fs_root_t *t_root,
+                 const char *t_path,
+                 apr_pool_t *result_pool,
+                 apr_pool_t *scratch_pool)
+{
+  svn_txdelta_stream_t *dstream;
+  svn_txdelta_window_t *window;
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+
+  *windows = apr_array_make(result_pool, 1, sizeof(svn_txdelta_window_t *));
+  SVN_ERR(svn_fs_get_file_delta_stream(&dstream, s_root, s_path,
+                                       t_root, t_path, scratch_pool));
+  do
+    {
+      svn_pool_clear(iterpool);
+      SVN_ERR(svn_txdelta_next_window(&window, dstream, iterpool));
+      if (window)
+        APR_ARRAY_PUSH(*windows, svn_txdelta_window_t *)
+          = svn_txdelta_window_dup(window, result_pool);
+    }
+  while (window);
+
+  svn_pool_destroy(iterpool);
+  return SVN_NO_ERROR;
+}
+
+/* Gather everything that update_entry() and delta_files() need to know
+   about the file ENTRY of B, using FS instead of B's filesystem, and
+   return it in *PREFETCH_P.  Allocate the result in RESULT_POOL and use
+   SCRATCH_POOL for temporary allocations.
+
+   This does not call the editor or the authz callback, so it may be
+   called from any thread. */
+static svn_error_t *
+prefetch_file(file_prefetch_t **prefetch_p,
+              report_baton_t *b,
+              svn_fs_t *fs,
+              svn_revnum_t s_rev,
+              const pending_entry_t *entry,
+              apr_pool_t *result_pool,
+              apr_pool_t *scratch_pool)
+{
+  file_prefetch_t *prefetch = apr_pcalloc(result_pool, sizeof(*prefetch));
+  const char *s_path = entry->prefetch_s_path;
+  const char *t_path = entry->t_path;
+  svn_fs_root_t *s_root = NULL, *t_root;
+  svn_checksum_t *checksum;
+
+  prefetch->s_rev = s_rev;
+  prefetch->s_path = s_path ? apr_pstrdup(result_pool, s_path) : NULL;
+  prefetch->t_path = apr_pstrdup(result_pool, t_path);
+  prefetch->changed = TRUE;
+  prefetch->contents_different = TRUE;
+
+  SVN_ERR(svn_fs_revision_root(&t_root, fs, b->t_rev, scratch_pool));
+  SVN_ERR(svn_fs_node_created_rev(&prefetch->created_rev, t_root, t_path,
+                                  scratch_pool));
+  SVN_ERR(svn_fs_node_proplist(&prefetch->t_props, t_root, t_path,
+                               result_pool));
+  SVN_ERR(svn_fs_file_checksum(&checksum, svn_checksum_md5, t_root,
+                               t_path, TRUE, scratch_pool));
+  prefetch->t_hex_digest = svn_checksum_to_cstring(checksum, result_pool);
+
+  if (s_path)
+    {
+      SVN_ERR(svn_fs_revision_root(&s_root, fs, s_rev, scratch_pool));
+
+      /* Same checks as in update_entry(). */
+      if (entry->check_changed)
+        {
+          SVN_ERR(svn_fs_props_changed(&prefetch->changed, s_root, s_path,
+                                       t_root, t_path, scratch_pool));
+          if (!prefetch->changed)
+            SVN_ERR(svn_fs_contents_changed(&prefetch->changed,
+                                            s_root, s_path,
+                                            t_root, t_path, scratch_pool));
+        }
+
+      /* Same checks as in delta_proplists() and delta_files(). */
+      SVN_ERR(svn_fs_props_different(&prefetch->props_different,
+                                     t_root, t_path, s_root, s_path,
+                                     scratch_pool));
+      if (prefetch->props_different)
+        SVN_ERR(svn_fs_node_proplist(&prefetch->s_props, s_root, s_path,
+                                     result_pool));
+
+      SVN_ERR(svn_fs_contents_different(&prefetch->contents_different,
+                                        t_root, t_path, s_root, s_path,
+                                        scratch_pool));
+      if (prefetch->contents_different)
+        {
+          SVN_ERR(svn_fs_file_checksum(&checksum, svn_checksum_md5, s_root,
+                                       s_path, TRUE, scratch_pool));
+          prefetch->s_hex_digest = svn_checksum_to_cstring(checksum,
+                                                           result_pool);
+        }
+    }
+
+  if (b->text_deltas && prefetch->contents_different)
+    {
+      svn_filesize_t length;
+
+      SVN_ERR(svn_fs_file_length(&length, t_root, t_path, scratch_pool));
+      if (length <= PREFETCH_MAX_TEXT_SIZE)
+        SVN_ERR(prefetch_windows(&prefetch->windows, s_root, s_path,
+                                 t_root, t_path, result_pool,
+                                 scratch_pool));
+    }
+
+  *prefetch_p = prefetch;
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_parallel__task_func_t.  BATON is a prefetch_batch_t.
+   For file entries, return a file_prefetch_t * for the IDX-th entry. */
+static svn_error_t *
+prefetch_task(void **result,
+              void *baton,
+              int idx,
+              svn_cancel_func_t cancel_func,
+              void *cancel_baton,
+              apr_pool_t *result_pool,
+              apr_pool_t *scratch_pool)
+{
+  prefetch_batch_t *batch = baton;
+  report_baton_t *b = batch->b;
+  const pending_entry_t *entry = APR_ARRAY_IDX(batch->entries, idx,
+                                               const pending_entry_t *);
+  file_prefetch_t *prefetch;
+  svn_fs_t *fs;
+  svn_error_t *err;
+
+  /* Directories will be handled by their own delta_dirs() call. */
+  if (entry->t_entry->kind != svn_node_file)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(svn_repos__fs_handles_acquire(&fs, b->fs_handles, scratch_pool));
+  err = prefetch_file(&prefetch, b, fs, batch->s_rev, entry,
+                      result_pool, scratch_pool);
+  SVN_ERR(svn_repos__fs_handles_release(b->fs_handles, fs, err));
+
+  *result = prefetch;
+  return SVN_NO_ERROR;
+}
+
+/* Number of file entries prefetched by any report in this process.
+   See svn_repos__report_prefetch_count(). */
+static volatile svn_atomic_t prefetch_count = 0;
+
+apr_uint32_t
+svn_repos__report_prefetch_count(void)
+{
+  return svn_atomic_read(&prefetch_count);
+}
+
+/* Implements svn_parallel__output_func_t.  BATON is a prefetch_batch_t.
+   Call update_entry() for the IDX-th entry, using the file_prefetch_t *
+   RESULT, if any. */
+static svn_error_t *
+prefetch_output(void *baton,
+                int idx,
+                void *result,
+                svn_error_t *task_err,
+                apr_pool_t *scratch_pool)
+{
+  prefetch_batch_t *batch = baton;
+  report_baton_t *b = batch->b;
+  const pending_entry_t *entry = APR_ARRAY_IDX(batch->entries, idx,
+                                               const pending_entry_t *);
+  svn_error_t *err;
+
+  /* Prefetching is only an optimization.  If it failed, let the regular
+     code do the work and report the problem. */
+  if (task_err)
+    {
+      svn_error_clear(task_err);
+      result = NULL;
+    }
+
+  if (result)
+    svn_atomic_inc(&prefetch_count);
+
+  b->prefetch = result;
+  err = update_entry(b, batch->s_rev, entry->s_path, entry->s_entry,
+                     entry->t_path, entry->t_entry, batch->dir_baton,
+                     entry->e_path, NULL, batch->wc_depth,
+                     batch->requested_depth, scratch_pool);
+  b->prefetch = NULL;
+
+  return svn_error_trace(err);
+}
+
 /* Emit edits within directory DIR_BATON (with corresponding path
    E_PATH) with the changes from the directory S_REV/S_PATH to the
    directory B->t_rev/T_PATH.  S_PATH may be NULL if the entry does
@@ -1164,6 +1528,8 @@ delta_dirs(report_baton_t *b, svn_revnum_t s_rev, const char *s_path,
   apr_hash_index_t *hi;
   apr_pool_t *subpool = svn_pool_create(pool);
   apr_array_header_t *t_ordered_entries = NULL;
+  prefetch_batch_t batch;
+  apr_pool_t *entry_pool;
   int i;
 
   /* Compare the property lists.  If we're starting empty, pass a NULL
@@ -1304,6 +1670,31 @@ delta_dirs(report_baton_t *b, svn_revnum_t s_rev, const char *s_path,
       /* Loop over the dirents in the target. */
       SVN_ERR(svn_fs_dir_optimal_order(&t_ordered_entries, b->t_root,
                                        t_entries, subpool, iterpool));
+
+      /* For larger directories, collect the entries first and let worker
+         threads prepare them while we drive the editor.  Sub-directories
+         of such a directory get processed by the output function of that
+         run.  Don't nest runs there, as each would start another set of
+         THREAD_COUNT workers. */
+      if (b->thread_count > 1
+          && !b->prefetching
+          && t_ordered_entries->nelts >= PREFETCH_MIN_ENTRIES)
+        {
+          batch.b = b;
+          batch.entries = apr_array_make(subpool, t_ordered_entries->nelts,
+                                         sizeof(pending_entry_t *));
+          batch.s_rev = s_rev;
+          batch.dir_baton = dir_baton;
+          batch.wc_depth = DEPTH_BELOW_HERE(wc_depth);
+          batch.requested_depth = DEPTH_BELOW_HERE(requested_depth);
+          entry_pool = subpool;
+        }
+      else
+        {
+          batch.entries = NULL;
+          entry_pool = iterpool;
+        }
+
       for (i = 0; i < t_ordered_entries->nelts; ++i)
         {
           const svn_fs_dirent_t *t_entry
@@ -1336,12 +1727,35 @@ delta_dirs(report_baton_t *b, svn_revnum_t s_rev, const char *s_path,
               s_entry = s_entries ?
                   svn_hash_gets(s_entries, t_entry->name) : NULL;
               s_fullpath = s_entry ?
-                  svn_fspath__join(s_path, t_entry->name, iterpool) : NULL;
+                  svn_fspath__join(s_path, t_entry->name, entry_pool) : NULL;
             }
 
           /* Compose the report, editor, and target paths for this entry. */
-          e_fullpath = svn_relpath_join(e_path, t_entry->name, iterpool);
-          t_fullpath = svn_fspath__join(t_path, t_entry->name, iterpool);
+          e_fullpath = svn_relpath_join(e_path, t_entry->name, entry_pool);
+          t_fullpath = svn_fspath__join(t_path, t_entry->name, entry_pool);
+
+          if (batch.entries)
+            {
+              pending_entry_t *entry = apr_pcalloc(subpool, sizeof(*entry));
+              int distance = -1;
+
+              entry->s_entry = s_entry;
+              entry->t_entry = t_entry;
+              entry->s_path = s_fullpath;
+              entry->t_path = t_fullpath;
+              entry->e_path = e_fullpath;
+
+              /* Predict the source that update_entry() will use. */
+              if (s_entry && s_entry->kind == t_entry->kind)
+                distance = svn_fs_compare_ids(s_entry->id, t_entry->id);
+              if (s_entry && s_entry->kind == t_entry->kind
+                  && (distance != -1 || b->ignore_ancestry))
+                entry->prefetch_s_path = s_fullpath;
+              entry->check_changed = !b->ignore_ancestry && distance == 1;
+
+              APR_ARRAY_PUSH(batch.entries, pending_entry_t *) = entry;
+              continue;
+            }
 
           SVN_ERR(update_entry(b, s_rev, s_fullpath, s_entry, t_fullpath,
                                t_entry, dir_baton, e_fullpath, NULL,
@@ -1350,6 +1764,19 @@ delta_dirs(report_baton_t *b, svn_revnum_t s_rev, const char *s_path,
                                iterpool));
         }
 
+      if (batch.entries && batch.entries->nelts)
+        {
+          svn_error_t *err;
+
+          b->prefetching = TRUE;
+          err = svn_parallel__run(batch.entries->nelts, b->thread_count, 0,
+                                  prefetch_task, &batch,
+                                  prefetch_output, &batch,
+                                  NULL, NULL, iterpool);
+          b->prefetching = FALSE;
+          SVN_ERR(err);
+        }
+
       /* iterpool is destroyed by destroying its parent (subpool) below */
     }
 
@@ -1583,7 +2010,7 @@ svn_repos_abort_report(void *baton, apr_pool_t *pool)
 
 
 svn_error_t *
-svn_repos_begin_report3(void **report_baton,
+svn_repos_begin_report4(void **report_baton,
                         svn_revnum_t revnum,
                         svn_repos_t *repos,
                         const char *fs_base,
@@ -1598,6 +2025,7 @@ svn_repos_begin_report3(void **report_baton,
                         svn_repos_authz_func_t authz_read_func,
                         void *authz_read_baton,
                         apr_size_t zero_copy_limit,
+                        int thread_count,
                         apr_pool_t *pool)
 {
   report_baton_t *b;
@@ -1629,12 +2057,19 @@ svn_repos_begin_report3(void **report_baton,
   b->authz_read_func = authz_read_func;
   b->authz_read_baton = authz_read_baton;
   b->revision_infos = apr_hash_make(pool);
+  b->thread_count = thread_count;
+  b->fs_handles = NULL;
+  b->prefetch = NULL;
+  b->prefetching = FALSE;
   b->pool = pool;
   b->reader = svn_spillbuf__reader_create(1000 /* blocksize */,
                                           1000000 /* maxsize */,
                                           pool);
   b->repos_uuid = svn_string_create(uuid, pool);
 
+  if (thread_count > 1)
+    SVN_ERR(svn_repos__fs_handles_create(&b->fs_handles, repos->fs, pool));
+
   /* Hand reporter back to client. */
   *report_baton = b;
   return SVN_NO_ERROR;
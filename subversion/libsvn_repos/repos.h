@@ -387,6 +387,118 @@ svn_repos__prev_location(svn_revnum_t *appeared_rev,
                          const char *path,
                          apr_pool_t *pool);
 
+/* Implements svn_repos_notify_func_t.  Append a copy of NOTIFY to BATON,
+   which must be an array of svn_repos_notify_t *.  The copy will be
+   allocated in the array's pool.
+
+   This allows worker threads to collect their notifications such that
+   the caller's thread can later send them in the correct order. */
+void
+svn_repos__notify_record(void *baton,
+                         const svn_repos_notify_t *notify,
+                         apr_pool_t *scratch_pool);
+
+/* A thread-safe collection of FS instances for the same repository that
+   can be handed out to concurrently running tasks.  Each instance will
+   only be used by a single task at a time. */
+typedef struct svn_repos__fs_handles_t svn_repos__fs_handles_t;
+
+/* Set *HANDLES_P to a new, empty collection of instances of FS.  They
+   will be opened on demand and closed when RESULT_POOL gets cleaned up.
+   Allocate the result in RESULT_POOL. */
+svn_error_t *
+svn_repos__fs_handles_create(svn_repos__fs_handles_t **handles_p,
+                             svn_fs_t *fs,
+                             apr_pool_t *result_pool);
+
+/* Set *FS_P to an unused FS instance from HANDLES, opening a new one if
+   necessary.  Return it with svn_repos__fs_handles_release() when done.
+   May be called from any thread.  Use SCRATCH_POOL for temporary
+   allocations. */
+svn_error_t *
+svn_repos__fs_handles_acquire(svn_fs_t **fs_p,
+                              svn_repos__fs_handles_t *handles,
+                              apr_pool_t *scratch_pool);
+
+/* Return FS to HANDLES for later reuse.  ERR is the error returned by
+   the code that used FS and will be passed through. */
+svn_error_t *
+svn_repos__fs_handles_release(svn_repos__fs_handles_t *handles,
+                              svn_fs_t *fs,
+                              svn_error_t *err);
+
+
+/*** Log index ***/
+
+/* The optional log index lives within the FS directory such that code
+   that only has access to the svn_fs_t can find it. */
+#define SVN_REPOS__LOG_INDEX_DB "log-index.db"
+
+/* An opened, read-only log index. */
+typedef struct svn_repos__log_index_t svn_repos__log_index_t;
+
+/* Set *INDEX_P to the log index of FS, if it exists and covers all
+   revisions up to REVISION.  Otherwise, set it to NULL.  Allocate the
+   result in RESULT_POOL and use SCRATCH_POOL for temporary allocations. */
+svn_error_t *
+svn_repos__log_index_open(svn_repos__log_index_t **index_p,
+                          svn_fs_t *fs,
+                          svn_revnum_t revision,
+                          apr_pool_t *result_pool,
+                          apr_pool_t *scratch_pool);
+
+/* Look up the latest change to the node PATH@REVISION in INDEX, similar
+   to svn_fs_history_prev2().  If INCLUSIVE is set, REVISION itself will
+   be considered, otherwise only older revisions.  If CROSS_COPIES is set,
+   continue at the copy source when reaching the node's creation.
+
+   Set *PREV_PATH and *PREV_REV to the location of the change found or to
+   NULL and SVN_INVALID_REVNUM if there is none.  Return SVN_ERR_FS_NOT_FOUND
+   if INCLUSIVE is set and PATH does not exist in REVISION.  Allocate
+   *PREV_PATH in RESULT_POOL and use SCRATCH_POOL for temporary
+   allocations. */
+svn_error_t *
+svn_repos__log_index_history_prev(const char **prev_path,
+                                  svn_revnum_t *prev_rev,
+                                  svn_repos__log_index_t *index,
+                                  const char *path,
+                                  svn_revnum_t revision,
+                                  svn_boolean_t cross_copies,
+                                  svn_boolean_t inclusive,
+                                  apr_pool_t *result_pool,
+                                  apr_pool_t *scratch_pool);
+
+/* Set *DELETED to the first revision after START and up to END in which
+   PATH@START got deleted or replaced according to INDEX, or to
+   SVN_INVALID_REVNUM if there is none.  START must be smaller than END.
+   See svn_repos_deleted_rev().  Use SCRATCH_POOL for temporary
+   allocations. */
+svn_error_t *
+svn_repos__log_index_deleted_rev(svn_revnum_t *deleted,
+                                 svn_repos__log_index_t *index,
+                                 const char *path,
+                                 svn_revnum_t start,
+                                 svn_revnum_t end,
+                                 apr_pool_t *scratch_pool);
+
+/* Add all revisions up to REVISION in FS to its log index.  If the index
+   does not exist, create it if CREATE is set and do nothing otherwise.
+   Unless CATCH_UP is set, do nothing if the index lacks more than a few
+   revisions up to REVISION, as it will after e.g. an 'svnadmin load'.
+   Send a svn_repos_notify_log_index_rev notification to NOTIFY_FUNC with
+   NOTIFY_BATON for every revision added.  Use SCRATCH_POOL for temporary
+   allocations. */
+svn_error_t *
+svn_repos__log_index_update(svn_fs_t *fs,
+                            svn_revnum_t revision,
+                            svn_boolean_t create,
+                            svn_boolean_t catch_up,
+                            svn_repos_notify_func_t notify_func,
+                            void *notify_baton,
+                            svn_cancel_func_t cancel_func,
+                            void *cancel_baton,
+                            apr_pool_t *scratch_pool);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -346,6 +346,19 @@ svn_repos_deleted_rev(svn_fs_t *fs,
       return SVN_NO_ERROR;
     }
 
+  /* The log index, if present, tells us right away. */
+  if (start < end)
+    {
+      svn_repos__log_index_t *log_index;
+
+      SVN_ERR(svn_repos__log_index_open(&log_index, fs, end, pool, pool));
+      if (log_index)
+        return svn_error_trace(svn_repos__log_index_deleted_rev(deleted,
+                                                                log_index,
+                                                                path, start,
+                                                                end, pool));
+    }
+
   /* Ensure path was deleted at or before end revision. */
   SVN_ERR(svn_fs_revision_root(&root, fs, end, pool));
   SVN_ERR(svn_fs_check_path(&kind, root, path, pool));
@@ -40,6 +40,7 @@
 
 #include "cache.h"
 #include "fnv1a.h"
+#include "sysinfo.h"
 
 /*
  * This svn_cache__t implementation actually consists of two parts:
@@ -129,6 +130,15 @@
  * to scale well despite that bottleneck, we simply segment the cache into
  * a number of independent caches (segments). Items will be multiplexed based
  * on their hash key.
+ *
+ * Where supported, plain reads don't even take the segment lock.  Every
+ * segment has a write sequence number that writers increment when they
+ * start and when they finish modifying it, i.e. it is odd while a write is
+ * in progress.  Readers copy the item data without locking and only accept
+ * the result if the sequence number was even and did not change in the
+ * meantime.  Otherwise, they repeat the lookup under the segment lock.
+ * Hit counters may then be updated concurrently with writers, which only
+ * affects the accuracy of our eviction heuristics.
  */
 
 /* APR's read-write lock implementation on Windows is horribly inefficient.
@@ -146,6 +156,24 @@
 #  define USE_SIMPLE_MUTEX 0
 #endif
 
+/* Lock-free reads require a memory barrier that keeps loads from being
+ * reordered across it.  Only use them where we know how to get one and
+ * not when debugging the cache contents, which needs consistent tags.
+ */
+#if defined(__GNUC__) \
+    && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 7))
+#  define READ_BARRIER() __atomic_thread_fence(__ATOMIC_ACQUIRE)
+#elif defined(_MSC_VER)
+#  define READ_BARRIER() MemoryBarrier()
+#endif
+
+#if APR_HAS_THREADS && defined(READ_BARRIER) \
+    && !defined(SVN_DEBUG_CACHE_MEMBUFFER)
+#  define USE_OPTIMISTIC_READS 1
+#else
+#  define USE_OPTIMISTIC_READS 0
+#endif
+
 /* For more efficient copy operations, let's align all data items properly.
  * Since we can't portably align pointers, this is rather the item size
  * granularity which ensures *relative* alignment within the cache - still
@@ -817,6 +845,12 @@ struct svn_membuffer_t
    * This one is only used in debug assertions to verify that you used
    * the correct multi-threading settings. */
   svn_atomic_t write_lock_count;
+
+  /* Incremented by writers before and after modifying this segment, i.e.
+   * odd while the segment is being modified.  Lock-free readers use it to
+   * detect concurrent modifications.
+   */
+  volatile svn_atomic_t write_sequence;
 };
 
 /* Align integer VALUE to the next ITEM_ALIGNMENT boundary.
@@ -927,6 +961,32 @@ unlock_cache(svn_membuffer_t *cache, svn_error_t *err)
 #endif
 }
 
+/* Mark the start of a modification of CACHE for lock-free readers.
+ * The caller must hold the write lock.
+ */
+static APR_INLINE void
+begin_modification(svn_membuffer_t *cache)
+{
+#if USE_OPTIMISTIC_READS
+  /* Full memory barrier, i.e. no data gets modified before this. */
+  svn_atomic_inc(&cache->write_sequence);
+#endif
+}
+
+/* Mark the end of a modification of CACHE for lock-free readers.
+ * The caller must still hold the write lock.  Return ERR.
+ */
+static APR_INLINE svn_error_t *
+end_modification(svn_membuffer_t *cache, svn_error_t *err)
+{
+#if USE_OPTIMISTIC_READS
+  /* Full memory barrier, i.e. all modifications have completed. */
+  svn_atomic_inc(&cache->write_sequence);
+#endif
+
+  return err;
+}
+
 /* If supported, guard the execution of EXPR with a read lock to CACHE.
  * The macro has been modeled after SVN_MUTEX__WITH_LOCK.
  */
@@ -959,7 +1019,9 @@ do {                                                            \
       else                                                      \
         break;                                                  \
     }                                                           \
-  SVN_ERR(unlock_cache(cache, (expr)));                         \
+  begin_modification(cache);                                    \
+  SVN_ERR(unlock_cache(cache,                                   \
+                       end_modification(cache, (expr))));       \
 } while (0)
 
 /* Returns 0 if the entry group identified by GROUP_INDEX in CACHE has not
@@ -1550,6 +1612,111 @@ find_entry(svn_membuffer_t *cache,
   return entry;
 }
 
+#if USE_OPTIMISTIC_READS
+
+/* Return the write sequence number of CACHE to be passed to
+ * end_optimistic_read() later.  If it is odd, a writer is active and
+ * a lock-free read is pointless.
+ */
+static APR_INLINE apr_uint32_t
+begin_optimistic_read(svn_membuffer_t *cache)
+{
+  apr_uint32_t sequence = svn_atomic_read(&cache->write_sequence);
+  READ_BARRIER();
+
+  return sequence;
+}
+
+/* Return whether CACHE has not been modified since begin_optimistic_read()
+ * returned SEQUENCE, i.e. whether everything read since is consistent.
+ */
+static APR_INLINE svn_boolean_t
+end_optimistic_read(svn_membuffer_t *cache, apr_uint32_t sequence)
+{
+  READ_BARRIER();
+
+  return svn_atomic_read(&cache->write_sequence) == sequence;
+}
+
+/* Lock-free variant of find_entry() with FIND_EMPTY not being set.
+ *
+ * Since writers may modify CACHE at any time, we can't trust any of the
+ * directory contents.  Check every group index, entry count and offset
+ * before using it and never follow chains longer than what writers may
+ * create.  If the data is found to be inconsistent, set *VALID to FALSE
+ * and return NULL.  Otherwise, set *VALID to TRUE and return the entry
+ * or NULL.  Either way, the result must be confirmed by calling
+ * end_optimistic_read().
+ */
+static entry_t *
+find_entry_optimistic(svn_membuffer_t *cache,
+                      apr_uint32_t group_index,
+                      const full_key_t *to_find,
+                      svn_boolean_t *valid)
+{
+  apr_uint32_t group_limit = cache->group_count + cache->spare_group_count;
+  apr_uint64_t data_size = cache->l2.start_offset + cache->l2.size;
+  apr_size_t key_len = to_find->entry_key.key_len;
+  volatile entry_group_t *group = &cache->directory[group_index];
+  int chain_length;
+
+  *valid = TRUE;
+  if (! is_group_initialized(cache, group_index))
+    return NULL;
+
+  for (chain_length = 0;
+       chain_length < MAX_GROUP_CHAIN_LENGTH;
+       ++chain_length)
+    {
+      apr_uint32_t used = group->header.used;
+      apr_uint32_t next = group->header.next;
+      apr_uint32_t i;
+
+      if (used > GROUP_SIZE)
+        break;
+
+      for (i = 0; i < used; ++i)
+        {
+          entry_t *entry = (entry_t *)&group->entries[i];
+          if (entry_keys_match(&entry->key, &to_find->entry_key))
+            {
+              apr_uint64_t offset = group->entries[i].offset;
+
+              /* Fully defined by prefix_id & mangled key? */
+              if (!key_len)
+                return entry;
+
+              /* The full key is stored in front of the data. */
+              if (offset > data_size || key_len > data_size - offset)
+                {
+                  *valid = FALSE;
+                  return NULL;
+                }
+
+              return memcmp(to_find->full_key.data, cache->data + offset,
+                            key_len) == 0
+                   ? entry
+                   : NULL;
+            }
+        }
+
+      /* end of chain? */
+      if (next == NO_INDEX)
+        return NULL;
+
+      /* only full groups may chain */
+      if (next >= group_limit || used != GROUP_SIZE)
+        break;
+
+      group = &cache->directory[next];
+    }
+
+  *valid = FALSE;
+  return NULL;
+}
+
+#endif
+
 /* Move a surviving ENTRY from just behind the insertion window to
  * its beginning and move the insertion window up accordingly.
  */
@@ -1832,6 +1999,32 @@ ensure_data_insertable_l1(svn_membuffer_t *cache, apr_size_t size)
    * right answer. */
 }
 
+/* Return the default number of segments for a membuffer cache of
+ * TOTAL_SIZE bytes.  The result is a power of two.
+ */
+static apr_size_t
+default_segment_count(apr_size_t total_size)
+{
+  /* Determine a reasonable number of cache segments. Segmentation is
+   * only useful for multi-threaded / multi-core servers as it reduces
+   * lock contention on these systems.
+   *
+   * But on these systems, we can assume that ample memory has been
+   * allocated to this cache. Smaller caches should not be segmented
+   * as this severely limits the maximum size of cachable items.
+   *
+   * Segments should not be smaller than 32MB and max. cachable item
+   * size should grow as fast as segmentation.
+   */
+
+  apr_uint32_t segment_count_shift = 0;
+  while (((2 * DEFAULT_MIN_SEGMENT_SIZE) << (2 * segment_count_shift))
+         < total_size)
+    ++segment_count_shift;
+
+  return (apr_size_t)1 << segment_count_shift;
+}
+
 svn_error_t *
 svn_cache__membuffer_cache_create(svn_membuffer_t **cache,
                                   apr_size_t total_size,
@@ -1865,6 +2058,20 @@ svn_cache__membuffer_cache_create(svn_membuffer_t **cache,
     total_size = MAX_SEGMENT_SIZE * MAX_SEGMENT_COUNT;
 #endif
 
+  /* Scale the segment count with the number of hardware threads, if
+   * requested.  With twice as many segments as threads, concurrent
+   * writers are unlikely to contend for the same segment.  Large caches
+   * may still use more segments than that.
+   */
+  if (segment_count == SVN_CACHE__MEMBUFFER_SCALE_SEGMENTS)
+    {
+      apr_size_t thread_count = svn_sysinfo__processor_count();
+
+      segment_count = default_segment_count(total_size);
+      while (segment_count < 2 * thread_count)
+        segment_count *= 2;
+    }
+
   /* Limit the segment count
    */
   if (segment_count > MAX_SEGMENT_COUNT)
@@ -1881,26 +2088,7 @@ svn_cache__membuffer_cache_create(svn_membuffer_t **cache,
    * limitations set it to 0, derive one from the absolute cache size
    */
   if (segment_count < 1)
-    {
-      /* Determine a reasonable number of cache segments. Segmentation is
-       * only useful for multi-threaded / multi-core servers as it reduces
-       * lock contention on these systems.
-       *
-       * But on these systems, we can assume that ample memory has been
-       * allocated to this cache. Smaller caches should not be segmented
-       * as this severely limits the maximum size of cachable items.
-       *
-       * Segments should not be smaller than 32MB and max. cachable item
-       * size should grow as fast as segmentation.
-       */
-
-      apr_uint32_t segment_count_shift = 0;
-      while (((2 * DEFAULT_MIN_SEGMENT_SIZE) << (2 * segment_count_shift))
-             < total_size)
-        ++segment_count_shift;
-
-      segment_count = (apr_size_t)1 << segment_count_shift;
-    }
+    segment_count = default_segment_count(total_size);
 
   /* If we have an extremely large cache (>512 GB), the default segment
    * size may exceed the amount allocatable as one chunk. In that case,
@@ -2046,6 +2234,7 @@ svn_cache__membuffer_cache_create(svn_membuffer_t **cache,
 #endif
       /* No writers at the moment. */
       c[seg].write_lock_count = 0;
+      c[seg].write_sequence = 0;
     }
 
   /* done here
@@ -2078,6 +2267,7 @@ svn_cache__membuffer_clear(svn_membuffer_t *cache)
     {
       /* Unconditionally acquire the write lock. */
       SVN_ERR(force_write_lock_cache(&cache[seg]));
+      begin_modification(&cache[seg]);
 
       /* Mark all groups as "not initialized", which implies "empty". */
       cache[seg].first_spare_group = NO_INDEX;
@@ -2102,7 +2292,8 @@ svn_cache__membuffer_clear(svn_membuffer_t *cache)
       cache[seg].used_entries = 0;
 
       /* Segment may be used again. */
-      SVN_ERR(unlock_cache(&cache[seg], SVN_NO_ERROR));
+      SVN_ERR(unlock_cache(&cache[seg],
+                           end_modification(&cache[seg], SVN_NO_ERROR)));
     }
 
   /* done here */
@@ -2433,6 +2624,79 @@ membuffer_cache_get_internal(svn_membuffer_t *cache,
   return SVN_NO_ERROR;
 }
 
+/* Lock-free variant of membuffer_cache_get_internal().  Return FALSE if
+ * that is not supported for CACHE or if a writer interfered.  In that case,
+ * the caller must repeat the lookup under the segment lock.  Return TRUE
+ * if *BUFFER and *ITEM_SIZE have been set.
+ */
+static svn_boolean_t
+membuffer_cache_get_optimistic(svn_membuffer_t *cache,
+                               apr_uint32_t group_index,
+                               const full_key_t *to_find,
+                               char **buffer,
+                               apr_size_t *item_size,
+                               apr_pool_t *result_pool)
+{
+#if USE_OPTIMISTIC_READS
+  apr_uint64_t data_size = cache->l2.start_offset + cache->l2.size;
+  apr_size_t key_len = to_find->entry_key.key_len;
+  apr_uint32_t sequence;
+  apr_uint64_t offset;
+  apr_size_t size;
+  svn_boolean_t valid;
+  entry_t *entry;
+
+  /* Without a lock, there can't be concurrent access. */
+  if (cache->lock == NULL)
+    return FALSE;
+
+  sequence = begin_optimistic_read(cache);
+  if (sequence & 1)
+    return FALSE;
+
+  entry = find_entry_optimistic(cache, group_index, to_find, &valid);
+  if (!valid)
+    return FALSE;
+
+  if (entry == NULL)
+    {
+      if (!end_optimistic_read(cache, sequence))
+        return FALSE;
+
+      cache->total_reads++;
+      *buffer = NULL;
+      *item_size = 0;
+
+      return TRUE;
+    }
+
+  /* Never copy data from outside the data buffer. */
+  offset = ((volatile entry_t *)entry)->offset;
+  size = ((volatile entry_t *)entry)->size;
+  if (   size < key_len
+      || offset > data_size
+      || size > data_size - offset
+      || ALIGN_VALUE(size) > data_size - offset)
+    return FALSE;
+
+  *buffer = apr_palloc(result_pool, ALIGN_VALUE(size) - key_len);
+  memcpy(*buffer, cache->data + offset + key_len,
+         ALIGN_VALUE(size) - key_len);
+
+  /* Only now do we know that we copied the right data. */
+  if (!end_optimistic_read(cache, sequence))
+    return FALSE;
+
+  cache->total_reads++;
+  increment_hit_counters(cache, entry);
+  *item_size = size - key_len;
+
+  return TRUE;
+#else
+  return FALSE;
+#endif
+}
+
 /* Look for the *ITEM identified by KEY. If no item has been stored
  * for KEY, *ITEM will be NULL. Otherwise, the DESERIALIZER is called
  * to re-construct the proper object from the serialized data.
@@ -2453,14 +2717,16 @@ membuffer_cache_get(svn_membuffer_t *cache,
   /* find the entry group that will hold the key.
    */
   group_index = get_group_index(&cache, &key->entry_key);
-  WITH_READ_LOCK(cache,
-                 membuffer_cache_get_internal(cache,
-                                              group_index,
-                                              key,
-                                              &buffer,
-                                              &size,
-                                              DEBUG_CACHE_MEMBUFFER_TAG
-                                              result_pool));
+  if (!membuffer_cache_get_optimistic(cache, group_index, key,
+                                      &buffer, &size, result_pool))
+    WITH_READ_LOCK(cache,
+                   membuffer_cache_get_internal(cache,
+                                                group_index,
+                                                key,
+                                                &buffer,
+                                                &size,
+                                                DEBUG_CACHE_MEMBUFFER_TAG
+                                                result_pool));
 
   /* re-construct the original data object from its serialized form.
    */
@@ -2502,6 +2768,45 @@ membuffer_cache_has_key_internal(svn_membuffer_t *cache,
   return SVN_NO_ERROR;
 }
 
+/* Lock-free variant of membuffer_cache_has_key_internal().  Return FALSE
+ * if that is not supported for CACHE or if a writer interfered.  In that
+ * case, the caller must repeat the lookup under the segment lock.  Return
+ * TRUE if *FOUND has been set.
+ */
+static svn_boolean_t
+membuffer_cache_has_key_optimistic(svn_membuffer_t *cache,
+                                   apr_uint32_t group_index,
+                                   const full_key_t *to_find,
+                                   svn_boolean_t *found)
+{
+#if USE_OPTIMISTIC_READS
+  apr_uint32_t sequence;
+  svn_boolean_t valid;
+  entry_t *entry;
+
+  /* Without a lock, there can't be concurrent access. */
+  if (cache->lock == NULL)
+    return FALSE;
+
+  sequence = begin_optimistic_read(cache);
+  if (sequence & 1)
+    return FALSE;
+
+  entry = find_entry_optimistic(cache, group_index, to_find, &valid);
+  if (!valid || !end_optimistic_read(cache, sequence))
+    return FALSE;
+
+  /* See membuffer_cache_has_key_internal() for why we count this as hit. */
+  if (entry)
+    increment_hit_counters(cache, entry);
+
+  *found = entry != NULL;
+  return TRUE;
+#else
+  return FALSE;
+#endif
+}
+
 /* Look for an entry identified by KEY.  If no item has been stored
  * for KEY, *FOUND will be set to FALSE and TRUE otherwise.
  */
@@ -2517,11 +2822,12 @@ membuffer_cache_has_key(svn_membuffer_t *cache,
   apr_uint32_t group_index = get_group_index(&cache, &key->entry_key);
   cache->total_reads++;
 
-  WITH_READ_LOCK(cache,
-                 membuffer_cache_has_key_internal(cache,
-                                                  group_index,
-                                                  key,
-                                                  found));
+  if (!membuffer_cache_has_key_optimistic(cache, group_index, key, found))
+    WITH_READ_LOCK(cache,
+                   membuffer_cache_has_key_internal(cache,
+                                                    group_index,
+                                                    key,
+                                                    found));
 
   return SVN_NO_ERROR;
 }
@@ -0,0 +1,1082 @@
+/*
+ * cache-mmap.c: persistent, memory-mapped caching for Subversion
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#include <string.h>
+
+#include <apr_md5.h>
+#include <apr_mmap.h>
+#include <apr_file_io.h>
+
+#include "svn_pools.h"
+#include "svn_dirent_uri.h"
+#include "svn_hash.h"
+#include "svn_io.h"
+#include "svn_sorts.h"
+#include "svn_version.h"
+
+#include "svn_private_config.h"
+#include "private/svn_atomic.h"
+#include "private/svn_cache.h"
+#include "private/svn_mutex.h"
+#include "private/svn_subr_private.h"
+
+#include "cache.h"
+
+/* A note on the design:
+ *
+ * The cache lives in a single file that gets mapped into the address space
+ * of every process using it.  Thus, its contents is shared between all
+ * processes on the same host and survives process restarts.  The file
+ * consists of three parts:
+ *
+ * - A fixed-size header describing the layout.  Apart from WRITE_POS,
+ *   it never changes once the file has been initialized.
+ * - An index of BUCKET_COUNT buckets with WAYS entries each.  Every entry
+ *   maps the MD5 fingerprint of a full key (prefix + key) to the position
+ *   of the respective record in the data section.
+ * - The data section that gets used as a ring buffer.  New records are
+ *   always appended at WRITE_POS, eventually overwriting the oldest ones.
+ *
+ * WRITE_POS is a logical position that never wraps.  The physical offset
+ * of a record is its logical position modulo the size of the data section
+ * and records never straddle its end.  A record written at position P
+ * remains valid as long as WRITE_POS does not exceed P + DATA_SIZE.
+ *
+ * Writers serialize among each other through a process-local mutex and
+ * a lock on the cache file.  They advance WRITE_POS *before* copying the
+ * new record into the data section and update the index entry last.  If
+ * either lock is not immediately available, the write is simply dropped.
+ * Partial updates are never applied to the shared records; they remove the
+ * key from the index instead, waiting for the file lock if necessary.
+ *
+ * Readers never lock.  They copy the record and then check that WRITE_POS
+ * has not moved beyond the record in the meantime.  Every record repeats
+ * its full key and carries a checksum of its contents, so that torn index
+ * entries, concurrent overwrites as well as data lost in a crash will
+ * simply result in a cache miss.
+ *
+ * Cached values are serialized data structures whose layout depends on
+ * the Subversion version and platform.  Records are therefore tagged with
+ * a "build signature" and readers ignore records written by a different
+ * build.  Different builds may still share the same cache file.
+ */
+
+/* The memory barriers that we need for lock-free reads across processes.
+ * Like in cache-membuffer.c, we only support the mmap cache where we know
+ * how to get them.
+ */
+#if defined(__GNUC__) \
+    && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 7))
+#  define READ_BARRIER() __atomic_thread_fence(__ATOMIC_ACQUIRE)
+#  define WRITE_BARRIER() __atomic_thread_fence(__ATOMIC_RELEASE)
+#elif defined(_MSC_VER)
+#  define READ_BARRIER() MemoryBarrier()
+#  define WRITE_BARRIER() MemoryBarrier()
+#endif
+
+#if APR_HAS_MMAP && defined(READ_BARRIER)
+#  define USE_MMAP_CACHE 1
+#else
+#  define USE_MMAP_CACHE 0
+#endif
+
+/* Identifies cache files and their layout version. */
+#define FILE_MAGIC "SVN-MMC\0"
+#define FILE_FORMAT 1
+
+/* Size reserved for the file header. */
+#define HEADER_SIZE 4096
+
+/* Number of index entries per bucket. */
+#define WAYS 4
+
+/* The expected average size of a record.  We allocate one index entry per
+ * this many bytes of data section. */
+#define AVERAGE_RECORD_SIZE 2048
+
+/* Alignment of records within the data section and of the sections
+ * within the file. */
+#define RECORD_ALIGNMENT 16
+#define SECTION_ALIGNMENT 4096
+
+/* Files smaller than this will be extended. */
+#define MIN_FILE_SIZE (1024 * 1024)
+
+/* Records larger than the data section divided by this will not be cached
+ * because they would evict too much other data. */
+#define MAX_RECORD_FRACTION 16
+
+/* Marks the start of a valid record. */
+#define RECORD_MAGIC 0x434e5653
+
+/* Round SIZE up to the next multiple of ALIGNMENT, which must be a power
+ * of two. */
+#define ALIGN_VALUE(size, alignment) \
+  (((size) + (alignment) - 1) & ~((apr_uint64_t)(alignment) - 1))
+
+/* The file header.  All numbers are in native byte order. */
+typedef struct file_header_t
+{
+  /* FILE_MAGIC.  Will be written last during initialization. */
+  char magic[8];
+
+  /* FILE_FORMAT */
+  apr_uint32_t format;
+
+  /* Reserved, 0. */
+  apr_uint32_t reserved;
+
+  /* Total size of the file in bytes. */
+  apr_uint64_t file_size;
+
+  /* Number of buckets in the index. */
+  apr_uint64_t bucket_count;
+
+  /* Offset and size of the data section within the file. */
+  apr_uint64_t data_offset;
+  apr_uint64_t data_size;
+
+  /* Logical position at which the next record will be written.  This is
+   * the only field that changes after initialization. */
+  volatile apr_uint64_t write_pos;
+} file_header_t;
+
+/* An entry in the index. */
+typedef struct index_entry_t
+{
+  /* MD5 of the full key.  All 0 for unused entries. */
+  unsigned char fingerprint[APR_MD5_DIGESTSIZE];
+
+  /* Logical position of the record in the data section. */
+  apr_uint64_t position;
+
+  /* Size of the record including its header and padding. */
+  apr_uint32_t size;
+
+  /* Reserved, 0. */
+  apr_uint32_t reserved;
+} index_entry_t;
+
+/* Header of every record in the data section.  It is followed by the
+ * full key and the serialized value. */
+typedef struct record_header_t
+{
+  /* RECORD_MAGIC */
+  apr_uint32_t magic;
+
+  /* Build signature of the writer, see get_build_signature(). */
+  apr_uint32_t signature;
+
+  /* Length of the key and the value in bytes. */
+  apr_uint32_t key_len;
+  apr_uint32_t value_len;
+
+  /* FNV-1a checksum over the value. */
+  apr_uint32_t checksum;
+
+  /* Reserved, 0. */
+  apr_uint32_t reserved;
+} record_header_t;
+
+/* The process-wide handle to a cache file. */
+struct svn_cache__mmap_t
+{
+  /* Absolute path of the cache file. */
+  const char *path;
+
+  /* The open cache file.  Writers lock it to serialize with other
+   * processes. */
+  apr_file_t *file;
+
+  /* Start of the mapped file and pointers to its sections. */
+  file_header_t *header;
+  index_entry_t *index;
+  unsigned char *data;
+
+  /* Local copies of the layout information.  We never trust the shared
+   * header to stay unmodified. */
+  apr_uint64_t file_size;
+  apr_uint64_t bucket_count;
+  apr_uint64_t data_size;
+
+  /* Serializes writers within this process.  File locks will not do that
+   * on all platforms. */
+  svn_mutex__t *mutex;
+};
+
+/* The svn_cache__t implementation on top of a svn_cache__mmap_t. */
+typedef struct mmap_cache_t
+{
+  /* The shared cache file. */
+  svn_cache__mmap_t *mmap;
+
+  /* Optional first-level cache.  May be NULL. */
+  svn_cache__t *l1;
+
+  /* Prepended to all keys to differentiate our data from any other data
+   * in the same cache file. */
+  const char *prefix;
+  apr_size_t prefix_len;
+
+  /* The size of the key: either a fixed number of bytes or
+   * APR_HASH_KEY_STRING. */
+  apr_ssize_t klen;
+
+  /* Used to marshal values in and out of the cache. */
+  svn_cache__serialize_func_t serialize_func;
+  svn_cache__deserialize_func_t deserialize_func;
+} mmap_cache_t;
+
+#if USE_MMAP_CACHE
+
+/* Return a value that identifies the data layout of serialized values
+ * for this build. */
+static apr_uint32_t
+get_build_signature(void)
+{
+  const char signature[] = SVN_VERSION;
+  apr_uint32_t sizes = (apr_uint32_t)(  (sizeof(void *) << 8)
+                                      | (sizeof(long) << 4)
+                                      | sizeof(apr_size_t));
+  apr_uint32_t endianness = 1;
+
+  return svn__fnv1a_32(signature, sizeof(signature))
+       ^ (sizes << 16)
+       ^ (apr_uint32_t)*(const unsigned char *)&endianness;
+}
+
+/* Calculate the file layout for a cache file of FILE_SIZE bytes. */
+static void
+get_layout(apr_uint64_t *bucket_count,
+           apr_uint64_t *data_offset,
+           apr_uint64_t *data_size,
+           apr_uint64_t file_size)
+{
+  apr_uint64_t buckets = (file_size - HEADER_SIZE)
+                       / (AVERAGE_RECORD_SIZE * WAYS);
+  if (buckets == 0)
+    buckets = 1;
+
+  *bucket_count = buckets;
+  *data_offset = ALIGN_VALUE(HEADER_SIZE
+                             + buckets * WAYS * sizeof(index_entry_t),
+                             SECTION_ALIGNMENT);
+  *data_size = (file_size - *data_offset) & ~(apr_uint64_t)(RECORD_ALIGNMENT
+                                                            - 1);
+}
+
+/* Return TRUE if HEADER describes a valid cache file of FILE_SIZE bytes. */
+static svn_boolean_t
+header_is_valid(const file_header_t *header,
+                apr_uint64_t file_size)
+{
+  apr_uint64_t bucket_count, data_offset, data_size;
+
+  if (   memcmp(header->magic, FILE_MAGIC, sizeof(header->magic))
+      || header->format != FILE_FORMAT
+      || header->file_size != file_size)
+    return FALSE;
+
+  get_layout(&bucket_count, &data_offset, &data_size, file_size);
+  return header->bucket_count == bucket_count
+      && header->data_offset == data_offset
+      && header->data_size == data_size;
+}
+
+/* Map the cache file at ABSPATH into memory, creating or initializing it
+ * with a size of about SIZE bytes if necessary.  Return the new handle in
+ * *CACHE_P, allocated in RESULT_POOL which must live as long as the
+ * process. */
+static svn_error_t *
+open_mmap(svn_cache__mmap_t **cache_p,
+          const char *abspath,
+          apr_uint64_t size,
+          apr_pool_t *result_pool)
+{
+  svn_cache__mmap_t *cache = apr_pcalloc(result_pool, sizeof(*cache));
+  apr_finfo_t finfo;
+  apr_mmap_t *mmap;
+  apr_uint64_t data_offset;
+  apr_status_t status;
+  svn_error_t *err;
+
+  cache->path = apr_pstrdup(result_pool, abspath);
+  SVN_ERR(svn_io_file_open(&cache->file, abspath,
+                           APR_READ | APR_WRITE | APR_CREATE | APR_BINARY,
+                           APR_OS_DEFAULT, result_pool));
+
+  /* Initialization must not race with other processes. */
+  SVN_ERR(svn_io_lock_open_file(cache->file, TRUE, FALSE, result_pool));
+
+  err = svn_io_file_info_get(&finfo, APR_FINFO_SIZE, cache->file,
+                             result_pool);
+
+  /* Never shrink existing files.  Other processes may still have them
+   * mapped and would crash upon access to the cut-off parts. */
+  if (!err && finfo.size < MIN_FILE_SIZE)
+    {
+      cache->file_size = MAX(size, MIN_FILE_SIZE);
+      err = svn_io_file_trunc(cache->file, cache->file_size, result_pool);
+    }
+  else
+    {
+      cache->file_size = finfo.size;
+    }
+
+  if (!err && cache->file_size > APR_SIZE_MAX)
+    err = svn_error_createf(SVN_ERR_BAD_CONFIG_VALUE, NULL,
+                            _("Cache file '%s' is too large to be mapped"),
+                            svn_dirent_local_style(abspath, result_pool));
+
+  if (!err)
+    {
+      status = apr_mmap_create(&mmap, cache->file, 0,
+                               (apr_size_t)cache->file_size,
+                               APR_MMAP_READ | APR_MMAP_WRITE, result_pool);
+      if (status)
+        err = svn_error_wrap_apr(status, _("Can't map cache file '%s'"),
+                                 svn_dirent_local_style(abspath,
+                                                        result_pool));
+    }
+
+  if (!err)
+    {
+      void *base;
+
+      get_layout(&cache->bucket_count, &data_offset, &cache->data_size,
+                 cache->file_size);
+
+      apr_mmap_offset(&base, mmap, 0);
+      cache->header = base;
+      cache->index = (index_entry_t *)((char *)base + HEADER_SIZE);
+      cache->data = (unsigned char *)base + data_offset;
+
+      if (!header_is_valid(cache->header, cache->file_size))
+        {
+          file_header_t *header = cache->header;
+
+          /* Start from scratch. */
+          memset(header, 0, HEADER_SIZE);
+          memset(cache->index, 0,
+                 cache->bucket_count * WAYS * sizeof(index_entry_t));
+
+          header->format = FILE_FORMAT;
+          header->file_size = cache->file_size;
+          header->bucket_count = cache->bucket_count;
+          header->data_offset = data_offset;
+          header->data_size = cache->data_size;
+          header->write_pos = 0;
+
+          WRITE_BARRIER();
+          memcpy(header->magic, FILE_MAGIC, sizeof(header->magic));
+        }
+    }
+
+  err = svn_error_compose_create(err,
+                                 svn_io_unlock_open_file(cache->file,
+                                                         result_pool));
+  SVN_ERR(err);
+
+  SVN_ERR(svn_mutex__init(&cache->mutex, TRUE, result_pool));
+
+  *cache_p = cache;
+  return SVN_NO_ERROR;
+}
+
+/* Process-wide registry of open cache files such that all users of the
+ * same file share the same mapping and writer mutex. */
+static volatile svn_atomic_t registry_initialized = 0;
+static apr_pool_t *registry_pool = NULL;
+static svn_mutex__t *registry_mutex = NULL;
+static apr_hash_t *registry = NULL;
+
+/* Implements svn_atomic__err_init_func_t. */
+static svn_error_t *
+init_registry(void *baton,
+              apr_pool_t *unused_pool)
+{
+  registry_pool = svn_pool_create(NULL);
+  SVN_ERR(svn_mutex__init(&registry_mutex, TRUE, registry_pool));
+  registry = apr_hash_make(registry_pool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Look up or open the cache file ABSPATH in the registry and return it
+ * in *CACHE_P.  SIZE is only used when creating the file. */
+static svn_error_t *
+get_registered_mmap(svn_cache__mmap_t **cache_p,
+                    const char *abspath,
+                    apr_uint64_t size)
+{
+  *cache_p = svn_hash_gets(registry, abspath);
+  if (*cache_p == NULL)
+    {
+      SVN_ERR(open_mmap(cache_p, abspath, size, registry_pool));
+      svn_hash_sets(registry, (*cache_p)->path, *cache_p);
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Set FINGERPRINT to the MD5 of the KEY_LEN bytes in KEY and return the
+ * index of the respective bucket in CACHE. */
+static apr_uint64_t
+get_bucket(unsigned char fingerprint[APR_MD5_DIGESTSIZE],
+           const svn_cache__mmap_t *cache,
+           const void *key,
+           apr_size_t key_len)
+{
+  apr_uint64_t hash;
+
+  apr_md5(fingerprint, key, key_len);
+  memcpy(&hash, fingerprint, sizeof(hash));
+
+  return hash % cache->bucket_count;
+}
+
+/* Return TRUE if a record of SIZE bytes at logical POSITION is completely
+ * within the data section of CACHE and has not been overwritten up to the
+ * current WRITE_POS. */
+static svn_boolean_t
+record_is_intact(const svn_cache__mmap_t *cache,
+                 apr_uint64_t position,
+                 apr_uint64_t size,
+                 apr_uint64_t write_pos)
+{
+  return size >= sizeof(record_header_t)
+      && size <= cache->data_size
+      && position + size <= write_pos
+      && write_pos <= position + cache->data_size
+      && position % cache->data_size + size <= cache->data_size;
+}
+
+/* Look for the record with the given KEY of KEY_LEN bytes in CACHE.
+ * If found, set *FOUND and, unless VALUE is NULL, return a copy of the
+ * value in *VALUE and its length in *VALUE_LEN.  The copy will be
+ * allocated in RESULT_POOL and have an extra terminating NUL.
+ */
+static void
+read_record(void **value,
+            apr_size_t *value_len,
+            svn_boolean_t *found,
+            const svn_cache__mmap_t *cache,
+            const void *key,
+            apr_size_t key_len,
+            apr_pool_t *result_pool)
+{
+  unsigned char fingerprint[APR_MD5_DIGESTSIZE];
+  const index_entry_t *bucket
+    = cache->index + get_bucket(fingerprint, cache, key, key_len) * WAYS;
+  apr_uint32_t signature = get_build_signature();
+  int i;
+
+  *found = FALSE;
+  for (i = 0; i < WAYS; ++i)
+    {
+      /* Take a snapshot of the entry.  It may get modified by others. */
+      index_entry_t entry = bucket[i];
+      const unsigned char *source;
+      record_header_t header;
+      char *copy = NULL;
+
+      if (memcmp(entry.fingerprint, fingerprint, sizeof(fingerprint)))
+        continue;
+
+      READ_BARRIER();
+      if (!record_is_intact(cache, entry.position, entry.size,
+                            cache->header->write_pos))
+        continue;
+
+      /* Copy what we need. */
+      source = cache->data + entry.position % cache->data_size;
+      memcpy(&header, source, sizeof(header));
+      if (   header.magic != RECORD_MAGIC
+          || header.signature != signature
+          || header.key_len != key_len
+          || sizeof(header) + (apr_uint64_t)header.key_len
+             + header.value_len > entry.size
+          || memcmp(source + sizeof(header), key, key_len))
+        continue;
+
+      if (value)
+        {
+          copy = apr_palloc(result_pool, header.value_len + 1);
+          memcpy(copy, source + sizeof(header) + key_len, header.value_len);
+          copy[header.value_len] = '\0';
+        }
+
+      /* Has anyone started overwriting the record while we copied it? */
+      READ_BARRIER();
+      if (!record_is_intact(cache, entry.position, entry.size,
+                            cache->header->write_pos))
+        continue;
+
+      /* Detect partially written data, e.g. after a crash. */
+      if (copy && svn__fnv1a_32(copy, header.value_len) != header.checksum)
+        continue;
+
+      if (value)
+        {
+          *value = copy;
+          *value_len = header.value_len;
+        }
+
+      *found = TRUE;
+      return;
+    }
+}
+
+/* Store the VALUE_LEN bytes of VALUE under the KEY of KEY_LEN bytes in
+ * CACHE.  The caller must hold CACHE->MUTEX.  Drop the data silently if
+ * another process is currently writing to the cache file.  Use
+ * SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+write_record(svn_cache__mmap_t *cache,
+             const void *key,
+             apr_size_t key_len,
+             const void *value,
+             apr_size_t value_len,
+             apr_pool_t *scratch_pool)
+{
+  unsigned char fingerprint[APR_MD5_DIGESTSIZE];
+  index_entry_t *bucket
+    = cache->index + get_bucket(fingerprint, cache, key, key_len) * WAYS;
+  apr_uint64_t size = ALIGN_VALUE(sizeof(record_header_t) + key_len
+                                  + value_len, RECORD_ALIGNMENT);
+  apr_uint64_t position, offset, write_pos;
+  record_header_t header = { 0 };
+  index_entry_t *target = NULL;
+  unsigned char *dest;
+  int i;
+
+  /* Caching is optional.  Don't wait for other processes. */
+  if (apr_file_lock(cache->file, APR_FLOCK_EXCLUSIVE | APR_FLOCK_NONBLOCK))
+    return SVN_NO_ERROR;
+
+  /* Records must not straddle the end of the data section. */
+  position = cache->header->write_pos;
+  offset = position % cache->data_size;
+  if (offset + size > cache->data_size)
+    {
+      position += cache->data_size - offset;
+      offset = 0;
+    }
+
+  /* Invalidate everything we are about to overwrite *before* touching
+   * the data. */
+  write_pos = position + size;
+  cache->header->write_pos = write_pos;
+  WRITE_BARRIER();
+
+  header.magic = RECORD_MAGIC;
+  header.signature = get_build_signature();
+  header.key_len = (apr_uint32_t)key_len;
+  header.value_len = (apr_uint32_t)value_len;
+  header.checksum = svn__fnv1a_32(value, value_len);
+
+  dest = cache->data + offset;
+  memcpy(dest, &header, sizeof(header));
+  memcpy(dest + sizeof(header), key, key_len);
+  memcpy(dest + sizeof(header) + key_len, value, value_len);
+
+  /* Only publish the record once it is complete.
+   * Replace an older version of the same key, an unused or invalid entry
+   * or the oldest one, in that order. */
+  WRITE_BARRIER();
+  for (i = 0; i < WAYS; ++i)
+    if (!memcmp(bucket[i].fingerprint, fingerprint, sizeof(fingerprint)))
+      {
+        target = &bucket[i];
+        break;
+      }
+
+  for (i = 0; !target && i < WAYS; ++i)
+    if (!record_is_intact(cache, bucket[i].position, bucket[i].size,
+                          write_pos))
+      target = &bucket[i];
+
+  if (!target)
+    {
+      target = &bucket[0];
+      for (i = 1; i < WAYS; ++i)
+        if (bucket[i].position < target->position)
+          target = &bucket[i];
+    }
+
+  target->position = position;
+  target->size = (apr_uint32_t)size;
+  memcpy(target->fingerprint, fingerprint, sizeof(fingerprint));
+
+  apr_file_unlock(cache->file);
+  return SVN_NO_ERROR;
+}
+
+/* Remove the record with the given KEY of KEY_LEN bytes from the index
+ * of CACHE.  The caller must hold CACHE->MUTEX.  Unlike write_record(),
+ * this waits for other processes because the record would otherwise
+ * survive with outdated contents. */
+static svn_error_t *
+invalidate_record(svn_cache__mmap_t *cache,
+                  const void *key,
+                  apr_size_t key_len)
+{
+  unsigned char fingerprint[APR_MD5_DIGESTSIZE];
+  index_entry_t *bucket
+    = cache->index + get_bucket(fingerprint, cache, key, key_len) * WAYS;
+  apr_status_t status;
+  int i;
+
+  status = apr_file_lock(cache->file, APR_FLOCK_EXCLUSIVE);
+  if (status)
+    return svn_error_wrap_apr(status, _("Can't lock cache file '%s'"),
+                              cache->path);
+
+  /* Readers will see either an invalid size or a wrong fingerprint. */
+  for (i = 0; i < WAYS; ++i)
+    if (!memcmp(bucket[i].fingerprint, fingerprint, sizeof(fingerprint)))
+      {
+        bucket[i].size = 0;
+        WRITE_BARRIER();
+        memset(bucket[i].fingerprint, 0, sizeof(fingerprint));
+      }
+
+  apr_file_unlock(cache->file);
+  return SVN_NO_ERROR;
+}
+
+/* Return the maximum value size that may be written to CACHE. */
+static apr_size_t
+max_value_size(const svn_cache__mmap_t *cache)
+{
+  return (apr_size_t)MIN(cache->data_size / MAX_RECORD_FRACTION,
+                         APR_UINT32_MAX);
+}
+
+/* Return the concatenation of CACHE's prefix and KEY in *FULL_KEY and its
+ * length in *FULL_KEY_LEN.  Allocate it in RESULT_POOL. */
+static void
+combine_key(const char **full_key,
+            apr_size_t *full_key_len,
+            const mmap_cache_t *cache,
+            const void *key,
+            apr_pool_t *result_pool)
+{
+  apr_size_t key_len = cache->klen == APR_HASH_KEY_STRING
+                     ? strlen(key)
+                     : (apr_size_t)cache->klen;
+  char *buffer = apr_palloc(result_pool, cache->prefix_len + key_len);
+
+  memcpy(buffer, cache->prefix, cache->prefix_len);
+  memcpy(buffer + cache->prefix_len, key, key_len);
+
+  *full_key = buffer;
+  *full_key_len = cache->prefix_len + key_len;
+}
+
+#endif /* USE_MMAP_CACHE */
+
+/* Look up KEY in the second level of CACHE.  If found, set *FOUND and
+ * return a copy of the serialized value in *DATA and its length in
+ * *DATA_LEN, allocated in RESULT_POOL.  DATA may be NULL. */
+static svn_error_t *
+l2_get(void **data,
+       apr_size_t *data_len,
+       svn_boolean_t *found,
+       mmap_cache_t *cache,
+       const void *key,
+       apr_pool_t *result_pool)
+{
+  *found = FALSE;
+
+#if USE_MMAP_CACHE
+  if (key)
+    {
+      apr_pool_t *subpool = svn_pool_create(result_pool);
+      const char *full_key;
+      apr_size_t full_key_len;
+
+      combine_key(&full_key, &full_key_len, cache, key, subpool);
+      read_record(data, data_len, found, cache->mmap, full_key, full_key_len,
+                  result_pool);
+
+      svn_pool_destroy(subpool);
+    }
+#endif
+
+  return SVN_NO_ERROR;
+}
+
+/* Store the DATA_LEN bytes of serialized DATA under KEY in the second
+ * level of CACHE.  Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+l2_set(mmap_cache_t *cache,
+       const void *key,
+       const void *data,
+       apr_size_t data_len,
+       apr_pool_t *scratch_pool)
+{
+#if USE_MMAP_CACHE
+  const char *full_key;
+  apr_size_t full_key_len;
+
+  if (data_len > max_value_size(cache->mmap))
+    return SVN_NO_ERROR;
+
+  combine_key(&full_key, &full_key_len, cache, key, scratch_pool);
+  SVN_MUTEX__WITH_LOCK(cache->mmap->mutex,
+                       write_record(cache->mmap, full_key, full_key_len,
+                                    data, data_len, scratch_pool));
+#endif
+
+  return SVN_NO_ERROR;
+}
+
+/* Remove KEY from the second level of CACHE.  Use SCRATCH_POOL for
+ * temporary allocations. */
+static svn_error_t *
+l2_invalidate(mmap_cache_t *cache,
+              const void *key,
+              apr_pool_t *scratch_pool)
+{
+#if USE_MMAP_CACHE
+  const char *full_key;
+  apr_size_t full_key_len;
+
+  combine_key(&full_key, &full_key_len, cache, key, scratch_pool);
+  SVN_MUTEX__WITH_LOCK(cache->mmap->mutex,
+                       invalidate_record(cache->mmap, full_key,
+                                         full_key_len));
+#endif
+
+  return SVN_NO_ERROR;
+}
+
+/* Turn the DATA_LEN bytes of serialized DATA into *VALUE_P using CACHE's
+ * deserializer.  DATA may be modified in the process and must have been
+ * allocated in RESULT_POOL. */
+static svn_error_t *
+deserialize(void **value_p,
+            mmap_cache_t *cache,
+            void *data,
+            apr_size_t data_len,
+            apr_pool_t *result_pool)
+{
+  if (cache->deserialize_func)
+    return svn_error_trace(cache->deserialize_func(value_p, data, data_len,
+                                                   result_pool));
+  else
+    {
+      svn_stringbuf_t *value = svn_stringbuf_create_empty(result_pool);
+      value->data = data;
+      value->blocksize = data_len;
+      value->len = data_len - 1; /* account for trailing NUL */
+      *value_p = value;
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Copy the value that we just read from the second level of CACHE into
+ * its first level, if there is one. */
+static svn_error_t *
+promote(mmap_cache_t *cache,
+        const void *key,
+        void *value,
+        apr_pool_t *scratch_pool)
+{
+  if (cache->l1)
+    SVN_ERR(svn_cache__set(cache->l1, key, value, scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+mmap_cache_get(void **value_p,
+               svn_boolean_t *found,
+               void *cache_void,
+               const void *key,
+               apr_pool_t *result_pool)
+{
+  mmap_cache_t *cache = cache_void;
+  void *data;
+  apr_size_t data_len;
+
+  if (cache->l1)
+    {
+      SVN_ERR(svn_cache__get(value_p, found, cache->l1, key, result_pool));
+      if (*found)
+        return SVN_NO_ERROR;
+    }
+
+  SVN_ERR(l2_get(&data, &data_len, found, cache, key, result_pool));
+  if (*found)
+    {
+      apr_pool_t *subpool;
+
+      SVN_ERR(deserialize(value_p, cache, data, data_len, result_pool));
+
+      subpool = svn_pool_create(result_pool);
+      SVN_ERR(promote(cache, key, *value_p, subpool));
+      svn_pool_destroy(subpool);
+    }
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+mmap_cache_has_key(svn_boolean_t *found,
+                   void *cache_void,
+                   const void *key,
+                   apr_pool_t *scratch_pool)
+{
+  mmap_cache_t *cache = cache_void;
+
+  if (cache->l1)
+    {
+      SVN_ERR(svn_cache__has_key(found, cache->l1, key, scratch_pool));
+      if (*found)
+        return SVN_NO_ERROR;
+    }
+
+  return svn_error_trace(l2_get(NULL, NULL, found, cache, key,
+                                scratch_pool));
+}
+
+static svn_error_t *
+mmap_cache_set(void *cache_void,
+               const void *key,
+               void *value,
+               apr_pool_t *scratch_pool)
+{
+  mmap_cache_t *cache = cache_void;
+  apr_pool_t *subpool;
+  void *data;
+  apr_size_t data_len;
+  svn_error_t *err;
+
+  if (key == NULL)
+    return SVN_NO_ERROR;
+
+  if (cache->l1)
+    SVN_ERR(svn_cache__set(cache->l1, key, value, scratch_pool));
+
+  subpool = svn_pool_create(scratch_pool);
+  if (cache->serialize_func)
+    {
+      SVN_ERR(cache->serialize_func(&data, &data_len, value, subpool));
+    }
+  else
+    {
+      svn_stringbuf_t *value_str = value;
+      data = value_str->data;
+      data_len = value_str->len + 1; /* copy trailing NUL */
+    }
+
+  err = l2_set(cache, key, data, data_len, subpool);
+
+  svn_pool_destroy(subpool);
+  return svn_error_trace(err);
+}
+
+static svn_error_t *
+mmap_cache_get_partial(void **value_p,
+                       svn_boolean_t *found,
+                       void *cache_void,
+                       const void *key,
+                       svn_cache__partial_getter_func_t func,
+                       void *baton,
+                       apr_pool_t *result_pool)
+{
+  mmap_cache_t *cache = cache_void;
+  apr_pool_t *subpool;
+  void *data;
+  apr_size_t data_len;
+  void *value;
+
+  if (cache->l1)
+    {
+      SVN_ERR(svn_cache__get_partial(value_p, found, cache->l1, key, func,
+                                     baton, result_pool));
+      if (*found)
+        return SVN_NO_ERROR;
+    }
+
+  subpool = svn_pool_create(result_pool);
+  SVN_ERR(l2_get(&data, &data_len, found, cache, key, subpool));
+  if (*found)
+    {
+      SVN_ERR(func(value_p, data, data_len, baton, result_pool));
+
+      /* FUNC copied what it needed.  Restore the full object such that
+       * the next access will be served by the first level. */
+      if (cache->l1)
+        {
+          SVN_ERR(deserialize(&value, cache, data, data_len, subpool));
+          SVN_ERR(promote(cache, key, value, subpool));
+        }
+    }
+
+  svn_pool_destroy(subpool);
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+mmap_cache_set_partial(void *cache_void,
+                       const void *key,
+                       svn_cache__partial_setter_func_t func,
+                       void *baton,
+                       apr_pool_t *scratch_pool)
+{
+  mmap_cache_t *cache = cache_void;
+  apr_pool_t *subpool;
+  svn_error_t *err;
+
+  if (cache->l1)
+    SVN_ERR(svn_cache__set_partial(cache->l1, key, func, baton,
+                                   scratch_pool));
+
+  /* Don't patch the shared record.  Writes to it may have been dropped,
+   * so it is not necessarily the version that FUNC expects and patching
+   * it would make it look current to every process.  Drop it instead. */
+  subpool = svn_pool_create(scratch_pool);
+  err = l2_invalidate(cache, key, subpool);
+
+  svn_pool_destroy(subpool);
+  return svn_error_trace(err);
+}
+
+static svn_error_t *
+mmap_cache_iter(svn_boolean_t *completed,
+                void *cache_void,
+                svn_iter_apr_hash_cb_t user_cb,
+                void *user_baton,
+                apr_pool_t *scratch_pool)
+{
+  return svn_error_create(SVN_ERR_UNSUPPORTED_FEATURE, NULL,
+                          _("Can't iterate a persistent cache"));
+}
+
+static svn_boolean_t
+mmap_cache_is_cachable(void *cache_void,
+                       apr_size_t size)
+{
+  mmap_cache_t *cache = cache_void;
+
+  if (cache->l1 && svn_cache__is_cachable(cache->l1, size))
+    return TRUE;
+
+#if USE_MMAP_CACHE
+  return size <= max_value_size(cache->mmap);
+#else
+  return FALSE;
+#endif
+}
+
+static svn_error_t *
+mmap_cache_get_info(void *cache_void,
+                    svn_cache__info_t *info,
+                    svn_boolean_t reset,
+                    apr_pool_t *result_pool)
+{
+  mmap_cache_t *cache = cache_void;
+
+  info->id = apr_pstrdup(result_pool, cache->prefix);
+
+#if USE_MMAP_CACHE
+  info->data_size = cache->mmap->data_size;
+  info->used_size = MIN(cache->mmap->header->write_pos,
+                        cache->mmap->data_size);
+  info->total_size = cache->mmap->file_size;
+  info->total_entries = cache->mmap->bucket_count * WAYS;
+#endif
+
+  return SVN_NO_ERROR;
+}
+
+static svn_cache__vtable_t mmap_cache_vtable = {
+  mmap_cache_get,
+  mmap_cache_has_key,
+  mmap_cache_set,
+  mmap_cache_iter,
+  mmap_cache_is_cachable,
+  mmap_cache_get_partial,
+  mmap_cache_set_partial,
+  mmap_cache_get_info
+};
+
+svn_error_t *
+svn_cache__mmap_open(svn_cache__mmap_t **mmap_p,
+                     const char *path,
+                     apr_uint64_t size,
+                     apr_pool_t *scratch_pool)
+{
+#if USE_MMAP_CACHE
+  const char *abspath;
+
+  SVN_ERR(svn_dirent_get_absolute(&abspath, path, scratch_pool));
+  SVN_ERR(svn_atomic__init_once(&registry_initialized, init_registry,
+                                NULL, scratch_pool));
+  SVN_MUTEX__WITH_LOCK(registry_mutex,
+                       get_registered_mmap(mmap_p, abspath, size));
+
+  return SVN_NO_ERROR;
+#else
+  return svn_error_create(SVN_ERR_UNSUPPORTED_FEATURE, NULL,
+                          _("Persistent caches are not supported "
+                            "on this platform"));
+#endif
+}
+
+svn_error_t *
+svn_cache__create_mmap_cache(svn_cache__t **cache_p,
+                             svn_cache__mmap_t *mmap,
+                             svn_cache__t *l1,
+                             svn_cache__serialize_func_t serialize_func,
+                             svn_cache__deserialize_func_t deserialize_func,
+                             apr_ssize_t klen,
+                             const char *prefix,
+                             apr_pool_t *result_pool)
+{
+  svn_cache__t *wrapper = apr_pcalloc(result_pool, sizeof(*wrapper));
+  mmap_cache_t *cache = apr_pcalloc(result_pool, sizeof(*cache));
+
+  SVN_ERR_ASSERT(mmap != NULL);
+
+  cache->mmap = mmap;
+  cache->l1 = l1;
+  cache->serialize_func = serialize_func;
+  cache->deserialize_func = deserialize_func;
+  cache->klen = klen;
+  cache->prefix = apr_pstrdup(result_pool, prefix);
+  cache->prefix_len = strlen(prefix);
+
+  wrapper->vtable = &mmap_cache_vtable;
+  wrapper->cache_internal = cache;
+  wrapper->error_handler = 0;
+  wrapper->error_baton = 0;
+  wrapper->pretend_empty = !!getenv("SVN_X_DOES_NOT_MARK_THE_SPOT");
+
+  *cache_p = wrapper;
+  return SVN_NO_ERROR;
+}
@@ -64,6 +64,12 @@ static svn_cache_config_t cache_settings =
 #endif
 };
 
+/* Whether the global membuffer cache shall use one segment per hardware
+ * thread or more.  This is not part of svn_cache_config_t because that
+ * struct must not be extended.
+ */
+static svn_boolean_t scale_segments = FALSE;
+
 /* Get the current FSFS cache configuration. */
 const svn_cache_config_t *
 svn_cache_config_get(void)
@@ -124,7 +130,7 @@ initialize_cache(void *baton, apr_pool_t *unused_pool)
           &cache,
           (apr_size_t)cache_size,
           (apr_size_t)(cache_size / 5),
-          0,
+          scale_segments ? SVN_CACHE__MEMBUFFER_SCALE_SEGMENTS : 0,
           ! svn_cache_config_get()->single_threaded,
           FALSE,
           pool);
@@ -179,3 +185,8 @@ svn_cache_config_set(const svn_cache_config_t *settings)
   cache_settings = *settings;
 }
 
+void
+svn_cache__config_set_scale_segments(svn_boolean_t scale)
+{
+  scale_segments = scale;
+}
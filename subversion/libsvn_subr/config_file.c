@@ -1154,6 +1154,14 @@ svn_config_ensure(const char *config_dir, apr_pool_t *pool)
         "###                              HTTP operation."                   NL
         "###   http-chunked-requests      Whether to use chunked transfer"   NL
         "###                              encoding for HTTP requests body."  NL
+        "###   http-adaptive-connections  Whether to open more connections"  NL
+        "###                              than http-max-connections while"   NL
+        "###                              that increases the throughput."    NL
+        "###   http-decode-threads        Number of threads to use for"      NL
+        "###                              parsing file contents received"    NL
+        "###                              during updates.  The main thread"  NL
+        "###                              still applies them to the working" NL
+        "###                              copy and verifies checksums."      NL
         "###   ssl-authority-files        List of files, each of a trusted CA"
                                                                              NL
         "###   ssl-trust-default-ca       Trust the system 'default' CAs"    NL
@@ -1553,6 +1561,36 @@ svn_config_ensure(const char *config_dir, apr_pool_t *pool)
         "### returning an error.  The default is 10000, i.e. 10 seconds."    NL
         "### Longer values may be useful when exclusive locking is enabled." NL
         "# busy-timeout = 10000"                                             NL
+        "### Set the number of threads used to translate and install files"  NL
+        "### from the pristine store into the working copy, e.g. during"     NL
+        "### checkout and update.  Values larger than 1 let multiple files"  NL
+        "### be written concurrently, which may speed up operations on slow" NL
+        "### or networked file systems.  The default is 1."                  NL
+        "# install-threads = 1"                                              NL
+        "### Set the number of threads used to read directories and to"      NL
+        "### check files for modifications ahead of 'svn status'.  The"      NL
+        "### results are still reported in the usual order.  Values larger"  NL
+        "### than 1 may speed up status on large working copies with a cold" NL
+        "### disk cache.  The default is 1."                                 NL
+        "# status-threads = 1"                                               NL
+        "### Set the number of threads used to translate, checksum and"      NL
+        "### compute the deltas of modified files ahead of sending them"     NL
+        "### during 'svn commit'.  The files are still sent in the usual"    NL
+        "### order.  Values larger than 1 may speed up commits of many"      NL
+        "### modified files.  The default is 1."                             NL
+        "# commit-threads = 1"                                               NL
+        "### Set the path of a directory that all working copies on this"    NL
+        "### host share as a store of pristine texts.  New pristine texts"   NL
+        "### are then hard linked (or, where the file system supports it,"   NL
+        "### cloned) from this store instead of being copied, and checkouts" NL
+        "### over http:// and https:// do not download texts that are"       NL
+        "### already present in it.  'svn cleanup --vacuum-pristines'"       NL
+        "### removes texts that no working copy links to anymore.  The"      NL
+        "### store should be on the same file system as the working copies." NL
+        "### Texts taken from the store are verified first, and only texts"  NL
+        "### owned by the current user are hard linked."                     NL
+        "### By default, no store is shared."                                NL
+        "# shared-pristine-store = /var/cache/svn-pristines"                 NL
         ;
 
       err = svn_io_file_open(&f, path,
@@ -51,6 +51,11 @@
 #include <fcntl.h>
 #endif
 
+#if defined(__linux__)
+#include <sys/ioctl.h>
+#include <linux/fs.h>
+#endif
+
 #include "svn_hash.h"
 #include "svn_types.h"
 #include "svn_dirent_uri.h"
@@ -780,6 +785,100 @@ svn_io_copy_link(const char *src,
 #endif
 }
 
+svn_error_t *
+svn_io__link_file(const char *src_abspath,
+                  const char *dst_abspath,
+                  apr_pool_t *scratch_pool)
+{
+#ifdef WIN32
+  const WCHAR *src_w;
+  const WCHAR *dst_w;
+
+  SVN_ERR(svn_io__utf8_to_unicode_longpath(&src_w, src_abspath,
+                                           scratch_pool));
+  SVN_ERR(svn_io__utf8_to_unicode_longpath(&dst_w, dst_abspath,
+                                           scratch_pool));
+
+  if (!CreateHardLinkW(dst_w, src_w, NULL))
+    return svn_error_wrap_apr(apr_get_os_error(),
+                              _("Can't create hard link '%s' to '%s'"),
+                              svn_dirent_local_style(dst_abspath,
+                                                     scratch_pool),
+                              svn_dirent_local_style(src_abspath,
+                                                     scratch_pool));
+#else
+  const char *src_apr;
+  const char *dst_apr;
+
+  SVN_ERR(cstring_from_utf8(&src_apr, src_abspath, scratch_pool));
+  SVN_ERR(cstring_from_utf8(&dst_apr, dst_abspath, scratch_pool));
+
+  if (link(src_apr, dst_apr) != 0)
+    return svn_error_wrap_apr(apr_get_os_error(),
+                              _("Can't create hard link '%s' to '%s'"),
+                              svn_dirent_local_style(dst_abspath,
+                                                     scratch_pool),
+                              svn_dirent_local_style(src_abspath,
+                                                     scratch_pool));
+#endif
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_io__clone_file(const char *src_abspath,
+                   const char *dst_abspath,
+                   apr_pool_t *scratch_pool)
+{
+#if defined(__linux__) && defined(FICLONE)
+  apr_file_t *src_file;
+  apr_file_t *dst_file;
+  apr_os_file_t src_fd;
+  apr_os_file_t dst_fd;
+  int rv;
+
+  SVN_ERR(svn_io_file_open(&src_file, src_abspath, APR_READ,
+                           APR_OS_DEFAULT, scratch_pool));
+  SVN_ERR(svn_io_file_open(&dst_file, dst_abspath,
+                           APR_WRITE | APR_CREATE | APR_EXCL,
+                           APR_OS_DEFAULT, scratch_pool));
+
+  apr_os_file_get(&src_fd, src_file);
+  apr_os_file_get(&dst_fd, dst_file);
+
+  do
+    {
+      rv = ioctl(dst_fd, FICLONE, src_fd);
+    }
+  while (rv == -1 && APR_STATUS_IS_EINTR(apr_get_os_error()));
+
+  if (rv == -1)
+    {
+      svn_error_t *err;
+
+      err = svn_error_wrap_apr(apr_get_os_error(),
+                               _("Can't clone '%s' to '%s'"),
+                               svn_dirent_local_style(src_abspath,
+                                                      scratch_pool),
+                               svn_dirent_local_style(dst_abspath,
+                                                      scratch_pool));
+      err = svn_error_compose_create(
+              err, svn_io_file_close(dst_file, scratch_pool));
+      err = svn_error_compose_create(
+              err, svn_io_remove_file2(dst_abspath, TRUE, scratch_pool));
+      return svn_error_compose_create(
+              err, svn_io_file_close(src_file, scratch_pool));
+    }
+
+  SVN_ERR(svn_io_file_close(dst_file, scratch_pool));
+  return svn_error_trace(svn_io_file_close(src_file, scratch_pool));
+#else
+  return svn_error_create(SVN_ERR_UNSUPPORTED_FEATURE, NULL,
+                          _("Cloning files is not supported on this "
+                            "platform"));
+#endif
+}
+
 /* Temporary directory name cache for svn_io_temp_dir() */
 static volatile svn_atomic_t temp_dir_init_state = 0;
 static const char *temp_dir;
@@ -2259,6 +2358,33 @@ svn_io__is_finfo_executable(svn_boolean_t *executable,
   return SVN_NO_ERROR;
 }
 
+svn_error_t *
+svn_io__is_finfo_owned(svn_boolean_t *owned,
+                       apr_finfo_t *file_info,
+                       apr_pool_t *pool)
+{
+#if defined(APR_HAS_USER)
+  apr_status_t apr_err;
+  apr_uid_t uid;
+  apr_gid_t gid;
+
+  *owned = FALSE;
+  if (!(file_info->valid & APR_FINFO_USER))
+    return SVN_NO_ERROR;
+
+  apr_err = apr_uid_current(&uid, &gid, pool);
+
+  if (apr_err)
+    return svn_error_wrap_apr(apr_err, _("Error getting UID of process"));
+
+  *owned = (apr_uid_compare(uid, file_info->user) == APR_SUCCESS);
+#else  /* !APR_HAS_USER */
+  *owned = FALSE;
+#endif
+
+  return SVN_NO_ERROR;
+}
+
 svn_error_t *
 svn_io_is_file_executable(svn_boolean_t *executable,
                           const char *path,
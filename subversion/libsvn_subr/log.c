@@ -427,3 +427,54 @@ svn_log__list(const char *path, svn_revnum_t revision,
   return apr_psprintf(pool, "list %s r%ld%s%s", log_path, revision,
                       log_depth(depth, pool), pattern_text->data);
 }
+
+const char *
+svn_log__get_blame(const char *path, svn_revnum_t start, svn_revnum_t end,
+                   const apr_array_header_t *diff_options,
+                   apr_pool_t *pool)
+{
+  svn_stringbuf_t *options_text = svn_stringbuf_create_empty(pool);
+  int i;
+
+  if (diff_options)
+    for (i = 0; i < diff_options->nelts; ++i)
+      {
+        const char *option = APR_ARRAY_IDX(diff_options, i, const char *);
+        svn_stringbuf_appendbyte(options_text, ' ');
+        svn_stringbuf_appendcstr(options_text, option);
+      }
+
+  return apr_psprintf(pool, "get-blame %s r%ld:%ld%s",
+                      svn_path_uri_encode(path, pool), start, end,
+                      options_text->data);
+}
+
+const char *
+svn_log__get_files(const apr_array_header_t *paths,
+                   const apr_array_header_t *revisions,
+                   svn_boolean_t want_props,
+                   apr_pool_t *pool)
+{
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  svn_stringbuf_t *space_separated_paths = svn_stringbuf_create_empty(pool);
+  int i;
+
+  for (i = 0; i < paths->nelts; i++)
+    {
+      const char *path = APR_ARRAY_IDX(paths, i, const char *);
+      svn_revnum_t revision = APR_ARRAY_IDX(revisions, i, svn_revnum_t);
+
+      svn_pool_clear(iterpool);
+      if (space_separated_paths->len)
+        svn_stringbuf_appendcstr(space_separated_paths, " ");
+      svn_stringbuf_appendcstr(space_separated_paths,
+                               apr_psprintf(iterpool, "%s@%ld",
+                                            svn_path_uri_encode(path,
+                                                                iterpool),
+                                            revision));
+    }
+  svn_pool_destroy(iterpool);
+
+  return apr_psprintf(pool, "get-files (%s)%s", space_separated_paths->data,
+                      want_props ? " props" : "");
+}
@@ -0,0 +1,469 @@
+/*
+ * parallel.c: concurrent execution of independent tasks
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#include <apr_thread_proc.h>
+
+#include "svn_pools.h"
+#include "svn_private_config.h"
+
+#include "private/svn_atomic.h"
+#include "private/svn_mutex.h"
+#include "private/svn_parallel.h"
+#include "private/svn_thread_cond.h"
+
+/* Number of pending tasks per worker thread that we allow for if the
+ * caller did not specify a limit. */
+#define DEFAULT_PENDING_PER_THREAD 4
+
+/* Interval in microseconds in which the calling thread checks for
+ * cancellation while it is waiting for the next task to complete. */
+#define CANCEL_CHECK_INTERVAL (100 * 1000)
+
+/* Execute all tasks in the calling thread, one after another.
+ * Parameters are the same as for svn_parallel__run.
+ */
+static svn_error_t *
+run_sequentially(int task_count,
+                 svn_parallel__task_func_t task_func,
+                 void *task_baton,
+                 svn_parallel__output_func_t output_func,
+                 void *output_baton,
+                 svn_cancel_func_t cancel_func,
+                 void *cancel_baton,
+                 apr_pool_t *scratch_pool)
+{
+  apr_pool_t *result_pool = svn_pool_create(scratch_pool);
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  int i;
+
+  for (i = 0; i < task_count; ++i)
+    {
+      void *result = NULL;
+      svn_error_t *err;
+
+      svn_pool_clear(result_pool);
+      svn_pool_clear(iterpool);
+
+      if (cancel_func)
+        SVN_ERR(cancel_func(cancel_baton));
+
+      err = task_func(&result, task_baton, i, cancel_func, cancel_baton,
+                      result_pool, iterpool);
+      SVN_ERR(output_func(output_baton, i, result, err, iterpool));
+    }
+
+  svn_pool_destroy(iterpool);
+  svn_pool_destroy(result_pool);
+
+  return SVN_NO_ERROR;
+}
+
+#if APR_HAS_THREADS
+
+/* Outcome of a single task.  The slots form a ring buffer in which the
+ * task with index IDX uses slot IDX % MAX_PENDING.
+ */
+typedef struct slot_t
+{
+  /* Thread-safe pool private to this task.  Contains RESULT. */
+  apr_pool_t *pool;
+
+  /* Result returned by the task function. */
+  void *result;
+
+  /* Error returned by the task function. */
+  svn_error_t *err;
+
+  /* Set once the task function returned.  Protected by run_t.MUTEX. */
+  svn_boolean_t done;
+} slot_t;
+
+/* Shared state of a single svn_parallel__run invocation. */
+typedef struct run_t
+{
+  /* Task function and baton as passed to svn_parallel__run. */
+  svn_parallel__task_func_t task_func;
+  void *task_baton;
+
+  /* Number of tasks in total. */
+  int task_count;
+
+  /* Maximum number of tasks that may be started or completed without
+   * their output having been processed. */
+  int max_pending;
+
+  /* Ring buffer of MAX_PENDING task outcomes. */
+  slot_t *slots;
+
+  /* Index of the next task to start.  Protected by MUTEX. */
+  int next_task;
+
+  /* Index of the next task whose output shall be processed.  Only
+   * modified by the calling thread and protected by MUTEX. */
+  int next_output;
+
+  /* Set when no further tasks shall be started. */
+  volatile svn_atomic_t aborted;
+
+  /* Serializes access to the members above. */
+  svn_mutex__t *mutex;
+
+  /* Gets signaled whenever a task completes, an output slot becomes
+   * available or the run has been aborted. */
+  svn_thread_cond__t *cond;
+} run_t;
+
+/* Context of a single worker thread. */
+typedef struct worker_t
+{
+  /* The run that we are working on. */
+  run_t *run;
+
+  /* Synchronization errors that terminated the worker. */
+  svn_error_t *err;
+} worker_t;
+
+/* Implements svn_cancel_func_t for the task functions.  BATON is a
+ * run_t and we report a cancellation once the run has been aborted.
+ */
+static svn_error_t *
+worker_cancel_func(void *baton)
+{
+  run_t *run = baton;
+  if (svn_atomic_read(&run->aborted))
+    return svn_error_create(SVN_ERR_CANCELLED, NULL, NULL);
+
+  return SVN_NO_ERROR;
+}
+
+/* Set *IDX to the index of the next task in RUN to execute.  Wait until
+ * there is room in the ring buffer for its result.  Set *IDX to -1, if
+ * there is no more work to do.
+ */
+static svn_error_t *
+claim_task(int *idx,
+           run_t *run)
+{
+  svn_error_t *err = SVN_NO_ERROR;
+
+  SVN_ERR(svn_mutex__lock(run->mutex));
+
+  /* This loop implicitly handles spurious wake-ups. */
+  while (   !err
+         && !svn_atomic_read(&run->aborted)
+         && run->next_task < run->task_count
+         && run->next_task >= run->next_output + run->max_pending)
+    err = svn_thread_cond__wait(run->cond, run->mutex);
+
+  if (   err
+      || svn_atomic_read(&run->aborted)
+      || run->next_task >= run->task_count)
+    *idx = -1;
+  else
+    *idx = run->next_task++;
+
+  return svn_error_trace(svn_mutex__unlock(run->mutex, err));
+}
+
+/* Mark SLOT in RUN as completed and notify the calling thread. */
+static svn_error_t *
+complete_task(run_t *run,
+              slot_t *slot)
+{
+  SVN_ERR(svn_mutex__lock(run->mutex));
+  slot->done = TRUE;
+
+  return svn_error_trace(svn_mutex__unlock(run->mutex,
+                              svn_thread_cond__broadcast(run->cond)));
+}
+
+/* Stop RUN from starting any further tasks and wake up all threads. */
+static svn_error_t *
+abort_run(run_t *run)
+{
+  SVN_ERR(svn_mutex__lock(run->mutex));
+  svn_atomic_set(&run->aborted, TRUE);
+
+  return svn_error_trace(svn_mutex__unlock(run->mutex,
+                              svn_thread_cond__broadcast(run->cond)));
+}
+
+/* Worker thread function.  DATA is a worker_t.  Keep executing tasks
+ * until there are none left or the run has been aborted.
+ */
+static void * APR_THREAD_FUNC
+worker_thread(apr_thread_t *thread,
+              void *data)
+{
+  worker_t *worker = data;
+  run_t *run = worker->run;
+
+  /* Our temporaries must not come from a pool shared with other threads.
+   * Allocating a sub-pool from the standard memory pool achieves that. */
+  apr_pool_t *scratch_pool = svn_pool_create(NULL);
+  svn_error_t *err = SVN_NO_ERROR;
+
+  while (!err)
+    {
+      int idx;
+      slot_t *slot;
+
+      err = claim_task(&idx, run);
+      if (err || idx < 0)
+        break;
+
+      slot = &run->slots[idx % run->max_pending];
+      slot->pool = svn_pool_create(NULL);
+      slot->result = NULL;
+      slot->err = run->task_func(&slot->result, run->task_baton, idx,
+                                 worker_cancel_func, run,
+                                 slot->pool, scratch_pool);
+      svn_pool_clear(scratch_pool);
+
+      err = complete_task(run, slot);
+    }
+
+  svn_pool_destroy(scratch_pool);
+
+  /* Don't let the calling thread wait for results that we won't produce. */
+  if (err)
+    err = svn_error_compose_create(err, abort_run(run));
+
+  worker->err = err;
+
+  return NULL;
+}
+
+/* Wait until SLOT in RUN has been completed.  Set *AVAILABLE to FALSE,
+ * if the run got aborted by some worker before that.  Check for
+ * cancellation using CANCEL_FUNC and CANCEL_BATON while waiting.
+ */
+static svn_error_t *
+wait_for_slot(svn_boolean_t *available,
+              run_t *run,
+              slot_t *slot,
+              svn_cancel_func_t cancel_func,
+              void *cancel_baton)
+{
+  svn_boolean_t aborted = FALSE;
+
+  *available = FALSE;
+  while (!*available && !aborted)
+    {
+      svn_error_t *err = SVN_NO_ERROR;
+
+      if (cancel_func)
+        SVN_ERR(cancel_func(cancel_baton));
+
+      SVN_ERR(svn_mutex__lock(run->mutex));
+
+      *available = slot->done;
+      aborted = svn_atomic_read(&run->aborted);
+      if (!*available && !aborted)
+        err = svn_thread_cond__timedwait(run->cond, run->mutex,
+                                         CANCEL_CHECK_INTERVAL);
+
+      SVN_ERR(svn_mutex__unlock(run->mutex, err));
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Pass the outcome in SLOT of the next task of RUN to OUTPUT_FUNC with
+ * OUTPUT_BATON.  Then, release SLOT for reuse by another task.
+ * Use SCRATCH_POOL for temporary allocations.
+ */
+static svn_error_t *
+output_slot(run_t *run,
+            slot_t *slot,
+            svn_parallel__output_func_t output_func,
+            void *output_baton,
+            apr_pool_t *scratch_pool)
+{
+  svn_error_t *task_err = slot->err;
+  svn_error_t *err;
+
+  /* OUTPUT_FUNC takes ownership of the task error. */
+  slot->err = SVN_NO_ERROR;
+  err = output_func(output_baton, run->next_output, slot->result, task_err,
+                    scratch_pool);
+
+  svn_pool_destroy(slot->pool);
+  slot->pool = NULL;
+  slot->result = NULL;
+  SVN_ERR(err);
+
+  SVN_ERR(svn_mutex__lock(run->mutex));
+  slot->done = FALSE;
+  run->next_output++;
+
+  return svn_error_trace(svn_mutex__unlock(run->mutex,
+                              svn_thread_cond__broadcast(run->cond)));
+}
+
+/* Execute all tasks on up to THREAD_COUNT worker threads.  THREAD_COUNT
+ * must be larger than 1.  All other parameters are the same as for
+ * svn_parallel__run.
+ */
+static svn_error_t *
+run_concurrently(int task_count,
+                 int thread_count,
+                 int max_pending,
+                 svn_parallel__task_func_t task_func,
+                 void *task_baton,
+                 svn_parallel__output_func_t output_func,
+                 void *output_baton,
+                 svn_cancel_func_t cancel_func,
+                 void *cancel_baton,
+                 apr_pool_t *scratch_pool)
+{
+  run_t *run = apr_pcalloc(scratch_pool, sizeof(*run));
+  worker_t *workers = apr_pcalloc(scratch_pool,
+                                  thread_count * sizeof(*workers));
+  apr_thread_t **threads = apr_pcalloc(scratch_pool,
+                                       thread_count * sizeof(*threads));
+  apr_pool_t *iterpool;
+  svn_error_t *err = SVN_NO_ERROR;
+  int threads_started = 0;
+  int i;
+
+  run->task_func = task_func;
+  run->task_baton = task_baton;
+  run->task_count = task_count;
+  run->max_pending = max_pending;
+  run->slots = apr_pcalloc(scratch_pool, max_pending * sizeof(*run->slots));
+  run->next_task = 0;
+  run->next_output = 0;
+  svn_atomic_set(&run->aborted, FALSE);
+
+  SVN_ERR(svn_mutex__init(&run->mutex, TRUE, scratch_pool));
+  SVN_ERR(svn_thread_cond__create(&run->cond, scratch_pool));
+
+  for (i = 0; i < thread_count; ++i)
+    {
+      apr_status_t status;
+
+      workers[i].run = run;
+      workers[i].err = SVN_NO_ERROR;
+
+      status = apr_thread_create(&threads[i], NULL, worker_thread,
+                                 &workers[i], scratch_pool);
+      if (status)
+        {
+          /* Continue with the threads that we already got, if any. */
+          if (threads_started == 0)
+            err = svn_error_wrap_apr(status, _("Can't create thread"));
+          break;
+        }
+
+      ++threads_started;
+    }
+
+  /* Process the results in order as they become available. */
+  iterpool = svn_pool_create(scratch_pool);
+  while (!err && run->next_output < task_count)
+    {
+      slot_t *slot = &run->slots[run->next_output % max_pending];
+      svn_boolean_t available;
+
+      svn_pool_clear(iterpool);
+
+      err = wait_for_slot(&available, run, slot, cancel_func, cancel_baton);
+      if (err || !available)
+        break;
+
+      err = output_slot(run, slot, output_func, output_baton, iterpool);
+    }
+
+  svn_pool_destroy(iterpool);
+
+  /* Shut down all workers.  Any synchronization problems encountered by
+   * them will be reported as well. */
+  err = svn_error_compose_create(err, abort_run(run));
+  for (i = 0; i < threads_started; ++i)
+    {
+      apr_status_t retval;
+      apr_status_t status = apr_thread_join(&retval, threads[i]);
+      if (status)
+        err = svn_error_compose_create(err,
+                   svn_error_wrap_apr(status, _("Can't join thread")));
+
+      err = svn_error_compose_create(err, workers[i].err);
+    }
+
+  /* Discard all results that we did not process. */
+  for (i = 0; i < max_pending; ++i)
+    if (run->slots[i].pool)
+      {
+        svn_error_clear(run->slots[i].err);
+        svn_pool_destroy(run->slots[i].pool);
+      }
+
+  return svn_error_trace(err);
+}
+
+#endif /* APR_HAS_THREADS */
+
+svn_error_t *
+svn_parallel__run(int task_count,
+                  int thread_count,
+                  int max_pending,
+                  svn_parallel__task_func_t task_func,
+                  void *task_baton,
+                  svn_parallel__output_func_t output_func,
+                  void *output_baton,
+                  svn_cancel_func_t cancel_func,
+                  void *cancel_baton,
+                  apr_pool_t *scratch_pool)
+{
+  /* There is no point in having more threads than tasks. */
+  if (thread_count > task_count)
+    thread_count = task_count;
+
+#if APR_HAS_THREADS
+
+  if (thread_count > 1)
+    {
+      if (max_pending <= 0)
+        max_pending = thread_count * DEFAULT_PENDING_PER_THREAD;
+
+      /* Every thread must be able to work on some task. */
+      if (max_pending < thread_count)
+        max_pending = thread_count;
+
+      return svn_error_trace(run_concurrently(task_count, thread_count,
+                                              max_pending,
+                                              task_func, task_baton,
+                                              output_func, output_baton,
+                                              cancel_func, cancel_baton,
+                                              scratch_pool));
+    }
+
+#endif
+
+  return svn_error_trace(run_sequentially(task_count,
+                                          task_func, task_baton,
+                                          output_func, output_baton,
+                                          cancel_func, cancel_baton,
+                                          scratch_pool));
+}
@@ -386,6 +386,12 @@ svn_sqlite__update(int *affected_rows, svn_sqlite__stmt_t *stmt)
   return svn_error_trace(svn_sqlite__reset(stmt));
 }
 
+int
+svn_sqlite__total_changes(svn_sqlite__db_t *db)
+{
+  return sqlite3_total_changes(db->db3);
+}
+
 
 static svn_error_t *
 vbindf(svn_sqlite__stmt_t *stmt, const char *fmt, va_list ap)
@@ -37,6 +37,23 @@
 
 #include "svn_private_config.h"
 
+/* Compare 16 bytes at a time using vector instructions where they are
+ * part of the baseline instruction set, i.e. need no runtime checks:
+ * SSE2 on x64 and NEON on little-endian AArch64.
+ */
+#if defined(__SSE2__) || defined(_M_X64) \
+    || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  include <emmintrin.h>
+#  if defined(_MSC_VER)
+#    include <intrin.h>
+#  endif
+#  define SVN_STRING_SSE2 1
+#elif defined(__aarch64__) && defined(__ARM_NEON) && defined(__GNUC__) \
+      && !defined(__AARCH64EB__)
+#  include <arm_neon.h>
+#  define SVN_STRING_NEON 1
+#endif
+
 
 
 /* Allocate the space for a memory buffer from POOL.
@@ -1501,6 +1518,79 @@ svn_string__similarity(const svn_string_t *stringa,
     return SVN_STRING__SIM_RANGE_MAX;
 }
 
+#if defined(SVN_STRING_SSE2) || defined(SVN_STRING_NEON)
+
+/* Return a bit mask with one bit per byte in the 16 bytes at A and B.
+ * A bit is set if the respective bytes differ.  For NEON, there are four
+ * bits per byte and the result is 64 bits wide.
+ */
+#ifdef SVN_STRING_SSE2
+typedef unsigned int diff_mask_t;
+#define DIFF_MASK_BITS_PER_BYTE 1
+
+static APR_INLINE diff_mask_t
+diff_mask16(const char *a, const char *b)
+{
+  __m128i va = _mm_loadu_si128((const __m128i *)a);
+  __m128i vb = _mm_loadu_si128((const __m128i *)b);
+
+  return ~(unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(va, vb)) & 0xffff;
+}
+
+#else
+typedef apr_uint64_t diff_mask_t;
+#define DIFF_MASK_BITS_PER_BYTE 4
+
+static APR_INLINE diff_mask_t
+diff_mask16(const char *a, const char *b)
+{
+  uint8x16_t va = vld1q_u8((const uint8_t *)a);
+  uint8x16_t vb = vld1q_u8((const uint8_t *)b);
+  uint8x16_t eq = vceqq_u8(va, vb);
+
+  /* Narrow every byte to a nibble. */
+  uint8x8_t nibbles = vshrn_n_u16(vreinterpretq_u16_u8(eq), 4);
+  return ~vget_lane_u64(vreinterpret_u64_u8(nibbles), 0);
+}
+
+#endif
+
+/* Return the index of the first byte that differs according to the
+ * non-zero MASK returned by diff_mask16().
+ */
+static APR_INLINE apr_size_t
+first_diff(diff_mask_t mask)
+{
+#if defined(_MSC_VER)
+  unsigned long idx;
+  _BitScanForward(&idx, mask);
+  return idx / DIFF_MASK_BITS_PER_BYTE;
+#elif defined(SVN_STRING_SSE2)
+  return __builtin_ctz(mask) / DIFF_MASK_BITS_PER_BYTE;
+#else
+  return __builtin_ctzll(mask) / DIFF_MASK_BITS_PER_BYTE;
+#endif
+}
+
+/* Return the index of the last byte that differs according to the
+ * non-zero MASK returned by diff_mask16().
+ */
+static APR_INLINE apr_size_t
+last_diff(diff_mask_t mask)
+{
+#if defined(_MSC_VER)
+  unsigned long idx;
+  _BitScanReverse(&idx, mask);
+  return idx / DIFF_MASK_BITS_PER_BYTE;
+#elif defined(SVN_STRING_SSE2)
+  return (31 - __builtin_clz(mask)) / DIFF_MASK_BITS_PER_BYTE;
+#else
+  return (63 - __builtin_clzll(mask)) / DIFF_MASK_BITS_PER_BYTE;
+#endif
+}
+
+#endif
+
 apr_size_t
 svn_cstring__match_length(const char *a,
                           const char *b,
@@ -1508,6 +1598,17 @@ svn_cstring__match_length(const char *a,
 {
   apr_size_t pos = 0;
 
+#if defined(SVN_STRING_SSE2) || defined(SVN_STRING_NEON)
+
+  for (; max_len - pos >= 16; pos += 16)
+    {
+      diff_mask_t mask = diff_mask16(a + pos, b + pos);
+      if (mask)
+        return pos + first_diff(mask);
+    }
+
+#endif
+
 #if SVN_UNALIGNED_ACCESS_IS_OK
 
   /* Chunky processing is so much faster ...
@@ -1536,6 +1637,19 @@ svn_cstring__reverse_match_length(const char *a,
 {
   apr_size_t pos = 0;
 
+#if defined(SVN_STRING_SSE2) || defined(SVN_STRING_NEON)
+
+  for (pos = 16; pos <= max_len; pos += 16)
+    {
+      diff_mask_t mask = diff_mask16(a - pos, b - pos);
+      if (mask)
+        return pos - 1 - last_diff(mask);
+    }
+
+  pos -= 16;
+
+#endif
+
 #if SVN_UNALIGNED_ACCESS_IS_OK
 
   /* Chunky processing is so much faster ...
@@ -1544,7 +1658,7 @@ svn_cstring__reverse_match_length(const char *a,
    * because A and B will probably have different alignment. So, skipping
    * the first few chars until alignment is reached is not an option.
    */
-  for (pos = sizeof(apr_size_t); pos <= max_len; pos += sizeof(apr_size_t))
+  for (pos += sizeof(apr_size_t); pos <= max_len; pos += sizeof(apr_size_t))
     if (*(const apr_size_t*)(a - pos) != *(const apr_size_t*)(b - pos))
       break;
 
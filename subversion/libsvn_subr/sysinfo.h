@@ -45,6 +45,11 @@ const char *svn_sysinfo__canonical_host(apr_pool_t *pool);
  */
 const char *svn_sysinfo__release_name(apr_pool_t *pool);
 
+/* Return the number of processors, i.e. hardware threads, currently
+ * online.  Return 1 if that information is not available.
+ */
+int svn_sysinfo__processor_count(void);
+
 /* Return an array of svn_version_linked_lib_t of descriptions of the
  * link-time and run-time versions of dependent libraries, or NULL of
  * the info is not available.
@@ -40,6 +40,9 @@
 #include "svn_path.h"
 
 #include "private/svn_wc_private.h"
+#include "private/svn_io_private.h"
+#include "private/svn_subr_private.h"
+#include "private/svn_parallel.h"
 
 #include "wc.h"
 #include "adm_files.h"
@@ -1051,6 +1054,52 @@ open_txdelta_stream(svn_txdelta_stream_t **txdelta_stream_p,
   return SVN_NO_ERROR;
 }
 
+/* Return ERR, the outcome of sending the delta of LOCAL_ABSPATH against
+   its pristine text, wrapped for reporting.  If the recorded MD5 checksum
+   EXPECTED_MD5_CHECKSUM of the pristine text and the VERIFY_CHECKSUM
+   actually found when reading it are both given but don't match, return
+   an SVN_ERR_WC_CORRUPT_TEXT_BASE error instead, since that is likely
+   the cause of ERR. */
+static svn_error_t *
+check_delta_result(svn_error_t *err,
+                   const svn_checksum_t *expected_md5_checksum,
+                   const svn_checksum_t *verify_checksum,
+                   const char *local_abspath,
+                   apr_pool_t *scratch_pool)
+{
+  if (expected_md5_checksum && verify_checksum
+      && !svn_checksum_match(expected_md5_checksum, verify_checksum))
+    {
+      /* The entry checksum does not match the actual text
+         base checksum.  Extreme badness. Of course,
+         theoretically we could just switch to
+         fulltext transmission here, and everything would
+         work fine; after all, we're going to replace the
+         text base with a new one in a moment anyway, and
+         we'd fix the checksum then.  But it's better to
+         error out.  People should know that their text
+         bases are getting corrupted, so they can
+         investigate.  Other commands could be affected,
+         too, such as `svn diff'.  */
+
+      err = svn_error_compose_create(
+              svn_checksum_mismatch_err(expected_md5_checksum, verify_checksum,
+                            scratch_pool,
+                            _("Checksum mismatch for text base of '%s'"),
+                            svn_dirent_local_style(local_abspath,
+                                                   scratch_pool)),
+              err);
+
+      return svn_error_create(SVN_ERR_WC_CORRUPT_TEXT_BASE, err, NULL);
+    }
+
+  SVN_ERR_W(err, apr_psprintf(scratch_pool,
+                              _("While preparing '%s' for commit"),
+                              svn_dirent_local_style(local_abspath,
+                                                     scratch_pool)));
+  return SVN_NO_ERROR;
+}
+
 svn_error_t *
 svn_wc__internal_transmit_text_deltas(svn_stream_t *tempstream,
                                       const svn_checksum_t **new_text_base_md5_checksum,
@@ -1171,40 +1220,10 @@ svn_wc__internal_transmit_text_deltas(svn_stream_t *tempstream,
 
   err = svn_error_compose_create(err, svn_stream_close(local_stream));
 
-  /* If we have an error, it may be caused by a corrupt text base,
-     so check the checksum. */
-  if (expected_md5_checksum && verify_checksum
-      && !svn_checksum_match(expected_md5_checksum, verify_checksum))
-    {
-      /* The entry checksum does not match the actual text
-         base checksum.  Extreme badness. Of course,
-         theoretically we could just switch to
-         fulltext transmission here, and everything would
-         work fine; after all, we're going to replace the
-         text base with a new one in a moment anyway, and
-         we'd fix the checksum then.  But it's better to
-         error out.  People should know that their text
-         bases are getting corrupted, so they can
-         investigate.  Other commands could be affected,
-         too, such as `svn diff'.  */
-
-      err = svn_error_compose_create(
-              svn_checksum_mismatch_err(expected_md5_checksum, verify_checksum,
-                            scratch_pool,
-                            _("Checksum mismatch for text base of '%s'"),
-                            svn_dirent_local_style(local_abspath,
-                                                   scratch_pool)),
-              err);
-
-      return svn_error_create(SVN_ERR_WC_CORRUPT_TEXT_BASE, err, NULL);
-    }
-
   /* Now, handle that delta transmission error if any, so we can stop
      thinking about it after this point. */
-  SVN_ERR_W(err, apr_psprintf(scratch_pool,
-                              _("While preparing '%s' for commit"),
-                              svn_dirent_local_style(local_abspath,
-                                                     scratch_pool)));
+  SVN_ERR(check_delta_result(err, expected_md5_checksum, verify_checksum,
+                             local_abspath, scratch_pool));
 
   if (new_text_base_md5_checksum)
     *new_text_base_md5_checksum = svn_checksum_dup(local_md5_checksum,
@@ -1247,6 +1266,546 @@ svn_wc_transmit_text_deltas3(const svn_checksum_t **new_text_base_md5_checksum,
                                                scratch_pool);
 }
 
+
+/*** Preparing text deltas ahead of a commit ***/
+
+/* The svndiff data of a prepared delta is kept in memory in blocks of this
+   size, up to the given maximum size.  Larger deltas are spilled to a
+   temporary file. */
+#define PREPARED_DELTA_BLOCKSIZE (16 * 1024)
+#define PREPARED_DELTA_MAXSIZE (256 * 1024)
+
+/* Everything prepare_delta_task() needs to know about a file to compute
+   its delta without accessing the working copy database. */
+typedef struct delta_source_t
+{
+  const char *local_abspath;
+
+  /* If not NULL, reading the information below failed with this error. */
+  svn_error_t *err;
+
+  /* How to translate the working file to normal form. */
+  svn_subst_eol_style_t style;
+  const char *eol;
+  apr_hash_t *keywords;
+  svn_boolean_t special;
+
+  /* The pristine text to compute the delta against and its recorded MD5
+     checksum.  If NULL, send a fulltext. */
+  const char *pristine_abspath;
+  const svn_checksum_t *expected_md5_checksum;
+
+  /* Where to create the new pristine text and the spill file. */
+  const char *temp_dir_abspath;
+} delta_source_t;
+
+struct svn_wc__prepared_delta_t
+{
+  svn_wc__db_t *db;
+  const char *local_abspath;
+
+  /* If TRUE, nothing has been prepared.  Compute the delta against the
+     pristine text, or against the empty text if FULLTEXT, while sending
+     it. */
+  svn_boolean_t direct;
+  svn_boolean_t fulltext;
+
+  /* The recorded MD5 checksum of the delta base, NULL for fulltexts. */
+  const svn_checksum_t *expected_md5_checksum;
+
+  /* The delta in svndiff version 0 format, consisting of WINDOW_COUNT
+     windows.  Once it has been read from memory, SVNDIFF_DATA holds the
+     contents of SVNDIFF, so that the delta can be sent more than once. */
+  svn_spillbuf_t *svndiff;
+  svn_stringbuf_t *svndiff_data;
+  int window_count;
+
+  /* The new pristine text, ready for installation, or NULL once that has
+     been taken care of. */
+  svn_stream_t *install_stream;
+
+  /* The checksums of the new pristine text. */
+  svn_checksum_t *md5_checksum;
+  svn_checksum_t *sha1_checksum;
+
+  /* The pool that the above is allocated in. */
+  apr_pool_t *pool;
+};
+
+/* Set *SOURCE to the information needed to compute the delta of
+   LOCAL_ABSPATH in DB against its pristine text, or against the empty text
+   if FULLTEXT.  If reading that information fails, put the error into
+   (*SOURCE)->ERR.  Allocate *SOURCE in RESULT_POOL. */
+static void
+get_delta_source(delta_source_t **source,
+                 svn_wc__db_t *db,
+                 const char *local_abspath,
+                 svn_boolean_t fulltext,
+                 apr_pool_t *result_pool,
+                 apr_pool_t *scratch_pool)
+{
+  delta_source_t *s = apr_pcalloc(result_pool, sizeof(*s));
+  const svn_checksum_t *checksum = NULL;
+  svn_error_t *err;
+
+  s->local_abspath = local_abspath;
+  *source = s;
+
+  err = svn_wc__get_translate_info(&s->style, &s->eol, &s->keywords,
+                                   &s->special, db, local_abspath, NULL,
+                                   FALSE, result_pool, scratch_pool);
+
+  if (!err && !fulltext)
+    err = svn_wc__db_read_info(NULL, NULL, NULL, NULL, NULL, NULL,
+                               NULL, NULL, NULL, NULL, &checksum,
+                               NULL, NULL, NULL, NULL, NULL, NULL,
+                               NULL, NULL, NULL, NULL, NULL, NULL,
+                               NULL, NULL, NULL, NULL,
+                               db, local_abspath,
+                               scratch_pool, scratch_pool);
+
+  /* Locally added files have no pristine text, so we send a fulltext. */
+  if (!err && checksum)
+    err = svn_wc__db_pristine_get_path(&s->pristine_abspath, db,
+                                       local_abspath, checksum,
+                                       result_pool, scratch_pool);
+  if (!err && checksum)
+    err = svn_wc__db_pristine_get_md5(&s->expected_md5_checksum, db,
+                                      local_abspath, checksum,
+                                      result_pool, scratch_pool);
+
+  if (!err)
+    err = svn_wc__db_pristine_get_install_tempdir(&s->temp_dir_abspath, db,
+                                                  local_abspath,
+                                                  result_pool, scratch_pool);
+
+  s->err = err;
+}
+
+/* Remove the new pristine text of the svn_wc__prepared_delta_t BATON
+   unless it has been taken care of.  Implements an APR pool cleanup. */
+static apr_status_t
+remove_unused_install(void *baton)
+{
+  svn_wc__prepared_delta_t *delta = baton;
+
+  if (delta->install_stream)
+    svn_error_clear(svn_stream__install_delete(delta->install_stream,
+                                               delta->pool));
+
+  return APR_SUCCESS;
+}
+
+/* Compute the delta described by SOURCE into DELTA, whose INSTALL_STREAM
+   has already been created.  Allocate the results in RESULT_POOL. */
+static svn_error_t *
+write_prepared_delta(svn_wc__prepared_delta_t *delta,
+                     const delta_source_t *source,
+                     svn_cancel_func_t cancel_func,
+                     void *cancel_baton,
+                     apr_pool_t *result_pool,
+                     apr_pool_t *scratch_pool)
+{
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  svn_checksum_t *verify_checksum = NULL;
+  svn_stream_t *local_stream;
+  svn_stream_t *base_stream;
+  svn_txdelta_stream_t *txdelta_stream;
+  svn_txdelta_window_handler_t handler;
+  void *handler_baton;
+  svn_error_t *err;
+  svn_error_t *err2;
+
+  /* Read the working file in normal form, copying it into the new
+     pristine text and checksumming it on the way. */
+  SVN_ERR(svn_wc__translated_stream_to_nf(&local_stream,
+                                          source->local_abspath,
+                                          source->style, source->eol,
+                                          source->keywords, source->special,
+                                          FALSE, scratch_pool, scratch_pool));
+  local_stream = copying_stream(local_stream,
+                                svn_stream_checksummed2(
+                                  delta->install_stream,
+                                  NULL, &delta->sha1_checksum,
+                                  svn_checksum_sha1, FALSE, result_pool),
+                                scratch_pool);
+  local_stream = svn_stream_checksummed2(local_stream, &delta->md5_checksum,
+                                         NULL, svn_checksum_md5, TRUE,
+                                         result_pool);
+
+  if (source->pristine_abspath)
+    {
+      SVN_ERR(svn_stream_open_readonly(&base_stream, source->pristine_abspath,
+                                       scratch_pool, scratch_pool));
+      base_stream = svn_stream_checksummed2(base_stream, &verify_checksum,
+                                            NULL, svn_checksum_md5, TRUE,
+                                            scratch_pool);
+    }
+  else
+    base_stream = svn_stream_empty(scratch_pool);
+
+  /* The delta is only read back by ourselves, so don't bother
+     compressing it. */
+  delta->svndiff = svn_spillbuf__create_extended(PREPARED_DELTA_BLOCKSIZE,
+                                                 PREPARED_DELTA_MAXSIZE,
+                                                 TRUE /* delete_on_close */,
+                                                 TRUE /* spill_all_contents */,
+                                                 source->temp_dir_abspath,
+                                                 result_pool);
+  svn_txdelta_to_svndiff3(&handler, &handler_baton,
+                          svn_stream__from_spillbuf(delta->svndiff,
+                                                    scratch_pool),
+                          0, SVN_DELTA_COMPRESSION_LEVEL_NONE,
+                          scratch_pool);
+
+  svn_txdelta2(&txdelta_stream, base_stream, local_stream, FALSE,
+               scratch_pool);
+  do
+    {
+      svn_txdelta_window_t *window;
+
+      svn_pool_clear(iterpool);
+      if (cancel_func)
+        SVN_ERR(cancel_func(cancel_baton));
+
+      err = svn_txdelta_next_window(&window, txdelta_stream, iterpool);
+      if (!err)
+        err = handler(window, handler_baton);
+      if (err || !window)
+        break;
+
+      delta->window_count++;
+    }
+  while (TRUE);
+
+  /* Close the two streams to force calculating the digests. */
+  err2 = svn_stream_close(base_stream);
+  if (err2)
+    {
+      /* VERIFY_CHECKSUM is uninitialized in this case. */
+      verify_checksum = NULL;
+      err = svn_error_compose_create(err, err2);
+    }
+
+  err = svn_error_compose_create(err, svn_stream_close(local_stream));
+
+  svn_pool_destroy(iterpool);
+
+  return svn_error_trace(check_delta_result(err,
+                                            source->expected_md5_checksum,
+                                            verify_checksum,
+                                            source->local_abspath,
+                                            scratch_pool));
+}
+
+/* Baton for prepare_delta_task() and prepare_delta_output(). */
+typedef struct prepare_baton_t
+{
+  svn_wc__db_t *db;
+
+  /* The files to prepare and whether to send fulltexts. */
+  const apr_array_header_t *local_abspaths;
+  const apr_array_header_t *fulltexts;
+
+  /* delta_source_t * for each file, or NULL to not prepare anything. */
+  apr_array_header_t *sources;
+
+  svn_wc__prepared_delta_func_t delta_func;
+  void *delta_baton;
+} prepare_baton_t;
+
+/* Prepare the delta of the IDX-th file of the prepare_baton_t BATON.
+   Implements svn_parallel__task_func_t. */
+static svn_error_t *
+prepare_delta_task(void **result,
+                   void *baton,
+                   int idx,
+                   svn_cancel_func_t cancel_func,
+                   void *cancel_baton,
+                   apr_pool_t *result_pool,
+                   apr_pool_t *scratch_pool)
+{
+  prepare_baton_t *b = baton;
+  svn_wc__prepared_delta_t *delta = apr_pcalloc(result_pool, sizeof(*delta));
+  const delta_source_t *source;
+
+  delta->db = b->db;
+  delta->local_abspath = APR_ARRAY_IDX(b->local_abspaths, idx, const char *);
+  delta->pool = result_pool;
+
+  if (!b->sources)
+    {
+      delta->direct = TRUE;
+      delta->fulltext = APR_ARRAY_IDX(b->fulltexts, idx, svn_boolean_t);
+      *result = delta;
+      return SVN_NO_ERROR;
+    }
+
+  source = APR_ARRAY_IDX(b->sources, idx, const delta_source_t *);
+  if (source->err)
+    return svn_error_dup(source->err);
+
+  delta->expected_md5_checksum = source->expected_md5_checksum;
+
+  SVN_ERR(svn_stream__create_for_install(&delta->install_stream,
+                                         source->temp_dir_abspath,
+                                         result_pool, scratch_pool));
+  apr_pool_cleanup_register(result_pool, delta, remove_unused_install,
+                            apr_pool_cleanup_null);
+
+  SVN_ERR(write_prepared_delta(delta, source, cancel_func, cancel_baton,
+                               result_pool, scratch_pool));
+
+  *result = delta;
+  return SVN_NO_ERROR;
+}
+
+/* Pass the delta prepared for the IDX-th file of the prepare_baton_t BATON
+   to the caller of svn_wc__prepare_text_deltas().
+   Implements svn_parallel__output_func_t. */
+static svn_error_t *
+prepare_delta_output(void *baton,
+                     int idx,
+                     void *result,
+                     svn_error_t *task_err,
+                     apr_pool_t *scratch_pool)
+{
+  prepare_baton_t *b = baton;
+
+  return svn_error_trace(b->delta_func(b->delta_baton, idx,
+                                       task_err ? NULL : result, task_err,
+                                       scratch_pool));
+}
+
+svn_error_t *
+svn_wc__prepare_text_deltas(svn_wc_context_t *wc_ctx,
+                            const apr_array_header_t *local_abspaths,
+                            const apr_array_header_t *fulltexts,
+                            svn_wc__prepared_delta_func_t delta_func,
+                            void *delta_baton,
+                            svn_cancel_func_t cancel_func,
+                            void *cancel_baton,
+                            apr_pool_t *scratch_pool)
+{
+  prepare_baton_t b;
+  int thread_count = svn_wc__db_get_commit_threads(wc_ctx->db);
+  int task_count = local_abspaths->nelts;
+  svn_error_t *err;
+
+  SVN_ERR_ASSERT(fulltexts->nelts == local_abspaths->nelts);
+
+  b.db = wc_ctx->db;
+  b.local_abspaths = local_abspaths;
+  b.fulltexts = fulltexts;
+  b.sources = NULL;
+  b.delta_func = delta_func;
+  b.delta_baton = delta_baton;
+
+  /* All database access happens here, in this thread, before any of the
+     files is read. */
+  if (thread_count > 1 && task_count > 1)
+    {
+      apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+      int i;
+
+      b.sources = apr_array_make(scratch_pool, task_count,
+                                 sizeof(delta_source_t *));
+      for (i = 0; i < task_count; i++)
+        {
+          delta_source_t *source;
+
+          svn_pool_clear(iterpool);
+          if (cancel_func)
+            SVN_ERR(cancel_func(cancel_baton));
+
+          get_delta_source(&source, wc_ctx->db,
+                           APR_ARRAY_IDX(local_abspaths, i, const char *),
+                           APR_ARRAY_IDX(fulltexts, i, svn_boolean_t),
+                           scratch_pool, iterpool);
+          APR_ARRAY_PUSH(b.sources, delta_source_t *) = source;
+
+          /* The failing file will be the last one sent. */
+          if (source->err)
+            {
+              task_count = i + 1;
+              break;
+            }
+        }
+
+      svn_pool_destroy(iterpool);
+    }
+  else
+    thread_count = 1;
+
+  err = svn_parallel__run(task_count, thread_count, 0,
+                          prepare_delta_task, &b,
+                          prepare_delta_output, &b,
+                          cancel_func, cancel_baton, scratch_pool);
+
+  if (b.sources)
+    {
+      int i;
+
+      for (i = 0; i < b.sources->nelts; i++)
+        svn_error_clear(APR_ARRAY_IDX(b.sources, i, delta_source_t *)->err);
+    }
+
+  return svn_error_trace(err);
+}
+
+/* Baton for read_prepared_window() and prepared_md5_digest(). */
+typedef struct prepared_txdelta_baton_t
+{
+  svn_stream_t *svndiff;
+  int windows_left;
+  const svn_checksum_t *md5_checksum;
+} prepared_txdelta_baton_t;
+
+/* Implements svn_txdelta_next_window_fn_t */
+static svn_error_t *
+read_prepared_window(svn_txdelta_window_t **window,
+                     void *baton,
+                     apr_pool_t *pool)
+{
+  prepared_txdelta_baton_t *b = baton;
+
+  if (b->windows_left == 0)
+    {
+      *window = NULL;
+      return SVN_NO_ERROR;
+    }
+
+  b->windows_left--;
+  return svn_error_trace(svn_txdelta_read_svndiff_window(window, b->svndiff,
+                                                         0, pool));
+}
+
+/* Implements svn_txdelta_md5_digest_fn_t */
+static const unsigned char *
+prepared_md5_digest(void *baton)
+{
+  prepared_txdelta_baton_t *b = baton;
+
+  return b->md5_checksum->digest;
+}
+
+/* Implements svn_txdelta_stream_open_func_t for a
+   svn_wc__prepared_delta_t BATON. */
+static svn_error_t *
+open_prepared_txdelta_stream(svn_txdelta_stream_t **txdelta_stream_p,
+                             void *baton,
+                             apr_pool_t *result_pool,
+                             apr_pool_t *scratch_pool)
+{
+  svn_wc__prepared_delta_t *delta = baton;
+  prepared_txdelta_baton_t *b = apr_pcalloc(result_pool, sizeof(*b));
+  apr_file_t *file = svn_spillbuf__get_file(delta->svndiff);
+  char header[4];
+  apr_size_t len = sizeof(header);
+
+  /* With SPILL_ALL_CONTENTS, the spill file has everything. */
+  if (file)
+    {
+      apr_off_t offset = 0;
+
+      SVN_ERR(svn_io_file_seek(file, APR_SET, &offset, scratch_pool));
+      b->svndiff = svn_stream_from_aprfile2(file, TRUE, result_pool);
+    }
+  else
+    {
+      if (!delta->svndiff_data)
+        {
+          const char *data;
+          apr_size_t data_len;
+
+          delta->svndiff_data = svn_stringbuf_create_ensure(
+                                  (apr_size_t)svn_spillbuf__get_size(
+                                                delta->svndiff),
+                                  delta->pool);
+          do
+            {
+              SVN_ERR(svn_spillbuf__read(&data, &data_len, delta->svndiff,
+                                         scratch_pool));
+              if (data)
+                svn_stringbuf_appendbytes(delta->svndiff_data, data,
+                                          data_len);
+            }
+          while (data);
+        }
+
+      b->svndiff = svn_stream_from_stringbuf(delta->svndiff_data,
+                                             result_pool);
+    }
+
+  /* Skip the svndiff header. */
+  SVN_ERR(svn_stream_read_full(b->svndiff, header, &len));
+
+  b->windows_left = delta->window_count;
+  b->md5_checksum = delta->md5_checksum;
+  *txdelta_stream_p = svn_txdelta_stream_create(b, read_prepared_window,
+                                                prepared_md5_digest,
+                                                result_pool);
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_wc__transmit_prepared_delta(
+  const svn_checksum_t **new_text_base_md5_checksum,
+  const svn_checksum_t **new_text_base_sha1_checksum,
+  svn_wc__prepared_delta_t *delta,
+  const svn_delta_editor_t *editor,
+  void *file_baton,
+  apr_pool_t *result_pool,
+  apr_pool_t *scratch_pool)
+{
+  const char *base_digest_hex = NULL;
+
+  if (delta->direct)
+    return svn_error_trace(svn_wc__internal_transmit_text_deltas(
+                             NULL, new_text_base_md5_checksum,
+                             new_text_base_sha1_checksum,
+                             delta->db, delta->local_abspath,
+                             delta->fulltext, editor, file_baton,
+                             result_pool, scratch_pool));
+
+  if (delta->expected_md5_checksum)
+    base_digest_hex = svn_checksum_to_cstring_display(
+                        delta->expected_md5_checksum, scratch_pool);
+
+  SVN_ERR_W(editor->apply_textdelta_stream(editor, file_baton,
+                                           base_digest_hex,
+                                           open_prepared_txdelta_stream,
+                                           delta, scratch_pool),
+            apr_psprintf(scratch_pool, _("While preparing '%s' for commit"),
+                         svn_dirent_local_style(delta->local_abspath,
+                                                scratch_pool)));
+
+  if (new_text_base_md5_checksum)
+    *new_text_base_md5_checksum = svn_checksum_dup(delta->md5_checksum,
+                                                   result_pool);
+  if (new_text_base_sha1_checksum)
+    {
+      svn_stream_t *install_stream = delta->install_stream;
+
+      /* Whatever happens, it is not ours to remove anymore. */
+      delta->install_stream = NULL;
+      SVN_ERR(svn_wc__db_pristine_install_stream(install_stream,
+                                                 delta->sha1_checksum,
+                                                 delta->md5_checksum,
+                                                 delta->db,
+                                                 delta->local_abspath,
+                                                 scratch_pool));
+      *new_text_base_sha1_checksum = svn_checksum_dup(delta->sha1_checksum,
+                                                      result_pool);
+    }
+
+  return svn_error_trace(
+             editor->close_file(file_baton,
+                                svn_checksum_to_cstring(delta->md5_checksum,
+                                                        scratch_pool),
+                                scratch_pool));
+}
+
 svn_error_t *
 svn_wc__internal_transmit_prop_deltas(svn_wc__db_t *db,
                                      const char *local_abspath,
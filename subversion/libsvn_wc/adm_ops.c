@@ -860,8 +860,11 @@ svn_wc__get_pristine_contents_by_checksum(svn_stream_t **contents,
 
   *contents = NULL;
 
-  SVN_ERR(svn_wc__db_pristine_check(&present, wc_ctx->db, wri_abspath,
-                                    checksum, scratch_pool));
+  if (wri_abspath)
+    SVN_ERR(svn_wc__db_pristine_check(&present, wc_ctx->db, wri_abspath,
+                                      checksum, scratch_pool));
+  else
+    present = FALSE;
 
   if (present)
     {
@@ -875,6 +878,12 @@ svn_wc__get_pristine_contents_by_checksum(svn_stream_t **contents,
       *contents = svn_stream_lazyopen_create(get_pristine_lazyopen_func,
                                              gpl_baton, FALSE, result_pool);
     }
+  else
+    {
+      /* Another working copy on this host may have the text already. */
+      SVN_ERR(svn_wc__db_pristine_read_shared(contents, wc_ctx->db, checksum,
+                                              result_pool, scratch_pool));
+    }
 
   return SVN_NO_ERROR;
 }
@@ -129,6 +129,10 @@ cleanup_internal(svn_wc__db_t *db,
 
       /* Remove unreferenced pristine texts */
       SVN_ERR(svn_wc__db_pristine_cleanup(db, dir_abspath, scratch_pool));
+
+      /* ... and the shared ones that no working copy links to anymore */
+      SVN_ERR(svn_wc__db_pristine_prune_shared(db, cancel_func, cancel_baton,
+                                               scratch_pool));
     }
 
   if (fix_recorded_timestamps)
@@ -0,0 +1,779 @@
+/*
+ * journal.c :  recording and reading the change journal
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+/* The change journal lives in the MONITOR directory of the working copy
+   root's administrative area:
+
+     journal  Written by the monitor only.  The first line identifies the
+              journal format and its generation, which changes whenever
+              the monitor starts or restarts the journal.  It is followed
+              by one line per event:
+
+                P <relpath>   The node at RELPATH may have changed.
+                C <name>      The cookie file NAME has been seen.
+                X             Changes may have been missed.
+
+     lock     Locked by the running monitor.
+
+     status   Written by status walks.  Records the journal position up to
+              which the last walk has seen all changes, the parameters of
+              that walk and the nodes it reported.
+
+   To find its position, a status walk creates a uniquely named cookie
+   file and waits for the monitor to report it.  Since the monitor reports
+   events in order, every change before that position has been recorded
+   by then and every change after it will be seen by the next walk. */
+
+#include <string.h>
+
+#include <apr_pools.h>
+#include <apr_strings.h>
+#include <apr_time.h>
+
+#include "svn_types.h"
+#include "svn_pools.h"
+#include "svn_dirent_uri.h"
+#include "svn_hash.h"
+#include "svn_io.h"
+#include "svn_path.h"
+#include "svn_sorts.h"
+#include "svn_string.h"
+
+#include "wc.h"
+#include "adm_files.h"
+#include "journal.h"
+
+#include "svn_private_config.h"
+#include "private/svn_wc_private.h"
+
+#define SDB_FILE  "wc.db"
+
+/* Files within the SVN_WC__ADM_MONITOR directory. */
+#define JOURNAL_FILE "journal"
+#define JOURNAL_LOCK_FILE "lock"
+#define JOURNAL_STATUS_FILE "status"
+
+/* First words of the JOURNAL_FILE and the JOURNAL_STATUS_FILE. */
+#define JOURNAL_FORMAT "svn-wc-journal-1"
+#define STATUS_FORMAT "svn-wc-journal-status-1"
+
+/* Start a new journal generation when the journal grows beyond this. */
+#define JOURNAL_MAX_SIZE (64 * 1024 * 1024)
+
+/* How long a status walk waits for the monitor to report its cookie. */
+#define COOKIE_TIMEOUT apr_time_from_sec(1)
+
+/* Longest pause between two attempts to find the cookie. */
+#define COOKIE_MAX_DELAY apr_time_from_msec(50)
+
+struct svn_wc__journal_t
+{
+  /* The absolute paths of the journal file and its directory. */
+  const char *monitor_abspath;
+  const char *journal_abspath;
+
+  /* JOURNAL_ABSPATH in the native encoding, for journal_cleanup(). */
+  const char *journal_apr;
+
+  /* The journal file, opened for appending, and its size. */
+  apr_file_t *file;
+  apr_off_t size;
+
+  /* The relpaths recorded since the last cookie, mapped to "". */
+  apr_hash_t *recorded;
+
+  /* The open lock file. */
+  apr_file_t *lock_file;
+
+  /* Pools for FILE and RECORDED, and the pool the journal lives in. */
+  apr_pool_t *file_pool;
+  apr_pool_t *recorded_pool;
+  apr_pool_t *pool;
+};
+
+struct svn_wc__journal_status_private_t
+{
+  /* The working copy root and the location of the status file. */
+  const char *wcroot_abspath;
+  const char *status_abspath;
+
+  /* The journal position up to which all changes have been seen. */
+  const char *generation;
+  apr_off_t offset;
+
+  /* The state of wc.db at the start of the walk. */
+  apr_time_t db_mtime;
+  apr_off_t db_size;
+
+  /* The walk's root relative to WCROOT_ABSPATH, and its parameters. */
+  const char *walk_relpath;
+  const char *walk_key;
+};
+
+
+/* Append LINE to JOURNAL. */
+static svn_error_t *
+write_line(svn_wc__journal_t *journal,
+           const char *line,
+           apr_pool_t *scratch_pool)
+{
+  apr_size_t len = strlen(line);
+
+  SVN_ERR(svn_io_file_write_full(journal->file, line, len, NULL,
+                                 scratch_pool));
+  journal->size += len;
+
+  return SVN_NO_ERROR;
+}
+
+/* Replace the journal file of JOURNAL with an empty one of a new
+   generation. */
+static svn_error_t *
+start_generation(svn_wc__journal_t *journal,
+                 apr_pool_t *scratch_pool)
+{
+  const char *header = apr_psprintf(scratch_pool, "%s %s\n", JOURNAL_FORMAT,
+                                    svn_uuid_generate(scratch_pool));
+
+  if (journal->file)
+    SVN_ERR(svn_io_file_close(journal->file, scratch_pool));
+
+  svn_pool_clear(journal->file_pool);
+  journal->file = NULL;
+
+  SVN_ERR(svn_io_write_atomic2(journal->journal_abspath, header,
+                               strlen(header), NULL, FALSE, scratch_pool));
+  SVN_ERR(svn_io_file_open(&journal->file, journal->journal_abspath,
+                           APR_WRITE | APR_APPEND, APR_OS_DEFAULT,
+                           journal->file_pool));
+  journal->size = strlen(header);
+
+  svn_pool_clear(journal->recorded_pool);
+  journal->recorded = apr_hash_make(journal->recorded_pool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Pool cleanup handler for the svn_wc__journal_t DATA.  Remove the
+   journal file, so that status walks do not wait for a monitor that is
+   gone.  The journal file itself has already been closed together with
+   the FILE_POOL sub-pool and the lock file gets closed, and thus
+   unlocked, by its own cleanup after this one. */
+static apr_status_t
+journal_cleanup(void *data)
+{
+  svn_wc__journal_t *journal = data;
+
+  apr_file_remove(journal->journal_apr, journal->pool);
+
+  return APR_SUCCESS;
+}
+
+svn_error_t *
+svn_wc__journal_open(svn_wc__journal_t **journal,
+                     const char **monitor_abspath,
+                     const char *wcroot_abspath,
+                     apr_pool_t *result_pool,
+                     apr_pool_t *scratch_pool)
+{
+  svn_wc__journal_t *j = apr_pcalloc(result_pool, sizeof(*j));
+  const char *lock_abspath;
+  svn_error_t *err;
+
+  j->pool = result_pool;
+  j->file_pool = svn_pool_create(result_pool);
+  j->recorded_pool = svn_pool_create(result_pool);
+  j->monitor_abspath = svn_wc__adm_child(wcroot_abspath, SVN_WC__ADM_MONITOR,
+                                         result_pool);
+  j->journal_abspath = svn_dirent_join(j->monitor_abspath, JOURNAL_FILE,
+                                       result_pool);
+  lock_abspath = svn_dirent_join(j->monitor_abspath, JOURNAL_LOCK_FILE,
+                                 scratch_pool);
+  SVN_ERR(svn_path_cstring_from_utf8(&j->journal_apr, j->journal_abspath,
+                                     result_pool));
+
+  SVN_ERR(svn_io_make_dir_recursively(j->monitor_abspath, scratch_pool));
+
+  SVN_ERR(svn_io_file_open(&j->lock_file, lock_abspath,
+                           APR_READ | APR_WRITE | APR_CREATE,
+                           APR_OS_DEFAULT, result_pool));
+  err = svn_io_lock_open_file(j->lock_file, TRUE, TRUE, result_pool);
+  if (err)
+    return svn_error_createf(SVN_ERR_WC_LOCKED, err,
+                             _("Working copy '%s' is already being "
+                               "monitored"),
+                             svn_dirent_local_style(wcroot_abspath,
+                                                    scratch_pool));
+
+  apr_pool_cleanup_register(result_pool, j, journal_cleanup,
+                            apr_pool_cleanup_null);
+  SVN_ERR(start_generation(j, scratch_pool));
+
+  *journal = j;
+  *monitor_abspath = j->monitor_abspath;
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_wc__journal_add_path(svn_wc__journal_t *journal,
+                         const char *local_relpath,
+                         apr_pool_t *scratch_pool)
+{
+  /* Paths are stored one per line. */
+  if (strchr(local_relpath, '\n'))
+    return svn_error_trace(svn_wc__journal_invalidate(journal,
+                                                      scratch_pool));
+
+  if (svn_hash_gets(journal->recorded, local_relpath))
+    return SVN_NO_ERROR;
+
+  SVN_ERR(write_line(journal,
+                     apr_pstrcat(scratch_pool, "P ", local_relpath, "\n",
+                                 SVN_VA_NULL),
+                     scratch_pool));
+  svn_hash_sets(journal->recorded,
+                apr_pstrdup(journal->recorded_pool, local_relpath), "");
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_wc__journal_add_cookie(svn_wc__journal_t *journal,
+                           const char *name,
+                           apr_pool_t *scratch_pool)
+{
+  /* A status walk starts reading the journal at a cookie.  So, this is
+     where the journal may be restarted to limit its size. */
+  if (journal->size > JOURNAL_MAX_SIZE)
+    SVN_ERR(start_generation(journal, scratch_pool));
+
+  SVN_ERR(write_line(journal,
+                     apr_pstrcat(scratch_pool, "C ", name, "\n",
+                                 SVN_VA_NULL),
+                     scratch_pool));
+
+  /* Readers will not look at anything before the cookie. */
+  svn_pool_clear(journal->recorded_pool);
+  journal->recorded = apr_hash_make(journal->recorded_pool);
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_wc__journal_invalidate(svn_wc__journal_t *journal,
+                           apr_pool_t *scratch_pool)
+{
+  return svn_error_trace(write_line(journal, "X\n", scratch_pool));
+}
+
+svn_error_t *
+svn_wc__journal_close(svn_wc__journal_t *journal,
+                      apr_pool_t *scratch_pool)
+{
+  SVN_ERR(svn_io_file_close(journal->file, scratch_pool));
+  journal->file = NULL;
+  SVN_ERR(svn_io_remove_file2(journal->journal_abspath, TRUE, scratch_pool));
+
+  SVN_ERR(svn_io_unlock_open_file(journal->lock_file, journal->pool));
+  SVN_ERR(svn_io_file_close(journal->lock_file, scratch_pool));
+
+  apr_pool_cleanup_kill(journal->pool, journal, journal_cleanup);
+
+  return SVN_NO_ERROR;
+}
+
+
+/* Set *LINE and *LEN to the next complete line in the buffer between *P
+   and END, excluding its newline, and advance *P beyond it.  Return FALSE
+   if there is no complete line left. */
+static svn_boolean_t
+next_line(const char **line,
+          apr_size_t *len,
+          const char **p,
+          const char *end)
+{
+  const char *eol = memchr(*p, '\n', end - *p);
+
+  if (!eol)
+    return FALSE;
+
+  *line = *p;
+  *len = eol - *p;
+  *p = eol + 1;
+
+  return TRUE;
+}
+
+/* The contents of a status file. */
+typedef struct status_file_t
+{
+  const char *generation;
+  apr_off_t offset;
+  apr_time_t db_mtime;
+  apr_off_t db_size;
+  const char *walk_relpath;
+  const char *walk_key;
+
+  /* const char * relpaths of the reported nodes. */
+  apr_array_header_t *reported;
+} status_file_t;
+
+/* Read the status file STATUS_ABSPATH into *STATUS_FILE, or set it to
+   NULL if there is no such file or it cannot be parsed. */
+static svn_error_t *
+read_status_file(status_file_t **status_file,
+                 const char *status_abspath,
+                 apr_pool_t *result_pool,
+                 apr_pool_t *scratch_pool)
+{
+  status_file_t *sf;
+  svn_stringbuf_t *contents;
+  const char *p, *end, *line;
+  apr_size_t len;
+  svn_error_t *err;
+
+  *status_file = NULL;
+
+  err = svn_stringbuf_from_file2(&contents, status_abspath, result_pool);
+  if (err && APR_STATUS_IS_ENOENT(err->apr_err))
+    {
+      svn_error_clear(err);
+      return SVN_NO_ERROR;
+    }
+  SVN_ERR(err);
+
+  p = contents->data;
+  end = p + contents->len;
+  if (!next_line(&line, &len, &p, end)
+      || len != strlen(STATUS_FORMAT)
+      || memcmp(line, STATUS_FORMAT, len) != 0)
+    return SVN_NO_ERROR;
+
+  sf = apr_pcalloc(result_pool, sizeof(*sf));
+  sf->reported = apr_array_make(result_pool, 16, sizeof(const char *));
+
+  while (next_line(&line, &len, &p, end))
+    {
+      const char *value;
+      apr_int64_t n;
+
+      if (len < 2 || line[1] != ' ')
+        return SVN_NO_ERROR;
+
+      value = apr_pstrmemdup(result_pool, line + 2, len - 2);
+      switch (line[0])
+        {
+          case 'G':
+            sf->generation = value;
+            break;
+
+          case 'O':
+            err = svn_cstring_atoi64(&n, value);
+            if (err)
+              {
+                svn_error_clear(err);
+                return SVN_NO_ERROR;
+              }
+            sf->offset = (apr_off_t)n;
+            break;
+
+          case 'T':
+            err = svn_cstring_atoi64(&n, value);
+            if (err)
+              {
+                svn_error_clear(err);
+                return SVN_NO_ERROR;
+              }
+            sf->db_mtime = (apr_time_t)n;
+            break;
+
+          case 'S':
+            err = svn_cstring_atoi64(&n, value);
+            if (err)
+              {
+                svn_error_clear(err);
+                return SVN_NO_ERROR;
+              }
+            sf->db_size = (apr_off_t)n;
+            break;
+
+          case 'W':
+            sf->walk_relpath = value;
+            break;
+
+          case 'K':
+            sf->walk_key = value;
+            break;
+
+          case 'R':
+            APR_ARRAY_PUSH(sf->reported, const char *) = value;
+            break;
+
+          default:
+            return SVN_NO_ERROR;
+        }
+    }
+
+  if (sf->generation && sf->walk_relpath && sf->walk_key)
+    *status_file = sf;
+
+  return SVN_NO_ERROR;
+}
+
+/* Look for the cookie COOKIE in the journal JOURNAL_ABSPATH.
+
+   *GENERATION and *OFFSET are the journal position up to which the
+   journal has been read before, with *GENERATION being NULL initially.
+   If the journal has been restarted since, set *GENERATION to the new
+   generation and start reading at STATUS_FILE's position, if it is from
+   that generation, and at the beginning of the journal otherwise.  Update
+   *VALID and clear CHANGED accordingly.
+
+   Add the relpaths recorded in the journal to CHANGED while *VALID, and
+   set *VALID to FALSE if the journal has been invalidated.  Advance
+   *OFFSET to the end of the cookie, if it has been found, and to the end
+   of the last complete line otherwise.
+
+   Set *FOUND to whether the cookie has been found.  Set *GENERATION to
+   NULL if the journal is missing or cannot be read. */
+static svn_error_t *
+scan_journal(svn_boolean_t *found,
+             const char **generation,
+             apr_off_t *offset,
+             svn_boolean_t *valid,
+             apr_hash_t *changed,
+             const char *journal_abspath,
+             const char *cookie,
+             const status_file_t *status_file,
+             apr_pool_t *result_pool,
+             apr_pool_t *scratch_pool)
+{
+  apr_file_t *file;
+  svn_stream_t *stream;
+  svn_stringbuf_t *header;
+  svn_stringbuf_t *contents;
+  const char *eol;
+  svn_boolean_t eof;
+  apr_off_t header_len;
+  const char *p, *end, *line;
+  apr_size_t len;
+  apr_size_t cookie_len = strlen(cookie);
+  apr_off_t offset_found;
+  svn_error_t *err;
+
+  *found = FALSE;
+
+  err = svn_io_file_open(&file, journal_abspath, APR_READ | APR_BUFFERED,
+                         APR_OS_DEFAULT, scratch_pool);
+  if (err && APR_STATUS_IS_ENOENT(err->apr_err))
+    {
+      svn_error_clear(err);
+      *generation = NULL;
+      return SVN_NO_ERROR;
+    }
+  SVN_ERR(err);
+
+  SVN_ERR(svn_io_file_readline(file, &header, &eol, &eof, 256,
+                               scratch_pool, scratch_pool));
+  if (eof
+      || strncmp(header->data, JOURNAL_FORMAT " ",
+                 strlen(JOURNAL_FORMAT " ")) != 0)
+    {
+      *generation = NULL;
+      return svn_error_trace(svn_io_file_close(file, scratch_pool));
+    }
+
+  header_len = header->len + 1;
+  if (!*generation
+      || strcmp(*generation, header->data + strlen(JOURNAL_FORMAT " ")) != 0)
+    {
+      *generation = apr_pstrdup(result_pool,
+                                header->data + strlen(JOURNAL_FORMAT " "));
+      *valid = (status_file
+                && strcmp(status_file->generation, *generation) == 0
+                && status_file->offset >= header_len);
+      *offset = *valid ? status_file->offset : header_len;
+      apr_hash_clear(changed);
+    }
+
+  offset_found = *offset;
+  SVN_ERR(svn_io_file_seek(file, APR_SET, &offset_found, scratch_pool));
+  stream = svn_stream_from_aprfile2(file, FALSE, scratch_pool);
+  SVN_ERR(svn_stringbuf_from_stream(&contents, stream, 0, scratch_pool));
+
+  p = contents->data;
+  end = p + contents->len;
+  while (next_line(&line, &len, &p, end))
+    {
+      if (len == 1 && line[0] == 'X')
+        {
+          *valid = FALSE;
+          apr_hash_clear(changed);
+        }
+      else if (len == cookie_len + 2 && line[0] == 'C'
+               && memcmp(line + 2, cookie, cookie_len) == 0)
+        {
+          *found = TRUE;
+          break;
+        }
+      else if (len >= 2 && line[0] == 'P' && *valid)
+        {
+          svn_hash_sets(changed,
+                        apr_pstrmemdup(result_pool, line + 2, len - 2), "");
+        }
+    }
+
+  *offset += (p - contents->data);
+
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_wc__journal_begin_status(svn_wc__journal_status_t **status_p,
+                             svn_wc__db_t *db,
+                             const char *local_abspath,
+                             const char *walk_key,
+                             apr_pool_t *result_pool,
+                             apr_pool_t *scratch_pool)
+{
+  struct svn_wc__journal_status_private_t *priv;
+  svn_wc__journal_status_t *status;
+  const char *wcroot_abspath;
+  const char *monitor_abspath;
+  const char *journal_abspath;
+  const char *cookie;
+  const char *cookie_abspath;
+  status_file_t *status_file;
+  apr_finfo_t finfo;
+  apr_file_t *file;
+  apr_hash_t *changed;
+  apr_pool_t *iterpool;
+  const char *generation = NULL;
+  apr_off_t offset = 0;
+  svn_boolean_t valid = FALSE;
+  svn_boolean_t found = FALSE;
+  apr_interval_time_t delay = apr_time_from_msec(1);
+  apr_time_t deadline;
+  svn_node_kind_t kind;
+  apr_hash_index_t *hi;
+  svn_error_t *err;
+  int i;
+
+  *status_p = NULL;
+
+  SVN_ERR(svn_wc__db_get_wcroot(&wcroot_abspath, db, local_abspath,
+                                result_pool, scratch_pool));
+  monitor_abspath = svn_wc__adm_child(wcroot_abspath, SVN_WC__ADM_MONITOR,
+                                      scratch_pool);
+  journal_abspath = svn_dirent_join(monitor_abspath, JOURNAL_FILE,
+                                    scratch_pool);
+
+  /* No monitor, the common case. */
+  SVN_ERR(svn_io_check_path(journal_abspath, &kind, scratch_pool));
+  if (kind != svn_node_file)
+    return SVN_NO_ERROR;
+
+  priv = apr_pcalloc(result_pool, sizeof(*priv));
+  priv->wcroot_abspath = wcroot_abspath;
+  priv->status_abspath = svn_dirent_join(monitor_abspath, JOURNAL_STATUS_FILE,
+                                         result_pool);
+  priv->walk_relpath = svn_dirent_skip_ancestor(wcroot_abspath,
+                                                local_abspath);
+  priv->walk_key = apr_pstrdup(result_pool, walk_key);
+
+  /* Any change to wc.db from here on will invalidate the status file. */
+  SVN_ERR(svn_io_stat(&finfo,
+                      svn_wc__adm_child(wcroot_abspath, SDB_FILE,
+                                        scratch_pool),
+                      APR_FINFO_MTIME | APR_FINFO_SIZE, scratch_pool));
+  priv->db_mtime = finfo.mtime;
+  priv->db_size = finfo.size;
+
+  SVN_ERR(read_status_file(&status_file, priv->status_abspath,
+                           scratch_pool, scratch_pool));
+  if (status_file
+      && (strcmp(status_file->walk_relpath, priv->walk_relpath) != 0
+          || strcmp(status_file->walk_key, priv->walk_key) != 0
+          || status_file->db_mtime != priv->db_mtime
+          || status_file->db_size != priv->db_size))
+    status_file = NULL;
+
+  /* Ask the monitor to tell us how far it got. */
+  cookie = apr_pstrcat(scratch_pool, SVN_WC__JOURNAL_COOKIE_PREFIX,
+                       svn_uuid_generate(scratch_pool), SVN_VA_NULL);
+  cookie_abspath = svn_dirent_join(monitor_abspath, cookie, scratch_pool);
+  err = svn_io_file_open(&file, cookie_abspath,
+                         APR_WRITE | APR_CREATE | APR_EXCL,
+                         APR_OS_DEFAULT, scratch_pool);
+  if (err)
+    {
+      /* E.g. a read-only working copy.  Just do a full walk. */
+      svn_error_clear(err);
+      return SVN_NO_ERROR;
+    }
+  SVN_ERR(svn_io_file_close(file, scratch_pool));
+
+  changed = apr_hash_make(scratch_pool);
+  deadline = apr_time_now() + COOKIE_TIMEOUT;
+  iterpool = svn_pool_create(scratch_pool);
+  while (TRUE)
+    {
+      svn_pool_clear(iterpool);
+
+      err = scan_journal(&found, &generation, &offset, &valid, changed,
+                         journal_abspath, cookie, status_file,
+                         scratch_pool, iterpool);
+      if (err)
+        {
+          /* Treat a journal we can't read like a missing one. */
+          svn_error_clear(err);
+          found = FALSE;
+          break;
+        }
+
+      if (found || !generation || apr_time_now() > deadline)
+        break;
+
+      apr_sleep(delay);
+      delay = MIN(2 * delay, COOKIE_MAX_DELAY);
+    }
+  svn_pool_destroy(iterpool);
+
+  SVN_ERR(svn_io_remove_file2(cookie_abspath, TRUE, scratch_pool));
+
+  if (!found)
+    {
+      apr_pool_t *lock_pool = svn_pool_create(scratch_pool);
+
+      /* If no monitor holds the lock anymore, the journal is stale and
+         just slows down every status walk. */
+      err = svn_io_file_lock2(svn_dirent_join(monitor_abspath,
+                                              JOURNAL_LOCK_FILE,
+                                              scratch_pool),
+                              FALSE, TRUE, lock_pool);
+      if (!err)
+        err = svn_io_remove_file2(journal_abspath, TRUE, scratch_pool);
+      svn_error_clear(err);
+      svn_pool_destroy(lock_pool);
+
+      return SVN_NO_ERROR;
+    }
+
+  priv->generation = generation;
+  priv->offset = offset;
+
+  /* A change to LOCAL_ABSPATH itself or to one of its ancestors, e.g. a
+     directory that got replaced or moved away and back, may affect every
+     node below it.  Only a full walk can find out. */
+  for (hi = valid ? apr_hash_first(scratch_pool, changed) : NULL;
+       hi;
+       hi = apr_hash_next(hi))
+    {
+      const char *abspath = svn_dirent_join(wcroot_abspath,
+                                            apr_hash_this_key(hi),
+                                            scratch_pool);
+
+      if (svn_dirent_is_ancestor(abspath, local_abspath))
+        {
+          valid = FALSE;
+          break;
+        }
+    }
+
+  status = apr_pcalloc(result_pool, sizeof(*status));
+  status->priv = priv;
+  status->valid = valid;
+  if (valid)
+    {
+      status->reported_nodes = apr_hash_make(result_pool);
+      for (i = 0; i < status_file->reported->nelts; i++)
+        {
+          const char *relpath = APR_ARRAY_IDX(status_file->reported, i,
+                                              const char *);
+
+          svn_hash_sets(status->reported_nodes,
+                        svn_dirent_join(wcroot_abspath, relpath,
+                                        result_pool),
+                        "");
+        }
+
+      status->changed_subtrees = apr_hash_make(result_pool);
+      for (hi = apr_hash_first(scratch_pool, changed);
+           hi;
+           hi = apr_hash_next(hi))
+        {
+          const char *abspath = svn_dirent_join(wcroot_abspath,
+                                                apr_hash_this_key(hi),
+                                                result_pool);
+
+          if (svn_dirent_is_ancestor(local_abspath, abspath))
+            svn_hash_sets(status->changed_subtrees, abspath, "");
+        }
+    }
+
+  *status_p = status;
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_wc__journal_end_status(svn_wc__journal_status_t *status,
+                           apr_hash_t *reported,
+                           apr_pool_t *scratch_pool)
+{
+  const struct svn_wc__journal_status_private_t *priv = status->priv;
+  svn_stringbuf_t *buf = svn_stringbuf_create_empty(scratch_pool);
+  apr_hash_index_t *hi;
+
+  svn_stringbuf_appendcstr(buf, STATUS_FORMAT "\n");
+  svn_stringbuf_appendcstr(buf,
+                           apr_psprintf(scratch_pool,
+                                        "G %s\n"
+                                        "O %" APR_OFF_T_FMT "\n"
+                                        "T %" APR_TIME_T_FMT "\n"
+                                        "S %" APR_OFF_T_FMT "\n"
+                                        "W %s\n"
+                                        "K %s\n",
+                                        priv->generation, priv->offset,
+                                        priv->db_mtime, priv->db_size,
+                                        priv->walk_relpath, priv->walk_key));
+
+  for (hi = apr_hash_first(scratch_pool, reported); hi; hi = apr_hash_next(hi))
+    {
+      const char *relpath = svn_dirent_skip_ancestor(priv->wcroot_abspath,
+                                                     apr_hash_this_key(hi));
+
+      /* Can't store this, so make sure the next walk is a full walk. */
+      if (!relpath || strchr(relpath, '\n'))
+        return svn_error_trace(svn_io_remove_file2(priv->status_abspath,
+                                                   TRUE, scratch_pool));
+
+      svn_stringbuf_appendbyte(buf, 'R');
+      svn_stringbuf_appendbyte(buf, ' ');
+      svn_stringbuf_appendcstr(buf, relpath);
+      svn_stringbuf_appendbyte(buf, '\n');
+    }
+
+  return svn_error_trace(svn_io_write_atomic2(priv->status_abspath,
+                                              buf->data, buf->len, NULL,
+                                              FALSE, scratch_pool));
+}
@@ -0,0 +1,96 @@
+/*
+ * journal.h :  reading the change journal during status walks
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#ifndef SVN_WC_JOURNAL_H
+#define SVN_WC_JOURNAL_H
+
+#include <apr_pools.h>
+#include <apr_hash.h>
+
+#include "svn_types.h"
+
+#include "wc_db.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+
+/* The state of a status walk that is backed by the change journal.
+
+   The journal is written by a file system monitor, see
+   svn_wc__journal_open().  After each status walk, the position in the
+   journal up to which all changes have been seen is stored in the
+   administrative area together with the list of nodes that were reported.
+   The next status walk then only needs to check those nodes plus
+   everything the journal recorded after that position. */
+typedef struct svn_wc__journal_status_t
+{
+  /* Whether the journal covers all changes since the previous status walk
+     with the same parameters.  If FALSE, a full walk is required. */
+  svn_boolean_t valid;
+
+  /* If VALID, the nodes reported by the previous status walk, mapping
+     const char * absolute paths to "".  They must be checked again. */
+  apr_hash_t *reported_nodes;
+
+  /* If VALID, the nodes that changed since the previous status walk,
+     mapping const char * absolute paths to "".  Their entire subtrees must
+     be checked. */
+  apr_hash_t *changed_subtrees;
+
+  /* Private state. */
+  struct svn_wc__journal_status_private_t *priv;
+} svn_wc__journal_status_t;
+
+/* Prepare a status walk of LOCAL_ABSPATH, a versioned directory in DB,
+   with parameters identified by WALK_KEY, using the change journal of its
+   working copy.
+
+   Set *STATUS_P to NULL if there is no journal or its monitor does not
+   respond.  Otherwise set it to the journal state, whose VALID flag tells
+   whether the walk may be restricted to the nodes that need checking.
+
+   Allocate *STATUS_P in RESULT_POOL and use SCRATCH_POOL for temporary
+   allocations. */
+svn_error_t *
+svn_wc__journal_begin_status(svn_wc__journal_status_t **status_p,
+                             svn_wc__db_t *db,
+                             const char *local_abspath,
+                             const char *walk_key,
+                             apr_pool_t *result_pool,
+                             apr_pool_t *scratch_pool);
+
+/* Complete the successful status walk prepared by
+   svn_wc__journal_begin_status() and returned in STATUS.  REPORTED maps
+   the const char * absolute paths of all reported nodes to "". */
+svn_error_t *
+svn_wc__journal_end_status(svn_wc__journal_status_t *status,
+                           apr_hash_t *reported,
+                           apr_pool_t *scratch_pool);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* SVN_WC_JOURNAL_H */
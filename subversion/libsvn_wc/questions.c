@@ -95,6 +95,11 @@
  * PROPS_MOD should be TRUE if the file's properties have been changed,
  * otherwise FALSE.
  *
+ * PRISTINE_CHECKSUM is the checksum of PRISTINE_STREAM.  If WORKING_CHECKSUM
+ * is not NULL, it is the checksum of the untranslated contents of
+ * VERSIONED_FILE_ABSPATH.  If no translation is required and both checksums
+ * are of the same kind, compare them instead of reading the files.
+ *
  * PRISTINE_STREAM will be closed before a successful return.
  *
  * DB is a wc_db; use SCRATCH_POOL for temporary allocation.
@@ -106,8 +111,10 @@ compare_and_verify(svn_boolean_t *modified_p,
                    svn_filesize_t versioned_file_size,
                    svn_stream_t *pristine_stream,
                    svn_filesize_t pristine_size,
+                   const svn_checksum_t *pristine_checksum,
                    svn_boolean_t has_props,
                    svn_boolean_t props_mod,
+                   const svn_checksum_t *working_checksum,
                    svn_boolean_t exact_comparison,
                    apr_pool_t *scratch_pool)
 {
@@ -149,6 +156,16 @@ compare_and_verify(svn_boolean_t *modified_p,
       return svn_error_trace(svn_stream_close(pristine_stream));
     }
 
+  /* Someone already read the working file for us? */
+  if (! need_translation
+      && working_checksum
+      && working_checksum->kind == pristine_checksum->kind)
+    {
+      *modified_p = ! svn_checksum_match(working_checksum, pristine_checksum);
+
+      return svn_error_trace(svn_stream_close(pristine_stream));
+    }
+
   /* ### Other checks possible? */
 
   /* Reading files is necessary. */
@@ -206,12 +223,16 @@ compare_and_verify(svn_boolean_t *modified_p,
   return SVN_NO_ERROR;
 }
 
-svn_error_t *
-svn_wc__internal_file_modified_p(svn_boolean_t *modified_p,
-                                 svn_wc__db_t *db,
-                                 const char *local_abspath,
-                                 svn_boolean_t exact_comparison,
-                                 apr_pool_t *scratch_pool)
+/* Implements svn_wc__internal_file_modified_p() and
+   svn_wc__internal_file_modified_checksum_p(), the former passing NULL for
+   WORKING_CHECKSUM. */
+static svn_error_t *
+file_modified_p(svn_boolean_t *modified_p,
+                svn_wc__db_t *db,
+                const char *local_abspath,
+                const svn_checksum_t *working_checksum,
+                svn_boolean_t exact_comparison,
+                apr_pool_t *scratch_pool)
 {
   svn_stream_t *pristine_stream;
   svn_filesize_t pristine_size;
@@ -311,8 +332,8 @@ svn_wc__internal_file_modified_p(svn_boolean_t *modified_p,
     svn_error_t *err;
     err = compare_and_verify(modified_p, db,
                              local_abspath, dirent->filesize,
-                             pristine_stream, pristine_size,
-                             has_props, props_mod,
+                             pristine_stream, pristine_size, checksum,
+                             has_props, props_mod, working_checksum,
                              exact_comparison,
                              scratch_pool);
 
@@ -341,6 +362,29 @@ svn_wc__internal_file_modified_p(svn_boolean_t *modified_p,
   return SVN_NO_ERROR;
 }
 
+svn_error_t *
+svn_wc__internal_file_modified_p(svn_boolean_t *modified_p,
+                                 svn_wc__db_t *db,
+                                 const char *local_abspath,
+                                 svn_boolean_t exact_comparison,
+                                 apr_pool_t *scratch_pool)
+{
+  return svn_error_trace(file_modified_p(modified_p, db, local_abspath,
+                                         NULL, exact_comparison,
+                                         scratch_pool));
+}
+
+svn_error_t *
+svn_wc__internal_file_modified_checksum_p(svn_boolean_t *modified_p,
+                                          svn_wc__db_t *db,
+                                          const char *local_abspath,
+                                          const svn_checksum_t *checksum,
+                                          apr_pool_t *scratch_pool)
+{
+  return svn_error_trace(file_modified_p(modified_p, db, local_abspath,
+                                         checksum, FALSE, scratch_pool));
+}
+
 
 svn_error_t *
 svn_wc_text_modified_p2(svn_boolean_t *modified_p,
@@ -37,6 +37,7 @@
 #include "svn_error.h"
 #include "svn_dirent_uri.h"
 #include "svn_io.h"
+#include "svn_checksum.h"
 #include "svn_config.h"
 #include "svn_time.h"
 #include "svn_hash.h"
@@ -46,11 +47,13 @@
 
 #include "wc.h"
 #include "props.h"
+#include "journal.h"
 
 #include "private/svn_sorts_private.h"
 #include "private/svn_wc_private.h"
 #include "private/svn_fspath.h"
 #include "private/svn_editor.h"
+#include "private/svn_parallel.h"
 
 
 /* The file internal variant of svn_wc_status3_t, with slightly more
@@ -100,6 +103,29 @@ struct walk_status_baton
 
   /* Repository locks, if set. */
   apr_hash_t *repos_locks;
+
+  /*** Change journal handling ***/
+  /* If not NULL, restrict the walk to the directories in this hash, each
+     mapped to an apr_hash_t * of the names of the children to check. */
+  apr_hash_t *journal_children;
+
+  /* The nodes whose entire subtree must be checked, mapping absolute
+     paths to "".  Only used with JOURNAL_CHILDREN. */
+  apr_hash_t *journal_subtrees;
+
+  /*** Parallel prefetching ***/
+  /* The number of threads reading directories and files ahead of the
+     walk.  Prefetching is disabled if this is 1. */
+  int thread_count;
+
+  /* Directories that have been read ahead, mapping absolute paths to
+     apr_hash_t * results of svn_io_get_dirents3().  Entries are owned by
+     the get_dir_status() call of the parent directory. */
+  apr_hash_t *prefetched_dirents;
+
+  /* Checksums of files whose text may have changed, mapping absolute paths
+     to svn_checksum_t *.  Entries are owned like PREFETCHED_DIRENTS. */
+  apr_hash_t *working_checksums;
 };
 
 /*** Editor batons ***/
@@ -334,6 +360,9 @@ internal_status(svn_wc__internal_status_t **status,
    do not adjust the result for missing working copy files.
 
    The status struct's repos_lock field will be set to REPOS_LOCK.
+
+   WORKING_CHECKSUM is the checksum of the file LOCAL_ABSPATH if it has
+   already been calculated, NULL otherwise.
 */
 static svn_error_t *
 assemble_status(svn_wc__internal_status_t **status,
@@ -348,6 +377,7 @@ assemble_status(svn_wc__internal_status_t **status,
                 svn_boolean_t ignore_text_mods,
                 svn_boolean_t check_working_copy,
                 const svn_lock_t *repos_lock,
+                const svn_checksum_t *working_checksum,
                 apr_pool_t *result_pool,
                 apr_pool_t *scratch_pool)
 {
@@ -471,9 +501,11 @@ assemble_status(svn_wc__internal_status_t **status,
           else
             {
               svn_error_t *err;
-              err = svn_wc__internal_file_modified_p(&text_modified_p,
+              err = svn_wc__internal_file_modified_checksum_p(
+                                                     &text_modified_p,
                                                      db, local_abspath,
-                                                     FALSE, scratch_pool);
+                                                     working_checksum,
+                                                     scratch_pool);
 
               if (err)
                 {
@@ -831,7 +863,9 @@ send_status_structure(const struct walk_status_baton *wb,
                           parent_repos_uuid,
                           info, dirent, get_all,
                           wb->ignore_text_mods, wb->check_working_copy,
-                          repos_lock, scratch_pool, scratch_pool));
+                          repos_lock,
+                          svn_hash_gets(wb->working_checksums, local_abspath),
+                          scratch_pool, scratch_pool));
 
   if (statstruct && status_func)
     return svn_error_trace((*status_func)(status_baton, local_abspath,
@@ -1188,6 +1222,248 @@ one_child_status(const struct walk_status_baton *wb,
   return SVN_NO_ERROR;
 }
 
+/* Set *DIRENTS to the dirents of the children of LOCAL_ABSPATH whose names
+   are the keys of NAMES, like svn_io_get_dirents3() would, but without
+   reading the directory.  Allocate *DIRENTS in RESULT_POOL. */
+static svn_error_t *
+stat_journal_children(apr_hash_t **dirents,
+                      const char *local_abspath,
+                      apr_hash_t *names,
+                      apr_pool_t *result_pool,
+                      apr_pool_t *scratch_pool)
+{
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  apr_hash_index_t *hi;
+
+  *dirents = apr_hash_make(result_pool);
+  for (hi = apr_hash_first(scratch_pool, names); hi; hi = apr_hash_next(hi))
+    {
+      const char *name = apr_hash_this_key(hi);
+      const svn_io_dirent2_t *dirent;
+
+      svn_pool_clear(iterpool);
+
+      SVN_ERR(svn_io_stat_dirent2(&dirent,
+                                  svn_dirent_join(local_abspath, name,
+                                                  iterpool),
+                                  FALSE, TRUE, result_pool, iterpool));
+      if (dirent->kind != svn_node_none)
+        svn_hash_sets(*dirents, name, dirent);
+    }
+
+  svn_pool_destroy(iterpool);
+  return SVN_NO_ERROR;
+}
+
+/* A directory listing or a file checksum to be read by a worker thread
+   ahead of the status walk. */
+typedef struct prefetch_task_t
+{
+  /* The node to read. */
+  const char *local_abspath;
+
+  /* TRUE to read the directory LOCAL_ABSPATH, FALSE to calculate the
+     SHA-1 checksum of the file LOCAL_ABSPATH. */
+  svn_boolean_t is_dir;
+} prefetch_task_t;
+
+/* Baton for prefetch_task() and prefetch_output(). */
+typedef struct prefetch_baton_t
+{
+  /* The tasks to run, of prefetch_task_t. */
+  apr_array_header_t *tasks;
+
+  /* Passed to svn_io_get_dirents3(). */
+  svn_boolean_t only_check_type;
+
+  /* Where to store the results and what pool to allocate them in. */
+  const struct walk_status_baton *wb;
+  apr_pool_t *result_pool;
+} prefetch_baton_t;
+
+/* Implements svn_parallel__task_func_t.  This may run on any thread and
+   must not touch the walk status baton. */
+static svn_error_t *
+prefetch_task(void **result,
+              void *baton,
+              int idx,
+              svn_cancel_func_t cancel_func,
+              void *cancel_baton,
+              apr_pool_t *result_pool,
+              apr_pool_t *scratch_pool)
+{
+  prefetch_baton_t *b = baton;
+  const prefetch_task_t *task = &APR_ARRAY_IDX(b->tasks, idx,
+                                               prefetch_task_t);
+
+  if (task->is_dir)
+    {
+      apr_hash_t *dirents;
+
+      SVN_ERR(svn_io_get_dirents3(&dirents, task->local_abspath,
+                                  b->only_check_type,
+                                  result_pool, scratch_pool));
+      *result = dirents;
+    }
+  else
+    {
+      svn_checksum_t *checksum;
+
+      SVN_ERR(svn_io_file_checksum2(&checksum, task->local_abspath,
+                                    svn_checksum_sha1, result_pool));
+      *result = checksum;
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_parallel__output_func_t, storing the result in the walk
+   status baton. */
+static svn_error_t *
+prefetch_output(void *baton,
+                int idx,
+                void *result,
+                svn_error_t *task_err,
+                apr_pool_t *scratch_pool)
+{
+  prefetch_baton_t *b = baton;
+  const prefetch_task_t *task = &APR_ARRAY_IDX(b->tasks, idx,
+                                               prefetch_task_t);
+
+  /* The walk will simply read the node itself and report the error, if it
+     still occurs at that point. */
+  if (task_err)
+    {
+      svn_error_clear(task_err);
+      return SVN_NO_ERROR;
+    }
+
+  if (task->is_dir)
+    {
+      apr_hash_t *dirents = apr_hash_make(b->result_pool);
+      apr_hash_index_t *hi;
+
+      for (hi = apr_hash_first(scratch_pool, result);
+           hi;
+           hi = apr_hash_next(hi))
+        svn_hash_sets(dirents,
+                      apr_pstrdup(b->result_pool, apr_hash_this_key(hi)),
+                      svn_io_dirent2_dup(apr_hash_this_val(hi),
+                                         b->result_pool));
+
+      svn_hash_sets(b->wb->prefetched_dirents, task->local_abspath, dirents);
+    }
+  else
+    svn_hash_sets(b->wb->working_checksums, task->local_abspath,
+                  svn_checksum_dup(result, b->result_pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Using WB->THREAD_COUNT threads, read the versioned subdirectories of
+   LOCAL_ABSPATH that a walk of DEPTH will descend into and calculate the
+   checksums of its files whose text needs to be compared, according to
+   NODES and DIRENTS as used by get_dir_status().  Store the results in
+   WB->PREFETCHED_DIRENTS and WB->WORKING_CHECKSUMS, allocated in
+   RESULT_POOL.
+
+   Set *TASKS to the prefetch_task_t of all nodes that have been read, for
+   use with forget_prefetched().  Allocate *TASKS in RESULT_POOL and use
+   SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+prefetch_children(apr_array_header_t **tasks,
+                  const struct walk_status_baton *wb,
+                  const char *local_abspath,
+                  apr_hash_t *nodes,
+                  apr_hash_t *dirents,
+                  svn_depth_t depth,
+                  svn_cancel_func_t cancel_func,
+                  void *cancel_baton,
+                  apr_pool_t *result_pool,
+                  apr_pool_t *scratch_pool)
+{
+  prefetch_baton_t baton;
+  apr_hash_index_t *hi;
+
+  *tasks = apr_array_make(result_pool, 0, sizeof(prefetch_task_t));
+
+  for (hi = apr_hash_first(scratch_pool, nodes); hi; hi = apr_hash_next(hi))
+    {
+      const char *name = apr_hash_this_key(hi);
+      const struct svn_wc__db_info_t *info = apr_hash_this_val(hi);
+      const svn_io_dirent2_t *dirent = svn_hash_gets(dirents, name);
+      prefetch_task_t task;
+
+      if (!dirent
+          || dirent->special
+          || info->status == svn_wc__db_status_not_present
+          || info->status == svn_wc__db_status_excluded
+          || info->status == svn_wc__db_status_server_excluded)
+        continue;
+
+      /* Directories that get_dir_status() will recurse into. */
+      if (depth == svn_depth_infinity
+          && info->kind == svn_node_dir
+          && info->has_descendants
+          && dirent->kind == svn_node_dir)
+        task.is_dir = TRUE;
+
+      /* Files for which assemble_status() will have to read the text.
+         Only files without properties qualify as their text needs no
+         translation and a changed size means modified without reading. */
+      else if (!wb->ignore_text_mods
+               && info->kind == svn_node_file
+               && dirent->kind == svn_node_file
+               && (info->status == svn_wc__db_status_normal
+                   || info->status == svn_wc__db_status_added)
+               && info->has_checksum
+               && !info->had_props
+               && !info->props_mod
+               && (info->recorded_size == SVN_INVALID_FILESIZE
+                   || info->recorded_size == dirent->filesize)
+               && info->recorded_time != dirent->mtime)
+        task.is_dir = FALSE;
+      else
+        continue;
+
+      task.local_abspath = svn_dirent_join(local_abspath, name, result_pool);
+      APR_ARRAY_PUSH(*tasks, prefetch_task_t) = task;
+    }
+
+  if ((*tasks)->nelts == 0)
+    return SVN_NO_ERROR;
+
+  baton.tasks = *tasks;
+  baton.only_check_type = wb->ignore_text_mods;
+  baton.wb = wb;
+  baton.result_pool = result_pool;
+
+  return svn_error_trace(svn_parallel__run((*tasks)->nelts, wb->thread_count,
+                                           0, prefetch_task, &baton,
+                                           prefetch_output, &baton,
+                                           cancel_func, cancel_baton,
+                                           scratch_pool));
+}
+
+/* Remove the unused results of the TASKS returned by prefetch_children()
+   from WB. */
+static void
+forget_prefetched(const struct walk_status_baton *wb,
+                  const apr_array_header_t *tasks)
+{
+  int i;
+
+  for (i = 0; i < tasks->nelts; i++)
+    {
+      const prefetch_task_t *task = &APR_ARRAY_IDX(tasks, i, prefetch_task_t);
+
+      if (task->is_dir)
+        svn_hash_sets(wb->prefetched_dirents, task->local_abspath, NULL);
+      else
+        svn_hash_sets(wb->working_checksums, task->local_abspath, NULL);
+    }
+}
+
 /* Send svn_wc_status3_t * structures for the directory LOCAL_ABSPATH and
    for all its child nodes (according to DEPTH) through STATUS_FUNC /
    STATUS_BATON.
@@ -1206,6 +1482,9 @@ one_child_status(const struct walk_status_baton *wb,
    DIRENT is LOCAL_ABSPATH's own dirent and is only needed if it is reported,
    so if SKIP_THIS_DIR is TRUE, DIRENT can be left NULL.
 
+   If WB->JOURNAL_CHILDREN is set, only check the children listed there,
+   unless LOCAL_ABSPATH is one of WB->JOURNAL_SUBTREES.
+
    Other arguments are the same as those passed to
    svn_wc_get_status_editor5().  */
 static svn_error_t *
@@ -1233,6 +1512,9 @@ get_dir_status(const struct walk_status_baton *wb,
   apr_hash_t *dirents, *nodes, *conflicts, *all_children;
   apr_array_header_t *sorted_children;
   apr_array_header_t *collected_ignore_patterns = NULL;
+  apr_hash_t *journal_names = NULL;
+  apr_array_header_t *prefetched = NULL;
+  struct walk_status_baton subtree_wb;
   apr_pool_t *iterpool;
   svn_error_t *err;
   int i;
@@ -1243,9 +1525,44 @@ get_dir_status(const struct walk_status_baton *wb,
   if (depth == svn_depth_unknown)
     depth = svn_depth_infinity;
 
+  if (wb->journal_children
+      && svn_hash_gets(wb->journal_subtrees, local_abspath))
+    {
+      /* Anything below this directory may have changed. */
+      subtree_wb = *wb;
+      subtree_wb.journal_children = NULL;
+      subtree_wb.journal_subtrees = NULL;
+      wb = &subtree_wb;
+    }
+  else if (wb->journal_children)
+    {
+      journal_names = svn_hash_gets(wb->journal_children, local_abspath);
+
+      /* Nothing to check below this directory? */
+      if (!journal_names)
+        {
+          if (skip_this_dir)
+            return SVN_NO_ERROR;
+
+          journal_names = apr_hash_make(scratch_pool);
+        }
+    }
+
   iterpool = svn_pool_create(scratch_pool);
 
-  if (wb->check_working_copy)
+  if (wb->check_working_copy && journal_names)
+    {
+      SVN_ERR(stat_journal_children(&dirents, local_abspath, journal_names,
+                                    scratch_pool, iterpool));
+    }
+  else if (wb->check_working_copy
+           && svn_hash_gets(wb->prefetched_dirents, local_abspath))
+    {
+      /* Read by our parent's get_dir_status(), which owns the memory. */
+      dirents = svn_hash_gets(wb->prefetched_dirents, local_abspath);
+      svn_hash_sets(wb->prefetched_dirents, local_abspath, NULL);
+    }
+  else if (wb->check_working_copy)
     {
       err = svn_io_get_dirents3(&dirents, local_abspath,
                                 wb->ignore_text_mods /* only_check_type*/,
@@ -1287,6 +1604,24 @@ get_dir_status(const struct walk_status_baton *wb,
   if (apr_hash_count(conflicts) > 0)
     all_children = apr_hash_overlay(scratch_pool, conflicts, all_children);
 
+  if (journal_names)
+    {
+      apr_hash_t *journal_children = apr_hash_make(scratch_pool);
+      apr_hash_index_t *hi;
+
+      for (hi = apr_hash_first(scratch_pool, journal_names);
+           hi;
+           hi = apr_hash_next(hi))
+        {
+          const char *name = apr_hash_this_key(hi);
+
+          if (svn_hash_gets(all_children, name))
+            svn_hash_sets(journal_children, name, "");
+        }
+
+      all_children = journal_children;
+    }
+
   /* Handle "this-dir" first. */
   if (! skip_this_dir)
     {
@@ -1336,6 +1671,13 @@ get_dir_status(const struct walk_status_baton *wb,
   if (depth == svn_depth_empty)
     return SVN_NO_ERROR;
 
+  /* Read the subdirectories we will descend into and the files whose text
+     must be compared concurrently instead of one after the other. */
+  if (wb->thread_count > 1 && wb->check_working_copy && !journal_names)
+    SVN_ERR(prefetch_children(&prefetched, wb, local_abspath, nodes, dirents,
+                              depth, cancel_func, cancel_baton,
+                              scratch_pool, iterpool));
+
   /* Walk all the children of this directory. */
   sorted_children = svn_sort__hash(all_children,
                                    svn_sort_compare_items_lexically,
@@ -1381,6 +1723,9 @@ get_dir_status(const struct walk_status_baton *wb,
                                iterpool));
     }
 
+  if (prefetched)
+    forget_prefetched(wb, prefetched);
+
   /* Destroy our subpools. */
   svn_pool_destroy(iterpool);
 
@@ -2513,6 +2858,11 @@ svn_wc__get_status_editor(const svn_delta_editor_t **editor,
   eb->wb.check_working_copy = check_working_copy;
   eb->wb.repos_locks      = NULL;
   eb->wb.repos_root       = NULL;
+  eb->wb.journal_children = NULL;
+  eb->wb.journal_subtrees = NULL;
+  eb->wb.thread_count     = svn_wc__db_get_status_threads(wc_ctx->db);
+  eb->wb.prefetched_dirents = apr_hash_make(result_pool);
+  eb->wb.working_checksums = apr_hash_make(result_pool);
 
   SVN_ERR(svn_wc__db_externals_defined_below(&eb->wb.externals,
                                              wc_ctx->db, eb->target_abspath,
@@ -2619,6 +2969,125 @@ stat_wc_dirent_case_sensitive(const svn_io_dirent2_t **dirent,
                                 result_pool, scratch_pool));
 }
 
+/* Set *KEY to a string identifying the parameters of a status walk that
+   affect which nodes it reports, allocated in RESULT_POOL. */
+static svn_error_t *
+journal_walk_key(const char **key,
+                 svn_boolean_t no_ignore,
+                 svn_boolean_t ignore_text_mods,
+                 const apr_array_header_t *ignore_patterns,
+                 apr_pool_t *result_pool)
+{
+  svn_stringbuf_t *patterns = svn_stringbuf_create_empty(result_pool);
+  svn_checksum_t *checksum;
+  int i;
+
+  for (i = 0; i < ignore_patterns->nelts; i++)
+    {
+      svn_stringbuf_appendcstr(patterns, APR_ARRAY_IDX(ignore_patterns, i,
+                                                       const char *));
+      svn_stringbuf_appendbyte(patterns, '\n');
+    }
+
+  SVN_ERR(svn_checksum(&checksum, svn_checksum_md5,
+                       patterns->data, patterns->len, result_pool));
+
+  *key = apr_psprintf(result_pool, "%d %d %s", no_ignore, ignore_text_mods,
+                      svn_checksum_to_cstring_display(checksum,
+                                                      result_pool));
+  return SVN_NO_ERROR;
+}
+
+/* Add LOCAL_ABSPATH and its ancestors up to the walk's TARGET_ABSPATH to
+   the JOURNAL_CHILDREN hash described for walk_status_baton.  Allocate
+   new entries in RESULT_POOL. */
+static void
+add_journal_child(apr_hash_t *journal_children,
+                  const char *target_abspath,
+                  const char *local_abspath,
+                  apr_pool_t *result_pool)
+{
+  if (!svn_dirent_is_ancestor(target_abspath, local_abspath))
+    return;
+
+  while (strcmp(local_abspath, target_abspath) != 0)
+    {
+      const char *parent_abspath = svn_dirent_dirname(local_abspath,
+                                                      result_pool);
+      const char *name = svn_dirent_basename(local_abspath, NULL);
+      apr_hash_t *names = svn_hash_gets(journal_children, parent_abspath);
+
+      if (!names)
+        {
+          names = apr_hash_make(result_pool);
+          svn_hash_sets(journal_children, parent_abspath, names);
+        }
+      else if (svn_hash_gets(names, name))
+        break; /* The ancestors have been added before. */
+
+      svn_hash_sets(names, name, "");
+      local_abspath = parent_abspath;
+    }
+}
+
+/* Restrict the walk WB to the nodes that JOURNAL says need checking.
+   Allocate the filter in RESULT_POOL. */
+static void
+setup_journal_walk(struct walk_status_baton *wb,
+                   const svn_wc__journal_status_t *journal,
+                   apr_pool_t *result_pool)
+{
+  apr_hash_index_t *hi;
+
+  /* Nothing to win? */
+  if (svn_hash_gets(journal->changed_subtrees, wb->target_abspath))
+    return;
+
+  wb->journal_children = apr_hash_make(result_pool);
+  wb->journal_subtrees = journal->changed_subtrees;
+
+  for (hi = apr_hash_first(result_pool, journal->reported_nodes);
+       hi;
+       hi = apr_hash_next(hi))
+    add_journal_child(wb->journal_children, wb->target_abspath,
+                      apr_hash_this_key(hi), result_pool);
+
+  for (hi = apr_hash_first(result_pool, journal->changed_subtrees);
+       hi;
+       hi = apr_hash_next(hi))
+    add_journal_child(wb->journal_children, wb->target_abspath,
+                      apr_hash_this_key(hi), result_pool);
+}
+
+/* Baton for journal_status_func(). */
+struct journal_status_baton
+{
+  /* The wrapped status function and baton. */
+  svn_wc_status_func4_t status_func;
+  void *status_baton;
+
+  /* The absolute paths of all reported nodes, mapped to "". */
+  apr_hash_t *reported;
+};
+
+/* Implements svn_wc_status_func4_t.  Remember LOCAL_ABSPATH for the next
+   journal based walk and pass STATUS on. */
+static svn_error_t *
+journal_status_func(void *baton,
+                    const char *local_abspath,
+                    const svn_wc_status3_t *status,
+                    apr_pool_t *scratch_pool)
+{
+  struct journal_status_baton *jsb = baton;
+
+  svn_hash_sets(jsb->reported,
+                apr_pstrdup(apr_hash_pool_get(jsb->reported), local_abspath),
+                "");
+
+  return svn_error_trace(jsb->status_func(jsb->status_baton, local_abspath,
+                                          status, scratch_pool));
+}
+
 svn_error_t *
 svn_wc__internal_walk_status(svn_wc__db_t *db,
                              const char *local_abspath,
@@ -2644,6 +3113,11 @@ svn_wc__internal_walk_status(svn_wc__db_t *db,
   wb.check_working_copy = TRUE;
   wb.repos_root = NULL;
   wb.repos_locks = NULL;
+  wb.journal_children = NULL;
+  wb.journal_subtrees = NULL;
+  wb.thread_count = svn_wc__db_get_status_threads(db);
+  wb.prefetched_dirents = apr_hash_make(scratch_pool);
+  wb.working_checksums = apr_hash_make(scratch_pool);
 
   /* Use the caller-provided ignore patterns if provided; the build-time
      configured defaults otherwise. */
@@ -2690,6 +3164,35 @@ svn_wc__internal_walk_status(svn_wc__db_t *db,
       && info->status != svn_wc__db_status_excluded
       && info->status != svn_wc__db_status_server_excluded)
     {
+      svn_wc__journal_status_t *journal = NULL;
+      struct journal_status_baton jsb;
+
+      /* Only the nodes reported by a previous walk and the ones changed
+         since can be interesting.  That's not true for other walks. */
+      if (!get_all
+          && (depth == svn_depth_infinity || depth == svn_depth_unknown))
+        {
+          const char *walk_key;
+
+          SVN_ERR(journal_walk_key(&walk_key, no_ignore, ignore_text_mods,
+                                   ignore_patterns, scratch_pool));
+          SVN_ERR(svn_wc__journal_begin_status(&journal, db, local_abspath,
+                                               walk_key,
+                                               scratch_pool, scratch_pool));
+        }
+
+      if (journal)
+        {
+          if (journal->valid)
+            setup_journal_walk(&wb, journal, scratch_pool);
+
+          jsb.status_func = status_func;
+          jsb.status_baton = status_baton;
+          jsb.reported = apr_hash_make(scratch_pool);
+          status_func = journal_status_func;
+          status_baton = &jsb;
+        }
+
       SVN_ERR(get_dir_status(&wb,
                              local_abspath,
                              FALSE /* skip_root */,
@@ -2703,6 +3206,10 @@ svn_wc__internal_walk_status(svn_wc__db_t *db,
                              status_func, status_baton,
                              cancel_func, cancel_baton,
                              scratch_pool));
+
+      if (journal)
+        SVN_ERR(svn_wc__journal_end_status(journal, jsb.reported,
+                                           scratch_pool));
     }
   else
     {
@@ -2901,6 +3408,7 @@ internal_status(svn_wc__internal_status_t **status,
                                          TRUE /* get_all */,
                                          FALSE, check_working_copy,
                                          NULL /* repos_lock */,
+                                         NULL /* working_checksum */,
                                          result_pool, scratch_pool));
 }
 
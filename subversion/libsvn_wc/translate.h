@@ -158,6 +158,28 @@ svn_wc__sync_flags_with_props(svn_boolean_t *did_set,
                               const char *local_abspath,
                               apr_pool_t *scratch_pool);
 
+/* Set *STREAM to a readable stream that returns the contents of the
+   working file LOCAL_ABSPATH translated to normal form, according to the
+   translation settings STYLE, EOL, KEYWORDS and SPECIAL as returned by
+   svn_wc__get_translate_info().  REPAIR_FORCED is as for
+   SVN_WC_TRANSLATE_FORCE_EOL_REPAIR.
+
+   Unlike svn_wc__internal_translated_stream(), this does not access the
+   working copy database, so it may be used in any thread.
+
+   Allocate *STREAM in RESULT_POOL and use SCRATCH_POOL for temporary
+   allocations. */
+svn_error_t *
+svn_wc__translated_stream_to_nf(svn_stream_t **stream,
+                                const char *local_abspath,
+                                svn_subst_eol_style_t style,
+                                const char *eol,
+                                apr_hash_t *keywords,
+                                svn_boolean_t special,
+                                svn_boolean_t repair_forced,
+                                apr_pool_t *result_pool,
+                                apr_pool_t *scratch_pool);
+
 /* Internal version of svn_wc_translated_stream2(), which see. */
 svn_error_t *
 svn_wc__internal_translated_stream(svn_stream_t **stream,
@@ -1301,6 +1301,10 @@ open_root(void *edit_baton,
                                                         db->new_repos_relpath,
                                                         *eb->target_revision,
                                                         pool));
+
+      /* The children will be opened one by one. */
+      SVN_ERR(svn_wc__db_prefetch_children(eb->db, db->local_abspath,
+                                           db->pool, pool));
     }
 
   return SVN_NO_ERROR;
@@ -2358,6 +2362,10 @@ open_directory(const char *path,
                                                     *eb->target_revision,
                                                     pool));
 
+  /* The children will be opened one by one. */
+  SVN_ERR(svn_wc__db_prefetch_children(eb->db, db->local_abspath,
+                                       db->pool, pool));
+
   return SVN_NO_ERROR;
 }
 
@@ -288,6 +288,7 @@ struct svn_wc_traversal_info_t
 #define SVN_WC__ADM_TMP                 "tmp"
 #define SVN_WC__ADM_PRISTINE            "pristine"
 #define SVN_WC__ADM_NONEXISTENT_PATH    "nonexistent-path"
+#define SVN_WC__ADM_MONITOR             "monitor"
 
 /* The basename of the ".prej" file, if a directory ever has property
    conflicts.  This .prej file will appear *within* the conflicted
@@ -348,6 +349,19 @@ svn_wc__internal_file_modified_p(svn_boolean_t *modified_p,
                                  svn_boolean_t exact_comparison,
                                  apr_pool_t *scratch_pool);
 
+/* Like svn_wc__internal_file_modified_p() with EXACT_COMPARISON set to
+ * FALSE, but CHECKSUM, if not NULL, is the checksum of the current contents
+ * of LOCAL_ABSPATH, e.g. calculated ahead of time by another thread.  If
+ * the file needs no translation, CHECKSUM is compared to the checksum of
+ * the pristine text instead of reading the file.
+ */
+svn_error_t *
+svn_wc__internal_file_modified_checksum_p(svn_boolean_t *modified_p,
+                                          svn_wc__db_t *db,
+                                          const char *local_abspath,
+                                          const svn_checksum_t *checksum,
+                                          apr_pool_t *scratch_pool);
+
 
 /* Prepare to merge a file content change into the working copy.
 
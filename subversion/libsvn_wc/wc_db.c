@@ -1218,22 +1218,489 @@ remove_from_access_cache(apr_hash_t *access_cache,
 }
 
 
+/* One layer of a node read ahead by svn_wc__db_prefetch_children(), as
+   stored in a row of the NODES table. */
+typedef struct read_cache_layer_t
+{
+  int op_depth;
+  svn_wc__db_status_t presence;
+  svn_node_kind_t kind;
+  apr_int64_t repos_id;
+  svn_revnum_t revision;
+  const char *repos_relpath;
+  svn_revnum_t changed_rev;
+  apr_time_t changed_date;
+  const char *changed_author;
+  svn_depth_t depth;
+  const svn_checksum_t *checksum;
+  const char *target;
+  svn_wc__db_lock_t *lock;
+  svn_filesize_t recorded_size;
+  apr_time_t recorded_time;
+  svn_boolean_t had_props;
+  svn_boolean_t file_external;
+} read_cache_layer_t;
+
+/* A node read ahead by svn_wc__db_prefetch_children(). */
+typedef struct read_cache_node_t
+{
+  /* The layer with the highest op-depth. */
+  read_cache_layer_t top;
+
+  /* The BASE layer, which may be TOP, or NULL if there is none. */
+  read_cache_layer_t *base;
+
+  /* Whether there is a WORKING layer below TOP. */
+  svn_boolean_t have_more_work;
+
+  /* From the ACTUAL_NODE table. */
+  const char *changelist;
+  svn_boolean_t props_mod;
+  svn_boolean_t conflicted;
+} read_cache_node_t;
+
+/* The children of a directory read ahead by svn_wc__db_prefetch_children(),
+   as stored in svn_wc__db_wcroot_t.read_cache. */
+typedef struct read_cache_dir_t
+{
+  svn_wc__db_wcroot_t *wcroot;
+  const char *local_relpath;
+
+  /* Map child names to read_cache_node_t *.  Actual-only nodes are not
+     included. */
+  apr_hash_t *nodes;
+
+  /* Map apr_int64_t repos ids to const char *[2] root URL and UUID. */
+  apr_hash_t *repos;
+
+  /* The pool the above is allocated in.  Destroying it removes this
+     directory from the cache. */
+  apr_pool_t *pool;
+
+  /* The pool given to svn_wc__db_prefetch_children(), whose cleanup will
+     destroy POOL. */
+  apr_pool_t *owner_pool;
+} read_cache_dir_t;
+
+/* Pool cleanup destroying the pool of the read_cache_dir_t DATA. */
+static apr_status_t
+read_cache_dir_owner_cleanup(void *data)
+{
+  read_cache_dir_t *dir = data;
+
+  svn_pool_destroy(dir->pool);
+  return APR_SUCCESS;
+}
+
+/* Pool cleanup removing the read_cache_dir_t DATA from its wcroot. */
+static apr_status_t
+read_cache_dir_cleanup(void *data)
+{
+  read_cache_dir_t *dir = data;
+
+  if (svn_hash_gets(dir->wcroot->read_cache, dir->local_relpath) == dir)
+    svn_hash_sets(dir->wcroot->read_cache, dir->local_relpath, NULL);
+
+  apr_pool_cleanup_kill(dir->owner_pool, dir, read_cache_dir_owner_cleanup);
+  return APR_SUCCESS;
+}
+
+/* Discard everything read ahead in WCROOT. */
+static void
+read_cache_clear(svn_wc__db_wcroot_t *wcroot)
+{
+  /* Destroying the pools removes the directories from the hash. */
+  while (apr_hash_count(wcroot->read_cache))
+    {
+      apr_hash_index_t *hi = apr_hash_first(NULL, wcroot->read_cache);
+      read_cache_dir_t *dir = apr_hash_this_val(hi);
+
+      svn_pool_destroy(dir->pool);
+    }
+}
+
+/* Discard what has been read ahead in WCROOT about LOCAL_ABSPATH, and about
+   its children up to DEPTH. */
+static void
+read_cache_forget_nodes(svn_wc__db_wcroot_t *wcroot,
+                        const char *local_abspath,
+                        svn_depth_t depth,
+                        apr_pool_t *scratch_pool)
+{
+  const char *local_relpath;
+
+  local_relpath = svn_dirent_skip_ancestor(wcroot->abspath, local_abspath);
+
+  if (!local_relpath)
+    {
+      read_cache_clear(wcroot);
+    }
+  else
+    {
+      apr_array_header_t *stale = NULL;
+      apr_hash_index_t *hi;
+      int i;
+
+      /* Directories whose children are within DEPTH below LOCAL_RELPATH. */
+      if (depth != svn_depth_empty)
+        for (hi = apr_hash_first(scratch_pool, wcroot->read_cache);
+             hi;
+             hi = apr_hash_next(hi))
+          {
+            read_cache_dir_t *dir = apr_hash_this_val(hi);
+            const char *remainder
+              = svn_relpath_skip_ancestor(local_relpath, dir->local_relpath);
+
+            if (remainder
+                && (*remainder == '\0'
+                    || depth == svn_depth_infinity
+                    || depth == svn_depth_unknown))
+              {
+                if (!stale)
+                  stale = apr_array_make(scratch_pool, 1, sizeof(dir));
+                APR_ARRAY_PUSH(stale, read_cache_dir_t *) = dir;
+              }
+          }
+
+      for (i = 0; stale && i < stale->nelts; i++)
+        svn_pool_destroy(APR_ARRAY_IDX(stale, i, read_cache_dir_t *)->pool);
+
+      /* LOCAL_RELPATH itself. */
+      if (*local_relpath)
+        {
+          read_cache_dir_t *dir
+            = svn_hash_gets(wcroot->read_cache,
+                            svn_relpath_dirname(local_relpath, scratch_pool));
+
+          if (dir)
+            svn_hash_sets(dir->nodes,
+                          svn_relpath_basename(local_relpath, NULL), NULL);
+        }
+    }
+}
+
+/* Tell the cache of WCROOT that everything written to its database since
+   svn_sqlite__total_changes() returned CHANGES_BEFORE has been about
+   LOCAL_ABSPATH and its children up to DEPTH only.  If the database had
+   already been written to by someone who didn't tell us before that,
+   discard everything read ahead. */
+static void
+read_cache_forget(svn_wc__db_wcroot_t *wcroot,
+                  int changes_before,
+                  const char *local_abspath,
+                  svn_depth_t depth,
+                  apr_pool_t *scratch_pool)
+{
+  if (apr_hash_count(wcroot->read_cache) == 0)
+    return;
+
+  /* Did we miss anything before? */
+  if (wcroot->read_cache_changes != changes_before)
+    read_cache_clear(wcroot);
+  else
+    read_cache_forget_nodes(wcroot, local_abspath, depth, scratch_pool);
+
+  wcroot->read_cache_changes = svn_sqlite__total_changes(wcroot->sdb);
+}
+
+/* Tell the cache of WCROOT that everything written to its database since
+   svn_sqlite__total_changes() returned CHANGES_BEFORE has left the nodes
+   alone, except for recording the file info of the nodes whose absolute
+   paths are the keys of RECORD_MAP, which may be NULL. */
+static void
+read_cache_keep(svn_wc__db_wcroot_t *wcroot,
+                int changes_before,
+                apr_hash_t *record_map,
+                apr_pool_t *scratch_pool)
+{
+  apr_hash_index_t *hi;
+
+  /* Did we miss anything before? */
+  if (wcroot->read_cache_changes != changes_before)
+    return;
+
+  if (record_map)
+    for (hi = apr_hash_first(scratch_pool, record_map);
+         hi;
+         hi = apr_hash_next(hi))
+      read_cache_forget_nodes(wcroot, apr_hash_this_key(hi), svn_depth_empty,
+                              scratch_pool);
+
+  wcroot->read_cache_changes = svn_sqlite__total_changes(wcroot->sdb);
+}
+
+/* Return the information read ahead about LOCAL_RELPATH in WCROOT, or NULL
+   if there is none.  Set *DIR to the directory it has been read with. */
+static const read_cache_node_t *
+read_cache_lookup(read_cache_dir_t **dir,
+                  svn_wc__db_wcroot_t *wcroot,
+                  const char *local_relpath,
+                  apr_pool_t *scratch_pool)
+{
+  if (apr_hash_count(wcroot->read_cache) == 0 || !*local_relpath)
+    return NULL;
+
+  /* Written to by someone who didn't tell us? */
+  if (wcroot->read_cache_changes != svn_sqlite__total_changes(wcroot->sdb))
+    {
+      read_cache_clear(wcroot);
+      return NULL;
+    }
+
+  *dir = svn_hash_gets(wcroot->read_cache,
+                       svn_relpath_dirname(local_relpath, scratch_pool));
+  if (!*dir)
+    return NULL;
+
+  return svn_hash_gets((*dir)->nodes,
+                       svn_relpath_basename(local_relpath, NULL));
+}
+
+/* Like svn_wc__db_fetch_repos_info(), but remembering the result in DIR. */
+static svn_error_t *
+read_cache_fetch_repos_info(const char **repos_root_url,
+                            const char **repos_uuid,
+                            read_cache_dir_t *dir,
+                            apr_int64_t repos_id,
+                            apr_pool_t *result_pool)
+{
+  const char **info;
+
+  if ((!repos_root_url && !repos_uuid) || repos_id == INVALID_REPOS_ID)
+    return svn_error_trace(svn_wc__db_fetch_repos_info(repos_root_url,
+                                                       repos_uuid,
+                                                       dir->wcroot, repos_id,
+                                                       result_pool));
+
+  info = apr_hash_get(dir->repos, &repos_id, sizeof(repos_id));
+  if (!info)
+    {
+      apr_int64_t *key = apr_pmemdup(dir->pool, &repos_id, sizeof(repos_id));
+
+      info = apr_palloc(dir->pool, 2 * sizeof(*info));
+      SVN_ERR(svn_wc__db_fetch_repos_info(&info[0], &info[1], dir->wcroot,
+                                          repos_id, dir->pool));
+      apr_hash_set(dir->repos, key, sizeof(*key), info);
+    }
+
+  if (repos_root_url)
+    *repos_root_url = apr_pstrdup(result_pool, info[0]);
+  if (repos_uuid)
+    *repos_uuid = apr_pstrdup(result_pool, info[1]);
+
+  return SVN_NO_ERROR;
+}
+
+/* Return a deep copy of LOCK allocated in RESULT_POOL. */
+static svn_wc__db_lock_t *
+lock_dup(const svn_wc__db_lock_t *lock,
+         apr_pool_t *result_pool)
+{
+  svn_wc__db_lock_t *new_lock;
+
+  if (!lock)
+    return NULL;
+
+  new_lock = apr_pmemdup(result_pool, lock, sizeof(*lock));
+  new_lock->token = apr_pstrdup(result_pool, lock->token);
+  new_lock->owner = apr_pstrdup(result_pool, lock->owner);
+  new_lock->comment = apr_pstrdup(result_pool, lock->comment);
+
+  return new_lock;
+}
+
+/* Like read_info(), but using the information in NODE that has been read
+   ahead for LOCAL_RELPATH. */
+static svn_error_t *
+read_info_from_cache(svn_wc__db_status_t *status,
+                     svn_node_kind_t *kind,
+                     svn_revnum_t *revision,
+                     const char **repos_relpath,
+                     apr_int64_t *repos_id,
+                     svn_revnum_t *changed_rev,
+                     apr_time_t *changed_date,
+                     const char **changed_author,
+                     svn_depth_t *depth,
+                     const svn_checksum_t **checksum,
+                     const char **target,
+                     const char **original_repos_relpath,
+                     apr_int64_t *original_repos_id,
+                     svn_revnum_t *original_revision,
+                     svn_wc__db_lock_t **lock,
+                     svn_filesize_t *recorded_size,
+                     apr_time_t *recorded_time,
+                     const char **changelist,
+                     svn_boolean_t *conflicted,
+                     svn_boolean_t *op_root,
+                     svn_boolean_t *had_props,
+                     svn_boolean_t *props_mod,
+                     svn_boolean_t *have_base,
+                     svn_boolean_t *have_more_work,
+                     svn_boolean_t *have_work,
+                     const read_cache_node_t *node,
+                     const char *local_relpath,
+                     apr_pool_t *result_pool)
+{
+  const read_cache_layer_t *top = &node->top;
+
+  if (status)
+    {
+      *status = top->presence;
+      if (top->op_depth != 0)
+        SVN_ERR(convert_to_working_status(status, *status));
+    }
+  if (kind)
+    *kind = top->kind;
+
+  if (top->op_depth != 0)
+    {
+      if (repos_id)
+        *repos_id = INVALID_REPOS_ID;
+      if (revision)
+        *revision = SVN_INVALID_REVNUM;
+      if (repos_relpath)
+        *repos_relpath = NULL;
+      if (original_repos_id)
+        *original_repos_id = top->repos_id;
+      if (original_revision)
+        *original_revision = top->revision;
+      if (original_repos_relpath)
+        *original_repos_relpath = apr_pstrdup(result_pool,
+                                              top->repos_relpath);
+      if (lock)
+        *lock = NULL;
+    }
+  else
+    {
+      if (repos_id)
+        *repos_id = top->repos_id;
+      if (revision)
+        *revision = top->revision;
+      if (repos_relpath)
+        *repos_relpath = apr_pstrdup(result_pool, top->repos_relpath);
+      if (original_repos_id)
+        *original_repos_id = INVALID_REPOS_ID;
+      if (original_revision)
+        *original_revision = SVN_INVALID_REVNUM;
+      if (original_repos_relpath)
+        *original_repos_relpath = NULL;
+      if (lock)
+        *lock = lock_dup(top->lock, result_pool);
+    }
+
+  if (changed_rev)
+    *changed_rev = top->changed_rev;
+  if (changed_date)
+    *changed_date = top->changed_date;
+  if (changed_author)
+    *changed_author = apr_pstrdup(result_pool, top->changed_author);
+  if (depth)
+    *depth = top->depth;
+  if (checksum)
+    *checksum = top->checksum ? svn_checksum_dup(top->checksum, result_pool)
+                              : NULL;
+  if (target)
+    *target = apr_pstrdup(result_pool, top->target);
+  if (recorded_size)
+    *recorded_size = top->recorded_size;
+  if (recorded_time)
+    *recorded_time = top->recorded_time;
+  if (changelist)
+    *changelist = apr_pstrdup(result_pool, node->changelist);
+  if (conflicted)
+    *conflicted = node->conflicted;
+  if (op_root)
+    *op_root = (top->op_depth > 0
+                && top->op_depth == relpath_depth(local_relpath));
+  if (had_props)
+    *had_props = top->had_props;
+  if (props_mod)
+    *props_mod = node->props_mod;
+  if (have_base)
+    *have_base = (node->base != NULL);
+  if (have_more_work)
+    *have_more_work = node->have_more_work;
+  if (have_work)
+    *have_work = (top->op_depth != 0);
+
+  return SVN_NO_ERROR;
+}
+
+/* Like svn_wc__db_base_get_info_internal() without the PROPS output, but
+   using the BASE layer that has been read ahead. */
+static void
+base_get_info_from_cache(svn_wc__db_status_t *status,
+                         svn_node_kind_t *kind,
+                         svn_revnum_t *revision,
+                         const char **repos_relpath,
+                         apr_int64_t *repos_id,
+                         svn_revnum_t *changed_rev,
+                         apr_time_t *changed_date,
+                         const char **changed_author,
+                         svn_depth_t *depth,
+                         const svn_checksum_t **checksum,
+                         const char **target,
+                         svn_wc__db_lock_t **lock,
+                         svn_boolean_t *had_props,
+                         svn_boolean_t *update_root,
+                         const read_cache_layer_t *base,
+                         apr_pool_t *result_pool)
+{
+  if (status)
+    *status = base->presence;
+  if (kind)
+    *kind = base->kind;
+  if (revision)
+    *revision = base->revision;
+  if (repos_relpath)
+    *repos_relpath = apr_pstrdup(result_pool, base->repos_relpath);
+  if (repos_id)
+    *repos_id = base->repos_id;
+  if (changed_rev)
+    *changed_rev = base->changed_rev;
+  if (changed_date)
+    *changed_date = base->changed_date;
+  if (changed_author)
+    *changed_author = apr_pstrdup(result_pool, base->changed_author);
+  if (depth)
+    *depth = base->depth;
+  if (checksum)
+    *checksum = base->checksum ? svn_checksum_dup(base->checksum, result_pool)
+                               : NULL;
+  if (target)
+    *target = apr_pstrdup(result_pool, base->target);
+  if (lock)
+    *lock = lock_dup(base->lock, result_pool);
+  if (had_props)
+    *had_props = base->had_props;
+  if (update_root)
+    *update_root = base->file_external;
+}
+
+
 /* Flush the access baton for LOCAL_ABSPATH, and any of its children up to
  * the specified DEPTH, from the access baton cache in WCROOT.
  * Also flush the access baton for the parent of LOCAL_ABSPATH.I
  *
  * This function must be called when the access baton cache goes stale,
  * i.e. data about LOCAL_ABSPATH will need to be read again from disk.
+ * It also discards the affected nodes read ahead in WCROOT; CHANGES_BEFORE
+ * is the svn_sqlite__total_changes() of WCROOT's database from just before
+ * the caller wrote to it, see read_cache_forget().
  *
  * Use SCRATCH_POOL for temporary allocations. */
 static svn_error_t *
 flush_entries(svn_wc__db_wcroot_t *wcroot,
+              int changes_before,
               const char *local_abspath,
               svn_depth_t depth,
               apr_pool_t *scratch_pool)
 {
   const char *parent_abspath;
 
+  read_cache_forget(wcroot, changes_before, local_abspath, depth,
+                    scratch_pool);
+
   if (apr_hash_count(wcroot->access_cache) == 0)
     return SVN_NO_ERROR;
 
@@ -1636,6 +2103,7 @@ svn_wc__db_base_add_directory(svn_wc__db_t *db,
                               apr_pool_t *scratch_pool)
 {
   svn_wc__db_wcroot_t *wcroot;
+  int changes_before;
   const char *local_relpath;
   insert_base_baton_t ibb;
 
@@ -1685,6 +2153,8 @@ svn_wc__db_base_add_directory(svn_wc__db_t *db,
       ibb.new_actual_props = new_actual_props;
     }
 
+  changes_before = svn_sqlite__total_changes(wcroot->sdb);
+
   /* Insert the directory and all its children transactionally.
 
      Note: old children can stick around, even if they are no longer present
@@ -1693,7 +2163,8 @@ svn_wc__db_base_add_directory(svn_wc__db_t *db,
             insert_base_node(&ibb, wcroot, local_relpath, scratch_pool),
             wcroot);
 
-  SVN_ERR(flush_entries(wcroot, local_abspath, depth, scratch_pool));
+  SVN_ERR(flush_entries(wcroot, changes_before, local_abspath, depth,
+                        scratch_pool));
   return SVN_NO_ERROR;
 }
 
@@ -1712,6 +2183,7 @@ svn_wc__db_base_add_incomplete_directory(svn_wc__db_t *db,
                                          apr_pool_t *scratch_pool)
 {
   svn_wc__db_wcroot_t *wcroot;
+  int changes_before;
   const char *local_relpath;
   struct insert_base_baton_t ibb;
 
@@ -1742,11 +2214,14 @@ svn_wc__db_base_add_incomplete_directory(svn_wc__db_t *db,
   ibb.conflict = conflict;
   ibb.work_items = work_items;
 
+  changes_before = svn_sqlite__total_changes(wcroot->sdb);
+
   SVN_WC__DB_WITH_TXN(
             insert_base_node(&ibb, wcroot, local_relpath, scratch_pool),
             wcroot);
 
-  SVN_ERR(flush_entries(wcroot, local_abspath, svn_depth_empty, scratch_pool));
+  SVN_ERR(flush_entries(wcroot, changes_before, local_abspath, svn_depth_empty,
+                        scratch_pool));
 
   return SVN_NO_ERROR;
 }
@@ -1777,6 +2252,7 @@ svn_wc__db_base_add_file(svn_wc__db_t *db,
                          apr_pool_t *scratch_pool)
 {
   svn_wc__db_wcroot_t *wcroot;
+  int changes_before;
   const char *local_relpath;
   insert_base_baton_t ibb;
 
@@ -1828,14 +2304,16 @@ svn_wc__db_base_add_file(svn_wc__db_t *db,
   ibb.conflict = conflict;
   ibb.work_items = work_items;
 
+  changes_before = svn_sqlite__total_changes(wcroot->sdb);
+
   SVN_WC__DB_WITH_TXN(
             insert_base_node(&ibb, wcroot, local_relpath, scratch_pool),
             wcroot);
 
   /* If this used to be a directory we should remove children so pass
    * depth infinity. */
-  SVN_ERR(flush_entries(wcroot, local_abspath, svn_depth_infinity,
-                        scratch_pool));
+  SVN_ERR(flush_entries(wcroot, changes_before, local_abspath,
+                        svn_depth_infinity, scratch_pool));
   return SVN_NO_ERROR;
 }
 
@@ -1865,6 +2343,7 @@ svn_wc__db_base_add_symlink(svn_wc__db_t *db,
                             apr_pool_t *scratch_pool)
 {
   svn_wc__db_wcroot_t *wcroot;
+  int changes_before;
   const char *local_relpath;
   insert_base_baton_t ibb;
 
@@ -1915,14 +2394,16 @@ svn_wc__db_base_add_symlink(svn_wc__db_t *db,
   ibb.conflict = conflict;
   ibb.work_items = work_items;
 
+  changes_before = svn_sqlite__total_changes(wcroot->sdb);
+
   SVN_WC__DB_WITH_TXN(
             insert_base_node(&ibb, wcroot, local_relpath, scratch_pool),
             wcroot);
 
   /* If this used to be a directory we should remove children so pass
    * depth infinity. */
-  SVN_ERR(flush_entries(wcroot, local_abspath, svn_depth_infinity,
-                        scratch_pool));
+  SVN_ERR(flush_entries(wcroot, changes_before, local_abspath,
+                        svn_depth_infinity, scratch_pool));
   return SVN_NO_ERROR;
 }
 
@@ -1941,6 +2422,7 @@ add_excluded_or_not_present_node(svn_wc__db_t *db,
                                  apr_pool_t *scratch_pool)
 {
   svn_wc__db_wcroot_t *wcroot;
+  int changes_before;
   const char *local_relpath;
   insert_base_baton_t ibb;
   const char *dir_abspath, *name;
@@ -1987,14 +2469,16 @@ add_excluded_or_not_present_node(svn_wc__db_t *db,
   ibb.conflict = conflict;
   ibb.work_items = work_items;
 
+  changes_before = svn_sqlite__total_changes(wcroot->sdb);
+
   SVN_WC__DB_WITH_TXN(
             insert_base_node(&ibb, wcroot, local_relpath, scratch_pool),
             wcroot);
 
   /* If this used to be a directory we should remove children so pass
    * depth infinity. */
-  SVN_ERR(flush_entries(wcroot, local_abspath, svn_depth_infinity,
-                        scratch_pool));
+  SVN_ERR(flush_entries(wcroot, changes_before, local_abspath,
+                        svn_depth_infinity, scratch_pool));
 
   return SVN_NO_ERROR;
 }
@@ -2445,6 +2929,7 @@ svn_wc__db_base_remove(svn_wc__db_t *db,
                        apr_pool_t *scratch_pool)
 {
   svn_wc__db_wcroot_t *wcroot;
+  int changes_before;
   const char *local_relpath;
 
   SVN_ERR_ASSERT(svn_dirent_is_absolute(local_abspath));
@@ -2453,6 +2938,8 @@ svn_wc__db_base_remove(svn_wc__db_t *db,
                               local_abspath, scratch_pool, scratch_pool));
   VERIFY_USABLE_WCROOT(wcroot);
 
+  changes_before = svn_sqlite__total_changes(wcroot->sdb);
+
   SVN_WC__DB_WITH_TXN(db_base_remove(wcroot, local_relpath,
                                      db, keep_as_working,
                                      mark_not_present, mark_excluded,
@@ -2462,8 +2949,8 @@ svn_wc__db_base_remove(svn_wc__db_t *db,
 
   /* If this used to be a directory we should remove children so pass
    * depth infinity. */
-  SVN_ERR(flush_entries(wcroot, local_abspath, svn_depth_infinity,
-                        scratch_pool));
+  SVN_ERR(flush_entries(wcroot, changes_before, local_abspath,
+                        svn_depth_infinity, scratch_pool));
 
   return SVN_NO_ERROR;
 }
@@ -2636,6 +3123,8 @@ svn_wc__db_base_get_info(svn_wc__db_status_t *status,
   svn_wc__db_wcroot_t *wcroot;
   const char *local_relpath;
   apr_int64_t repos_id;
+  const read_cache_node_t *cached;
+  read_cache_dir_t *cache_dir;
 
   SVN_ERR_ASSERT(svn_dirent_is_absolute(local_abspath));
 
@@ -2643,6 +3132,20 @@ svn_wc__db_base_get_info(svn_wc__db_status_t *status,
                               local_abspath, scratch_pool, scratch_pool));
   VERIFY_USABLE_WCROOT(wcroot);
 
+  cached = read_cache_lookup(&cache_dir, wcroot, local_relpath, scratch_pool);
+  if (cached && cached->base && !props)
+    {
+      base_get_info_from_cache(status, kind, revision, repos_relpath,
+                               &repos_id, changed_rev, changed_date,
+                               changed_author, depth, checksum, target, lock,
+                               had_props, update_root, cached->base,
+                               result_pool);
+      return svn_error_trace(read_cache_fetch_repos_info(repos_root_url,
+                                                         repos_uuid,
+                                                         cache_dir, repos_id,
+                                                         result_pool));
+    }
+
   SVN_WC__DB_WITH_TXN4(
           svn_wc__db_base_get_info_internal(status, kind, revision,
                                             repos_relpath, &repos_id,
@@ -5270,6 +5773,7 @@ svn_wc__db_op_handle_move_back(svn_boolean_t *moved_back,
                                apr_pool_t *scratch_pool)
 {
   svn_wc__db_wcroot_t *wcroot;
+  int changes_before;
   const char *local_relpath;
   const char *moved_from_relpath;
   SVN_ERR_ASSERT(svn_dirent_is_absolute(local_abspath));
@@ -5293,13 +5797,15 @@ svn_wc__db_op_handle_move_back(svn_boolean_t *moved_back,
       return SVN_NO_ERROR;
     }
 
+  changes_before = svn_sqlite__total_changes(wcroot->sdb);
+
   SVN_WC__DB_WITH_TXN(handle_move_back(moved_back, wcroot, local_relpath,
                                        moved_from_relpath, work_items,
                                        scratch_pool),
                       wcroot);
 
-  SVN_ERR(flush_entries(wcroot, local_abspath, svn_depth_infinity,
-                        scratch_pool));
+  SVN_ERR(flush_entries(wcroot, changes_before, local_abspath,
+                        svn_depth_infinity, scratch_pool));
 
   return SVN_NO_ERROR;
 }
@@ -5689,6 +6195,7 @@ svn_wc__db_op_copy_dir(svn_wc__db_t *db,
                        apr_pool_t *scratch_pool)
 {
   svn_wc__db_wcroot_t *wcroot;
+  int changes_before;
   const char *local_relpath;
   insert_working_baton_t iwb;
   int parent_op_depth;
@@ -5738,10 +6245,13 @@ svn_wc__db_op_copy_dir(svn_wc__db_t *db,
   iwb.work_items = work_items;
   iwb.conflict = conflict;
 
+  changes_before = svn_sqlite__total_changes(wcroot->sdb);
+
   SVN_WC__DB_WITH_TXN(
                 insert_working_node(&iwb, wcroot, local_relpath, scratch_pool),
                 wcroot);
-  SVN_ERR(flush_entries(wcroot, local_abspath, depth, scratch_pool));
+  SVN_ERR(flush_entries(wcroot, changes_before, local_abspath, depth,
+                        scratch_pool));
 
   return SVN_NO_ERROR;
 }
@@ -5767,6 +6277,7 @@ svn_wc__db_op_copy_file(svn_wc__db_t *db,
                         apr_pool_t *scratch_pool)
 {
   svn_wc__db_wcroot_t *wcroot;
+  int changes_before;
   const char *local_relpath;
   insert_working_baton_t iwb;
   int parent_op_depth;
@@ -5823,10 +6334,13 @@ svn_wc__db_op_copy_file(svn_wc__db_t *db,
   iwb.work_items = work_items;
   iwb.conflict = conflict;
 
+  changes_before = svn_sqlite__total_changes(wcroot->sdb);
+
   SVN_WC__DB_WITH_TXN(
           insert_working_node(&iwb, wcroot, local_relpath, scratch_pool),
           wcroot);
-  SVN_ERR(flush_entries(wcroot, local_abspath, svn_depth_empty, scratch_pool));
+  SVN_ERR(flush_entries(wcroot, changes_before, local_abspath, svn_depth_empty,
+                        scratch_pool));
 
   return SVN_NO_ERROR;
 }
@@ -5850,6 +6364,7 @@ svn_wc__db_op_copy_symlink(svn_wc__db_t *db,
                            apr_pool_t *scratch_pool)
 {
   svn_wc__db_wcroot_t *wcroot;
+  int changes_before;
   const char *local_relpath;
   insert_working_baton_t iwb;
   int parent_op_depth;
@@ -5897,10 +6412,13 @@ svn_wc__db_op_copy_symlink(svn_wc__db_t *db,
   iwb.work_items = work_items;
   iwb.conflict = conflict;
 
+  changes_before = svn_sqlite__total_changes(wcroot->sdb);
+
   SVN_WC__DB_WITH_TXN(
             insert_working_node(&iwb, wcroot, local_relpath, scratch_pool),
             wcroot);
-  SVN_ERR(flush_entries(wcroot, local_abspath, svn_depth_empty, scratch_pool));
+  SVN_ERR(flush_entries(wcroot, changes_before, local_abspath, svn_depth_empty,
+                        scratch_pool));
 
   return SVN_NO_ERROR;
 }
@@ -5914,6 +6432,7 @@ svn_wc__db_op_add_directory(svn_wc__db_t *db,
                             apr_pool_t *scratch_pool)
 {
   svn_wc__db_wcroot_t *wcroot;
+  int changes_before;
   const char *local_relpath;
   const char *dir_abspath;
   const char *name;
@@ -5941,13 +6460,15 @@ svn_wc__db_op_add_directory(svn_wc__db_t *db,
 
   iwb.work_items = work_items;
 
+  changes_before = svn_sqlite__total_changes(wcroot->sdb);
+
   SVN_WC__DB_WITH_TXN(
             insert_working_node(&iwb, wcroot, local_relpath, scratch_pool),
             wcroot);
   /* Use depth infinity to make sure we have no invalid cached information
    * about children of this dir. */
-  SVN_ERR(flush_entries(wcroot, local_abspath, svn_depth_infinity,
-                        scratch_pool));
+  SVN_ERR(flush_entries(wcroot, changes_before, local_abspath,
+                        svn_depth_infinity, scratch_pool));
 
   return SVN_NO_ERROR;
 }
@@ -5961,6 +6482,7 @@ svn_wc__db_op_add_file(svn_wc__db_t *db,
                        apr_pool_t *scratch_pool)
 {
   svn_wc__db_wcroot_t *wcroot;
+  int changes_before;
   const char *local_relpath;
   insert_working_baton_t iwb;
   const char *dir_abspath;
@@ -5988,10 +6510,13 @@ svn_wc__db_op_add_file(svn_wc__db_t *db,
 
   iwb.work_items = work_items;
 
+  changes_before = svn_sqlite__total_changes(wcroot->sdb);
+
   SVN_WC__DB_WITH_TXN(
             insert_working_node(&iwb, wcroot, local_relpath, scratch_pool),
             wcroot);
-  SVN_ERR(flush_entries(wcroot, local_abspath, svn_depth_empty, scratch_pool));
+  SVN_ERR(flush_entries(wcroot, changes_before, local_abspath, svn_depth_empty,
+                        scratch_pool));
 
   return SVN_NO_ERROR;
 }
@@ -6006,6 +6531,7 @@ svn_wc__db_op_add_symlink(svn_wc__db_t *db,
                           apr_pool_t *scratch_pool)
 {
   svn_wc__db_wcroot_t *wcroot;
+  int changes_before;
   const char *local_relpath;
   insert_working_baton_t iwb;
   const char *dir_abspath;
@@ -6038,10 +6564,13 @@ svn_wc__db_op_add_symlink(svn_wc__db_t *db,
 
   iwb.work_items = work_items;
 
+  changes_before = svn_sqlite__total_changes(wcroot->sdb);
+
   SVN_WC__DB_WITH_TXN(
             insert_working_node(&iwb, wcroot, local_relpath, scratch_pool),
             wcroot);
-  SVN_ERR(flush_entries(wcroot, local_abspath, svn_depth_empty, scratch_pool));
+  SVN_ERR(flush_entries(wcroot, changes_before, local_abspath, svn_depth_empty,
+                        scratch_pool));
 
   return SVN_NO_ERROR;
 }
@@ -6077,6 +6606,7 @@ svn_wc__db_global_record_fileinfo(svn_wc__db_t *db,
                                   apr_pool_t *scratch_pool)
 {
   svn_wc__db_wcroot_t *wcroot;
+  int changes_before;
   const char *local_relpath;
 
   SVN_ERR_ASSERT(svn_dirent_is_absolute(local_abspath));
@@ -6085,11 +6615,14 @@ svn_wc__db_global_record_fileinfo(svn_wc__db_t *db,
                               local_abspath, scratch_pool, scratch_pool));
   VERIFY_USABLE_WCROOT(wcroot);
 
+  changes_before = svn_sqlite__total_changes(wcroot->sdb);
+
   SVN_ERR(db_record_fileinfo(wcroot, local_relpath,
                              recorded_size, recorded_time, scratch_pool));
 
   /* We *totally* monkeyed the entries. Toss 'em.  */
-  SVN_ERR(flush_entries(wcroot, local_abspath, svn_depth_empty, scratch_pool));
+  SVN_ERR(flush_entries(wcroot, changes_before, local_abspath, svn_depth_empty,
+                        scratch_pool));
 
   return SVN_NO_ERROR;
 }
@@ -6554,7 +7087,8 @@ svn_wc__db_op_set_changelist(svn_wc__db_t *db,
 
   /* Flush the entries before we do the work. Even if no work is performed,
      the flush isn't a problem. */
-  SVN_ERR(flush_entries(wcroot, local_abspath, depth, scratch_pool));
+  SVN_ERR(flush_entries(wcroot, svn_sqlite__total_changes(wcroot->sdb),
+                        local_abspath, depth, scratch_pool));
 
   /* Perform the set-changelist operation (transactionally), perform any
      notifications necessary, and then clean out our temporary tables.  */
@@ -6623,6 +7157,7 @@ svn_wc__db_op_mark_conflict(svn_wc__db_t *db,
                             apr_pool_t *scratch_pool)
 {
   svn_wc__db_wcroot_t *wcroot;
+  int changes_before;
   const char *local_relpath;
 
   SVN_ERR_ASSERT(svn_dirent_is_absolute(local_abspath));
@@ -6631,6 +7166,8 @@ svn_wc__db_op_mark_conflict(svn_wc__db_t *db,
                               local_abspath, scratch_pool, scratch_pool));
   VERIFY_USABLE_WCROOT(wcroot);
 
+  changes_before = svn_sqlite__total_changes(wcroot->sdb);
+
   SVN_ERR(svn_wc__db_mark_conflict_internal(wcroot, local_relpath,
                                             conflict_skel, scratch_pool));
 
@@ -6638,7 +7175,8 @@ svn_wc__db_op_mark_conflict(svn_wc__db_t *db,
   if (work_items)
     SVN_ERR(add_work_items(wcroot->sdb, work_items, scratch_pool));
 
-  SVN_ERR(flush_entries(wcroot, local_abspath, svn_depth_empty, scratch_pool));
+  SVN_ERR(flush_entries(wcroot, changes_before, local_abspath, svn_depth_empty,
+                        scratch_pool));
 
   return SVN_NO_ERROR;
 
@@ -6747,6 +7285,7 @@ svn_wc__db_op_mark_resolved(svn_wc__db_t *db,
                             apr_pool_t *scratch_pool)
 {
   svn_wc__db_wcroot_t *wcroot;
+  int changes_before;
   const char *local_relpath;
 
   SVN_ERR_ASSERT(svn_dirent_is_absolute(local_abspath));
@@ -6755,6 +7294,8 @@ svn_wc__db_op_mark_resolved(svn_wc__db_t *db,
                               local_abspath, scratch_pool, scratch_pool));
   VERIFY_USABLE_WCROOT(wcroot);
 
+  changes_before = svn_sqlite__total_changes(wcroot->sdb);
+
   SVN_WC__DB_WITH_TXN(
     svn_wc__db_op_mark_resolved_internal(
                         wcroot, local_relpath, db,
@@ -6762,7 +7303,8 @@ svn_wc__db_op_mark_resolved(svn_wc__db_t *db,
                         work_items, scratch_pool),
     wcroot);
 
-  SVN_ERR(flush_entries(wcroot, local_abspath, svn_depth_empty, scratch_pool));
+  SVN_ERR(flush_entries(wcroot, changes_before, local_abspath, svn_depth_empty,
+                        scratch_pool));
   return SVN_NO_ERROR;
 }
 
@@ -7196,6 +7738,7 @@ svn_wc__db_op_revert(svn_wc__db_t *db,
                      apr_pool_t *scratch_pool)
 {
   svn_wc__db_wcroot_t *wcroot;
+  int changes_before;
   const char *local_relpath;
   struct revert_baton_t rvb;
   struct with_triggers_baton_t wtb = { STMT_CREATE_REVERT_LIST,
@@ -7227,10 +7770,13 @@ svn_wc__db_op_revert(svn_wc__db_t *db,
                               db, local_abspath, scratch_pool, scratch_pool));
   VERIFY_USABLE_WCROOT(wcroot);
 
+  changes_before = svn_sqlite__total_changes(wcroot->sdb);
+
   SVN_WC__DB_WITH_TXN(with_triggers(&wtb, wcroot, local_relpath, scratch_pool),
                       wcroot);
 
-  SVN_ERR(flush_entries(wcroot, local_abspath, depth, scratch_pool));
+  SVN_ERR(flush_entries(wcroot, changes_before, local_abspath, depth,
+                        scratch_pool));
 
   return SVN_NO_ERROR;
 }
@@ -7745,6 +8291,7 @@ svn_wc__db_op_remove_node(svn_boolean_t *left_changes,
                           apr_pool_t *scratch_pool)
 {
   svn_wc__db_wcroot_t *wcroot;
+  int changes_before;
   const char *local_relpath;
 
   SVN_ERR_ASSERT(svn_dirent_is_absolute(local_abspath));
@@ -7753,6 +8300,8 @@ svn_wc__db_op_remove_node(svn_boolean_t *left_changes,
                               local_abspath, scratch_pool, scratch_pool));
   VERIFY_USABLE_WCROOT(wcroot);
 
+  changes_before = svn_sqlite__total_changes(wcroot->sdb);
+
   SVN_WC__DB_WITH_TXN(remove_node_txn(left_changes,
                                       wcroot, local_relpath, db,
                                       destroy_wc, destroy_changes,
@@ -7761,8 +8310,8 @@ svn_wc__db_op_remove_node(svn_boolean_t *left_changes,
                       wcroot);
 
   /* Flush everything below this node in all ways */
-  SVN_ERR(flush_entries(wcroot, local_abspath, svn_depth_infinity,
-                        scratch_pool));
+  SVN_ERR(flush_entries(wcroot, changes_before, local_abspath,
+                        svn_depth_infinity, scratch_pool));
 
   return SVN_NO_ERROR;
 }
@@ -7803,6 +8352,7 @@ svn_wc__db_op_set_base_depth(svn_wc__db_t *db,
                              apr_pool_t *scratch_pool)
 {
   svn_wc__db_wcroot_t *wcroot;
+  int changes_before;
   const char *local_relpath;
 
   SVN_ERR_ASSERT(svn_dirent_is_absolute(local_abspath));
@@ -7812,13 +8362,16 @@ svn_wc__db_op_set_base_depth(svn_wc__db_t *db,
                               local_abspath, scratch_pool, scratch_pool));
   VERIFY_USABLE_WCROOT(wcroot);
 
+  changes_before = svn_sqlite__total_changes(wcroot->sdb);
+
   /* ### We set depth on working and base to match entry behavior.
          Maybe these should be separated later? */
   SVN_WC__DB_WITH_TXN(db_op_set_base_depth(wcroot, local_relpath, depth,
                                            scratch_pool),
                       wcroot);
 
-  SVN_ERR(flush_entries(wcroot, local_abspath, svn_depth_empty, scratch_pool));
+  SVN_ERR(flush_entries(wcroot, changes_before, local_abspath, svn_depth_empty,
+                        scratch_pool));
 
   return SVN_NO_ERROR;
 }
@@ -8630,6 +9183,7 @@ svn_wc__db_op_delete(svn_wc__db_t *db,
                      apr_pool_t *scratch_pool)
 {
   svn_wc__db_wcroot_t *wcroot;
+  int changes_before;
   svn_wc__db_wcroot_t *moved_to_wcroot;
   const char *local_relpath;
   const char *moved_to_relpath;
@@ -8668,6 +9222,8 @@ svn_wc__db_op_delete(svn_wc__db_t *db,
   odb.work_items = work_items;
   odb.delete_dir_externals = delete_dir_externals;
 
+  changes_before = svn_sqlite__total_changes(wcroot->sdb);
+
   if (notify_func)
     {
       /* Perform the deletion operation (transactionally), perform any
@@ -8690,8 +9246,8 @@ svn_wc__db_op_delete(svn_wc__db_t *db,
                     wcroot);
     }
 
-  SVN_ERR(flush_entries(wcroot, local_abspath, svn_depth_infinity,
-                        scratch_pool));
+  SVN_ERR(flush_entries(wcroot, changes_before, local_abspath,
+                        svn_depth_infinity, scratch_pool));
 
   return SVN_NO_ERROR;
 }
@@ -8744,8 +9300,9 @@ svn_wc__db_op_delete_many(svn_wc__db_t *db,
       SVN_ERR_ASSERT(wcroot->wc_id == target_wcroot->wc_id);
 
       APR_ARRAY_PUSH(odmb.rel_targets, const char *) = local_relpath;
-      SVN_ERR(flush_entries(target_wcroot, local_abspath, svn_depth_infinity,
-                            iterpool));
+      SVN_ERR(flush_entries(target_wcroot,
+                            svn_sqlite__total_changes(target_wcroot->sdb),
+                            local_abspath, svn_depth_infinity, iterpool));
 
     }
   svn_pool_destroy(iterpool);
@@ -9171,6 +9728,172 @@ svn_wc__db_read_info_internal(svn_wc__db_status_t *status,
 }
 
 
+/* Fill LAYER from the current row of STMT, an STMT_SELECT_NODE_CHILDREN_INFO
+   query, allocating in RESULT_POOL. */
+static svn_error_t *
+read_cache_layer_from_columns(read_cache_layer_t *layer,
+                              svn_sqlite__stmt_t *stmt,
+                              apr_pool_t *result_pool)
+{
+  svn_error_t *err = SVN_NO_ERROR;
+
+  layer->op_depth = svn_sqlite__column_int(stmt, 0);
+  layer->presence = column_token_err(&err, stmt, 3, presence_map);
+  layer->kind = column_token_err(&err, stmt, 4, kind_map);
+  repos_location_from_columns(&layer->repos_id, &layer->revision,
+                              &layer->repos_relpath, stmt, 1, 5, 2,
+                              result_pool);
+  layer->changed_rev = svn_sqlite__column_revnum(stmt, 8);
+  layer->changed_date = svn_sqlite__column_int64(stmt, 9);
+  layer->changed_author = svn_sqlite__column_text(stmt, 10, result_pool);
+
+  if (layer->kind != svn_node_dir || svn_sqlite__column_is_null(stmt, 11))
+    layer->depth = svn_depth_unknown;
+  else
+    layer->depth = column_token_err(&err, stmt, 11, depth_map);
+
+  if (layer->kind == svn_node_file)
+    err = svn_error_compose_create(
+              err, svn_sqlite__column_checksum(&layer->checksum, stmt, 6,
+                                               result_pool));
+  else
+    layer->checksum = NULL;
+
+  if (layer->kind == svn_node_symlink)
+    layer->target = svn_sqlite__column_text(stmt, 12, result_pool);
+  else
+    layer->target = NULL;
+
+  layer->recorded_size = get_recorded_size(stmt, 7);
+  layer->recorded_time = svn_sqlite__column_int64(stmt, 13);
+  layer->had_props = SQLITE_PROPERTIES_AVAILABLE(stmt, 14);
+  layer->lock = lock_from_columns(stmt, 15, 16, 17, 18, result_pool);
+  layer->file_external = svn_sqlite__column_boolean(stmt, 22);
+
+  return svn_error_trace(err);
+}
+
+/* Read the NODES and ACTUAL_NODE rows of all children of DIR into DIR. */
+static svn_error_t *
+read_cache_fill(read_cache_dir_t *dir)
+{
+  svn_wc__db_wcroot_t *wcroot = dir->wcroot;
+  svn_sqlite__stmt_t *stmt;
+  svn_boolean_t have_row;
+  svn_error_t *err = SVN_NO_ERROR;
+
+  SVN_ERR(svn_sqlite__get_statement(&stmt, wcroot->sdb,
+                                    STMT_SELECT_NODE_CHILDREN_INFO));
+  SVN_ERR(svn_sqlite__bindf(stmt, "is", wcroot->wc_id, dir->local_relpath));
+  SVN_ERR(svn_sqlite__step(&have_row, stmt));
+
+  /* The rows of each child come with the highest op-depth first. */
+  while (have_row && !err)
+    {
+      const char *name = svn_relpath_basename(
+                            svn_sqlite__column_text(stmt, 19, NULL), NULL);
+      read_cache_node_t *node = svn_hash_gets(dir->nodes, name);
+      int op_depth = svn_sqlite__column_int(stmt, 0);
+
+      if (!node)
+        {
+          node = apr_pcalloc(dir->pool, sizeof(*node));
+          err = read_cache_layer_from_columns(&node->top, stmt, dir->pool);
+          if (op_depth == 0)
+            node->base = &node->top;
+
+          svn_hash_sets(dir->nodes, apr_pstrdup(dir->pool, name), node);
+        }
+      else if (op_depth > 0)
+        {
+          node->have_more_work = TRUE;
+        }
+      else
+        {
+          node->base = apr_pcalloc(dir->pool, sizeof(*node->base));
+          err = read_cache_layer_from_columns(node->base, stmt, dir->pool);
+        }
+
+      if (!err)
+        err = svn_sqlite__step(&have_row, stmt);
+    }
+
+  SVN_ERR(svn_error_compose_create(err, svn_sqlite__reset(stmt)));
+
+  SVN_ERR(svn_sqlite__get_statement(&stmt, wcroot->sdb,
+                                    STMT_SELECT_ACTUAL_CHILDREN_INFO));
+  SVN_ERR(svn_sqlite__bindf(stmt, "is", wcroot->wc_id, dir->local_relpath));
+  SVN_ERR(svn_sqlite__step(&have_row, stmt));
+
+  while (have_row)
+    {
+      const char *name = svn_relpath_basename(
+                            svn_sqlite__column_text(stmt, 0, NULL), NULL);
+      read_cache_node_t *node = svn_hash_gets(dir->nodes, name);
+
+      if (node)
+        {
+          node->changelist = svn_sqlite__column_text(stmt, 1, dir->pool);
+          node->props_mod = !svn_sqlite__column_is_null(stmt, 2);
+          node->conflicted = !svn_sqlite__column_is_null(stmt, 3);
+        }
+
+      SVN_ERR(svn_sqlite__step(&have_row, stmt));
+    }
+
+  return svn_error_trace(svn_sqlite__reset(stmt));
+}
+
+svn_error_t *
+svn_wc__db_prefetch_children(svn_wc__db_t *db,
+                             const char *local_abspath,
+                             apr_pool_t *result_pool,
+                             apr_pool_t *scratch_pool)
+{
+  svn_wc__db_wcroot_t *wcroot;
+  const char *local_relpath;
+  read_cache_dir_t *dir;
+
+  SVN_ERR_ASSERT(svn_dirent_is_absolute(local_abspath));
+
+  SVN_ERR(svn_wc__db_wcroot_parse_local_abspath(&wcroot, &local_relpath, db,
+                              local_abspath, scratch_pool, scratch_pool));
+  VERIFY_USABLE_WCROOT(wcroot);
+
+  /* Start over if anything has been written to the database since the
+     cache was last known to be up to date. */
+  if (wcroot->read_cache_changes != svn_sqlite__total_changes(wcroot->sdb))
+    {
+      read_cache_clear(wcroot);
+      wcroot->read_cache_changes = svn_sqlite__total_changes(wcroot->sdb);
+    }
+
+  dir = svn_hash_gets(wcroot->read_cache, local_relpath);
+  if (dir)
+    svn_pool_destroy(dir->pool);
+
+  /* The cache is owned by RESULT_POOL but must not outlive WCROOT, which
+     is allocated in the state pool. */
+  dir = apr_pcalloc(result_pool, sizeof(*dir));
+  dir->wcroot = wcroot;
+  dir->pool = svn_pool_create(db->state_pool);
+  dir->owner_pool = result_pool;
+  dir->local_relpath = apr_pstrdup(dir->pool, local_relpath);
+  dir->nodes = apr_hash_make(dir->pool);
+  dir->repos = apr_hash_make(dir->pool);
+
+  apr_pool_cleanup_register(result_pool, dir, read_cache_dir_owner_cleanup,
+                            apr_pool_cleanup_null);
+  apr_pool_cleanup_register(dir->pool, dir, read_cache_dir_cleanup,
+                            apr_pool_cleanup_null);
+
+  SVN_WC__DB_WITH_TXN(read_cache_fill(dir), wcroot);
+
+  svn_hash_sets(wcroot->read_cache, dir->local_relpath, dir);
+  return SVN_NO_ERROR;
+}
+
+
 svn_error_t *
 svn_wc__db_read_info(svn_wc__db_status_t *status,
                      svn_node_kind_t *kind,
@@ -9207,6 +9930,8 @@ svn_wc__db_read_info(svn_wc__db_status_t *status,
   svn_wc__db_wcroot_t *wcroot;
   const char *local_relpath;
   apr_int64_t repos_id, original_repos_id;
+  const read_cache_node_t *cached;
+  read_cache_dir_t *cache_dir;
 
   SVN_ERR_ASSERT(svn_dirent_is_absolute(local_abspath));
 
@@ -9214,6 +9939,26 @@ svn_wc__db_read_info(svn_wc__db_status_t *status,
                               local_abspath, scratch_pool, scratch_pool));
   VERIFY_USABLE_WCROOT(wcroot);
 
+  cached = read_cache_lookup(&cache_dir, wcroot, local_relpath, scratch_pool);
+  if (cached)
+    {
+      SVN_ERR(read_info_from_cache(status, kind, revision, repos_relpath,
+                                   &repos_id, changed_rev, changed_date,
+                                   changed_author, depth, checksum, target,
+                                   original_repos_relpath, &original_repos_id,
+                                   original_revision, lock,
+                                   recorded_size, recorded_time, changelist,
+                                   conflicted, op_root, have_props, props_mod,
+                                   have_base, have_more_work, have_work,
+                                   cached, local_relpath, result_pool));
+      SVN_ERR(read_cache_fetch_repos_info(repos_root_url, repos_uuid,
+                                          cache_dir, repos_id, result_pool));
+      SVN_ERR(read_cache_fetch_repos_info(original_root_url, original_uuid,
+                                          cache_dir, original_repos_id,
+                                          result_pool));
+      return SVN_NO_ERROR;
+    }
+
   SVN_WC__DB_WITH_TXN4(
           read_info(status, kind, revision, repos_relpath, &repos_id,
                     changed_rev, changed_date, changed_author,
@@ -11384,6 +12129,7 @@ svn_wc__db_global_relocate(svn_wc__db_t *db,
                            apr_pool_t *scratch_pool)
 {
   svn_wc__db_wcroot_t *wcroot;
+  int changes_before;
   const char *local_relpath;
 
   SVN_ERR_ASSERT(svn_dirent_is_absolute(local_dir_abspath));
@@ -11393,12 +12139,14 @@ svn_wc__db_global_relocate(svn_wc__db_t *db,
                            db, local_dir_abspath, scratch_pool, scratch_pool));
   VERIFY_USABLE_WCROOT(wcroot);
 
+  changes_before = svn_sqlite__total_changes(wcroot->sdb);
+
   SVN_WC__DB_WITH_TXN(
     relocate_txn(wcroot, local_relpath, repos_root_url, scratch_pool),
     wcroot);
 
-  SVN_ERR(flush_entries(wcroot, local_dir_abspath, svn_depth_infinity,
-                        scratch_pool));
+  SVN_ERR(flush_entries(wcroot, changes_before, local_dir_abspath,
+                        svn_depth_infinity, scratch_pool));
 
   return SVN_NO_ERROR;
 }
@@ -11981,6 +12729,7 @@ svn_wc__db_global_commit(svn_wc__db_t *db,
 {
   const char *local_relpath;
   svn_wc__db_wcroot_t *wcroot;
+  int changes_before;
 
   SVN_ERR_ASSERT(svn_dirent_is_absolute(local_abspath));
   SVN_ERR_ASSERT(SVN_IS_VALID_REVNUM(new_revision));
@@ -11989,6 +12738,8 @@ svn_wc__db_global_commit(svn_wc__db_t *db,
                               local_abspath, scratch_pool, scratch_pool));
   VERIFY_USABLE_WCROOT(wcroot);
 
+  changes_before = svn_sqlite__total_changes(wcroot->sdb);
+
   SVN_WC__DB_WITH_TXN(
     commit_node(wcroot, local_relpath,
                 new_revision, changed_revision, changed_date, changed_author,
@@ -11997,7 +12748,8 @@ svn_wc__db_global_commit(svn_wc__db_t *db,
     wcroot);
 
   /* We *totally* monkeyed the entries. Toss 'em.  */
-  SVN_ERR(flush_entries(wcroot, local_abspath, svn_depth_empty, scratch_pool));
+  SVN_ERR(flush_entries(wcroot, changes_before, local_abspath, svn_depth_empty,
+                        scratch_pool));
 
   return SVN_NO_ERROR;
 }
@@ -12081,7 +12833,7 @@ db_op_set_rev_repos_relpath_iprops(svn_wc__db_wcroot_t *wcroot,
 {
   svn_sqlite__stmt_t *stmt;
 
-  SVN_ERR(flush_entries(wcroot,
+  SVN_ERR(flush_entries(wcroot, svn_sqlite__total_changes(wcroot->sdb),
                         svn_dirent_join(wcroot->abspath, local_relpath,
                                         scratch_pool),
                         svn_depth_empty, scratch_pool));
@@ -12433,6 +13185,7 @@ svn_wc__db_lock_add(svn_wc__db_t *db,
                     apr_pool_t *scratch_pool)
 {
   svn_wc__db_wcroot_t *wcroot;
+  int changes_before;
   const char *local_relpath;
 
   SVN_ERR_ASSERT(svn_dirent_is_absolute(local_abspath));
@@ -12442,12 +13195,15 @@ svn_wc__db_lock_add(svn_wc__db_t *db,
                               local_abspath, scratch_pool, scratch_pool));
   VERIFY_USABLE_WCROOT(wcroot);
 
+  changes_before = svn_sqlite__total_changes(wcroot->sdb);
+
   SVN_WC__DB_WITH_TXN(
     lock_add_txn(wcroot, local_relpath, lock, scratch_pool),
     wcroot);
 
   /* There may be some entries, and the lock info is now out of date.  */
-  SVN_ERR(flush_entries(wcroot, local_abspath, svn_depth_empty, scratch_pool));
+  SVN_ERR(flush_entries(wcroot, changes_before, local_abspath, svn_depth_empty,
+                        scratch_pool));
 
   return SVN_NO_ERROR;
 }
@@ -12491,6 +13247,7 @@ svn_wc__db_lock_remove(svn_wc__db_t *db,
                        apr_pool_t *scratch_pool)
 {
   svn_wc__db_wcroot_t *wcroot;
+  int changes_before;
   const char *local_relpath;
 
   SVN_ERR_ASSERT(svn_dirent_is_absolute(local_abspath));
@@ -12499,12 +13256,15 @@ svn_wc__db_lock_remove(svn_wc__db_t *db,
                               local_abspath, scratch_pool, scratch_pool));
   VERIFY_USABLE_WCROOT(wcroot);
 
+  changes_before = svn_sqlite__total_changes(wcroot->sdb);
+
   SVN_WC__DB_WITH_TXN(
     lock_remove_txn(wcroot, local_relpath, work_items, scratch_pool),
     wcroot);
 
   /* There may be some entries, and the lock info is now out of date.  */
-  SVN_ERR(flush_entries(wcroot, local_abspath, svn_depth_empty, scratch_pool));
+  SVN_ERR(flush_entries(wcroot, changes_before, local_abspath, svn_depth_empty,
+                        scratch_pool));
 
   return SVN_NO_ERROR;
 }
@@ -13441,6 +14201,7 @@ svn_wc__db_wq_add(svn_wc__db_t *db,
 {
   svn_wc__db_wcroot_t *wcroot;
   const char *local_relpath;
+  int changes_before;
 
   SVN_ERR_ASSERT(svn_dirent_is_absolute(wri_abspath));
 
@@ -13452,9 +14213,13 @@ svn_wc__db_wq_add(svn_wc__db_t *db,
                               wri_abspath, scratch_pool, scratch_pool));
   VERIFY_USABLE_WCROOT(wcroot);
 
+  changes_before = svn_sqlite__total_changes(wcroot->sdb);
+
   /* Add the work item(s) to the WORK_QUEUE.  */
-  return svn_error_trace(add_work_items(wcroot->sdb, work_item,
-                                        scratch_pool));
+  SVN_ERR(add_work_items(wcroot->sdb, work_item, scratch_pool));
+
+  read_cache_keep(wcroot, changes_before, NULL, scratch_pool);
+  return SVN_NO_ERROR;
 }
 
 /* The body of svn_wc__db_wq_fetch_next().
@@ -13515,6 +14280,7 @@ svn_wc__db_wq_fetch_next(apr_uint64_t *id,
 {
   svn_wc__db_wcroot_t *wcroot;
   const char *local_relpath;
+  int changes_before;
 
   SVN_ERR_ASSERT(id != NULL);
   SVN_ERR_ASSERT(work_item != NULL);
@@ -13524,12 +14290,15 @@ svn_wc__db_wq_fetch_next(apr_uint64_t *id,
                               wri_abspath, scratch_pool, scratch_pool));
   VERIFY_USABLE_WCROOT(wcroot);
 
+  changes_before = svn_sqlite__total_changes(wcroot->sdb);
+
   SVN_WC__DB_WITH_TXN(
     wq_fetch_next(id, work_item,
                   wcroot, local_relpath, completed_id,
                   result_pool, scratch_pool),
     wcroot);
 
+  read_cache_keep(wcroot, changes_before, NULL, scratch_pool);
   return SVN_NO_ERROR;
 }
 
@@ -13576,6 +14345,7 @@ svn_wc__db_wq_record_and_fetch_next(apr_uint64_t *id,
 {
   svn_wc__db_wcroot_t *wcroot;
   const char *local_relpath;
+  int changes_before;
 
   SVN_ERR_ASSERT(id != NULL);
   SVN_ERR_ASSERT(work_item != NULL);
@@ -13585,6 +14355,8 @@ svn_wc__db_wq_record_and_fetch_next(apr_uint64_t *id,
                               wri_abspath, scratch_pool, scratch_pool));
   VERIFY_USABLE_WCROOT(wcroot);
 
+  changes_before = svn_sqlite__total_changes(wcroot->sdb);
+
   SVN_WC__DB_WITH_TXN(
     svn_error_compose_create(
             wq_fetch_next(id, work_item,
@@ -13593,11 +14365,104 @@ svn_wc__db_wq_record_and_fetch_next(apr_uint64_t *id,
             wq_record(wcroot, record_map, scratch_pool)),
     wcroot);
 
+  read_cache_keep(wcroot, changes_before, record_map, scratch_pool);
   return SVN_NO_ERROR;
 }
 
 
 
+/* The body of svn_wc__db_wq_record_and_fetch_batch().
+ */
+static svn_error_t *
+wq_record_and_fetch_batch(apr_array_header_t **ids,
+                          apr_array_header_t **work_items,
+                          svn_wc__db_wcroot_t *wcroot,
+                          const apr_array_header_t *completed_ids,
+                          apr_hash_t *record_map,
+                          int max_items,
+                          apr_pool_t *result_pool,
+                          apr_pool_t *scratch_pool)
+{
+  svn_sqlite__stmt_t *stmt;
+  svn_boolean_t have_row;
+  int i;
+
+  if (completed_ids)
+    for (i = 0; i < completed_ids->nelts; i++)
+      {
+        SVN_ERR(svn_sqlite__get_statement(&stmt, wcroot->sdb,
+                                          STMT_DELETE_WORK_ITEM));
+        SVN_ERR(svn_sqlite__bind_int64(stmt, 1,
+                                       APR_ARRAY_IDX(completed_ids, i,
+                                                     apr_uint64_t)));
+        SVN_ERR(svn_sqlite__step_done(stmt));
+      }
+
+  if (record_map)
+    SVN_ERR(wq_record(wcroot, record_map, scratch_pool));
+
+  *ids = apr_array_make(result_pool, max_items, sizeof(apr_uint64_t));
+  *work_items = apr_array_make(result_pool, max_items, sizeof(svn_skel_t *));
+
+  SVN_ERR(svn_sqlite__get_statement(&stmt, wcroot->sdb,
+                                    STMT_SELECT_WORK_ITEMS));
+  SVN_ERR(svn_sqlite__bind_int(stmt, 1, max_items));
+  SVN_ERR(svn_sqlite__step(&have_row, stmt));
+
+  while (have_row)
+    {
+      apr_size_t len;
+      const void *val;
+
+      APR_ARRAY_PUSH(*ids, apr_uint64_t) = svn_sqlite__column_int64(stmt, 0);
+
+      val = svn_sqlite__column_blob(stmt, 1, &len, result_pool);
+      APR_ARRAY_PUSH(*work_items, svn_skel_t *)
+        = svn_skel__parse(val, len, result_pool);
+
+      SVN_ERR(svn_sqlite__step(&have_row, stmt));
+    }
+
+  return svn_error_trace(svn_sqlite__reset(stmt));
+}
+
+svn_error_t *
+svn_wc__db_wq_record_and_fetch_batch(apr_array_header_t **ids,
+                                     apr_array_header_t **work_items,
+                                     svn_wc__db_t *db,
+                                     const char *wri_abspath,
+                                     const apr_array_header_t *completed_ids,
+                                     apr_hash_t *record_map,
+                                     int max_items,
+                                     apr_pool_t *result_pool,
+                                     apr_pool_t *scratch_pool)
+{
+  svn_wc__db_wcroot_t *wcroot;
+  const char *local_relpath;
+  int changes_before;
+
+  SVN_ERR_ASSERT(ids != NULL);
+  SVN_ERR_ASSERT(work_items != NULL);
+  SVN_ERR_ASSERT(max_items > 0);
+  SVN_ERR_ASSERT(svn_dirent_is_absolute(wri_abspath));
+
+  SVN_ERR(svn_wc__db_wcroot_parse_local_abspath(&wcroot, &local_relpath, db,
+                              wri_abspath, scratch_pool, scratch_pool));
+  VERIFY_USABLE_WCROOT(wcroot);
+
+  changes_before = svn_sqlite__total_changes(wcroot->sdb);
+
+  SVN_WC__DB_WITH_TXN(
+    wq_record_and_fetch_batch(ids, work_items, wcroot, completed_ids,
+                              record_map, max_items,
+                              result_pool, scratch_pool),
+    wcroot);
+
+  read_cache_keep(wcroot, changes_before, record_map, scratch_pool);
+  return SVN_NO_ERROR;
+}
+
+
 /* ### temporary API. remove before release.  */
 svn_error_t *
 svn_wc__db_temp_get_format(int *format,
@@ -14886,6 +15751,7 @@ svn_wc__db_temp_op_end_directory_update(svn_wc__db_t *db,
                                         apr_pool_t *scratch_pool)
 {
   svn_wc__db_wcroot_t *wcroot;
+  int changes_before;
   const char *local_relpath;
 
   SVN_ERR_ASSERT(svn_dirent_is_absolute(local_dir_abspath));
@@ -14894,12 +15760,14 @@ svn_wc__db_temp_op_end_directory_update(svn_wc__db_t *db,
                               local_dir_abspath, scratch_pool, scratch_pool));
   VERIFY_USABLE_WCROOT(wcroot);
 
+  changes_before = svn_sqlite__total_changes(wcroot->sdb);
+
   SVN_WC__DB_WITH_TXN(
     end_directory_update(wcroot, local_relpath, scratch_pool),
     wcroot);
 
-  SVN_ERR(flush_entries(wcroot, local_dir_abspath, svn_depth_empty,
-                        scratch_pool));
+  SVN_ERR(flush_entries(wcroot, changes_before, local_dir_abspath,
+                        svn_depth_empty, scratch_pool));
 
   return SVN_NO_ERROR;
 }
@@ -14941,6 +15809,7 @@ svn_wc__db_temp_op_start_directory_update(svn_wc__db_t *db,
                                           apr_pool_t *scratch_pool)
 {
   svn_wc__db_wcroot_t *wcroot;
+  int changes_before;
   const char *local_relpath;
 
   SVN_ERR_ASSERT(svn_dirent_is_absolute(local_abspath));
@@ -14951,12 +15820,15 @@ svn_wc__db_temp_op_start_directory_update(svn_wc__db_t *db,
                               local_abspath, scratch_pool, scratch_pool));
   VERIFY_USABLE_WCROOT(wcroot);
 
+  changes_before = svn_sqlite__total_changes(wcroot->sdb);
+
   SVN_WC__DB_WITH_TXN(
     start_directory_update_txn(wcroot, local_relpath,
                                new_repos_relpath, new_rev, scratch_pool),
     wcroot);
 
-  SVN_ERR(flush_entries(wcroot, local_abspath, svn_depth_empty, scratch_pool));
+  SVN_ERR(flush_entries(wcroot, changes_before, local_abspath, svn_depth_empty,
+                        scratch_pool));
 
   return SVN_NO_ERROR;
 }
@@ -15310,6 +16182,7 @@ svn_wc__db_op_make_copy(svn_wc__db_t *db,
                         apr_pool_t *scratch_pool)
 {
   svn_wc__db_wcroot_t *wcroot;
+  int changes_before;
   const char *local_relpath;
 
   SVN_ERR_ASSERT(svn_dirent_is_absolute(local_abspath));
@@ -15318,13 +16191,15 @@ svn_wc__db_op_make_copy(svn_wc__db_t *db,
                               local_abspath, scratch_pool, scratch_pool));
   VERIFY_USABLE_WCROOT(wcroot);
 
+  changes_before = svn_sqlite__total_changes(wcroot->sdb);
+
   SVN_WC__DB_WITH_TXN(
     svn_wc__db_op_make_copy_internal(wcroot, local_relpath, FALSE,
                                      conflicts, work_items,
                                      scratch_pool),
     wcroot);
 
-  SVN_ERR(flush_entries(wcroot, local_abspath,
+  SVN_ERR(flush_entries(wcroot, changes_before, local_abspath,
                         svn_depth_infinity, scratch_pool));
 
   return SVN_NO_ERROR;
@@ -16219,8 +17094,8 @@ process_committed_leaf(svn_wc__db_t *db,
                              path_for_error_message(wcroot, local_relpath,
                                                     scratch_pool));
 
-    SVN_ERR(flush_entries(wcroot, lock_relpath, svn_depth_empty,
-                          scratch_pool));
+    SVN_ERR(flush_entries(wcroot, svn_sqlite__total_changes(wcroot->sdb),
+                          lock_relpath, svn_depth_empty, scratch_pool));
   }
 
   if (status == svn_wc__db_status_not_present)
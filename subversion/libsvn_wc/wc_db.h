@@ -268,6 +268,42 @@ svn_wc__db_open(svn_wc__db_t **db,
 svn_error_t *
 svn_wc__db_close(svn_wc__db_t *db);
 
+/* Upper limit for the "install-threads" working copy option.  */
+#define SVN_WC__DB_MAX_INSTALL_THREADS 64
+
+/* Return the number of threads that svn_wc__wq_run() may use to install
+   files into working copies opened via DB.  This is always at least 1,
+   which means that work queue items are run strictly sequentially.  */
+int
+svn_wc__db_get_install_threads(svn_wc__db_t *db);
+
+/* Upper limit for the "status-threads" working copy option.  */
+#define SVN_WC__DB_MAX_STATUS_THREADS 64
+
+/* Return the number of threads that status walks may use to read
+   directories and file contents of working copies opened via DB ahead of
+   reporting them.  This is always at least 1, which means that status
+   walks are strictly sequential.  */
+int
+svn_wc__db_get_status_threads(svn_wc__db_t *db);
+
+/* Upper limit for the "commit-threads" working copy option.  */
+#define SVN_WC__DB_MAX_COMMIT_THREADS 64
+
+/* Return the number of threads that commits may use to prepare the text
+   deltas of files in working copies opened via DB ahead of sending them.
+   This is always at least 1, which means that every delta is computed
+   while it is being sent.  */
+int
+svn_wc__db_get_commit_threads(svn_wc__db_t *db);
+
+/* Return the absolute path of the pristine store that working copies
+   opened via DB share with all other working copies on this host, as set
+   by the "shared-pristine-store" working copy option, or NULL if pristine
+   texts are not shared.  */
+const char *
+svn_wc__db_get_shared_pristine_store(svn_wc__db_t *db);
+
 
 /* Initialize the SDB for LOCAL_ABSPATH, which should be a working copy path.
 
@@ -985,6 +1021,32 @@ svn_error_t *
 svn_wc__db_pristine_install_abort(svn_wc__db_install_data_t *install_data,
                                   apr_pool_t *scratch_pool);
 
+/* Set *TEMP_DIR_ABSPATH to the directory in which temporary text bases
+   for the working copy containing WRI_ABSPATH in DB are created.  A stream
+   opened there by svn_stream__create_for_install() can be installed with
+   svn_wc__db_pristine_install_stream().  Unlike a stream returned by
+   svn_wc__db_pristine_prepare_install(), it may be created and written
+   in another thread, because that does not involve DB.
+
+   Allocate *TEMP_DIR_ABSPATH in RESULT_POOL. */
+svn_error_t *
+svn_wc__db_pristine_get_install_tempdir(const char **temp_dir_abspath,
+                                        svn_wc__db_t *db,
+                                        const char *wri_abspath,
+                                        apr_pool_t *result_pool,
+                                        apr_pool_t *scratch_pool);
+
+/* Like svn_wc__db_pristine_install(), but install INSTALL_STREAM, which
+   has been created in the directory returned by
+   svn_wc__db_pristine_get_install_tempdir() for WRI_ABSPATH. */
+svn_error_t *
+svn_wc__db_pristine_install_stream(svn_stream_t *install_stream,
+                                   const svn_checksum_t *sha1_checksum,
+                                   const svn_checksum_t *md5_checksum,
+                                   svn_wc__db_t *db,
+                                   const char *wri_abspath,
+                                   apr_pool_t *scratch_pool);
+
 
 /* Set *MD5_CHECKSUM to the MD-5 checksum of a pristine text
    identified by its SHA-1 checksum SHA1_CHECKSUM. Return an error
@@ -1057,6 +1119,31 @@ svn_wc__db_pristine_check(svn_boolean_t *present,
                           const svn_checksum_t *sha1_checksum,
                           apr_pool_t *scratch_pool);
 
+/* Set *CONTENTS to a readable stream of the pristine text with SHA-1
+   checksum SHA1_CHECKSUM in the pristine store shared by all working
+   copies opened via DB, or to NULL if there is no shared store or it
+   doesn't contain that text (or SHA1_CHECKSUM is not a SHA-1 checksum).
+   Texts that are not owned by the current user or whose contents don't
+   match SHA1_CHECKSUM are ignored as well.
+
+   Allocate the stream in RESULT_POOL. */
+svn_error_t *
+svn_wc__db_pristine_read_shared(svn_stream_t **contents,
+                                svn_wc__db_t *db,
+                                const svn_checksum_t *sha1_checksum,
+                                apr_pool_t *result_pool,
+                                apr_pool_t *scratch_pool);
+
+/* Remove the pristine texts from the pristine store shared by all working
+   copies opened via DB that are no longer hard linked from any working
+   copy, as well as stale temporary files.  Do nothing if there is no
+   shared store. */
+svn_error_t *
+svn_wc__db_pristine_prune_shared(svn_wc__db_t *db,
+                                 svn_cancel_func_t cancel_func,
+                                 void *cancel_baton,
+                                 apr_pool_t *scratch_pool);
+
 /* @defgroup svn_wc__db_external  External management
    @{ */
 
@@ -2047,6 +2134,26 @@ svn_wc__db_read_children_info(apr_hash_t **nodes,
                               apr_pool_t *result_pool,
                               apr_pool_t *scratch_pool);
 
+/* Read the information about all children of the directory LOCAL_ABSPATH
+   with one query and keep it in memory, so that svn_wc__db_read_info() and
+   svn_wc__db_base_get_info() calls on these children can be answered
+   without accessing the database.  This is useful for operations that
+   visit every child of a directory one by one, like the update editor.
+
+   The information is discarded when RESULT_POOL is cleared.  It is
+   discarded for individual nodes when they are changed through DB and
+   completely when DB is written to in ways that don't tell which nodes
+   have changed.  Changes made through other svn_wc__db_t instances are
+   not noticed, so RESULT_POOL should not live longer than the operation
+   the information is needed for.
+
+   Use SCRATCH_POOL for temporary allocations. */
+svn_error_t *
+svn_wc__db_prefetch_children(svn_wc__db_t *db,
+                             const char *local_abspath,
+                             apr_pool_t *result_pool,
+                             apr_pool_t *scratch_pool);
+
 /* Like svn_wc__db_read_children_info, but only gets an info node for the root
    element.
 
@@ -3028,6 +3135,28 @@ svn_wc__db_wq_record_and_fetch_next(apr_uint64_t *id,
                                     apr_pool_t *result_pool,
                                     apr_pool_t *scratch_pool);
 
+/* Batch variant of svn_wc__db_wq_record_and_fetch_next().
+
+   In a single transaction, mark all work items in COMPLETED_IDS (an array
+   of apr_uint64_t, may be NULL) as completed, record timestamps and sizes
+   from RECORD_MAP (may be NULL) and return up to MAX_ITEMS of the next work
+   items in queue order.  Their identifiers are returned in *IDS (an array
+   of apr_uint64_t) and their data in *WORK_ITEMS (an array of svn_skel_t *).
+   Both arrays will be empty if there is no more work to do.
+
+   RESULT_POOL will be used to allocate the arrays and the work items, and
+   SCRATCH_POOL will be used for all temporary allocations.  */
+svn_error_t *
+svn_wc__db_wq_record_and_fetch_batch(apr_array_header_t **ids,
+                                     apr_array_header_t **work_items,
+                                     svn_wc__db_t *db,
+                                     const char *wri_abspath,
+                                     const apr_array_header_t *completed_ids,
+                                     apr_hash_t *record_map,
+                                     int max_items,
+                                     apr_pool_t *result_pool,
+                                     apr_pool_t *scratch_pool);
+
 
 /* @} */
 
@@ -40,38 +40,34 @@
 #define PRISTINE_STORAGE_RELPATH "pristine"
 #define PRISTINE_TEMPDIR_RELPATH "tmp"
 
+/* Temporary files older than this are left over by crashed processes and
+   removed from the shared pristine store when it is pruned. */
+#define SHARED_STORE_TEMP_MAX_AGE apr_time_from_sec(24 * 60 * 60)
+
 
 
 /* Returns in PRISTINE_ABSPATH a new string allocated from RESULT_POOL,
    holding the local absolute path to the file location that is dedicated
-   to hold CHECKSUM's pristine file, relating to the pristine store
-   configured for the working copy indicated by PDH. The returned path
-   does not necessarily currently exist.
+   to hold CHECKSUM's pristine file in the pristine store located at
+   BASE_DIR_ABSPATH. The returned path does not necessarily currently exist.
 
    Any other allocations are made in SCRATCH_POOL. */
 static svn_error_t *
-get_pristine_fname(const char **pristine_abspath,
-                   const char *wcroot_abspath,
-                   const svn_checksum_t *sha1_checksum,
-                   apr_pool_t *result_pool,
-                   apr_pool_t *scratch_pool)
+get_store_fname(const char **pristine_abspath,
+                const char *base_dir_abspath,
+                const svn_checksum_t *sha1_checksum,
+                apr_pool_t *result_pool,
+                apr_pool_t *scratch_pool)
 {
-  const char *base_dir_abspath;
   const char *hexdigest = svn_checksum_to_cstring(sha1_checksum, scratch_pool);
   char subdir[3];
 
   /* ### code is in transition. make sure we have the proper data.  */
   SVN_ERR_ASSERT(pristine_abspath != NULL);
-  SVN_ERR_ASSERT(svn_dirent_is_absolute(wcroot_abspath));
+  SVN_ERR_ASSERT(svn_dirent_is_absolute(base_dir_abspath));
   SVN_ERR_ASSERT(sha1_checksum != NULL);
   SVN_ERR_ASSERT(sha1_checksum->kind == svn_checksum_sha1);
 
-  base_dir_abspath = svn_dirent_join_many(scratch_pool,
-                                          wcroot_abspath,
-                                          svn_wc_get_adm_dir(scratch_pool),
-                                          PRISTINE_STORAGE_RELPATH,
-                                          SVN_VA_NULL);
-
   /* We should have a valid checksum and (thus) a valid digest. */
   SVN_ERR_ASSERT(hexdigest != NULL);
 
@@ -83,7 +79,7 @@ get_pristine_fname(const char **pristine_abspath,
   hexdigest = apr_pstrcat(scratch_pool, hexdigest, PRISTINE_STORAGE_EXT,
                           SVN_VA_NULL);
 
-  /* The file is located at DIR/.svn/pristine/XX/XXYYZZ...svn-base */
+  /* The file is located at BASE_DIR/XX/XXYYZZ...svn-base */
   *pristine_abspath = svn_dirent_join_many(result_pool,
                                            base_dir_abspath,
                                            subdir,
@@ -92,6 +88,32 @@ get_pristine_fname(const char **pristine_abspath,
   return SVN_NO_ERROR;
 }
 
+/* Returns in PRISTINE_ABSPATH a new string allocated from RESULT_POOL,
+   holding the local absolute path to the file location that is dedicated
+   to hold CHECKSUM's pristine file, relating to the pristine store
+   of the working copy at WCROOT_ABSPATH. The returned path does not
+   necessarily currently exist.
+
+   Any other allocations are made in SCRATCH_POOL. */
+static svn_error_t *
+get_pristine_fname(const char **pristine_abspath,
+                   const char *wcroot_abspath,
+                   const svn_checksum_t *sha1_checksum,
+                   apr_pool_t *result_pool,
+                   apr_pool_t *scratch_pool)
+{
+  SVN_ERR_ASSERT(svn_dirent_is_absolute(wcroot_abspath));
+
+  /* The file is located at DIR/.svn/pristine/XX/XXYYZZ...svn-base */
+  return svn_error_trace(get_store_fname(
+                           pristine_abspath,
+                           svn_dirent_join_many(
+                             scratch_pool, wcroot_abspath,
+                             svn_wc_get_adm_dir(scratch_pool),
+                             PRISTINE_STORAGE_RELPATH, SVN_VA_NULL),
+                           sha1_checksum, result_pool, scratch_pool));
+}
+
 
 svn_error_t *
 svn_wc__db_pristine_get_path(const char **pristine_abspath,
@@ -268,10 +290,179 @@ pristine_get_tempdir(svn_wc__db_wcroot_t *wcroot,
                               PRISTINE_TEMPDIR_RELPATH, SVN_VA_NULL);
 }
 
+/* Set *VALID to whether PRISTINE_ABSPATH, just linked or cloned from the
+ * shared pristine store, can be trusted to hold the pristine text with
+ * SHA1_CHECKSUM and SIZE.
+ *
+ * Anybody may put files into the shared store, so we check the content.
+ * A HARD_LINK must also be owned by us, because otherwise its owner could
+ * still modify it.  Checking our own path rather than the store entry
+ * ensures that we check the file we are going to use. */
+static svn_error_t *
+verify_shared_link(svn_boolean_t *valid,
+                   const char *pristine_abspath,
+                   svn_boolean_t hard_link,
+                   apr_off_t size,
+                   const svn_checksum_t *sha1_checksum,
+                   apr_pool_t *scratch_pool)
+{
+  apr_finfo_t finfo;
+  svn_checksum_t *actual_checksum;
+
+  *valid = FALSE;
+
+  SVN_ERR(svn_io_stat(&finfo, pristine_abspath,
+                      APR_FINFO_SIZE | APR_FINFO_USER, scratch_pool));
+  if (finfo.size != size)
+    return SVN_NO_ERROR;
+
+  if (hard_link)
+    {
+      svn_boolean_t owned;
+
+      SVN_ERR(svn_io__is_finfo_owned(&owned, &finfo, scratch_pool));
+      if (!owned)
+        return SVN_NO_ERROR;
+    }
+
+  SVN_ERR(svn_io_file_checksum2(&actual_checksum, pristine_abspath,
+                                svn_checksum_sha1, scratch_pool));
+  *valid = svn_checksum_match(actual_checksum, sha1_checksum);
+
+  return SVN_NO_ERROR;
+}
+
+/* Try to create PRISTINE_ABSPATH as a hard link to, or else as a clone
+ * of, the file with SHA1_CHECKSUM and SIZE in the shared pristine store at
+ * SHARED_ABSPATH.  Set *LINKED to whether that succeeded and the result
+ * passed verify_shared_link().  Only a clone will be made read-only.
+ *
+ * Hard links count as references to the shared text, see
+ * svn_wc__db_pristine_prune_shared().  Clones share the data blocks
+ * copy-on-write but are independent files. */
+static svn_error_t *
+link_from_shared_store(svn_boolean_t *linked,
+                       const char *shared_abspath,
+                       const char *pristine_abspath,
+                       const svn_checksum_t *sha1_checksum,
+                       apr_off_t size,
+                       apr_pool_t *scratch_pool)
+{
+  const char *shared_fname;
+  svn_node_kind_t kind;
+  svn_boolean_t hard_link = TRUE;
+  svn_error_t *err;
+
+  *linked = FALSE;
+
+  SVN_ERR(get_store_fname(&shared_fname, shared_abspath, sha1_checksum,
+                          scratch_pool, scratch_pool));
+  SVN_ERR(svn_io_check_path(shared_fname, &kind, scratch_pool));
+  if (kind != svn_node_file)
+    return SVN_NO_ERROR;
+
+  /* An orphan file left at the target doesn't matter. */
+  SVN_ERR(svn_io_remove_file2(pristine_abspath, TRUE, scratch_pool));
+  SVN_ERR(svn_io_make_dir_recursively(svn_dirent_dirname(pristine_abspath,
+                                                         scratch_pool),
+                                      scratch_pool));
+
+  err = svn_io__link_file(shared_fname, pristine_abspath, scratch_pool);
+  if (err)
+    {
+      svn_error_clear(err);
+      hard_link = FALSE;
+      err = svn_io__clone_file(shared_fname, pristine_abspath, scratch_pool);
+    }
+
+  /* If another process pruned the text in the meantime, or the file system
+     doesn't support either kind of link, we just install our own copy. */
+  if (err)
+    {
+      svn_error_clear(err);
+      return SVN_NO_ERROR;
+    }
+
+  SVN_ERR(verify_shared_link(linked, pristine_abspath, hard_link, size,
+                             sha1_checksum, scratch_pool));
+  if (!*linked)
+    return svn_error_trace(svn_io_remove_file2(pristine_abspath, FALSE,
+                                               scratch_pool));
+
+  /* Don't touch the permissions of a shared inode. */
+  if (!hard_link)
+    SVN_ERR(svn_io_set_file_read_only(pristine_abspath, FALSE,
+                                      scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Make the newly installed PRISTINE_ABSPATH with SHA1_CHECKSUM available
+ * in the shared pristine store at SHARED_ABSPATH, preferably as a hard
+ * link.  If it is already available, do nothing.
+ *
+ * The shared store is only a cache, so callers should ignore errors. */
+static svn_error_t *
+publish_to_shared_store(const char *shared_abspath,
+                        const char *pristine_abspath,
+                        const svn_checksum_t *sha1_checksum,
+                        apr_pool_t *scratch_pool)
+{
+  const char *shared_fname;
+  const char *temp_abspath;
+  svn_error_t *err;
+
+  SVN_ERR(get_store_fname(&shared_fname, shared_abspath, sha1_checksum,
+                          scratch_pool, scratch_pool));
+  SVN_ERR(svn_io_make_dir_recursively(svn_dirent_dirname(shared_fname,
+                                                         scratch_pool),
+                                      scratch_pool));
+
+  /* Creating the link is atomic, so concurrent installers of the same text
+     either add the first link or find the store entry already there. */
+  err = svn_io__link_file(pristine_abspath, shared_fname, scratch_pool);
+  if (!err || APR_STATUS_IS_EEXIST(err->apr_err))
+    {
+      svn_error_clear(err);
+      return SVN_NO_ERROR;
+    }
+  svn_error_clear(err);
+
+  /* Hard links are not possible, e.g. because the store is on another file
+     system.  Store a copy and move it into place, so that readers never see
+     an incomplete text. */
+  SVN_ERR(svn_io_make_dir_recursively(
+            svn_dirent_join(shared_abspath, PRISTINE_TEMPDIR_RELPATH,
+                            scratch_pool),
+            scratch_pool));
+  SVN_ERR(svn_io_open_unique_file3(NULL, &temp_abspath,
+                                   svn_dirent_join(shared_abspath,
+                                                   PRISTINE_TEMPDIR_RELPATH,
+                                                   scratch_pool),
+                                   svn_io_file_del_none,
+                                   scratch_pool, scratch_pool));
+  err = svn_io_copy_file(pristine_abspath, temp_abspath, FALSE,
+                         scratch_pool);
+  if (!err)
+    err = svn_io_set_file_read_only(temp_abspath, FALSE, scratch_pool);
+  if (!err)
+    err = svn_io_file_rename2(temp_abspath, shared_fname, FALSE,
+                              scratch_pool);
+  if (err)
+    return svn_error_compose_create(
+             err, svn_io_remove_file2(temp_abspath, TRUE, scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
 /* Install the pristine text described by BATON into the pristine store of
  * SDB.  If it is already stored then just delete the new file
  * BATON->tempfile_abspath.
  *
+ * If SHARED_ABSPATH is not NULL, link the text from the shared pristine
+ * store at that path if it is available there, and publish it there
+ * otherwise.
+ *
  * This function expects to be executed inside a SQLite txn that has already
  * acquired a 'RESERVED' lock.
  *
@@ -287,6 +478,8 @@ pristine_install_txn(svn_sqlite__db_t *sdb,
                      const svn_checksum_t *sha1_checksum,
                      /* The pristine text's MD-5 checksum. */
                      const svn_checksum_t *md5_checksum,
+                     /* The shared pristine store, or NULL. */
+                     const char *shared_abspath,
                      apr_pool_t *scratch_pool)
 {
   svn_sqlite__stmt_t *stmt;
@@ -333,10 +526,22 @@ pristine_install_txn(svn_sqlite__db_t *sdb,
    * an orphan file and it doesn't matter if we overwrite it.) */
   {
     apr_finfo_t finfo;
+    svn_boolean_t linked = FALSE;
+
     SVN_ERR(svn_stream__install_get_info(&finfo, install_stream,
                                          APR_FINFO_SIZE, scratch_pool));
-    SVN_ERR(svn_stream__install_stream(install_stream, pristine_abspath,
-                                       TRUE, scratch_pool));
+
+    /* Only delete our own copy once the shared one is in place, so that
+     * a concurrent prune of the shared store can't make us lose the text. */
+    if (shared_abspath)
+      SVN_ERR(link_from_shared_store(&linked, shared_abspath,
+                                     pristine_abspath, sha1_checksum,
+                                     finfo.size, scratch_pool));
+    if (linked)
+      SVN_ERR(svn_stream__install_delete(install_stream, scratch_pool));
+    else
+      SVN_ERR(svn_stream__install_stream(install_stream, pristine_abspath,
+                                         TRUE, scratch_pool));
 
     SVN_ERR(svn_sqlite__get_statement(&stmt, sdb, STMT_INSERT_PRISTINE));
     SVN_ERR(svn_sqlite__bind_checksum(stmt, 1, sha1_checksum, scratch_pool));
@@ -344,7 +549,15 @@ pristine_install_txn(svn_sqlite__db_t *sdb,
     SVN_ERR(svn_sqlite__bind_int64(stmt, 3, finfo.size));
     SVN_ERR(svn_sqlite__insert(NULL, stmt));
 
-    SVN_ERR(svn_io_set_file_read_only(pristine_abspath, FALSE, scratch_pool));
+    if (!linked)
+      SVN_ERR(svn_io_set_file_read_only(pristine_abspath, FALSE,
+                                        scratch_pool));
+
+    if (shared_abspath && !linked)
+      svn_error_clear(publish_to_shared_store(shared_abspath,
+                                              pristine_abspath,
+                                              sha1_checksum,
+                                              scratch_pool));
   }
 
   return SVN_NO_ERROR;
@@ -354,6 +567,9 @@ struct svn_wc__db_install_data_t
 {
   svn_wc__db_wcroot_t *wcroot;
   svn_stream_t *inner_stream;
+
+  /* The shared pristine store, or NULL. */
+  const char *shared_abspath;
 };
 
 svn_error_t *
@@ -380,6 +596,7 @@ svn_wc__db_pristine_prepare_install(svn_stream_t **stream,
 
   *install_data = apr_pcalloc(result_pool, sizeof(**install_data));
   (*install_data)->wcroot = wcroot;
+  (*install_data)->shared_abspath = db->shared_pristine_abspath;
 
   SVN_ERR_W(svn_stream__create_for_install(stream,
                                            temp_dir_abspath,
@@ -422,6 +639,7 @@ svn_wc__db_pristine_install(svn_wc__db_install_data_t *install_data,
     pristine_install_txn(wcroot->sdb,
                          install_data->inner_stream, pristine_abspath,
                          sha1_checksum, md5_checksum,
+                         install_data->shared_abspath,
                          scratch_pool),
     wcroot->sdb);
 
@@ -436,6 +654,55 @@ svn_wc__db_pristine_install_abort(svn_wc__db_install_data_t *install_data,
                                                     scratch_pool));
 }
 
+svn_error_t *
+svn_wc__db_pristine_get_install_tempdir(const char **temp_dir_abspath,
+                                        svn_wc__db_t *db,
+                                        const char *wri_abspath,
+                                        apr_pool_t *result_pool,
+                                        apr_pool_t *scratch_pool)
+{
+  svn_wc__db_wcroot_t *wcroot;
+  const char *local_relpath;
+
+  SVN_ERR_ASSERT(svn_dirent_is_absolute(wri_abspath));
+
+  SVN_ERR(svn_wc__db_wcroot_parse_local_abspath(&wcroot, &local_relpath, db,
+                              wri_abspath, scratch_pool, scratch_pool));
+  VERIFY_USABLE_WCROOT(wcroot);
+
+  *temp_dir_abspath = pristine_get_tempdir(wcroot, result_pool,
+                                           scratch_pool);
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_wc__db_pristine_install_stream(svn_stream_t *install_stream,
+                                   const svn_checksum_t *sha1_checksum,
+                                   const svn_checksum_t *md5_checksum,
+                                   svn_wc__db_t *db,
+                                   const char *wri_abspath,
+                                   apr_pool_t *scratch_pool)
+{
+  svn_wc__db_install_data_t install_data;
+  const char *local_relpath;
+
+  SVN_ERR_ASSERT(svn_dirent_is_absolute(wri_abspath));
+
+  SVN_ERR(svn_wc__db_wcroot_parse_local_abspath(&install_data.wcroot,
+                                                &local_relpath, db,
+                                                wri_abspath,
+                                                scratch_pool, scratch_pool));
+  VERIFY_USABLE_WCROOT(install_data.wcroot);
+
+  install_data.inner_stream = install_stream;
+  install_data.shared_abspath = db->shared_pristine_abspath;
+
+  return svn_error_trace(svn_wc__db_pristine_install(&install_data,
+                                                     sha1_checksum,
+                                                     md5_checksum,
+                                                     scratch_pool));
+}
+
 
 svn_error_t *
 svn_wc__db_pristine_get_md5(const svn_checksum_t **md5_checksum,
@@ -883,6 +1150,166 @@ svn_wc__db_pristine_cleanup(svn_wc__db_t *db,
 }
 
 
+svn_error_t *
+svn_wc__db_pristine_read_shared(svn_stream_t **contents,
+                                svn_wc__db_t *db,
+                                const svn_checksum_t *sha1_checksum,
+                                apr_pool_t *result_pool,
+                                apr_pool_t *scratch_pool)
+{
+  const char *shared_fname;
+  apr_file_t *file;
+  apr_finfo_t finfo;
+  svn_boolean_t owned;
+  svn_checksum_t *actual_checksum;
+  apr_off_t offset = 0;
+  svn_error_t *err;
+
+  *contents = NULL;
+
+  if (!db->shared_pristine_abspath
+      || sha1_checksum->kind != svn_checksum_sha1)
+    return SVN_NO_ERROR;
+
+  SVN_ERR(get_store_fname(&shared_fname, db->shared_pristine_abspath,
+                          sha1_checksum, scratch_pool, scratch_pool));
+
+  /* Like in pristine_read_txn(), the file stays readable even if the
+   * text is pruned from the store while we read it. */
+  err = svn_io_file_open(&file, shared_fname, APR_READ | APR_BINARY,
+                         APR_OS_DEFAULT, result_pool);
+  if (err && (APR_STATUS_IS_ENOENT(err->apr_err)
+              || SVN__APR_STATUS_IS_ENOTDIR(err->apr_err)))
+    {
+      svn_error_clear(err);
+      return SVN_NO_ERROR;
+    }
+  SVN_ERR(err);
+
+  /* Anybody may put files into the shared store.  Like verify_shared_link(),
+   * only trust a file that nobody else can modify and that has the expected
+   * contents.  Check the file we opened, not the path. */
+  SVN_ERR(svn_io_file_info_get(&finfo, APR_FINFO_USER, file, scratch_pool));
+  SVN_ERR(svn_io__is_finfo_owned(&owned, &finfo, scratch_pool));
+  if (!owned)
+    return svn_error_trace(svn_io_file_close(file, scratch_pool));
+
+  SVN_ERR(svn_stream_contents_checksum(&actual_checksum,
+                                       svn_stream_from_aprfile2(file, TRUE,
+                                                                scratch_pool),
+                                       svn_checksum_sha1,
+                                       scratch_pool, scratch_pool));
+  if (!svn_checksum_match(actual_checksum, sha1_checksum))
+    return svn_error_trace(svn_io_file_close(file, scratch_pool));
+
+  SVN_ERR(svn_io_file_seek(file, APR_SET, &offset, scratch_pool));
+  *contents = svn_stream_from_aprfile2(file, FALSE, result_pool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Remove the texts in the subdirectory DIR_ABSPATH of the shared pristine
+   store that have no other hard links anymore.  If IS_TEMP_DIR, remove the
+   files older than SHARED_STORE_TEMP_MAX_AGE instead. */
+static svn_error_t *
+prune_shared_dir(const char *dir_abspath,
+                 svn_boolean_t is_temp_dir,
+                 svn_cancel_func_t cancel_func,
+                 void *cancel_baton,
+                 apr_pool_t *scratch_pool)
+{
+  apr_hash_t *dirents;
+  apr_hash_index_t *hi;
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  apr_time_t now = apr_time_now();
+
+  SVN_ERR(svn_io_get_dirents3(&dirents, dir_abspath, TRUE,
+                              scratch_pool, scratch_pool));
+
+  for (hi = apr_hash_first(scratch_pool, dirents); hi; hi = apr_hash_next(hi))
+    {
+      const char *name = apr_hash_this_key(hi);
+      const svn_io_dirent2_t *dirent = apr_hash_this_val(hi);
+      const char *file_abspath;
+      apr_finfo_t finfo;
+      svn_error_t *err;
+
+      if (dirent->kind != svn_node_file)
+        continue;
+
+      svn_pool_clear(iterpool);
+
+      if (cancel_func)
+        SVN_ERR(cancel_func(cancel_baton));
+
+      file_abspath = svn_dirent_join(dir_abspath, name, iterpool);
+
+      if (is_temp_dir)
+        {
+          if (now - dirent->mtime > SHARED_STORE_TEMP_MAX_AGE)
+            svn_error_clear(svn_io_remove_file2(file_abspath, TRUE,
+                                                iterpool));
+          continue;
+        }
+
+      /* The store's own link is the only one left, so no working copy
+       * references the text anymore.  A working copy that links it right
+       * after this check keeps the text alive via its own link. */
+      err = svn_io_stat(&finfo, file_abspath, APR_FINFO_NLINK, iterpool);
+      if (err)
+        svn_error_clear(err);
+      else if ((finfo.valid & APR_FINFO_NLINK) && finfo.nlink == 1)
+        svn_error_clear(svn_io_remove_file2(file_abspath, TRUE, iterpool));
+    }
+
+  svn_pool_destroy(iterpool);
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+svn_wc__db_pristine_prune_shared(svn_wc__db_t *db,
+                                 svn_cancel_func_t cancel_func,
+                                 void *cancel_baton,
+                                 apr_pool_t *scratch_pool)
+{
+  apr_hash_t *dirents;
+  apr_hash_index_t *hi;
+  apr_pool_t *iterpool;
+  svn_error_t *err;
+
+  if (!db->shared_pristine_abspath)
+    return SVN_NO_ERROR;
+
+  err = svn_io_get_dirents3(&dirents, db->shared_pristine_abspath, TRUE,
+                            scratch_pool, scratch_pool);
+  if (err && APR_STATUS_IS_ENOENT(err->apr_err))
+    {
+      svn_error_clear(err);
+      return SVN_NO_ERROR;
+    }
+  SVN_ERR(err);
+
+  iterpool = svn_pool_create(scratch_pool);
+  for (hi = apr_hash_first(scratch_pool, dirents); hi; hi = apr_hash_next(hi))
+    {
+      const char *name = apr_hash_this_key(hi);
+      const svn_io_dirent2_t *dirent = apr_hash_this_val(hi);
+
+      if (dirent->kind != svn_node_dir)
+        continue;
+
+      svn_pool_clear(iterpool);
+      SVN_ERR(prune_shared_dir(svn_dirent_join(db->shared_pristine_abspath,
+                                               name, iterpool),
+                               strcmp(name, PRISTINE_TEMPDIR_RELPATH) == 0,
+                               cancel_func, cancel_baton, iterpool));
+    }
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+
 svn_error_t *
 svn_wc__db_pristine_check(svn_boolean_t *present,
                           svn_wc__db_t *db,
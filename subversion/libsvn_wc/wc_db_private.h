@@ -52,6 +52,22 @@ struct svn_wc__db_t {
   /* Busy timeout in ms., 0 for the libsvn_subr default. */
   apr_int32_t timeout;
 
+  /* Number of threads to use for installing files from the work queue.
+     Values of 1 or less process the work queue strictly sequentially. */
+  int install_threads;
+
+  /* Number of threads to use for reading directories and file contents
+     ahead of status walks.  Values of 1 or less walk sequentially. */
+  int status_threads;
+
+  /* Number of threads to use for preparing the text deltas of a commit.
+     Values of 1 or less compute each delta while sending it. */
+  int commit_threads;
+
+  /* The absolute path of the pristine store shared by all working copies
+     on this host, or NULL if pristine texts are not shared. */
+  const char *shared_pristine_abspath;
+
   /* Map a given working copy directory to its relevant data.
      const char *local_abspath -> svn_wc__db_wcroot_t *wcroot  */
   apr_hash_t *dir_data;
@@ -107,6 +123,15 @@ typedef struct svn_wc__db_wcroot_t {
      const char *local_abspath -> svn_wc_adm_access_t *adm_access */
   apr_hash_t *access_cache;
 
+  /* Map a directory to the information about its children that has been
+     read ahead by svn_wc__db_prefetch_children().
+     const char *local_relpath -> struct read_cache_dir_t *dir  */
+  apr_hash_t *read_cache;
+
+  /* The svn_sqlite__total_changes() of SDB at the time READ_CACHE was
+     last known to be up to date. */
+  int read_cache_changes;
+
 } svn_wc__db_wcroot_t;
 
 
@@ -232,6 +232,9 @@ svn_wc__db_open(svn_wc__db_t **db,
   (*db)->verify_format = !open_without_upgrade;
   (*db)->enforce_empty_wq = enforce_empty_wq;
   (*db)->dir_data = apr_hash_make(result_pool);
+  (*db)->install_threads = 1;
+  (*db)->status_threads = 1;
+  (*db)->commit_threads = 1;
 
   (*db)->state_pool = result_pool;
 
@@ -241,6 +244,8 @@ svn_wc__db_open(svn_wc__db_t **db,
       svn_error_t *err;
       svn_boolean_t sqlite_exclusive = FALSE;
       apr_int64_t timeout;
+      apr_int64_t threads;
+      const char *store_dir;
 
       err = svn_config_get_bool(config, &sqlite_exclusive,
                                 SVN_CONFIG_SECTION_WORKING_COPY,
@@ -261,12 +266,82 @@ svn_wc__db_open(svn_wc__db_t **db,
         svn_error_clear(err);
       else
         (*db)->timeout = (apr_int32_t)timeout;
+
+      err = svn_config_get_int64(config, &threads,
+                                 SVN_CONFIG_SECTION_WORKING_COPY,
+                                 SVN_CONFIG_OPTION_WC_INSTALL_THREADS,
+                                 1);
+      if (err || threads < 1 || threads > SVN_WC__DB_MAX_INSTALL_THREADS)
+        svn_error_clear(err);
+      else
+        (*db)->install_threads = (int)threads;
+
+      err = svn_config_get_int64(config, &threads,
+                                 SVN_CONFIG_SECTION_WORKING_COPY,
+                                 SVN_CONFIG_OPTION_WC_STATUS_THREADS,
+                                 1);
+      if (err || threads < 1 || threads > SVN_WC__DB_MAX_STATUS_THREADS)
+        svn_error_clear(err);
+      else
+        (*db)->status_threads = (int)threads;
+
+      err = svn_config_get_int64(config, &threads,
+                                 SVN_CONFIG_SECTION_WORKING_COPY,
+                                 SVN_CONFIG_OPTION_WC_COMMIT_THREADS,
+                                 1);
+      if (err || threads < 1 || threads > SVN_WC__DB_MAX_COMMIT_THREADS)
+        svn_error_clear(err);
+      else
+        (*db)->commit_threads = (int)threads;
+
+      svn_config_get(config, &store_dir, SVN_CONFIG_SECTION_WORKING_COPY,
+                     SVN_CONFIG_OPTION_WC_SHARED_PRISTINE_STORE, NULL);
+      if (store_dir && *store_dir)
+        {
+          err = svn_dirent_get_absolute(&(*db)->shared_pristine_abspath,
+                                        svn_dirent_internal_style(
+                                          store_dir, scratch_pool),
+                                        result_pool);
+          if (err)
+            {
+              svn_error_clear(err);
+              (*db)->shared_pristine_abspath = NULL;
+            }
+        }
     }
 
   return SVN_NO_ERROR;
 }
 
 
+int
+svn_wc__db_get_install_threads(svn_wc__db_t *db)
+{
+  return db->install_threads;
+}
+
+
+int
+svn_wc__db_get_status_threads(svn_wc__db_t *db)
+{
+  return db->status_threads;
+}
+
+
+int
+svn_wc__db_get_commit_threads(svn_wc__db_t *db)
+{
+  return db->commit_threads;
+}
+
+
+const char *
+svn_wc__db_get_shared_pristine_store(svn_wc__db_t *db)
+{
+  return db->shared_pristine_abspath;
+}
+
+
 svn_error_t *
 svn_wc__db_close(svn_wc__db_t *db)
 {
@@ -377,6 +452,8 @@ svn_wc__db_pdh_create_wcroot(svn_wc__db_wcroot_t **wcroot,
   (*wcroot)->owned_locks = apr_array_make(result_pool, 8,
                                           sizeof(svn_wc__db_wclock_t));
   (*wcroot)->access_cache = apr_hash_make(result_pool);
+  (*wcroot)->read_cache = apr_hash_make(result_pool);
+  (*wcroot)->read_cache_changes = 0;
 
   /* SDB will be NULL for pre-NG working copies. We only need to run a
      cleanup when the SDB is present.  */
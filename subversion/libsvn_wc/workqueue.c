@@ -39,6 +39,7 @@
 #include "translate.h"
 
 #include "private/svn_io_private.h"
+#include "private/svn_parallel.h"
 #include "private/svn_skel.h"
 
 
@@ -66,6 +67,15 @@
 
 typedef struct work_item_baton_t work_item_baton_t;
 
+struct work_item_baton_t
+{
+  apr_pool_t *result_pool; /* Pool to allocate result in */
+
+  svn_boolean_t used; /* needs reset */
+
+  apr_hash_t *record_map; /* const char * -> svn_io_dirent2_t map */
+};
+
 struct work_item_dispatch {
   const char *name;
   svn_error_t *(*func)(work_item_baton_t *wqb,
@@ -77,7 +87,12 @@ struct work_item_dispatch {
                        apr_pool_t *scratch_pool);
 };
 
-/* Forward definition */
+/* Forward definitions */
+static void
+record_fileinfo(work_item_baton_t *wqb,
+                const char *local_abspath,
+                const svn_io_dirent2_t *dirent);
+
 static svn_error_t *
 get_and_record_fileinfo(work_item_baton_t *wqb,
                         const char *local_abspath,
@@ -445,60 +460,83 @@ svn_wc__wq_build_postupgrade(svn_skel_t **work_item,
 
 /* OP_FILE_INSTALL */
 
-/* Process the OP_FILE_INSTALL work item WORK_ITEM.
- * See svn_wc__wq_build_file_install() which generates this work item.
- * Implements (struct work_item_dispatch).func. */
+/* Everything needed to install a single file into the working copy.
+   Filled in by prepare_file_install() which does all the wc.db lookups,
+   so that perform_file_install() only needs to touch the file system. */
+typedef struct file_install_t
+{
+  /* The file to create. */
+  const char *local_abspath;
+
+  /* The source of the file contents in repository-normal form. */
+  const char *source_abspath;
+
+  /* Whether this is a special file (i.e. a symlink). */
+  svn_boolean_t special;
+
+  /* Translation to apply; only used when TRANSLATE is set. */
+  svn_boolean_t translate;
+  const char *eol;
+  apr_hash_t *keywords;
+
+  /* Where to create the temporary file. */
+  const char *temp_dir_abspath;
+
+  /* Tweaks to apply to the installed file. */
+  svn_boolean_t set_executable;
+  svn_boolean_t set_read_only;
+  apr_time_t set_time; /* 0 for "don't touch" */
+
+  /* Whether to stat the result to record its size and timestamp. */
+  svn_boolean_t record_fileinfo;
+} file_install_t;
+
+/* Collect the information required to process the OP_FILE_INSTALL work
+   item WORK_ITEM in *INSTALL, allocated in RESULT_POOL.  This function
+   does all the DB access for the install. */
 static svn_error_t *
-run_file_install(work_item_baton_t *wqb,
-                 svn_wc__db_t *db,
-                 const svn_skel_t *work_item,
-                 const char *wri_abspath,
-                 svn_cancel_func_t cancel_func,
-                 void *cancel_baton,
-                 apr_pool_t *scratch_pool)
+prepare_file_install(file_install_t **install,
+                     svn_wc__db_t *db,
+                     const svn_skel_t *work_item,
+                     const char *wri_abspath,
+                     apr_pool_t *result_pool,
+                     apr_pool_t *scratch_pool)
 {
   const svn_skel_t *arg1 = work_item->children->next;
   const svn_skel_t *arg4 = arg1->next->next->next;
+  file_install_t *fi = apr_pcalloc(result_pool, sizeof(*fi));
   const char *local_relpath;
-  const char *local_abspath;
   svn_boolean_t use_commit_times;
-  svn_boolean_t record_fileinfo;
-  svn_boolean_t special;
-  svn_stream_t *src_stream;
   svn_subst_eol_style_t style;
-  const char *eol;
-  apr_hash_t *keywords;
-  const char *temp_dir_abspath;
-  svn_stream_t *dst_stream;
   apr_int64_t val;
   const char *wcroot_abspath;
-  const char *source_abspath;
   const svn_checksum_t *checksum;
   apr_hash_t *props;
   apr_time_t changed_date;
 
   local_relpath = apr_pstrmemdup(scratch_pool, arg1->data, arg1->len);
-  SVN_ERR(svn_wc__db_from_relpath(&local_abspath, db, wri_abspath,
-                                  local_relpath, scratch_pool, scratch_pool));
+  SVN_ERR(svn_wc__db_from_relpath(&fi->local_abspath, db, wri_abspath,
+                                  local_relpath, result_pool, scratch_pool));
 
   SVN_ERR(svn_skel__parse_int(&val, arg1->next, scratch_pool));
   use_commit_times = (val != 0);
   SVN_ERR(svn_skel__parse_int(&val, arg1->next->next, scratch_pool));
-  record_fileinfo = (val != 0);
+  fi->record_fileinfo = (val != 0);
 
   SVN_ERR(svn_wc__db_read_node_install_info(&wcroot_abspath,
                                             &checksum, &props,
                                             &changed_date,
-                                            db, local_abspath, wri_abspath,
+                                            db, fi->local_abspath,
+                                            wri_abspath,
                                             scratch_pool, scratch_pool));
 
   if (arg4 != NULL)
     {
       /* Use the provided path for the source.  */
       local_relpath = apr_pstrmemdup(scratch_pool, arg4->data, arg4->len);
-      SVN_ERR(svn_wc__db_from_relpath(&source_abspath, db, wri_abspath,
+      SVN_ERR(svn_wc__db_from_relpath(&fi->source_abspath, db, wri_abspath,
                                       local_relpath,
-                                      scratch_pool, scratch_pool));
+                                      result_pool, scratch_pool));
     }
   else if (! checksum)
     {
@@ -513,27 +551,94 @@ run_file_install(work_item_baton_t *wqb,
                                _("Can't install '%s' from pristine store, "
                                  "because no checksum is recorded for this "
                                  "file"),
-                               svn_dirent_local_style(local_abspath,
+                               svn_dirent_local_style(fi->local_abspath,
                                                       scratch_pool));
     }
   else
     {
-      SVN_ERR(svn_wc__db_pristine_get_future_path(&source_abspath,
+      SVN_ERR(svn_wc__db_pristine_get_future_path(&fi->source_abspath,
                                                   wcroot_abspath,
                                                   checksum,
-                                                  scratch_pool, scratch_pool));
+                                                  result_pool, scratch_pool));
     }
 
-  SVN_ERR(svn_stream_open_readonly(&src_stream, source_abspath,
-                                   scratch_pool, scratch_pool));
-
   /* Fetch all the translation bits.  */
-  SVN_ERR(svn_wc__get_translate_info(&style, &eol,
-                                     &keywords,
-                                     &special, db, local_abspath,
+  SVN_ERR(svn_wc__get_translate_info(&style, &fi->eol,
+                                     &fi->keywords,
+                                     &fi->special, db, fi->local_abspath,
                                      props, FALSE,
-                                     scratch_pool, scratch_pool));
-  if (special)
+                                     result_pool, scratch_pool));
+  if (fi->special)
+    {
+      /* No need to set exec or read-only flags on special files.  */
+
+      /* ### Shouldn't this record a timestamp and size, etc.? */
+      fi->record_fileinfo = FALSE;
+      *install = fi;
+      return SVN_NO_ERROR;
+    }
+
+  fi->translate = svn_subst_translation_required(style, fi->eol,
+                                                 fi->keywords,
+                                                 FALSE /* special */,
+                                                 TRUE /* force_eol_check */);
+
+  /* Where is the Right Place to put a temp file in this working copy?  */
+  SVN_ERR(svn_wc__db_temp_wcroot_tempdir(&fi->temp_dir_abspath,
+                                         db, wcroot_abspath,
+                                         result_pool, scratch_pool));
+
+#ifndef WIN32
+  fi->set_executable = (props
+                        && svn_hash_gets(props, SVN_PROP_EXECUTABLE) != NULL);
+#endif
+
+  /* Note that this explicitly checks the pristine properties, to make sure
+     that when the lock is locally set (=modification) it is not read only */
+  if (props && svn_hash_gets(props, SVN_PROP_NEEDS_LOCK))
+    {
+      svn_wc__db_status_t status;
+      svn_wc__db_lock_t *lock;
+      SVN_ERR(svn_wc__db_read_info(&status, NULL, NULL, NULL, NULL, NULL, NULL,
+                                   NULL, NULL, NULL, NULL, NULL, NULL, NULL,
+                                   NULL, NULL, &lock, NULL, NULL, NULL, NULL,
+                                   NULL, NULL, NULL, NULL, NULL, NULL,
+                                   db, fi->local_abspath,
+                                   scratch_pool, scratch_pool));
+
+      fi->set_read_only = (!lock && status != svn_wc__db_status_added);
+    }
+
+  if (use_commit_times)
+    fi->set_time = changed_date;
+
+  *install = fi;
+  return SVN_NO_ERROR;
+}
+
+/* Install the file described by INSTALL.  This only accesses the file
+   system and may therefore be called from any thread.
+
+   If INSTALL->RECORD_FILEINFO is set, return the state of the installed
+   file in *DIRENT, allocated in RESULT_POOL.  Otherwise, set it to NULL. */
+static svn_error_t *
+perform_file_install(const svn_io_dirent2_t **dirent,
+                     const file_install_t *install,
+                     svn_cancel_func_t cancel_func,
+                     void *cancel_baton,
+                     apr_pool_t *result_pool,
+                     apr_pool_t *scratch_pool)
+{
+  const char *local_abspath = install->local_abspath;
+  svn_stream_t *src_stream;
+  svn_stream_t *dst_stream;
+
+  *dirent = NULL;
+
+  SVN_ERR(svn_stream_open_readonly(&src_stream, install->source_abspath,
+                                   scratch_pool, scratch_pool));
+
+  if (install->special)
     {
       /* When this stream is closed, the resulting special file will
          atomically be created/moved into place at LOCAL_ABSPATH.  */
@@ -542,37 +647,26 @@ run_file_install(work_item_baton_t *wqb,
 
       /* Copy the "repository normal" form of the special file into the
          special stream.  */
-      SVN_ERR(svn_stream_copy3(src_stream, dst_stream,
-                               cancel_func, cancel_baton,
-                               scratch_pool));
-
-      /* No need to set exec or read-only flags on special files.  */
-
-      /* ### Shouldn't this record a timestamp and size, etc.? */
-      return SVN_NO_ERROR;
+      return svn_error_trace(svn_stream_copy3(src_stream, dst_stream,
+                                              cancel_func, cancel_baton,
+                                              scratch_pool));
     }
 
-  if (svn_subst_translation_required(style, eol, keywords,
-                                     FALSE /* special */,
-                                     TRUE /* force_eol_check */))
+  if (install->translate)
     {
       /* Wrap it in a translating (expanding) stream.  */
-      src_stream = svn_subst_stream_translated(src_stream, eol,
+      src_stream = svn_subst_stream_translated(src_stream, install->eol,
                                                TRUE /* repair */,
-                                               keywords,
+                                               install->keywords,
                                                TRUE /* expand */,
                                                scratch_pool);
     }
 
-  /* Where is the Right Place to put a temp file in this working copy?  */
-  SVN_ERR(svn_wc__db_temp_wcroot_tempdir(&temp_dir_abspath,
-                                         db, wcroot_abspath,
-                                         scratch_pool, scratch_pool));
-
   /* Translate to a temporary file. We don't want the user seeing a partial
      file, nor let them muck with it while we translate. We may also need to
      get its TRANSLATED_SIZE before the user can monkey it.  */
-  SVN_ERR(svn_stream__create_for_install(&dst_stream, temp_dir_abspath,
+  SVN_ERR(svn_stream__create_for_install(&dst_stream,
+                                         install->temp_dir_abspath,
                                          scratch_pool, scratch_pool));
 
   /* Copy from the source to the dest, translating as we go. This will also
@@ -589,44 +683,48 @@ run_file_install(work_item_baton_t *wqb,
                                      TRUE /* make_parents*/, scratch_pool));
 
   /* Tweak the on-disk file according to its properties.  */
-#ifndef WIN32
-  if (props && svn_hash_gets(props, SVN_PROP_EXECUTABLE))
+  if (install->set_executable)
     SVN_ERR(svn_io_set_file_executable(local_abspath, TRUE, FALSE,
                                        scratch_pool));
-#endif
-
-  /* Note that this explicitly checks the pristine properties, to make sure
-     that when the lock is locally set (=modification) it is not read only */
-  if (props && svn_hash_gets(props, SVN_PROP_NEEDS_LOCK))
-    {
-      svn_wc__db_status_t status;
-      svn_wc__db_lock_t *lock;
-      SVN_ERR(svn_wc__db_read_info(&status, NULL, NULL, NULL, NULL, NULL, NULL,
-                                   NULL, NULL, NULL, NULL, NULL, NULL, NULL,
-                                   NULL, NULL, &lock, NULL, NULL, NULL, NULL,
-                                   NULL, NULL, NULL, NULL, NULL, NULL,
-                                   db, local_abspath,
-                                   scratch_pool, scratch_pool));
 
-      if (!lock && status != svn_wc__db_status_added)
-        SVN_ERR(svn_io_set_file_read_only(local_abspath, FALSE, scratch_pool));
-    }
+  if (install->set_read_only)
+    SVN_ERR(svn_io_set_file_read_only(local_abspath, FALSE, scratch_pool));
 
-  if (use_commit_times)
-    {
-      if (changed_date)
-        SVN_ERR(svn_io_set_file_affected_time(changed_date,
-                                              local_abspath,
-                                              scratch_pool));
-    }
+  if (install->set_time)
+    SVN_ERR(svn_io_set_file_affected_time(install->set_time,
+                                          local_abspath,
+                                          scratch_pool));
 
   /* ### this should happen before we rename the file into place.  */
-  if (record_fileinfo)
-    {
-      SVN_ERR(get_and_record_fileinfo(wqb, local_abspath,
-                                      FALSE /* ignore_enoent */,
-                                      scratch_pool));
-    }
+  if (install->record_fileinfo)
+    SVN_ERR(svn_io_stat_dirent2(dirent, local_abspath, FALSE, FALSE,
+                                result_pool, scratch_pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Process the OP_FILE_INSTALL work item WORK_ITEM.
+ * See svn_wc__wq_build_file_install() which generates this work item.
+ * Implements (struct work_item_dispatch).func. */
+static svn_error_t *
+run_file_install(work_item_baton_t *wqb,
+                 svn_wc__db_t *db,
+                 const svn_skel_t *work_item,
+                 const char *wri_abspath,
+                 svn_cancel_func_t cancel_func,
+                 void *cancel_baton,
+                 apr_pool_t *scratch_pool)
+{
+  file_install_t *install;
+  const svn_io_dirent2_t *dirent;
+
+  SVN_ERR(prepare_file_install(&install, db, work_item, wri_abspath,
+                               scratch_pool, scratch_pool));
+  SVN_ERR(perform_file_install(&dirent, install, cancel_func, cancel_baton,
+                               wqb->result_pool, scratch_pool));
+
+  if (dirent)
+    record_fileinfo(wqb, install->local_abspath, dirent);
 
   return SVN_NO_ERROR;
 }
@@ -1408,15 +1506,6 @@ static const struct work_item_dispatch dispatch_table[] = {
   { NULL }
 };
 
-struct work_item_baton_t
-{
-  apr_pool_t *result_pool; /* Pool to allocate result in */
-
-  svn_boolean_t used; /* needs reset */
-
-  apr_hash_t *record_map; /* const char * -> svn_io_dirent2_t map */
-};
-
 
 static svn_error_t *
 dispatch_work_item(work_item_baton_t *wqb,
@@ -1474,6 +1563,253 @@ dispatch_work_item(work_item_baton_t *wqb,
 }
 
 
+/* Wrap ERR, the failure of the work item WORK_ITEM with identifier ID,
+   in the error that svn_wc__wq_run() reports for WRI_ABSPATH. */
+static svn_error_t *
+wrap_work_item_error(svn_error_t *err,
+                     const char *wri_abspath,
+                     apr_uint64_t id,
+                     const svn_skel_t *work_item,
+                     apr_pool_t *scratch_pool)
+{
+  const char *skel = svn_skel__unparse(work_item, scratch_pool)->data;
+
+  return svn_error_createf(SVN_ERR_WC_BAD_ADM_LOG, err,
+                           _("Failed to run the WC DB work queue "
+                             "associated with '%s', work item %d %s"),
+                           svn_dirent_local_style(wri_abspath,
+                                                  scratch_pool),
+                           (int)id, skel);
+}
+
+/* Number of work items to fetch per worker thread at once when processing
+   the work queue in batches. */
+#define WQ_BATCH_SIZE_PER_THREAD 16
+
+/* A run of consecutive OP_FILE_INSTALL items of a work queue batch that
+   get processed concurrently by install_task() and install_output(). */
+typedef struct install_group_t
+{
+  /* The prepared installs, file_install_t *. */
+  apr_array_header_t *installs;
+
+  /* The current batch, apr_uint64_t and svn_skel_t * respectively, and
+     the index of the group's first item within it. */
+  const apr_array_header_t *ids;
+  const apr_array_header_t *work_items;
+  int first;
+
+  /* Where to collect the results of completed items. */
+  work_item_baton_t *wib;
+  apr_array_header_t *completed_ids;
+
+  /* For error messages. */
+  const char *wri_abspath;
+} install_group_t;
+
+/* Implements svn_parallel__task_func_t.  Installs a single file of the
+   install_group_t BATON and returns its svn_io_dirent2_t * to record,
+   if any. */
+static svn_error_t *
+install_task(void **result,
+             void *baton,
+             int idx,
+             svn_cancel_func_t cancel_func,
+             void *cancel_baton,
+             apr_pool_t *result_pool,
+             apr_pool_t *scratch_pool)
+{
+  install_group_t *group = baton;
+  const svn_io_dirent2_t *dirent;
+
+  SVN_ERR(perform_file_install(&dirent,
+                               APR_ARRAY_IDX(group->installs, idx,
+                                             const file_install_t *),
+                               cancel_func, cancel_baton,
+                               result_pool, scratch_pool));
+
+  *result = (void *)dirent;
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_parallel__output_func_t.  Runs in the thread that called
+   svn_wc__wq_run() and marks the work item as completed. */
+static svn_error_t *
+install_output(void *baton,
+               int idx,
+               void *result,
+               svn_error_t *task_err,
+               apr_pool_t *scratch_pool)
+{
+  install_group_t *group = baton;
+  const file_install_t *install = APR_ARRAY_IDX(group->installs, idx,
+                                                const file_install_t *);
+  apr_uint64_t id = APR_ARRAY_IDX(group->ids, group->first + idx,
+                                  apr_uint64_t);
+
+  if (task_err)
+    return svn_error_trace(
+             wrap_work_item_error(task_err, group->wri_abspath, id,
+                                  APR_ARRAY_IDX(group->work_items,
+                                                group->first + idx,
+                                                const svn_skel_t *),
+                                  scratch_pool));
+
+  /* RESULT will be gone after we return. */
+  if (result)
+    record_fileinfo(group->wib, install->local_abspath,
+                    svn_io_dirent2_dup(result, group->wib->result_pool));
+
+  APR_ARRAY_PUSH(group->completed_ids, apr_uint64_t) = id;
+  return SVN_NO_ERROR;
+}
+
+/* Like svn_wc__wq_run() but fetch the work items in batches and install
+   runs of consecutive OP_FILE_INSTALL items using up to THREAD_COUNT
+   threads.
+
+   All wc.db access, i.e. gathering the information for each install as
+   well as recording the results and removing completed items from the
+   queue, still happens in this thread and in queue order.  Only the file
+   system operations run concurrently.  Since every work item must be
+   restartable anyway, a failure will simply leave all items from the
+   current batch in the queue. */
+static svn_error_t *
+run_batched(svn_wc__db_t *db,
+            const char *wri_abspath,
+            int thread_count,
+            svn_cancel_func_t cancel_func,
+            void *cancel_baton,
+            apr_pool_t *scratch_pool)
+{
+  apr_pool_t *batch_pool = svn_pool_create(scratch_pool);
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  apr_array_header_t *completed_ids = NULL;
+  work_item_baton_t wib = { 0 };
+  wib.result_pool = svn_pool_create(scratch_pool);
+
+  while (TRUE)
+    {
+      apr_array_header_t *ids;
+      apr_array_header_t *work_items;
+      int i;
+
+      /* Mark everything from the previous batch as completed before
+         fetching the next one. */
+      svn_pool_clear(batch_pool);
+      SVN_ERR(svn_wc__db_wq_record_and_fetch_batch(
+                        &ids, &work_items, db, wri_abspath,
+                        completed_ids, wib.record_map,
+                        thread_count * WQ_BATCH_SIZE_PER_THREAD,
+                        batch_pool, iterpool));
+
+      svn_pool_clear(wib.result_pool);
+      wib.record_map = NULL;
+      wib.used = FALSE;
+      completed_ids = apr_array_make(wib.result_pool, ids->nelts,
+                                     sizeof(apr_uint64_t));
+
+      /* Stop work queue processing, if requested.  See svn_wc__wq_run(). */
+      if (cancel_func)
+        SVN_ERR(cancel_func(cancel_baton));
+
+      if (ids->nelts == 0)
+        break;
+
+      i = 0;
+      while (i < ids->nelts)
+        {
+          const svn_skel_t *work_item = APR_ARRAY_IDX(work_items, i,
+                                                      const svn_skel_t *);
+          apr_uint64_t id = APR_ARRAY_IDX(ids, i, apr_uint64_t);
+          install_group_t group;
+          apr_hash_t *paths;
+          svn_error_t *err = SVN_NO_ERROR;
+
+          svn_pool_clear(iterpool);
+
+          if (!svn_skel__matches_atom(work_item->children, OP_FILE_INSTALL))
+            {
+              err = dispatch_work_item(&wib, db, wri_abspath, work_item,
+                                       cancel_func, cancel_baton, iterpool);
+              if (err)
+                return svn_error_trace(
+                         wrap_work_item_error(err, wri_abspath, id,
+                                              work_item, scratch_pool));
+
+              APR_ARRAY_PUSH(completed_ids, apr_uint64_t) = id;
+              i++;
+              continue;
+            }
+
+          /* Prepare the longest run of file installs starting at I.
+             Stop early at an item that would install the same file
+             again, so that concurrent installs never interfere. */
+          group.installs = apr_array_make(iterpool, ids->nelts - i,
+                                          sizeof(file_install_t *));
+          group.ids = ids;
+          group.work_items = work_items;
+          group.first = i;
+          group.wib = &wib;
+          group.completed_ids = completed_ids;
+          group.wri_abspath = wri_abspath;
+          paths = apr_hash_make(iterpool);
+
+          for (; i < ids->nelts; i++)
+            {
+              file_install_t *install;
+
+              work_item = APR_ARRAY_IDX(work_items, i, const svn_skel_t *);
+              if (!svn_skel__matches_atom(work_item->children,
+                                          OP_FILE_INSTALL))
+                break;
+
+              err = prepare_file_install(&install, db, work_item,
+                                         wri_abspath, iterpool, iterpool);
+              if (err)
+                break;
+
+              if (svn_hash_gets(paths, install->local_abspath))
+                break;
+
+              svn_hash_sets(paths, install->local_abspath, install);
+              APR_ARRAY_PUSH(group.installs, file_install_t *) = install;
+            }
+
+          /* Install everything we prepared, even if preparing the next
+             item failed.  That keeps the order of errors reported the
+             same as for sequential processing. */
+          if (group.installs->nelts)
+            {
+              svn_error_t *run_err;
+
+              run_err = svn_parallel__run(group.installs->nelts,
+                                          thread_count, 0,
+                                          install_task, &group,
+                                          install_output, &group,
+                                          cancel_func, cancel_baton,
+                                          iterpool);
+              if (run_err)
+                {
+                  svn_error_clear(err);
+                  return svn_error_trace(run_err);
+                }
+            }
+
+          if (err)
+            return svn_error_trace(
+                     wrap_work_item_error(err, wri_abspath,
+                                          APR_ARRAY_IDX(ids, i, apr_uint64_t),
+                                          work_item, scratch_pool));
+        }
+    }
+
+  svn_pool_destroy(iterpool);
+  svn_pool_destroy(batch_pool);
+  return SVN_NO_ERROR;
+}
+
+
 svn_error_t *
 svn_wc__wq_run(svn_wc__db_t *db,
                const char *wri_abspath,
@@ -1481,10 +1817,10 @@ svn_wc__wq_run(svn_wc__db_t *db,
                void *cancel_baton,
                apr_pool_t *scratch_pool)
 {
-  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  apr_pool_t *iterpool;
   apr_uint64_t last_id = 0;
   work_item_baton_t wib = { 0 };
-  wib.result_pool = svn_pool_create(scratch_pool);
+  int thread_count = svn_wc__db_get_install_threads(db);
 
 #ifdef SVN_DEBUG_WORK_QUEUE
   SVN_DBG(("wq_run: wri='%s'\n", wri_abspath));
@@ -1500,6 +1836,14 @@ svn_wc__wq_run(svn_wc__db_t *db,
   }
 #endif
 
+  if (thread_count > 1)
+    return svn_error_trace(run_batched(db, wri_abspath, thread_count,
+                                       cancel_func, cancel_baton,
+                                       scratch_pool));
+
+  iterpool = svn_pool_create(scratch_pool);
+  wib.result_pool = svn_pool_create(scratch_pool);
+
   while (TRUE)
     {
       apr_uint64_t id;
@@ -1546,16 +1890,8 @@ svn_wc__wq_run(svn_wc__db_t *db,
       err = dispatch_work_item(&wib, db, wri_abspath, work_item,
                                cancel_func, cancel_baton, iterpool);
       if (err)
-        {
-          const char *skel = svn_skel__unparse(work_item, scratch_pool)->data;
-
-          return svn_error_createf(SVN_ERR_WC_BAD_ADM_LOG, err,
-                                   _("Failed to run the WC DB work queue "
-                                     "associated with '%s', work item %d %s"),
-                                   svn_dirent_local_style(wri_abspath,
-                                                          scratch_pool),
-                                   (int)id, skel);
-        }
+        return svn_error_trace(wrap_work_item_error(err, wri_abspath, id,
+                                                    work_item, scratch_pool));
 
       /* The work item finished without error. Mark it completed
          in the next loop.  */
@@ -1615,6 +1951,25 @@ svn_wc__wq_merge(svn_skel_t *work_item1,
 }
 
 
+/* Remember DIRENT as the state to record for LOCAL_ABSPATH in WQB,
+   if it describes a file. */
+static void
+record_fileinfo(work_item_baton_t *wqb,
+                const char *local_abspath,
+                const svn_io_dirent2_t *dirent)
+{
+  if (dirent->kind != svn_node_file)
+    return;
+
+  wqb->used = TRUE;
+
+  if (! wqb->record_map)
+    wqb->record_map = apr_hash_make(wqb->result_pool);
+
+  svn_hash_sets(wqb->record_map, apr_pstrdup(wqb->result_pool, local_abspath),
+                dirent);
+}
+
 static svn_error_t *
 get_and_record_fileinfo(work_item_baton_t *wqb,
                         const char *local_abspath,
@@ -1626,16 +1981,7 @@ get_and_record_fileinfo(work_item_baton_t *wqb,
   SVN_ERR(svn_io_stat_dirent2(&dirent, local_abspath, FALSE, ignore_enoent,
                               wqb->result_pool, scratch_pool));
 
-  if (dirent->kind != svn_node_file)
-    return SVN_NO_ERROR;
-
-  wqb->used = TRUE;
-
-  if (! wqb->record_map)
-    wqb->record_map = apr_hash_make(wqb->result_pool);
-
-  svn_hash_sets(wqb->record_map, apr_pstrdup(wqb->result_pool, local_abspath),
-                dirent);
+  record_fileinfo(wqb, local_abspath, dirent);
 
   return SVN_NO_ERROR;
 }
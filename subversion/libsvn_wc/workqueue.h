@@ -85,7 +85,11 @@ svn_wc__wq_merge(svn_skel_t *work_item1,
 
 
 /* For the WCROOT identified by the DB and WRI_ABSPATH pair, run any
-   work items that may be present in its workqueue.  */
+   work items that may be present in its workqueue.
+
+   If DB has been configured to use multiple install threads (see
+   svn_wc__db_get_install_threads()), consecutive file installs will be
+   performed concurrently.  The items still complete in queue order.  */
 svn_error_t *
 svn_wc__wq_run(svn_wc__db_t *db,
                const char *wri_abspath,
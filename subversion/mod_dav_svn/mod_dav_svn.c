@@ -42,6 +42,7 @@
 #include "svn_dso.h"
 #include "mod_dav_svn.h"
 
+#include "private/svn_cache.h"
 #include "private/svn_fspath.h"
 #include "private/svn_subr_private.h"
 
@@ -67,6 +68,10 @@ typedef struct server_conf_t {
      compression level. */
   int compression_level;
 
+  /* The number of threads per update report that svn_repos_begin_report4()
+   * may use to prefetch file data.  0 means not configured. */
+  int report_threads;
+
 } server_conf_t;
 
 
@@ -231,6 +236,10 @@ merge_server_config(apr_pool_t *p, void *base, void *overrides)
       newconf->compression_level = child->compression_level;
     }
 
+  newconf->report_threads = child->report_threads
+                          ? child->report_threads
+                          : parent->report_threads;
+
   return newconf;
 }
 
@@ -624,6 +633,14 @@ SVNInMemoryCacheSize_cmd(cmd_parms *cmd, void *config, const char *arg1)
   return NULL;
 }
 
+static const char *
+SVNInMemoryCacheScaleSegments_cmd(cmd_parms *cmd, void *config, int arg)
+{
+  svn_cache__config_set_scale_segments(arg);
+
+  return NULL;
+}
+
 static const char *
 SVNCompressionLevel_cmd(cmd_parms *cmd, void *config, const char *arg1)
 {
@@ -652,6 +669,31 @@ SVNCompressionLevel_cmd(cmd_parms *cmd, void *config, const char *arg1)
   return NULL;
 }
 
+static const char *
+SVNReportThreads_cmd(cmd_parms *cmd, void *config, const char *arg1)
+{
+  server_conf_t *conf;
+  int value = 0;
+  svn_error_t *err = svn_cstring_atoi(&value, arg1);
+  if (err)
+    {
+      svn_error_clear(err);
+      return "Invalid decimal number for the SVN report thread count.";
+    }
+
+  if (value < 1)
+    return apr_psprintf(cmd->pool,
+                        "%d is not a valid report thread count. "
+                        "The minimum value is 1.",
+                        value);
+
+  conf = ap_get_module_config(cmd->server->module_config,
+                              &dav_svn_module);
+  conf->report_threads = value;
+
+  return NULL;
+}
+
 static const char *
 SVNUseUTF8_cmd(cmd_parms *cmd, void *config, int arg)
 {
@@ -1060,6 +1102,18 @@ dav_svn__get_compression_level(request_rec *r)
     }
 }
 
+int
+dav_svn__get_report_threads(request_rec *r)
+{
+  server_conf_t *conf;
+
+  conf = ap_get_module_config(r->server->module_config,
+                              &dav_svn_module);
+
+  /* prefetching in update reports is disabled by default. */
+  return conf->report_threads ? conf->report_threads : 1;
+}
+
 const char *
 dav_svn__get_hooks_env(request_rec *r)
 {
@@ -1404,12 +1458,28 @@ static const command_rec cmds[] =
                 "in-memory object cache (default value is 16384; 0 switches "
                 "to dynamically sized caches)."),
   /* per server */
+  AP_INIT_FLAG("SVNInMemoryCacheScaleSegments",
+               SVNInMemoryCacheScaleSegments_cmd, NULL,
+               RSRC_CONF,
+               "reduces lock contention in Subversion's in-memory object "
+               "cache by splitting it into at least twice as many segments "
+               "as there are hardware threads.  Recommended for large "
+               "caches on servers running many threads per process "
+               "(default is Off)."),
+  /* per server */
   AP_INIT_TAKE1("SVNCompressionLevel", SVNCompressionLevel_cmd, NULL,
                 RSRC_CONF,
                 "specifies the compression level used before sending file "
                 "content over the network (0 for no compression, 9 for "
                 "maximum, 5 is default)."),
 
+  /* per server */
+  AP_INIT_TAKE1("SVNReportThreads", SVNReportThreads_cmd, NULL,
+                RSRC_CONF,
+                "specifies the number of threads per update report used to "
+                "read file data ahead of sending it to the client "
+                "(default is 1, i.e. no prefetching)."),
+
   /* per server */
   AP_INIT_FLAG("SVNUseUTF8",
                SVNUseUTF8_cmd, NULL,
@@ -0,0 +1,260 @@
+/*
+ * blame.c: mod_dav_svn REPORT handler for server-side blame
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#include <apr_pools.h>
+#include <apr_strings.h>
+#include <apr_xml.h>
+
+#include <mod_dav.h>
+
+#include "svn_repos.h"
+#include "svn_hash.h"
+#include "svn_string.h"
+#include "svn_types.h"
+#include "svn_xml.h"
+#include "svn_path.h"
+#include "svn_dav.h"
+#include "svn_props.h"
+
+#include "private/svn_log.h"
+#include "private/svn_fspath.h"
+
+#include "../dav_svn.h"
+
+/* Baton type to be used with blame_receiver. */
+typedef struct blame_receiver_baton_t
+{
+  /* this buffers the output for a bit and is automatically flushed,
+     at appropriate times, by the Apache filter system. */
+  apr_bucket_brigade *bb;
+
+  /* where to deliver the output */
+  dav_svn__output *output;
+
+  /* Whether we've written the <S:blame-report> header.  Allows for lazy
+     writes to support mod_dav-based error handling. */
+  svn_boolean_t needs_header;
+
+  /* Are we talking to a SVN client? */
+  svn_boolean_t is_svn_client;
+} blame_receiver_baton_t;
+
+
+/* If BRB->needs_header is true, send the "<S:blame-report>" start
+   element and set BRB->needs_header to zero.  Else do nothing. */
+static svn_error_t *
+maybe_send_header(blame_receiver_baton_t *brb)
+{
+  if (brb->needs_header)
+    {
+      SVN_ERR(dav_svn__brigade_puts(brb->bb, brb->output,
+                                    DAV_XML_HEADER DEBUG_CR
+                                    "<S:blame-report xmlns:S=\""
+                                    SVN_XML_NAMESPACE "\" "
+                                    "xmlns:D=\"DAV:\">" DEBUG_CR));
+      brb->needs_header = FALSE;
+    }
+
+  return SVN_NO_ERROR;
+}
+
+
+/* Implements svn_repos_blame_receiver_t, sending the line range and its
+ * revision info to the client.  BATON must be a blame_receiver_baton_t. */
+static svn_error_t *
+blame_receiver(apr_int64_t start_line,
+               apr_int64_t end_line,
+               svn_revnum_t revision,
+               apr_hash_t *rev_props,
+               void *baton,
+               apr_pool_t *scratch_pool)
+{
+  blame_receiver_baton_t *b = baton;
+  const char *attr_rev = "";
+  const char *attr_date = "";
+  const char *tag_author = "";
+
+  if (SVN_IS_VALID_REVNUM(revision))
+    {
+      const svn_string_t *author = NULL;
+      const svn_string_t *date = NULL;
+
+      attr_rev = apr_psprintf(scratch_pool, " rev=\"%ld\"", revision);
+
+      if (rev_props)
+        {
+          author = svn_hash_gets(rev_props, SVN_PROP_REVISION_AUTHOR);
+          date = svn_hash_gets(rev_props, SVN_PROP_REVISION_DATE);
+        }
+
+      if (date)
+        attr_date = apr_psprintf(scratch_pool, " date=\"%s\"",
+                                 apr_xml_quote_string(scratch_pool,
+                                                      date->data, 1));
+
+      if (author)
+        {
+          const char *escaped
+            = dav_svn__fuzzy_escape_author(author->data, b->is_svn_client,
+                                           scratch_pool, scratch_pool);
+          tag_author = apr_psprintf(scratch_pool,
+                                    "<D:creator-displayname>%s"
+                                    "</D:creator-displayname>",
+                                    apr_xml_quote_string(scratch_pool,
+                                                         escaped, 1));
+        }
+    }
+
+  SVN_ERR(maybe_send_header(b));
+
+  return svn_error_trace(
+           dav_svn__brigade_printf(b->bb, b->output,
+                                   "<S:range"
+                                   " start-line=\"%" APR_INT64_T_FMT "\""
+                                   " end-line=\"%" APR_INT64_T_FMT "\""
+                                   "%s"
+                                   "%s>%s</S:range>" DEBUG_CR,
+                                   start_line, end_line,
+                                   attr_rev, attr_date, tag_author));
+}
+
+dav_error *
+dav_svn__blame_report(const dav_resource *resource,
+                      const apr_xml_doc *doc,
+                      dav_svn__output *output)
+{
+  svn_error_t *serr;
+  dav_error *derr = NULL;
+  apr_xml_elem *child;
+  blame_receiver_baton_t brb = { 0 };
+  dav_svn__authz_read_baton arb;
+  const dav_svn_repos *repos = resource->info->repos;
+  int ns;
+  const char *full_path = NULL;
+
+  /* These get determined from the request document. */
+  svn_revnum_t start = SVN_INVALID_REVNUM;
+  svn_revnum_t end = SVN_INVALID_REVNUM;
+  apr_array_header_t *diff_options = apr_array_make(resource->pool, 0,
+                                                    sizeof(const char *));
+
+  /* Sanity check. */
+  if (!resource->info->repos_path)
+    return dav_svn__new_error(resource->pool, HTTP_BAD_REQUEST, 0, 0,
+                              "The request does not specify a repository path");
+  ns = dav_svn__find_ns(doc->namespaces, SVN_XML_NAMESPACE);
+  if (ns == -1)
+    {
+      return dav_svn__new_error_svn(resource->pool, HTTP_BAD_REQUEST, 0, 0,
+                                    "The request does not contain the 'svn:' "
+                                    "namespace, so it is not going to have "
+                                    "certain required elements");
+    }
+
+  for (child = doc->root->first_child; child != NULL; child = child->next)
+    {
+      /* if this element isn't one of ours, then skip it */
+      if (child->ns != ns)
+        continue;
+
+      else if (strcmp(child->name, "path") == 0)
+        {
+          const char *rel_path = dav_xml_get_cdata(child, resource->pool, 0);
+          if ((derr = dav_svn__test_canonical(rel_path, resource->pool)))
+            return derr;
+
+          /* Force REL_PATH to be a relative path, not an fspath. */
+          rel_path = svn_relpath_canonicalize(rel_path, resource->pool);
+
+          /* Append the REL_PATH to the base FS path to get an
+             absolute repository path. */
+          full_path = svn_fspath__join(resource->info->repos_path, rel_path,
+                                       resource->pool);
+        }
+      else if (strcmp(child->name, "start-revision") == 0)
+        start = SVN_STR_TO_REV(dav_xml_get_cdata(child, resource->pool, 1));
+      else if (strcmp(child->name, "end-revision") == 0)
+        end = SVN_STR_TO_REV(dav_xml_get_cdata(child, resource->pool, 1));
+      else if (strcmp(child->name, "diff-option") == 0)
+        {
+          const char *option = dav_xml_get_cdata(child, resource->pool, 1);
+          APR_ARRAY_PUSH(diff_options, const char *) = option;
+        }
+      /* else unknown element; skip it */
+    }
+
+  if (!full_path)
+    return dav_svn__new_error_svn(resource->pool, HTTP_BAD_REQUEST, 0, 0,
+                                  "Not all parameters passed");
+
+  if (!SVN_IS_VALID_REVNUM(start) || !SVN_IS_VALID_REVNUM(end))
+    return dav_svn__new_error_svn(resource->pool, HTTP_BAD_REQUEST, 0, 0,
+                                  "Invalid revision range");
+
+  /* Build authz read baton */
+  arb.r = resource->info->r;
+  arb.repos = resource->info->repos;
+
+  /* Build blame receiver baton */
+  brb.bb = apr_brigade_create(resource->pool,  /* not the subpool! */
+                              dav_svn__output_get_bucket_alloc(output));
+  brb.output = output;
+  brb.needs_header = TRUE;
+  brb.is_svn_client = resource->info->repos->is_svn_client;
+
+  serr = svn_repos_blame(repos->repos, full_path, start, end, diff_options,
+                         dav_svn__authz_read_func(&arb), &arb,
+                         blame_receiver, &brb, NULL, NULL, resource->pool);
+  if (serr)
+    {
+      derr = dav_svn__convert_err(serr, HTTP_BAD_REQUEST, NULL,
+                                  resource->pool);
+      goto cleanup;
+    }
+
+  if ((serr = maybe_send_header(&brb)))
+    {
+      derr = dav_svn__convert_err(serr, HTTP_INTERNAL_SERVER_ERROR,
+                                  "Error beginning REPORT response.",
+                                  resource->pool);
+      goto cleanup;
+    }
+
+  if ((serr = dav_svn__brigade_puts(brb.bb, brb.output,
+                                    "</S:blame-report>" DEBUG_CR)))
+    {
+      derr = dav_svn__convert_err(serr, HTTP_INTERNAL_SERVER_ERROR,
+                                  "Error ending REPORT response.",
+                                  resource->pool);
+      goto cleanup;
+    }
+
+ cleanup:
+
+  dav_svn__operational_log(resource->info,
+                           svn_log__get_blame(full_path, start, end,
+                                              diff_options, resource->pool));
+
+  return dav_svn__final_flush_or_error(resource->info->r, brb.bb, output,
+                                       derr, resource->pool);
+}
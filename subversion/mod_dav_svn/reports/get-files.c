@@ -0,0 +1,371 @@
+/*
+ * get-files.c: mod_dav_svn REPORT handler for fetching many files at once
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#include <apr_pools.h>
+#include <apr_strings.h>
+#include <apr_xml.h>
+
+#include <mod_dav.h>
+
+#include "svn_repos.h"
+#include "svn_fs.h"
+#include "svn_hash.h"
+#include "svn_pools.h"
+#include "svn_string.h"
+#include "svn_types.h"
+#include "svn_xml.h"
+#include "svn_path.h"
+#include "svn_dav.h"
+#include "svn_props.h"
+#include "svn_base64.h"
+#include "svn_delta.h"
+
+#include "private/svn_log.h"
+#include "private/svn_fspath.h"
+
+#include "../dav_svn.h"
+
+/* Baton type for the functions sending the individual files. */
+typedef struct get_files_baton_t
+{
+  /* this buffers the output for a bit and is automatically flushed,
+     at appropriate times, by the Apache filter system. */
+  apr_bucket_brigade *bb;
+
+  /* where to deliver the output */
+  dav_svn__output *output;
+
+  /* Whether we've written the <S:get-files-report> header.  Allows for
+     lazy writes to support mod_dav-based error handling. */
+  svn_boolean_t needs_header;
+
+  /* Send the files' properties as well? */
+  svn_boolean_t want_props;
+
+  /* SVNDIFF version and compression level to use when sending to
+     client. */
+  int svndiff_version;
+  int compression_level;
+
+  /* The repository to read from. */
+  svn_fs_t *fs;
+} get_files_baton_t;
+
+
+/* If GFB->needs_header is true, send the "<S:get-files-report>" start
+   element and set GFB->needs_header to zero.  Else do nothing. */
+static svn_error_t *
+maybe_send_header(get_files_baton_t *gfb)
+{
+  if (gfb->needs_header)
+    {
+      SVN_ERR(dav_svn__brigade_puts(gfb->bb, gfb->output,
+                                    DAV_XML_HEADER DEBUG_CR
+                                    "<S:get-files-report xmlns:S=\""
+                                    SVN_XML_NAMESPACE "\" "
+                                    "xmlns:D=\"DAV:\">" DEBUG_CR));
+      gfb->needs_header = FALSE;
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Send a property named NAME with value VAL in a set-prop element.
+   Quote NAME and base64-encode VAL if necessary. */
+static svn_error_t *
+send_prop(get_files_baton_t *gfb,
+          const char *name,
+          const svn_string_t *val,
+          apr_pool_t *pool)
+{
+  name = apr_xml_quote_string(pool, name, 1);
+
+  if (svn_xml_is_xml_safe(val->data, val->len))
+    {
+      svn_stringbuf_t *tmp = NULL;
+      svn_xml_escape_cdata_string(&tmp, val, pool);
+      SVN_ERR(dav_svn__brigade_printf(gfb->bb, gfb->output,
+                                      "<S:set-prop name=\"%s\">%s"
+                                      "</S:set-prop>" DEBUG_CR,
+                                      name, tmp->data));
+    }
+  else
+    {
+      val = svn_base64_encode_string2(val, TRUE, pool);
+      SVN_ERR(dav_svn__brigade_printf(gfb->bb, gfb->output,
+                                      "<S:set-prop name=\"%s\" "
+                                      "encoding=\"base64\">%s"
+                                      "</S:set-prop>" DEBUG_CR,
+                                      name, val->data));
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Set *PROPS to all properties of FULL_PATH in ROOT, including the entry
+   props that a GET / PROPFIND based file fetch would return.  Allocate
+   the result in POOL. */
+static svn_error_t *
+get_file_props(apr_hash_t **props,
+               svn_fs_root_t *root,
+               const char *full_path,
+               apr_pool_t *pool)
+{
+  svn_revnum_t crev;
+  const char *cdate, *cauthor, *uuid;
+
+  SVN_ERR(svn_fs_node_proplist(props, root, full_path, pool));
+  SVN_ERR(svn_repos_get_committed_info(&crev, &cdate, &cauthor, root,
+                                       full_path, pool));
+  SVN_ERR(svn_fs_get_uuid(svn_fs_root_fs(root), &uuid, pool));
+
+  svn_hash_sets(*props, SVN_PROP_ENTRY_COMMITTED_REV,
+                svn_string_createf(pool, "%ld", crev));
+  if (cdate)
+    svn_hash_sets(*props, SVN_PROP_ENTRY_COMMITTED_DATE,
+                  svn_string_create(cdate, pool));
+  if (cauthor)
+    svn_hash_sets(*props, SVN_PROP_ENTRY_LAST_AUTHOR,
+                  svn_string_create(cauthor, pool));
+  if (uuid)
+    svn_hash_sets(*props, SVN_PROP_ENTRY_UUID,
+                  svn_string_create(uuid, pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Send the file FULL_PATH at REV, reported as PATH, with its properties
+   and its contents as svndiff against the empty file.  Use POOL for
+   temporary allocations. */
+static svn_error_t *
+send_file(get_files_baton_t *gfb,
+          const char *path,
+          const char *full_path,
+          svn_revnum_t rev,
+          apr_pool_t *pool)
+{
+  svn_fs_root_t *root;
+  svn_checksum_t *checksum;
+  svn_stream_t *contents;
+  svn_stream_t *base64_stream;
+  svn_txdelta_window_handler_t handler;
+  void *handler_baton;
+
+  SVN_ERR(svn_fs_revision_root(&root, gfb->fs, rev, pool));
+  SVN_ERR(svn_fs_file_checksum(&checksum, svn_checksum_md5, root,
+                               full_path, TRUE, pool));
+  SVN_ERR(svn_fs_file_contents(&contents, root, full_path, pool));
+
+  SVN_ERR(maybe_send_header(gfb));
+  SVN_ERR(dav_svn__brigade_printf(gfb->bb, gfb->output,
+                                  "<S:file path=\"%s\" rev=\"%ld\""
+                                  " checksum=\"%s\">" DEBUG_CR,
+                                  apr_xml_quote_string(pool, path, 1), rev,
+                                  svn_checksum_to_cstring_display(checksum,
+                                                                  pool)));
+
+  if (gfb->want_props)
+    {
+      apr_hash_t *props;
+      apr_hash_index_t *hi;
+      apr_pool_t *iterpool = svn_pool_create(pool);
+
+      SVN_ERR(get_file_props(&props, root, full_path, pool));
+      for (hi = apr_hash_first(pool, props); hi; hi = apr_hash_next(hi))
+        {
+          svn_pool_clear(iterpool);
+          SVN_ERR(send_prop(gfb, apr_hash_this_key(hi), apr_hash_this_val(hi),
+                            iterpool));
+        }
+      svn_pool_destroy(iterpool);
+    }
+
+  /* The final window closes BASE64_STREAM. */
+  base64_stream = dav_svn__make_base64_output_stream(gfb->bb, gfb->output,
+                                                     pool);
+  svn_txdelta_to_svndiff3(&handler, &handler_baton, base64_stream,
+                          gfb->svndiff_version, gfb->compression_level,
+                          pool);
+
+  SVN_ERR(dav_svn__brigade_puts(gfb->bb, gfb->output, "<S:txdelta>"));
+  SVN_ERR(svn_txdelta_send_stream(contents, handler, handler_baton, NULL,
+                                  pool));
+
+  return svn_error_trace(dav_svn__brigade_puts(gfb->bb, gfb->output,
+                                               "</S:txdelta></S:file>"
+                                               DEBUG_CR));
+}
+
+dav_error *
+dav_svn__get_files_report(const dav_resource *resource,
+                          const apr_xml_doc *doc,
+                          dav_svn__output *output)
+{
+  svn_error_t *serr;
+  dav_error *derr = NULL;
+  apr_xml_elem *child;
+  get_files_baton_t gfb = { 0 };
+  const dav_svn_repos *repos = resource->info->repos;
+  int ns;
+  int i;
+  apr_pool_t *iterpool;
+  svn_revnum_t youngest = SVN_INVALID_REVNUM;
+
+  /* These get determined from the request document. */
+  apr_array_header_t *paths = apr_array_make(resource->pool, 0,
+                                             sizeof(const char *));
+  apr_array_header_t *full_paths = apr_array_make(resource->pool, 0,
+                                                  sizeof(const char *));
+  apr_array_header_t *revisions = apr_array_make(resource->pool, 0,
+                                                 sizeof(svn_revnum_t));
+
+  /* Sanity check. */
+  if (!resource->info->repos_path)
+    return dav_svn__new_error(resource->pool, HTTP_BAD_REQUEST, 0, 0,
+                              "The request does not specify a repository path");
+  ns = dav_svn__find_ns(doc->namespaces, SVN_XML_NAMESPACE);
+  if (ns == -1)
+    {
+      return dav_svn__new_error_svn(resource->pool, HTTP_BAD_REQUEST, 0, 0,
+                                    "The request does not contain the 'svn:' "
+                                    "namespace, so it is not going to have "
+                                    "certain required elements");
+    }
+
+  for (child = doc->root->first_child; child != NULL; child = child->next)
+    {
+      /* if this element isn't one of ours, then skip it */
+      if (child->ns != ns)
+        continue;
+
+      if (strcmp(child->name, "include-props") == 0)
+        gfb.want_props = TRUE; /* presence indicates positivity */
+      else if (strcmp(child->name, "file") == 0)
+        {
+          const char *rel_path = dav_xml_get_cdata(child, resource->pool, 0);
+          svn_revnum_t rev = SVN_INVALID_REVNUM;
+          apr_xml_attr *this_attr;
+
+          if ((derr = dav_svn__test_canonical(rel_path, resource->pool)))
+            return derr;
+
+          for (this_attr = child->attr; this_attr; this_attr = this_attr->next)
+            if (strcmp(this_attr->name, "rev") == 0)
+              rev = SVN_STR_TO_REV(this_attr->value);
+
+          /* Force REL_PATH to be a relative path, not an fspath. */
+          rel_path = svn_relpath_canonicalize(rel_path, resource->pool);
+
+          APR_ARRAY_PUSH(paths, const char *) = rel_path;
+          APR_ARRAY_PUSH(full_paths, const char *)
+            = svn_fspath__join(resource->info->repos_path, rel_path,
+                               resource->pool);
+          APR_ARRAY_PUSH(revisions, svn_revnum_t) = rev;
+        }
+      /* else unknown element; skip it */
+    }
+
+  /* Resolve HEAD and check all authorizations before sending anything.
+     That way, the client gets a proper HTTP status for the whole request
+     instead of a partial response. */
+  iterpool = svn_pool_create(resource->pool);
+  for (i = 0; i < full_paths->nelts; i++)
+    {
+      const char *full_path = APR_ARRAY_IDX(full_paths, i, const char *);
+      svn_revnum_t *rev = &APR_ARRAY_IDX(revisions, i, svn_revnum_t);
+
+      svn_pool_clear(iterpool);
+      if (!SVN_IS_VALID_REVNUM(*rev))
+        {
+          if (!SVN_IS_VALID_REVNUM(youngest))
+            {
+              serr = svn_fs_youngest_rev(&youngest, repos->fs,
+                                         resource->pool);
+              if (serr)
+                return dav_svn__convert_err(serr, HTTP_INTERNAL_SERVER_ERROR,
+                                            "Could not determine youngest "
+                                            "revision", resource->pool);
+            }
+
+          *rev = youngest;
+        }
+
+      if (!dav_svn__allow_read(resource->info->r, repos, full_path, *rev,
+                               iterpool))
+        return dav_svn__new_error(resource->pool, HTTP_FORBIDDEN, 0, 0,
+                                  "Path is not accessible.");
+    }
+
+  /* Build the baton for sending the files */
+  gfb.bb = apr_brigade_create(resource->pool,  /* not the subpool! */
+                              dav_svn__output_get_bucket_alloc(output));
+  gfb.output = output;
+  gfb.needs_header = TRUE;
+  gfb.svndiff_version = resource->info->svndiff_version;
+  gfb.compression_level = dav_svn__get_compression_level(resource->info->r);
+  gfb.fs = repos->fs;
+
+  for (i = 0; i < paths->nelts; i++)
+    {
+      svn_pool_clear(iterpool);
+      serr = send_file(&gfb, APR_ARRAY_IDX(paths, i, const char *),
+                       APR_ARRAY_IDX(full_paths, i, const char *),
+                       APR_ARRAY_IDX(revisions, i, svn_revnum_t),
+                       iterpool);
+      if (serr)
+        {
+          derr = dav_svn__convert_err(serr, HTTP_BAD_REQUEST, NULL,
+                                      resource->pool);
+          goto cleanup;
+        }
+    }
+
+  if ((serr = maybe_send_header(&gfb)))
+    {
+      derr = dav_svn__convert_err(serr, HTTP_INTERNAL_SERVER_ERROR,
+                                  "Error beginning REPORT response.",
+                                  resource->pool);
+      goto cleanup;
+    }
+
+  if ((serr = dav_svn__brigade_puts(gfb.bb, gfb.output,
+                                    "</S:get-files-report>" DEBUG_CR)))
+    {
+      derr = dav_svn__convert_err(serr, HTTP_INTERNAL_SERVER_ERROR,
+                                  "Error ending REPORT response.",
+                                  resource->pool);
+      goto cleanup;
+    }
+
+ cleanup:
+
+  svn_pool_destroy(iterpool);
+
+  dav_svn__operational_log(resource->info,
+                           svn_log__get_files(full_paths, revisions,
+                                              gfb.want_props,
+                                              resource->pool));
+
+  return dav_svn__final_flush_or_error(resource->info->r, gfb.bb, output,
+                                       derr, resource->pool);
+}
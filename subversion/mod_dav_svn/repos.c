@@ -26,6 +26,7 @@
 #include <apr_strings.h>
 #include <apr_hash.h>
 #include <apr_lib.h>
+#include <apr_portable.h>
 
 #include <httpd.h>
 #include <http_request.h>
@@ -54,9 +55,11 @@
 #include "svn_ra.h"  /* for SVN_RA_CAPABILITY_* */
 #include "svn_dirent_uri.h"
 #include "private/svn_log.h"
+#include "private/svn_fs_private.h"
 #include "private/svn_fspath.h"
 #include "private/svn_repos_private.h"
 #include "private/svn_sorts_private.h"
+#include "private/svn_subr_private.h"
 
 #include "dav_svn.h"
 
@@ -1741,7 +1744,10 @@ static int sort_encoding_pref(const void *accept_rec1, const void *accept_rec2)
 
 static int get_svndiff_version(const struct accept_rec *rec)
 {
-  if (strcmp(rec->name, "svndiff2") == 0)
+  /* We can only produce svndiff3 if we have been built with zstd. */
+  if (strcmp(rec->name, "svndiff3") == 0 && svn_zstd__is_available())
+    return 3;
+  else if (strcmp(rec->name, "svndiff2") == 0)
     return 2;
   else if (strcmp(rec->name, "svndiff1") == 0)
     return 1;
@@ -2405,6 +2411,8 @@ get_resource(request_rec *r,
       fs_config = apr_hash_make(r->connection->pool);
       svn_hash_sets(fs_config, SVN_FS_CONFIG_FSFS_CACHE_DELTAS,
                     dav_svn__get_txdelta_cache_flag(r) ? "1" :"0");
+      svn_hash_sets(fs_config, SVN_FS_CONFIG_CACHE_FILE_DELTAS,
+                    dav_svn__get_txdelta_cache_flag(r) ? "1" :"0");
       svn_hash_sets(fs_config, SVN_FS_CONFIG_FSFS_CACHE_FULLTEXTS,
                     dav_svn__get_fulltext_cache_flag(r) ? "1" :"0");
       svn_hash_sets(fs_config, SVN_FS_CONFIG_FSFS_CACHE_REVPROPS,
@@ -3574,6 +3582,68 @@ emit_collection_tail(const dav_resource *resource,
 }
 
 
+/* If the contents of the file RESOURCE are stored as a plain fulltext in
+   the repository, send them to OUTPUT, followed by EOS, and set *DELIVERED.
+   The data will be passed as a file bucket, which allows the core output
+   filter to use sendfile() or mmap() for it.  Otherwise, send nothing
+   and clear *DELIVERED. */
+static dav_error *
+deliver_contents_range(svn_boolean_t *delivered,
+                       const dav_resource *resource,
+                       dav_svn__output *output)
+{
+  apr_file_t *fs_file;
+  apr_file_t *file;
+  apr_os_file_t os_file;
+  apr_off_t offset;
+  svn_filesize_t length;
+  apr_bucket_brigade *bb;
+  apr_status_t status;
+  svn_error_t *serr;
+
+  *delivered = FALSE;
+
+  serr = svn_fs__file_contents_range(&fs_file, &offset, &length,
+                                     resource->info->root.root,
+                                     resource->info->repos_path,
+                                     resource->pool, resource->pool);
+  if (serr != NULL)
+    return dav_svn__convert_err(serr, HTTP_INTERNAL_SERVER_ERROR,
+                                "could not prepare to read the file",
+                                resource->pool);
+  if (fs_file == NULL || length == 0)
+    return NULL;
+
+  /* The repository's file object is buffered and has not been opened for
+     sendfile().  Wrap its OS handle into an unbuffered one that has.
+     The repository's object will close the handle with RESOURCE->POOL. */
+  status = apr_os_file_get(&os_file, fs_file);
+  if (status == APR_SUCCESS)
+    status = apr_os_file_put(&file, &os_file,
+                             APR_FOPEN_READ | APR_FOPEN_SENDFILE_ENABLED,
+                             resource->pool);
+  if (status != APR_SUCCESS)
+    return NULL;
+
+  bb = apr_brigade_create(resource->pool,
+                          dav_svn__output_get_bucket_alloc(output));
+  apr_brigade_insert_file(bb, file, offset, length, resource->pool);
+  APR_BRIGADE_INSERT_TAIL(bb,
+    apr_bucket_eos_create(dav_svn__output_get_bucket_alloc(output)));
+
+  serr = dav_svn__output_pass_brigade(output, bb);
+  apr_brigade_destroy(bb);
+  if (serr != NULL)
+    /* ### that HTTP code... */
+    return dav_svn__convert_err(serr, HTTP_INTERNAL_SERVER_ERROR,
+                                "Could not write data to filter.",
+                                resource->pool);
+
+  *delivered = TRUE;
+  return NULL;
+}
+
+
 static dav_error *
 deliver(const dav_resource *resource, ap_filter_t *unused)
 {
@@ -3860,6 +3930,17 @@ deliver(const dav_resource *resource, ap_filter_t *unused)
       svn_stream_t *stream;
       char *block;
 
+      /* Without keyword substitution, we may be able to pass the plain
+         fulltext straight from the repository to the network. */
+      if (! resource->info->keyword_subst)
+        {
+          svn_boolean_t delivered;
+          dav_error *derr = deliver_contents_range(&delivered, resource,
+                                                   output);
+          if (derr != NULL || delivered)
+            return derr;
+        }
+
       serr = svn_fs_file_contents(&stream,
                                   resource->info->root.root,
                                   resource->info->repos_path,
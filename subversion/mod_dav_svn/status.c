@@ -70,7 +70,9 @@
 int dav_svn__status(request_rec *r)
 {
   svn_cache__info_t *info;
+  svn_cache__info_t *delta_info;
   svn_string_t *text_stats;
+  svn_error_t *err;
   apr_array_header_t *lines;
   int i;
 
@@ -81,6 +83,19 @@ int dav_svn__status(request_rec *r)
   text_stats = svn_cache__format_info(info, FALSE, r->pool);
   lines = svn_cstring_split(text_stats->data, "\n", FALSE, r->pool);
 
+  /* Add the hit rates of the file delta cache, if there is one. */
+  err = svn_fs__get_file_delta_cache_info(&delta_info, FALSE, r->pool);
+  if (err)
+    svn_error_clear(err);
+  else if (delta_info)
+    {
+      APR_ARRAY_PUSH(lines, const char *) = "File delta cache:";
+      apr_array_cat(lines,
+                    svn_cstring_split(svn_cache__format_info(delta_info, TRUE,
+                                                             r->pool)->data,
+                                      "\n", FALSE, r->pool));
+    }
+
   ap_set_content_type(r, "text/html; charset=ISO-8859-1");
 
   ap_rvputs(r,
@@ -154,8 +154,12 @@ get_vsn_options(apr_pool_t *p, apr_text_header *phdr)
   apr_text_append(p, phdr, SVN_DAV_NS_DAV_SVN_REVERSE_FILE_REVS);
   apr_text_append(p, phdr, SVN_DAV_NS_DAV_SVN_SVNDIFF1);
   apr_text_append(p, phdr, SVN_DAV_NS_DAV_SVN_SVNDIFF2);
+  if (svn_zstd__is_available())
+    apr_text_append(p, phdr, SVN_DAV_NS_DAV_SVN_SVNDIFF3);
   apr_text_append(p, phdr, SVN_DAV_NS_DAV_SVN_PUT_RESULT_CHECKSUM);
   apr_text_append(p, phdr, SVN_DAV_NS_DAV_SVN_LIST);
+  apr_text_append(p, phdr, SVN_DAV_NS_DAV_SVN_BLAME);
+  apr_text_append(p, phdr, SVN_DAV_NS_DAV_SVN_GET_FILES);
   /* Mergeinfo is a special case: here we merely say that the server
    * knows how to handle mergeinfo -- whether the repository does too
    * is a separate matter.
@@ -1159,6 +1163,14 @@ deliver_report(request_rec *r,
         {
           return dav_svn__list_report(resource, doc, output);
         }
+      else if (strcmp(doc->root->name, "blame-report") == 0)
+        {
+          return dav_svn__blame_report(resource, doc, output);
+        }
+      else if (strcmp(doc->root->name, "get-files-report") == 0)
+        {
+          return dav_svn__get_files_report(resource, doc, output);
+        }
       /* NOTE: if you add a report, don't forget to add it to the
        *       dav_svn__reports_list[] array.
        */
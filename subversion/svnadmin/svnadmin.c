@@ -49,6 +49,7 @@
 #include "private/svn_subr_private.h"
 #include "private/svn_cmdline_private.h"
 #include "private/svn_fspath.h"
+#include "private/svn_repos_private.h"
 
 #include "svn_private_config.h"
 
@@ -95,6 +96,7 @@ check_lib_versions(void)
 /** Subcommands. **/
 
 static svn_opt_subcommand_t
+  subcommand_build_log_index,
   subcommand_crashtest,
   subcommand_create,
   subcommand_delrevprop,
@@ -155,7 +157,9 @@ enum svnadmin__cmdline_options_t
     svnadmin__normalize_props,
     svnadmin__exclude,
     svnadmin__include,
-    svnadmin__glob
+    svnadmin__glob,
+    svnadmin__threads,
+    svnadmin__deltas_compression
   };
 
 /* Option codes and descriptions.
@@ -294,6 +298,20 @@ static const apr_getopt_option_t options_table[] =
         "                             Character '/' is not treated specially, so\n"
         "                             pattern /*/foo matches paths /a/foo and /a/b/foo.") },
 
+    {"threads", svnadmin__threads, 1,
+     N_("use up to ARG worker threads for the operation.\n"
+        "                             Default: 1.")},
+
+    {"deltas-compression", svnadmin__deltas_compression, 1,
+     N_("compress deltas in dump output using method ARG\n"
+        "                             (implies --deltas).  ARG is one of:\n"
+        "                                'none'  (default)\n"
+        "                                'zlib', 'zlib-1' ... 'zlib-9'\n"
+        "                                'lz4'   (requires 1.10 to load)\n"
+        "                                'zstd', 'zstd-1' ... 'zstd-19'\n"
+        "                                        (requires 1.10 with zstd\n"
+        "                                        support to load)")},
+
     {NULL}
   };
 
@@ -303,6 +321,16 @@ static const apr_getopt_option_t options_table[] =
  */
 static const svn_opt_subcommand_desc2_t cmd_table[] =
 {
+  {"build-log-index", subcommand_build_log_index, {0}, N_
+   ("usage: svnadmin build-log-index REPOS_PATH\n\n"
+    "Create or update the log index of the repository at REPOS_PATH.\n"
+    "Once it exists, 'log' as well as deleted-revision lookups use it\n"
+    "instead of walking the repository history.  Commits keep an up to\n"
+    "date index current, but many revisions added by other means, e.g.\n"
+    "by 'svnadmin load', require running this command again.  To stop\n"
+    "using the index, remove db/log-index.db.\n"),
+   {'q'} },
+
   {"crashtest", subcommand_crashtest, {0}, N_
    ("usage: svnadmin crashtest REPOS_PATH\n\n"
     "Open the repository at REPOS_PATH, then abort, thus simulating\n"
@@ -355,8 +383,10 @@ static const svn_opt_subcommand_desc2_t cmd_table[] =
     "Using --exclude or --include gives results equivalent to authz-based\n"
     "path exclusions. In particular, when the source of a copy is\n"
     "excluded, the copy is transformed into an add (unlike in 'svndumpfilter').\n"),
-  {'r', svnadmin__incremental, svnadmin__deltas, 'q', 'M', 'F',
-   svnadmin__exclude, svnadmin__include, svnadmin__glob },
+  {'r', svnadmin__incremental, svnadmin__deltas,
+   svnadmin__deltas_compression, 'q', 'M', 'F',
+   svnadmin__exclude, svnadmin__include, svnadmin__glob,
+   svnadmin__threads },
   {{'F', N_("write to file ARG instead of stdout")}} },
 
   {"dump-revprops", subcommand_dump_revprops, {0}, N_
@@ -423,7 +453,7 @@ static const svn_opt_subcommand_desc2_t cmd_table[] =
     svnadmin__use_pre_commit_hook, svnadmin__use_post_commit_hook,
     svnadmin__parent_dir, svnadmin__normalize_props,
     svnadmin__bypass_prop_validation, 'M',
-    svnadmin__no_flush_to_disk, 'F'},
+    svnadmin__no_flush_to_disk, 'F', svnadmin__threads},
    {{'F', N_("read from file ARG instead of stdin")}} },
 
   {"load-revprops", subcommand_load_revprops, {0}, N_
@@ -463,7 +493,7 @@ static const svn_opt_subcommand_desc2_t cmd_table[] =
    ("usage: svnadmin pack REPOS_PATH\n\n"
     "Possibly compact the repository into a more efficient storage model.\n"
     "This may not apply to all repositories, in which case, exit.\n"),
-   {'q', 'M'} },
+   {'q', 'M', svnadmin__threads} },
 
   {"recover", subcommand_recover, {0}, N_
    ("usage: svnadmin recover REPOS_PATH\n\n"
@@ -539,7 +569,8 @@ static const svn_opt_subcommand_desc2_t cmd_table[] =
    ("usage: svnadmin verify REPOS_PATH\n\n"
     "Verify the data stored in the repository.\n"),
    {'t', 'r', 'q', svnadmin__keep_going, 'M',
-    svnadmin__check_normalization, svnadmin__metadata_only} },
+    svnadmin__check_normalization, svnadmin__metadata_only,
+    svnadmin__threads} },
 
   { NULL, NULL, {0}, NULL, {0} }
 };
@@ -557,6 +588,8 @@ struct svnadmin_opt_state
   svn_boolean_t version;                            /* --version */
   svn_boolean_t incremental;                        /* --incremental */
   svn_boolean_t use_deltas;                         /* --deltas */
+  int svndiff_version;                              /* --deltas-compression */
+  int compression_level;                            /* --deltas-compression */
   svn_boolean_t use_pre_commit_hook;                /* --use-pre-commit-hook */
   svn_boolean_t use_post_commit_hook;               /* --use-post-commit-hook */
   svn_boolean_t use_pre_revprop_change_hook;        /* --use-pre-revprop-change-hook */
@@ -577,6 +610,7 @@ struct svnadmin_opt_state
   enum svn_repos_load_uuid uuid_action;             /* --ignore-uuid,
                                                        --force-uuid */
   apr_uint64_t memory_cache_size;                   /* --memory-cache-size M */
+  int threads;                                      /* --threads */
   const char *parent_dir;                           /* --parent-dir */
   const char *file;                                 /* --file */
   apr_array_header_t *exclude;                      /* --exclude */
@@ -587,6 +621,63 @@ struct svnadmin_opt_state
 };
 
 
+/* Parse the --deltas-compression argument ARG and set *SVNDIFF_VERSION
+ * and *COMPRESSION_LEVEL accordingly. */
+static svn_error_t *
+parse_deltas_compression(int *svndiff_version,
+                         int *compression_level,
+                         const char *arg)
+{
+  apr_int64_t level;
+
+  if (strcmp(arg, "none") == 0)
+    {
+      *svndiff_version = 0;
+      *compression_level = SVN_DELTA_COMPRESSION_LEVEL_NONE;
+    }
+  else if (strcmp(arg, "lz4") == 0)
+    {
+      *svndiff_version = 2;
+      *compression_level = SVN_DELTA_COMPRESSION_LEVEL_DEFAULT;
+    }
+  else if (strcmp(arg, "zlib") == 0)
+    {
+      *svndiff_version = 1;
+      *compression_level = SVN_DELTA_COMPRESSION_LEVEL_DEFAULT;
+    }
+  else if (strncmp(arg, "zlib-", 5) == 0)
+    {
+      SVN_ERR(svn_cstring_strtoi64(&level, arg + 5,
+                                   SVN__COMPRESSION_ZLIB_MIN,
+                                   SVN__COMPRESSION_ZLIB_MAX, 10));
+      *svndiff_version = 1;
+      *compression_level = (int)level;
+    }
+  else if (strcmp(arg, "zstd") == 0 || strncmp(arg, "zstd-", 5) == 0)
+    {
+      if (!svn_zstd__is_available())
+        return svn_error_create(SVN_ERR_CL_ARG_PARSING_ERROR, NULL,
+                                _("Zstandard compression is not supported "
+                                  "by this build of Subversion"));
+
+      level = SVN__COMPRESSION_ZSTD_DEFAULT;
+      if (arg[4])
+        SVN_ERR(svn_cstring_strtoi64(&level, arg + 5,
+                                     SVN__COMPRESSION_ZSTD_MIN,
+                                     SVN__COMPRESSION_ZSTD_MAX, 10));
+      *svndiff_version = 3;
+      *compression_level = (int)level;
+    }
+  else
+    {
+      return svn_error_createf(SVN_ERR_CL_ARG_PARSING_ERROR, NULL,
+                               _("Invalid compression method '%s'"), arg);
+    }
+
+  return SVN_NO_ERROR;
+}
+
+
 /* Helper to open a repository and set a warning func (so we don't
  * SEGFAULT when libsvn_fs's default handler gets run).  */
 static svn_error_t *
@@ -611,6 +702,8 @@ open_repos(svn_repos_t **repos,
                            use_block_read ? "1" : "0");
   svn_hash_sets(fs_config, SVN_FS_CONFIG_NO_FLUSH_TO_DISK,
                            opt_state->no_flush_to_disk ? "1" : "0");
+  svn_hash_sets(fs_config, SVN_FS_CONFIG_FSFS_PACK_THREADS,
+                           apr_itoa(pool, opt_state->threads));
 
   /* now, open the requested repository */
   SVN_ERR(svn_repos_open3(repos, path, fs_config, pool, pool));
@@ -924,7 +1017,7 @@ struct repos_verify_callback_baton
 };
 
 /* Implementation of svn_repos_verify_callback_t to handle errors coming
-   from svn_repos_verify_fs3(). */
+   from svn_repos_verify_fs4(). */
 static svn_error_t *
 repos_verify_callback(void *baton,
                       svn_revnum_t revision,
@@ -1190,6 +1283,12 @@ repos_notify_handler(void *baton,
                         notify->new_revision));
       return;
 
+    case svn_repos_notify_log_index_rev:
+      svn_error_clear(svn_stream_printf(feedback_stream, scratch_pool,
+                        _("* Indexed revision %ld.\n"),
+                        notify->revision));
+      return;
+
     default:
       return;
   }
@@ -1385,13 +1484,16 @@ subcommand_dump(apr_getopt_t *os, void *baton, apr_pool_t *pool)
                                  "cannot be used simultaneously"));
     }
 
-  SVN_ERR(svn_repos_dump_fs4(repos, out_stream, lower, upper,
+  SVN_ERR(svn_repos__dump_fs(repos, out_stream, lower, upper,
                              opt_state->incremental, opt_state->use_deltas,
+                             opt_state->svndiff_version,
+                             opt_state->compression_level,
                              TRUE, TRUE,
                              !opt_state->quiet ? repos_notify_handler : NULL,
                              feedback_stream,
                              filter_baton.prefixes ? dump_filter_func : NULL,
                              &filter_baton,
+                             opt_state->threads,
                              check_cancel, NULL, pool));
 
   return SVN_NO_ERROR;
@@ -1434,7 +1536,7 @@ subcommand_dump_revprops(apr_getopt_t *os, void *baton, apr_pool_t *pool)
   SVN_ERR(svn_repos_dump_fs4(repos, out_stream, lower, upper,
                              FALSE, FALSE, TRUE, FALSE,
                              !opt_state->quiet ? repos_notify_handler : NULL,
-                             feedback_stream, NULL, NULL,
+                             feedback_stream, NULL, NULL, 1,
                              check_cancel, NULL, pool));
 
   return SVN_NO_ERROR;
@@ -1648,6 +1750,7 @@ subcommand_load(apr_getopt_t *os, void *baton, apr_pool_t *pool)
                            !opt_state->bypass_prop_validation,
                            opt_state->ignore_dates,
                            opt_state->normalize_props,
+                           opt_state->threads,
                            opt_state->quiet ? NULL : repos_notify_handler,
                            feedback_stream, check_cancel, NULL, pool);
 
@@ -2120,6 +2223,30 @@ subcommand_pack(apr_getopt_t *os, void *baton, apr_pool_t *pool)
 }
 
 
+/* This implements `svn_opt_subcommand_t'. */
+static svn_error_t *
+subcommand_build_log_index(apr_getopt_t *os, void *baton, apr_pool_t *pool)
+{
+  struct svnadmin_opt_state *opt_state = baton;
+  svn_repos_t *repos;
+  svn_stream_t *feedback_stream = NULL;
+
+  /* Expect no more arguments. */
+  SVN_ERR(parse_args(NULL, os, 0, 0, pool));
+
+  SVN_ERR(open_repos(&repos, opt_state->repository_path, opt_state, pool));
+
+  /* Progress feedback goes to STDOUT, unless they asked to suppress it. */
+  if (! opt_state->quiet)
+    feedback_stream = recode_stream_create(stdout, pool);
+
+  return svn_error_trace(
+    svn_repos_build_log_index(repos,
+                              !opt_state->quiet ? repos_notify_handler : NULL,
+                              feedback_stream, check_cancel, NULL, pool));
+}
+
+
 /* This implements `svn_opt_subcommand_t'. */
 static svn_error_t *
 subcommand_verify(apr_getopt_t *os, void *baton, apr_pool_t *pool)
@@ -2181,9 +2308,10 @@ subcommand_verify(apr_getopt_t *os, void *baton, apr_pool_t *pool)
     apr_array_make(pool, 0, sizeof(struct verification_error *));
   verify_baton.result_pool = pool;
 
-  SVN_ERR(svn_repos_verify_fs3(repos, lower, upper,
+  SVN_ERR(svn_repos_verify_fs4(repos, lower, upper,
                                opt_state->check_normalization,
                                opt_state->metadata_only,
+                               opt_state->threads,
                                !opt_state->quiet
                                  ? repos_notify_handler : NULL,
                                feedback_stream,
@@ -2821,6 +2949,7 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
   opt_state.start_revision.kind = svn_opt_revision_unspecified;
   opt_state.end_revision.kind = svn_opt_revision_unspecified;
   opt_state.memory_cache_size = svn_cache_config_get()->cache_size;
+  opt_state.threads = 1;
 
   /* Parse options. */
   SVN_ERR(svn_cmdline__getopt_init(&os, argc, argv, pool));
@@ -2886,6 +3015,19 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
           opt_state.memory_cache_size = 0x100000 * sz_val;
         }
         break;
+      case svnadmin__deltas_compression:
+        SVN_ERR(parse_deltas_compression(&opt_state.svndiff_version,
+                                         &opt_state.compression_level,
+                                         opt_arg));
+        opt_state.use_deltas = TRUE;
+        break;
+      case svnadmin__threads:
+        SVN_ERR(svn_cstring_atoi(&opt_state.threads, opt_arg));
+        if (opt_state.threads < 1)
+          return svn_error_createf(SVN_ERR_CL_ARG_PARSING_ERROR, NULL,
+                                   _("Invalid number of threads '%s'"),
+                                   opt_arg);
+        break;
       case 'F':
         SVN_ERR(svn_utf_cstring_to_utf8(&(opt_state.file), opt_arg, pool));
         dash_F_arg = TRUE;
@@ -3162,7 +3304,7 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
     svn_cache_config_t settings = *svn_cache_config_get();
 
     settings.cache_size = opt_state.memory_cache_size;
-    settings.single_threaded = TRUE;
+    settings.single_threaded = opt_state.threads <= 1;
 
     svn_cache_config_set(&settings);
   }
@@ -82,6 +82,28 @@ file_rev_handler(void *baton, const char *path, svn_revnum_t revnum,
   return SVN_NO_ERROR;
 }
 
+struct blame_baton {
+  apr_int64_t range_count;
+  apr_int64_t line_count;
+};
+
+/* Implements svn_ra_blame_receiver_t */
+static svn_error_t *
+blame_receiver(apr_int64_t start_line,
+               apr_int64_t end_line,
+               svn_revnum_t revision,
+               apr_hash_t *rev_props,
+               void *baton,
+               apr_pool_t *scratch_pool)
+{
+  struct blame_baton *bb = baton;
+
+  bb->range_count++;
+  bb->line_count += end_line - start_line;
+
+  return SVN_NO_ERROR;
+}
+
 static svn_error_t *
 bench_null_blame(const char *target,
                  const svn_opt_revision_t *peg_revision,
@@ -89,6 +111,7 @@ bench_null_blame(const char *target,
                  const svn_opt_revision_t *end,
                  svn_boolean_t include_merged_revisions,
                  svn_boolean_t quiet,
+                 svn_boolean_t server_blame,
                  svn_client_ctx_t *ctx,
                  apr_pool_t *pool)
 {
@@ -140,6 +163,31 @@ bench_null_blame(const char *target,
 
   backwards = (start_revnum > end_revnum);
 
+  if (server_blame)
+    {
+      struct blame_baton bb = { 0, 0 };
+
+      if (backwards || include_merged_revisions)
+        return svn_error_create(SVN_ERR_CL_MUTUALLY_EXCLUSIVE_ARGS, NULL,
+                                _("'--server-blame' supports neither "
+                                  "reverse revision ranges nor merge "
+                                  "history"));
+
+      SVN_ERR(svn_ra_get_blame(ra_session, "", start_revnum, end_revnum,
+                               NULL, blame_receiver, &bb, pool));
+
+      if (!quiet)
+        SVN_ERR(svn_cmdline_printf(pool,
+                                   _("%15s line ranges\n"
+                                     "%15s lines\n"),
+                                   svn__ui64toa_sep(bb.range_count, ',',
+                                                    pool),
+                                   svn__ui64toa_sep(bb.line_count, ',',
+                                                    pool)));
+
+      return SVN_NO_ERROR;
+    }
+
   /* Collect all blame information.
      We need to ensure that we get one revision before the start_rev,
      if available so that we can know what was actually changed in the start
@@ -243,6 +291,7 @@ svn_cl__null_blame(apr_getopt_t *os,
                              &opt_state->end_revision,
                              opt_state->use_merge_history,
                              opt_state->quiet,
+                             opt_state->server_blame,
                              ctx,
                              iterpool);
 
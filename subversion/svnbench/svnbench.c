@@ -69,7 +69,8 @@ typedef enum svn_cl__longopt_t {
   opt_trust_server_cert,
   opt_trust_server_cert_failures,
   opt_changelist,
-  opt_search
+  opt_search,
+  opt_server_blame
 } svn_cl__longopt_t;
 
 
@@ -168,6 +169,10 @@ const apr_getopt_option_t svn_cl__options[] =
                        "history")},
   {"search", opt_search, 1,
                        N_("use ARG as search pattern (glob syntax)")},
+  {"server-blame", opt_server_blame, 0,
+                    N_("let the server compute the blame and fetch\n"
+                       "                             "
+                       "only the resulting line ranges")},
 
   /* Long-opt Aliases
    *
@@ -227,8 +232,11 @@ const svn_opt_subcommand_desc2_t svn_cl__cmd_table[] =
      "  If specified, REV determines in which revision the target is first\n"
      "  looked up.\n"
      "\n"
+     "  With --server-blame, the server annotates the file and only sends\n"
+     "  the resulting line ranges.\n"
+     "\n"
      "  Write the annotated result to standard output.\n"),
-    {'r', 'g'} },
+    {'r', 'g', opt_server_blame} },
 
   { "null-export", svn_cl__null_export, {0}, N_
     ("Create an unversioned copy of a tree.\n"
@@ -682,6 +690,9 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
       case 'g':
         opt_state.use_merge_history = TRUE;
         break;
+      case opt_server_blame:
+        opt_state.server_blame = TRUE;
+        break;
       case opt_search:
         SVN_ERR(svn_utf_cstring_to_utf8(&utf8_opt_arg, opt_arg, pool));
         SVN_ERR(svn_utf__xfrm(&utf8_opt_arg, utf8_opt_arg,
@@ -51,10 +51,12 @@
 #include "svn_mergeinfo.h"
 #include "svn_user.h"
 
+#include "private/svn_fs_private.h"
 #include "private/svn_log.h"
 #include "private/svn_mergeinfo_private.h"
 #include "private/svn_ra_svn_private.h"
 #include "private/svn_fspath.h"
+#include "private/svn_subr_private.h"
 
 #ifdef HAVE_UNISTD_H
 #include <unistd.h>   /* For getpid() */
@@ -811,8 +813,13 @@ static svn_error_t *must_have_access(svn_ra_svn_conn_t *conn,
      authentication whether authz will work or not.  We force
      requiring a username because we need one to be able to check
      authz configuration again with a different user credentials than
-     the first time round. */
-  if (b->client_info->user == NULL
+     the first time round.
+
+     Within a pipeline, the client has already sent further commands
+     that we would misread as its auth response.  So, simply fail the
+     command then.  The client will retry it on its own. */
+  if (! b->in_pipeline
+      && b->client_info->user == NULL
       && b->repository->auth_access >= req
       && (b->client_info->tunnel_user || b->repository->pwdb
           || b->repository->use_sasl))
@@ -979,7 +986,7 @@ static svn_error_t *accept_report(svn_boolean_t *only_empty_entry,
   /* Make an svn_repos report baton.  Tell it to drive the network editor
    * when the report is complete. */
   svn_ra_svn_get_editor(&editor, &edit_baton, conn, pool, NULL, NULL);
-  SVN_CMD_ERR(svn_repos_begin_report3(&report_baton, rev,
+  SVN_CMD_ERR(svn_repos_begin_report4(&report_baton, rev,
                                       b->repository->repos,
                                       b->repository->fs_path->data, target,
                                       tgt_path, text_deltas, depth,
@@ -987,7 +994,7 @@ static svn_error_t *accept_report(svn_boolean_t *only_empty_entry,
                                       editor, edit_baton,
                                       authz_check_access_cb_func(b),
                                       &ab, svn_ra_svn_zero_copy_limit(conn),
-                                      pool));
+                                      b->report_threads, pool));
 
   rb.sb = b;
   rb.repos_url = svn_path_uri_decode(b->repository->repos_url, pool);
@@ -1562,6 +1569,9 @@ get_file(svn_ra_svn_conn_t *conn,
   svn_revnum_t rev;
   svn_fs_root_t *root;
   svn_stream_t *contents;
+  apr_file_t *contents_file = NULL;
+  apr_off_t contents_offset;
+  svn_filesize_t contents_length;
   apr_hash_t *props = NULL;
   apr_array_header_t *inherited_props;
   svn_string_t write_str;
@@ -1614,7 +1624,15 @@ get_file(svn_ra_svn_conn_t *conn,
                           &ab, root, full_path,
                           pool));
   if (want_contents)
-    SVN_CMD_ERR(svn_fs_file_contents(&contents, root, full_path, pool));
+    {
+      /* Plain fulltexts can be sent straight from the repository. */
+      SVN_CMD_ERR(svn_fs__file_contents_range(&contents_file,
+                                              &contents_offset,
+                                              &contents_length,
+                                              root, full_path, pool, pool));
+      if (!contents_file)
+        SVN_CMD_ERR(svn_fs_file_contents(&contents, root, full_path, pool));
+    }
 
   /* Send successful command response with revision and props. */
   SVN_ERR(svn_ra_svn__write_tuple(conn, pool, "w((?c)r(!", "success",
@@ -1644,7 +1662,15 @@ get_file(svn_ra_svn_conn_t *conn,
   SVN_ERR(svn_ra_svn__write_tuple(conn, pool, "!))"));
 
   /* Now send the file's contents. */
-  if (want_contents)
+  if (contents_file)
+    {
+      SVN_ERR(svn_ra_svn__write_file_range(conn, pool, contents_file,
+                                           contents_offset,
+                                           contents_length));
+      SVN_ERR(svn_ra_svn__write_cstring(conn, pool, ""));
+      SVN_ERR(svn_ra_svn__write_cmd_response(conn, pool, ""));
+    }
+  else if (want_contents)
     {
       err = SVN_NO_ERROR;
       while (1)
@@ -3686,6 +3712,364 @@ list(svn_ra_svn_conn_t *conn,
   return svn_error_trace(svn_ra_svn__write_cmd_response(conn, pool, ""));
 }
 
+/* Implements svn_repos_blame_receiver_t, sending the line range and
+ * its revision info to the client.  BATON is the svn_ra_svn_conn_t. */
+static svn_error_t *
+blame_receiver(apr_int64_t start_line,
+               apr_int64_t end_line,
+               svn_revnum_t revision,
+               apr_hash_t *rev_props,
+               void *baton,
+               apr_pool_t *scratch_pool)
+{
+  svn_ra_svn_conn_t *conn = baton;
+  const svn_string_t *author = NULL;
+  const svn_string_t *date = NULL;
+
+  if (rev_props)
+    {
+      author = svn_hash_gets(rev_props, SVN_PROP_REVISION_AUTHOR);
+      date = svn_hash_gets(rev_props, SVN_PROP_REVISION_DATE);
+    }
+
+  return svn_error_trace(svn_ra_svn__write_tuple(conn, scratch_pool,
+                                                 "nn(?r)(?c)(?c)",
+                                                 (apr_uint64_t)start_line,
+                                                 (apr_uint64_t)end_line,
+                                                 revision,
+                                                 author ? author->data : NULL,
+                                                 date ? date->data : NULL));
+}
+
+static svn_error_t *
+get_blame(svn_ra_svn_conn_t *conn,
+          apr_pool_t *pool,
+          svn_ra_svn__list_t *params,
+          void *baton)
+{
+  server_baton_t *b = baton;
+  const char *path, *full_path;
+  svn_revnum_t start_rev, end_rev;
+  svn_ra_svn__list_t *options_list;
+  apr_array_header_t *diff_options;
+  int i;
+  svn_error_t *err, *write_err;
+
+  authz_baton_t ab;
+  ab.server = b;
+  ab.conn = conn;
+
+  /* Read the command parameters. */
+  SVN_ERR(svn_ra_svn__parse_tuple(params, "crrl", &path, &start_rev,
+                                  &end_rev, &options_list));
+  full_path = svn_fspath__join(b->repository->fs_path->data,
+                               svn_relpath_canonicalize(path, pool), pool);
+
+  diff_options = apr_array_make(pool, options_list->nelts,
+                                sizeof(const char *));
+  for (i = 0; i < options_list->nelts; ++i)
+    {
+      svn_ra_svn__item_t *elt = &SVN_RA_SVN__LIST_ITEM(options_list, i);
+
+      if (elt->kind != SVN_RA_SVN_STRING)
+        return svn_error_create(SVN_ERR_RA_SVN_MALFORMED_DATA, NULL,
+                                "Diff option not a string");
+
+      APR_ARRAY_PUSH(diff_options, const char *) = elt->u.string.data;
+    }
+
+  /* Check authorizations */
+  SVN_ERR(must_have_access(conn, pool, b, svn_authz_read,
+                           full_path, FALSE));
+
+  SVN_ERR(log_command(b, conn, pool, "%s",
+                      svn_log__get_blame(full_path, start_rev, end_rev,
+                                         diff_options, pool)));
+
+  /* Blame the file and send the line ranges immediately. */
+  err = svn_repos_blame(b->repository->repos, full_path, start_rev, end_rev,
+                        diff_options, authz_check_access_cb_func(b), &ab,
+                        blame_receiver, conn, NULL, NULL, pool);
+
+  /* Finish response. */
+  write_err = svn_ra_svn__write_word(conn, pool, "done");
+  if (write_err)
+    {
+      svn_error_clear(err);
+      return write_err;
+    }
+  SVN_CMD_ERR(err);
+
+  return svn_error_trace(svn_ra_svn__write_cmd_response(conn, pool, ""));
+}
+
+/* Baton type to be used with send_zero_copy_contents(). */
+typedef struct zero_copy_baton_t
+{
+  /* The connection to send the contents to. */
+  svn_ra_svn_conn_t *conn;
+
+  /* Don't send contents larger than this. */
+  apr_size_t zero_copy_limit;
+
+  /* Set to TRUE if the contents have been sent. */
+  svn_boolean_t sent;
+} zero_copy_baton_t;
+
+/* Implements svn_fs_process_contents_func_t.  If LEN does not exceed the
+ * limit given in the zero_copy_baton_t BATON, send CONTENTS directly from
+ * the FS cache as a single string and set BATON->sent.
+ */
+static svn_error_t *
+send_zero_copy_contents(const unsigned char *contents,
+                        apr_size_t len,
+                        void *baton,
+                        apr_pool_t *scratch_pool)
+{
+  zero_copy_baton_t *zb = baton;
+  svn_string_t write_str;
+
+  if (len > zb->zero_copy_limit)
+    return SVN_NO_ERROR;
+
+  if (len > 0)
+    {
+      write_str.data = (const char *)contents;
+      write_str.len = len;
+      SVN_ERR(svn_ra_svn__write_string(zb->conn, scratch_pool, &write_str));
+    }
+
+  zb->sent = TRUE;
+  return SVN_NO_ERROR;
+}
+
+/* Send the file FULL_PATH in REV as part of a get-files response, using
+ * PATH as the path reported to the client.  Include its properties if
+ * WANT_PROPS is set.  Use POOL for allocations.
+ *
+ * Errors that leave the response in a consistent state, i.e. such that
+ * the client will see a complete file entry or none at all, are wrapped
+ * in SVN_ERR_RA_SVN_CMD_ERR.  Other errors are connection errors.
+ */
+static svn_error_t *
+send_file(svn_ra_svn_conn_t *conn,
+          server_baton_t *b,
+          authz_baton_t *ab,
+          const char *path,
+          const char *full_path,
+          svn_revnum_t rev,
+          svn_boolean_t want_props,
+          apr_pool_t *pool)
+{
+  svn_fs_root_t *root;
+  svn_checksum_t *checksum;
+  svn_stream_t *contents;
+  apr_hash_t *props = NULL;
+  svn_error_t *err = SVN_NO_ERROR, *write_err;
+  apr_size_t zero_copy_limit = svn_ra_svn_zero_copy_limit(conn);
+  svn_boolean_t zero_copy_sent = FALSE;
+
+  /* Check authorizations for this path only.  We already sent our
+     single auth reply for the whole command. */
+  if (! lookup_access(pool, b, svn_authz_read, full_path, FALSE))
+    return svn_error_create(SVN_ERR_RA_SVN_CMD_ERR,
+                            error_create_and_log(SVN_ERR_RA_NOT_AUTHORIZED,
+                                                 NULL, NULL, b),
+                            NULL);
+
+  /* Get everything that may fail before sending the file header. */
+  SVN_CMD_ERR(svn_fs_revision_root(&root, b->repository->fs, rev, pool));
+  SVN_CMD_ERR(svn_fs_file_checksum(&checksum, svn_checksum_md5, root,
+                                   full_path, TRUE, pool));
+  if (want_props)
+    SVN_CMD_ERR(get_props(&props, NULL, ab, root, full_path, pool));
+
+  SVN_ERR(svn_ra_svn__write_tuple(conn, pool, "c(?c)r(!", path,
+                                  svn_checksum_to_cstring_display(checksum,
+                                                                  pool),
+                                  rev));
+  SVN_ERR(svn_ra_svn__write_proplist(conn, pool, props));
+  SVN_ERR(svn_ra_svn__write_tuple(conn, pool, "!)"));
+
+  /* Send small, cached contents directly from the cache. */
+  if (zero_copy_limit > 0)
+    {
+      zero_copy_baton_t zb;
+      svn_boolean_t called = FALSE;
+
+      zb.conn = conn;
+      zb.zero_copy_limit = zero_copy_limit;
+      zb.sent = FALSE;
+
+      err = svn_fs_try_process_file_contents(&called, root, full_path,
+                                             send_zero_copy_contents, &zb,
+                                             pool);
+      if (err || (called && zb.sent))
+        zero_copy_sent = TRUE;
+    }
+
+  /* Stream everything else. */
+  if (!zero_copy_sent)
+    err = svn_fs_file_contents(&contents, root, full_path, pool);
+  while (!err && !zero_copy_sent)
+    {
+      char buf[SVN__STREAM_CHUNK_SIZE];
+      apr_size_t len = sizeof(buf);
+
+      err = svn_stream_read_full(contents, buf, &len);
+      if (err)
+        break;
+      if (len > 0)
+        {
+          svn_string_t write_str;
+
+          write_str.data = buf;
+          write_str.len = len;
+          SVN_ERR(svn_ra_svn__write_string(conn, pool, &write_str));
+        }
+      if (len < sizeof(buf))
+        {
+          err = svn_stream_close(contents);
+          break;
+        }
+    }
+
+  /* Terminate the contents even if reading them failed.  If that was
+     due to a connection error, this will fail as well. */
+  write_err = svn_ra_svn__write_cstring(conn, pool, "");
+  if (write_err)
+    {
+      svn_error_clear(err);
+      return write_err;
+    }
+  SVN_CMD_ERR(err);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+get_files(svn_ra_svn_conn_t *conn,
+          apr_pool_t *pool,
+          svn_ra_svn__list_t *params,
+          void *baton)
+{
+  server_baton_t *b = baton;
+  svn_ra_svn__list_t *targets;
+  svn_boolean_t want_props;
+  apr_array_header_t *paths, *full_paths, *revisions;
+  const char *denied_path;
+  svn_revnum_t youngest = SVN_INVALID_REVNUM;
+  apr_pool_t *iterpool;
+  int i;
+  svn_error_t *err = SVN_NO_ERROR, *write_err;
+
+  authz_baton_t ab;
+  ab.server = b;
+  ab.conn = conn;
+
+  /* Read the command parameters. */
+  SVN_ERR(svn_ra_svn__parse_tuple(params, "lb", &targets, &want_props));
+
+  paths = apr_array_make(pool, targets->nelts, sizeof(const char *));
+  full_paths = apr_array_make(pool, targets->nelts, sizeof(const char *));
+  revisions = apr_array_make(pool, targets->nelts, sizeof(svn_revnum_t));
+  for (i = 0; i < targets->nelts; ++i)
+    {
+      svn_ra_svn__item_t *elt = &SVN_RA_SVN__LIST_ITEM(targets, i);
+      const char *path;
+      svn_revnum_t rev;
+
+      if (elt->kind != SVN_RA_SVN_LIST)
+        return svn_error_create(SVN_ERR_RA_SVN_MALFORMED_DATA, NULL,
+                                "File target not a list");
+      SVN_ERR(svn_ra_svn__parse_tuple(&elt->u.list, "c(?r)", &path, &rev));
+
+      APR_ARRAY_PUSH(paths, const char *) = path;
+      APR_ARRAY_PUSH(full_paths, const char *)
+        = svn_fspath__join(b->repository->fs_path->data,
+                           svn_relpath_canonicalize(path, pool), pool);
+      APR_ARRAY_PUSH(revisions, svn_revnum_t) = rev;
+    }
+
+  /* Like get-file, give the client a chance to authenticate if it lacks
+     read access to any of the paths.  Checking the first such path is
+     enough to trigger that.  The individual paths still get checked as
+     we go. */
+  denied_path = NULL;
+  for (i = 0; i < full_paths->nelts && !denied_path; ++i)
+    if (! lookup_access(pool, b, svn_authz_read,
+                        APR_ARRAY_IDX(full_paths, i, const char *), FALSE))
+      denied_path = APR_ARRAY_IDX(full_paths, i, const char *);
+
+  SVN_ERR(must_have_access(conn, pool, b, svn_authz_read, denied_path,
+                           FALSE));
+
+  for (i = 0; i < revisions->nelts; ++i)
+    if (!SVN_IS_VALID_REVNUM(APR_ARRAY_IDX(revisions, i, svn_revnum_t)))
+      {
+        if (!SVN_IS_VALID_REVNUM(youngest))
+          SVN_CMD_ERR(svn_fs_youngest_rev(&youngest, b->repository->fs,
+                                          pool));
+        APR_ARRAY_IDX(revisions, i, svn_revnum_t) = youngest;
+      }
+
+  SVN_ERR(log_command(b, conn, pool, "%s",
+                      svn_log__get_files(full_paths, revisions, want_props,
+                                         pool)));
+
+  /* Send the files one after another and stop at the first failure. */
+  iterpool = svn_pool_create(pool);
+  for (i = 0; i < paths->nelts && !err; ++i)
+    {
+      svn_pool_clear(iterpool);
+      err = send_file(conn, b, &ab,
+                      APR_ARRAY_IDX(paths, i, const char *),
+                      APR_ARRAY_IDX(full_paths, i, const char *),
+                      APR_ARRAY_IDX(revisions, i, svn_revnum_t),
+                      want_props, iterpool);
+    }
+  svn_pool_destroy(iterpool);
+
+  /* Connection errors leave us no chance to finish the response. */
+  if (err && err->apr_err != SVN_ERR_RA_SVN_CMD_ERR)
+    return err;
+
+  /* Finish response. */
+  write_err = svn_ra_svn__write_word(conn, pool, "done");
+  if (write_err)
+    {
+      svn_error_clear(err);
+      return write_err;
+    }
+  SVN_ERR(err);
+
+  return svn_error_trace(svn_ra_svn__write_cmd_response(conn, pool, ""));
+}
+
+static svn_error_t *
+begin_pipeline(svn_ra_svn_conn_t *conn,
+               apr_pool_t *pool,
+               svn_ra_svn__list_t *params,
+               void *baton)
+{
+  server_baton_t *b = baton;
+
+  b->in_pipeline = TRUE;
+  return svn_error_trace(svn_ra_svn__write_cmd_response(conn, pool, ""));
+}
+
+static svn_error_t *
+end_pipeline(svn_ra_svn_conn_t *conn,
+             apr_pool_t *pool,
+             svn_ra_svn__list_t *params,
+             void *baton)
+{
+  server_baton_t *b = baton;
+
+  b->in_pipeline = FALSE;
+  return svn_error_trace(svn_ra_svn__write_cmd_response(conn, pool, ""));
+}
+
 static const svn_ra_svn__cmd_entry_t main_commands[] = {
   { "reparent",        reparent },
   { "get-latest-rev",  get_latest_rev },
@@ -3719,6 +4103,10 @@ static const svn_ra_svn__cmd_entry_t main_commands[] = {
   { "get-deleted-rev", get_deleted_rev },
   { "get-iprops",      get_inherited_props },
   { "list",            list },
+  { "get-blame",       get_blame },
+  { "get-files",       get_files },
+  { "begin-pipeline",  begin_pipeline },
+  { "end-pipeline",    end_pipeline },
   { NULL }
 };
 
@@ -4119,6 +4507,7 @@ construct_server_baton(server_baton_t **baton,
   b->repository->use_sasl = FALSE;
 
   b->read_only = params->read_only;
+  b->report_threads = params->report_threads;
   b->pool = conn_pool;
   b->vhost = params->vhost;
 
@@ -4129,7 +4518,7 @@ construct_server_baton(server_baton_t **baton,
    * send an empty mechlist. */
   if (params->compression_level > 0)
     SVN_ERR(svn_ra_svn__write_cmd_response(conn, scratch_pool,
-                                           "nn()(wwwwwwwwwwwww)",
+                                           "nn()(wwwwwwwwwwwwwwww?w)",
                                            (apr_uint64_t) 2, (apr_uint64_t) 2,
                                            SVN_RA_SVN_CAP_EDIT_PIPELINE,
                                            SVN_RA_SVN_CAP_SVNDIFF1,
@@ -4143,11 +4532,17 @@ construct_server_baton(server_baton_t **baton,
                                            SVN_RA_SVN_CAP_INHERITED_PROPS,
                                            SVN_RA_SVN_CAP_EPHEMERAL_TXNPROPS,
                                            SVN_RA_SVN_CAP_GET_FILE_REVS_REVERSE,
-                                           SVN_RA_SVN_CAP_LIST
+                                           SVN_RA_SVN_CAP_LIST,
+                                           SVN_RA_SVN_CAP_BLAME,
+                                           SVN_RA_SVN_CAP_PIPELINING,
+                                           SVN_RA_SVN_CAP_GET_FILES,
+                                           svn_zstd__is_available()
+                                             ? SVN_RA_SVN_CAP_SVNDIFF3_ACCEPTED
+                                             : NULL
                                            ));
   else
     SVN_ERR(svn_ra_svn__write_cmd_response(conn, scratch_pool,
-                                           "nn()(wwwwwwwwwww)",
+                                           "nn()(wwwwwwwwwwwwww)",
                                            (apr_uint64_t) 2, (apr_uint64_t) 2,
                                            SVN_RA_SVN_CAP_EDIT_PIPELINE,
                                            SVN_RA_SVN_CAP_ABSENT_ENTRIES,
@@ -4159,7 +4554,10 @@ construct_server_baton(server_baton_t **baton,
                                            SVN_RA_SVN_CAP_INHERITED_PROPS,
                                            SVN_RA_SVN_CAP_EPHEMERAL_TXNPROPS,
                                            SVN_RA_SVN_CAP_GET_FILE_REVS_REVERSE,
-                                           SVN_RA_SVN_CAP_LIST
+                                           SVN_RA_SVN_CAP_LIST,
+                                           SVN_RA_SVN_CAP_BLAME,
+                                           SVN_RA_SVN_CAP_PIPELINING,
+                                           SVN_RA_SVN_CAP_GET_FILES
                                            ));
 
   /* Read client response, which we assume to be in version 2 format:
@@ -4311,23 +4709,27 @@ construct_server_baton(server_baton_t **baton,
   return SVN_NO_ERROR;
 }
 
-svn_error_t *
-serve_interruptable(svn_boolean_t *terminate_p,
-                    connection_t *connection,
-                    svn_boolean_t (* is_busy)(connection_t *),
-                    apr_pool_t *pool)
+/* Return a hash mapping all command names to their
+   svn_ra_svn__cmd_entry_t, allocated in RESULT_POOL. */
+static apr_hash_t *
+make_command_hash(apr_pool_t *result_pool)
 {
-  svn_boolean_t terminate = FALSE;
-  svn_error_t *err = NULL;
   const svn_ra_svn__cmd_entry_t *command;
-  apr_pool_t *iterpool = svn_pool_create(pool);
+  apr_hash_t *cmd_hash = apr_hash_make(result_pool);
 
-  /* Prepare command parser. */
-  apr_hash_t *cmd_hash = apr_hash_make(pool);
   for (command = main_commands; command->cmdname; command++)
     svn_hash_sets(cmd_hash, command->cmdname, command);
 
-  /* Auto-initialize connection */
+  return cmd_hash;
+}
+
+/* If CONNECTION has not been used before, create its ra_svn connection
+   object and its server baton, performing the initial handshake with
+   the client.  Use SCRATCH_POOL for temporary allocations. */
+static svn_error_t *
+init_connection(connection_t *connection,
+                apr_pool_t *scratch_pool)
+{
   if (! connection->conn)
     {
       apr_status_t ar;
@@ -4357,10 +4759,29 @@ serve_interruptable(svn_boolean_t *terminate_p,
                                   connection->pool);
 
       /* Construct server baton and open the repository for the first time. */
-      err = construct_server_baton(&connection->baton, connection->conn,
-                                   connection->params, pool);
+      SVN_ERR(construct_server_baton(&connection->baton, connection->conn,
+                                     connection->params, scratch_pool));
     }
 
+  return SVN_NO_ERROR;
+}
+
+svn_error_t *
+serve_interruptable(svn_boolean_t *terminate_p,
+                    connection_t *connection,
+                    svn_boolean_t (* is_busy)(connection_t *),
+                    apr_pool_t *pool)
+{
+  svn_boolean_t terminate = FALSE;
+  svn_error_t *err;
+  apr_pool_t *iterpool = svn_pool_create(pool);
+
+  /* Prepare command parser. */
+  apr_hash_t *cmd_hash = make_command_hash(pool);
+
+  /* Auto-initialize connection */
+  err = init_connection(connection, pool);
+
   /* If we can't access the repo for some reason, end this connection. */
   if (err)
     terminate = TRUE;
@@ -4408,6 +4829,48 @@ serve_interruptable(svn_boolean_t *terminate_p,
   return svn_error_trace(err);
 }
 
+svn_error_t *
+serve_buffered(svn_boolean_t *terminate_p,
+               connection_t *connection,
+               apr_pool_t *pool)
+{
+  svn_boolean_t terminate = FALSE;
+  svn_error_t *err;
+  apr_pool_t *iterpool = svn_pool_create(pool);
+
+  /* Prepare command parser. */
+  apr_hash_t *cmd_hash = make_command_hash(pool);
+
+  /* Auto-initialize connection */
+  err = init_connection(connection, pool);
+
+  /* If we can't access the repo for some reason, end this connection. */
+  if (err)
+    terminate = TRUE;
+
+  /* Process all commands that have been received completely. */
+  while (!terminate && !err)
+    {
+      svn_boolean_t has_command;
+
+      svn_pool_clear(iterpool);
+      err = svn_ra_svn__has_complete_command(&has_command, &terminate,
+                                             connection->conn, iterpool);
+      if (err || !has_command)
+        break;
+
+      err = svn_ra_svn__handle_command(&terminate, cmd_hash,
+                                       connection->baton,
+                                       connection->conn,
+                                       FALSE, iterpool);
+    }
+
+  svn_pool_destroy(iterpool);
+  *terminate_p = terminate;
+
+  return svn_error_trace(err);
+}
+
 svn_error_t *serve(svn_ra_svn_conn_t *conn,
                    serve_params_t *params,
                    apr_pool_t *pool)
@@ -90,6 +90,8 @@ typedef struct server_baton_t {
                               May be NULL even if log_file is not. */
   svn_boolean_t read_only; /* Disallow write access (global flag) */
   svn_boolean_t vhost;     /* Use virtual-host-based path to repo. */
+  svn_boolean_t in_pipeline; /* Between begin-pipeline and end-pipeline. */
+  int report_threads;      /* Threads per reporter run (see serve_params_t) */
   apr_pool_t *pool;
 } server_baton_t;
 
@@ -159,6 +161,10 @@ typedef struct serve_params_t {
 
   /* Use virtual-host-based path to repo. */
   svn_boolean_t vhost;
+
+  /* Number of threads to use per reporter run, i.e. per update, switch
+     or status request.  1 disables prefetching in the reporter. */
+  int report_threads;
 } serve_params_t;
 
 /* This structure contains all data that describes a client / server
@@ -221,6 +227,21 @@ serve_interruptable(svn_boolean_t *terminate_p,
                     svn_boolean_t (* is_busy)(connection_t *),
                     apr_pool_t *pool);
 
+/* Serve all commands of CONNECTION that can be read without blocking,
+   i.e. that have already been received completely, and return once
+   there is none left.  Set *TERMINATE_P to TRUE if the connection got
+   terminated.  Commands that exchange more than a single request with
+   the client, e.g. commit, will still block until they are done.  So
+   will any command on a SASL encrypted connection, whose input can only
+   be decoded in whole packets.
+
+   Connection initialization is the same as for serve_interruptable.
+ */
+svn_error_t *
+serve_buffered(svn_boolean_t *terminate_p,
+               connection_t *connection,
+               apr_pool_t *pool);
+
 /* Initialize the Cyrus SASL library. POOL is used for allocations. */
 svn_error_t *cyrus_init(apr_pool_t *pool);
 
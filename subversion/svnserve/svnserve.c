@@ -56,10 +56,12 @@
 #include "private/svn_cmdline_private.h"
 #include "private/svn_atomic.h"
 #include "private/svn_mutex.h"
+#include "private/svn_ra_svn_private.h"
 #include "private/svn_subr_private.h"
 
 #if APR_HAS_THREADS
 #    include <apr_thread_pool.h>
+#    include <apr_poll.h>
 #endif
 
 #include "winservice.h"
@@ -76,6 +78,7 @@
 enum connection_handling_mode {
   connection_mode_fork,   /* Create a process per connection */
   connection_mode_thread, /* Create a thread per connection */
+  connection_mode_event,  /* Use threads only for complete requests */
   connection_mode_single  /* One connection at a time in this process */
 };
 
@@ -222,6 +225,8 @@ void winservice_notify_stop(void)
 #define SVNSERVE_OPT_MAX_REQUEST     274
 #define SVNSERVE_OPT_MAX_RESPONSE    275
 #define SVNSERVE_OPT_CACHE_NODEPROPS 276
+#define SVNSERVE_OPT_MULTIPLEX       277
+#define SVNSERVE_OPT_REPORT_THREADS  278
 
 /* Text macro because we can't use #ifdef sections inside a N_("...")
    macro expansion. */
@@ -229,7 +234,7 @@ void winservice_notify_stop(void)
 #define ONLY_AVAILABLE_WITH_THEADS \
         "\n" \
         "                             "\
-        "[used only with --threads]"
+        "[used only with --threads or --multiplex]"
 #else
 #define ONLY_AVAILABLE_WITH_THEADS ""
 #endif
@@ -347,6 +352,14 @@ static const apr_getopt_option_t svnserve__options[] =
     {"threads",          'T', 0, N_("use threads instead of fork "
                                     "[mode: daemon]")},
 #endif
+#if APR_HAS_THREADS
+    {"multiplex",        SVNSERVE_OPT_MULTIPLEX, 0,
+     N_("wait for requests on all connections in a\n"
+        "                             "
+        "single thread and use worker threads only to\n"
+        "                             "
+        "process them [mode: daemon]")},
+#endif
 #if APR_HAS_THREADS
     {"min-threads",      SVNSERVE_OPT_MIN_THREADS, 1,
      N_("Minimum number of server threads, even if idle.\n"
@@ -362,6 +375,13 @@ static const apr_getopt_option_t svnserve__options[] =
         "                             "
         "Default is " APR_STRINGIFY(THREADPOOL_MAX_SIZE) "."
         ONLY_AVAILABLE_WITH_THEADS)},
+    {"report-threads",   SVNSERVE_OPT_REPORT_THREADS, 1,
+     N_("Number of threads per update, switch or status\n"
+        "                             "
+        "request used to read file data ahead of sending\n"
+        "                             "
+        "it to the client.  Default is 1 (no prefetching)."
+        ONLY_AVAILABLE_WITH_THEADS)},
 #endif
     {"max-request-size", SVNSERVE_OPT_MAX_REQUEST, 1,
      N_("Maximum acceptable size of a client request in MB.\n"
@@ -656,6 +676,181 @@ static void * APR_THREAD_FUNC serve_thread(apr_thread_t *tid, void *data)
   return NULL;
 }
 
+/* Size hint for the pollset that holds all idle connections in event
+   mode.  APR may use this as a hard limit on platforms without a
+   native event notification mechanism. */
+#define EVENT_POLLSET_SIZE 1024
+
+/* In event mode, the listening socket plus all connections that wait
+   for their next request. */
+static apr_pollset_t *pollset;
+
+/* Fill *POLLFD with the descriptor for CONNECTION in POLLSET. */
+static void
+init_connection_pollfd(apr_pollfd_t *pollfd,
+                       connection_t *connection)
+{
+  memset(pollfd, 0, sizeof(*pollfd));
+  pollfd->p = connection->pool;
+  pollfd->desc_type = APR_POLL_SOCKET;
+  pollfd->reqevents = APR_POLLIN;
+  pollfd->desc.s = connection->usock;
+  pollfd->client_data = connection;
+}
+
+/* Let the event loop wait for the next request on CONNECTION. */
+static apr_status_t
+watch_connection(connection_t *connection)
+{
+  apr_pollfd_t pollfd;
+  init_connection_pollfd(&pollfd, connection);
+
+  return apr_pollset_add(pollset, &pollfd);
+}
+
+/* Stop the event loop from waiting for requests on CONNECTION. */
+static apr_status_t
+unwatch_connection(connection_t *connection)
+{
+  apr_pollfd_t pollfd;
+  init_connection_pollfd(&pollfd, connection);
+
+  return apr_pollset_remove(pollset, &pollfd);
+}
+
+/* Serve all requests that the event loop received completely on the
+   connection given by DATA, then hand the connection back to the event
+   loop.  New connections get initialized here as well. */
+static void * APR_THREAD_FUNC serve_event_thread(apr_thread_t *tid,
+                                                 void *data)
+{
+  svn_boolean_t done;
+  connection_t *connection = data;
+  svn_error_t *err;
+
+  apr_pool_t *pool = svn_root_pools__acquire_pool(connection_pools);
+
+  /* process the actual requests and log errors */
+  err = serve_buffered(&done, connection, pool);
+  if (err)
+    {
+      logger__log_error(connection->params->logger, err, NULL,
+                        get_client_info(connection->conn, connection->params,
+                                        pool));
+      svn_error_clear(err);
+      done = TRUE;
+    }
+  svn_root_pools__release_pool(pool, connection_pools);
+
+  /* Close the connection or wait for its next request.  Once it is being
+     watched again, the event loop owns CONNECTION. */
+  if (done || watch_connection(connection))
+    close_connection(connection);
+
+  return NULL;
+}
+
+/* Accept connections on SOCK and serve them with PARAMS until an error
+   occurs.  Connections that wait for their next request only occupy a
+   slot in POLLSET; the request data gets buffered by this thread and
+   only complete requests get passed to the worker THREADS.  Use POOL
+   for all allocations. */
+static svn_error_t *
+serve_events(apr_socket_t *sock,
+             serve_params_t *params,
+             apr_pool_t *pool)
+{
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  apr_pollfd_t listener = { 0 };
+  apr_status_t status;
+
+  status = apr_pollset_create(&pollset, EVENT_POLLSET_SIZE, pool,
+                              APR_POLLSET_THREADSAFE);
+  if (status)
+    return svn_error_wrap_apr(status, _("Can't create pollset"));
+
+  listener.p = pool;
+  listener.desc_type = APR_POLL_SOCKET;
+  listener.reqevents = APR_POLLIN;
+  listener.desc.s = sock;
+  listener.client_data = NULL;
+
+  status = apr_pollset_add(pollset, &listener);
+  if (status)
+    return svn_error_wrap_apr(status, _("Can't watch listening socket"));
+
+  while (1)
+    {
+      const apr_pollfd_t *events;
+      apr_int32_t count;
+      apr_int32_t i;
+
+      status = apr_pollset_poll(pollset, -1, &count, &events);
+      if (APR_STATUS_IS_EINTR(status))
+        continue;
+      if (status)
+        return svn_error_wrap_apr(status, _("Can't poll connections"));
+
+      for (i = 0; i < count; i++)
+        {
+          connection_t *connection = events[i].client_data;
+          svn_boolean_t has_command = FALSE;
+          svn_boolean_t terminated = FALSE;
+          svn_error_t *err;
+
+          svn_pool_clear(iterpool);
+
+          /* The initial handshake may block, so leave it to the
+             worker threads as well. */
+          if (connection == NULL)
+            {
+              SVN_ERR(accept_connection(&connection, sock, params,
+                                        connection_mode_event, pool));
+
+              status = apr_thread_pool_push(threads, serve_event_thread,
+                                            connection, 0, NULL);
+              if (status)
+                return svn_error_wrap_apr(status, _("Can't push task"));
+
+              continue;
+            }
+
+          /* Read whatever the client sent without blocking.  Connections
+             whose input can't be buffered that way, i.e. SASL encrypted
+             ones, get reported as soon as they have any input and a
+             worker will wait for the rest of the request instead. */
+          err = svn_ra_svn__has_complete_command(&has_command, &terminated,
+                                                 connection->conn,
+                                                 iterpool);
+          if (err)
+            {
+              logger__log_error(params->logger, err, NULL,
+                                get_client_info(connection->conn, params,
+                                                iterpool));
+              svn_error_clear(err);
+              terminated = TRUE;
+            }
+
+          if (!terminated && !has_command)
+            continue;
+
+          unwatch_connection(connection);
+          if (terminated)
+            {
+              close_connection(connection);
+              continue;
+            }
+
+          status = apr_thread_pool_push(threads, serve_event_thread,
+                                        connection, 0, NULL);
+          if (status)
+            return svn_error_wrap_apr(status, _("Can't push task"));
+        }
+    }
+
+  /* NOTREACHED */
+}
+
 #endif
 
 /* Write the PID of the current process as a decimal number, followed by a
@@ -771,6 +966,7 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
   params.username_case = CASE_ASIS;
   params.memory_cache_size = (apr_uint64_t)-1;
   params.zero_copy_limit = 0;
+  params.report_threads = 1;
   params.error_check_interval = 4096;
   params.max_request_size = MAX_REQUEST_SIZE * 0x100000;
   params.max_response_size = 0;
@@ -892,6 +1088,11 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
           handling_opt_count++;
           break;
 
+        case SVNSERVE_OPT_MULTIPLEX:
+          handling_mode = connection_mode_event;
+          handling_opt_count++;
+          break;
+
         case 'c':
           params.compression_level = atoi(arg);
           if (params.compression_level < SVN_DELTA_COMPRESSION_LEVEL_NONE)
@@ -962,6 +1163,12 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
           max_thread_count = (apr_size_t)apr_strtoi64(arg, NULL, 0);
           break;
 
+        case SVNSERVE_OPT_REPORT_THREADS:
+          params.report_threads = (int)apr_strtoi64(arg, NULL, 0);
+          if (params.report_threads < 1)
+            params.report_threads = 1;
+          break;
+
 #ifdef WIN32
         case SVNSERVE_OPT_SERVICE:
           if (run_mode != run_mode_service)
@@ -1029,7 +1236,8 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
   if (handling_opt_count > 1)
     {
       svn_error_clear(svn_cmdline_fputs(
-                      _("You may only specify one of -T or --single-thread\n"),
+                      _("You may only specify one of -T, --multiplex or "
+                        "--single-thread\n"),
                       stderr, pool));
       usage(argv[0], pool);
       *exit_code = EXIT_FAILURE;
@@ -1037,10 +1245,13 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
     }
 
   /* construct object pools */
-  is_multi_threaded = handling_mode == connection_mode_thread;
+  is_multi_threaded = handling_mode == connection_mode_thread
+                   || handling_mode == connection_mode_event;
   params.fs_config = apr_hash_make(pool);
   svn_hash_sets(params.fs_config, SVN_FS_CONFIG_FSFS_CACHE_DELTAS,
                 cache_txdeltas ? "1" :"0");
+  svn_hash_sets(params.fs_config, SVN_FS_CONFIG_CACHE_FILE_DELTAS,
+                cache_txdeltas ? "1" :"0");
   svn_hash_sets(params.fs_config, SVN_FS_CONFIG_FSFS_CACHE_FULLTEXTS,
                 cache_fulltexts ? "1" :"0");
   svn_hash_sets(params.fs_config, SVN_FS_CONFIG_FSFS_CACHE_NODEPROPS,
@@ -1280,7 +1491,7 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
       settings.cache_size = params.memory_cache_size;
 
     settings.single_threaded = TRUE;
-    if (handling_mode == connection_mode_thread)
+    if (is_multi_threaded || params.report_threads > 1)
       {
 #if APR_HAS_THREADS
         settings.single_threaded = FALSE;
@@ -1300,7 +1511,7 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
 #if APR_HAS_THREADS
   SVN_ERR(svn_root_pools__create(&connection_pools));
 
-  if (handling_mode == connection_mode_thread)
+  if (is_multi_threaded)
     {
       /* create the thread pool with a valid range of threads */
       if (max_thread_count < 1)
@@ -1328,6 +1539,10 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
     {
       threads = NULL;
     }
+
+  if (   handling_mode == connection_mode_event
+      && run_mode != run_mode_listen_once)
+    return svn_error_trace(serve_events(sock, &params, pool));
 #endif
 
   while (1)
@@ -1382,6 +1597,10 @@ sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
 #endif
           break;
 
+        case connection_mode_event:
+          /* Only used with run_mode_listen_once, handled above. */
+          break;
+
         case connection_mode_single:
           /* Serve one connection at a time. */
           /* serve_socket() logs any error it returns, so ignore it. */
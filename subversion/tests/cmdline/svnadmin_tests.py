@@ -3801,6 +3801,84 @@ def dump_invalid_filtering_option(sbox):
                                           '--include', '/A/B/E',
                                           sbox.repo_dir)
 
+def build_log_index(sbox):
+  "build-log-index and log"
+
+  sbox.build()
+  wc_dir = sbox.wc_dir
+
+  # Some history with copies, deletions and replacements.
+  sbox.simple_copy('A/B', 'A/B2')
+  sbox.simple_commit(message='r2')
+  sbox.simple_append('A/B2/lambda', 'new line\n')
+  sbox.simple_commit(message='r3')
+  sbox.simple_rm('A/B/E')
+  sbox.simple_commit(message='r4')
+  sbox.simple_propset('prop', 'val', 'A/D')
+  sbox.simple_commit(message='r5')
+  sbox.simple_rm('A/B2')
+  sbox.simple_commit(message='r6')
+  svntest.actions.run_and_verify_svn(None, [], 'copy', '-m', 'r7',
+                                     sbox.repo_url + '/A/B2@5',
+                                     sbox.repo_url + '/A/B2')
+
+  targets = [ '', '/A', '/A/B', '/A/B2', '/A/B2/lambda', '/A/B2@5',
+              '/A/B2/lambda@3', '/A/D/G/pi', '/A/B/E@3' ]
+
+  def get_logs():
+    logs = []
+    for target in targets:
+      for args in [ ['-v'], ['-v', '--stop-on-copy'], ['-q', '-r2:HEAD'] ]:
+        exit_code, output, errput = svntest.main.run_svn(
+                                      None, 'log', sbox.repo_url + target,
+                                      *args)
+        logs.append(output)
+    return logs
+
+  expected_logs = get_logs()
+
+  expected_output = [ '* Indexed revision %d.\n' % rev for rev in range(8) ]
+  svntest.actions.run_and_verify_svnadmin(expected_output, [],
+                                          'build-log-index', sbox.repo_dir)
+  if get_logs() != expected_logs:
+    raise svntest.Failure("Log output differs with the log index")
+
+  # Commits keep the index up to date.
+  svntest.actions.run_and_verify_svn(None, [], 'rm', '-m', 'r8',
+                                     sbox.repo_url + '/A/B2/lambda')
+  svntest.actions.run_and_verify_svnadmin([], [],
+                                          'build-log-index', sbox.repo_dir)
+  exit_code, output, errput = svntest.main.run_svn(None, 'log', '-q',
+                                                   sbox.repo_url
+                                                   + '/A/B2/lambda@7')
+  expected_output = svntest.verify.RegexListOutput([
+      '-+', 'r7 .*', '-+', 'r3 .*', '-+', 'r2 .*', '-+', 'r1 .*', '-+' ])
+  svntest.verify.verify_outputs(None, output, errput, expected_output, [])
+
+  # Commits catch up with a revision the index missed.
+  index_path = os.path.join(sbox.repo_dir, 'db', 'log-index.db')
+  os.rename(index_path, index_path + '.moved')
+  svntest.actions.run_and_verify_svn(None, [], 'mkdir', '-m', 'r9',
+                                     sbox.repo_url + '/X')
+  os.rename(index_path + '.moved', index_path)
+  svntest.actions.run_and_verify_svn(None, [], 'mkdir', '-m', 'r10',
+                                     sbox.repo_url + '/Y')
+  svntest.actions.run_and_verify_svnadmin([], [],
+                                          'build-log-index', sbox.repo_dir)
+
+  # But not with many of them.
+  os.rename(index_path, index_path + '.moved')
+  for rev in range(11, 28):
+    svntest.actions.run_and_verify_svn(None, [], 'mkdir', '-m', 'r%d' % rev,
+                                       sbox.repo_url + '/Z%d' % rev)
+  os.rename(index_path + '.moved', index_path)
+  svntest.actions.run_and_verify_svn(None, [], 'mkdir', '-m', 'r28',
+                                     sbox.repo_url + '/Z28')
+  expected_output = [ '* Indexed revision %d.\n' % rev
+                      for rev in range(11, 29) ]
+  svntest.actions.run_and_verify_svnadmin(expected_output, [],
+                                          'build-log-index', sbox.repo_dir)
+
 ########################################################################
 # Run the tests
 
@@ -3873,7 +3951,8 @@ test_list = [ None,
               dump_exclude_by_pattern,
               dump_include_by_pattern,
               dump_exclude_all_rev_changes,
-              dump_invalid_filtering_option
+              dump_invalid_filtering_option,
+              build_log_index
              ]
 
 if __name__ == '__main__':
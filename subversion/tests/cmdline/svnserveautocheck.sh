@@ -31,6 +31,9 @@
 # distribution; it's easiest to just run it as "make svnserveautocheck".
 # Like "make check", you can specify further options like
 # "make svnserveautocheck FS_TYPE=bdb TESTS=subversion/tests/cmdline/basic.py".
+#
+# Set THREADED or MULTIPLEX to run svnserve with -T or --multiplex,
+# respectively, e.g. "make svnserveautocheck MULTIPLEX=1".
 
 PYTHON=${PYTHON:-python}
 
@@ -116,7 +119,9 @@ while \
   SVNSERVE_PORT=$(random_port)
 done
 
-if [ "$THREADED" != "" ]; then
+if [ "$MULTIPLEX" != "" ]; then
+  SVNSERVE_ARGS="--multiplex"
+elif [ "$THREADED" != "" ]; then
   SVNSERVE_ARGS="-T"
 fi
 
@@ -6855,6 +6855,68 @@ def update_add_missing_local_add(sbox):
   
   sbox.simple_update()
 
+def update_with_http_options(sbox, *options):
+  """Check out and update the greek tree from SBOX's repository in
+  skelta mode, passing OPTIONS as extra 'servers' options."""
+
+  sbox.build()
+  wc_dir = sbox.wc_dir
+  args = ['--config-option=servers:global:http-bulk-updates=no']
+  args += ['--config-option=servers:global:' + o for o in options]
+
+  # Small changes and a file too big to be buffered for decoding.
+  big_contents = 'This is the file \'big\'.\n' * 50000
+  sbox.simple_append('A/mu', 'More text for mu.\n')
+  sbox.simple_append('A/D/G/rho', 'More text for rho.\n')
+  sbox.simple_add_text(big_contents, 'A/B/big')
+  sbox.simple_rm('A/D/H/psi')
+  sbox.simple_commit()
+  sbox.simple_update(revision=1)
+
+  expected_output = svntest.wc.State(wc_dir, {
+    'A/mu'      : Item(status='U '),
+    'A/D/G/rho' : Item(status='U '),
+    'A/B/big'   : Item(status='A '),
+    'A/D/H/psi' : Item(status='D '),
+    })
+  expected_disk = svntest.main.greek_state.copy()
+  expected_disk.tweak('A/mu',
+                      contents=expected_disk.desc['A/mu'].contents
+                               + 'More text for mu.\n')
+  expected_disk.tweak('A/D/G/rho',
+                      contents=expected_disk.desc['A/D/G/rho'].contents
+                               + 'More text for rho.\n')
+  expected_disk.add({'A/B/big' : Item(contents=big_contents)})
+  expected_disk.remove('A/D/H/psi')
+  expected_status = svntest.actions.get_virginal_state(wc_dir, 2)
+  expected_status.add({'A/B/big' : Item(status='  ', wc_rev=2)})
+  expected_status.remove('A/D/H/psi')
+  svntest.actions.run_and_verify_update(wc_dir, expected_output,
+                                        expected_disk, expected_status,
+                                        [], False, wc_dir, *args)
+
+  # A checkout has no delta bases at all.
+  other_wc = sbox.add_wc_path('other')
+  expected_output = expected_disk.copy()
+  expected_output.wc_dir = other_wc
+  expected_output.tweak(status='A ', contents=None)
+  svntest.actions.run_and_verify_checkout(sbox.repo_url, other_wc,
+                                          expected_output, expected_disk,
+                                          [], *args)
+
+@SkipUnless(svntest.main.is_ra_type_dav)
+def update_http_decode_threads(sbox):
+  "update with http-decode-threads"
+
+  update_with_http_options(sbox, 'http-decode-threads=4')
+
+@SkipUnless(svntest.main.is_ra_type_dav)
+def update_http_adaptive_connections(sbox):
+  "update with http-adaptive-connections"
+
+  update_with_http_options(sbox, 'http-adaptive-connections=yes',
+                           'http-max-connections=2')
+
 #######################################################################
 # Run the tests
 
@@ -6946,6 +7008,8 @@ test_list = [ None,
               missing_tmp_update,
               update_delete_switched,
               update_add_missing_local_add,
+              update_http_decode_threads,
+              update_http_adaptive_connections,
              ]
 
 if __name__ == '__main__':
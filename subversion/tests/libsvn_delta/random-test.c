@@ -36,6 +36,7 @@
 #include "svn_delta.h"
 #include "svn_pools.h"
 #include "svn_error.h"
+#include "private/svn_subr_private.h"
 
 #include "../../libsvn_delta/delta.h"
 #include "delta-window-test.h"
@@ -48,6 +49,9 @@
 #define SEEDS 50
 #define MAXSEQ 100
 
+/* Number of svndiff versions to cycle through.  svndiff3 requires zstd. */
+#define SVNDIFF_VERSIONS (svn_zstd__is_available() ? 4 : 3)
+
 
 /* Initialize parameters for the random tests. */
 extern int test_argc;
@@ -330,8 +334,8 @@ do_random_test(apr_pool_t *pool,
 
       /* Make stage 2: encode the text delta in svndiff format using
                        varying svndiff versions and compression levels. */
-      svn_txdelta_to_svndiff3(&handler, &handler_baton, stream, i % 3,
-                              i % 10, delta_pool);
+      svn_txdelta_to_svndiff3(&handler, &handler_baton, stream,
+                              i % SVNDIFF_VERSIONS, i % 10, delta_pool);
 
       /* Make stage 1: create the text delta.  */
       svn_txdelta2(&txdelta_stream,
@@ -426,8 +430,8 @@ do_random_combine_test(apr_pool_t *pool,
 
       /* Make stage 2: encode the text delta in svndiff format using
                        varying svndiff versions and compression levels. */
-      svn_txdelta_to_svndiff3(&handler, &handler_baton, stream, i % 3,
-                              i % 10, delta_pool);
+      svn_txdelta_to_svndiff3(&handler, &handler_baton, stream,
+                              i % SVNDIFF_VERSIONS, i % 10, delta_pool);
 
       /* Make stage 1: create the text deltas.  */
 
@@ -569,8 +573,9 @@ do_random_txdelta_to_svndiff_stream_test(apr_pool_t *pool,
                    svn_stream_from_aprfile2(source, TRUE, iterpool),
                    svn_stream_from_aprfile2(target, TRUE, iterpool),
                    FALSE, iterpool);
-      delta_stream = svn_txdelta_to_svndiff_stream(txstream, i % 3, i % 10,
-                                                   iterpool);
+      delta_stream = svn_txdelta_to_svndiff_stream(txstream,
+                                                   i % SVNDIFF_VERSIONS,
+                                                   i % 10, iterpool);
 
       /* Apply it to a copy of the source file to see if we get the
          same target back. */
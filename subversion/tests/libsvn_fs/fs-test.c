@@ -6644,6 +6644,130 @@ test_delta_file_stream(const svn_test_opts_t *opts,
   return SVN_NO_ERROR;
 }
 
+/* Commit OLD_CONTENT and then NEW_CONTENT to file "foo" in the empty FS
+   as r1 and r2.  Use POOL for allocations. */
+static svn_error_t *
+commit_file_versions(svn_fs_t *fs,
+                     const char *old_content,
+                     const char *new_content,
+                     apr_pool_t *pool)
+{
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *txn_root;
+  svn_revnum_t rev;
+
+  /* Revision 1: create a file. */
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, 0, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  SVN_ERR(svn_fs_make_file(txn_root, "foo", pool));
+  SVN_ERR(svn_test__set_file_contents(txn_root, "foo", old_content, pool));
+  SVN_ERR(test_commit_txn(&rev, txn, NULL, pool));
+
+  /* Revision 2: modify the file. */
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, rev, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  SVN_ERR(svn_test__set_file_contents(txn_root, "foo", new_content, pool));
+  SVN_ERR(test_commit_txn(&rev, txn, NULL, pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Verify that svn_fs_get_file_delta_stream() turns OLD_CONTENT of "foo"
+   in r1 of FS into NEW_CONTENT in r2.  Use POOL for allocations. */
+static svn_error_t *
+check_delta_file_stream(svn_fs_t *fs,
+                        const char *old_content,
+                        const char *new_content,
+                        apr_pool_t *pool)
+{
+  svn_fs_root_t *root1, *root2;
+  svn_txdelta_window_handler_t delta_handler;
+  void *delta_baton;
+  svn_txdelta_stream_t *delta_stream;
+  svn_checksum_t *checksum;
+  svn_stringbuf_t *source = svn_stringbuf_create(old_content, pool);
+  svn_stringbuf_t *dest = svn_stringbuf_create_empty(pool);
+
+  SVN_ERR(svn_fs_revision_root(&root1, fs, 1, pool));
+  SVN_ERR(svn_fs_revision_root(&root2, fs, 2, pool));
+
+  SVN_ERR(svn_fs_get_file_delta_stream(&delta_stream,
+                                       root1, "foo", root2, "foo",
+                                       pool));
+
+  svn_txdelta_apply(svn_stream_from_stringbuf(source, pool),
+                    svn_stream_from_stringbuf(dest, pool),
+                    NULL, NULL, pool, &delta_handler, &delta_baton);
+  SVN_ERR(svn_txdelta_send_txstream(delta_stream,
+                                    delta_handler,
+                                    delta_baton,
+                                    pool));
+  SVN_TEST_STRING_ASSERT(new_content, dest->data);
+
+  SVN_ERR(svn_fs_file_checksum(&checksum, svn_checksum_md5, root2, "foo",
+                               TRUE, pool));
+  SVN_TEST_ASSERT(memcmp(svn_txdelta_md5_digest(delta_stream),
+                         checksum->digest, APR_MD5_DIGESTSIZE) == 0);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_delta_file_stream_cached(const svn_test_opts_t *opts,
+                              apr_pool_t *pool)
+{
+  const char *repo_name = "test-repo-delta-file-stream-cached";
+  svn_fs_t *fs;
+  apr_hash_t *fs_config = apr_hash_make(pool);
+  svn_cache__info_t *info;
+  apr_uint64_t hits = 0;
+  const char *uuid;
+  const char *old_content = "some content";
+  const char *new_content = "some more content";
+  int i;
+
+  /* Only filesystems with an instance ID use the cache. */
+  svn_boolean_t cached
+    = strcmp(opts->fs_type, SVN_FS_TYPE_BDB) != 0
+      && (!opts->server_minor_version || (opts->server_minor_version >= 9));
+
+  /* Create a new repo that caches the deltas computed for it. */
+  svn_hash_sets(fs_config, SVN_FS_CONFIG_CACHE_FILE_DELTAS, "1");
+  SVN_ERR(svn_test__create_fs2(&fs, repo_name, opts, fs_config, pool));
+  SVN_ERR(svn_fs_get_uuid(fs, &uuid, pool));
+  SVN_ERR(commit_file_versions(fs, old_content, new_content, pool));
+
+  SVN_ERR(svn_fs__get_file_delta_cache_info(&info, FALSE, pool));
+  if (info)
+    hits = info->hits;
+
+  /* The first run fills the cache, the second one reads from it.
+     Both must produce the same, correct result. */
+  for (i = 0; i < 2; i++)
+    {
+      apr_pool_t *iterpool = svn_pool_create(pool);
+      SVN_ERR(check_delta_file_stream(fs, old_content, new_content,
+                                      iterpool));
+      svn_pool_destroy(iterpool);
+    }
+
+  SVN_ERR(svn_fs__get_file_delta_cache_info(&info, FALSE, pool));
+  if (info && cached)
+    SVN_TEST_ASSERT(info->hits > hits);
+
+  /* A new repository with the same UUID and path, e.g. after a dump /
+     load cycle, reuses the node IDs for different contents.  Its deltas
+     must not come from the cache. */
+  SVN_ERR(svn_test__create_fs2(&fs, repo_name, opts, fs_config, pool));
+  SVN_ERR(svn_fs_set_uuid(fs, uuid, pool));
+  SVN_ERR(commit_file_versions(fs, "other content", "other more content",
+                               pool));
+  SVN_ERR(check_delta_file_stream(fs, "other content",
+                                  "other more content", pool));
+
+  return SVN_NO_ERROR;
+}
+
 static svn_error_t *
 test_fs_merge(const svn_test_opts_t *opts,
               apr_pool_t *pool)
@@ -7487,6 +7611,8 @@ static struct svn_test_descriptor_t test_funcs[] =
                        "get configuration files"),
     SVN_TEST_OPTS_PASS(test_delta_file_stream,
                        "get a delta stream on a file"),
+    SVN_TEST_OPTS_PASS(test_delta_file_stream_cached,
+                       "get a delta stream on a file from the cache"),
     SVN_TEST_OPTS_PASS(test_fs_merge,
                        "get merging txns with newer revisions"),
     SVN_TEST_OPTS_PASS(test_fsfs_config_opts,
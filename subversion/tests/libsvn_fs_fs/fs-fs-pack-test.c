@@ -30,13 +30,17 @@
 #include "../../libsvn_fs_fs/fs_fs.h"
 #include "../../libsvn_fs_fs/low_level.h"
 #include "../../libsvn_fs_fs/pack.h"
+#include "../../libsvn_fs_fs/rep-cache.h"
 #include "../../libsvn_fs_fs/util.h"
 
 #include "svn_hash.h"
 #include "svn_pools.h"
 #include "svn_props.h"
 #include "svn_fs.h"
+#include "private/svn_fs_private.h"
+#include "private/svn_sqlite.h"
 #include "private/svn_string_private.h"
+#include "private/svn_subr_private.h"
 
 #include "../svn_test_fs.h"
 
@@ -190,7 +194,7 @@ create_packed_filesystem(const char *dir,
   /* Now pack the FS */
   pnb.expected_shard = 0;
   pnb.expected_action = svn_fs_pack_notify_start;
-  return svn_fs_pack(dir, pack_notify, &pnb, NULL, NULL, pool);
+  return svn_fs_pack2(dir, NULL, pack_notify, &pnb, NULL, NULL, pool);
 }
 
 /* Create a packed FSFS filesystem for revprop tests at REPO_NAME with
@@ -225,7 +229,7 @@ prepare_revprop_repo(svn_fs_t **fs,
   svn_pool_destroy(subpool);
 
   /* Pack the repository. */
-  SVN_ERR(svn_fs_pack(repo_name, NULL, NULL, NULL, NULL, pool));
+  SVN_ERR(svn_fs_pack2(repo_name, NULL, NULL, NULL, NULL, NULL, pool));
 
   return SVN_NO_ERROR;
 }
@@ -662,7 +666,7 @@ recover_fully_packed(const svn_test_opts_t *opts,
   SVN_ERR(svn_fs_commit_txn(&conflict, &after_rev, txn, subpool));
   SVN_TEST_ASSERT(SVN_IS_VALID_REVNUM(after_rev));
   svn_pool_destroy(subpool);
-  SVN_ERR(svn_fs_pack(REPO_NAME, NULL, NULL, NULL, NULL, pool));
+  SVN_ERR(svn_fs_pack2(REPO_NAME, NULL, NULL, NULL, NULL, NULL, pool));
   SVN_ERR(svn_fs_recover(REPO_NAME, NULL, NULL, pool));
 
   /* Now, delete the youngest revprop file, and recover again.  This
@@ -1001,7 +1005,7 @@ upgrade_txns_to_log_addressing(const svn_test_opts_t *opts,
   /* Pack repo to verify that old and new shard get packed according to
      their respective addressing mode */
 
-  SVN_ERR(svn_fs_pack(repo_name, NULL, NULL, NULL, NULL, pool));
+  SVN_ERR(svn_fs_pack2(repo_name, NULL, NULL, NULL, NULL, NULL, pool));
 
   /* verify that our changes got in */
 
@@ -1887,6 +1891,419 @@ large_delta_against_plain(const svn_test_opts_t *opts,
 
 #undef REPO_NAME
 
+/* ------------------------------------------------------------------------ */
+
+#define REPO_NAME "test-repo-plain_file_contents_range"
+
+static svn_error_t *
+plain_file_contents_range(const svn_test_opts_t *opts,
+                          apr_pool_t *pool)
+{
+  svn_fs_t *fs;
+  fs_fs_data_t *ffd;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *root;
+  svn_revnum_t rev;
+  apr_file_t *file;
+  apr_off_t offset;
+  svn_filesize_t length;
+  const char *contents = "This is the file 'plain'.\n";
+  char *buffer;
+  svn_stringbuf_t *read_contents;
+
+  if (strcmp(opts->fs_type, "fsfs") != 0)
+    return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL, NULL);
+
+  SVN_ERR(svn_test__create_fs(&fs, REPO_NAME, opts, pool));
+  ffd = fs->fsap_data;
+
+  /* Old formats don't support compression at all. */
+  if (ffd->delta_compression_type == compression_type_none)
+    return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL, NULL);
+
+  /* Revision 1: one compressed and one uncompressed file. */
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, 0, pool));
+  SVN_ERR(svn_fs_txn_root(&root, txn, pool));
+  SVN_ERR(svn_fs_make_file(root, "/delta", pool));
+  SVN_ERR(svn_test__set_file_contents(root, "/delta", "delta", pool));
+
+  /* Deltified contents are not available as a plain byte range. */
+  SVN_ERR(svn_fs__file_contents_range(&file, &offset, &length, root,
+                                      "/delta", pool, pool));
+  SVN_TEST_ASSERT(file == NULL);
+
+  /* Not compressing by default, like old formats do, is not enough. */
+  ffd->delta_compression_type = compression_type_none;
+  SVN_ERR(svn_fs_make_file(root, "/self-delta", pool));
+  SVN_ERR(svn_test__set_file_contents(root, "/self-delta",
+                                      "This is the file 'self-delta'.\n",
+                                      pool));
+
+  /* Only an explicit "compression = none" makes it store PLAIN reps. */
+  ffd->store_plain_fulltexts = TRUE;
+  SVN_ERR(svn_fs_make_file(root, "/plain", pool));
+  SVN_ERR(svn_test__set_file_contents(root, "/plain", contents, pool));
+
+  /* Neither is anything in a transaction. */
+  SVN_ERR(svn_fs__file_contents_range(&file, &offset, &length, root,
+                                      "/plain", pool, pool));
+  SVN_TEST_ASSERT(file == NULL);
+  SVN_ERR(svn_fs_commit_txn(NULL, &rev, txn, pool));
+
+  SVN_ERR(svn_fs_revision_root(&root, fs, rev, pool));
+  SVN_ERR(svn_fs__file_contents_range(&file, &offset, &length, root,
+                                      "/delta", pool, pool));
+  SVN_TEST_ASSERT(file == NULL);
+  SVN_ERR(svn_fs__file_contents_range(&file, &offset, &length, root,
+                                      "/self-delta", pool, pool));
+  SVN_TEST_ASSERT(file == NULL);
+
+  /* The PLAIN rep can be read directly from the rev file. */
+  SVN_ERR(svn_fs__file_contents_range(&file, &offset, &length, root,
+                                      "/plain", pool, pool));
+  SVN_TEST_ASSERT(file != NULL);
+  SVN_TEST_ASSERT(length == strlen(contents));
+
+  buffer = apr_pcalloc(pool, (apr_size_t)length + 1);
+  SVN_ERR(svn_io_file_seek(file, APR_SET, &offset, pool));
+  SVN_ERR(svn_io_file_read_full2(file, buffer, (apr_size_t)length, NULL,
+                                 NULL, pool));
+  SVN_TEST_STRING_ASSERT(buffer, contents);
+
+  /* Regular reads must work as well. */
+  SVN_ERR(svn_test__get_file_contents(root, "/plain", &read_contents, pool));
+  SVN_TEST_STRING_ASSERT(read_contents->data, contents);
+
+  return SVN_NO_ERROR;
+}
+
+#undef REPO_NAME
+
+/* ------------------------------------------------------------------------ */
+
+#define REPO_NAME "test-repo-batched_rep_cache"
+
+/* Implements svn_fs_fs__walk_rep_reference().walker.
+   Count the entries in the apr_int64_t at BATON. */
+static svn_error_t *
+count_rep_cache_entries(representation_t *rep,
+                        void *baton,
+                        svn_fs_t *fs,
+                        apr_pool_t *scratch_pool)
+{
+  apr_int64_t *count = baton;
+  ++*count;
+
+  return SVN_NO_ERROR;
+}
+
+/* Set *REP to a copy of MODEL, allocated in POOL, but with the SHA1
+   checksum of CONTENTS. */
+static svn_error_t *
+rep_with_contents(representation_t **rep,
+                  const representation_t *model,
+                  const char *contents,
+                  apr_pool_t *pool)
+{
+  svn_checksum_t *checksum;
+
+  SVN_ERR(svn_checksum(&checksum, svn_checksum_sha1, contents,
+                       strlen(contents), pool));
+
+  *rep = apr_pmemdup(pool, model, sizeof(**rep));
+  memcpy((*rep)->sha1_digest, checksum->digest, sizeof((*rep)->sha1_digest));
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+batched_rep_cache(const svn_test_opts_t *opts,
+                  apr_pool_t *pool)
+{
+  svn_fs_t *fs;
+  fs_fs_data_t *ffd;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *root;
+  svn_revnum_t rev;
+  apr_array_header_t *checksums;
+  apr_array_header_t *reps;
+  apr_hash_t *found;
+  apr_hash_index_t *hi;
+  apr_int64_t count = 0;
+  svn_checksum_t *checksum;
+  representation_t *model;
+  representation_t *rep;
+  svn_sqlite__db_t *sdb;
+  const char *statements[3];
+  int i;
+
+  if (strcmp(opts->fs_type, "fsfs") != 0)
+    return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL, NULL);
+
+  SVN_ERR(svn_test__create_fs(&fs, REPO_NAME, opts, pool));
+
+  ffd = fs->fsap_data;
+  if (ffd->format < SVN_FS_FS__MIN_REP_SHARING_FORMAT)
+    return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL, NULL);
+
+  ffd->rep_sharing_allowed = TRUE;
+
+  /* Revision 1: 40 files with 35 different contents.  That is more than
+     two full batches plus some remainder. */
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, 0, pool));
+  SVN_ERR(svn_fs_txn_root(&root, txn, pool));
+  checksums = apr_array_make(pool, 36, sizeof(svn_checksum_t *));
+  for (i = 0; i < 40; i++)
+    {
+      const char *path = apr_psprintf(pool, "file%d", i);
+      const char *contents = apr_psprintf(pool, "This is file %d.\n",
+                                          i % 35);
+
+      SVN_ERR(svn_fs_make_file(root, path, pool));
+      SVN_ERR(svn_test__set_file_contents(root, path, contents, pool));
+
+      if (i < 35)
+        {
+          SVN_ERR(svn_checksum(&checksum, svn_checksum_sha1, contents,
+                               strlen(contents), pool));
+          APR_ARRAY_PUSH(checksums, svn_checksum_t *) = checksum;
+        }
+    }
+  SVN_ERR(svn_fs_commit_txn(NULL, &rev, txn, pool));
+
+  /* Every content is in the rep-cache exactly once. */
+  SVN_ERR(svn_fs_fs__walk_rep_reference(fs, 0, rev, count_rep_cache_entries,
+                                        &count, NULL, NULL, pool));
+  SVN_TEST_ASSERT(count == 35);
+
+  /* Look them up at once, plus one that is not in the cache. */
+  SVN_ERR(svn_checksum(&checksum, svn_checksum_sha1, "none", 4, pool));
+  APR_ARRAY_PUSH(checksums, svn_checksum_t *) = checksum;
+
+  SVN_ERR(svn_fs_fs__get_rep_references(&found, fs, checksums, pool, pool));
+  SVN_TEST_ASSERT(apr_hash_count(found) == 35);
+  SVN_TEST_ASSERT(!apr_hash_get(found, checksum->digest,
+                                APR_SHA1_DIGESTSIZE));
+
+  /* Adding existing entries again is a no-op. */
+  reps = apr_array_make(pool, 35, sizeof(representation_t *));
+  for (hi = apr_hash_first(pool, found); hi; hi = apr_hash_next(hi))
+    {
+      representation_t *rep = apr_hash_this_val(hi);
+
+      SVN_TEST_ASSERT(rep->revision == rev);
+      APR_ARRAY_PUSH(reps, representation_t *) = rep;
+    }
+
+  SVN_ERR(svn_fs_fs__set_rep_references(fs, reps, pool));
+
+  count = 0;
+  SVN_ERR(svn_fs_fs__walk_rep_reference(fs, 0, rev, count_rep_cache_entries,
+                                        &count, NULL, NULL, pool));
+  SVN_TEST_ASSERT(count == 35);
+
+  /* Along with the existing entries, add 20 new ones, i.e. more than a
+     full batch, each of them twice.  Only the new ones get added and
+     each of them only once. */
+  model = APR_ARRAY_IDX(reps, 0, representation_t *);
+  for (i = 0; i < 40; i++)
+    {
+      SVN_ERR(rep_with_contents(&rep, model,
+                                apr_psprintf(pool, "new %d", i % 20), pool));
+      APR_ARRAY_PUSH(reps, representation_t *) = rep;
+    }
+
+  SVN_ERR(svn_fs_fs__set_rep_references(fs, reps, pool));
+
+  count = 0;
+  SVN_ERR(svn_fs_fs__walk_rep_reference(fs, 0, rev, count_rep_cache_entries,
+                                        &count, NULL, NULL, pool));
+  SVN_TEST_ASSERT(count == 55);
+
+  /* Add a full batch of new entries while someone else adds one of them
+     between our lookup and our insert.  We simulate that with a trigger
+     that inserts the 6th entry as soon as the first one gets inserted.
+     The batch insert then fails with a constraint violation and we must
+     fall back to inserting the entries one-by-one. */
+  apr_array_clear(reps);
+  checksums = apr_array_make(pool, 16, sizeof(svn_checksum_t *));
+  for (i = 0; i < 16; i++)
+    {
+      SVN_ERR(rep_with_contents(&rep, model,
+                                apr_psprintf(pool, "racing %d", i), pool));
+      APR_ARRAY_PUSH(reps, representation_t *) = rep;
+      APR_ARRAY_PUSH(checksums, svn_checksum_t *)
+        = svn_checksum__from_digest_sha1(rep->sha1_digest, pool);
+    }
+
+  statements[0] = apr_psprintf(pool,
+                    "CREATE TRIGGER race AFTER INSERT ON rep_cache "
+                    "WHEN NEW.hash = '%s' "
+                    "BEGIN "
+                    "  INSERT INTO rep_cache (hash, revision, offset, size, "
+                    "                         expanded_size) "
+                    "  VALUES ('%s', NEW.revision, NEW.offset, NEW.size, "
+                    "          NEW.expanded_size); "
+                    "END;",
+                    svn_checksum_to_cstring(APR_ARRAY_IDX(checksums, 0,
+                                                          svn_checksum_t *),
+                                            pool),
+                    svn_checksum_to_cstring(APR_ARRAY_IDX(checksums, 5,
+                                                          svn_checksum_t *),
+                                            pool));
+  statements[1] = "DROP TRIGGER race;";
+  statements[2] = NULL;
+
+  SVN_ERR(svn_sqlite__open(&sdb,
+                           svn_dirent_join(fs->path, REP_CACHE_DB_NAME,
+                                           pool),
+                           svn_sqlite__mode_readwrite, statements, 0, NULL,
+                           0, pool, pool));
+  SVN_ERR(svn_sqlite__exec_statements(sdb, 0));
+
+  SVN_ERR(svn_fs_fs__set_rep_references(fs, reps, pool));
+
+  SVN_ERR(svn_sqlite__exec_statements(sdb, 1));
+  SVN_ERR(svn_sqlite__close(sdb));
+
+  SVN_ERR(svn_fs_fs__get_rep_references(&found, fs, checksums, pool, pool));
+  SVN_TEST_ASSERT(apr_hash_count(found) == 16);
+
+  count = 0;
+  SVN_ERR(svn_fs_fs__walk_rep_reference(fs, 0, rev, count_rep_cache_entries,
+                                        &count, NULL, NULL, pool));
+  SVN_TEST_ASSERT(count == 71);
+
+  return SVN_NO_ERROR;
+}
+
+#undef REPO_NAME
+
+/* ------------------------------------------------------------------------ */
+
+#define REPO_NAME "test-repo-commit_many_files_performance"
+
+/* Print the latency of commits that add an increasing number of files,
+   i.e. that add the same number of entries to the rep-cache. */
+static svn_error_t *
+commit_many_files_performance(const svn_test_opts_t *opts,
+                              apr_pool_t *pool)
+{
+  const int file_counts[] = { 1000, 5000, 20000, 50000 };
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  int n;
+
+  if (strcmp(opts->fs_type, "fsfs") != 0)
+    return svn_error_create(SVN_ERR_TEST_SKIPPED, NULL, NULL);
+
+  for (n = 0; n < sizeof(file_counts) / sizeof(file_counts[0]); n++)
+    {
+      svn_fs_t *fs;
+      svn_fs_txn_t *txn;
+      svn_fs_root_t *root;
+      svn_revnum_t rev;
+      apr_time_t start;
+      int i;
+
+      svn_pool_clear(iterpool);
+
+      SVN_ERR(svn_test__create_fs(&fs,
+                                  apr_psprintf(iterpool, "%s-%d", REPO_NAME,
+                                               file_counts[n]),
+                                  opts, iterpool));
+
+      /* A vendor drop: many new files with distinct contents. */
+      SVN_ERR(svn_fs_begin_txn(&txn, fs, 0, iterpool));
+      SVN_ERR(svn_fs_txn_root(&root, txn, iterpool));
+      for (i = 0; i < file_counts[n]; i++)
+        {
+          const char *path;
+
+          if (i % 100 == 0)
+            SVN_ERR(svn_fs_make_dir(root, apr_psprintf(iterpool, "dir%d",
+                                                       i / 100),
+                                    iterpool));
+
+          path = apr_psprintf(iterpool, "dir%d/file%d", i / 100, i);
+          SVN_ERR(svn_fs_make_file(root, path, iterpool));
+          SVN_ERR(svn_test__set_file_contents(root, path,
+                                              apr_psprintf(iterpool,
+                                                           "This is file %d.\n",
+                                                           i),
+                                              iterpool));
+        }
+
+      start = apr_time_now();
+      SVN_ERR(svn_fs_commit_txn(NULL, &rev, txn, iterpool));
+      printf("%6d files: %"APR_TIME_T_FMT" musecs to commit\n",
+             file_counts[n], apr_time_now() - start);
+    }
+
+  svn_pool_destroy(iterpool);
+  return SVN_NO_ERROR;
+}
+
+#undef REPO_NAME
+
+/* ------------------------------------------------------------------------ */
+#define REPO_NAME "test-repo-pack-concurrently"
+#define SHARD_SIZE 5
+#define MAX_REV 53
+static svn_error_t *
+pack_concurrently(const svn_test_opts_t *opts,
+                  apr_pool_t *pool)
+{
+  struct pack_notify_baton pnb;
+  apr_hash_t *fs_config;
+  svn_fs_t *fs;
+  svn_revnum_t i;
+  apr_pool_t *iterpool;
+
+  SVN_ERR(create_non_packed_filesystem(REPO_NAME, opts, MAX_REV, SHARD_SIZE,
+                                       pool));
+
+  /* Pack all 10 shards using 4 threads.  Notifications must still come
+   * in start / end pairs in shard order, like for a sequential pack. */
+  fs_config = apr_hash_make(pool);
+  svn_hash_sets(fs_config, SVN_FS_CONFIG_FSFS_PACK_THREADS, "4");
+
+  pnb.expected_shard = 0;
+  pnb.expected_action = svn_fs_pack_notify_start;
+  SVN_ERR(svn_fs_pack2(REPO_NAME, fs_config, pack_notify, &pnb,
+                       NULL, NULL, pool));
+  SVN_TEST_ASSERT(pnb.expected_shard == (MAX_REV + 1) / SHARD_SIZE);
+
+  /* Read all contents back from the packed repository. */
+  SVN_ERR(svn_fs_open2(&fs, REPO_NAME, NULL, pool, pool));
+  iterpool = svn_pool_create(pool);
+  for (i = 1; i < (MAX_REV + 1); i++)
+    {
+      svn_fs_root_t *rev_root;
+      svn_stream_t *rstream;
+      svn_stringbuf_t *rstring;
+      const char *expected;
+
+      svn_pool_clear(iterpool);
+
+      SVN_ERR(svn_fs_revision_root(&rev_root, fs, i, iterpool));
+      SVN_ERR(svn_fs_file_contents(&rstream, rev_root, "iota", iterpool));
+      SVN_ERR(svn_test__stream_to_string(&rstring, rstream, iterpool));
+
+      expected = (i == 1) ? "This is the file 'iota'.\n"
+                          : get_rev_contents(i, iterpool);
+      SVN_TEST_STRING_ASSERT(rstring->data, expected);
+    }
+  svn_pool_destroy(iterpool);
+
+  SVN_ERR(svn_fs_verify(REPO_NAME, NULL, 0, MAX_REV, NULL, NULL, NULL, NULL,
+                        pool));
+
+  return SVN_NO_ERROR;
+}
+#undef REPO_NAME
+#undef SHARD_SIZE
+#undef MAX_REV
+
 
 
 /* The test table.  */
@@ -1942,6 +2359,14 @@ static struct svn_test_descriptor_t test_funcs[] =
                        "pack with limited memory for metadata"),
     SVN_TEST_OPTS_PASS(large_delta_against_plain,
                        "large deltas against PLAIN, issue #4658"),
+    SVN_TEST_OPTS_PASS(pack_concurrently,
+                       "pack multiple shards concurrently"),
+    SVN_TEST_OPTS_PASS(plain_file_contents_range,
+                       "plain file contents as byte range"),
+    SVN_TEST_OPTS_PASS(batched_rep_cache,
+                       "batched rep-cache lookups and inserts"),
+    SVN_TEST_OPTS_SKIP(commit_many_files_performance, TRUE,
+                       "optional commit latency vs. file count test"),
     SVN_TEST_NULL
   };
 
@@ -36,6 +36,10 @@
 #include "svn_cmdline.h"
 #include "svn_dirent_uri.h"
 #include "svn_hash.h"
+#include "svn_props.h"
+#include "svn_ra_svn.h"
+#include "svn_sorts.h"
+#include "private/svn_ra_svn_private.h"
 
 #include "../svn_test.h"
 #include "../svn_test_fs.h"
@@ -260,6 +264,87 @@ close_tunnel(void *tunnel_context, void *tunnel_baton)
     }
 }
 
+/* Open *SESSION to the existing repository named REPOS_NAME over the
+   svn+test:// tunnel, i.e. through ra_svn and svnserve. */
+static svn_error_t *
+open_tunnel_session(svn_ra_session_t **session,
+                    const char *repos_name,
+                    apr_pool_t *pool)
+{
+  tunnel_baton_t *b = apr_pcalloc(pool, sizeof(*b));
+  const char *url;
+  svn_ra_callbacks2_t *cbtable;
+
+  b->magic = TUNNEL_MAGIC;
+
+  url = apr_pstrcat(pool, "svn+test://localhost/", repos_name, SVN_VA_NULL);
+  SVN_ERR(svn_ra_create_callbacks(&cbtable, pool));
+  cbtable->check_tunnel_func = check_tunnel;
+  cbtable->open_tunnel_func = open_tunnel;
+  cbtable->tunnel_baton = b;
+  SVN_ERR(svn_cmdline_create_auth_baton2(&cbtable->auth_baton,
+                                         TRUE  /* non_interactive */,
+                                         "jrandom", "rayjandom",
+                                         NULL,
+                                         TRUE  /* no_auth_cache */,
+                                         FALSE /* trust_server_cert */,
+                                         FALSE, FALSE, FALSE, FALSE,
+                                         NULL, NULL, NULL, pool));
+
+  SVN_ERR(svn_ra_open4(session, NULL, url, NULL, cbtable, NULL, NULL, pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Create a repository named REPOS_NAME and open *SESSION to it over the
+   svn+test:// tunnel, i.e. through ra_svn and svnserve. */
+static svn_error_t *
+make_and_open_tunnel_repos(svn_ra_session_t **session,
+                           const char *repos_name,
+                           const svn_test_opts_t *opts,
+                           apr_pool_t *pool)
+{
+  apr_pool_t *scratch_pool = svn_pool_create(pool);
+
+  SVN_ERR(svn_test__create_repos(NULL, repos_name, opts, scratch_pool));
+
+  /* Immediately close the repository to avoid race condition with svnserve
+     (and then the cleanup code) with BDB when our pool is cleared. */
+  svn_pool_destroy(scratch_pool);
+
+  return svn_error_trace(open_tunnel_session(session, repos_name, pool));
+}
+
+/* Commit COUNT new empty directories "d0" ... to the root of SESSION. */
+static svn_error_t *
+commit_many_dirs(svn_ra_session_t *session,
+                 int count,
+                 apr_pool_t *pool)
+{
+  apr_hash_t *revprop_table = apr_hash_make(pool);
+  const svn_delta_editor_t *editor;
+  void *edit_baton;
+  void *root_baton, *dir_baton;
+  int i;
+
+  SVN_ERR(svn_ra_get_commit_editor3(session, &editor, &edit_baton,
+                                    revprop_table,
+                                    NULL, NULL, NULL, TRUE, pool));
+
+  SVN_ERR(editor->open_root(edit_baton, SVN_INVALID_REVNUM,
+                            pool, &root_baton));
+  for (i = 0; i < count; i++)
+    {
+      SVN_ERR(editor->add_directory(apr_psprintf(pool, "d%d", i),
+                                    root_baton, NULL, SVN_INVALID_REVNUM,
+                                    pool, &dir_baton));
+      SVN_ERR(editor->close_directory(dir_baton, pool));
+    }
+  SVN_ERR(editor->close_directory(root_baton, pool));
+  SVN_ERR(editor->close_edit(edit_baton, pool));
+  return SVN_NO_ERROR;
+}
+
 
 
 
@@ -620,6 +705,349 @@ get_dir_test(const svn_test_opts_t *opts,
   return SVN_NO_ERROR;
 }
 
+/* Test svn_ra_get_dirs(). */
+static svn_error_t *
+get_dirs_test(const svn_test_opts_t *opts,
+              apr_pool_t *pool)
+{
+  svn_ra_session_t *session;
+  apr_array_header_t *paths = apr_array_make(pool, 3, sizeof(const char *));
+  apr_hash_t *dirents;
+  apr_hash_t *entries;
+  svn_dirent_t *ent;
+
+  SVN_ERR(make_and_open_repos(&session, "test-get-dirs", opts, pool));
+  SVN_ERR(commit_tree(session, pool));
+
+  APR_ARRAY_PUSH(paths, const char *) = "A";
+  APR_ARRAY_PUSH(paths, const char *) = "A/B";
+  APR_ARRAY_PUSH(paths, const char *) = "A/BB";
+  SVN_ERR(svn_ra_get_dirs(session, &dirents, paths, 1, SVN_DIRENT_KIND,
+                          pool, pool));
+  SVN_TEST_INT_ASSERT(apr_hash_count(dirents), 3);
+
+  entries = svn_hash_gets(dirents, "A");
+  SVN_TEST_ASSERT(entries);
+  SVN_TEST_INT_ASSERT(apr_hash_count(entries), 2);
+  ent = svn_hash_gets(entries, "BB");
+  SVN_TEST_ASSERT(ent);
+  SVN_TEST_ASSERT(ent->kind == svn_node_dir);
+
+  entries = svn_hash_gets(dirents, "A/BB");
+  SVN_TEST_ASSERT(entries);
+  SVN_TEST_INT_ASSERT(apr_hash_count(entries), 2);
+  ent = svn_hash_gets(entries, "g");
+  SVN_TEST_ASSERT(ent);
+  SVN_TEST_ASSERT(ent->kind == svn_node_file);
+
+  /* A failing directory must not leave the session out of sync. */
+  APR_ARRAY_PUSH(paths, const char *) = "non/existing/relpath";
+  APR_ARRAY_PUSH(paths, const char *) = "A/B";
+  SVN_TEST_ASSERT_ERROR(svn_ra_get_dirs(session, &dirents, paths, 1,
+                                        SVN_DIRENT_KIND, pool, pool),
+                        SVN_ERR_FS_NOT_FOUND);
+
+  SVN_ERR(svn_ra_get_dir2(session, &entries, NULL, NULL, "A/B", 1,
+                          SVN_DIRENT_KIND, pool));
+  SVN_TEST_INT_ASSERT(apr_hash_count(entries), 2);
+
+  return SVN_NO_ERROR;
+}
+
+/* Test svn_ra_get_dirs() over ra_svn, which pipelines the requests. */
+static svn_error_t *
+get_dirs_tunnel_test(const svn_test_opts_t *opts,
+                     apr_pool_t *pool)
+{
+  const char repos_name[] = "test-get-dirs-tunnel";
+  const char authz[] = "[/]\n"
+                       "* = r\n"
+                       "[/A/BB]\n"
+                       "* =\n"
+                       "$authenticated = r\n"
+                       "[/d7]\n"
+                       "* =\n";
+  svn_ra_session_t *session;
+  apr_array_header_t *paths = apr_array_make(pool, 0, sizeof(const char *));
+  apr_hash_t *dirents;
+  apr_hash_t *entries;
+  svn_revnum_t youngest;
+  const char *conf_dir;
+  int i;
+
+  SVN_ERR(make_and_open_tunnel_repos(&session, repos_name, opts, pool));
+  SVN_ERR(commit_tree(session, pool));
+
+  /* More directories than ra_svn keeps in flight at once. */
+  SVN_ERR(commit_many_dirs(session, 100, pool));
+
+  /* No paths at all.  The session must still be usable afterwards. */
+  SVN_ERR(svn_ra_get_dirs(session, &dirents, paths, 2, SVN_DIRENT_KIND,
+                          pool, pool));
+  SVN_TEST_INT_ASSERT(apr_hash_count(dirents), 0);
+  SVN_ERR(svn_ra_get_latest_revnum(session, &youngest, pool));
+  SVN_TEST_INT_ASSERT(youngest, 2);
+  SVN_ERR(svn_ra_get_dir2(session, &entries, NULL, NULL, "A", 2,
+                          SVN_DIRENT_KIND, pool));
+  SVN_TEST_INT_ASSERT(apr_hash_count(entries), 2);
+
+  /* A single path. */
+  APR_ARRAY_PUSH(paths, const char *) = "A/B";
+  SVN_ERR(svn_ra_get_dirs(session, &dirents, paths, 2, SVN_DIRENT_KIND,
+                          pool, pool));
+  SVN_TEST_INT_ASSERT(apr_hash_count(dirents), 1);
+  entries = svn_hash_gets(dirents, "A/B");
+  SVN_TEST_ASSERT(entries);
+  SVN_TEST_INT_ASSERT(apr_hash_count(entries), 2);
+
+  /* Many paths. */
+  APR_ARRAY_PUSH(paths, const char *) = "A";
+  APR_ARRAY_PUSH(paths, const char *) = "A/BB";
+  for (i = 0; i < 100; i++)
+    APR_ARRAY_PUSH(paths, const char *) = apr_psprintf(pool, "d%d", i);
+  SVN_ERR(svn_ra_get_dirs(session, &dirents, paths, 2, SVN_DIRENT_KIND,
+                          pool, pool));
+  SVN_TEST_INT_ASSERT(apr_hash_count(dirents), 103);
+  entries = svn_hash_gets(dirents, "d99");
+  SVN_TEST_ASSERT(entries);
+  SVN_TEST_INT_ASSERT(apr_hash_count(entries), 0);
+
+  /* An error part-way through the batch, after some requests have already
+     been answered and while others are still in flight. */
+  APR_ARRAY_IDX(paths, 50, const char *) = "non/existing/relpath";
+  SVN_TEST_ASSERT_ERROR(svn_ra_get_dirs(session, &dirents, paths, 2,
+                                        SVN_DIRENT_KIND, pool, pool),
+                        SVN_ERR_FS_NOT_FOUND);
+
+  /* The session must still be in sync. */
+  SVN_ERR(svn_ra_get_latest_revnum(session, &youngest, pool));
+  SVN_TEST_INT_ASSERT(youngest, 2);
+  APR_ARRAY_IDX(paths, 50, const char *) = "d47";
+  SVN_ERR(svn_ra_get_dirs(session, &dirents, paths, 2, SVN_DIRENT_KIND,
+                          pool, pool));
+  SVN_TEST_INT_ASSERT(apr_hash_count(dirents), 102);
+
+  /* Let only authenticated users read A/BB and nobody read d7. */
+  conf_dir = svn_dirent_join(repos_name, "conf", pool);
+  SVN_ERR(svn_io_write_atomic2(svn_dirent_join(conf_dir, "svnserve.conf",
+                                               pool),
+                               "[general]\n"
+                               "authz-db = authz\n",
+                               strlen("[general]\n"
+                                      "authz-db = authz\n"),
+                               NULL, FALSE, pool));
+  SVN_ERR(svn_io_write_atomic2(svn_dirent_join(conf_dir, "authz", pool),
+                               authz, strlen(authz), NULL, FALSE, pool));
+
+  /* A new, anonymous session cannot authenticate within the pipeline.
+     So, svnserve rejects A/BB there and ra_svn must retry it on its own,
+     authenticating as the tunnel user.  The retry of d7 fails again. */
+  SVN_ERR(open_tunnel_session(&session, repos_name, pool));
+  apr_array_clear(paths);
+  APR_ARRAY_PUSH(paths, const char *) = "A";
+  APR_ARRAY_PUSH(paths, const char *) = "A/BB";
+  APR_ARRAY_PUSH(paths, const char *) = "d7";
+  APR_ARRAY_PUSH(paths, const char *) = "A/B";
+  SVN_TEST_ASSERT_ERROR(svn_ra_get_dirs(session, &dirents, paths, 2,
+                                        SVN_DIRENT_KIND, pool, pool),
+                        SVN_ERR_RA_NOT_AUTHORIZED);
+  SVN_ERR(svn_ra_get_latest_revnum(session, &youngest, pool));
+  SVN_TEST_INT_ASSERT(youngest, 2);
+
+  SVN_ERR(open_tunnel_session(&session, repos_name, pool));
+  APR_ARRAY_IDX(paths, 2, const char *) = "d3";
+  SVN_ERR(svn_ra_get_dirs(session, &dirents, paths, 2, SVN_DIRENT_KIND,
+                          pool, pool));
+  SVN_TEST_INT_ASSERT(apr_hash_count(dirents), 4);
+  entries = svn_hash_gets(dirents, "A/BB");
+  SVN_TEST_ASSERT(entries);
+  SVN_TEST_INT_ASSERT(apr_hash_count(entries), 2);
+  entries = svn_hash_gets(dirents, "A/B");
+  SVN_TEST_ASSERT(entries);
+  SVN_TEST_INT_ASSERT(apr_hash_count(entries), 2);
+
+  /* The session must still be in sync. */
+  SVN_ERR(svn_ra_get_latest_revnum(session, &youngest, pool));
+  SVN_TEST_INT_ASSERT(youngest, 2);
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_ra_file_stream_func_t, recording PATH and REVISION in
+   the array of const char * BATON.  Also checks that PROPS got sent. */
+static svn_error_t *
+get_files_stream_func(svn_stream_t **stream,
+                      void *baton,
+                      const char *path,
+                      svn_revnum_t revision,
+                      apr_hash_t *props,
+                      apr_pool_t *pool)
+{
+  apr_array_header_t *received = baton;
+  svn_string_t *committed_rev;
+
+  SVN_TEST_ASSERT(props);
+  committed_rev = svn_hash_gets(props, SVN_PROP_ENTRY_COMMITTED_REV);
+  SVN_TEST_ASSERT(committed_rev);
+  SVN_TEST_STRING_ASSERT(committed_rev->data, "1");
+
+  APR_ARRAY_PUSH(received, const char *)
+    = apr_psprintf(received->pool, "%s@%ld", path, revision);
+
+  *stream = svn_stream_empty(pool);
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+get_files_test(const svn_test_opts_t *opts,
+               apr_pool_t *pool)
+{
+  svn_ra_session_t *session;
+  apr_array_header_t *targets = apr_array_make(pool, 3,
+                                               sizeof(svn_ra_file_target_t *));
+  apr_array_header_t *received = apr_array_make(pool, 3,
+                                                sizeof(const char *));
+  svn_ra_file_target_t *target;
+  apr_hash_t *props;
+
+  SVN_ERR(make_and_open_repos(&session, "test-get-files", opts, pool));
+  SVN_ERR(commit_tree(session, pool));
+
+  target = apr_pcalloc(pool, sizeof(*target));
+  target->path = "A/B/f";
+  target->revision = 1;
+  APR_ARRAY_PUSH(targets, svn_ra_file_target_t *) = target;
+
+  target = apr_pcalloc(pool, sizeof(*target));
+  target->path = "A/BB/g";
+  target->revision = SVN_INVALID_REVNUM;
+  APR_ARRAY_PUSH(targets, svn_ra_file_target_t *) = target;
+
+  SVN_ERR(svn_ra_get_files(session, targets, TRUE, get_files_stream_func,
+                           received, pool));
+  SVN_TEST_INT_ASSERT(received->nelts, 2);
+  SVN_TEST_STRING_ASSERT(APR_ARRAY_IDX(received, 0, const char *), "A/B/f@1");
+  SVN_TEST_STRING_ASSERT(APR_ARRAY_IDX(received, 1, const char *),
+                         "A/BB/g@1");
+
+  /* A failing file must not leave the session out of sync. */
+  target = apr_pcalloc(pool, sizeof(*target));
+  target->path = "non/existing/relpath";
+  target->revision = 1;
+  APR_ARRAY_PUSH(targets, svn_ra_file_target_t *) = target;
+
+  SVN_TEST_ASSERT_ERROR(svn_ra_get_files(session, targets, TRUE,
+                                         get_files_stream_func, received,
+                                         pool),
+                        SVN_ERR_FS_NOT_FOUND);
+
+  SVN_ERR(svn_ra_get_file(session, "A/B/f", 1, NULL, NULL, &props, pool));
+  SVN_TEST_ASSERT(svn_hash_gets(props, SVN_PROP_ENTRY_COMMITTED_REV));
+
+  return SVN_NO_ERROR;
+}
+
+/* Test svn_ra_get_files() over ra_svn, which uses the get-files command. */
+static svn_error_t *
+get_files_tunnel_test(const svn_test_opts_t *opts,
+                      apr_pool_t *pool)
+{
+  const char repos_name[] = "test-get-files-tunnel";
+  svn_ra_session_t *session;
+  apr_array_header_t *targets = apr_array_make(pool, 3,
+                                               sizeof(svn_ra_file_target_t *));
+  apr_array_header_t *received = apr_array_make(pool, 3,
+                                                sizeof(const char *));
+  svn_ra_file_target_t *target;
+  svn_revnum_t youngest;
+  svn_boolean_t has;
+  const char *conf_dir;
+
+  SVN_ERR(make_and_open_tunnel_repos(&session, repos_name, opts, pool));
+  SVN_ERR(commit_tree(session, pool));
+  SVN_ERR(svn_ra_has_capability(session, &has, SVN_RA_CAPABILITY_GET_FILES,
+                                pool));
+  SVN_TEST_ASSERT(has);
+
+  /* No targets at all. */
+  SVN_ERR(svn_ra_get_files(session, targets, TRUE, get_files_stream_func,
+                           received, pool));
+  SVN_TEST_INT_ASSERT(received->nelts, 0);
+
+  target = apr_pcalloc(pool, sizeof(*target));
+  target->path = "A/B/f";
+  target->revision = 1;
+  APR_ARRAY_PUSH(targets, svn_ra_file_target_t *) = target;
+
+  target = apr_pcalloc(pool, sizeof(*target));
+  target->path = "A/BB/g";
+  target->revision = SVN_INVALID_REVNUM;
+  APR_ARRAY_PUSH(targets, svn_ra_file_target_t *) = target;
+
+  SVN_ERR(svn_ra_get_files(session, targets, TRUE, get_files_stream_func,
+                           received, pool));
+  SVN_TEST_INT_ASSERT(received->nelts, 2);
+  SVN_TEST_STRING_ASSERT(APR_ARRAY_IDX(received, 0, const char *), "A/B/f@1");
+  SVN_TEST_STRING_ASSERT(APR_ARRAY_IDX(received, 1, const char *),
+                         "A/BB/g@1");
+
+  /* A missing file ends the response after the files before it. */
+  target = apr_pcalloc(pool, sizeof(*target));
+  target->path = "non/existing/relpath";
+  target->revision = 1;
+  apr_array_clear(received);
+  APR_ARRAY_PUSH(targets, svn_ra_file_target_t *) = target;
+  APR_ARRAY_PUSH(targets, svn_ra_file_target_t *)
+    = APR_ARRAY_IDX(targets, 0, svn_ra_file_target_t *);
+
+  SVN_TEST_ASSERT_ERROR(svn_ra_get_files(session, targets, TRUE,
+                                         get_files_stream_func, received,
+                                         pool),
+                        SVN_ERR_FS_NOT_FOUND);
+  SVN_TEST_INT_ASSERT(received->nelts, 2);
+  SVN_ERR(svn_ra_get_latest_revnum(session, &youngest, pool));
+  SVN_TEST_INT_ASSERT(youngest, 1);
+
+  /* Deny access to A/BB and fetch the files in a new svnserve. */
+  conf_dir = svn_dirent_join(repos_name, "conf", pool);
+  SVN_ERR(svn_io_write_atomic2(svn_dirent_join(conf_dir, "svnserve.conf",
+                                               pool),
+                               "[general]\n"
+                               "authz-db = authz\n",
+                               strlen("[general]\n"
+                                      "authz-db = authz\n"),
+                               NULL, FALSE, pool));
+  SVN_ERR(svn_io_write_atomic2(svn_dirent_join(conf_dir, "authz", pool),
+                               "[/]\n"
+                               "* = r\n"
+                               "[/A/BB]\n"
+                               "* =\n",
+                               strlen("[/]\n"
+                                      "* = r\n"
+                                      "[/A/BB]\n"
+                                      "* =\n"),
+                               NULL, FALSE, pool));
+  SVN_ERR(open_tunnel_session(&session, repos_name, pool));
+
+  apr_array_clear(received);
+  apr_array_pop(targets);
+  apr_array_pop(targets);
+  SVN_TEST_ASSERT_ERROR(svn_ra_get_files(session, targets, TRUE,
+                                         get_files_stream_func, received,
+                                         pool),
+                        SVN_ERR_RA_NOT_AUTHORIZED);
+  SVN_TEST_INT_ASSERT(received->nelts, 1);
+
+  /* Readable files still work. */
+  apr_array_clear(received);
+  apr_array_pop(targets);
+  SVN_ERR(svn_ra_get_files(session, targets, TRUE, get_files_stream_func,
+                           received, pool));
+  SVN_TEST_INT_ASSERT(received->nelts, 1);
+
+  return SVN_NO_ERROR;
+}
+
 /* Implements svn_commit_callback2_t for commit_callback_failure() */
 static svn_error_t *
 commit_callback_with_failure(const svn_commit_info_t *info,
@@ -1784,6 +2212,220 @@ commit_locked_file(const svn_test_opts_t *opts, apr_pool_t *pool)
   return SVN_NO_ERROR;
 }
 
+/* Baton for the input streams created by trickle_conn_create(). */
+typedef struct trickle_baton_t
+{
+  /* The data to deliver. */
+  const char *data;
+  apr_size_t len;
+
+  /* The number of bytes delivered so far and the number of bytes that
+     may be delivered without blocking. */
+  apr_size_t pos;
+  apr_size_t available;
+
+  /* If not 0, deliver this byte forever after DATA. */
+  char filler;
+} trickle_baton_t;
+
+/* Implements svn_read_fn_t. */
+static svn_error_t *
+trickle_read(void *baton, char *buffer, apr_size_t *len)
+{
+  trickle_baton_t *b = baton;
+  apr_size_t count;
+
+  if (b->filler)
+    {
+      count = 0;
+      if (b->pos < b->len)
+        {
+          count = MIN(*len, b->len - b->pos);
+          memcpy(buffer, b->data + b->pos, count);
+          b->pos += count;
+        }
+
+      memset(buffer + count, b->filler, *len - count);
+      return SVN_NO_ERROR;
+    }
+
+  /* Reading beyond what is available would block. */
+  SVN_TEST_ASSERT(b->pos < b->available || b->available == b->len);
+
+  count = MIN(*len, b->available - b->pos);
+  memcpy(buffer, b->data + b->pos, count);
+  b->pos += count;
+  *len = count;
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_stream_data_available_fn_t. */
+static svn_error_t *
+trickle_data_available(void *baton, svn_boolean_t *data_available)
+{
+  trickle_baton_t *b = baton;
+
+  *data_available = b->filler || b->pos < b->available;
+  return SVN_NO_ERROR;
+}
+
+/* Return an ra_svn connection that reads DATA, with no more than the
+   first AVAILABLE bytes of it being available initially.  If FILLER is
+   not 0, the input continues with endless copies of it after DATA.
+   Set *BATON to the input stream's baton. */
+static svn_ra_svn_conn_t *
+trickle_conn_create(trickle_baton_t **baton,
+                    const char *data,
+                    apr_size_t available,
+                    char filler,
+                    apr_uint64_t max_in,
+                    apr_pool_t *pool)
+{
+  trickle_baton_t *b = apr_pcalloc(pool, sizeof(*b));
+  svn_stream_t *in;
+
+  b->data = data;
+  b->len = strlen(data);
+  b->available = available;
+  b->filler = filler;
+
+  in = svn_stream_create(b, pool);
+  svn_stream_set_read2(in, trickle_read, NULL);
+  svn_stream_set_data_available(in, trickle_data_available);
+
+  *baton = b;
+  return svn_ra_svn_create_conn5(NULL, in, svn_stream_empty(pool), 0, 0, 0,
+                                 max_in, 0, pool);
+}
+
+/* Two commands.  The first one has strings with parentheses and colons
+   in them as well as nested lists. */
+#define SPLIT_COMMAND_1 "( test-cmd ( 5:)(:(( ( 1 ( 23 ( 456 ) ) ) " \
+                        "12:))))))))))))" " ) )"
+#define SPLIT_COMMAND_2 " ( next-cmd ( ) ) "
+
+/* Read the commands from SPLIT_COMMAND_1 and SPLIT_COMMAND_2 from CONN,
+   checking that svn_ra_svn__has_complete_command() reports both. */
+static svn_error_t *
+read_split_commands(svn_ra_svn_conn_t *conn,
+                    apr_pool_t *pool)
+{
+  svn_boolean_t has_command, terminated;
+  const char *cmdname;
+  svn_ra_svn__list_t *params;
+  svn_string_t *str1, *str2;
+  apr_uint64_t n1, n2, n3;
+
+  SVN_ERR(svn_ra_svn__has_complete_command(&has_command, &terminated,
+                                           conn, pool));
+  SVN_TEST_ASSERT(has_command && !terminated);
+
+  SVN_ERR(svn_ra_svn__read_tuple(conn, pool, "wl", &cmdname, &params));
+  SVN_TEST_STRING_ASSERT(cmdname, "test-cmd");
+  SVN_ERR(svn_ra_svn__parse_tuple(params, "s(n(n(n)))s",
+                                  &str1, &n1, &n2, &n3, &str2));
+  SVN_TEST_STRING_ASSERT(str1->data, ")(:((");
+  SVN_TEST_ASSERT(n1 == 1 && n2 == 23 && n3 == 456);
+  SVN_TEST_STRING_ASSERT(str2->data, "))))))))))))");
+
+  SVN_ERR(svn_ra_svn__has_complete_command(&has_command, &terminated,
+                                           conn, pool));
+  SVN_TEST_ASSERT(has_command && !terminated);
+
+  SVN_ERR(svn_ra_svn__read_tuple(conn, pool, "wl", &cmdname, &params));
+  SVN_TEST_STRING_ASSERT(cmdname, "next-cmd");
+  SVN_TEST_ASSERT(params->nelts == 0);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+complete_command_split(apr_pool_t *pool)
+{
+  const char *data = SPLIT_COMMAND_1 SPLIT_COMMAND_2;
+  apr_size_t end = strlen(SPLIT_COMMAND_1);
+  apr_size_t len = strlen(data);
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  apr_size_t i;
+
+  /* Split the input into two reads at every possible offset. */
+  for (i = 0; i <= len; ++i)
+    {
+      trickle_baton_t *b;
+      svn_ra_svn_conn_t *conn;
+      svn_boolean_t has_command, terminated;
+
+      svn_pool_clear(iterpool);
+      conn = trickle_conn_create(&b, data, i, 0, 0, iterpool);
+
+      SVN_ERR(svn_ra_svn__has_complete_command(&has_command, &terminated,
+                                               conn, iterpool));
+      SVN_TEST_ASSERT(!terminated);
+      SVN_TEST_ASSERT(has_command == (i >= end));
+
+      b->available = len;
+      SVN_ERR(read_split_commands(conn, iterpool));
+    }
+
+  /* Deliver the input one byte at a time. */
+  {
+    trickle_baton_t *b;
+    svn_ra_svn_conn_t *conn;
+
+    svn_pool_clear(iterpool);
+    conn = trickle_conn_create(&b, data, 0, 0, 0, iterpool);
+    for (i = 0; i < end; ++i)
+      {
+        svn_boolean_t has_command, terminated;
+
+        SVN_ERR(svn_ra_svn__has_complete_command(&has_command, &terminated,
+                                                 conn, iterpool));
+        SVN_TEST_ASSERT(!has_command && !terminated);
+        b->available++;
+      }
+
+    b->available = len;
+    SVN_ERR(read_split_commands(conn, iterpool));
+  }
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+complete_command_limit(apr_pool_t *pool)
+{
+  /* Requests that never end: one nesting lists ever deeper and one
+     that announces a huge string. */
+  const char *requests[] = { "( test-cmd ( ", "( test-cmd ( 99999999999:" };
+  const char fillers[] = { '(', 'x' };
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  apr_size_t i;
+
+  for (i = 0; i < sizeof(fillers); ++i)
+    {
+      trickle_baton_t *b;
+      svn_ra_svn_conn_t *conn;
+      svn_boolean_t has_command, terminated;
+
+      svn_pool_clear(iterpool);
+      conn = trickle_conn_create(&b, requests[i], 0, fillers[i], 100000,
+                                 iterpool);
+
+      /* This must not keep buffering input forever. */
+      SVN_TEST_ASSERT_ERROR(
+        svn_ra_svn__has_complete_command(&has_command, &terminated, conn,
+                                         iterpool),
+        SVN_ERR_RA_SVN_REQUEST_SIZE);
+    }
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
 
 /* The test table.  */
 
@@ -1802,6 +2444,14 @@ static struct svn_test_descriptor_t test_funcs[] =
                        "lock multiple paths"),
     SVN_TEST_OPTS_PASS(get_dir_test,
                        "test ra_get_dir2"),
+    SVN_TEST_OPTS_PASS(get_dirs_test,
+                       "test ra_get_dirs"),
+    SVN_TEST_OPTS_PASS(get_dirs_tunnel_test,
+                       "svn_ra_get_dirs over a tunnel"),
+    SVN_TEST_OPTS_PASS(get_files_tunnel_test,
+                       "svn_ra_get_files over a tunnel"),
+    SVN_TEST_OPTS_PASS(get_files_test,
+                       "test ra_get_files"),
     SVN_TEST_OPTS_PASS(commit_callback_failure,
                        "commit callback failure"),
     SVN_TEST_OPTS_PASS(base_revision_above_youngest,
@@ -1820,6 +2470,10 @@ static struct svn_test_descriptor_t test_funcs[] =
                        "check how last change applies to empty commit"),
     SVN_TEST_OPTS_PASS(commit_locked_file,
                        "check commit editor for a locked file"),
+    SVN_TEST_PASS2(complete_command_split,
+                   "detect commands received in pieces"),
+    SVN_TEST_PASS2(complete_command_limit,
+                   "limit the size of incomplete commands"),
     SVN_TEST_NULL
   };
 
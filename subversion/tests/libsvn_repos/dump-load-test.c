@@ -28,6 +28,7 @@
 #include "svn_error.h"
 #include "svn_fs.h"
 #include "svn_repos.h"
+#include "svn_dirent_uri.h"
 #include "private/svn_repos_private.h"
 
 #include "../svn_test.h"
@@ -79,7 +80,7 @@ test_dump_bad_props(svn_stringbuf_t **dump_data_p,
   SVN_ERR(svn_repos_dump_fs4(repos, stream, start_rev, end_rev,
                              FALSE, FALSE, TRUE, TRUE,
                              notify_func, notify_baton,
-                             NULL, NULL, NULL, NULL,
+                             NULL, NULL, 1, NULL, NULL,
                              pool));
   svn_stream_close(stream);
 
@@ -128,6 +129,7 @@ test_load_bad_props(svn_stringbuf_t *dump_data,
                              validate_props,
                              FALSE /*ignore_dates*/,
                              FALSE /*normalize_props*/,
+                             1 /*thread_count*/,
                              notify_func, notify_baton,
                              NULL, NULL, /*cancellation*/
                              pool));
@@ -273,6 +275,278 @@ test_load_r0_mergeinfo(const svn_test_opts_t *opts,
   return SVN_NO_ERROR;
 }
 
+/* Notification receiver for test_verify_concurrently(),
+   test_dump_concurrently() and test_load_concurrently().  Append a line
+   describing NOTIFY to the svn_stringbuf_t given as BATON.
+ */
+static void
+verify_notifier(void *baton,
+                const svn_repos_notify_t *notify,
+                apr_pool_t *scratch_pool)
+{
+  svn_stringbuf_t *notifications = baton;
+
+  svn_stringbuf_appendcstr(notifications,
+                           apr_psprintf(scratch_pool, "%d %ld\n",
+                                        notify->action, notify->revision));
+}
+
+/* Verify a repository sequentially and concurrently and check that both
+   produce the same sequence of notifications. */
+static svn_error_t *
+test_verify_concurrently(const svn_test_opts_t *opts,
+                         apr_pool_t *pool)
+{
+  svn_repos_t *repos;
+  svn_fs_t *fs;
+  svn_revnum_t youngest_rev = 0;
+  svn_stringbuf_t *sequential = svn_stringbuf_create_empty(pool);
+  svn_stringbuf_t *concurrent = svn_stringbuf_create_empty(pool);
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  int i;
+
+  SVN_ERR(svn_test__create_repos(&repos, "test-repo-verify-concurrently",
+                                 opts, pool));
+  fs = svn_repos_fs(repos);
+
+  /* r1 adds the greek tree, all later revisions modify iota. */
+  for (i = 1; i <= 20; ++i)
+    {
+      svn_fs_txn_t *txn;
+      svn_fs_root_t *txn_root;
+
+      svn_pool_clear(iterpool);
+
+      SVN_ERR(svn_fs_begin_txn2(&txn, fs, youngest_rev, 0, iterpool));
+      SVN_ERR(svn_fs_txn_root(&txn_root, txn, iterpool));
+      if (i == 1)
+        SVN_ERR(svn_test__create_greek_tree(txn_root, iterpool));
+      else
+        SVN_ERR(svn_test__set_file_contents(txn_root, "iota",
+                                            apr_psprintf(iterpool,
+                                                         "iota in r%d\n", i),
+                                            iterpool));
+      SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn,
+                                      iterpool));
+      SVN_TEST_ASSERT(SVN_IS_VALID_REVNUM(youngest_rev));
+    }
+
+  svn_pool_destroy(iterpool);
+
+  SVN_ERR(svn_repos_verify_fs4(repos, SVN_INVALID_REVNUM, SVN_INVALID_REVNUM,
+                               FALSE, FALSE, 1,
+                               verify_notifier, sequential,
+                               NULL, NULL, NULL, NULL, pool));
+  SVN_ERR(svn_repos_verify_fs4(repos, SVN_INVALID_REVNUM, SVN_INVALID_REVNUM,
+                               FALSE, FALSE, 4,
+                               verify_notifier, concurrent,
+                               NULL, NULL, NULL, NULL, pool));
+
+  SVN_TEST_STRING_ASSERT(concurrent->data, sequential->data);
+
+  return SVN_NO_ERROR;
+}
+
+/* Dump a repository sequentially and concurrently, with and without
+   deltas, and check that both produce identical output. */
+static svn_error_t *
+test_dump_concurrently(const svn_test_opts_t *opts,
+                       apr_pool_t *pool)
+{
+  svn_repos_t *repos;
+  svn_fs_t *fs;
+  svn_revnum_t youngest_rev = 0;
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  int i;
+
+  SVN_ERR(svn_test__create_repos(&repos, "test-repo-dump-concurrently",
+                                 opts, pool));
+  fs = svn_repos_fs(repos);
+
+  /* r1 adds the greek tree, all later revisions modify iota and copy
+     some directory. */
+  for (i = 1; i <= 20; ++i)
+    {
+      svn_fs_txn_t *txn;
+      svn_fs_root_t *txn_root;
+
+      svn_pool_clear(iterpool);
+
+      SVN_ERR(svn_fs_begin_txn2(&txn, fs, youngest_rev, 0, iterpool));
+      SVN_ERR(svn_fs_txn_root(&txn_root, txn, iterpool));
+      if (i == 1)
+        {
+          SVN_ERR(svn_test__create_greek_tree(txn_root, iterpool));
+        }
+      else
+        {
+          svn_fs_root_t *rev_root;
+
+          SVN_ERR(svn_test__set_file_contents(txn_root, "iota",
+                                              apr_psprintf(iterpool,
+                                                           "iota in r%d\n",
+                                                           i),
+                                              iterpool));
+          SVN_ERR(svn_fs_revision_root(&rev_root, fs, youngest_rev,
+                                       iterpool));
+          SVN_ERR(svn_fs_copy(rev_root, "A/B", txn_root,
+                              apr_psprintf(iterpool, "B%d", i), iterpool));
+        }
+      SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn,
+                                      iterpool));
+      SVN_TEST_ASSERT(SVN_IS_VALID_REVNUM(youngest_rev));
+    }
+
+  for (i = 0; i < 4; ++i)
+    {
+      svn_boolean_t incremental = (i & 1) != 0;
+      svn_boolean_t use_deltas = (i & 2) != 0;
+      svn_stringbuf_t *sequential;
+      svn_stringbuf_t *concurrent;
+      svn_stringbuf_t *seq_notifications;
+      svn_stringbuf_t *con_notifications;
+
+      svn_pool_clear(iterpool);
+      sequential = svn_stringbuf_create_empty(iterpool);
+      concurrent = svn_stringbuf_create_empty(iterpool);
+      seq_notifications = svn_stringbuf_create_empty(iterpool);
+      con_notifications = svn_stringbuf_create_empty(iterpool);
+
+      SVN_ERR(svn_repos_dump_fs4(repos,
+                                 svn_stream_from_stringbuf(sequential,
+                                                           iterpool),
+                                 5, youngest_rev, incremental, use_deltas,
+                                 TRUE, TRUE,
+                                 verify_notifier, seq_notifications,
+                                 NULL, NULL, 1, NULL, NULL, iterpool));
+      SVN_ERR(svn_repos_dump_fs4(repos,
+                                 svn_stream_from_stringbuf(concurrent,
+                                                           iterpool),
+                                 5, youngest_rev, incremental, use_deltas,
+                                 TRUE, TRUE,
+                                 verify_notifier, con_notifications,
+                                 NULL, NULL, 4, NULL, NULL, iterpool));
+
+      SVN_TEST_STRING_ASSERT(concurrent->data, sequential->data);
+      SVN_TEST_STRING_ASSERT(con_notifications->data,
+                             seq_notifications->data);
+    }
+
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Load a dump stream with deltas sequentially and concurrently and check
+   that both produce the same repository contents and notifications. */
+static svn_error_t *
+test_load_concurrently(const svn_test_opts_t *opts,
+                       apr_pool_t *pool)
+{
+  svn_repos_t *repos;
+  svn_fs_t *fs;
+  svn_revnum_t youngest_rev = 0;
+  svn_stringbuf_t *dump_data = svn_stringbuf_create_empty(pool);
+  svn_stringbuf_t *contents[2];
+  svn_stringbuf_t *notifications[2];
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  int i;
+
+  SVN_ERR(svn_test__create_repos(&repos, "test-repo-load-concurrently",
+                                 opts, pool));
+  fs = svn_repos_fs(repos);
+
+  /* r1 adds the greek tree, all later revisions modify iota, add a new
+     file and copy some directory, modifying a file within the copy. */
+  for (i = 1; i <= 20; ++i)
+    {
+      svn_fs_txn_t *txn;
+      svn_fs_root_t *txn_root;
+
+      svn_pool_clear(iterpool);
+
+      SVN_ERR(svn_fs_begin_txn2(&txn, fs, youngest_rev, 0, iterpool));
+      SVN_ERR(svn_fs_txn_root(&txn_root, txn, iterpool));
+      if (i == 1)
+        {
+          SVN_ERR(svn_test__create_greek_tree(txn_root, iterpool));
+        }
+      else
+        {
+          svn_fs_root_t *rev_root;
+          const char *path = apr_psprintf(iterpool, "file%d", i);
+          const char *copy_path = apr_psprintf(iterpool, "B%d", i);
+
+          SVN_ERR(svn_test__set_file_contents(txn_root, "iota",
+                                              apr_psprintf(iterpool,
+                                                           "iota in r%d\n",
+                                                           i),
+                                              iterpool));
+          SVN_ERR(svn_fs_make_file(txn_root, path, iterpool));
+          SVN_ERR(svn_test__set_file_contents(txn_root, path,
+                                              "new file\n", iterpool));
+          SVN_ERR(svn_fs_revision_root(&rev_root, fs, youngest_rev,
+                                       iterpool));
+          SVN_ERR(svn_fs_copy(rev_root, "A/B", txn_root, copy_path,
+                              iterpool));
+          SVN_ERR(svn_test__set_file_contents(
+                    txn_root, svn_relpath_join(copy_path, "lambda", iterpool),
+                    apr_psprintf(iterpool, "lambda in r%d\n", i),
+                    iterpool));
+        }
+      SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn,
+                                      iterpool));
+      SVN_TEST_ASSERT(SVN_IS_VALID_REVNUM(youngest_rev));
+    }
+
+  svn_pool_destroy(iterpool);
+
+  SVN_ERR(svn_repos_dump_fs4(repos, svn_stream_from_stringbuf(dump_data,
+                                                               pool),
+                             SVN_INVALID_REVNUM, SVN_INVALID_REVNUM,
+                             FALSE, TRUE, TRUE, TRUE, NULL, NULL,
+                             NULL, NULL, 1, NULL, NULL, pool));
+
+  /* Load with 1 and 4 threads, then dump the results without deltas. */
+  for (i = 0; i < 2; ++i)
+    {
+      svn_repos_t *target;
+
+      SVN_ERR(svn_test__create_repos(&target,
+                                     apr_psprintf(pool,
+                                                  "test-repo-load-"
+                                                  "concurrently-%d", i),
+                                     opts, pool));
+
+      notifications[i] = svn_stringbuf_create_empty(pool);
+      SVN_ERR(svn_repos_load_fs6(target,
+                                 svn_stream_from_stringbuf(dump_data, pool),
+                                 SVN_INVALID_REVNUM, SVN_INVALID_REVNUM,
+                                 svn_repos_load_uuid_default, NULL,
+                                 FALSE, FALSE, /*use_*_commit_hook*/
+                                 TRUE /*validate_props*/,
+                                 FALSE /*ignore_dates*/,
+                                 FALSE /*normalize_props*/,
+                                 i ? 4 : 1,
+                                 verify_notifier, notifications[i],
+                                 NULL, NULL, /*cancellation*/
+                                 pool));
+
+      contents[i] = svn_stringbuf_create_empty(pool);
+      SVN_ERR(svn_repos_dump_fs4(target,
+                                 svn_stream_from_stringbuf(contents[i],
+                                                           pool),
+                                 SVN_INVALID_REVNUM, SVN_INVALID_REVNUM,
+                                 FALSE, FALSE, TRUE, TRUE, NULL, NULL,
+                                 NULL, NULL, 1, NULL, NULL, pool));
+    }
+
+  SVN_TEST_STRING_ASSERT(contents[1]->data, contents[0]->data);
+  SVN_TEST_STRING_ASSERT(notifications[1]->data, notifications[0]->data);
+
+  return SVN_NO_ERROR;
+}
+
 /* The test table.  */
 
 static int max_threads = 4;
@@ -284,6 +558,12 @@ static struct svn_test_descriptor_t test_funcs[] =
                        "test dumping with r0 mergeinfo"),
     SVN_TEST_OPTS_PASS(test_load_r0_mergeinfo,
                        "test loading with r0 mergeinfo"),
+    SVN_TEST_OPTS_PASS(test_verify_concurrently,
+                       "test concurrent repository verification"),
+    SVN_TEST_OPTS_PASS(test_dump_concurrently,
+                       "test concurrent repository dump"),
+    SVN_TEST_OPTS_PASS(test_load_concurrently,
+                       "test concurrent repository load"),
     SVN_TEST_NULL
   };
 
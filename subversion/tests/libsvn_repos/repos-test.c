@@ -24,6 +24,7 @@
 #include <string.h>
 
 #include <apr_pools.h>
+#include <apr_strings.h>
 #include <apr_time.h>
 
 #include "../svn_test.h"
@@ -1575,6 +1576,132 @@ test_authz_wildcard_performance(apr_pool_t *pool)
   return SVN_NO_ERROR;
 }
 
+/* Test patterns with multiple wildcards as well as lookup sequences that
+ * resume at different parent paths of the previous lookup. */
+static svn_error_t *
+test_authz_complex_patterns(apr_pool_t *pool)
+{
+  svn_authz_t *authz_cfg;
+
+  const char *contents =
+    "[/]"                                                                    NL
+    "* = rw"                                                                 NL
+    ""                                                                       NL
+    "[:glob:/**/x*y*z]"                                                      NL
+    "* ="                                                                    NL
+    ""                                                                       NL
+    "[:glob:/**/a?c*]"                                                       NL
+    "* ="                                                                    NL
+    ""                                                                       NL
+    "[:glob:/A/B/*p*q*]"                                                     NL
+    "* = r"                                                                  NL;
+
+  const struct check_access_tests test_set[] = {
+    { "/xyz", NULL, NULL, svn_authz_read, FALSE },
+    { "/xz", NULL, NULL, svn_authz_read, TRUE },
+    { "/xzyz", NULL, NULL, svn_authz_read, FALSE },
+    { "/xyzz", NULL, NULL, svn_authz_read, FALSE },
+    { "/yxz", NULL, NULL, svn_authz_read, TRUE },
+    { "/xyzy", NULL, NULL, svn_authz_read, TRUE },
+    { "/abc", NULL, NULL, svn_authz_read, FALSE },
+    { "/abcd", NULL, NULL, svn_authz_read, FALSE },
+    { "/ac", NULL, NULL, svn_authz_read, TRUE },
+    { "/A/B/C/xaybz", NULL, NULL, svn_authz_read, FALSE },
+    { "/A/B/C/D", NULL, NULL, svn_authz_write, TRUE },
+    { "/A/B/pq", NULL, NULL, svn_authz_write, FALSE },
+    { "/A/B/pq", NULL, NULL, svn_authz_read, TRUE },
+    { "/A/B/qp", NULL, NULL, svn_authz_write, TRUE },
+    { "/A/B/C/pq", NULL, NULL, svn_authz_write, TRUE },
+    { "/A/xz", NULL, NULL, svn_authz_read, TRUE },
+    { "/A/B/C/xyz", NULL, NULL, svn_authz_read, FALSE },
+    { "/A/B/C/xyz/D", NULL, NULL, svn_authz_read, FALSE },
+    { "/A/B/C/E", NULL, NULL, svn_authz_read, TRUE },
+    { "/A/B", NULL, NULL, svn_authz_write | svn_authz_recursive, FALSE },
+    { "/A/C", NULL, NULL, svn_authz_read | svn_authz_recursive, FALSE },
+    { "/A/B/C", NULL, NULL, svn_authz_write, TRUE },
+    /* Sentinel */
+    { NULL, NULL, NULL, svn_authz_none, FALSE }
+  };
+
+  /* Load the test authz rules. */
+  SVN_ERR(authz_get_handle(&authz_cfg, contents, FALSE, pool));
+
+  /* Loop over the test array and test each case. */
+  SVN_ERR(authz_check_access(authz_cfg, test_set, pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Test the authz performance with a large number of rules, checking
+ * the paths of a tree walk like the reporter does. */
+static svn_error_t *
+test_authz_large_ruleset_performance(apr_pool_t *pool)
+{
+  svn_authz_t *authz_cfg;
+  svn_boolean_t access_granted;
+  svn_stringbuf_t *contents = svn_stringbuf_create_empty(pool);
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  apr_int64_t checks = 0;
+  int i, k, n;
+  apr_time_t start, end;
+
+  /* 50k rules: per-project access for individual users and some
+   * project-specific wildcard rules. */
+  svn_stringbuf_appendcstr(contents, "[/]" NL "* = r" NL NL);
+  for (i = 0; i < 40000; ++i)
+    svn_stringbuf_appendcstr(contents,
+                             apr_psprintf(iterpool,
+                                          "[/projects/p%d/trunk]" NL
+                                          "user%d = rw" NL NL,
+                                          i, i % 1000));
+  for (i = 0; i < 10000; ++i)
+    svn_stringbuf_appendcstr(contents,
+                             apr_psprintf(iterpool,
+                                          "[:glob:/projects/p%d/**/*sec*%d]" NL
+                                          "* =" NL NL,
+                                          i * 4, i % 10));
+
+  start = apr_time_now();
+  SVN_ERR(authz_get_handle(&authz_cfg, contents->data, FALSE, pool));
+  end = apr_time_now();
+  printf("%"APR_TIME_T_FMT" musecs to parse\n", end - start);
+
+  start = apr_time_now();
+  for (k = 0; k < 100; ++k)
+    for (i = 0; i < 40; ++i)
+      {
+        const char *project;
+
+        svn_pool_clear(iterpool);
+        project = apr_psprintf(iterpool, "/projects/p%d", i);
+
+        /* Walk each project depth-first. */
+        for (n = 0; n < 100; ++n)
+          {
+            const char *dir = apr_psprintf(iterpool, "%s/trunk/d%d",
+                                           project, n / 10);
+            const char *file = apr_psprintf(iterpool, "%s/f%d-sec-%d",
+                                            dir, n, n % 10);
+
+            SVN_ERR(svn_repos_authz_check_access(authz_cfg, NULL, dir,
+                                                 "user7", svn_authz_read,
+                                                 &access_granted, iterpool));
+            SVN_ERR(svn_repos_authz_check_access(authz_cfg, NULL, file,
+                                                 "user7", svn_authz_read,
+                                                 &access_granted, iterpool));
+            checks += 2;
+          }
+      }
+
+  end = apr_time_now();
+  printf("%"APR_TIME_T_FMT" musecs\n", end - start);
+  printf("%"APR_INT64_T_FMT" checks / sec\n",
+         checks * 1000000 / (end - start));
+
+  svn_pool_destroy(iterpool);
+  return SVN_NO_ERROR;
+}
+
 /* Test that the latest definition wins, regardless of whether the ":glob:"
  * prefix has been given. */
 static svn_error_t *
@@ -4466,6 +4593,516 @@ test_list(const svn_test_opts_t *opts,
   return SVN_NO_ERROR;
 }
 
+/* Tests for svn_repos_blame() */
+
+/* One range of blame information as reported by svn_repos_blame(). */
+typedef struct blame_range_t {
+    apr_int64_t start_line;
+    apr_int64_t end_line;
+    svn_revnum_t rev;
+    const char *author;
+} blame_range_t;
+
+/* Implements svn_repos_blame_receiver_t.  Appends the range to the
+   array of blame_range_t in BATON. */
+static svn_error_t *
+blame_receiver(apr_int64_t start_line,
+               apr_int64_t end_line,
+               svn_revnum_t revision,
+               apr_hash_t *rev_props,
+               void *baton,
+               apr_pool_t *scratch_pool)
+{
+  apr_array_header_t *ranges = baton;
+  blame_range_t *range = apr_array_push(ranges);
+
+  range->start_line = start_line;
+  range->end_line = end_line;
+  range->rev = revision;
+  range->author = rev_props
+                ? apr_pstrdup(ranges->pool,
+                              svn_prop_get_value(rev_props,
+                                                 SVN_PROP_REVISION_AUTHOR))
+                : NULL;
+
+  return SVN_NO_ERROR;
+}
+
+/* Commit CONTENTS as the new contents of /file in REPOS as AUTHOR.
+   Create the file if it does not exist.  If CONTENTS is NULL, change
+   a property instead. */
+static svn_error_t *
+commit_blame_file(svn_repos_t *repos,
+                  const char *author,
+                  const char *contents,
+                  apr_pool_t *pool)
+{
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *txn_root;
+  svn_revnum_t youngest_rev;
+  svn_node_kind_t kind;
+  apr_hash_t *revprops = apr_hash_make(pool);
+
+  svn_hash_sets(revprops, SVN_PROP_REVISION_AUTHOR,
+                svn_string_create(author, pool));
+
+  SVN_ERR(svn_fs_youngest_rev(&youngest_rev, svn_repos_fs(repos), pool));
+  SVN_ERR(svn_repos_fs_begin_txn_for_commit2(&txn, repos, youngest_rev,
+                                             revprops, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+
+  SVN_ERR(svn_fs_check_path(&kind, txn_root, "/file", pool));
+  if (kind == svn_node_none)
+    SVN_ERR(svn_fs_make_file(txn_root, "/file", pool));
+
+  if (contents)
+    SVN_ERR(svn_test__set_file_contents(txn_root, "/file", contents, pool));
+  else
+    SVN_ERR(svn_fs_change_node_prop(txn_root, "/file", "prop",
+                                    svn_string_create(author, pool), pool));
+
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn, pool));
+  SVN_TEST_ASSERT(SVN_IS_VALID_REVNUM(youngest_rev));
+
+  return SVN_NO_ERROR;
+}
+
+/* Verify that RANGES matches the COUNT elements of EXPECTED. */
+static svn_error_t *
+verify_blame_ranges(const apr_array_header_t *ranges,
+                    const blame_range_t *expected,
+                    int count)
+{
+  int i;
+
+  SVN_TEST_ASSERT(ranges->nelts == count);
+  for (i = 0; i < count; i++)
+    {
+      const blame_range_t *range = &APR_ARRAY_IDX(ranges, i, blame_range_t);
+
+      SVN_TEST_ASSERT(range->start_line == expected[i].start_line);
+      SVN_TEST_ASSERT(range->end_line == expected[i].end_line);
+      SVN_TEST_ASSERT(range->rev == expected[i].rev);
+      SVN_TEST_STRING_ASSERT(range->author, expected[i].author);
+    }
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_blame(const svn_test_opts_t *opts,
+           apr_pool_t *pool)
+{
+  svn_repos_t *repos;
+  apr_array_header_t *ranges;
+  apr_array_header_t *diff_options;
+
+  blame_range_t full_range[] = {
+    { 0, 1, 4, "carol" },
+    { 1, 2, 1, "alice" },
+    { 2, 4, 2, "bob" },
+  };
+  blame_range_t partial_range[] = {
+    { 0, 1, 4, "carol" },
+    { 1, 2, SVN_INVALID_REVNUM, NULL },
+    { 2, 4, 2, "bob" },
+  };
+  blame_range_t ignore_space[] = {
+    { 0, 1, 4, "carol" },
+    { 1, 2, 1, "alice" },
+    { 2, 4, 2, "bob" },
+    { 4, 5, 6, "dave" },
+  };
+
+  SVN_ERR(svn_test__create_repos(&repos, "test-repo-blame", opts, pool));
+
+  SVN_ERR(commit_blame_file(repos, "alice", "1\n2\n3\n", pool));
+  SVN_ERR(commit_blame_file(repos, "bob", "1\nX\n3\n4\n", pool));
+  SVN_ERR(commit_blame_file(repos, "carol", NULL, pool));
+  SVN_ERR(commit_blame_file(repos, "carol", "0\n1\nX\n4\n", pool));
+
+  /* Blame the whole history. */
+  ranges = apr_array_make(pool, 0, sizeof(blame_range_t));
+  SVN_ERR(svn_repos_blame(repos, "/file", 0, 4, NULL, NULL, NULL,
+                          blame_receiver, ranges, NULL, NULL, pool));
+  SVN_ERR(verify_blame_ranges(ranges, full_range,
+                              sizeof(full_range) / sizeof(full_range[0])));
+
+  /* Lines older than the range don't get attributed to any revision. */
+  ranges = apr_array_make(pool, 0, sizeof(blame_range_t));
+  SVN_ERR(svn_repos_blame(repos, "/file", 2, 4, NULL, NULL, NULL,
+                          blame_receiver, ranges, NULL, NULL, pool));
+  SVN_ERR(verify_blame_ranges(ranges, partial_range,
+                              sizeof(partial_range) / sizeof(partial_range[0])));
+
+  /* Whitespace changes only count when not ignoring them. */
+  SVN_ERR(commit_blame_file(repos, "dave", "0\n1 \nX\n4\n", pool));
+  SVN_ERR(commit_blame_file(repos, "dave", "0\n1 \nX\n4\n5\n", pool));
+
+  diff_options = apr_array_make(pool, 1, sizeof(const char *));
+  APR_ARRAY_PUSH(diff_options, const char *) = "-w";
+
+  ranges = apr_array_make(pool, 0, sizeof(blame_range_t));
+  SVN_ERR(svn_repos_blame(repos, "/file", 0, 6, diff_options, NULL, NULL,
+                          blame_receiver, ranges, NULL, NULL, pool));
+  SVN_ERR(verify_blame_ranges(ranges, ignore_space,
+                              sizeof(ignore_space) / sizeof(ignore_space[0])));
+
+  /* Reverse ranges are not supported. */
+  SVN_TEST_ASSERT_ERROR(svn_repos_blame(repos, "/file", 4, 2, NULL,
+                                        NULL, NULL, blame_receiver, ranges,
+                                        NULL, NULL, pool),
+                        SVN_ERR_UNSUPPORTED_FEATURE);
+
+  return SVN_NO_ERROR;
+}
+
+/* Edit baton of the editor returned by get_recording_editor(). */
+typedef struct record_edit_baton_t
+{
+  /* The editor calls seen so far, as const char *. */
+  apr_array_header_t *calls;
+  apr_pool_t *pool;
+} record_edit_baton_t;
+
+/* Directory and file baton of the editor returned by
+   get_recording_editor(). */
+typedef struct record_node_baton_t
+{
+  record_edit_baton_t *eb;
+  const char *path;
+} record_node_baton_t;
+
+/* Append a description of an editor call, formatted like printf, to
+   EB->CALLS. */
+static void
+record_call(record_edit_baton_t *eb, const char *fmt, ...)
+{
+  va_list ap;
+
+  va_start(ap, fmt);
+  APR_ARRAY_PUSH(eb->calls, const char *) = apr_pvsprintf(eb->pool, fmt, ap);
+  va_end(ap);
+}
+
+/* Return a new record_node_baton_t for PATH within EB. */
+static record_node_baton_t *
+make_record_baton(record_edit_baton_t *eb, const char *path)
+{
+  record_node_baton_t *nb = apr_pcalloc(eb->pool, sizeof(*nb));
+
+  nb->eb = eb;
+  nb->path = apr_pstrdup(eb->pool, path);
+  return nb;
+}
+
+static svn_error_t *
+record_open_root(void *edit_baton,
+                 svn_revnum_t base_revision,
+                 apr_pool_t *result_pool,
+                 void **root_baton)
+{
+  record_call(edit_baton, "open_root %ld", base_revision);
+  *root_baton = make_record_baton(edit_baton, "");
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+record_delete_entry(const char *path,
+                    svn_revnum_t revision,
+                    void *parent_baton,
+                    apr_pool_t *scratch_pool)
+{
+  record_node_baton_t *pb = parent_baton;
+
+  record_call(pb->eb, "delete_entry %s %ld", path, revision);
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+record_add_node(const char *path,
+                void *parent_baton,
+                const char *copyfrom_path,
+                svn_revnum_t copyfrom_revision,
+                apr_pool_t *result_pool,
+                void **child_baton)
+{
+  record_node_baton_t *pb = parent_baton;
+
+  record_call(pb->eb, "add %s", path);
+  *child_baton = make_record_baton(pb->eb, path);
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+record_open_node(const char *path,
+                 void *parent_baton,
+                 svn_revnum_t base_revision,
+                 apr_pool_t *result_pool,
+                 void **child_baton)
+{
+  record_node_baton_t *pb = parent_baton;
+
+  record_call(pb->eb, "open %s %ld", path, base_revision);
+  *child_baton = make_record_baton(pb->eb, path);
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+record_change_prop(void *baton,
+                   const char *name,
+                   const svn_string_t *value,
+                   apr_pool_t *scratch_pool)
+{
+  record_node_baton_t *nb = baton;
+
+  record_call(nb->eb, "change_prop %s %s %s", nb->path, name,
+              value ? value->data : "(deleted)");
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+record_window(svn_txdelta_window_t *window,
+              void *baton)
+{
+  record_node_baton_t *nb = baton;
+
+  if (window)
+    record_call(nb->eb, "window %s %" APR_SIZE_T_FMT " %d", nb->path,
+                window->tview_len, window->num_ops);
+  else
+    record_call(nb->eb, "window %s end", nb->path);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+record_apply_textdelta(void *file_baton,
+                       const char *base_checksum,
+                       apr_pool_t *result_pool,
+                       svn_txdelta_window_handler_t *handler,
+                       void **handler_baton)
+{
+  record_node_baton_t *fb = file_baton;
+
+  record_call(fb->eb, "apply_textdelta %s %s", fb->path,
+              base_checksum ? base_checksum : "(none)");
+  *handler = record_window;
+  *handler_baton = fb;
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+record_close_node(void *baton,
+                  apr_pool_t *scratch_pool)
+{
+  record_node_baton_t *nb = baton;
+
+  record_call(nb->eb, "close %s", nb->path);
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+record_close_file(void *file_baton,
+                  const char *text_checksum,
+                  apr_pool_t *scratch_pool)
+{
+  record_node_baton_t *fb = file_baton;
+
+  record_call(fb->eb, "close %s %s", fb->path,
+              text_checksum ? text_checksum : "(none)");
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+record_close_edit(void *edit_baton,
+                  apr_pool_t *scratch_pool)
+{
+  record_call(edit_baton, "close_edit");
+  return SVN_NO_ERROR;
+}
+
+/* Return in *EDITOR and *EDIT_BATON an editor that appends a description
+   of every call made to it to CALLS, allocated in POOL. */
+static void
+get_recording_editor(const svn_delta_editor_t **editor,
+                     void **edit_baton,
+                     apr_array_header_t *calls,
+                     apr_pool_t *pool)
+{
+  svn_delta_editor_t *e = svn_delta_default_editor(pool);
+  record_edit_baton_t *eb = apr_pcalloc(pool, sizeof(*eb));
+
+  e->open_root = record_open_root;
+  e->delete_entry = record_delete_entry;
+  e->add_directory = record_add_node;
+  e->open_directory = record_open_node;
+  e->change_dir_prop = record_change_prop;
+  e->close_directory = record_close_node;
+  e->add_file = record_add_node;
+  e->open_file = record_open_node;
+  e->apply_textdelta = record_apply_textdelta;
+  e->change_file_prop = record_change_prop;
+  e->close_file = record_close_file;
+  e->close_edit = record_close_edit;
+
+  eb->calls = calls;
+  eb->pool = pool;
+
+  *editor = e;
+  *edit_baton = eb;
+}
+
+/* Drive EDITOR / EDIT_BATON with an update report from r1 to r2 of the
+   whole REPOS, using up to THREAD_COUNT threads. */
+static svn_error_t *
+report_r1_to_r2(svn_repos_t *repos,
+                const svn_delta_editor_t *editor,
+                void *edit_baton,
+                int thread_count,
+                apr_pool_t *pool)
+{
+  void *report_baton;
+
+  SVN_ERR(svn_repos_begin_report4(&report_baton, 2, repos, "/", "", NULL,
+                                  TRUE, svn_depth_infinity, FALSE, FALSE,
+                                  editor, edit_baton, NULL, NULL, 0,
+                                  thread_count, pool));
+  SVN_ERR(svn_repos_set_path3(report_baton, "", 1, svn_depth_infinity,
+                              FALSE, NULL, pool));
+  SVN_ERR(svn_repos_finish_report(report_baton, pool));
+
+  return SVN_NO_ERROR;
+}
+
+/* Test that an update report driven with several threads, i.e. with
+   prefetching of file data, gives the same result and the same editor
+   drive as the sequential one. */
+static svn_error_t *
+test_report_prefetch(const svn_test_opts_t *opts,
+                     apr_pool_t *pool)
+{
+  svn_repos_t *repos;
+  svn_fs_t *fs;
+  svn_fs_txn_t *txn;
+  svn_fs_root_t *txn_root;
+  svn_revnum_t youngest_rev;
+  const svn_delta_editor_t *editor;
+  void *edit_baton;
+  svn_test__tree_entry_t entries[13];
+  svn_string_t *value;
+  apr_array_header_t *sequential_calls = NULL;
+  int thread_count;
+  int i;
+
+  SVN_ERR(svn_test__create_repos(&repos, "test-repo-report-prefetch",
+                                 opts, pool));
+  fs = svn_repos_fs(repos);
+
+  /* Revision 1: a directory with enough files to trigger prefetching. */
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, 0, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  SVN_ERR(svn_fs_make_dir(txn_root, "dir", pool));
+  for (i = 0; i < 12; i++)
+    {
+      const char *path = apr_psprintf(pool, "dir/f%02d", i);
+      SVN_ERR(svn_fs_make_file(txn_root, path, pool));
+      SVN_ERR(svn_test__set_file_contents(txn_root, path,
+                                          apr_psprintf(pool,
+                                                       "This is file %d.\n",
+                                                       i),
+                                          pool));
+    }
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn, pool));
+  SVN_TEST_ASSERT(SVN_IS_VALID_REVNUM(youngest_rev));
+
+  /* Revision 2: change most files, delete one, add one and change a
+     property. */
+  SVN_ERR(svn_fs_begin_txn(&txn, fs, youngest_rev, pool));
+  SVN_ERR(svn_fs_txn_root(&txn_root, txn, pool));
+  for (i = 0; i < 10; i++)
+    SVN_ERR(svn_test__set_file_contents(txn_root,
+                                        apr_psprintf(pool, "dir/f%02d", i),
+                                        apr_psprintf(pool,
+                                                     "This is file %d.\n"
+                                                     "Changed in r2.\n", i),
+                                        pool));
+  SVN_ERR(svn_fs_delete(txn_root, "dir/f10", pool));
+  SVN_ERR(svn_fs_make_file(txn_root, "dir/f12", pool));
+  SVN_ERR(svn_test__set_file_contents(txn_root, "dir/f12",
+                                      "This is file 12.\n", pool));
+  SVN_ERR(svn_fs_change_node_prop(txn_root, "dir/f01", "prop",
+                                  svn_string_create("value", pool), pool));
+  SVN_ERR(svn_repos_fs_commit_txn(NULL, repos, &youngest_rev, txn, pool));
+  SVN_TEST_ASSERT(SVN_IS_VALID_REVNUM(youngest_rev));
+
+  /* The expected result of updating from r1 to r2:  f00 .. f09, f11 and
+     f12. */
+  entries[0].path = "dir";
+  entries[0].contents = NULL;
+  for (i = 0; i < 12; i++)
+    {
+      int n = i < 10 ? i : i + 1;
+
+      entries[i + 1].path = apr_psprintf(pool, "dir/f%02d", n);
+      entries[i + 1].contents
+        = apr_psprintf(pool, n < 10 ? "This is file %d.\nChanged in r2.\n"
+                                    : "This is file %d.\n", n);
+    }
+
+  /* Update from r1 to r2 sequentially and with prefetching. */
+  for (thread_count = 1; thread_count <= 4; thread_count *= 4)
+    {
+      apr_pool_t *subpool = svn_pool_create(pool);
+      apr_array_header_t *calls = apr_array_make(pool, 64,
+                                                 sizeof(const char *));
+      apr_uint32_t prefetched = svn_repos__report_prefetch_count();
+
+      /* Record the editor calls. */
+      get_recording_editor(&editor, &edit_baton, calls, pool);
+      SVN_ERR(report_r1_to_r2(repos, editor, edit_baton, thread_count,
+                              subpool));
+      prefetched = svn_repos__report_prefetch_count() - prefetched;
+
+      /* Only the threaded drive prefetches, and it must not change what
+         the editor sees. */
+      if (thread_count == 1)
+        {
+          SVN_TEST_INT_ASSERT(prefetched, 0);
+          sequential_calls = calls;
+        }
+      else
+        {
+          SVN_TEST_ASSERT(prefetched > 0);
+          SVN_TEST_INT_ASSERT(calls->nelts, sequential_calls->nelts);
+          for (i = 0; i < calls->nelts; i++)
+            SVN_TEST_STRING_ASSERT(APR_ARRAY_IDX(calls, i, const char *),
+                                   APR_ARRAY_IDX(sequential_calls, i,
+                                                 const char *));
+        }
+
+      /* Apply the edit to a temporary txn. */
+      SVN_ERR(svn_fs_begin_txn(&txn, fs, 1, subpool));
+      SVN_ERR(svn_fs_txn_root(&txn_root, txn, subpool));
+      SVN_ERR(dir_delta_get_editor(&editor, &edit_baton, fs,
+                                   txn_root, "", subpool));
+      SVN_ERR(report_r1_to_r2(repos, editor, edit_baton, thread_count,
+                              subpool));
+
+      SVN_ERR(svn_test__validate_tree(txn_root, entries,
+                                      sizeof(entries) / sizeof(entries[0]),
+                                      subpool));
+      SVN_ERR(svn_fs_node_prop(&value, txn_root, "dir/f01", "prop",
+                               subpool));
+      SVN_TEST_STRING_ASSERT(value ? value->data : NULL, "value");
+
+      SVN_ERR(svn_fs_abort_txn(txn, subpool));
+      svn_pool_destroy(subpool);
+    }
+
+  return SVN_NO_ERROR;
+}
+
 /* The test table.  */
 
 static int max_threads = 4;
@@ -4535,8 +5172,16 @@ static struct svn_test_descriptor_t test_funcs[] =
                    "test the different types of authz wildcards"),
     SVN_TEST_SKIP2(test_authz_wildcard_performance, TRUE,
                    "optional authz wildcard performance test"),
+    SVN_TEST_PASS2(test_authz_complex_patterns,
+                   "test authz patterns with multiple wildcards"),
+    SVN_TEST_SKIP2(test_authz_large_ruleset_performance, TRUE,
+                   "optional authz performance test with many rules"),
     SVN_TEST_OPTS_PASS(test_list,
                        "test svn_repos_list"),
+    SVN_TEST_OPTS_PASS(test_blame,
+                       "test svn_repos_blame"),
+    SVN_TEST_OPTS_PASS(test_report_prefetch,
+                       "test prefetching in the reporter"),
     SVN_TEST_NULL
   };
 
@@ -28,8 +28,11 @@
 #include <apr_time.h>
 
 #include "svn_pools.h"
+#include "svn_dirent_uri.h"
+#include "svn_io.h"
 
 #include "private/svn_cache.h"
+#include "private/svn_parallel.h"
 #include "svn_private_config.h"
 
 #include "../svn_test.h"
@@ -590,7 +593,372 @@ test_membuffer_unaligned_fixed_keys(apr_pool_t *pool)
   return SVN_NO_ERROR;
 }
 
+/* Baton for contention_task() and contention_output().
+ */
+typedef struct contention_baton_t
+{
+  /* The cache shared by all tasks. */
+  svn_membuffer_t *membuffer;
+
+  /* Keys are the revnums 0 .. KEY_COUNT-1. */
+  int key_count;
+
+  /* Number of cache accesses per task. */
+  int iterations;
+
+  /* Sum of cache hits over all tasks. */
+  apr_int64_t hits;
+} contention_baton_t;
+
+/* Implements svn_parallel__task_func_t.  Perform BATON->ITERATIONS random
+ * lookups in BATON->MEMBUFFER through our own front-end instance.  Every
+ * 16th access is a write.  Verify all values found and return the number
+ * of hits in *RESULT.
+ */
+static svn_error_t *
+contention_task(void **result,
+                void *baton,
+                int idx,
+                svn_cancel_func_t cancel_func,
+                void *cancel_baton,
+                apr_pool_t *result_pool,
+                apr_pool_t *scratch_pool)
+{
+  contention_baton_t *b = baton;
+  apr_pool_t *iterpool = svn_pool_create(scratch_pool);
+  apr_uint32_t seed = (apr_uint32_t)idx;
+  apr_int64_t *hits = apr_pcalloc(result_pool, sizeof(*hits));
+  svn_cache__t *cache;
+  int i;
+
+  SVN_ERR(svn_cache__create_membuffer_cache(&cache,
+                                            b->membuffer,
+                                            serialize_revnum,
+                                            deserialize_revnum,
+                                            sizeof(svn_revnum_t),
+                                            "contention:",
+                                            SVN_CACHE__MEMBUFFER_DEFAULT_PRIORITY,
+                                            FALSE,
+                                            FALSE,
+                                            scratch_pool, scratch_pool));
+
+  *result = hits;
+  for (i = 0; i < b->iterations; ++i)
+    {
+      svn_revnum_t key = svn_test_rand(&seed) % b->key_count;
+      svn_revnum_t value = 2 * key;
+      svn_revnum_t *found_value;
+      svn_boolean_t found;
+
+      svn_pool_clear(iterpool);
+
+      if (i % 16 == 0)
+        {
+          SVN_ERR(svn_cache__set(cache, &key, &value, iterpool));
+          continue;
+        }
+
+      SVN_ERR(svn_cache__get((void **)&found_value, &found, cache, &key,
+                             iterpool));
+      if (found)
+        {
+          SVN_TEST_ASSERT(*found_value == value);
+          ++*hits;
+        }
+    }
+
+  svn_pool_destroy(iterpool);
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_parallel__output_func_t.  Sum up the hits.
+ */
+static svn_error_t *
+contention_output(void *baton,
+                  int idx,
+                  void *result,
+                  svn_error_t *task_err,
+                  apr_pool_t *scratch_pool)
+{
+  contention_baton_t *b = baton;
+  SVN_ERR(task_err);
+
+  b->hits += *(apr_int64_t *)result;
+  return SVN_NO_ERROR;
+}
+
+/* Run contention_task() on THREAD_COUNT threads against a new membuffer
+ * cache with SEGMENT_COUNT segments.  Report the throughput if OPTS ask
+ * for verbose output.
+ */
+static svn_error_t *
+run_contention_test(const svn_test_opts_t *opts,
+                    apr_size_t segment_count,
+                    int thread_count,
+                    apr_pool_t *pool)
+{
+  contention_baton_t baton;
+  apr_time_t start;
+  apr_time_t duration;
+  void *unused;
+
+  baton.key_count = 1000;
+  baton.iterations = 20000;
+  baton.hits = 0;
+  SVN_ERR(svn_cache__membuffer_cache_create(&baton.membuffer, 1024 * 1024,
+                                            64 * 1024, segment_count,
+                                            TRUE, FALSE, pool));
+
+  /* Populate the cache such that most lookups will be hits. */
+  SVN_ERR(contention_task(&unused, &baton, 0, NULL, NULL, pool, pool));
+
+  start = apr_time_now();
+  SVN_ERR(svn_parallel__run(thread_count, thread_count, 0,
+                            contention_task, &baton,
+                            contention_output, &baton,
+                            NULL, NULL, pool));
+  duration = apr_time_now() - start;
+
+  /* Writes may get dropped under contention but reads must still hit. */
+  SVN_TEST_ASSERT(baton.hits > 0);
+
+  if (opts->verbose)
+    printf("%d threads, %s: %d accesses in %" APR_TIME_T_FMT " usec, "
+           "%" APR_INT64_T_FMT " hits\n",
+           thread_count,
+           segment_count == SVN_CACHE__MEMBUFFER_SCALE_SEGMENTS
+             ? "scaled segments"
+             : apr_psprintf(pool, "%" APR_SIZE_T_FMT " segment(s)",
+                            segment_count),
+           thread_count * baton.iterations, duration, baton.hits);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_membuffer_cache_contention(const svn_test_opts_t *opts,
+                                apr_pool_t *pool)
+{
+  /* Worst case: all threads access the same segment. */
+  SVN_ERR(run_contention_test(opts, 1, 8, pool));
+
+  /* Let the number of segments scale with the hardware threads. */
+  SVN_ERR(run_contention_test(opts, SVN_CACHE__MEMBUFFER_SCALE_SEGMENTS, 8,
+                              pool));
+
+  return SVN_NO_ERROR;
+}
+
+
 
+/* Open a persistent cache file in a new sandbox directory NAME and return
+ * it in *MMAP.  Return SVN_ERR_TEST_SKIPPED if that is not supported on
+ * this platform.
+ */
+static svn_error_t *
+open_mmap_cache(svn_cache__mmap_t **mmap,
+                const char *name,
+                apr_pool_t *pool)
+{
+  const char *sb_dir;
+  svn_error_t *err;
+
+  SVN_ERR(svn_test_make_sandbox_dir(&sb_dir, name, pool));
+  err = svn_cache__mmap_open(mmap, svn_dirent_join(sb_dir, "cache", pool),
+                             4 * 1024 * 1024, pool);
+  if (err && err->apr_err == SVN_ERR_UNSUPPORTED_FEATURE)
+    return svn_error_create(SVN_ERR_TEST_SKIPPED, err, NULL);
+
+  return svn_error_trace(err);
+}
+
+static svn_error_t *
+test_mmap_cache_basic(apr_pool_t *pool)
+{
+  svn_cache__t *cache;
+  svn_cache__mmap_t *mmap;
+
+  SVN_ERR(open_mmap_cache(&mmap, "mmap-cache-basic", pool));
+  SVN_ERR(svn_cache__create_mmap_cache(&cache, mmap, NULL,
+                                       serialize_revnum,
+                                       deserialize_revnum,
+                                       APR_HASH_KEY_STRING,
+                                       "cache:",
+                                       pool));
+
+  return basic_cache_test(cache, FALSE, pool);
+}
+
+/* Create a membuffer cache instance for revnums in *CACHE_P. */
+static svn_error_t *
+create_l1_cache(svn_cache__t **cache_p,
+                apr_pool_t *pool)
+{
+  svn_membuffer_t *membuffer;
+
+  SVN_ERR(svn_cache__membuffer_cache_create(&membuffer, 10*1024, 1, 0,
+                                            TRUE, TRUE, pool));
+  SVN_ERR(svn_cache__create_membuffer_cache(cache_p, membuffer,
+                                            serialize_revnum,
+                                            deserialize_revnum,
+                                            sizeof(svn_revnum_t), "l1:",
+                                            SVN_CACHE__MEMBUFFER_DEFAULT_PRIORITY,
+                                            FALSE, FALSE, pool, pool));
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_mmap_cache_two_level(apr_pool_t *pool)
+{
+  svn_cache__t *cache;
+  svn_cache__t *l1;
+  svn_cache__mmap_t *mmap;
+  svn_cache__mmap_t *mmap2;
+  svn_revnum_t key = 42;
+  svn_revnum_t value = 4711;
+  svn_revnum_t *found_value;
+  svn_boolean_t found;
+
+  SVN_ERR(open_mmap_cache(&mmap, "mmap-cache-two-level", pool));
+
+  /* Write through both levels. */
+  SVN_ERR(create_l1_cache(&l1, pool));
+  SVN_ERR(svn_cache__create_mmap_cache(&cache, mmap, l1,
+                                       serialize_revnum,
+                                       deserialize_revnum,
+                                       sizeof(key), "l2:", pool));
+  SVN_ERR(svn_cache__set(cache, &key, &value, pool));
+
+  /* Simulate a restart: new, empty first level over the same file. */
+  SVN_ERR(create_l1_cache(&l1, pool));
+  SVN_ERR(svn_cache__get((void **)&found_value, &found, l1, &key, pool));
+  SVN_TEST_ASSERT(!found);
+
+  SVN_ERR(svn_cache__create_mmap_cache(&cache, mmap, l1,
+                                       serialize_revnum,
+                                       deserialize_revnum,
+                                       sizeof(key), "l2:", pool));
+  SVN_ERR(svn_cache__get((void **)&found_value, &found, cache, &key, pool));
+  SVN_TEST_ASSERT(found);
+  SVN_TEST_ASSERT(*found_value == value);
+
+  /* The second level hit must have been copied into the first level. */
+  SVN_ERR(svn_cache__get((void **)&found_value, &found, l1, &key, pool));
+  SVN_TEST_ASSERT(found);
+  SVN_TEST_ASSERT(*found_value == value);
+
+  /* Different prefixes don't see each other's data. */
+  SVN_ERR(svn_cache__create_mmap_cache(&cache, mmap, NULL,
+                                       serialize_revnum,
+                                       deserialize_revnum,
+                                       sizeof(key), "other:", pool));
+  SVN_ERR(svn_cache__has_key(&found, cache, &key, pool));
+  SVN_TEST_ASSERT(!found);
+
+  /* Opening the same file again must return the same handle. */
+  SVN_ERR(svn_cache__mmap_open(&mmap2,
+                               svn_dirent_join(
+                                 svn_test_data_path("mmap-cache-two-level",
+                                                    pool),
+                                 "cache", pool),
+                               0, pool));
+  SVN_TEST_ASSERT(mmap2 == mmap);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_mmap_cache_corruption(apr_pool_t *pool)
+{
+  svn_cache__t *cache;
+  svn_cache__mmap_t *mmap;
+  svn_stringbuf_t *value
+    = svn_stringbuf_create("persistent cache test value", pool);
+  svn_stringbuf_t *found_value;
+  svn_stringbuf_t *contents;
+  svn_boolean_t found;
+  const char *path;
+  apr_file_t *file;
+  apr_off_t offset;
+  char byte = 'X';
+
+  SVN_ERR(open_mmap_cache(&mmap, "mmap-cache-corruption", pool));
+  SVN_ERR(svn_cache__create_mmap_cache(&cache, mmap, NULL, NULL, NULL,
+                                       APR_HASH_KEY_STRING, "corrupt:",
+                                       pool));
+  SVN_ERR(svn_cache__set(cache, "key", value, pool));
+  SVN_ERR(svn_cache__get((void **)&found_value, &found, cache, "key", pool));
+  SVN_TEST_ASSERT(found);
+  SVN_TEST_STRING_ASSERT(found_value->data, value->data);
+
+  /* Damage the stored value behind the cache's back, as a writer dying
+   * halfway through the record would. */
+  path = svn_dirent_join(svn_test_data_path("mmap-cache-corruption", pool),
+                         "cache", pool);
+  SVN_ERR(svn_stringbuf_from_file2(&contents, path, pool));
+  for (offset = 0; offset + value->len <= contents->len; ++offset)
+    if (!memcmp(contents->data + offset, value->data, value->len))
+      break;
+  SVN_TEST_ASSERT(offset + value->len <= contents->len);
+
+  SVN_ERR(svn_io_file_open(&file, path, APR_WRITE | APR_BINARY,
+                           APR_OS_DEFAULT, pool));
+  SVN_ERR(svn_io_file_seek(file, APR_SET, &offset, pool));
+  SVN_ERR(svn_io_file_write_full(file, &byte, 1, NULL, pool));
+  SVN_ERR(svn_io_file_close(file, pool));
+
+  /* The checksum no longer matches. */
+  SVN_ERR(svn_cache__get((void **)&found_value, &found, cache, "key", pool));
+  SVN_TEST_ASSERT(!found);
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_cache__partial_setter_func_t.
+ * Overwrite the first byte of the serialized value. */
+static svn_error_t *
+patch_first_byte(void **data,
+                 apr_size_t *data_len,
+                 void *baton,
+                 apr_pool_t *result_pool)
+{
+  *(char *)*data = 'X';
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_mmap_cache_set_partial(apr_pool_t *pool)
+{
+  svn_cache__t *cache;
+  svn_cache__mmap_t *mmap;
+  svn_stringbuf_t *value
+    = svn_stringbuf_create("persistent cache test value", pool);
+  svn_stringbuf_t *found_value;
+  svn_boolean_t found;
+
+  SVN_ERR(open_mmap_cache(&mmap, "mmap-cache-set-partial", pool));
+  SVN_ERR(svn_cache__create_mmap_cache(&cache, mmap, NULL, NULL, NULL,
+                                       APR_HASH_KEY_STRING, "partial:",
+                                       pool));
+  SVN_ERR(svn_cache__set(cache, "key", value, pool));
+
+  /* The shared record must not be patched but dropped. */
+  SVN_ERR(svn_cache__set_partial(cache, "key", patch_first_byte, NULL,
+                                 pool));
+  SVN_ERR(svn_cache__get((void **)&found_value, &found, cache, "key", pool));
+  SVN_TEST_ASSERT(!found);
+
+  /* Setting the key again works as usual. */
+  SVN_ERR(svn_cache__set(cache, "key", value, pool));
+  SVN_ERR(svn_cache__get((void **)&found_value, &found, cache, "key", pool));
+  SVN_TEST_ASSERT(found);
+  SVN_TEST_STRING_ASSERT(found_value->data, value->data);
+
+  return SVN_NO_ERROR;
+}
+
+
 /* The test table.  */
 
 static int max_threads = 1;
@@ -616,6 +984,16 @@ static struct svn_test_descriptor_t test_funcs[] =
                    "test membuffer cache with unaligned string keys"),
     SVN_TEST_PASS2(test_membuffer_unaligned_fixed_keys,
                    "test membuffer cache with unaligned fixed keys"),
+    SVN_TEST_OPTS_PASS(test_membuffer_cache_contention,
+                       "concurrent membuffer cache reads and writes"),
+    SVN_TEST_PASS2(test_mmap_cache_basic,
+                   "basic persistent svn_cache test"),
+    SVN_TEST_PASS2(test_mmap_cache_two_level,
+                   "persistent svn_cache behind a membuffer cache"),
+    SVN_TEST_PASS2(test_mmap_cache_corruption,
+                   "damaged persistent svn_cache records are misses"),
+    SVN_TEST_PASS2(test_mmap_cache_set_partial,
+                   "partial updates drop persistent svn_cache records"),
     SVN_TEST_NULL
   };
 
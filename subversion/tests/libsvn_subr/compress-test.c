@@ -25,6 +25,14 @@
 #include "private/svn_subr_private.h"
 #include "../svn_test.h"
 
+#include "svn_private_config.h"
+
+#ifdef SVN_HAVE_ZSTD
+#define ZSTD_MISSING FALSE
+#else
+#define ZSTD_MISSING TRUE
+#endif
+
 static svn_error_t *
 test_decompress_lz4(apr_pool_t *pool)
 {
@@ -76,6 +84,76 @@ test_compress_lz4_empty(apr_pool_t *pool)
   return SVN_NO_ERROR;
 }
 
+static svn_error_t *
+test_compress_zstd(apr_pool_t *pool)
+{
+  const char input[] =
+    "aaaabbbbccccaaaaccccbbbbaaaabbbb"
+    "aaaabbbbccccaaaaccccbbbbaaaabbbb"
+    "aaaabbbbccccaaaaccccbbbbaaaabbbb";
+  const int levels[] = { SVN__COMPRESSION_ZSTD_MIN,
+                         SVN__COMPRESSION_ZSTD_DEFAULT,
+                         SVN__COMPRESSION_ZSTD_MAX,
+                         SVN__COMPRESSION_ZSTD_MAX + 100 };
+  svn_stringbuf_t *compressed = svn_stringbuf_create_empty(pool);
+  svn_stringbuf_t *decompressed = svn_stringbuf_create_empty(pool);
+  apr_size_t i;
+
+  for (i = 0; i < sizeof(levels) / sizeof(levels[0]); i++)
+    {
+      SVN_ERR(svn__compress_zstd(input, sizeof(input), compressed,
+                                 levels[i]));
+      SVN_TEST_ASSERT(compressed->len < sizeof(input));
+      SVN_ERR(svn__decompress_zstd(compressed->data, compressed->len,
+                                   decompressed, 100));
+      SVN_TEST_STRING_ASSERT(decompressed->data, input);
+    }
+
+  /* Decompression must enforce the size limit. */
+  SVN_TEST_ASSERT_ERROR(svn__decompress_zstd(compressed->data,
+                                             compressed->len,
+                                             decompressed, 10),
+                        SVN_ERR_SVNDIFF_INVALID_COMPRESSED_DATA);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_compress_zstd_empty(apr_pool_t *pool)
+{
+  svn_stringbuf_t *compressed = svn_stringbuf_create_empty(pool);
+  svn_stringbuf_t *decompressed = svn_stringbuf_create_empty(pool);
+
+  SVN_ERR(svn__compress_zstd("", 0, compressed,
+                             SVN__COMPRESSION_ZSTD_DEFAULT));
+  SVN_ERR(svn__decompress_zstd(compressed->data, compressed->len,
+                               decompressed, 100));
+  SVN_TEST_STRING_ASSERT(decompressed->data, "");
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_compress_zstd_none(apr_pool_t *pool)
+{
+  const char input[] = "aaaabbbbccccaaaaccccbbbbaaaabbbb";
+  svn_stringbuf_t *compressed = svn_stringbuf_create_empty(pool);
+  svn_stringbuf_t *decompressed = svn_stringbuf_create_empty(pool);
+
+  /* Without compression, the data gets stored as-is after the length
+     prefix. */
+  SVN_ERR(svn__compress_zstd(input, sizeof(input), compressed,
+                             SVN__COMPRESSION_NONE));
+  SVN_TEST_ASSERT(compressed->len == sizeof(input) + 1);
+  SVN_TEST_ASSERT(memcmp(compressed->data + 1, input, sizeof(input)) == 0);
+
+  SVN_ERR(svn__decompress_zstd(compressed->data, compressed->len,
+                               decompressed, 100));
+  SVN_TEST_STRING_ASSERT(decompressed->data, input);
+
+  return SVN_NO_ERROR;
+}
+
 static int max_threads = -1;
 
 static struct svn_test_descriptor_t test_funcs[] =
@@ -87,6 +165,12 @@ static struct svn_test_descriptor_t test_funcs[] =
                  "test svn__compress_lz4()"),
   SVN_TEST_PASS2(test_compress_lz4_empty,
                  "test svn__compress_lz4() with empty input"),
+  SVN_TEST_SKIP2(test_compress_zstd, ZSTD_MISSING,
+                 "test svn__compress_zstd()"),
+  SVN_TEST_SKIP2(test_compress_zstd_empty, ZSTD_MISSING,
+                 "test svn__compress_zstd() with empty input"),
+  SVN_TEST_SKIP2(test_compress_zstd_none, ZSTD_MISSING,
+                 "test svn__compress_zstd() without compression"),
   SVN_TEST_NULL
 };
 
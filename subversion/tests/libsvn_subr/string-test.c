@@ -872,6 +872,47 @@ test_string_matching(apr_pool_t *pool)
   return SVN_NO_ERROR;
 }
 
+/* Like test_string_matching but with strings long enough to exercise
+ * the chunky code paths, with a single difference at every position.
+ */
+static svn_error_t *
+test_long_string_matching(apr_pool_t *pool)
+{
+  enum { LEN = 100 };
+  char a[LEN];
+  char b[LEN];
+  apr_size_t i;
+  apr_size_t diff;
+  apr_size_t max_len;
+
+  for (i = 0; i < LEN; ++i)
+    a[i] = (char)('a' + i % 26);
+
+  for (diff = 0; diff <= LEN; ++diff)
+    {
+      memcpy(b, a, LEN);
+      if (diff < LEN)
+        b[diff] = '_';
+
+      for (max_len = 0; max_len <= LEN; ++max_len)
+        {
+          /* Number of matching chars from the start and from the end. */
+          apr_size_t match_len = MIN(diff, max_len);
+          apr_size_t rmatch_len = diff < LEN
+                                ? MIN(LEN - diff - 1, max_len)
+                                : max_len;
+
+          SVN_TEST_ASSERT(svn_cstring__match_length(a, b, max_len)
+                          == match_len);
+          SVN_TEST_ASSERT(svn_cstring__reverse_match_length(a + LEN, b + LEN,
+                                                            max_len)
+                          == rmatch_len);
+        }
+    }
+
+  return SVN_NO_ERROR;
+}
+
 static svn_error_t *
 test_cstring_skip_prefix(apr_pool_t *pool)
 {
@@ -1151,6 +1192,8 @@ static struct svn_test_descriptor_t test_funcs[] =
                    "test svn_stringbuf_set()"),
     SVN_TEST_PASS2(test_cstring_join,
                    "test svn_cstring_join2()"),
+    SVN_TEST_PASS2(test_long_string_matching,
+                   "test string matching with long strings"),
     SVN_TEST_NULL
   };
 
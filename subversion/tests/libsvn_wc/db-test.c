@@ -1525,6 +1525,124 @@ test_externals_store(apr_pool_t *pool)
   return SVN_NO_ERROR;
 }
 
+static svn_error_t *
+test_prefetch_children(apr_pool_t *pool)
+{
+  const char *local_abspath;
+  const char *a_abspath;
+  const char *f_abspath;
+  const char *g_abspath;
+  svn_wc__db_t *db;
+  svn_wc__db_t *db2;
+  apr_pool_t *dir_pool = svn_pool_create(pool);
+  svn_wc__db_status_t status;
+  svn_node_kind_t kind;
+  svn_revnum_t revision;
+  const char *repos_relpath;
+  const char *repos_root_url;
+  const svn_checksum_t *checksum;
+  svn_filesize_t recorded_size;
+  apr_time_t recorded_time;
+  svn_boolean_t have_base;
+  svn_boolean_t props_mod;
+  apr_hash_t *props;
+
+  SVN_ERR(create_open(&db, &local_abspath, "test_prefetch_children", pool));
+  a_abspath = svn_dirent_join(local_abspath, "A", pool);
+  f_abspath = svn_dirent_join(local_abspath, "F", pool);
+  g_abspath = svn_dirent_join(local_abspath, "G", pool);
+
+  SVN_ERR(svn_wc__db_prefetch_children(db, local_abspath, dir_pool, pool));
+
+  /* Test: the children are read from the cache like from the database. */
+  SVN_ERR(svn_wc__db_read_info(&status, &kind, &revision, &repos_relpath,
+                               &repos_root_url, NULL, NULL, NULL, NULL, NULL,
+                               &checksum, NULL, NULL, NULL, NULL, NULL, NULL,
+                               &recorded_size, &recorded_time, NULL, NULL,
+                               NULL, NULL, NULL, &have_base, NULL, NULL,
+                               db, a_abspath, pool, pool));
+  SVN_TEST_ASSERT(status == svn_wc__db_status_normal);
+  SVN_TEST_ASSERT(kind == svn_node_file);
+  SVN_TEST_ASSERT(revision == 1);
+  SVN_TEST_STRING_ASSERT(repos_relpath, "A");
+  SVN_TEST_STRING_ASSERT(repos_root_url, ROOT_ONE);
+  SVN_TEST_STRING_ASSERT(SHA1_1, svn_checksum_to_cstring(checksum, pool));
+  SVN_TEST_ASSERT(recorded_size == 10);
+  SVN_TEST_ASSERT(recorded_time == 10);
+  SVN_TEST_ASSERT(have_base);
+
+  SVN_ERR(svn_wc__db_base_get_info(&status, &kind, NULL, &repos_relpath,
+                                   NULL, NULL, NULL, NULL, NULL, NULL, NULL,
+                                   NULL, NULL, NULL, NULL, NULL,
+                                   db, svn_dirent_join(local_abspath, "B",
+                                                       pool),
+                                   pool, pool));
+  SVN_TEST_ASSERT(status == svn_wc__db_status_excluded);
+  SVN_TEST_ASSERT(kind == svn_node_symlink);
+  SVN_TEST_STRING_ASSERT(repos_relpath, "B");
+
+  /* Test: changes to the children are not hidden by the cache. */
+  SVN_ERR(svn_wc__db_global_record_fileinfo(db, a_abspath, 20, 30, pool));
+  SVN_ERR(svn_wc__db_read_info(NULL, NULL, NULL, NULL, NULL, NULL, NULL,
+                               NULL, NULL, NULL, NULL, NULL, NULL, NULL,
+                               NULL, NULL, NULL, &recorded_size,
+                               &recorded_time, NULL, NULL, NULL, NULL, NULL,
+                               NULL, NULL, NULL,
+                               db, a_abspath, pool, pool));
+  SVN_TEST_ASSERT(recorded_size == 20);
+  SVN_TEST_ASSERT(recorded_time == 30);
+
+  /* Test: a change made without telling the cache is not hidden by a
+     later change that does. */
+  SVN_ERR(svn_wc__db_read_info(NULL, NULL, NULL, NULL, NULL, NULL, NULL,
+                               NULL, NULL, NULL, NULL, NULL, NULL, NULL,
+                               NULL, NULL, NULL, NULL, NULL, NULL, NULL,
+                               NULL, NULL, &props_mod, NULL, NULL, NULL,
+                               db, f_abspath, pool, pool));
+  SVN_TEST_ASSERT(!props_mod);
+
+  props = apr_hash_make(pool);
+  set_prop(props, "p1", "v1", pool);
+  SVN_ERR(svn_wc__db_op_set_props(db, f_abspath, props, FALSE, NULL, NULL,
+                                  pool));
+  SVN_ERR(svn_wc__db_global_record_fileinfo(db, a_abspath, 40, 50, pool));
+  SVN_ERR(svn_wc__db_read_info(NULL, NULL, NULL, NULL, NULL, NULL, NULL,
+                               NULL, NULL, NULL, NULL, NULL, NULL, NULL,
+                               NULL, NULL, NULL, NULL, NULL, NULL, NULL,
+                               NULL, NULL, &props_mod, NULL, NULL, NULL,
+                               db, f_abspath, pool, pool));
+  SVN_TEST_ASSERT(props_mod);
+
+  /* Test: the cache goes away with its pool.  Changes made through
+     another svn_wc__db_t are not noticed while the cache is around but
+     become visible once it is gone. */
+  SVN_ERR(svn_wc__db_prefetch_children(db, local_abspath, dir_pool, pool));
+  SVN_ERR(svn_wc__db_open(&db2, NULL, FALSE, TRUE, pool, pool));
+  SVN_ERR(svn_wc__db_global_record_fileinfo(db2, g_abspath, 60, 70, pool));
+  SVN_ERR(svn_wc__db_close(db2));
+
+  SVN_ERR(svn_wc__db_read_info(NULL, NULL, NULL, NULL, NULL, NULL, NULL,
+                               NULL, NULL, NULL, NULL, NULL, NULL, NULL,
+                               NULL, NULL, NULL, &recorded_size,
+                               &recorded_time, NULL, NULL, NULL, NULL, NULL,
+                               NULL, NULL, NULL,
+                               db, g_abspath, pool, pool));
+  SVN_TEST_ASSERT(recorded_size != 60);
+  SVN_TEST_ASSERT(recorded_time != 70);
+
+  svn_pool_destroy(dir_pool);
+  SVN_ERR(svn_wc__db_read_info(NULL, NULL, NULL, NULL, NULL, NULL, NULL,
+                               NULL, NULL, NULL, NULL, NULL, NULL, NULL,
+                               NULL, NULL, NULL, &recorded_size,
+                               &recorded_time, NULL, NULL, NULL, NULL, NULL,
+                               NULL, NULL, NULL,
+                               db, g_abspath, pool, pool));
+  SVN_TEST_ASSERT(recorded_size == 60);
+  SVN_TEST_ASSERT(recorded_time == 70);
+
+  return SVN_NO_ERROR;
+}
+
 static int max_threads = 2;
 
 static struct svn_test_descriptor_t test_funcs[] =
@@ -1550,6 +1668,8 @@ static struct svn_test_descriptor_t test_funcs[] =
                    "work queue processing"),
     SVN_TEST_PASS2(test_externals_store,
                    "externals store"),
+    SVN_TEST_PASS2(test_prefetch_children,
+                   "reading ahead the children of a directory"),
     SVN_TEST_NULL
   };
 
@@ -39,6 +39,7 @@
 #include "svn_repos.h"
 #include "svn_wc.h"
 #include "svn_client.h"
+#include "svn_config.h"
 
 #include "utils.h"
 
@@ -306,6 +307,213 @@ reject_mismatching_text(const svn_test_opts_t *opts,
 #endif
 }
 
+/* Install the pristine text DATA into the working copy at WC_ABSPATH via
+ * DB, and return its SHA-1 checksum in *DATA_SHA1. */
+static svn_error_t *
+install_text(svn_checksum_t **data_sha1,
+             svn_wc__db_t *db,
+             const char *wc_abspath,
+             const char *data,
+             apr_pool_t *pool)
+{
+  svn_wc__db_install_data_t *install_data;
+  svn_stream_t *pristine_stream;
+  svn_checksum_t *data_md5;
+  apr_size_t sz;
+
+  SVN_ERR(svn_wc__db_pristine_prepare_install(&pristine_stream,
+                                              &install_data,
+                                              data_sha1, &data_md5,
+                                              db, wc_abspath,
+                                              pool, pool));
+
+  sz = strlen(data);
+  SVN_ERR(svn_stream_write(pristine_stream, data, &sz));
+  SVN_ERR(svn_stream_close(pristine_stream));
+
+  return svn_error_trace(svn_wc__db_pristine_install(install_data,
+                                                     *data_sha1, data_md5,
+                                                     pool));
+}
+
+/* Test sharing pristine texts between two working copies. */
+static svn_error_t *
+shared_pristine_store(const svn_test_opts_t *opts,
+                      apr_pool_t *pool)
+{
+  svn_test__sandbox_t b1, b2;
+  svn_config_t *config;
+  svn_wc__db_t *db;
+  const char *store_abspath;
+  svn_stream_t *contents;
+  svn_checksum_t *data_sha1, *data_sha1_2;
+
+  const char data[] = "Shared blah";
+
+  SVN_ERR(svn_test__sandbox_create(&b1, "shared_pristine_store_1",
+                                   opts, pool));
+  SVN_ERR(svn_test__sandbox_create(&b2, "shared_pristine_store_2",
+                                   opts, pool));
+
+  store_abspath = svn_test_data_path("shared_pristine_store", pool);
+  SVN_ERR(svn_io_remove_dir2(store_abspath, TRUE, NULL, NULL, pool));
+  svn_test_add_dir_cleanup(store_abspath);
+
+  SVN_ERR(svn_config_create2(&config, FALSE, FALSE, pool));
+  svn_config_set(config, SVN_CONFIG_SECTION_WORKING_COPY,
+                 SVN_CONFIG_OPTION_WC_SHARED_PRISTINE_STORE, store_abspath);
+  SVN_ERR(svn_wc__db_open(&db, config, FALSE, TRUE, pool, pool));
+  SVN_TEST_STRING_ASSERT(svn_wc__db_get_shared_pristine_store(db),
+                         store_abspath);
+
+  /* The first install publishes the text in the store. */
+  SVN_ERR(install_text(&data_sha1, db, b1.wc_abspath, data, pool));
+  SVN_ERR(svn_wc__db_pristine_read_shared(&contents, db, data_sha1,
+                                          pool, pool));
+  SVN_TEST_ASSERT(contents != NULL);
+  {
+    svn_stringbuf_t *buf;
+
+    SVN_ERR(svn_stringbuf_from_stream(&buf, contents, 0, pool));
+    SVN_TEST_STRING_ASSERT(buf->data, data);
+  }
+
+  /* The second working copy gets the same text from the store. */
+  SVN_ERR(install_text(&data_sha1_2, db, b2.wc_abspath, data, pool));
+  SVN_TEST_ASSERT(svn_checksum_match(data_sha1, data_sha1_2));
+  {
+    svn_stream_t *data_read_back;
+    svn_boolean_t same;
+
+    SVN_ERR(svn_wc__db_pristine_read(&data_read_back, NULL, db,
+                                     b2.wc_abspath, data_sha1, pool, pool));
+    SVN_ERR(svn_stream_contents_same2(&same, data_read_back,
+                                      svn_stream_from_string(
+                                        svn_string_create(data, pool), pool),
+                                      pool));
+    SVN_TEST_ASSERT(same);
+  }
+
+  /* ... and really shares it: the store and both working copies link to
+   * the same file. */
+  {
+    const char *pristine_abspath;
+    apr_finfo_t finfo;
+
+    SVN_ERR(svn_wc__db_pristine_get_path(&pristine_abspath, db,
+                                         b2.wc_abspath, data_sha1,
+                                         pool, pool));
+    SVN_ERR(svn_io_stat(&finfo, pristine_abspath, APR_FINFO_NLINK, pool));
+#ifndef WIN32
+    SVN_TEST_ASSERT(finfo.valid & APR_FINFO_NLINK);
+#endif
+    if (finfo.valid & APR_FINFO_NLINK)
+      SVN_TEST_INT_ASSERT(finfo.nlink, 3);
+  }
+
+  /* Texts that are still referenced survive pruning. */
+  SVN_ERR(svn_wc__db_pristine_prune_shared(db, NULL, NULL, pool));
+  SVN_ERR(svn_wc__db_pristine_read_shared(&contents, db, data_sha1,
+                                          pool, pool));
+  SVN_TEST_ASSERT(contents != NULL);
+  SVN_ERR(svn_stream_close(contents));
+
+  /* Once both working copies dropped it, pruning removes it, as long as
+   * the file system supports counting the hard links. */
+  SVN_ERR(svn_wc__db_pristine_remove(db, b1.wc_abspath, data_sha1, pool));
+  SVN_ERR(svn_wc__db_pristine_remove(db, b2.wc_abspath, data_sha1, pool));
+  SVN_ERR(svn_wc__db_pristine_read_shared(&contents, db, data_sha1,
+                                          pool, pool));
+  SVN_TEST_ASSERT(contents != NULL);
+  SVN_ERR(svn_stream_close(contents));
+
+  SVN_ERR(svn_wc__db_pristine_prune_shared(db, NULL, NULL, pool));
+  SVN_ERR(svn_wc__db_pristine_read_shared(&contents, db, data_sha1,
+                                          pool, pool));
+#ifndef WIN32
+  SVN_TEST_ASSERT(contents == NULL);
+#endif
+
+  SVN_ERR(svn_wc__db_close(db));
+
+  return SVN_NO_ERROR;
+}
+
+/* Test that texts planted in the shared pristine store by somebody else
+ * don't end up in a working copy. */
+static svn_error_t *
+shared_pristine_store_planted(const svn_test_opts_t *opts,
+                              apr_pool_t *pool)
+{
+  svn_test__sandbox_t b;
+  svn_config_t *config;
+  svn_wc__db_t *db;
+  svn_wc_context_t *wc_ctx;
+  svn_stream_t *contents;
+  const char *store_abspath;
+  const char *planted_abspath;
+  const char *pristine_abspath;
+  const char *hexdigest;
+  svn_checksum_t *data_sha1, *installed_sha1;
+  svn_stringbuf_t *buf;
+  apr_finfo_t finfo;
+
+  /* Same size, different content. */
+  const char data[] = "Honest blah";
+  const char planted[] = "Planted bla";
+
+  SVN_ERR(svn_test__sandbox_create(&b, "shared_pristine_store_planted",
+                                   opts, pool));
+
+  store_abspath = svn_test_data_path("shared_pristine_store_planted", pool);
+  SVN_ERR(svn_io_remove_dir2(store_abspath, TRUE, NULL, NULL, pool));
+  svn_test_add_dir_cleanup(store_abspath);
+
+  SVN_ERR(svn_config_create2(&config, FALSE, FALSE, pool));
+  svn_config_set(config, SVN_CONFIG_SECTION_WORKING_COPY,
+                 SVN_CONFIG_OPTION_WC_SHARED_PRISTINE_STORE, store_abspath);
+  SVN_ERR(svn_wc__db_open(&db, config, FALSE, TRUE, pool, pool));
+
+  /* Put the wrong content under the name of DATA's checksum. */
+  SVN_ERR(svn_checksum(&data_sha1, svn_checksum_sha1, data, strlen(data),
+                       pool));
+  hexdigest = svn_checksum_to_cstring(data_sha1, pool);
+  planted_abspath = svn_dirent_join_many(pool, store_abspath,
+                                         apr_pstrndup(pool, hexdigest, 2),
+                                         apr_pstrcat(pool, hexdigest,
+                                                     ".svn-base",
+                                                     SVN_VA_NULL),
+                                         SVN_VA_NULL);
+  SVN_ERR(svn_io_make_dir_recursively(svn_dirent_dirname(planted_abspath,
+                                                         pool),
+                                      pool));
+  SVN_ERR(svn_io_file_create(planted_abspath, planted, pool));
+
+  /* Reading DATA without a working copy, as for 'svn cat URL', must not
+     serve the planted file. */
+  SVN_ERR(svn_wc__context_create_with_db(&wc_ctx, config, db, pool));
+  SVN_ERR(svn_wc__get_pristine_contents_by_checksum(&contents, wc_ctx, NULL,
+                                                    data_sha1, pool, pool));
+  SVN_TEST_ASSERT(contents == NULL);
+
+  /* Installing DATA must ignore the planted file. */
+  SVN_ERR(install_text(&installed_sha1, db, b.wc_abspath, data, pool));
+  SVN_TEST_ASSERT(svn_checksum_match(data_sha1, installed_sha1));
+
+  SVN_ERR(svn_wc__db_pristine_get_path(&pristine_abspath, db, b.wc_abspath,
+                                       data_sha1, pool, pool));
+  SVN_ERR(svn_stringbuf_from_file2(&buf, pristine_abspath, pool));
+  SVN_TEST_STRING_ASSERT(buf->data, data);
+
+  SVN_ERR(svn_io_stat(&finfo, pristine_abspath, APR_FINFO_NLINK, pool));
+  if (finfo.valid & APR_FINFO_NLINK)
+    SVN_TEST_INT_ASSERT(finfo.nlink, 1);
+
+  SVN_ERR(svn_wc__db_close(db));
+
+  return SVN_NO_ERROR;
+}
+
 
 static int max_threads = -1;
 
@@ -318,6 +526,10 @@ static struct svn_test_descriptor_t test_funcs[] =
                        "pristine_delete_while_open"),
     SVN_TEST_OPTS_PASS(reject_mismatching_text,
                        "reject_mismatching_text"),
+    SVN_TEST_OPTS_PASS(shared_pristine_store,
+                       "shared pristine store across working copies"),
+    SVN_TEST_OPTS_PASS(shared_pristine_store_planted,
+                       "ignore texts planted in the shared store"),
     SVN_TEST_NULL
   };
 
@@ -35,12 +35,15 @@
 #include "svn_wc.h"
 #include "svn_client.h"
 #include "svn_hash.h"
+#include "svn_props.h"
 
 #include "utils.h"
 
 #include "private/svn_wc_private.h"
 #include "private/svn_sqlite.h"
 #include "private/svn_dep_compat.h"
+#include "private/svn_atomic.h"
+#include "private/svn_mutex.h"
 #include "../../libsvn_wc/wc.h"
 #include "../../libsvn_wc/wc_db.h"
 #define SVN_WC__I_AM_WC_DB
@@ -493,6 +496,425 @@ test_internal_file_modified(const svn_test_opts_t *opts, apr_pool_t *pool)
   return SVN_NO_ERROR;
 }
 
+static svn_error_t *
+test_parallel_file_install(const svn_test_opts_t *opts, apr_pool_t *pool)
+{
+  svn_test__sandbox_t b;
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  const char *files[] = { "iota", "A/mu", "A/B/lambda", "A/B/E/alpha",
+                          "A/B/E/beta", "A/D/gamma", "A/D/G/pi",
+                          "A/D/G/rho", "A/D/G/tau", "A/D/H/chi",
+                          "A/D/H/omega", "A/D/H/psi", NULL };
+  int i;
+
+  SVN_ERR(svn_test__sandbox_create(&b, "parallel_file_install",
+                                   opts, pool));
+  SVN_ERR(sbox_add_and_commit_greek_tree(&b));
+
+  /* Run the work queue on multiple threads when re-creating the tree. */
+  b.wc_ctx->db->install_threads = 4;
+  SVN_ERR(sbox_wc_update(&b, "", 0));
+  SVN_ERR(sbox_wc_update(&b, "", 1));
+
+  for (i = 0; files[i]; i++)
+    {
+      const char *local_abspath = sbox_wc_path(&b, files[i]);
+      svn_stringbuf_t *contents;
+      svn_filesize_t recorded_size;
+      svn_boolean_t modified;
+
+      svn_pool_clear(iterpool);
+
+      SVN_ERR(svn_stringbuf_from_file2(&contents, local_abspath, iterpool));
+      SVN_TEST_STRING_ASSERT(contents->data,
+                             apr_psprintf(iterpool, "This is the file '%s'.\n",
+                                          svn_dirent_basename(files[i],
+                                                              iterpool)));
+
+      /* The file info must have been recorded for every installed file. */
+      SVN_ERR(svn_wc__db_read_info(NULL, NULL, NULL, NULL, NULL, NULL, NULL,
+                                   NULL, NULL, NULL, NULL, NULL, NULL, NULL,
+                                   NULL, NULL, NULL, &recorded_size, NULL,
+                                   NULL, NULL, NULL, NULL, NULL, NULL, NULL,
+                                   NULL,
+                                   b.wc_ctx->db, local_abspath,
+                                   iterpool, iterpool));
+      SVN_TEST_ASSERT(recorded_size == (svn_filesize_t)contents->len);
+
+      SVN_ERR(svn_wc__internal_file_modified_p(&modified, b.wc_ctx->db,
+                                               local_abspath, FALSE,
+                                               iterpool));
+      SVN_TEST_ASSERT(!modified);
+    }
+
+  svn_pool_destroy(iterpool);
+  return SVN_NO_ERROR;
+}
+
+/* A stand-in for the file system monitor that answers the cookies of
+   status walks. */
+struct cookie_baton_t
+{
+  svn_wc__journal_t *journal;
+  const char *monitor_abspath;
+
+  /* Serializes access to JOURNAL. */
+  svn_mutex__t *mutex;
+
+  /* Set to stop the thread.  Any error it encounters. */
+  volatile svn_atomic_t done;
+  svn_error_t *err;
+};
+
+#if APR_HAS_THREADS
+static void *
+APR_THREAD_FUNC cookie_thread(apr_thread_t *tid, void *data)
+{
+  struct cookie_baton_t *cb = data;
+  apr_pool_t *pool = svn_pool_create(NULL);
+  apr_pool_t *iterpool = svn_pool_create(pool);
+  apr_hash_t *answered = apr_hash_make(pool);
+
+  while (!cb->err && !svn_atomic_read(&cb->done))
+    {
+      apr_hash_t *dirents;
+      apr_hash_index_t *hi;
+
+      svn_pool_clear(iterpool);
+
+      cb->err = svn_io_get_dirents3(&dirents, cb->monitor_abspath, TRUE,
+                                    iterpool, iterpool);
+      for (hi = cb->err ? NULL : apr_hash_first(iterpool, dirents);
+           hi && !cb->err;
+           hi = apr_hash_next(hi))
+        {
+          const char *name = apr_hash_this_key(hi);
+
+          if (strncmp(name, SVN_WC__JOURNAL_COOKIE_PREFIX,
+                      strlen(SVN_WC__JOURNAL_COOKIE_PREFIX)) != 0
+              || svn_hash_gets(answered, name))
+            continue;
+
+          cb->err = svn_mutex__lock(cb->mutex);
+          if (!cb->err)
+            cb->err = svn_mutex__unlock(cb->mutex,
+                                        svn_wc__journal_add_cookie(
+                                          cb->journal, name, iterpool));
+          svn_hash_sets(answered, apr_pstrdup(pool, name), "");
+        }
+
+      apr_sleep(apr_time_from_msec(1));
+    }
+
+  svn_pool_destroy(pool);
+  apr_thread_exit(tid, APR_SUCCESS);
+
+  return NULL;
+}
+#endif
+
+/* A node and its expected status. */
+struct expected_status_t
+{
+  const char *relpath;
+  enum svn_wc_status_kind status;
+};
+
+/* Implements svn_wc_status_func4_t.  Collects the node status of each
+   reported node in the apr_hash_t * BATON, by absolute path. */
+static svn_error_t *
+collect_node_status(void *baton,
+                    const char *local_abspath,
+                    const svn_wc_status3_t *status,
+                    apr_pool_t *scratch_pool)
+{
+  apr_hash_t *statuses = baton;
+  apr_pool_t *pool = apr_hash_pool_get(statuses);
+
+  svn_hash_sets(statuses, apr_pstrdup(pool, local_abspath),
+                apr_pmemdup(pool, &status->node_status,
+                            sizeof(status->node_status)));
+
+  return SVN_NO_ERROR;
+}
+
+/* Run a status walk of the whole working copy of B and verify that it
+   reports exactly the nodes in EXPECTED, which is terminated by an entry
+   with a NULL relpath. */
+static svn_error_t *
+check_journal_status(svn_test__sandbox_t *b,
+                     const struct expected_status_t *expected,
+                     apr_pool_t *pool)
+{
+  apr_hash_t *statuses = apr_hash_make(pool);
+  int i;
+
+  SVN_ERR(svn_wc_walk_status(b->wc_ctx, b->wc_abspath, svn_depth_infinity,
+                             FALSE, FALSE, FALSE, NULL,
+                             collect_node_status, statuses,
+                             NULL, NULL, pool));
+
+  for (i = 0; expected[i].relpath; i++)
+    {
+      const enum svn_wc_status_kind *status
+        = svn_hash_gets(statuses, sbox_wc_path(b, expected[i].relpath));
+
+      SVN_TEST_ASSERT(status != NULL);
+      SVN_TEST_INT_ASSERT(*status, expected[i].status);
+    }
+  SVN_TEST_INT_ASSERT(apr_hash_count(statuses), i);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_status_journal(const svn_test_opts_t *opts, apr_pool_t *pool)
+{
+#if APR_HAS_THREADS
+  svn_test__sandbox_t b;
+  struct cookie_baton_t cb = { 0 };
+  apr_thread_t *thread;
+  apr_status_t status, retval;
+  static const struct expected_status_t
+    nothing[] = { { NULL } },
+    changed[] = { { "iota", svn_wc_status_modified },
+                  { "A/new", svn_wc_status_unversioned },
+                  { NULL } },
+    invalidated[] = { { "iota", svn_wc_status_modified },
+                      { "A/new", svn_wc_status_unversioned },
+                      { "A/mu", svn_wc_status_modified },
+                      { NULL } },
+    reverted[] = { { "A/new", svn_wc_status_unversioned },
+                   { "A/mu", svn_wc_status_modified },
+                   { NULL } },
+    propchanged[] = { { "A/new", svn_wc_status_unversioned },
+                      { "A/mu", svn_wc_status_modified },
+                      { "A/B", svn_wc_status_modified },
+                      { NULL } },
+    rootchanged[] = { { "A/new", svn_wc_status_unversioned },
+                      { "A/mu", svn_wc_status_modified },
+                      { "A/B", svn_wc_status_modified },
+                      { "A/D/gamma", svn_wc_status_modified },
+                      { NULL } };
+
+  SVN_ERR(svn_test__sandbox_create(&b, "status_journal", opts, pool));
+  SVN_ERR(sbox_add_and_commit_greek_tree(&b));
+
+  SVN_ERR(svn_wc__journal_open(&cb.journal, &cb.monitor_abspath,
+                               b.wc_abspath, pool, pool));
+  SVN_ERR(svn_mutex__init(&cb.mutex, TRUE, pool));
+  status = apr_thread_create(&thread, NULL, cookie_thread, &cb, pool);
+  if (status)
+    return svn_error_wrap_apr(status, NULL);
+
+  /* The first walk is a full walk. */
+  SVN_ERR(check_journal_status(&b, nothing, pool));
+
+  /* Recorded changes are seen. */
+  SVN_ERR(sbox_file_write(&b, "iota", "modified iota\n"));
+  SVN_ERR(sbox_file_write(&b, "A/new", "new file\n"));
+  SVN_MUTEX__WITH_LOCK(cb.mutex,
+                       svn_wc__journal_add_path(cb.journal, "iota", pool));
+  SVN_MUTEX__WITH_LOCK(cb.mutex,
+                       svn_wc__journal_add_path(cb.journal, "A/new", pool));
+  SVN_ERR(check_journal_status(&b, changed, pool));
+
+  /* Unrecorded ones are not, until the journal gets invalidated. */
+  SVN_ERR(sbox_file_write(&b, "A/mu", "modified mu\n"));
+  SVN_ERR(check_journal_status(&b, changed, pool));
+  SVN_MUTEX__WITH_LOCK(cb.mutex,
+                       svn_wc__journal_invalidate(cb.journal, pool));
+  SVN_ERR(check_journal_status(&b, invalidated, pool));
+
+  /* Nodes reported before are checked again. */
+  SVN_ERR(sbox_file_write(&b, "iota", "This is the file 'iota'.\n"));
+  SVN_MUTEX__WITH_LOCK(cb.mutex,
+                       svn_wc__journal_add_path(cb.journal, "iota", pool));
+  SVN_ERR(check_journal_status(&b, reverted, pool));
+
+  /* Changing wc.db requires a full walk. */
+  SVN_ERR(sbox_wc_propset(&b, "prop", "value", "A/B"));
+  SVN_ERR(check_journal_status(&b, propchanged, pool));
+
+  /* A change recorded for the root of the walk requires a full walk. */
+  SVN_ERR(sbox_file_write(&b, "A/D/gamma", "modified gamma\n"));
+  SVN_ERR(check_journal_status(&b, propchanged, pool));
+  SVN_MUTEX__WITH_LOCK(cb.mutex,
+                       svn_wc__journal_add_path(cb.journal, "", pool));
+  SVN_ERR(check_journal_status(&b, rootchanged, pool));
+
+  svn_atomic_set(&cb.done, TRUE);
+  status = apr_thread_join(&retval, thread);
+  if (status)
+    return svn_error_wrap_apr(status, NULL);
+  SVN_ERR(cb.err);
+
+  SVN_ERR(svn_wc__journal_close(cb.journal, pool));
+#endif
+
+  return SVN_NO_ERROR;
+}
+
+/* Implements svn_wc_status_func4_t.  Appends the node status and the
+   absolute path of each reported node to the apr_array_header_t * BATON of
+   const char *. */
+static svn_error_t *
+collect_status_in_order(void *baton,
+                        const char *local_abspath,
+                        const svn_wc_status3_t *status,
+                        apr_pool_t *scratch_pool)
+{
+  apr_array_header_t *statuses = baton;
+
+  APR_ARRAY_PUSH(statuses, const char *)
+    = apr_psprintf(statuses->pool, "%d %s", status->node_status,
+                   local_abspath);
+
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_parallel_status(const svn_test_opts_t *opts, apr_pool_t *pool)
+{
+  svn_test__sandbox_t b;
+  apr_array_header_t *expected = apr_array_make(pool, 0, sizeof(char *));
+  apr_array_header_t *actual = apr_array_make(pool, 0, sizeof(char *));
+  apr_time_t time;
+  int i;
+  static const struct expected_status_t
+    interesting[] = { { "iota", svn_wc_status_normal },
+                      { "A/mu", svn_wc_status_modified },
+                      { "A/B/lambda", svn_wc_status_modified },
+                      { "A/B/F", svn_wc_status_missing },
+                      { "A/D/gamma", svn_wc_status_modified },
+                      { "A/D/G/new", svn_wc_status_unversioned },
+                      { "A/D/H/chi", svn_wc_status_missing },
+                      { NULL } };
+
+  SVN_ERR(svn_test__sandbox_create(&b, "parallel_status", opts, pool));
+  SVN_ERR(sbox_add_and_commit_greek_tree(&b));
+
+  /* Same size but different text, only found by reading the file. */
+  SVN_ERR(sbox_file_write(&b, "A/mu", "This is the file 'MU'.\n"));
+  SVN_ERR(svn_io_file_affected_time(&time, sbox_wc_path(&b, "A/mu"), pool));
+  SVN_ERR(svn_io_set_file_affected_time(time + apr_time_from_sec(1),
+                                        sbox_wc_path(&b, "A/mu"), pool));
+
+  /* Touched but unmodified. */
+  SVN_ERR(svn_io_file_affected_time(&time, sbox_wc_path(&b, "iota"), pool));
+  SVN_ERR(svn_io_set_file_affected_time(time + apr_time_from_sec(1),
+                                        sbox_wc_path(&b, "iota"), pool));
+  SVN_ERR(sbox_wc_propset(&b, "prop", "value", "A/D/gamma"));
+  SVN_ERR(svn_io_set_file_affected_time(time + apr_time_from_sec(1),
+                                        sbox_wc_path(&b, "A/D/gamma"), pool));
+
+  /* Other kinds of changes. */
+  SVN_ERR(sbox_file_write(&b, "A/B/lambda", "modified lambda\n"));
+  SVN_ERR(sbox_file_write(&b, "A/D/G/new", "new file\n"));
+  SVN_ERR(svn_io_remove_file2(sbox_wc_path(&b, "A/D/H/chi"), FALSE, pool));
+  SVN_ERR(svn_io_remove_dir2(sbox_wc_path(&b, "A/B/F"), FALSE,
+                             NULL, NULL, pool));
+
+  SVN_ERR(svn_wc_walk_status(b.wc_ctx, b.wc_abspath, svn_depth_infinity,
+                             TRUE, FALSE, FALSE, NULL,
+                             collect_status_in_order, expected,
+                             NULL, NULL, pool));
+
+  /* Read directories and files on multiple threads. */
+  b.wc_ctx->db->status_threads = 4;
+  SVN_ERR(svn_wc_walk_status(b.wc_ctx, b.wc_abspath, svn_depth_infinity,
+                             TRUE, FALSE, FALSE, NULL,
+                             collect_status_in_order, actual,
+                             NULL, NULL, pool));
+
+  SVN_TEST_INT_ASSERT(actual->nelts, expected->nelts);
+  for (i = 0; i < expected->nelts; i++)
+    SVN_TEST_STRING_ASSERT(APR_ARRAY_IDX(actual, i, const char *),
+                           APR_ARRAY_IDX(expected, i, const char *));
+
+  /* Make sure the interesting cases were actually there. */
+  for (i = 0; interesting[i].relpath; i++)
+    {
+      const char *line = apr_psprintf(pool, "%d %s", interesting[i].status,
+                                      sbox_wc_path(&b,
+                                                   interesting[i].relpath));
+      int j;
+
+      for (j = 0; j < expected->nelts; j++)
+        if (!strcmp(APR_ARRAY_IDX(expected, j, const char *), line))
+          break;
+
+      SVN_TEST_ASSERT(j < expected->nelts);
+    }
+
+  return SVN_NO_ERROR;
+}
+
+/* Set *CONTENTS to the pristine text of RELPATH in B. */
+static svn_error_t *
+read_pristine(const char **contents,
+              svn_test__sandbox_t *b,
+              const char *relpath,
+              apr_pool_t *pool)
+{
+  svn_stream_t *stream;
+  svn_string_t *str;
+
+  SVN_ERR(svn_wc_get_pristine_contents2(&stream, b->wc_ctx,
+                                        sbox_wc_path(b, relpath),
+                                        pool, pool));
+  SVN_ERR(svn_string_from_stream2(&str, stream, 0, pool));
+  *contents = str->data;
+  return SVN_NO_ERROR;
+}
+
+static svn_error_t *
+test_parallel_commit(const svn_test_opts_t *opts, apr_pool_t *pool)
+{
+  svn_test__sandbox_t b;
+  svn_stringbuf_t *big = svn_stringbuf_create_empty(pool);
+  const char *contents;
+  int i;
+
+  SVN_ERR(svn_test__sandbox_create(&b, "parallel_commit", opts, pool));
+  SVN_ERR(sbox_add_and_commit_greek_tree(&b));
+
+  /* Large enough to be spilled to disk. */
+  for (i = 0; i < 40000; i++)
+    svn_stringbuf_appendcstr(big, apr_psprintf(pool, "line %d\n", i));
+
+  SVN_ERR(sbox_file_write(&b, "iota", "This is the file 'iota'.\nmore\n"));
+  SVN_ERR(sbox_file_write(&b, "A/mu", big->data));
+  SVN_ERR(sbox_wc_propset(&b, SVN_PROP_EOL_STYLE, "native", "A/D/gamma"));
+  SVN_ERR(sbox_file_write(&b, "A/D/gamma", "gamma\r\nmore\r\n"));
+  SVN_ERR(sbox_file_write(&b, "A/D/G/new", big->data));
+  SVN_ERR(sbox_wc_add(&b, "A/D/G/new"));
+
+  /* Prepare the deltas on multiple threads. */
+  b.wc_ctx->db->commit_threads = 4;
+  SVN_ERR(sbox_wc_commit(&b, ""));
+
+  SVN_ERR(read_pristine(&contents, &b, "iota", pool));
+  SVN_TEST_STRING_ASSERT(contents, "This is the file 'iota'.\nmore\n");
+  SVN_ERR(read_pristine(&contents, &b, "A/mu", pool));
+  SVN_TEST_STRING_ASSERT(contents, big->data);
+  SVN_ERR(read_pristine(&contents, &b, "A/D/gamma", pool));
+  SVN_TEST_STRING_ASSERT(contents, "gamma\nmore\n");
+  SVN_ERR(read_pristine(&contents, &b, "A/D/G/new", pool));
+  SVN_TEST_STRING_ASSERT(contents, big->data);
+
+  /* The repository got the same texts.  Updating back and forth would
+     fail on checksum mismatches otherwise. */
+  SVN_ERR(sbox_wc_update(&b, "", 1));
+  SVN_ERR(sbox_wc_update(&b, "", SVN_INVALID_REVNUM));
+  SVN_ERR(read_pristine(&contents, &b, "A/mu", pool));
+  SVN_TEST_STRING_ASSERT(contents, big->data);
+  SVN_ERR(read_pristine(&contents, &b, "A/D/gamma", pool));
+  SVN_TEST_STRING_ASSERT(contents, "gamma\nmore\n");
+
+  return SVN_NO_ERROR;
+}
+
 /* ---------------------------------------------------------------------- */
 /* The list of test functions */
 
@@ -515,6 +937,14 @@ static struct svn_test_descriptor_t test_funcs[] =
                        "test legacy commit2"),
     SVN_TEST_OPTS_PASS(test_internal_file_modified,
                        "test internal_file_modified"),
+    SVN_TEST_OPTS_PASS(test_parallel_file_install,
+                       "test work queue with parallel file installs"),
+    SVN_TEST_OPTS_SKIP(test_status_journal, !APR_HAS_THREADS,
+                       "test status walks using the change journal"),
+    SVN_TEST_OPTS_PASS(test_parallel_status,
+                       "test status walks reading ahead on threads"),
+    SVN_TEST_OPTS_PASS(test_parallel_commit,
+                       "test commits preparing deltas on threads"),
     SVN_TEST_NULL
   };
 
@@ -0,0 +1,596 @@
+/*
+ * svn-wc-monitor.c :  record changes to a working copy in its change journal
+ *
+ * ====================================================================
+ *    Licensed to the Apache Software Foundation (ASF) under one
+ *    or more contributor license agreements.  See the NOTICE file
+ *    distributed with this work for additional information
+ *    regarding copyright ownership.  The ASF licenses this file
+ *    to you under the Apache License, Version 2.0 (the
+ *    "License"); you may not use this file except in compliance
+ *    with the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing,
+ *    software distributed under the License is distributed on an
+ *    "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *    KIND, either express or implied.  See the License for the
+ *    specific language governing permissions and limitations
+ *    under the License.
+ * ====================================================================
+ */
+
+#include <string.h>
+
+#include <apr_getopt.h>
+#include <apr_strings.h>
+#include <apr_thread_proc.h>
+
+#include "svn_cmdline.h"
+#include "svn_dirent_uri.h"
+#include "svn_error.h"
+#include "svn_hash.h"
+#include "svn_io.h"
+#include "svn_opt.h"
+#include "svn_path.h"
+#include "svn_pools.h"
+#include "svn_utf.h"
+#include "svn_wc.h"
+
+#include "private/svn_cmdline_private.h"
+#include "private/svn_wc_private.h"
+
+#include "svn_private_config.h"
+
+#ifdef HAVE_SYS_INOTIFY_H
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+#endif
+
+/* Used to terminate lines in large multi-line string literals. */
+#define NL APR_EOL_STR
+
+static const char *usage_summary =
+  "usage: svn-wc-monitor [--daemon] [WCPATH]"                               NL
+  ""                                                                        NL
+  "Watch the working copy containing WCPATH (default: the current"         NL
+  "directory) for changes and record them in the working copy's change"     NL
+  "journal until interrupted.  While the monitor is running, 'svn status'"  NL
+  "only checks the nodes that changed since its last run instead of"        NL
+  "scanning the whole working copy."                                        NL
+  ""                                                                        NL
+  "Options:"                                                                NL
+  "  -d, --daemon   run in the background"                                  NL
+  "  -h, --help     show this help"                                         NL;
+
+static const apr_getopt_option_t options[] =
+{
+  {"daemon", 'd', 0, NULL},
+  {"help",   'h', 0, NULL},
+  {0,        0,   0, 0}
+};
+
+#ifdef HAVE_SYS_INOTIFY_H
+
+/* The events to watch for in working copy directories. */
+#define TREE_EVENTS (IN_CREATE | IN_DELETE | IN_MODIFY | IN_CLOSE_WRITE \
+                     | IN_ATTRIB | IN_MOVED_FROM | IN_MOVED_TO           \
+                     | IN_DELETE_SELF | IN_MOVE_SELF                     \
+                     | IN_ONLYDIR | IN_DONT_FOLLOW | IN_EXCL_UNLINK)
+
+/* The kinds of watched directories. */
+typedef enum watch_kind_t
+{
+  watch_kind_tree,
+  watch_kind_adm,
+  watch_kind_monitor
+} watch_kind_t;
+
+/* A watched directory. */
+typedef struct watch_t
+{
+  int wd;
+  watch_kind_t kind;
+
+  /* Relative to the working copy root. */
+  const char *relpath;
+} watch_t;
+
+/* The monitor's state. */
+typedef struct monitor_t
+{
+  int fd;
+  const char *wcroot_abspath;
+  svn_wc__journal_t *journal;
+
+  /* All watches, by watch descriptor and, for tree watches, by relpath. */
+  apr_hash_t *by_wd;
+  apr_hash_t *by_relpath;
+
+  /* The pool the watches are allocated in and the number of watches that
+     have been removed since it has been created. */
+  apr_pool_t *watch_pool;
+  int removed;
+} monitor_t;
+
+/* Add a watch of kind KIND for the directory LOCAL_ABSPATH to MONITOR.
+   Set *WATCH to NULL if the directory has disappeared. */
+static svn_error_t *
+add_watch(watch_t **watch,
+          monitor_t *monitor,
+          const char *local_abspath,
+          const char *relpath,
+          watch_kind_t kind,
+          apr_pool_t *scratch_pool)
+{
+  const char *local_abspath_native;
+  watch_t *w;
+  int wd;
+
+  SVN_ERR(svn_utf_cstring_from_utf8(&local_abspath_native, local_abspath,
+                                    scratch_pool));
+  wd = inotify_add_watch(monitor->fd, local_abspath_native,
+                         kind == watch_kind_tree ? TREE_EVENTS
+                                                 : IN_CREATE | IN_MODIFY
+                                                   | IN_CLOSE_WRITE
+                                                   | IN_DELETE | IN_MOVED_TO
+                                                   | IN_ONLYDIR);
+  if (wd < 0)
+    {
+      if (errno == ENOENT || errno == ENOTDIR)
+        {
+          *watch = NULL;
+          return SVN_NO_ERROR;
+        }
+
+      return svn_error_wrap_apr(errno,
+                                errno == ENOSPC
+                                  ? _("Can't watch '%s'; consider raising "
+                                      "fs.inotify.max_user_watches")
+                                  : _("Can't watch '%s'"),
+                                svn_dirent_local_style(local_abspath,
+                                                       scratch_pool));
+    }
+
+  /* Watching a directory twice yields the same descriptor. */
+  w = apr_hash_get(monitor->by_wd, &wd, sizeof(wd));
+  if (!w)
+    {
+      w = apr_pcalloc(monitor->watch_pool, sizeof(*w));
+      w->wd = wd;
+      apr_hash_set(monitor->by_wd, &w->wd, sizeof(w->wd), w);
+    }
+  else if (w->kind == watch_kind_tree)
+    svn_hash_sets(monitor->by_relpath, w->relpath, NULL);
+
+  w->kind = kind;
+  w->relpath = apr_pstrdup(monitor->watch_pool, relpath);
+  if (kind == watch_kind_tree)
+    svn_hash_sets(monitor->by_relpath, w->relpath, w);
+
+  *watch = w;
+  return SVN_NO_ERROR;
+}
+
+/* Watch the directory RELPATH and all directories below it that are not
+   administrative directories. */
+static svn_error_t *
+watch_tree(monitor_t *monitor,
+           const char *relpath,
+           apr_pool_t *scratch_pool)
+{
+  const char *local_abspath = svn_dirent_join(monitor->wcroot_abspath,
+                                              relpath, scratch_pool);
+  apr_pool_t *iterpool;
+  apr_hash_t *dirents;
+  apr_hash_index_t *hi;
+  watch_t *watch;
+  svn_error_t *err;
+
+  SVN_ERR(add_watch(&watch, monitor, local_abspath, relpath,
+                    watch_kind_tree, scratch_pool));
+  if (!watch)
+    return SVN_NO_ERROR;
+
+  /* Anything created from here on is reported by the new watch. */
+  err = svn_io_get_dirents3(&dirents, local_abspath, TRUE,
+                            scratch_pool, scratch_pool);
+  if (err && (APR_STATUS_IS_ENOENT(err->apr_err)
+              || SVN__APR_STATUS_IS_ENOTDIR(err->apr_err)))
+    {
+      svn_error_clear(err);
+      return SVN_NO_ERROR;
+    }
+  SVN_ERR(err);
+
+  iterpool = svn_pool_create(scratch_pool);
+  for (hi = apr_hash_first(scratch_pool, dirents); hi; hi = apr_hash_next(hi))
+    {
+      const char *name = apr_hash_this_key(hi);
+      const svn_io_dirent2_t *dirent = apr_hash_this_val(hi);
+
+      svn_pool_clear(iterpool);
+
+      if (dirent->kind != svn_node_dir || dirent->special
+          || svn_wc_is_adm_dir(name, iterpool))
+        continue;
+
+      SVN_ERR(watch_tree(monitor, svn_relpath_join(relpath, name, iterpool),
+                         iterpool));
+    }
+  svn_pool_destroy(iterpool);
+
+  return SVN_NO_ERROR;
+}
+
+/* Forget WATCH.  If REMOVE is set, tell the kernel as well. */
+static void
+forget_watch(monitor_t *monitor,
+             watch_t *watch,
+             svn_boolean_t remove)
+{
+  if (remove)
+    inotify_rm_watch(monitor->fd, watch->wd);
+
+  apr_hash_set(monitor->by_wd, &watch->wd, sizeof(watch->wd), NULL);
+  if (watch->kind == watch_kind_tree)
+    svn_hash_sets(monitor->by_relpath, watch->relpath, NULL);
+
+  monitor->removed++;
+}
+
+/* Stop watching RELPATH and everything below it. */
+static void
+unwatch_tree(monitor_t *monitor,
+             const char *relpath,
+             apr_pool_t *scratch_pool)
+{
+  apr_array_header_t *watches = apr_array_make(scratch_pool, 1,
+                                               sizeof(watch_t *));
+  apr_hash_index_t *hi;
+  int i;
+
+  for (hi = apr_hash_first(scratch_pool, monitor->by_relpath);
+       hi;
+       hi = apr_hash_next(hi))
+    if (svn_relpath_skip_ancestor(relpath, apr_hash_this_key(hi)))
+      APR_ARRAY_PUSH(watches, watch_t *) = apr_hash_this_val(hi);
+
+  for (i = 0; i < watches->nelts; i++)
+    forget_watch(monitor, APR_ARRAY_IDX(watches, i, watch_t *), TRUE);
+}
+
+/* Copy the watches into a new pool once enough of them have been
+   removed, so that a long-running monitor doesn't grow without bounds. */
+static void
+compact_watches(monitor_t *monitor)
+{
+  apr_pool_t *pool;
+  apr_hash_t *by_wd;
+  apr_hash_t *by_relpath;
+  apr_hash_index_t *hi;
+
+  if (monitor->removed < 1024
+      || monitor->removed < (int)apr_hash_count(monitor->by_wd))
+    return;
+
+  pool = svn_pool_create(apr_pool_parent_get(monitor->watch_pool));
+  by_wd = apr_hash_make(pool);
+  by_relpath = apr_hash_make(pool);
+  for (hi = apr_hash_first(pool, monitor->by_wd); hi; hi = apr_hash_next(hi))
+    {
+      const watch_t *old_watch = apr_hash_this_val(hi);
+      watch_t *watch = apr_pmemdup(pool, old_watch, sizeof(*watch));
+
+      watch->relpath = apr_pstrdup(pool, old_watch->relpath);
+      apr_hash_set(by_wd, &watch->wd, sizeof(watch->wd), watch);
+      if (watch->kind == watch_kind_tree)
+        svn_hash_sets(by_relpath, watch->relpath, watch);
+    }
+
+  svn_pool_destroy(monitor->watch_pool);
+  monitor->watch_pool = pool;
+  monitor->by_wd = by_wd;
+  monitor->by_relpath = by_relpath;
+  monitor->removed = 0;
+}
+
+/* Record the inotify event EVENT in the journal.  Set *DONE if the
+   working copy has gone away. */
+static svn_error_t *
+handle_event(svn_boolean_t *done,
+             monitor_t *monitor,
+             const struct inotify_event *event,
+             apr_pool_t *scratch_pool)
+{
+  watch_t *watch;
+  const char *name;
+  const char *relpath;
+  svn_error_t *err;
+
+  if (event->mask & IN_Q_OVERFLOW)
+    return svn_error_trace(svn_wc__journal_invalidate(monitor->journal,
+                                                      scratch_pool));
+
+  watch = apr_hash_get(monitor->by_wd, &event->wd, sizeof(event->wd));
+  if (!watch)
+    return SVN_NO_ERROR;
+
+  if (event->mask & IN_IGNORED)
+    {
+      forget_watch(monitor, watch, FALSE);
+      return SVN_NO_ERROR;
+    }
+
+  if (watch->kind == watch_kind_tree && watch->relpath[0] == '\0'
+      && (event->mask & (IN_DELETE_SELF | IN_MOVE_SELF)))
+    {
+      *done = TRUE;
+      return SVN_NO_ERROR;
+    }
+
+  /* Events for the directory itself are reported to its parent as well. */
+  if (event->len == 0)
+    return SVN_NO_ERROR;
+
+  err = svn_utf_cstring_to_utf8(&name, event->name, scratch_pool);
+  if (err)
+    {
+      /* Can't record that name. */
+      svn_error_clear(err);
+      return svn_error_trace(svn_wc__journal_invalidate(monitor->journal,
+                                                        scratch_pool));
+    }
+
+  if (watch->kind == watch_kind_monitor)
+    {
+      if ((event->mask & IN_CREATE)
+          && strncmp(name, SVN_WC__JOURNAL_COOKIE_PREFIX,
+                     strlen(SVN_WC__JOURNAL_COOKIE_PREFIX)) == 0)
+        SVN_ERR(svn_wc__journal_add_cookie(monitor->journal, name,
+                                           scratch_pool));
+      return SVN_NO_ERROR;
+    }
+
+  if (watch->kind == watch_kind_adm)
+    {
+      /* Status walks can't see changes to the working copy's metadata. */
+      if (strcmp(name, "wc.db") == 0)
+        SVN_ERR(svn_wc__journal_invalidate(monitor->journal, scratch_pool));
+      return SVN_NO_ERROR;
+    }
+
+  if (svn_wc_is_adm_dir(name, scratch_pool))
+    return SVN_NO_ERROR;
+
+  relpath = svn_relpath_join(watch->relpath, name, scratch_pool);
+
+  if (event->mask & IN_ISDIR)
+    {
+      if (event->mask & (IN_DELETE | IN_MOVED_FROM))
+        unwatch_tree(monitor, relpath, scratch_pool);
+      else if (event->mask & (IN_CREATE | IN_MOVED_TO))
+        SVN_ERR(watch_tree(monitor, relpath, scratch_pool));
+      else
+        return SVN_NO_ERROR; /* Nothing status cares about. */
+    }
+
+  return svn_error_trace(svn_wc__journal_add_path(monitor->journal, relpath,
+                                                  scratch_pool));
+}
+
+/* Record changes to the working copy at WCROOT_ABSPATH until CANCEL_FUNC
+   says otherwise. */
+static svn_error_t *
+run_monitor(const char *wcroot_abspath,
+            svn_cancel_func_t cancel_func,
+            apr_pool_t *pool)
+{
+  monitor_t monitor = { 0 };
+  const char *monitor_abspath;
+  const char *adm_abspath;
+  apr_pool_t *iterpool;
+  svn_boolean_t done = FALSE;
+  watch_t *watch;
+  svn_error_t *err;
+  union
+    {
+      struct inotify_event event;
+      char buf[64 * 1024];
+    } events;
+
+  monitor.wcroot_abspath = wcroot_abspath;
+  monitor.watch_pool = svn_pool_create(pool);
+  monitor.by_wd = apr_hash_make(monitor.watch_pool);
+  monitor.by_relpath = apr_hash_make(monitor.watch_pool);
+
+  SVN_ERR(svn_wc__journal_open(&monitor.journal, &monitor_abspath,
+                               wcroot_abspath, pool, pool));
+
+  monitor.fd = inotify_init1(IN_CLOEXEC);
+  if (monitor.fd < 0)
+    return svn_error_compose_create(
+             svn_error_wrap_apr(errno, _("Can't initialize inotify")),
+             svn_wc__journal_close(monitor.journal, pool));
+
+  /* Watch for cookies first, so that status walks get an answer once
+     we're done setting up. */
+  adm_abspath = svn_dirent_join(wcroot_abspath, svn_wc_get_adm_dir(pool),
+                                pool);
+  err = add_watch(&watch, &monitor, monitor_abspath, "",
+                  watch_kind_monitor, pool);
+  if (!err)
+    err = add_watch(&watch, &monitor, adm_abspath, "", watch_kind_adm, pool);
+  if (!err)
+    err = watch_tree(&monitor, "", pool);
+
+  iterpool = svn_pool_create(pool);
+  while (!err && !done)
+    {
+      struct pollfd pfd;
+      ssize_t len;
+      char *p;
+
+      svn_pool_clear(iterpool);
+
+      err = cancel_func(NULL);
+      if (err)
+        break;
+
+      pfd.fd = monitor.fd;
+      pfd.events = POLLIN;
+      if (poll(&pfd, 1, 1000) <= 0)
+        continue;
+
+      len = read(monitor.fd, events.buf, sizeof(events.buf));
+      if (len < 0)
+        {
+          if (errno != EINTR && errno != EAGAIN)
+            err = svn_error_wrap_apr(errno, _("Can't read inotify events"));
+          continue;
+        }
+
+      for (p = events.buf; !err && !done && p < events.buf + len; )
+        {
+          const struct inotify_event *event = (const void *)p;
+
+          err = handle_event(&done, &monitor, event, iterpool);
+          p += sizeof(*event) + event->len;
+        }
+
+      compact_watches(&monitor);
+    }
+  svn_pool_destroy(iterpool);
+
+  close(monitor.fd);
+
+  if (err && err->apr_err == SVN_ERR_CANCELLED)
+    {
+      svn_error_clear(err);
+      err = SVN_NO_ERROR;
+    }
+
+  /* The working copy may be gone with its journal. */
+  if (done)
+    return svn_error_trace(err);
+
+  return svn_error_compose_create(err,
+                                  svn_wc__journal_close(monitor.journal,
+                                                        pool));
+}
+
+#else /* !HAVE_SYS_INOTIFY_H */
+
+static svn_error_t *
+run_monitor(const char *wcroot_abspath,
+            svn_cancel_func_t cancel_func,
+            apr_pool_t *pool)
+{
+  return svn_error_create(SVN_ERR_UNSUPPORTED_FEATURE, NULL,
+                          _("Monitoring working copies is not supported "
+                            "on this platform"));
+}
+
+#endif /* HAVE_SYS_INOTIFY_H */
+
+static svn_error_t *
+sub_main(int *exit_code, int argc, const char *argv[], apr_pool_t *pool)
+{
+  apr_getopt_t *os;
+  svn_boolean_t daemon = FALSE;
+  svn_wc_context_t *wc_ctx;
+  svn_cancel_func_t cancel_func;
+  const char *local_abspath;
+  const char *wcroot_abspath;
+
+  SVN_ERR(svn_cmdline__getopt_init(&os, argc, argv, pool));
+  while (1)
+    {
+      int opt;
+      const char *arg;
+      apr_status_t status = apr_getopt_long(os, options, &opt, &arg);
+
+      if (APR_STATUS_IS_EOF(status))
+        break;
+      if (status != APR_SUCCESS || opt == 'h')
+        {
+          svn_error_clear(svn_cmdline_fputs(usage_summary, stderr, pool));
+          *exit_code = EXIT_FAILURE;
+          return SVN_NO_ERROR;
+        }
+
+      if (opt == 'd')
+        daemon = TRUE;
+    }
+
+  if (os->ind < argc - 1)
+    {
+      svn_error_clear(svn_cmdline_fputs(usage_summary, stderr, pool));
+      *exit_code = EXIT_FAILURE;
+      return SVN_NO_ERROR;
+    }
+
+  if (os->ind < argc)
+    {
+      SVN_ERR(svn_utf_cstring_to_utf8(&local_abspath, os->argv[os->ind],
+                                      pool));
+      local_abspath = svn_dirent_internal_style(local_abspath, pool);
+    }
+  else
+    local_abspath = "";
+  SVN_ERR(svn_dirent_get_absolute(&local_abspath, local_abspath, pool));
+
+  SVN_ERR(svn_wc_context_create(&wc_ctx, NULL, pool, pool));
+  SVN_ERR(svn_wc__get_wcroot(&wcroot_abspath, wc_ctx, local_abspath,
+                             pool, pool));
+  SVN_ERR(svn_wc_context_destroy(wc_ctx));
+
+  cancel_func = svn_cmdline__setup_cancellation_handler();
+
+#if APR_HAS_FORK
+  /* Before taking the journal's lock, which is not inherited. */
+  if (daemon)
+    apr_proc_detach(APR_PROC_DETACH_DAEMONIZE);
+#else
+  if (daemon)
+    return svn_error_create(SVN_ERR_UNSUPPORTED_FEATURE, NULL,
+                            _("Running in the background is not supported "
+                              "on this platform"));
+#endif
+
+  return svn_error_trace(run_monitor(wcroot_abspath, cancel_func, pool));
+}
+
+int
+main(int argc, const char *argv[])
+{
+  apr_pool_t *pool;
+  int exit_code = EXIT_SUCCESS;
+  svn_error_t *err;
+
+  /* Initialize the app. */
+  if (svn_cmdline_init("svn-wc-monitor", stderr) != EXIT_SUCCESS)
+    return EXIT_FAILURE;
+
+  /* Create our top-level pool.  Use a separate mutexless allocator,
+   * given this application is single threaded.
+   */
+  pool = apr_allocator_owner_get(svn_pool_create_allocator(FALSE));
+
+  err = sub_main(&exit_code, argc, argv, pool);
+
+  if (err)
+    {
+      exit_code = EXIT_FAILURE;
+      svn_cmdline_handle_exit_error(err, NULL, "svn-wc-monitor: ");
+    }
+
+  svn_pool_destroy(pool);
+
+  svn_cmdline__cancellation_exit();
+
+  return exit_code;
+}